@@ -0,0 +1,158 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ConsoleLogWriter.h"
+
+#include <QFile>
+#include <QMutexLocker>
+
+namespace QVirt {
+
+ConsoleLogWriter::ConsoleLogWriter(const QString &path, qint64 maxFileBytes, int keepFiles,
+                                   QObject *parent)
+    : QThread(parent)
+    , m_path(path)
+    , m_maxFileBytes(qMax<qint64>(1, maxFileBytes))
+    , m_keepFiles(qMax(0, keepFiles))
+    , m_queuedBytes(0)
+    , m_maxQueuedBytes(DefaultMaxQueuedBytes)
+    , m_stopping(false)
+    , m_failed(false)
+    , m_writtenBytes(0)
+    , m_droppedBytes(0)
+{
+}
+
+ConsoleLogWriter::~ConsoleLogWriter()
+{
+    stop();
+}
+
+void ConsoleLogWriter::setMaxQueuedBytes(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxQueuedBytes = qMax<qint64>(1, bytes);
+}
+
+QString ConsoleLogWriter::rotatedName(const QString &path, int index)
+{
+    return index == 0 ? path : QStringLiteral("%1.%2").arg(path).arg(index);
+}
+
+bool ConsoleLogWriter::append(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return true;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping || m_failed || m_queuedBytes + data.size() > m_maxQueuedBytes) {
+        m_droppedBytes.fetch_add(data.size(), std::memory_order_relaxed);
+        return false;
+    }
+    m_queue.append(data);
+    m_queuedBytes += data.size();
+    m_wake.wakeOne();
+    return true;
+}
+
+void ConsoleLogWriter::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    wait();
+}
+
+bool ConsoleLogWriter::rotate()
+{
+    if (m_keepFiles == 0) {
+        return QFile::remove(m_path);
+    }
+
+    QFile::remove(rotatedName(m_path, m_keepFiles));
+    for (int index = m_keepFiles - 1; index >= 0; --index) {
+        const QString name = rotatedName(m_path, index);
+        if (QFile::exists(name) && !QFile::rename(name, rotatedName(m_path, index + 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConsoleLogWriter::run()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_failed = true;
+            m_queue.clear();
+            m_queuedBytes = 0;
+        }
+        emit writeError(tr("Cannot open console log %1: %2").arg(m_path, file.errorString()));
+        return;
+    }
+    qint64 fileSize = file.size();
+
+    QList<QByteArray> batch;
+    forever {
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_stopping) {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_queue.isEmpty()) {
+                break;
+            }
+            batch.swap(m_queue);
+            m_queuedBytes = 0;
+        }
+
+        QString error;
+        for (const QByteArray &data : batch) {
+            if (fileSize > 0 && fileSize + data.size() > m_maxFileBytes) {
+                file.close();
+                if (!rotate() || !file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+                    error = tr("Cannot rotate console log %1").arg(m_path);
+                    break;
+                }
+                fileSize = file.size();
+            }
+            if (file.write(data) != data.size()) {
+                error = tr("Cannot write console log %1: %2").arg(m_path, file.errorString());
+                break;
+            }
+            fileSize += data.size();
+            m_writtenBytes.fetch_add(data.size(), std::memory_order_relaxed);
+        }
+        batch.clear();
+
+        // Flush per batch so the file can be followed while the console runs
+        if (error.isEmpty() && !file.flush()) {
+            error = tr("Cannot write console log %1: %2").arg(m_path, file.errorString());
+        }
+        if (!error.isEmpty()) {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_failed = true;
+                m_queue.clear();
+                m_queuedBytes = 0;
+            }
+            emit writeError(error);
+            return;
+        }
+    }
+}
+
+} // namespace QVirt
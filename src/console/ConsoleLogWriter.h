@@ -0,0 +1,100 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CONSOLE_CONSOLELOGWRITER_H
+#define QVIRT_CONSOLE_CONSOLELOGWRITER_H
+
+#include <QThread>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <atomic>
+
+namespace QVirt {
+
+/**
+ * @brief Background writer teeing console output to a rotating log file
+ *
+ * append() only queues the (implicitly shared) buffer it is given, so the
+ * console never copies or waits on disk I/O; the thread writes and
+ * flushes whatever is queued. When the file would grow beyond
+ * maxFileBytes() it is renamed to "<path>.1", older files shift up and the
+ * oldest beyond keepFiles() is removed.
+ *
+ * If the disk falls behind by more than maxQueuedBytes(), new data is
+ * dropped and counted rather than buffered without limit.
+ */
+class ConsoleLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 DefaultMaxFileBytes = 64 * 1024 * 1024;
+    static constexpr int DefaultKeepFiles = 5;
+    static constexpr qint64 DefaultMaxQueuedBytes = 8 * 1024 * 1024;
+
+    explicit ConsoleLogWriter(const QString &path,
+                              qint64 maxFileBytes = DefaultMaxFileBytes,
+                              int keepFiles = DefaultKeepFiles,
+                              QObject *parent = nullptr);
+    ~ConsoleLogWriter() override;
+
+    QString path() const { return m_path; }
+    qint64 maxFileBytes() const { return m_maxFileBytes; }
+    int keepFiles() const { return m_keepFiles; }
+
+    qint64 maxQueuedBytes() const { return m_maxQueuedBytes; }
+    void setMaxQueuedBytes(qint64 bytes);
+
+    // Any thread: queue @p data for writing; false if it was dropped
+    bool append(const QByteArray &data);
+
+    // Write everything queued, then end the thread
+    void stop();
+
+    qint64 writtenBytes() const { return m_writtenBytes.load(std::memory_order_relaxed); }
+    qint64 droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+
+    // Name of the @p index-th rotated file; 0 is the live file
+    static QString rotatedName(const QString &path, int index);
+
+signals:
+    // Emitted from the writer thread; logging stops after an error
+    void writeError(const QString &message);
+
+protected:
+    void run() override;
+
+private:
+    bool rotate();
+
+    const QString m_path;
+    const qint64 m_maxFileBytes;
+    const int m_keepFiles;
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QList<QByteArray> m_queue;
+    qint64 m_queuedBytes;
+    qint64 m_maxQueuedBytes;
+    bool m_stopping;
+    bool m_failed;
+
+    std::atomic<qint64> m_writtenBytes;
+    std::atomic<qint64> m_droppedBytes;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CONSOLE_CONSOLELOGWRITER_H
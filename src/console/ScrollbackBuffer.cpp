@@ -0,0 +1,230 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ScrollbackBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace QVirt {
+
+namespace {
+
+// Small appends are packed into chunks of this size; larger ones are kept
+// as their own (implicitly shared) chunk without copying
+constexpr int ChunkCapacity = 64 * 1024;
+
+} // namespace
+
+ScrollbackBuffer::ScrollbackBuffer(qint64 maxBytes, qint64 maxLines)
+    : m_start(0)
+    , m_end(0)
+    , m_firstLine(0)
+    , m_maxBytes(qMax<qint64>(1, maxBytes))
+    , m_maxLines(qMax<qint64>(1, maxLines))
+{
+    m_lineStarts.push_back(0);
+}
+
+void ScrollbackBuffer::setLimits(qint64 maxBytes, qint64 maxLines)
+{
+    m_maxBytes = qMax<qint64>(1, maxBytes);
+    m_maxLines = qMax<qint64>(1, maxLines);
+    evict();
+}
+
+void ScrollbackBuffer::clear()
+{
+    // Positions keep counting so callers holding offsets see them evicted;
+    // whatever comes next starts a new line
+    m_firstLine = lastLine() + 1;
+    m_chunks.clear();
+    m_lineStarts.clear();
+    m_lineStarts.push_back(m_end);
+    m_start = m_end;
+}
+
+void ScrollbackBuffer::append(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    const qint64 base = m_end;
+    if (data.size() >= ChunkCapacity / 2) {
+        m_chunks.push_back(Chunk{base, data});
+    } else if (!m_chunks.empty()
+               && m_chunks.back().data.size() + data.size() <= ChunkCapacity
+               && m_chunks.back().data.capacity() >= ChunkCapacity) {
+        m_chunks.back().data.append(data);
+    } else {
+        Chunk chunk{base, QByteArray()};
+        chunk.data.reserve(ChunkCapacity);
+        chunk.data.append(data);
+        m_chunks.push_back(std::move(chunk));
+    }
+    m_end += data.size();
+
+    // Index the start of every line that begins inside the new data
+    const char *bytes = data.constData();
+    const char *end = bytes + data.size();
+    for (const char *p = bytes; p < end; ++p) {
+        p = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!p) {
+            break;
+        }
+        m_lineStarts.push_back(base + (p - bytes) + 1);
+    }
+
+    evict();
+}
+
+void ScrollbackBuffer::evict()
+{
+    qint64 target = m_start;
+    if (m_end - m_start > m_maxBytes) {
+        target = m_end - m_maxBytes;
+    }
+    if (lineCount() > m_maxLines) {
+        target = qMax(target, m_lineStarts[std::size_t(lineCount() - m_maxLines)]);
+    }
+    if (target <= m_start) {
+        return;
+    }
+
+    // Move forward to the next line start so the oldest line is whole; a
+    // single line longer than the limit is cut instead
+    auto it = std::lower_bound(m_lineStarts.begin(), m_lineStarts.end(), target);
+    if (it == m_lineStarts.end()) {
+        m_firstLine += qint64(m_lineStarts.size()) - 1;
+        m_lineStarts.clear();
+        m_lineStarts.push_back(target);
+        m_start = target;
+    } else {
+        m_firstLine += qint64(it - m_lineStarts.begin());
+        m_lineStarts.erase(m_lineStarts.begin(), it);
+        m_start = m_lineStarts.front();
+    }
+
+    while (!m_chunks.empty()
+           && m_chunks.front().start + m_chunks.front().data.size() <= m_start) {
+        m_chunks.pop_front();
+    }
+}
+
+int ScrollbackBuffer::chunkIndex(qint64 offset) const
+{
+    auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), offset,
+                               [](qint64 value, const Chunk &chunk) {
+        return value < chunk.start;
+    });
+    return int(it - m_chunks.begin()) - 1;
+}
+
+qint64 ScrollbackBuffer::lineAt(qint64 offset) const
+{
+    offset = qBound(m_start, offset, m_end);
+    auto it = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset);
+    return m_firstLine + qint64(it - m_lineStarts.begin()) - 1;
+}
+
+qint64 ScrollbackBuffer::lineStart(qint64 line) const
+{
+    if (line < m_firstLine || line > lastLine()) {
+        return -1;
+    }
+    return m_lineStarts[line - m_firstLine];
+}
+
+QByteArray ScrollbackBuffer::line(qint64 line) const
+{
+    qint64 start = lineStart(line);
+    if (start < 0) {
+        return QByteArray();
+    }
+    qint64 end = line < lastLine() ? m_lineStarts[line - m_firstLine + 1] - 1 : m_end;
+    return read(start, end - start);
+}
+
+QByteArray ScrollbackBuffer::read(qint64 offset, qint64 length) const
+{
+    offset = qMax(offset, m_start);
+    length = qMin(length, m_end - offset);
+    if (length <= 0) {
+        return QByteArray();
+    }
+
+    int index = chunkIndex(offset);
+    const Chunk &first = m_chunks[index];
+    qint64 local = offset - first.start;
+
+    // Common case: the range lies in one chunk and is shared, not copied
+    if (local + length <= first.data.size()) {
+        if (local == 0 && length == first.data.size()) {
+            return first.data;
+        }
+        return first.data.mid(int(local), int(length));
+    }
+
+    QByteArray result;
+    result.reserve(int(length));
+    while (length > 0 && index < int(m_chunks.size())) {
+        const Chunk &chunk = m_chunks[index];
+        qint64 take = qMin<qint64>(length, chunk.data.size() - local);
+        result.append(chunk.data.constData() + local, int(take));
+        length -= take;
+        local = 0;
+        ++index;
+    }
+    return result;
+}
+
+qint64 ScrollbackBuffer::find(const QString &text, qint64 from, FindFlags flags) const
+{
+    if (text.isEmpty() || isEmpty()) {
+        return -1;
+    }
+
+    const Qt::CaseSensitivity cs = flags.testFlag(FindCaseSensitive) ? Qt::CaseSensitive
+                                                                     : Qt::CaseInsensitive;
+    const bool backward = flags.testFlag(FindBackward);
+    from = qBound(m_start, from, m_end);
+
+    qint64 lineNumber = lineAt(from);
+    const qint64 step = backward ? -1 : 1;
+    for (bool first = true; lineNumber >= m_firstLine && lineNumber <= lastLine();
+         lineNumber += step, first = false) {
+        const QByteArray bytes = line(lineNumber);
+        const qint64 start = lineStart(lineNumber);
+        const QString lineText = QString::fromUtf8(bytes);
+
+        int index;
+        if (!first) {
+            index = backward ? lineText.lastIndexOf(text, -1, cs) : lineText.indexOf(text, 0, cs);
+        } else {
+            // Character column of @p from within its line
+            const int column = QString::fromUtf8(bytes.left(int(from - start))).size();
+            if (backward) {
+                index = column > 0 ? lineText.lastIndexOf(text, column - 1, cs) : -1;
+            } else {
+                index = lineText.indexOf(text, column, cs);
+            }
+        }
+
+        if (index >= 0) {
+            return start + lineText.left(index).toUtf8().size();
+        }
+    }
+    return -1;
+}
+
+} // namespace QVirt
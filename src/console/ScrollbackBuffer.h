@@ -0,0 +1,116 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CONSOLE_SCROLLBACKBUFFER_H
+#define QVIRT_CONSOLE_SCROLLBACKBUFFER_H
+
+#include <QByteArray>
+#include <QFlags>
+#include <QString>
+#include <deque>
+
+namespace QVirt {
+
+/**
+ * @brief Bounded console history with a line index
+ *
+ * Text is stored as a ring of chunks: appends go to the newest chunk and
+ * the oldest data is released a whole chunk at a time once the byte or
+ * line limit is exceeded. Eviction always stops on a line boundary, so
+ * the oldest retained line is complete.
+ *
+ * Offsets and line numbers are absolute: they count from the first byte
+ * ever appended and stay valid while older data is evicted. Line starts
+ * are kept in a sorted index, so mapping an offset to its line and
+ * jumping to a line are O(log n).
+ */
+class ScrollbackBuffer
+{
+public:
+    enum FindFlag {
+        FindBackward = 0x1,
+        FindCaseSensitive = 0x2
+    };
+    Q_DECLARE_FLAGS(FindFlags, FindFlag)
+
+    static constexpr qint64 DefaultMaxBytes = 16 * 1024 * 1024;
+    static constexpr qint64 DefaultMaxLines = 100000;
+
+    explicit ScrollbackBuffer(qint64 maxBytes = DefaultMaxBytes,
+                              qint64 maxLines = DefaultMaxLines);
+
+    qint64 maxBytes() const { return m_maxBytes; }
+    qint64 maxLines() const { return m_maxLines; }
+    void setLimits(qint64 maxBytes, qint64 maxLines);
+
+    void append(const QByteArray &data);
+    void clear();
+
+    // Retained range, as absolute offsets [startOffset, endOffset)
+    qint64 startOffset() const { return m_start; }
+    qint64 endOffset() const { return m_end; }
+    qint64 size() const { return m_end - m_start; }
+    bool isEmpty() const { return m_end == m_start; }
+
+    // Retained lines [firstLine, firstLine + lineCount); the last one may
+    // still be open (no trailing newline yet)
+    qint64 firstLine() const { return m_firstLine; }
+    qint64 lineCount() const { return qint64(m_lineStarts.size()); }
+    qint64 lastLine() const { return m_firstLine + lineCount() - 1; }
+
+    // Line containing @p offset, clamped to the retained range
+    qint64 lineAt(qint64 offset) const;
+
+    // Offset of the first byte of @p line, or -1 if it is not retained
+    qint64 lineStart(qint64 line) const;
+
+    // Text of @p line without its newline
+    QByteArray line(qint64 line) const;
+
+    // Up to @p length bytes starting at @p offset, clamped to the retained range
+    QByteArray read(qint64 offset, qint64 length) const;
+    QByteArray toByteArray() const { return read(m_start, size()); }
+
+    int chunkCount() const { return int(m_chunks.size()); }
+
+    /**
+     * @brief Find @p text line by line
+     *
+     * Forward searches return the first match starting at or after
+     * @p from; backward searches the last match starting before it.
+     * Matches do not span lines. Returns the absolute offset of the
+     * match, or -1.
+     */
+    qint64 find(const QString &text, qint64 from, FindFlags flags = FindFlags()) const;
+
+private:
+    struct Chunk {
+        qint64 start;
+        QByteArray data;
+    };
+
+    void evict();
+    int chunkIndex(qint64 offset) const;
+
+    std::deque<Chunk> m_chunks;
+    std::deque<qint64> m_lineStarts;
+    qint64 m_start;
+    qint64 m_end;
+    qint64 m_firstLine;
+    qint64 m_maxBytes;
+    qint64 m_maxLines;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ScrollbackBuffer::FindFlags)
+
+} // namespace QVirt
+
+#endif // QVIRT_CONSOLE_SCROLLBACKBUFFER_H
@@ -10,13 +10,24 @@
  */
 
 #include "SerialConsole.h"
+#include "ConsoleLogWriter.h"
 #include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QTextBlock>
 #include <QLabel>
 #include <QPushButton>
 #include <QProcess>
 #include <QMessageBox>
 #include <QClipboard>
 #include <QApplication>
+#include <QPlainTextEdit>
+#include <QScrollBar>
+#include <QTextCursor>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QFontDatabase>
+#include <QDebug>
 
 #ifdef QTERMWIDGET_FOUND
 #include <QTermWidget>
@@ -24,6 +35,42 @@
 
 namespace QVirt {
 
+namespace {
+
+// Bytes turned into text per event loop pass; the rest waits for the next
+// pass so input and painting interleave with a flood of output
+constexpr qint64 MaxRenderBytes = 64 * 1024;
+
+// Lines kept in the view
+constexpr int MaxViewLines = 10000;
+
+// Typed or pasted input waiting for the stream; beyond this it is dropped
+constexpr int MaxWriteBacklog = 1024 * 1024;
+
+// Length of @p bytes without an incomplete UTF-8 sequence at the end
+int completeUtf8Length(const QByteArray &bytes)
+{
+    const int size = bytes.size();
+    for (int back = 1; back <= qMin(3, size); ++back) {
+        const uchar c = uchar(bytes.at(size - back));
+        if ((c & 0xC0) == 0x80) {
+            continue;   // Continuation byte, keep looking for the lead
+        }
+        int needed = 1;
+        if ((c & 0xE0) == 0xC0) {
+            needed = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            needed = 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            needed = 4;
+        }
+        return needed > back ? size - back : size;
+    }
+    return size;
+}
+
+} // namespace
+
 SerialConsole::SerialConsole(QWidget *parent)
     : QWidget(parent)
     , m_baudRate(115200)
@@ -34,16 +81,27 @@ SerialConsole::SerialConsole(QWidget *parent)
     , m_useExternalTerminal(true)
 #ifdef QTERMWIDGET_FOUND
     , m_terminal(nullptr)
-#else
+#endif
     , m_ioDevice(nullptr)
     , m_placeholder(nullptr)
-#endif
+    , m_output(nullptr)
+    , m_renderTimer(nullptr)
+    , m_filterState(FilterText)
+    , m_logWriter(nullptr)
+    , m_findBar(nullptr)
+    , m_findEdit(nullptr)
+    , m_findStatus(nullptr)
+    , m_matchOffset(-1)
+    , m_viewFirstLine(0)
+    , m_viewFollowing(true)
 {
     setupUI();
 }
 
 SerialConsole::~SerialConsole()
 {
+    // Receivers may already be half destroyed along with our parent
+    blockSignals(true);
     disconnect();
 }
 
@@ -80,6 +138,37 @@ void SerialConsole::setupUI()
     
     layout->addWidget(m_placeholder);
 
+    // Output view for stream transports, shown once a stream is attached
+    m_output = new QPlainTextEdit(this);
+    m_output->setReadOnly(true);
+    m_output->setUndoRedoEnabled(false);
+    m_output->setMaximumBlockCount(MaxViewLines);
+    m_output->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_output->setLineWrapMode(m_wordWrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+    m_output->installEventFilter(this);
+    m_output->hide();
+    layout->addWidget(m_output);
+
+    // Find bar, toggled with Ctrl+Shift+F while the view has focus
+    m_findBar = new QWidget(this);
+    auto *findLayout = new QHBoxLayout(m_findBar);
+    findLayout->setContentsMargins(4, 2, 4, 2);
+    m_findEdit = new QLineEdit(m_findBar);
+    m_findEdit->setPlaceholderText(tr("Find in scrollback"));
+    m_findEdit->setToolTip(tr("Enter: older match, Shift+Enter: newer match, Esc: close"));
+    m_findEdit->installEventFilter(this);
+    connect(m_findEdit, &QLineEdit::textEdited, this, &SerialConsole::onFindTextEdited);
+    m_findStatus = new QLabel(m_findBar);
+    findLayout->addWidget(m_findEdit, 1);
+    findLayout->addWidget(m_findStatus);
+    m_findBar->hide();
+    layout->addWidget(m_findBar);
+
+    m_renderTimer = new QTimer(this);
+    m_renderTimer->setSingleShot(true);
+    m_renderTimer->setInterval(0);
+    connect(m_renderTimer, &QTimer::timeout, this, &SerialConsole::renderPending);
+
     setFocusPolicy(Qt::StrongFocus);
 }
 
@@ -104,6 +193,45 @@ void SerialConsole::connectToDevice(const QString &path, int baudRate)
 #endif
 }
 
+void SerialConsole::connectToStream(QIODevice *device)
+{
+    if (m_connected || m_ioDevice) {
+        disconnect();
+    }
+
+    if (!device || !device->isOpen()) {
+        emit connectionError(device ? device->errorString() : tr("No console stream"));
+        delete device;
+        return;
+    }
+
+    device->setParent(this);
+    m_ioDevice = device;
+    m_writeBacklog.clear();
+    m_partialUtf8.clear();
+    m_filterState = FilterText;
+
+    connect(device, &QIODevice::readyRead, this, &SerialConsole::onDataReceived);
+    connect(device, &QIODevice::bytesWritten, this, &SerialConsole::flushWrites);
+    connect(device, &QIODevice::readChannelFinished, this, &SerialConsole::onStreamFinished);
+
+    m_placeholder->hide();
+    m_output->clear();
+    m_scrollback.clear();
+    m_matchOffset = -1;
+    m_viewFollowing = true;
+    m_output->show();
+    m_output->setFocus();
+
+    m_connected = true;
+    emit connected();
+
+    // Output that arrived before we were listening
+    if (device->bytesAvailable() > 0) {
+        m_renderTimer->start();
+    }
+}
+
 void SerialConsole::disconnect()
 {
 #ifdef QTERMWIDGET_FOUND
@@ -111,8 +239,17 @@ void SerialConsole::disconnect()
         m_terminal->closePtyProcess();
     }
 #endif
+    if (m_ioDevice) {
+        QObject::disconnect(m_ioDevice, nullptr, this, nullptr);
+        m_ioDevice->close();
+        m_ioDevice->deleteLater();
+        m_ioDevice = nullptr;
+    }
+    if (m_renderTimer) {
+        m_renderTimer->stop();
+    }
+    m_writeBacklog.clear();
     m_connected = false;
-    m_readBuffer.clear();
     emit disconnected();
 }
 
@@ -123,17 +260,75 @@ void SerialConsole::sendText(const QString &text)
 
 void SerialConsole::sendBytes(const QByteArray &bytes)
 {
+    if (m_ioDevice) {
+        if (m_writeBacklog.size() + bytes.size() > MaxWriteBacklog) {
+            qWarning() << "Serial console input backlog full, dropping" << bytes.size() << "bytes";
+            return;
+        }
+        m_writeBacklog.append(bytes);
+        flushWrites();
+        return;
+    }
+
 #ifdef QTERMWIDGET_FOUND
     if (m_terminal && m_connected) {
         m_terminal->sendData(bytes);
     }
-#else
-    Q_UNUSED(bytes);
 #endif
 }
 
+void SerialConsole::flushWrites()
+{
+    if (!m_ioDevice || m_writeBacklog.isEmpty()) {
+        return;
+    }
+
+    // The device takes what fits and reports progress via bytesWritten()
+    qint64 written = m_ioDevice->write(m_writeBacklog);
+    if (written > 0) {
+        m_writeBacklog.remove(0, int(written));
+    } else if (written < 0) {
+        m_writeBacklog.clear();
+    }
+}
+
+void SerialConsole::setScrollbackLimits(qint64 maxBytes, qint64 maxLines)
+{
+    m_scrollback.setLimits(maxBytes, maxLines);
+    if (m_matchOffset >= 0 && m_matchOffset < m_scrollback.startOffset()) {
+        m_matchOffset = -1;
+    }
+}
+
+void SerialConsole::setLogFile(const QString &path, qint64 maxFileBytes, int keepFiles)
+{
+    if (m_logWriter) {
+        // Drains what is queued before the thread ends
+        delete m_logWriter;
+        m_logWriter = nullptr;
+    }
+    if (path.isEmpty()) {
+        return;
+    }
+
+    m_logWriter = new ConsoleLogWriter(path, maxFileBytes, keepFiles, this);
+    connect(m_logWriter, &ConsoleLogWriter::writeError, this, &SerialConsole::logFileError);
+    m_logWriter->start(QThread::LowPriority);
+}
+
+QString SerialConsole::logFile() const
+{
+    return m_logWriter ? m_logWriter->path() : QString();
+}
+
 void SerialConsole::clearScreen()
 {
+    if (m_output) {
+        m_output->clear();
+    }
+    m_scrollback.clear();
+    m_matchOffset = -1;
+    m_viewFollowing = true;
 #ifdef QTERMWIDGET_FOUND
     if (m_terminal) {
         m_terminal->clear();
@@ -144,6 +339,9 @@ void SerialConsole::clearScreen()
 void SerialConsole::setWordWrap(bool wrap)
 {
     m_wordWrap = wrap;
+    if (m_output) {
+        m_output->setLineWrapMode(wrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+    }
 #ifdef QTERMWIDGET_FOUND
     if (m_terminal) {
         m_terminal->setWordWrap(wrap);
@@ -154,6 +352,11 @@ void SerialConsole::setWordWrap(bool wrap)
 void SerialConsole::setFontSize(int size)
 {
     m_fontSize = size;
+    if (m_output) {
+        QFont font = m_output->font();
+        font.setPointSize(size);
+        m_output->setFont(font);
+    }
 #ifdef QTERMWIDGET_FOUND
     if (m_terminal) {
         QFont font = m_terminal->getTerminalFont();
@@ -176,6 +379,10 @@ void SerialConsole::setColorScheme(const QString &scheme)
 void SerialConsole::focusInEvent(QFocusEvent *event)
 {
     QWidget::focusInEvent(event);
+    if (m_ioDevice) {
+        m_output->setFocus();
+        return;
+    }
 #ifdef QTERMWIDGET_FOUND
     if (m_terminal) {
         m_terminal->setFocus();
@@ -183,8 +390,108 @@ void SerialConsole::focusInEvent(QFocusEvent *event)
 #endif
 }
 
+bool SerialConsole::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::KeyPress) {
+        return QWidget::eventFilter(watched, event);
+    }
+    auto *keyEvent = static_cast<QKeyEvent *>(event);
+    const Qt::KeyboardModifiers ctrlShift = Qt::ControlModifier | Qt::ShiftModifier;
+
+    if (watched == m_findEdit) {
+        switch (keyEvent->key()) {
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            findText(m_findEdit->text(), keyEvent->modifiers().testFlag(Qt::ShiftModifier)
+                                         ? ScrollbackBuffer::FindFlags()
+                                         : ScrollbackBuffer::FindBackward);
+            return true;
+        case Qt::Key_Escape:
+            hideFindBar();
+            return true;
+        default:
+            return QWidget::eventFilter(watched, event);
+        }
+    }
+
+    if (watched != m_output) {
+        return QWidget::eventFilter(watched, event);
+    }
+    if (keyEvent->key() == Qt::Key_F && (keyEvent->modifiers() & ctrlShift) == ctrlShift) {
+        showFindBar();
+        return true;
+    }
+    if (!m_ioDevice) {
+        return QWidget::eventFilter(watched, event);
+    }
+
+    // Keys go to the guest, not to the (read-only) view
+    QByteArray bytes;
+    switch (keyEvent->key()) {
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        bytes = "\r";
+        break;
+    case Qt::Key_Backspace:
+        bytes = "\x7f";
+        break;
+    case Qt::Key_Tab:
+        bytes = "\t";
+        break;
+    case Qt::Key_Escape:
+        bytes = "\x1b";
+        break;
+    case Qt::Key_Up:
+        bytes = "\x1b[A";
+        break;
+    case Qt::Key_Down:
+        bytes = "\x1b[B";
+        break;
+    case Qt::Key_Right:
+        bytes = "\x1b[C";
+        break;
+    case Qt::Key_Left:
+        bytes = "\x1b[D";
+        break;
+    case Qt::Key_Home:
+        bytes = "\x1b[H";
+        break;
+    case Qt::Key_End:
+        bytes = "\x1b[F";
+        break;
+    case Qt::Key_Delete:
+        bytes = "\x1b[3~";
+        break;
+    case Qt::Key_V:
+        if ((keyEvent->modifiers() & ctrlShift) == ctrlShift) {
+            bytes = QApplication::clipboard()->text().toUtf8();
+            break;
+        }
+        bytes = keyEvent->text().toUtf8();
+        break;
+    default:
+        // Includes control characters for Ctrl+letter
+        bytes = keyEvent->text().toUtf8();
+        break;
+    }
+
+    if (!bytes.isEmpty()) {
+        sendBytes(bytes);
+        return true;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
 void SerialConsole::onDataReceived()
 {
+    if (m_ioDevice) {
+        // Coalesce bursts of readyRead into one render pass
+        if (!m_renderTimer->isActive()) {
+            m_renderTimer->start();
+        }
+        return;
+    }
+
 #ifdef QTERMWIDGET_FOUND
     if (m_terminal) {
         QByteArray data = m_terminal->readAll();
@@ -201,6 +508,217 @@ void SerialConsole::onErrorOccurred()
     disconnect();
 }
 
+void SerialConsole::onStreamFinished()
+{
+    if (!m_ioDevice) {
+        return;
+    }
+
+    // Show whatever was still buffered, then why the console went away
+    while (m_ioDevice->bytesAvailable() > 0) {
+        renderPending();
+    }
+    QString reason = m_ioDevice->errorString();
+    appendOutput(QStringLiteral("\n[%1]\n").arg(reason).toUtf8());
+    disconnect();
+}
+
+void SerialConsole::renderPending()
+{
+    if (!m_ioDevice) {
+        return;
+    }
+
+    QByteArray data = m_ioDevice->read(MaxRenderBytes);
+    if (!data.isEmpty()) {
+        if (m_logWriter) {
+            // Shares the buffer; the writer thread does the copying to disk
+            m_logWriter->append(data);
+        }
+        emit dataReceived(data);
+        appendOutput(filterControlSequences(data));
+    }
+
+    if (m_ioDevice->bytesAvailable() > 0) {
+        m_renderTimer->start();
+    }
+}
+
+void SerialConsole::appendOutput(const QByteArray &bytes)
+{
+    // Keep multi-byte characters split across reads intact
+    QByteArray text = m_partialUtf8 + bytes;
+    int complete = completeUtf8Length(text);
+    m_partialUtf8 = text.mid(complete);
+    text.truncate(complete);
+    if (text.isEmpty()) {
+        return;
+    }
+
+    m_scrollback.append(text);
+    if (!m_viewFollowing) {
+        // The view shows older scrollback; it catches up when search ends
+        return;
+    }
+
+    QScrollBar *scrollBar = m_output->verticalScrollBar();
+    bool following = scrollBar->value() == scrollBar->maximum();
+
+    // One insertion per pass; the document lays out only the new text
+    QTextCursor cursor(m_output->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(QString::fromUtf8(text));
+
+    if (following) {
+        scrollBar->setValue(scrollBar->maximum());
+    }
+}
+
+QByteArray SerialConsole::filterControlSequences(const QByteArray &bytes)
+{
+    // Cursor movement and colours are dropped: the view is a plain log, not
+    // a screen. Only newlines and tabs survive among control characters.
+    QByteArray out;
+    out.reserve(bytes.size());
+    for (char ch : bytes) {
+        const uchar c = uchar(ch);
+        switch (m_filterState) {
+        case FilterText:
+            if (c == 0x1b) {
+                m_filterState = FilterEscape;
+            } else if (c >= 0x20 || c == '\n' || c == '\t') {
+                out.append(ch);
+            }
+            break;
+        case FilterEscape:
+            if (c == '[') {
+                m_filterState = FilterCsi;
+            } else if (c == ']') {
+                m_filterState = FilterOsc;
+            } else {
+                m_filterState = FilterText;
+            }
+            break;
+        case FilterCsi:
+            if (c >= 0x40 && c <= 0x7e) {
+                m_filterState = FilterText;
+            }
+            break;
+        case FilterOsc:
+            if (c == 0x07) {
+                m_filterState = FilterText;
+            } else if (c == 0x1b) {
+                m_filterState = FilterOscEscape;
+            }
+            break;
+        case FilterOscEscape:
+            m_filterState = c == '\\' ? FilterText : FilterOsc;
+            break;
+        }
+    }
+    return out;
+}
+
+bool SerialConsole::findText(const QString &text, ScrollbackBuffer::FindFlags flags, bool incremental)
+{
+    if (m_matchOffset < m_scrollback.startOffset()) {
+        m_matchOffset = -1;     // Evicted since it was found
+    }
+    if (text.isEmpty() || m_scrollback.isEmpty()) {
+        m_matchOffset = -1;
+        m_findStatus->clear();
+        return false;
+    }
+
+    const bool backward = flags.testFlag(ScrollbackBuffer::FindBackward);
+    const qint64 wrapFrom = backward ? m_scrollback.endOffset() : m_scrollback.startOffset();
+    qint64 from = wrapFrom;
+    if (m_matchOffset >= 0) {
+        // Backward searches look before @p from, forward ones at or after it
+        from = m_matchOffset + ((incremental == backward) ? 1 : 0);
+    }
+
+    qint64 offset = m_scrollback.find(text, from, flags);
+    if (offset < 0 && from != wrapFrom) {
+        offset = m_scrollback.find(text, wrapFrom, flags);
+    }
+    if (offset < 0) {
+        m_findStatus->setText(tr("Not found"));
+        return false;
+    }
+
+    m_matchOffset = offset;
+    selectMatch(offset, text.size());
+    m_findStatus->setText(tr("Line %1 of %2")
+                              .arg(m_scrollback.lineAt(offset) - m_scrollback.firstLine() + 1)
+                              .arg(m_scrollback.lineCount()));
+    return true;
+}
+
+void SerialConsole::showFindBar()
+{
+    m_findBar->show();
+    m_findEdit->setFocus();
+    m_findEdit->selectAll();
+}
+
+void SerialConsole::hideFindBar()
+{
+    m_findBar->hide();
+    m_findStatus->clear();
+    if (!m_viewFollowing) {
+        showScrollback(qMax(m_scrollback.firstLine(), m_scrollback.lastLine() - MaxViewLines + 1));
+    }
+    QScrollBar *scrollBar = m_output->verticalScrollBar();
+    scrollBar->setValue(scrollBar->maximum());
+    m_output->setFocus();
+}
+
+void SerialConsole::onFindTextEdited(const QString &text)
+{
+    // Search as you type, starting with the most recent output
+    findText(text, ScrollbackBuffer::FindBackward, true);
+}
+
+void SerialConsole::showScrollback(qint64 firstLine)
+{
+    firstLine = qMax(firstLine, m_scrollback.firstLine());
+    const qint64 lastLine = qMin(m_scrollback.lastLine(), firstLine + MaxViewLines - 1);
+    const qint64 start = m_scrollback.lineStart(firstLine);
+    const qint64 end = lastLine < m_scrollback.lastLine()
+                           ? m_scrollback.lineStart(lastLine + 1) - 1
+                           : m_scrollback.endOffset();
+
+    m_output->setPlainText(QString::fromUtf8(m_scrollback.read(start, end - start)));
+    m_viewFirstLine = firstLine;
+    m_viewFollowing = lastLine == m_scrollback.lastLine();
+}
+
+void SerialConsole::selectMatch(qint64 offset, int length)
+{
+    const qint64 line = m_scrollback.lineAt(offset);
+
+    // While following, the last block is the last scrollback line
+    qint64 block = m_viewFollowing
+                       ? m_output->blockCount() - 1 - (m_scrollback.lastLine() - line)
+                       : line - m_viewFirstLine;
+    if (block < 0 || block >= m_output->blockCount()) {
+        showScrollback(line - MaxViewLines / 2);
+        block = m_viewFollowing
+                    ? m_output->blockCount() - 1 - (m_scrollback.lastLine() - line)
+                    : line - m_viewFirstLine;
+    }
+
+    const qint64 lineStart = m_scrollback.lineStart(line);
+    const int column = QString::fromUtf8(m_scrollback.read(lineStart, offset - lineStart)).size();
+
+    QTextCursor cursor(m_output->document()->findBlockByNumber(int(block)));
+    cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, column);
+    cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, length);
+    m_output->setTextCursor(cursor);
+    m_output->ensureCursorVisible();
+}
+
 void SerialConsole::setupPTY()
 {
     // Setup PTY connection
@@ -17,12 +17,21 @@
 #include <QByteArray>
 #include <QIODevice>
 
+#include "ScrollbackBuffer.h"
+
+class QLabel;
+class QLineEdit;
+class QPlainTextEdit;
+class QTimer;
+
 #ifdef QTERMWIDGET_FOUND
 #include <QTermWidget>
 #endif
 
 namespace QVirt {
 
+class ConsoleLogWriter;
+
 /**
  * @brief Serial console widget for VM serial ports
  *
@@ -42,11 +51,60 @@ public:
 
     void connectToDevice(const QString &path, int baudRate = 115200);
     void connectToPTY(const QString &ptyPath);
+
+    /**
+     * @brief Use an open byte stream as the console transport
+     *
+     * Typically a ConsoleStream on a guest console, which works for remote
+     * connections. The console takes ownership of @p device. Output is
+     * rendered incrementally, a bounded slice per event loop pass, so a
+     * flood of guest output never stalls the UI; input is queued and
+     * written as the device accepts it.
+     */
+    void connectToStream(QIODevice *device);
     void disconnect();
 
     void sendText(const QString &text);
     void sendBytes(const QByteArray &bytes);
 
+    // Input queued while the stream applies back-pressure
+    qint64 pendingInputBytes() const { return m_writeBacklog.size(); }
+
+    /**
+     * @brief History of a stream console
+     *
+     * Holds the same text as the view, bounded by setScrollbackLimits();
+     * the view only shows the most recent part. It survives a remote close
+     * and is cleared by clearScreen() or the next connectToStream().
+     */
+    const ScrollbackBuffer &scrollback() const { return m_scrollback; }
+    void setScrollbackLimits(qint64 maxBytes, qint64 maxLines);
+
+    /**
+     * @brief Tee raw stream output to a rotating log file
+     *
+     * Written on a background thread; an empty @p path stops logging.
+     */
+    void setLogFile(const QString &path,
+                    qint64 maxFileBytes = 64 * 1024 * 1024, int keepFiles = 5);
+    QString logFile() const;
+
+    /**
+     * @brief Find @p text in the scrollback and select it in the view
+     *
+     * Continues from the current match, wrapping around once. With
+     * @p incremental the current match itself is a candidate, so typing
+     * more of a word keeps the selection in place. Matches older than the
+     * view are shown by loading that part of the scrollback.
+     * @return true if a match was found
+     */
+    bool findText(const QString &text, ScrollbackBuffer::FindFlags flags = ScrollbackBuffer::FindFlags(),
+              bool incremental = false);
+    qint64 currentMatch() const { return m_matchOffset; }
+
+    void showFindBar();
+    void hideFindBar();
+
     void clearScreen();
     void setWordWrap(bool wrap);
     bool wordWrap() const { return m_wordWrap; }
@@ -80,18 +138,37 @@ signals:
     void disconnected();
     void connectionError(const QString &error);
     void dataReceived(const QByteArray &data);
+    void logFileError(const QString &error);
 
 protected:
     void focusInEvent(QFocusEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void onDataReceived();
     void onErrorOccurred();
+    void onStreamFinished();
+    void renderPending();
+    void flushWrites();
+    void onFindTextEdited(const QString &text);
 
 private:
+    // Escape sequence parser state, carried across reads
+    enum FilterState {
+        FilterText,
+        FilterEscape,
+        FilterCsi,
+        FilterOsc,
+        FilterOscEscape
+    };
+
     void setupUI();
     void setupPTY();
     void updateTerminal();
+    void appendOutput(const QByteArray &bytes);
+    QByteArray filterControlSequences(const QByteArray &bytes);
+    void showScrollback(qint64 firstLine);
+    void selectMatch(qint64 offset, int length);
 
     QString m_devicePath;
     int m_baudRate;
@@ -104,11 +181,26 @@ private:
 
 #ifdef QTERMWIDGET_FOUND
     QTermWidget *m_terminal;
-#else
+#endif
     QIODevice *m_ioDevice;
     QWidget *m_placeholder;
-#endif
-    QByteArray m_readBuffer;
+
+    // Stream transport
+    QPlainTextEdit *m_output;
+    QTimer *m_renderTimer;
+    QByteArray m_writeBacklog;
+    QByteArray m_partialUtf8;       // Incomplete trailing UTF-8 sequence
+    FilterState m_filterState;
+
+    // History, search and logging
+    ScrollbackBuffer m_scrollback;
+    ConsoleLogWriter *m_logWriter;
+    QWidget *m_findBar;
+    QLineEdit *m_findEdit;
+    QLabel *m_findStatus;
+    qint64 m_matchOffset;           // Absolute scrollback offset, or -1
+    qint64 m_viewFirstLine;         // Scrollback line of the first block
+    bool m_viewFollowing;           // View shows the tail of the scrollback
 };
 
 } // namespace QVirt
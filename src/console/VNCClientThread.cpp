@@ -0,0 +1,409 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VNCClientThread.h"
+#include <QSysInfo>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>
+#endif
+
+#ifdef LIBVNCCLIENT_FOUND
+#include <rfb/rfbclient.h>
+#endif
+
+namespace QVirt {
+
+namespace {
+
+// Queued input events per console before posting starts to fail
+const int InputQueueCapacity = 1024;
+
+#ifdef LIBVNCCLIENT_FOUND
+// How long the protocol loop waits for server data before checking the
+// input queue and the interruption flag again
+const unsigned int PollIntervalUs = 5000;
+
+// Upper bound of server messages decoded into one published frame
+const int MaxMessagesPerFrame = 64;
+
+// Address used as the rfbClient client-data key for the owning thread
+int ClientDataTag = 0;
+
+// Period of link sampling and statistics reports
+const qint64 SampleIntervalMs = 1000;
+
+/**
+ * @brief Kernel view of a TCP connection
+ */
+struct TcpSample
+{
+    double rttMs = -1.0;
+    qint64 bytesReceived = -1;
+};
+
+TcpSample sampleTcp(int socket)
+{
+    TcpSample sample;
+#ifdef Q_OS_LINUX
+    struct tcp_info info;
+    std::memset(&info, 0, sizeof(info));
+    socklen_t length = sizeof(info);
+    if (getsockopt(socket, IPPROTO_TCP, TCP_INFO, &info, &length) == 0) {
+        sample.rttMs = info.tcpi_rtt / 1000.0;
+        // Older kernels return a shorter structure
+        if (length >= offsetof(struct tcp_info, tcpi_bytes_received) +
+                      sizeof(info.tcpi_bytes_received)) {
+            sample.bytesReceived = static_cast<qint64>(info.tcpi_bytes_received);
+        }
+    }
+#else
+    Q_UNUSED(socket);
+#endif
+    return sample;
+}
+#endif
+
+} // namespace
+
+#ifdef LIBVNCCLIENT_FOUND
+/**
+ * @brief libvncclient callbacks; all run on the protocol thread
+ */
+struct VNCClientCallbacks
+{
+    static VNCClientThread *threadFor(rfbClient *client)
+    {
+        return static_cast<VNCClientThread *>(rfbClientGetClientData(client, &ClientDataTag));
+    }
+
+    static rfbBool mallocFrameBuffer(rfbClient *client)
+    {
+        VNCClientThread *self = threadFor(client);
+        if (!self) {
+            return FALSE;
+        }
+
+        // Called on connect and on every desktop resize. At full colour
+        // libvncclient decodes directly into the image's (tightly packed)
+        // 32-bit rows; at low colour into a 16-bit buffer that is
+        // converted rectangle by rectangle on publish
+        self->m_decode = QImage(client->width, client->height, QImage::Format_RGB32);
+        if (self->m_decode.isNull()) {
+            client->frameBuffer = nullptr;
+            return FALSE;
+        }
+        self->m_decode.fill(Qt::black);
+        self->m_damage = QRegion(self->m_decode.rect());
+
+        if (self->m_lowColourMode) {
+            self->m_lowColour.fill('\0', client->width * client->height * 2);
+            client->frameBuffer = reinterpret_cast<uint8_t *>(self->m_lowColour.data());
+        } else {
+            self->m_lowColour.clear();
+            client->frameBuffer = self->m_decode.bits();
+        }
+        return TRUE;
+    }
+
+    static void gotFrameBufferUpdate(rfbClient *client, int x, int y, int w, int h)
+    {
+        if (VNCClientThread *self = threadFor(client)) {
+            self->m_damage += QRect(x, y, w, h);
+        }
+    }
+
+    static char *getPassword(rfbClient *client)
+    {
+        // libvncclient takes ownership of the returned string
+        VNCClientThread *self = threadFor(client);
+        return strdup(self ? self->m_password.toUtf8().constData() : "");
+    }
+
+    static void gotBell(rfbClient *client)
+    {
+        if (VNCClientThread *self = threadFor(client)) {
+            emit self->bell();
+        }
+    }
+
+    static void gotCutText(rfbClient *client, const char *text, int len)
+    {
+        if (VNCClientThread *self = threadFor(client)) {
+            emit self->clipboardReceived(QString::fromLatin1(text, len));
+        }
+    }
+};
+#endif
+
+VNCClientThread::VNCClientThread(const QString &host, int port, const QString &password,
+                                 QObject *parent)
+    : QThread(parent)
+    , m_host(host)
+    , m_port(port)
+    , m_password(password)
+    , m_client(nullptr)
+    , m_lowColourMode(false)
+    , m_damageSince(0)
+    , m_lastSampleMs(0)
+    , m_lastSampleBytes(-1)
+    , m_input(InputQueueCapacity)
+    , m_lastButtonMask(0)
+    , m_sentEvents(0)
+    , m_coalescedEvents(0)
+{
+}
+
+VNCClientThread::~VNCClientThread()
+{
+    requestInterruption();
+    wait();
+}
+
+bool VNCClientThread::postEvent(const VNCInputEvent &event)
+{
+    return m_input.tryPush(event);
+}
+
+void VNCClientThread::run()
+{
+#ifdef LIBVNCCLIENT_FOUND
+    rfbClient *client = rfbGetClient(8, 3, 4);
+    if (!client) {
+        emit connectionError(tr("Failed to initialize VNC client"));
+        return;
+    }
+
+    // libvncclient frees serverHost in rfbClientCleanup()
+    client->serverHost = strdup(m_host.toUtf8().constData());
+    client->serverPort = m_port;
+    rfbClientSetClientData(client, &ClientDataTag, this);
+
+    // Start from what this display's link looked like last time; the
+    // colour depth is fixed for the whole session
+    const QString display = QString("%1:%2").arg(m_host).arg(m_port);
+    m_policy = VNCLinkPolicy(VNCLinkPolicy::rememberedTier(display));
+    const VNCLinkPolicy::Settings settings = VNCLinkPolicy::settingsFor(m_policy.tier());
+    m_lowColourMode = settings.lowColour;
+
+    if (m_lowColourMode) {
+        // RGB565
+        client->format.bitsPerPixel = 16;
+        client->format.depth = 16;
+        client->format.redMax = 31;
+        client->format.greenMax = 63;
+        client->format.blueMax = 31;
+        client->format.redShift = 11;
+        client->format.greenShift = 5;
+        client->format.blueShift = 0;
+    } else {
+        // QImage::Format_RGB32 layout, so decoded rectangles can be
+        // painted without conversion
+        client->format.redShift = 16;
+        client->format.greenShift = 8;
+        client->format.blueShift = 0;
+    }
+    client->format.bigEndian = QSysInfo::ByteOrder == QSysInfo::BigEndian;
+
+    client->appData.encodingsString = settings.encodings;
+    client->appData.qualityLevel = settings.qualityLevel;
+    client->appData.compressLevel = settings.compressLevel;
+    client->appData.enableJPEG = settings.enableJPEG ? TRUE : FALSE;
+
+    client->canHandleNewFBSize = TRUE;
+    client->MallocFrameBuffer = VNCClientCallbacks::mallocFrameBuffer;
+    client->GotFrameBufferUpdate = VNCClientCallbacks::gotFrameBufferUpdate;
+    client->GetPassword = VNCClientCallbacks::getPassword;
+    client->Bell = VNCClientCallbacks::gotBell;
+    client->GotXCutText = VNCClientCallbacks::gotCutText;
+
+    if (!rfbInitClient(client, nullptr, nullptr)) {
+        // rfbInitClient() releases the client on failure
+        emit connectionError(tr("Failed to connect to VNC server"));
+        return;
+    }
+
+    m_client = client;
+    emit connected();
+    m_damageSince = VNCFrameExchange::clockUs();
+    publishFrame();
+
+    bool failed = false;
+    while (!failed && !isInterruptionRequested()) {
+        sendPendingInput();
+
+        int ready = client->buffered > 0 ? 1 : WaitForMessage(client, PollIntervalUs);
+
+        if (ready > 0) {
+            const qint64 arrivalUs = VNCFrameExchange::clockUs();
+            if (m_damage.isEmpty()) {
+                m_damageSince = arrivalUs;
+            }
+            const qint64 burstBytes = sampleTcp(client->sock).bytesReceived;
+
+            // Decode everything already received, then publish it as one frame
+            for (int i = 0; ready > 0 && i < MaxMessagesPerFrame; ++i) {
+                if (!HandleRFBServerMessage(client)) {
+                    ready = -1;
+                    break;
+                }
+                ready = client->buffered > 0 ? 1 : WaitForMessage(client, 0);
+            }
+
+            // Large updates stream in while they are decoded, which makes
+            // the batch a throughput probe
+            const qint64 endBytes = sampleTcp(client->sock).bytesReceived;
+            if (burstBytes >= 0 && endBytes >= 0) {
+                m_policy.addBurstSample(endBytes - burstBytes,
+                                        (VNCFrameExchange::clockUs() - arrivalUs) / 1000.0);
+            }
+        }
+        failed = ready < 0;
+
+        publishFrame();
+
+        const qint64 nowMs = VNCFrameExchange::clockUs() / 1000;
+        if (nowMs - m_lastSampleMs >= SampleIntervalMs) {
+            sampleLink(nowMs);
+        }
+    }
+
+    VNCLinkPolicy::rememberTier(display, m_policy.tier());
+    m_client = nullptr;
+    // The framebuffer belongs to this object, not to libvncclient
+    client->frameBuffer = nullptr;
+    rfbClientCleanup(client);
+
+    if (failed && !isInterruptionRequested()) {
+        emit connectionError(tr("Connection to VNC server lost"));
+    }
+#else
+    emit connectionError(tr("VNC support not available - libvncclient not found"));
+#endif
+}
+
+void VNCClientThread::sendPendingInput()
+{
+#ifdef LIBVNCCLIENT_FOUND
+    m_inputBatch.clear();
+    VNCInputEvent event;
+    while (m_input.tryPop(&event)) {
+        m_inputBatch.append(event);
+    }
+
+    quint64 coalesced = VNCInputBatcher::collapseMotion(&m_inputBatch, &m_lastButtonMask);
+    quint64 sent = 0;
+    for (const VNCInputEvent &input : m_inputBatch) {
+        switch (input.type) {
+        case VNCInputEvent::Key:
+            SendKeyEvent(m_client, input.keysym, input.down ? TRUE : FALSE);
+            break;
+        case VNCInputEvent::Pointer:
+            SendPointerEvent(m_client, input.x, input.y, input.buttonMask);
+            break;
+        case VNCInputEvent::ClipboardText:
+            SendClientCutText(m_client, const_cast<char *>(input.text.constData()),
+                              input.text.size());
+            break;
+        }
+        sent++;
+    }
+
+    if (sent > 0) {
+        m_sentEvents.fetch_add(sent, std::memory_order_relaxed);
+    }
+    if (coalesced > 0) {
+        m_coalescedEvents.fetch_add(coalesced, std::memory_order_relaxed);
+    }
+#endif
+}
+
+void VNCClientThread::publishFrame()
+{
+    if (m_damage.isEmpty() || m_decode.isNull()) {
+        return;
+    }
+
+    if (m_lowColourMode) {
+        convertLowColour();
+    }
+    if (m_frames.publish(m_decode, m_damage, m_damageSince)) {
+        emit frameReady();
+    }
+    m_damage = QRegion();
+}
+
+void VNCClientThread::convertLowColour()
+{
+    const int width = m_decode.width();
+    const quint16 *source = reinterpret_cast<const quint16 *>(m_lowColour.constData());
+    const QRegion damage = m_damage.intersected(m_decode.rect());
+
+    for (const QRect &rect : damage) {
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const quint16 *in = source + y * width + rect.x();
+            QRgb *out = reinterpret_cast<QRgb *>(m_decode.scanLine(y)) + rect.x();
+            for (int x = 0; x < rect.width(); ++x) {
+                const quint16 pixel = in[x];
+                const int r = (pixel >> 11) & 0x1f;
+                const int g = (pixel >> 5) & 0x3f;
+                const int b = pixel & 0x1f;
+                out[x] = qRgb((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+            }
+        }
+    }
+}
+
+void VNCClientThread::sampleLink(qint64 nowMs)
+{
+#ifdef LIBVNCCLIENT_FOUND
+    const TcpSample sample = sampleTcp(m_client->sock);
+    m_policy.addRttSample(sample.rttMs);
+
+    double kbps = 0.0;
+    if (sample.bytesReceived >= 0 && m_lastSampleBytes >= 0 && nowMs > m_lastSampleMs) {
+        kbps = (sample.bytesReceived - m_lastSampleBytes) * 8.0 / (nowMs - m_lastSampleMs);
+    }
+    m_lastSampleBytes = sample.bytesReceived;
+    m_lastSampleMs = nowMs;
+
+    if (m_policy.update(nowMs)) {
+        applySettings(VNCLinkPolicy::settingsFor(m_policy.tier()));
+    }
+
+    emit linkStatsUpdated(kbps, m_policy.rttMs(), VNCLinkPolicy::tierName(m_policy.tier()));
+#else
+    Q_UNUSED(nowMs);
+#endif
+}
+
+void VNCClientThread::applySettings(const VNCLinkPolicy::Settings &settings)
+{
+#ifdef LIBVNCCLIENT_FOUND
+    // The pixel format stays as negotiated: changing it mid-stream would
+    // race with updates already on the wire in the old format
+    m_client->appData.encodingsString = settings.encodings;
+    m_client->appData.qualityLevel = settings.qualityLevel;
+    m_client->appData.compressLevel = settings.compressLevel;
+    m_client->appData.enableJPEG = settings.enableJPEG ? TRUE : FALSE;
+    SetFormatAndEncodings(m_client);
+#else
+    Q_UNUSED(settings);
+#endif
+}
+
+} // namespace QVirt
@@ -0,0 +1,120 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CONSOLE_VNCCLIENTTHREAD_H
+#define QVIRT_CONSOLE_VNCCLIENTTHREAD_H
+
+#include <QThread>
+#include <QImage>
+#include <QRegion>
+#include <QVector>
+
+#include "VNCFrameExchange.h"
+#include "VNCInputBatcher.h"
+#include "VNCLinkPolicy.h"
+#include "../core/SPSCQueue.h"
+
+#include <atomic>
+
+struct _rfbClient;
+
+namespace QVirt {
+
+/**
+ * @brief RFB protocol loop of one VNC console
+ *
+ * Owns the libvncclient session and runs connect, WaitForMessage() and
+ * HandleRFBServerMessage() on its own thread, so large updates never stall
+ * the GUI and a busy GUI never stalls decoding. Decoded frames are handed
+ * over through a VNCFrameExchange and announced with frameReady(), which
+ * is emitted at most once per frame the GUI has not yet picked up.
+ *
+ * Once a second the thread samples the link (TCP round-trip time and
+ * update burst throughput), reports it with linkStatsUpdated() and lets a
+ * VNCLinkPolicy retune encodings, JPEG quality and compression. The
+ * colour depth is chosen at connect time from the last tier seen for the
+ * same display.
+ *
+ * Input travels the other way on a lock-free SPSC queue: postEvent() is
+ * called from the GUI thread only and never blocks; the protocol thread
+ * drains the queue between messages, collapsing runs of pointer motion
+ * that piled up while it was busy into their last position. Presses and
+ * releases are always sent.
+ */
+class VNCClientThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    VNCClientThread(const QString &host, int port, const QString &password,
+                    QObject *parent = nullptr);
+    ~VNCClientThread() override;
+
+    // GUI thread: queue input for the server; false if the queue is full
+    bool postEvent(const VNCInputEvent &event);
+
+    // Input messages written, and queued motion collapsed before writing
+    quint64 sentEvents() const { return m_sentEvents.load(std::memory_order_relaxed); }
+    quint64 coalescedEvents() const { return m_coalescedEvents.load(std::memory_order_relaxed); }
+
+    // GUI thread: frames published by the protocol thread
+    VNCFrameExchange *frames() { return &m_frames; }
+
+signals:
+    void connected();
+    void connectionError(const QString &error);
+    void frameReady();
+    void bell();
+    void clipboardReceived(const QString &text);
+
+    // Once a second: received data rate, smoothed round-trip time (< 0 if
+    // unknown) and the name of the active encoding tier
+    void linkStatsUpdated(double kbps, double rttMs, const QString &tier);
+
+protected:
+    void run() override;
+
+private:
+    friend struct VNCClientCallbacks;
+
+    void sendPendingInput();
+    void publishFrame();
+    void convertLowColour();
+    void sampleLink(qint64 nowMs);
+    void applySettings(const VNCLinkPolicy::Settings &settings);
+
+    const QString m_host;
+    const int m_port;
+    const QString m_password;
+
+    _rfbClient *m_client;       // Protocol thread only
+    QImage m_decode;            // Complete RGB32 frame
+    QByteArray m_lowColour;     // 16-bit decode target, if low colour
+    bool m_lowColourMode;
+    QRegion m_damage;           // Decoded since the last publish
+    qint64 m_damageSince;       // Arrival of the oldest unpublished data
+
+    // Link measurement, protocol thread only
+    VNCLinkPolicy m_policy;
+    qint64 m_lastSampleMs;
+    qint64 m_lastSampleBytes;
+
+    VNCFrameExchange m_frames;
+    SPSCQueue<VNCInputEvent> m_input;
+    QVector<VNCInputEvent> m_inputBatch;    // Protocol thread only
+    int m_lastButtonMask;                   // Protocol thread only; as the server saw it
+    std::atomic<quint64> m_sentEvents;
+    std::atomic<quint64> m_coalescedEvents;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CONSOLE_VNCCLIENTTHREAD_H
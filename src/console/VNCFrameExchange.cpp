@@ -0,0 +1,109 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VNCFrameExchange.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace QVirt {
+
+namespace {
+
+void copyRegion(const QImage &source, QImage *target, const QRegion &region)
+{
+    const int bytesPerPixel = source.depth() / 8;
+    const QRegion clipped = region.intersected(source.rect());
+    for (const QRect &rect : clipped) {
+        const int offset = rect.x() * bytesPerPixel;
+        const int length = rect.width() * bytesPerPixel;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            std::memcpy(target->scanLine(y) + offset, source.constScanLine(y) + offset, length);
+        }
+    }
+}
+
+} // namespace
+
+VNCFrameExchange::VNCFrameExchange()
+    : m_middle(1)
+    , m_back(0)
+    , m_unconsumedSince(0)
+    , m_published(0)
+    , m_replaced(0)
+    , m_front(2)
+{
+}
+
+bool VNCFrameExchange::publish(const QImage &source, const QRegion &damage, qint64 timestampUs)
+{
+    for (QRegion &stale : m_stale) {
+        stale += damage;
+    }
+
+    Slot &back = m_slots[m_back];
+    if (back.image.size() != source.size() || back.image.format() != source.format()) {
+        // First use or desktop resize: the whole slot is out of date
+        back.image = QImage(source.size(), source.format());
+        m_stale[m_back] = QRegion(source.rect());
+    }
+    copyRegion(source, &back.image, m_stale[m_back]);
+    m_stale[m_back] = QRegion();
+
+    // Until an exchange proves the consumer has taken a frame, everything
+    // published since then may still be unseen
+    if (m_unconsumed.isEmpty()) {
+        m_unconsumedSince = timestampUs;
+    }
+    m_unconsumed += damage;
+    back.damage = m_unconsumed;
+    back.timestamp = m_unconsumedSince;
+
+    const int previous = m_middle.exchange(m_back | FreshFlag, std::memory_order_acq_rel);
+    m_back = previous & IndexMask;
+    m_published++;
+
+    if (previous & FreshFlag) {
+        // The frame we got back was never seen; ours replaces it and
+        // already carries its damage
+        m_replaced++;
+        return false;
+    }
+
+    m_unconsumed = damage;
+    m_unconsumedSince = timestampUs;
+    return true;
+}
+
+bool VNCFrameExchange::acquire(QRegion *damage, qint64 *timestampUs)
+{
+    if (!(m_middle.load(std::memory_order_acquire) & FreshFlag)) {
+        return false;
+    }
+
+    const int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = previous & IndexMask;
+    if (damage) {
+        *damage = m_slots[m_front].damage;
+    }
+    if (timestampUs) {
+        *timestampUs = m_slots[m_front].timestamp;
+    }
+    return true;
+}
+
+qint64 VNCFrameExchange::clockUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace QVirt
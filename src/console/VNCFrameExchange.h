@@ -0,0 +1,100 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CONSOLE_VNCFRAMEEXCHANGE_H
+#define QVIRT_CONSOLE_VNCFRAMEEXCHANGE_H
+
+#include <QImage>
+#include <QRegion>
+
+#include <atomic>
+
+namespace QVirt {
+
+/**
+ * @brief Lock-free handoff of decoded frames from a VNC thread to the GUI
+ *
+ * The decoder keeps its own complete framebuffer and publishes snapshots
+ * of it through three image slots: one owned by the producer (back), one
+ * owned by the consumer (front) and one in flight. publish() and acquire()
+ * each swap their slot with the in-flight one in a single atomic exchange,
+ * so neither side ever waits for the other and the GUI always paints a
+ * complete, untorn frame.
+ *
+ * Updates are incremental: publishing copies only the rectangles a slot
+ * has missed since it was last written, and the consumer receives the
+ * union of all damage since its previous acquire(), even when frames were
+ * skipped in between.
+ */
+class VNCFrameExchange
+{
+public:
+    VNCFrameExchange();
+
+    /**
+     * @brief Publish the producer's current framebuffer
+     * @param source Complete decoded frame
+     * @param damage Area of @p source changed since the previous publish
+     * @param timestampUs clockUs() when the data for this frame arrived
+     * @return true if the consumer has consumed the previous frame and so
+     *         needs a new notification; false if it has yet to pick up the
+     *         last one, which this frame now replaces
+     */
+    bool publish(const QImage &source, const QRegion &damage, qint64 timestampUs = 0);
+
+    /**
+     * @brief Make the newest published frame current on the consumer side
+     * @param damage Receives the area changed since the previous acquire
+     *        (possibly slightly more)
+     * @param timestampUs Receives the arrival time of the oldest change in
+     *        the frame, for latency measurement
+     * @return false if nothing was published since the previous acquire
+     */
+    bool acquire(QRegion *damage, qint64 *timestampUs = nullptr);
+
+    // Consumer's current frame; stays valid and unchanged until acquire()
+    const QImage &frontFrame() const { return m_slots[m_front].image; }
+
+    // Monotonic clock shared by both sides, in microseconds
+    static qint64 clockUs();
+
+    // Producer-side statistics
+    quint64 publishedFrames() const { return m_published; }
+    quint64 replacedFrames() const { return m_replaced; }
+
+private:
+    struct Slot {
+        QImage image;
+        QRegion damage;     // Changes since the consumer's previous frame, or more
+        qint64 timestamp = 0;
+    };
+
+    static const int FreshFlag = 0x4;
+    static const int IndexMask = 0x3;
+
+    Slot m_slots[3];
+    std::atomic<int> m_middle;  // In-flight slot index, plus FreshFlag
+
+    // Producer only
+    int m_back;
+    QRegion m_stale[3];         // Area each slot lags behind the producer
+    QRegion m_unconsumed;       // Damage the consumer may not have seen yet
+    qint64 m_unconsumedSince;
+    quint64 m_published;
+    quint64 m_replaced;
+
+    // Consumer only
+    int m_front;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CONSOLE_VNCFRAMEEXCHANGE_H
@@ -0,0 +1,197 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VNCInputBatcher.h"
+
+#include <QtGlobal>
+
+namespace QVirt {
+
+namespace {
+
+// QWheelEvent::angleDelta() units per wheel notch
+const int WheelStep = 120;
+
+// RFB pointer buttons 4-7 are the wheel
+const int WheelUpButton = 0x08;
+const int WheelDownButton = 0x10;
+const int WheelLeftButton = 0x20;
+const int WheelRightButton = 0x40;
+
+} // namespace
+
+VNCInputBatcher::VNCInputBatcher(int motionIntervalMs)
+    : m_motionInterval(qMax(0, motionIntervalMs))
+    , m_lastMotionSent(0)
+    , m_motionSentEver(false)
+    , m_buttonMask(0)
+    , m_hasPending(false)
+    , m_wheelX(0)
+    , m_wheelY(0)
+{
+    m_pending.type = VNCInputEvent::Pointer;
+}
+
+void VNCInputBatcher::setMotionInterval(int milliseconds)
+{
+    m_motionInterval = qMax(0, milliseconds);
+}
+
+int VNCInputBatcher::motion(int x, int y, int buttonMask, qint64 nowMs)
+{
+    // A move that also changes buttons is a press/release in disguise
+    if (buttonMask != m_buttonMask) {
+        pointer(x, y, buttonMask);
+        return -1;
+    }
+
+    m_stats.pointerEvents++;
+
+    qint64 elapsed = nowMs - m_lastMotionSent;
+    if (!m_hasPending && (!m_motionSentEver || elapsed >= m_motionInterval)) {
+        // Leading edge: nothing was sent recently, so send right away
+        m_lastMotionSent = nowMs;
+        m_motionSentEver = true;
+        emitPointer(x, y, buttonMask);
+        return -1;
+    }
+
+    if (m_hasPending) {
+        m_stats.coalesced++;
+    }
+    m_hasPending = true;
+    m_pending.x = x;
+    m_pending.y = y;
+    m_pending.buttonMask = buttonMask;
+    return static_cast<int>(qMax<qint64>(0, m_motionInterval - elapsed));
+}
+
+void VNCInputBatcher::pointer(int x, int y, int buttonMask)
+{
+    m_stats.pointerEvents++;
+
+    // The event carries its own position, so a pending move is superseded
+    dropPendingMotion();
+    emitPointer(x, y, buttonMask);
+    m_buttonMask = buttonMask;
+}
+
+void VNCInputBatcher::wheel(int x, int y, int buttonMask, int deltaX, int deltaY)
+{
+    dropPendingMotion();
+    m_wheelY += deltaY;
+    emitWheelSteps(x, y, buttonMask, &m_wheelY, WheelUpButton, WheelDownButton);
+    m_wheelX += deltaX;
+    emitWheelSteps(x, y, buttonMask, &m_wheelX, WheelLeftButton, WheelRightButton);
+}
+
+void VNCInputBatcher::key(quint32 keysym, bool down)
+{
+    m_stats.keyEvents++;
+
+    // Keys may depend on where the pointer is (focus follows mouse)
+    if (m_hasPending) {
+        m_hasPending = false;
+        emitPointer(m_pending.x, m_pending.y, m_pending.buttonMask);
+    }
+
+    VNCInputEvent event;
+    event.type = VNCInputEvent::Key;
+    event.keysym = keysym;
+    event.down = down;
+    m_events.append(event);
+}
+
+void VNCInputBatcher::clipboardText(const QByteArray &latin1)
+{
+    VNCInputEvent event;
+    event.type = VNCInputEvent::ClipboardText;
+    event.text = latin1;
+    m_events.append(event);
+}
+
+void VNCInputBatcher::flushMotion(qint64 nowMs)
+{
+    if (!m_hasPending) {
+        return;
+    }
+
+    m_hasPending = false;
+    m_lastMotionSent = nowMs;
+    emitPointer(m_pending.x, m_pending.y, m_pending.buttonMask);
+}
+
+QVector<VNCInputEvent> VNCInputBatcher::takeEvents()
+{
+    QVector<VNCInputEvent> events;
+    events.swap(m_events);
+    return events;
+}
+
+void VNCInputBatcher::emitPointer(int x, int y, int buttonMask)
+{
+    VNCInputEvent event;
+    event.type = VNCInputEvent::Pointer;
+    event.x = x;
+    event.y = y;
+    event.buttonMask = buttonMask;
+    m_events.append(event);
+}
+
+void VNCInputBatcher::dropPendingMotion()
+{
+    if (m_hasPending) {
+        m_hasPending = false;
+        m_stats.coalesced++;
+    }
+}
+
+void VNCInputBatcher::emitWheelSteps(int x, int y, int buttonMask, int *accumulator,
+                                     int positiveButton, int negativeButton)
+{
+    // Each step is a press and release of the wheel button
+    while (*accumulator >= WheelStep || *accumulator <= -WheelStep) {
+        int button = *accumulator > 0 ? positiveButton : negativeButton;
+        *accumulator -= *accumulator > 0 ? WheelStep : -WheelStep;
+        emitPointer(x, y, buttonMask | button);
+        emitPointer(x, y, buttonMask);
+        m_stats.wheelSteps++;
+    }
+}
+
+int VNCInputBatcher::collapseMotion(QVector<VNCInputEvent> *events, int *lastButtonMask)
+{
+    int kept = 0;
+    for (int i = 0; i < events->size(); ++i) {
+        const VNCInputEvent &input = events->at(i);
+        if (input.type == VNCInputEvent::Pointer) {
+            // Motion directly followed by more motion with the same buttons
+            // is stale by the time it would reach the server
+            bool transition = input.buttonMask != *lastButtonMask;
+            *lastButtonMask = input.buttonMask;
+            if (!transition && i + 1 < events->size() &&
+                events->at(i + 1).type == VNCInputEvent::Pointer &&
+                events->at(i + 1).buttonMask == input.buttonMask) {
+                continue;
+            }
+        }
+        if (kept != i) {
+            (*events)[kept] = input;
+        }
+        kept++;
+    }
+
+    int dropped = events->size() - kept;
+    events->resize(kept);
+    return dropped;
+}
+
+} // namespace QVirt
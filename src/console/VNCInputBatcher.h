@@ -0,0 +1,139 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CONSOLE_VNCINPUTBATCHER_H
+#define QVIRT_CONSOLE_VNCINPUTBATCHER_H
+
+#include <QByteArray>
+#include <QVector>
+
+namespace QVirt {
+
+/**
+ * @brief One RFB input message queued for a VNC session
+ */
+struct VNCInputEvent
+{
+    enum Type {
+        Key,
+        Pointer,
+        ClipboardText
+    };
+
+    Type type = Key;
+    quint32 keysym = 0;
+    bool down = false;
+    int x = 0;
+    int y = 0;
+    int buttonMask = 0;
+    QByteArray text;        // Latin-1, for ClipboardText
+};
+
+/**
+ * @brief Input counters of one console
+ */
+struct VNCInputStats
+{
+    quint64 pointerEvents = 0;  // Motion and button events from the UI
+    quint64 keyEvents = 0;
+    quint64 wheelSteps = 0;
+    quint64 coalesced = 0;      // Pointer events merged into a later one
+    quint64 dropped = 0;        // Lost because the input queue was full
+    quint64 sent = 0;           // Input messages written to the server
+};
+
+/**
+ * @brief Turns raw UI input into a lean stream of RFB input messages
+ *
+ * Pointer motion is rate limited to one message per motion interval: the
+ * first move after a quiet period goes out at once, later ones only update
+ * a pending position that is sent when the interval expires. Anything that
+ * must not be reordered or lost (button changes, wheel steps, keys) first
+ * resolves the pending motion, so the server always sees presses at the
+ * right place and in the right order.
+ *
+ * Wheel deltas are accumulated so high-resolution wheels and touchpads
+ * produce whole RFB wheel steps instead of one click per tiny delta.
+ *
+ * The batcher does no I/O; callers drain takeEvents() after feeding it.
+ */
+class VNCInputBatcher
+{
+public:
+    // One frame at 60 Hz
+    static const int DefaultMotionInterval = 16;
+
+    explicit VNCInputBatcher(int motionIntervalMs = DefaultMotionInterval);
+
+    int motionInterval() const { return m_motionInterval; }
+    void setMotionInterval(int milliseconds);
+
+    /**
+     * @brief Pointer moved
+     * @return Milliseconds after which flushMotion() must be called to send
+     *         a pending position, or -1 if nothing is pending
+     */
+    int motion(int x, int y, int buttonMask, qint64 nowMs);
+
+    // Button press/release or explicit pointer event; never coalesced
+    void pointer(int x, int y, int buttonMask);
+
+    // Wheel rotation in eighths of a degree, as QWheelEvent::angleDelta()
+    void wheel(int x, int y, int buttonMask, int deltaX, int deltaY);
+
+    void key(quint32 keysym, bool down);
+    void clipboardText(const QByteArray &latin1);
+
+    // Send the pending position, if any
+    void flushMotion(qint64 nowMs);
+    bool hasPendingMotion() const { return m_hasPending; }
+
+    // Messages produced since the previous call, in order
+    QVector<VNCInputEvent> takeEvents();
+
+    const VNCInputStats &stats() const { return m_stats; }
+
+    /**
+     * @brief Collapse motion that piled up in a queue before it is sent
+     *
+     * Drops a pointer event only if it is pure motion (its buttons match
+     * @p lastButtonMask, the state the server last saw) and the next
+     * event is motion with the same buttons; presses and releases always
+     * survive. @p lastButtonMask is updated to the state after the batch.
+     *
+     * @return Number of events dropped
+     */
+    static int collapseMotion(QVector<VNCInputEvent> *events, int *lastButtonMask);
+
+private:
+    void emitPointer(int x, int y, int buttonMask);
+    void dropPendingMotion();
+    void emitWheelSteps(int x, int y, int buttonMask, int *accumulator,
+                        int positiveButton, int negativeButton);
+
+    int m_motionInterval;
+    qint64 m_lastMotionSent;
+    bool m_motionSentEver;
+    int m_buttonMask;           // Last button state sent
+
+    bool m_hasPending;
+    VNCInputEvent m_pending;
+
+    int m_wheelX;               // Accumulated, not yet sent wheel deltas
+    int m_wheelY;
+
+    QVector<VNCInputEvent> m_events;
+    VNCInputStats m_stats;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CONSOLE_VNCINPUTBATCHER_H
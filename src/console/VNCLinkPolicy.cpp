@@ -0,0 +1,163 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VNCLinkPolicy.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace QVirt {
+
+namespace {
+
+// Weight of a new sample in the moving averages
+const double SmoothingFactor = 0.25;
+
+// Tier limits: round-trip time up to, and throughput at least
+const double LanRttMs = 10.0;
+const double BroadbandRttMs = 40.0;
+const double WanRttMs = 120.0;
+const double LanKbps = 50000.0;
+const double BroadbandKbps = 8000.0;
+const double WanKbps = 1500.0;
+
+QMutex s_rememberedMutex;
+QHash<QString, int> s_remembered;
+
+double smooth(double average, double sample)
+{
+    return average < 0 ? sample : average + SmoothingFactor * (sample - average);
+}
+
+} // namespace
+
+VNCLinkPolicy::VNCLinkPolicy(Tier initial)
+    : m_tier(initial)
+    , m_candidate(initial)
+    , m_candidateSince(0)
+    , m_rttMs(-1.0)
+    , m_throughputKbps(-1.0)
+{
+}
+
+void VNCLinkPolicy::addRttSample(double rttMs)
+{
+    if (rttMs >= 0) {
+        m_rttMs = smooth(m_rttMs, rttMs);
+    }
+}
+
+void VNCLinkPolicy::addBurstSample(qint64 bytes, double durationMs)
+{
+    if (bytes < MinBurstBytes || durationMs <= 0) {
+        return;
+    }
+    m_throughputKbps = smooth(m_throughputKbps, bytes * 8.0 / durationMs);
+}
+
+bool VNCLinkPolicy::update(qint64 nowMs)
+{
+    if (m_rttMs < 0 && m_throughputKbps < 0) {
+        return false;
+    }
+
+    Tier indicated = tierFor(m_rttMs, m_throughputKbps);
+    if (indicated == m_tier) {
+        m_candidate = m_tier;
+        return false;
+    }
+
+    if (indicated != m_candidate) {
+        m_candidate = indicated;
+        m_candidateSince = nowMs;
+        return false;
+    }
+
+    qint64 delay = indicated > m_tier ? DowngradeDelayMs : UpgradeDelayMs;
+    if (nowMs - m_candidateSince < delay) {
+        return false;
+    }
+
+    m_tier = indicated;
+    return true;
+}
+
+VNCLinkPolicy::Tier VNCLinkPolicy::tierFor(double rttMs, double throughputKbps)
+{
+    Tier tier = LanTier;
+    if (rttMs >= 0) {
+        if (rttMs > WanRttMs) {
+            tier = SlowTier;
+        } else if (rttMs > BroadbandRttMs) {
+            tier = WanTier;
+        } else if (rttMs > LanRttMs) {
+            tier = BroadbandTier;
+        }
+    }
+
+    // A measured burst rate can only make things worse: a short RTT says
+    // nothing about a thin pipe, while a fast burst on a long link is still
+    // a long link for interactive use
+    if (throughputKbps >= 0) {
+        Tier byRate = throughputKbps >= LanKbps ? LanTier
+                    : throughputKbps >= BroadbandKbps ? BroadbandTier
+                    : throughputKbps >= WanKbps ? WanTier
+                    : SlowTier;
+        tier = qMax(tier, byRate);
+    }
+    return tier;
+}
+
+VNCLinkPolicy::Settings VNCLinkPolicy::settingsFor(Tier tier)
+{
+    switch (tier) {
+    case LanTier:
+        // Lossless and cheap to encode; bandwidth is not the bottleneck
+        return { "copyrect zrle hextile zlib raw", 9, 1, false, false };
+    case BroadbandTier:
+        return { "copyrect tight zrle hextile zlib raw", 8, 3, true, false };
+    case WanTier:
+        return { "copyrect tight zrle zlib hextile raw", 6, 6, true, false };
+    case SlowTier:
+        return { "copyrect tight zrle zlib hextile raw", 3, 9, true, true };
+    }
+    return settingsFor(LanTier);
+}
+
+QString VNCLinkPolicy::tierName(Tier tier)
+{
+    switch (tier) {
+    case LanTier:
+        return QStringLiteral("LAN");
+    case BroadbandTier:
+        return QStringLiteral("Broadband");
+    case WanTier:
+        return QStringLiteral("WAN");
+    case SlowTier:
+        return QStringLiteral("Slow link");
+    }
+    return QString();
+}
+
+VNCLinkPolicy::Tier VNCLinkPolicy::rememberedTier(const QString &display, Tier fallback)
+{
+    QMutexLocker locker(&s_rememberedMutex);
+    return static_cast<Tier>(s_remembered.value(display, fallback));
+}
+
+void VNCLinkPolicy::rememberTier(const QString &display, Tier tier)
+{
+    QMutexLocker locker(&s_rememberedMutex);
+    s_remembered.insert(display, tier);
+}
+
+} // namespace QVirt
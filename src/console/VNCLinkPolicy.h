@@ -0,0 +1,96 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CONSOLE_VNCLINKPOLICY_H
+#define QVIRT_CONSOLE_VNCLINKPOLICY_H
+
+#include <QString>
+
+namespace QVirt {
+
+/**
+ * @brief Link estimation and encoding choice for one VNC session
+ *
+ * Tracks a smoothed round-trip time and the throughput seen while the
+ * server was actually streaming an update (an idle screen says nothing
+ * about the link, so quiet periods are ignored). From these it picks a
+ * quality tier; each tier maps to an encoding list, JPEG quality, zlib
+ * compression level and colour depth.
+ *
+ * Tier changes have hysteresis: a worse tier must be indicated for
+ * DowngradeDelayMs and a better one for UpgradeDelayMs before the policy
+ * switches, so a single slow update or a burst of fast ones does not make
+ * the session flap between settings (each switch costs a full refresh).
+ */
+class VNCLinkPolicy
+{
+public:
+    enum Tier {
+        LanTier,
+        BroadbandTier,
+        WanTier,
+        SlowTier
+    };
+
+    struct Settings {
+        const char *encodings;  // libvncclient encodingsString
+        int qualityLevel;       // JPEG quality, 0-9
+        int compressLevel;      // zlib level, 0-9
+        bool enableJPEG;
+        bool lowColour;         // 16 bits per pixel
+    };
+
+    static const int DowngradeDelayMs = 2000;
+    static const int UpgradeDelayMs = 6000;
+
+    // Smallest update burst that counts as a throughput measurement
+    static const qint64 MinBurstBytes = 64 * 1024;
+
+    explicit VNCLinkPolicy(Tier initial = LanTier);
+
+    // Round-trip time measurement, e.g. from TCP_INFO
+    void addRttSample(double rttMs);
+
+    // @p bytes received over @p durationMs while an update was streaming
+    void addBurstSample(qint64 bytes, double durationMs);
+
+    /**
+     * @brief Re-evaluate the tier
+     * @return true if the tier changed
+     */
+    bool update(qint64 nowMs);
+
+    Tier tier() const { return m_tier; }
+    double rttMs() const { return m_rttMs; }                // < 0 if unknown
+    double throughputKbps() const { return m_throughputKbps; }  // < 0 if unknown
+
+    static Settings settingsFor(Tier tier);
+    static QString tierName(Tier tier);
+
+    // Tier the link measurements point to, ignoring hysteresis
+    static Tier tierFor(double rttMs, double throughputKbps);
+
+    // Last tier seen per display ("host:port"), used to pick the colour
+    // depth at connect time since it cannot change mid-session
+    static Tier rememberedTier(const QString &display, Tier fallback = LanTier);
+    static void rememberTier(const QString &display, Tier tier);
+
+private:
+    Tier m_tier;
+    Tier m_candidate;
+    qint64 m_candidateSince;
+    double m_rttMs;
+    double m_throughputKbps;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CONSOLE_VNCLINKPOLICY_H
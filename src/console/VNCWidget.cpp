@@ -10,9 +10,12 @@
  */
 
 #include "VNCWidget.h"
+#include "VNCClientThread.h"
 #include <QPainter>
-#include <QVBoxLayout>
+#include <QFontMetrics>
+#include <QPaintEvent>
 #include <QKeyEvent>
+#include <QTimer>
 
 #ifdef LIBVNCCLIENT_FOUND
 #include <rfb/rfbclient.h>
@@ -20,15 +23,33 @@
 
 namespace QVirt {
 
+namespace {
+
+const QColor BackgroundColor(0x1a, 0x1a, 0x1a);
+const QColor PlaceholderColor(0x88, 0x88, 0x88);
+const QColor OverlayColor(0, 0, 0, 160);
+
+// Overlay distance from the widget corner, and inner padding
+const int OverlayMargin = 8;
+const int OverlayPadding = 6;
+
+// Bounds of the round-trip-driven pointer motion interval
+const int MaxMotionInterval = 100;
+
+} // namespace
+
 VNCWidget::VNCWidget(QWidget *parent)
     : QWidget(parent)
-    , m_displayLabel(nullptr)
     , m_port(5900)
     , m_connected(false)
     , m_scalingEnabled(true)
-#ifdef LIBVNCCLIENT_FOUND
-    , m_client(nullptr)
-#endif
+    , m_thread(nullptr)
+    , m_motionTimer(nullptr)
+    , m_droppedInput(0)
+    , m_motionIntervalSetting(0)
+    , m_windowFrames(0)
+    , m_windowLatencyUs(0)
+    , m_statsOverlay(false)
 {
     setupUI();
 }
@@ -40,17 +61,18 @@ VNCWidget::~VNCWidget()
 
 void VNCWidget::setupUI()
 {
-    auto layout = new QVBoxLayout(this);
-    layout->setContentsMargins(0, 0, 0, 0);
+    setMinimumSize(640, 480);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFocusPolicy(Qt::StrongFocus);
+    setMouseTracking(true);
 
-    m_displayLabel = new QLabel(this);
-    m_displayLabel->setAlignment(Qt::AlignCenter);
-    m_displayLabel->setMinimumSize(640, 480);
-    m_displayLabel->setStyleSheet("QLabel { background-color: #1a1a1a; color: #888; }");
-    m_displayLabel->setText(tr("VNC Console\n\nClick 'Connect' to start the VNC session"));
-    layout->addWidget(m_displayLabel);
+    m_motionTimer = new QTimer(this);
+    m_motionTimer->setSingleShot(true);
+    m_motionTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_motionTimer, &QTimer::timeout, this, &VNCWidget::flushMotion);
+    m_inputClock.start();
 
-    setFocusPolicy(Qt::StrongFocus);
+    m_statusText = tr("VNC Console\n\nClick 'Connect' to start the VNC session");
 }
 
 void VNCWidget::connectToServer(const QString &host, int port, const QString &password)
@@ -60,24 +82,28 @@ void VNCWidget::connectToServer(const QString &host, int port, const QString &pa
     m_password = password;
 
 #ifdef LIBVNCCLIENT_FOUND
-    m_client = rfbGetClient(8, 3, 4);
-    if (!m_client) {
-        emit connectionError(tr("Failed to initialize VNC client"));
-        return;
-    }
-
-    m_client->frameBuffer = m_host.toUtf8().data();
-    m_client->serverPort = m_port;
-    m_client->clientData = this;
-
-    if (!rfbInitClient(m_client, nullptr, nullptr)) {
-        emit connectionError(tr("Failed to connect to VNC server"));
-        m_client = nullptr;
-        return;
+    if (m_thread) {
+        disconnect();
     }
 
-    m_connected = true;
-    emit connected();
+    m_thread = new VNCClientThread(m_host, m_port, m_password);
+    connect(m_thread, &VNCClientThread::connected, this, &VNCWidget::onConnected);
+    connect(m_thread, &VNCClientThread::connectionError, this, &VNCWidget::onConnectionFailed);
+    connect(m_thread, &VNCClientThread::frameReady, this, &VNCWidget::updateFramebuffer);
+    connect(m_thread, &VNCClientThread::bell, this, &VNCWidget::bell);
+    connect(m_thread, &VNCClientThread::clipboardReceived, this, &VNCWidget::clipboardReceived);
+    connect(m_thread, &VNCClientThread::linkStatsUpdated, this, &VNCWidget::onLinkStats);
+    m_thread->start();
+    m_input = VNCInputBatcher(m_motionIntervalSetting > 0 ? m_motionIntervalSetting
+                                                          : VNCInputBatcher::DefaultMotionInterval);
+    m_droppedInput = 0;
+    m_sessionStats = VNCSessionStats();
+    m_windowFrames = 0;
+    m_windowLatencyUs = 0;
+    m_statsWindow.start();
+
+    m_statusText = tr("VNC Console\n\nConnecting to %1:%2...").arg(m_host).arg(m_port);
+    update();
 #else
     Q_UNUSED(password);
     emit connectionError(tr("VNC support not available - libvncclient not found"));
@@ -86,55 +112,110 @@ void VNCWidget::connectToServer(const QString &host, int port, const QString &pa
 
 void VNCWidget::disconnect()
 {
-#ifdef LIBVNCCLIENT_FOUND
-    if (m_client) {
-        rfbClientCleanup(m_client);
-        m_client = nullptr;
+    if (m_thread) {
+        // Let the session wind down on its own thread (it may still be
+        // inside a blocking connect) and free it once it has finished
+        QObject::disconnect(m_thread, nullptr, this, nullptr);
+        connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+        m_thread->requestInterruption();
+        if (m_thread->isFinished()) {
+            m_thread->deleteLater();
+        }
+        m_thread = nullptr;
     }
-#endif
+
+    m_motionTimer->stop();
+    m_sessionStats = VNCSessionStats();
+    m_overlayText.clear();
+    m_overlayRect = QRect();
     m_connected = false;
-    m_framebuffer = QImage();
-    m_scaledFramebuffer = QImage();
-    m_displayLabel->clear();
-    m_displayLabel->setText(tr("VNC Console\n\nDisconnected"));
+    m_frameSize = QSize();
+    m_statusText = tr("VNC Console\n\nDisconnected");
+    updateScaling();
     emit disconnected();
 }
 
+QImage VNCWidget::framebuffer() const
+{
+    return frame().copy();
+}
+
+const QImage &VNCWidget::frame() const
+{
+    static const QImage noFrame;
+    return m_thread ? m_thread->frames()->frontFrame() : noFrame;
+}
+
 void VNCWidget::sendKeyEvent(int key, bool pressed)
 {
-#ifdef LIBVNCCLIENT_FOUND
-    if (m_client && m_connected) {
-        int rfbKey = keyToRFBCode(key);
-        SendKeyEvent(m_client, rfbKey, pressed ? 1 : 0);
+    if (m_thread && m_connected) {
+        m_input.key(static_cast<quint32>(keyToRFBCode(key)), pressed);
+        postInput();
     }
-#else
-    Q_UNUSED(key);
-    Q_UNUSED(pressed);
-#endif
 }
 
 void VNCWidget::sendPointerEvent(int x, int y, int buttonMask)
 {
-#ifdef LIBVNCCLIENT_FOUND
-    if (m_client && m_connected) {
-        SendPointerEvent(m_client, x, y, buttonMask);
+    if (m_thread && m_connected) {
+        m_input.pointer(x, y, buttonMask);
+        postInput();
     }
-#else
-    Q_UNUSED(x);
-    Q_UNUSED(y);
-    Q_UNUSED(buttonMask);
-#endif
 }
 
 void VNCWidget::sendClipboardText(const QString &text)
 {
-#ifdef LIBVNCCLIENT_FOUND
-    if (m_client && m_connected) {
-        SendClientCutText(m_client, text.toUtf8().data(), text.length());
+    if (m_thread && m_connected) {
+        // RFB cut text is Latin-1
+        m_input.clipboardText(text.toLatin1());
+        postInput();
+    }
+}
+
+VNCInputStats VNCWidget::inputStats() const
+{
+    VNCInputStats stats = m_input.stats();
+    stats.dropped = m_droppedInput;
+    if (m_thread) {
+        stats.coalesced += m_thread->coalescedEvents();
+        stats.sent = m_thread->sentEvents();
+    }
+    return stats;
+}
+
+void VNCWidget::setMotionInterval(int milliseconds)
+{
+    m_motionIntervalSetting = qMax(0, milliseconds);
+    m_input.setMotionInterval(m_motionIntervalSetting > 0 ? m_motionIntervalSetting
+                                                          : VNCInputBatcher::DefaultMotionInterval);
+}
+
+void VNCWidget::setStatsOverlayVisible(bool visible)
+{
+    if (m_statsOverlay != visible) {
+        m_statsOverlay = visible;
+        updateOverlay();
+    }
+}
+
+void VNCWidget::postInput()
+{
+    const QVector<VNCInputEvent> events = m_input.takeEvents();
+    if (!m_thread) {
+        return;
+    }
+    for (const VNCInputEvent &event : events) {
+        if (!m_thread->postEvent(event)) {
+            m_droppedInput++;
+        }
+    }
+}
+
+void VNCWidget::flushMotion()
+{
+    if (m_thread && m_connected) {
+        m_input.flushMotion(m_inputClock.elapsed());
+        postInput();
     }
-#else
-    Q_UNUSED(text);
-#endif
 }
 
 void VNCWidget::setScalingEnabled(bool enabled)
@@ -147,7 +228,47 @@ void VNCWidget::setScalingEnabled(bool enabled)
 
 void VNCWidget::paintEvent(QPaintEvent *event)
 {
-    QWidget::paintEvent(event);
+    QPainter painter(this);
+    const QImage &image = frame();
+
+    if (image.isNull()) {
+        painter.fillRect(event->rect(), BackgroundColor);
+        painter.setPen(PlaceholderColor);
+        painter.drawText(rect(), Qt::AlignCenter, m_statusText);
+        return;
+    }
+
+    // Letterbox around the remote screen
+    const QRegion bars = event->region().subtracted(QRegion(m_targetRect));
+    for (const QRect &rect : bars) {
+        painter.fillRect(rect, BackgroundColor);
+    }
+
+    // Draw only the exposed part of the framebuffer, straight from the
+    // decoded image into its place in the target rectangle
+    const QRegion exposed = event->region().intersected(m_targetRect);
+    const bool scaled = m_targetRect.size() != image.size();
+    if (scaled) {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    }
+
+    const qreal sx = qreal(image.width()) / m_targetRect.width();
+    const qreal sy = qreal(image.height()) / m_targetRect.height();
+    for (const QRect &rect : exposed) {
+        if (scaled) {
+            QRectF source((rect.x() - m_targetRect.x()) * sx,
+                          (rect.y() - m_targetRect.y()) * sy,
+                          rect.width() * sx, rect.height() * sy);
+            painter.drawImage(QRectF(rect), image, source);
+        } else {
+            painter.drawImage(rect.topLeft(), image,
+                              rect.translated(-m_targetRect.topLeft()));
+        }
+    }
+
+    if (m_statsOverlay && event->region().intersects(m_overlayRect)) {
+        paintOverlay(&painter);
+    }
 }
 
 void VNCWidget::resizeEvent(QResizeEvent *event)
@@ -175,11 +296,8 @@ void VNCWidget::keyReleaseEvent(QKeyEvent *event)
 void VNCWidget::mousePressEvent(QMouseEvent *event)
 {
     if (m_connected) {
-        int buttonMask = 0;
-        if (event->buttons() & Qt::LeftButton) buttonMask |= 0x01;
-        if (event->buttons() & Qt::MiddleButton) buttonMask |= 0x02;
-        if (event->buttons() & Qt::RightButton) buttonMask |= 0x04;
-        sendPointerEvent(event->pos().x(), event->pos().y(), buttonMask);
+        QPoint pos = mapToFramebuffer(event->pos());
+        sendPointerEvent(pos.x(), pos.y(), buttonMask(event->buttons()));
     }
     QWidget::mousePressEvent(event);
 }
@@ -187,35 +305,37 @@ void VNCWidget::mousePressEvent(QMouseEvent *event)
 void VNCWidget::mouseReleaseEvent(QMouseEvent *event)
 {
     if (m_connected) {
-        sendPointerEvent(event->pos().x(), event->pos().y(), 0);
+        QPoint pos = mapToFramebuffer(event->pos());
+        sendPointerEvent(pos.x(), pos.y(), buttonMask(event->buttons()));
     }
     QWidget::mouseReleaseEvent(event);
 }
 
 void VNCWidget::mouseMoveEvent(QMouseEvent *event)
 {
-    if (m_connected) {
-        int buttonMask = 0;
-        if (event->buttons() & Qt::LeftButton) buttonMask |= 0x01;
-        if (event->buttons() & Qt::MiddleButton) buttonMask |= 0x02;
-        if (event->buttons() & Qt::RightButton) buttonMask |= 0x04;
-        sendPointerEvent(event->pos().x(), event->pos().y(), buttonMask);
+    if (m_thread && m_connected) {
+        QPoint pos = mapToFramebuffer(event->pos());
+        int delay = m_input.motion(pos.x(), pos.y(), buttonMask(event->buttons()),
+                                   m_inputClock.elapsed());
+        postInput();
+        if (delay >= 0 && !m_motionTimer->isActive()) {
+            m_motionTimer->start(delay);
+        }
     }
     QWidget::mouseMoveEvent(event);
 }
 
 void VNCWidget::wheelEvent(QWheelEvent *event)
 {
-    if (m_connected) {
-#ifdef LIBVNCCLIENT_FOUND
-        if (event->angleDelta().y() > 0) {
-            SendPointerEvent(m_client, event->pos().x(), event->pos().y(), 0x08);
-            SendPointerEvent(m_client, event->pos().x(), event->pos().y(), 0);
-        } else {
-            SendPointerEvent(m_client, event->pos().x(), event->pos().y(), 0x10);
-            SendPointerEvent(m_client, event->pos().x(), event->pos().y(), 0);
-        }
+    if (m_thread && m_connected) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QPoint pos = mapToFramebuffer(event->position().toPoint());
+#else
+        QPoint pos = mapToFramebuffer(event->pos());
 #endif
+        m_input.wheel(pos.x(), pos.y(), buttonMask(event->buttons()),
+                      event->angleDelta().x(), event->angleDelta().y());
+        postInput();
     }
     QWidget::wheelEvent(event);
 }
@@ -232,32 +352,159 @@ void VNCWidget::focusOutEvent(QFocusEvent *event)
 
 void VNCWidget::updateFramebuffer()
 {
-#ifdef LIBVNCCLIENT_FOUND
-    if (m_client && m_connected) {
-        // Update framebuffer from VNC client
-        // This would be called by the VNC client callback
+    if (!m_thread) {
+        return;
+    }
+
+    QRegion damage;
+    qint64 arrivalUs = 0;
+    if (!m_thread->frames()->acquire(&damage, &arrivalUs)) {
+        return;
+    }
+    m_windowFrames++;
+    m_windowLatencyUs += VNCFrameExchange::clockUs() - arrivalUs;
+
+    const QSize size = frame().size();
+    if (size != m_frameSize) {
+        // First frame or desktop resize
+        m_frameSize = size;
+        updateScaling();
+        return;
+    }
+
+    QRegion widgetRegion;
+    for (const QRect &rect : damage) {
+        widgetRegion += mapFromFramebuffer(rect);
+    }
+    update(widgetRegion);
+}
+
+void VNCWidget::onLinkStats(double kbps, double rttMs, const QString &tier)
+{
+    const qint64 elapsed = m_statsWindow.restart();
+    m_sessionStats.fps = elapsed > 0 ? m_windowFrames * 1000.0 / elapsed : 0.0;
+    m_sessionStats.updateLatencyMs = m_windowFrames > 0
+        ? m_windowLatencyUs / 1000.0 / m_windowFrames : 0.0;
+    m_sessionStats.kbps = kbps;
+    m_sessionStats.rttMs = rttMs;
+    m_sessionStats.tier = tier;
+    m_windowFrames = 0;
+    m_windowLatencyUs = 0;
+
+    // Sending motion faster than the link turns around only queues it up
+    if (m_motionIntervalSetting == 0 && rttMs >= 0) {
+        m_input.setMotionInterval(qBound(VNCInputBatcher::DefaultMotionInterval,
+                                         qRound(rttMs), MaxMotionInterval));
+    }
+
+    if (m_statsOverlay) {
+        updateOverlay();
     }
-#endif
 }
 
-void VNCWidget::onConnectionFailed()
+void VNCWidget::updateOverlay()
+{
+    const QRect previous = m_overlayRect;
+
+    if (m_statsOverlay && m_connected) {
+        const VNCSessionStats &stats = m_sessionStats;
+        QString rtt = stats.rttMs >= 0 ? tr("%1 ms").arg(stats.rttMs, 0, 'f', 0) : tr("n/a");
+        m_overlayText = tr("%1 fps, %2 kbit/s\nRTT %3, update %4 ms\n%5")
+            .arg(stats.fps, 0, 'f', 1)
+            .arg(stats.kbps, 0, 'f', 0)
+            .arg(rtt)
+            .arg(stats.updateLatencyMs, 0, 'f', 1)
+            .arg(stats.tier);
+
+        QFontMetrics fm(font());
+        QRect text = fm.boundingRect(QRect(0, 0, width(), height()),
+                                     Qt::AlignLeft | Qt::AlignTop, m_overlayText);
+        m_overlayRect = text.translated(OverlayMargin + OverlayPadding,
+                                        OverlayMargin + OverlayPadding)
+                            .adjusted(-OverlayPadding, -OverlayPadding,
+                                      OverlayPadding, OverlayPadding);
+    } else {
+        m_overlayText.clear();
+        m_overlayRect = QRect();
+    }
+
+    update(previous.united(m_overlayRect));
+}
+
+void VNCWidget::paintOverlay(QPainter *painter)
+{
+    painter->fillRect(m_overlayRect, OverlayColor);
+    painter->setPen(Qt::white);
+    painter->drawText(m_overlayRect.adjusted(OverlayPadding, OverlayPadding,
+                                             -OverlayPadding, -OverlayPadding),
+                      Qt::AlignLeft | Qt::AlignTop, m_overlayText);
+}
+
+void VNCWidget::onConnected()
+{
+    m_connected = true;
+    emit connected();
+}
+
+void VNCWidget::onConnectionFailed(const QString &error)
 {
     disconnect();
-    emit connectionError(tr("Connection failed"));
+    emit connectionError(error);
 }
 
 void VNCWidget::updateScaling()
 {
-    if (m_scalingEnabled && !m_framebuffer.isNull()) {
-        m_scaledFramebuffer = m_framebuffer.scaled(
-            m_displayLabel->size(),
-            Qt::KeepAspectRatio,
-            Qt::SmoothTransformation
-        );
-        m_displayLabel->setPixmap(QPixmap::fromImage(m_scaledFramebuffer));
-    } else if (!m_framebuffer.isNull()) {
-        m_displayLabel->setPixmap(QPixmap::fromImage(m_framebuffer));
+    m_targetRect = targetRect();
+    update();
+}
+
+QRect VNCWidget::targetRect() const
+{
+    if (m_frameSize.isEmpty()) {
+        return QRect();
     }
+
+    QSize size = m_frameSize;
+    if (m_scalingEnabled) {
+        size.scale(this->size(), Qt::KeepAspectRatio);
+    }
+    return QRect(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+}
+
+QRect VNCWidget::mapFromFramebuffer(const QRect &rect) const
+{
+    if (m_targetRect.size() == m_frameSize) {
+        return rect.translated(m_targetRect.topLeft());
+    }
+
+    const qreal sx = qreal(m_targetRect.width()) / m_frameSize.width();
+    const qreal sy = qreal(m_targetRect.height()) / m_frameSize.height();
+    QRectF mapped(m_targetRect.x() + rect.x() * sx, m_targetRect.y() + rect.y() * sy,
+                  rect.width() * sx, rect.height() * sy);
+
+    // Grow by a pixel for the bleed of smooth scaling
+    return mapped.toAlignedRect().adjusted(-1, -1, 1, 1).intersected(m_targetRect);
+}
+
+QPoint VNCWidget::mapToFramebuffer(const QPoint &pos) const
+{
+    if (m_targetRect.isEmpty()) {
+        return pos;
+    }
+
+    int x = (pos.x() - m_targetRect.x()) * m_frameSize.width() / m_targetRect.width();
+    int y = (pos.y() - m_targetRect.y()) * m_frameSize.height() / m_targetRect.height();
+    return QPoint(qBound(0, x, m_frameSize.width() - 1),
+                  qBound(0, y, m_frameSize.height() - 1));
+}
+
+int VNCWidget::buttonMask(Qt::MouseButtons buttons)
+{
+    int mask = 0;
+    if (buttons & Qt::LeftButton) mask |= 0x01;
+    if (buttons & Qt::MiddleButton) mask |= 0x02;
+    if (buttons & Qt::RightButton) mask |= 0x04;
+    return mask;
 }
 
 int VNCWidget::keyToRFBCode(int qtKey)
@@ -13,20 +13,45 @@
 #define QVIRT_CONSOLE_VNCWIDGET_H
 
 #include <QWidget>
-#include <QLabel>
 #include <QImage>
-#include <QPointer>
+#include <QElapsedTimer>
 
-#ifdef LIBVNCCLIENT_FOUND
-#include <rfb/rfbclient.h>
-#endif
+#include "VNCInputBatcher.h"
+
+class QTimer;
+class QPainter;
 
 namespace QVirt {
 
+class VNCClientThread;
+
+/**
+ * @brief Live statistics of one console session
+ */
+struct VNCSessionStats
+{
+    double fps = 0.0;               // Frames taken over by the widget
+    double kbps = 0.0;              // Data received from the server
+    double rttMs = -1.0;            // Smoothed round-trip time, < 0 if unknown
+    double updateLatencyMs = 0.0;   // Data arrival to frame handoff
+    QString tier;                   // Active encoding tier
+};
+
 /**
  * @brief Integrated VNC viewer widget
  *
- * Provides VNC console functionality without external dependencies
+ * Provides VNC console functionality without external dependencies.
+ * The RFB session runs on a VNCClientThread; the widget only queues input
+ * to it and paints the frames it publishes. Input goes through a
+ * VNCInputBatcher first, so pointer motion costs at most one message per
+ * motion interval however fast the mouse reports.
+ *
+ * Encoding settings follow the measured link (see VNCLinkPolicy), and an
+ * optional overlay shows frame rate, data rate, round-trip time and update
+ * latency. Each frame handoff schedules a
+ * repaint of just the rectangles that changed, and paintEvent() draws the
+ * exposed part of the frame into the (optionally scaled) target rectangle
+ * without making a scaled copy.
  */
 class VNCWidget : public QWidget
 {
@@ -47,7 +72,21 @@ public:
     void sendPointerEvent(int x, int y, int buttonMask);
     void sendClipboardText(const QString &text);
 
-    QImage framebuffer() const { return m_framebuffer; }
+    // Input pipeline counters for the current session
+    VNCInputStats inputStats() const;
+
+    // Minimum spacing of pointer motion messages; button, wheel and key
+    // events are never delayed. 0 (the default) follows the round-trip time
+    int motionInterval() const { return m_input.motionInterval(); }
+    void setMotionInterval(int milliseconds);
+
+    VNCSessionStats sessionStats() const { return m_sessionStats; }
+    bool isStatsOverlayVisible() const { return m_statsOverlay; }
+    void setStatsOverlayVisible(bool visible);
+
+    // Deep copy of the current remote screen
+    QImage framebuffer() const;
+    QSize framebufferSize() const { return frame().size(); }
     void setScalingEnabled(bool enabled);
     bool isScalingEnabled() const { return m_scalingEnabled; }
 
@@ -72,25 +111,54 @@ protected:
 
 private slots:
     void updateFramebuffer();
-    void onConnectionFailed();
+    void onConnected();
+    void onConnectionFailed(const QString &error);
+    void flushMotion();
+    void onLinkStats(double kbps, double rttMs, const QString &tier);
 
 private:
     void setupUI();
     void updateScaling();
     int keyToRFBCode(int qtKey);
+    void postInput();
+    void updateOverlay();
+    void paintOverlay(QPainter *painter);
+
+    // Current frame, owned by the client thread's frame exchange
+    const QImage &frame() const;
+
+    // Framebuffer <-> widget coordinate mapping for the current scaling
+    QRect targetRect() const;
+    QRect mapFromFramebuffer(const QRect &rect) const;
+    QPoint mapToFramebuffer(const QPoint &pos) const;
+    static int buttonMask(Qt::MouseButtons buttons);
 
-    QLabel *m_displayLabel;
     QString m_host;
     int m_port;
     QString m_password;
     bool m_connected;
     bool m_scalingEnabled;
-    QImage m_framebuffer;
-    QImage m_scaledFramebuffer;
-
-#ifdef LIBVNCCLIENT_FOUND
-    rfbClient *m_client;
-#endif
+    QString m_statusText;
+
+    VNCClientThread *m_thread;
+    QSize m_frameSize;          // Size of the last acquired frame
+    QRect m_targetRect;         // Widget coordinates, cached by updateScaling()
+
+    // Input pipeline
+    VNCInputBatcher m_input;
+    QTimer *m_motionTimer;      // Sends the pending pointer position
+    QElapsedTimer m_inputClock;
+    quint64 m_droppedInput;
+    int m_motionIntervalSetting;    // 0 = follow the round-trip time
+
+    // Statistics and overlay
+    VNCSessionStats m_sessionStats;
+    QElapsedTimer m_statsWindow;
+    int m_windowFrames;
+    qint64 m_windowLatencyUs;
+    bool m_statsOverlay;
+    QString m_overlayText;
+    QRect m_overlayRect;
 };
 
 } // namespace QVirt
@@ -0,0 +1,40 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ByteFormat.h"
+
+namespace QVirt {
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes < 0) {
+        return QStringLiteral("-");
+    }
+
+    static const char *const units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double value = double(bytes);
+    int unit = 0;
+    while (value >= 1024 && unit < 4) {
+        value /= 1024;
+        unit++;
+    }
+
+    // Whole bytes; one decimal up to MiB, two from GiB where it still matters
+    int decimals = unit == 0 ? 0 : (unit < 3 ? 1 : 2);
+    return QString("%1 %2").arg(value, 0, 'f', decimals).arg(QLatin1String(units[unit]));
+}
+
+QString formatByteRate(qint64 bytesPerSecond)
+{
+    return bytesPerSecond < 0 ? QStringLiteral("-") : formatBytes(bytesPerSecond) + "/s";
+}
+
+} // namespace QVirt
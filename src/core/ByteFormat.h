@@ -0,0 +1,32 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CORE_BYTEFORMAT_H
+#define QVIRT_CORE_BYTEFORMAT_H
+
+#include <QString>
+
+namespace QVirt {
+
+/**
+ * @brief Human-readable size in binary units, e.g. "512.0 MiB", "10.00 GiB"
+ *
+ * Negative sizes, which libvirt and the job statistics use for "unknown",
+ * are shown as "-".
+ */
+QString formatBytes(qint64 bytes);
+
+// Transfer rate, e.g. "85.3 MiB/s"; "-" if unknown
+QString formatByteRate(qint64 bytesPerSecond);
+
+} // namespace QVirt
+
+#endif // QVIRT_CORE_BYTEFORMAT_H
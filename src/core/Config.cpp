@@ -123,6 +123,56 @@ QSize Config::vmWindowSize(const QString &uri, const QString &uuid, const QSize
     return m_settings.value(key, defaultSize).toSize();
 }
 
+// Backup policies live under the hashed URI; raw URIs would nest groups
+void Config::setVMBackupPolicy(const QString &uri, const QString &uuid, const BackupPolicy &policy)
+{
+    QString group = QString("Backup/%1/%2").arg(sanitizeUriToFilename(uri), uuid);
+    m_settings.beginGroup(group);
+    m_settings.setValue("enabled", policy.enabled);
+    m_settings.setValue("targetDir", policy.targetDir);
+    m_settings.setValue("intervalHours", policy.intervalHours);
+    m_settings.setValue("fullEvery", policy.fullEvery);
+    m_settings.setValue("lastRun", policy.lastRun);
+    m_settings.endGroup();
+    emit valueChanged(group);
+}
+
+BackupPolicy Config::vmBackupPolicy(const QString &uri, const QString &uuid) const
+{
+    QString group = QString("Backup/%1/%2/").arg(sanitizeUriToFilename(uri), uuid);
+    BackupPolicy policy;
+    policy.enabled = m_settings.value(group + "enabled", false).toBool();
+    policy.targetDir = m_settings.value(group + "targetDir").toString();
+    policy.intervalHours = qMax(1, m_settings.value(group + "intervalHours", 24).toInt());
+    policy.fullEvery = qMax(0, m_settings.value(group + "fullEvery", 7).toInt());
+    policy.lastRun = m_settings.value(group + "lastRun", 0).toLongLong();
+    return policy;
+}
+
+void Config::setVMBackupLastRun(const QString &uri, const QString &uuid, qint64 timestamp)
+{
+    QString key = QString("Backup/%1/%2/lastRun").arg(sanitizeUriToFilename(uri), uuid);
+    m_settings.setValue(key, timestamp);
+    emit valueChanged(key);
+}
+
+QStringList Config::backupPolicyUUIDs(const QString &uri) const
+{
+    // beginGroup() is not const; pick the UUIDs out of the keys instead
+    const QString prefix = QString("Backup/%1/").arg(sanitizeUriToFilename(uri));
+    QStringList uuids;
+    const QStringList keys = m_settings.allKeys();
+    for (const QString &key : keys) {
+        if (key.startsWith(prefix)) {
+            QString uuid = key.mid(prefix.size()).section('/', 0, 0);
+            if (!uuid.isEmpty() && !uuids.contains(uuid)) {
+                uuids.append(uuid);
+            }
+        }
+    }
+    return uuids;
+}
+
 // Helper to convert URI to filesystem-safe UUID-like name
 QString Config::sanitizeUriToFilename(const QString &uri)
 {
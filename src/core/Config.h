@@ -66,6 +66,18 @@ struct VMCacheInfo
         : name(name), uuid(uuid) {}
 };
 
+/**
+ * @brief Scheduled backup settings of one VM
+ */
+struct BackupPolicy
+{
+    bool enabled = false;
+    QString targetDir;          // Backups go to a subdirectory per VM
+    int intervalHours = 24;
+    int fullEvery = 7;          // Incremental backups between two full ones
+    qint64 lastRun = 0;         // Unix timestamp of the last successful backup
+};
+
 /**
  * @brief Application configuration manager
  *
@@ -106,6 +118,12 @@ public:
     void setVMWindowSize(const QString &uri, const QString &uuid, const QSize &size);
     QSize vmWindowSize(const QString &uri, const QString &uuid, const QSize &defaultSize = QSize(800, 600)) const;
 
+    // Backup policies, per VM
+    void setVMBackupPolicy(const QString &uri, const QString &uuid, const BackupPolicy &policy);
+    BackupPolicy vmBackupPolicy(const QString &uri, const QString &uuid) const;
+    void setVMBackupLastRun(const QString &uri, const QString &uuid, qint64 timestamp);
+    QStringList backupPolicyUUIDs(const QString &uri) const;
+
     // VM Cache - save/load VM information per connection
     // Uses XML files in QStandardPaths::AppDataLocation for storage
     // Connection URI is sanitized to a filesystem-safe name
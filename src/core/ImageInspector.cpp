@@ -0,0 +1,443 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ImageInspector.h"
+
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <QtAlgorithms>
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace QVirt {
+
+namespace {
+
+constexpr quint32 Qcow2Magic = 0x514649fb;     // "QFI\xfb"
+constexpr qint64 Qcow2V2HeaderSize = 72;
+constexpr qint64 Qcow2V3HeaderSize = 104;
+
+constexpr int MinClusterBits = 9;
+constexpr int MaxClusterBits = 21;
+
+// Everything the header can point at lies within the first cluster
+constexpr qint64 MaxHeaderMapSize = qint64(1) << MaxClusterBits;
+
+// Limits QEMU itself enforces
+constexpr quint32 MaxL1Entries = 32 * 1024 * 1024 / 8;
+constexpr quint32 MaxBackingFileSize = 1023;
+
+// Header extension types
+constexpr quint32 ExtensionEnd = 0x00000000;
+constexpr quint32 ExtensionBackingFormat = 0xe2792aca;
+constexpr quint32 ExtensionDataFile = 0x44415441;
+
+// Table entry bits
+constexpr quint64 TableOffsetMask = 0x00fffffffffffe00ULL;
+constexpr quint64 CompressedFlag = quint64(1) << 62;
+constexpr quint64 ZeroFlag = 1;
+
+quint32 readBE32(const uchar *p)
+{
+    return qFromBigEndian<quint32>(p);
+}
+
+quint64 readBE64(const uchar *p)
+{
+    return qFromBigEndian<quint64>(p);
+}
+
+ImageInfo invalid(ImageInfo info, const QString &error)
+{
+    info.error = error;
+    return info;
+}
+
+// Length of the file or block device open in @p file
+qint64 deviceSize(QFile &file)
+{
+#ifdef Q_OS_UNIX
+    const off_t end = ::lseek(file.handle(), 0, SEEK_END);
+    ::lseek(file.handle(), 0, SEEK_SET);
+    if (end >= 0) {
+        return qint64(end);
+    }
+#endif
+    return file.size();
+}
+
+// Bytes the host has allocated for @p file, -1 if unknown
+qint64 hostAllocation(QFile &file, qint64 size)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::fstat(file.handle(), &st) == 0) {
+        // Block devices report no blocks of their own
+        return S_ISREG(st.st_mode) ? qint64(st.st_blocks) * 512 : size;
+    }
+    return -1;
+#else
+    Q_UNUSED(file);
+    return size;
+#endif
+}
+
+bool cancelled(const std::atomic<bool> *cancel)
+{
+    return cancel && cancel->load();
+}
+
+// Guest bytes mapped by one L2 table
+qint64 countL2(const uchar *table, qint64 clusterSize, bool extendedL2, int version)
+{
+    const qint64 entrySize = extendedL2 ? 16 : 8;
+    const qint64 subclusterSize = clusterSize / 32;
+
+    qint64 bytes = 0;
+    for (qint64 pos = 0; pos + entrySize <= clusterSize; pos += entrySize) {
+        const quint64 entry = readBE64(table + pos);
+        if (entry & CompressedFlag) {
+            bytes += clusterSize;
+            continue;
+        }
+        if (!(entry & TableOffsetMask)) {
+            continue;
+        }
+        if (extendedL2) {
+            const quint32 allocated = quint32(readBE64(table + pos + 8));
+            bytes += qint64(qPopulationCount(allocated)) * subclusterSize;
+        } else if (version < 3 || !(entry & ZeroFlag)) {
+            bytes += clusterSize;
+        }
+    }
+    return bytes;
+}
+
+} // namespace
+
+QString ImageInfo::formatName() const
+{
+    switch (format) {
+    case FormatRaw:
+        return QStringLiteral("raw");
+    case FormatQcow2:
+        return QStringLiteral("qcow2");
+    case FormatUnknown:
+        break;
+    }
+    return QString();
+}
+
+ImageInfo ImageInspector::parseHeader(const QByteArray &header, qint64 fileSize)
+{
+    ImageInfo info;
+    info.fileSize = fileSize;
+
+    const auto *d = reinterpret_cast<const uchar *>(header.constData());
+    const qint64 size = header.size();
+
+    if (size < 4 || readBE32(d) != Qcow2Magic) {
+        // Raw images have no header; any other format could be here too
+        info.virtualSize = qMax<qint64>(0, fileSize);
+        return info;
+    }
+
+    info.format = ImageInfo::FormatQcow2;
+    if (size < Qcow2V2HeaderSize) {
+        return invalid(info, QObject::tr("Truncated qcow2 header"));
+    }
+
+    info.version = int(readBE32(d + 4));
+    if (info.version != 2 && info.version != 3) {
+        return invalid(info, QObject::tr("Unsupported qcow2 version %1").arg(readBE32(d + 4)));
+    }
+
+    const quint64 backingOffset = readBE64(d + 8);
+    const quint32 backingSize = readBE32(d + 16);
+    const quint32 clusterBits = readBE32(d + 20);
+    if (clusterBits < quint32(MinClusterBits) || clusterBits > quint32(MaxClusterBits)) {
+        return invalid(info, QObject::tr("Invalid cluster size 2^%1").arg(clusterBits));
+    }
+    info.clusterBits = int(clusterBits);
+    const qint64 clusterSize = info.clusterSize();
+
+    const quint64 virtualSize = readBE64(d + 24);
+    if (virtualSize > quint64(std::numeric_limits<qint64>::max())) {
+        return invalid(info, QObject::tr("Invalid virtual size"));
+    }
+    info.virtualSize = qint64(virtualSize);
+    info.encrypted = readBE32(d + 32) != 0;
+    info.l1Size = readBE32(d + 36);
+    const quint64 l1Offset = readBE64(d + 40);
+    info.snapshotCount = readBE32(d + 60);
+
+    quint32 refcountOrder = 4;
+    quint64 headerLength = Qcow2V2HeaderSize;
+    if (info.version >= 3) {
+        if (size < Qcow2V3HeaderSize) {
+            return invalid(info, QObject::tr("Truncated qcow2 header"));
+        }
+        info.incompatibleFeatures = readBE64(d + 72);
+        refcountOrder = readBE32(d + 96);
+        headerLength = readBE32(d + 100);
+        if (headerLength < quint64(Qcow2V3HeaderSize) || headerLength > quint64(clusterSize)) {
+            return invalid(info, QObject::tr("Invalid header length %1").arg(headerLength));
+        }
+    }
+    if (refcountOrder > 6) {
+        return invalid(info, QObject::tr("Invalid refcount width 2^%1").arg(refcountOrder));
+    }
+    info.refcountBits = 1 << refcountOrder;
+
+    // The L1 table must cover the whole disk and lie inside the file
+    const qint64 l2Entries = clusterSize / (info.hasExtendedL2() ? 16 : 8);
+    const qint64 bytesPerL1Entry = clusterSize * l2Entries;
+    const qint64 l1Needed = info.virtualSize / bytesPerL1Entry
+                            + (info.virtualSize % bytesPerL1Entry ? 1 : 0);
+    if (info.l1Size > MaxL1Entries) {
+        return invalid(info, QObject::tr("L1 table too large (%1 entries)").arg(info.l1Size));
+    }
+    if (qint64(info.l1Size) < l1Needed) {
+        return invalid(info, QObject::tr("L1 table has %1 entries, %2 needed")
+                                 .arg(info.l1Size).arg(l1Needed));
+    }
+    if (l1Offset % quint64(clusterSize) != 0
+        || (info.l1Size > 0 && fileSize >= 0
+            && (l1Offset > quint64(fileSize)
+                || quint64(info.l1Size) * 8 > quint64(fileSize) - l1Offset))) {
+        return invalid(info, QObject::tr("L1 table lies outside the image"));
+    }
+    info.l1TableOffset = qint64(l1Offset);
+
+    if (backingOffset != 0) {
+        if (backingSize == 0 || backingSize > MaxBackingFileSize) {
+            return invalid(info, QObject::tr("Invalid backing file name length %1").arg(backingSize));
+        }
+        if (backingOffset >= quint64(size) || backingSize > quint64(size) - backingOffset) {
+            return invalid(info, QObject::tr("Backing file name lies outside the header"));
+        }
+        info.backingFile = QString::fromUtf8(header.constData() + backingOffset, int(backingSize));
+    }
+
+    // Header extensions follow the header, up to the end of the first cluster
+    const quint64 end = quint64(qMin(size, clusterSize));
+    quint64 pos = headerLength;
+    while (pos + 8 <= end) {
+        const quint32 type = readBE32(d + pos);
+        const quint32 length = readBE32(d + pos + 4);
+        pos += 8;
+        if (type == ExtensionEnd) {
+            break;
+        }
+        if (length > end - pos) {
+            return invalid(info, QObject::tr("Truncated header extension 0x%1").arg(type, 8, 16, QChar('0')));
+        }
+
+        const QString text = QString::fromUtf8(header.constData() + pos, int(length));
+        if (type == ExtensionBackingFormat) {
+            info.backingFormat = text;
+        } else if (type == ExtensionDataFile) {
+            info.dataFile = text;
+        }
+        pos += (quint64(length) + 7) & ~quint64(7);
+    }
+
+    return info;
+}
+
+ImageInfo ImageInspector::inspect(const QString &path)
+{
+    ImageInfo info;
+    info.path = path;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return invalid(info, file.errorString());
+    }
+
+    const qint64 fileSize = deviceSize(file);
+    const qint64 headerSize = qMin(fileSize, MaxHeaderMapSize);
+
+    // Mapping is lazy: only the pages the parser touches are read
+    QByteArray header;
+    uchar *mapped = headerSize > 0 ? file.map(0, headerSize) : nullptr;
+    if (mapped) {
+        header = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), int(headerSize));
+    } else {
+        // Block devices and some file systems cannot be mapped
+        header = file.read(MaxHeaderMapSize);
+    }
+
+    info = parseHeader(header, fileSize);
+    info.path = path;
+    info.allocation = hostAllocation(file, fileSize);
+
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    return info;
+}
+
+QString ImageInspector::resolveBackingFile(const ImageInfo &info)
+{
+    if (info.backingFile.isEmpty()) {
+        return QString();
+    }
+
+    // Protocols such as nbd:, json: or http:// are not files here
+    static const QRegularExpression protocol("^[A-Za-z][A-Za-z0-9+.-]+:");
+    if (protocol.match(info.backingFile).hasMatch()) {
+        return QString();
+    }
+
+    // Relative names are relative to the image that refers to them
+    if (QFileInfo(info.backingFile).isRelative()) {
+        return QDir::cleanPath(QFileInfo(info.path).dir().filePath(info.backingFile));
+    }
+    return QDir::cleanPath(info.backingFile);
+}
+
+QList<ImageInfo> ImageInspector::backingChain(const QString &path, int maxDepth)
+{
+    QList<ImageInfo> chain;
+    QSet<QString> seen;
+
+    QString current = path;
+    while (!current.isEmpty()) {
+        if (chain.size() >= maxDepth) {
+            if (!chain.isEmpty()) {
+                chain.last().error = QObject::tr("Backing chain is deeper than %1 images").arg(maxDepth);
+            }
+            break;
+        }
+
+        const QString canonical = QFileInfo(current).canonicalFilePath();
+        if (!canonical.isEmpty() && seen.contains(canonical)) {
+            chain.last().error = QObject::tr("Backing chain loops back to %1").arg(current);
+            break;
+        }
+        seen.insert(canonical);
+
+        ImageInfo info = inspect(current);
+        if (info.format == ImageInfo::FormatUnknown && info.isReadable() && !chain.isEmpty()
+            && chain.last().backingFormat == QLatin1String("raw")) {
+            info.format = ImageInfo::FormatRaw;
+        }
+        chain.append(info);
+        if (!info.isValid()) {
+            break;
+        }
+        current = resolveBackingFile(info);
+    }
+    return chain;
+}
+
+qint64 ImageInspector::dataExtentBytes(const QString &path, const std::atomic<bool> *cancel)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    const qint64 size = deviceSize(file);
+#if defined(Q_OS_UNIX) && defined(SEEK_DATA)
+    const int fd = file.handle();
+    qint64 allocated = 0;
+    for (qint64 pos = 0; pos < size;) {
+        if (cancelled(cancel)) {
+            return -1;
+        }
+        const off_t data = ::lseek(fd, off_t(pos), SEEK_DATA);
+        if (data < 0) {
+            if (errno == ENXIO) {
+                break;              // Only a hole is left
+            }
+            return allocated + (size - pos);
+        }
+        off_t hole = ::lseek(fd, data, SEEK_HOLE);
+        if (hole < 0) {
+            hole = off_t(size);
+        }
+        allocated += qMin<qint64>(hole, size) - data;
+        pos = hole;
+    }
+    return allocated;
+#else
+    Q_UNUSED(cancel);
+    return size;
+#endif
+}
+
+qint64 ImageInspector::scanAllocation(const QString &path, const std::atomic<bool> *cancel)
+{
+    const ImageInfo info = inspect(path);
+    if (!info.isReadable()) {
+        return -1;
+    }
+    if (info.format != ImageInfo::FormatQcow2) {
+        return dataExtentBytes(path, cancel);
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    if (info.l1Size == 0) {
+        return 0;
+    }
+
+    uchar *l1 = file.map(info.l1TableOffset, qint64(info.l1Size) * 8);
+    if (!l1) {
+        return -1;
+    }
+
+    const qint64 clusterSize = info.clusterSize();
+    qint64 bytes = 0;
+    for (quint32 i = 0; i < info.l1Size; ++i) {
+        if (cancelled(cancel)) {
+            bytes = -1;
+            break;
+        }
+
+        const quint64 l2Offset = readBE64(l1 + qint64(i) * 8) & TableOffsetMask;
+        if (l2Offset == 0) {
+            continue;
+        }
+        // A misplaced table is corruption; count what can be read
+        if (l2Offset % quint64(clusterSize) != 0
+            || l2Offset > quint64(info.fileSize)
+            || quint64(clusterSize) > quint64(info.fileSize) - l2Offset) {
+            continue;
+        }
+
+        uchar *l2 = file.map(qint64(l2Offset), clusterSize);
+        if (!l2) {
+            continue;
+        }
+        bytes += countL2(l2, clusterSize, info.hasExtendedL2(), info.version);
+        file.unmap(l2);
+    }
+    file.unmap(l1);
+
+    return bytes < 0 ? -1 : qMin(bytes, info.virtualSize);
+}
+
+} // namespace QVirt
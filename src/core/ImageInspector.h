@@ -0,0 +1,124 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CORE_IMAGEINSPECTOR_H
+#define QVIRT_CORE_IMAGEINSPECTOR_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <atomic>
+
+namespace QVirt {
+
+/**
+ * @brief What the header of a disk image says about it
+ */
+struct ImageInfo
+{
+    enum Format {
+        FormatUnknown,
+        FormatRaw,
+        FormatQcow2
+    };
+
+    QString path;
+    Format format = FormatUnknown;
+    qint64 virtualSize = 0;         // Size the guest sees
+    qint64 fileSize = 0;            // Length of the file on the host
+    qint64 allocation = -1;         // Host blocks in use, -1 if unknown
+
+    // qcow2 only
+    int version = 0;
+    int clusterBits = 0;
+    quint32 l1Size = 0;             // Entries in the L1 table
+    qint64 l1TableOffset = 0;
+    int refcountBits = 0;
+    quint32 snapshotCount = 0;
+    quint64 incompatibleFeatures = 0;
+    bool encrypted = false;
+    QString backingFile;            // As written in the image
+    QString backingFormat;
+    QString dataFile;               // External data file, if any
+
+    QString error;                  // Why the image could not be read
+
+    // Read, and positively identified by its header
+    bool isValid() const { return error.isEmpty() && format != FormatUnknown; }
+    bool isReadable() const { return error.isEmpty(); }
+    QString formatName() const;
+    qint64 clusterSize() const { return clusterBits > 0 ? qint64(1) << clusterBits : 0; }
+
+    bool isDirty() const { return incompatibleFeatures & (1u << 0); }
+    bool isCorrupt() const { return incompatibleFeatures & (1u << 1); }
+    bool hasExtendedL2() const { return incompatibleFeatures & (1u << 4); }
+};
+
+/**
+ * @brief Reads disk image metadata straight from local files
+ *
+ * Needs nothing but the file: the qcow2 header and its extensions are
+ * memory-mapped and parsed in place, so format, virtual size, cluster
+ * layout and backing file come without asking libvirt for the volume
+ * XML. A header that is not qcow2 proves nothing: such files are
+ * FormatUnknown, sized by their length, unless the image above them in
+ * a backing chain names them raw. Callers keep libvirt's format for
+ * them. Only useful where the image is on this host, i.e. for local
+ * connections.
+ *
+ * The parser checks every offset and size against the mapped header and
+ * the file length, so truncated or hostile images give an error rather
+ * than a bad read.
+ */
+class ImageInspector
+{
+public:
+    // Deepest backing chain followed before giving up
+    static constexpr int MaxChainDepth = 32;
+
+    // Header of @p path; one small read, fine on the GUI thread
+    static ImageInfo inspect(const QString &path);
+
+    // Parse @p header, the start of an image @p fileSize bytes long
+    static ImageInfo parseHeader(const QByteArray &header, qint64 fileSize);
+
+    /**
+     * @brief @p path followed by its backing images, top first
+     *
+     * Stops at the first image that cannot be read, at a backing file
+     * that is not a local path (e.g. nbd: or json:), on a loop and after
+     * @p maxDepth images; the last entry's error says why, if any.
+     */
+    static QList<ImageInfo> backingChain(const QString &path, int maxDepth = MaxChainDepth);
+
+    // Local path of @p info's backing file, empty if it has none or it is remote
+    static QString resolveBackingFile(const ImageInfo &info);
+
+    /**
+     * @brief Bytes of guest data in the image
+     *
+     * Walks the qcow2 L1 and L2 tables, or the data extents of a raw file
+     * with SEEK_DATA/SEEK_HOLE. May take a while on large images: run it
+     * off the GUI thread. Returns -1 on error or once @p cancel is set.
+     */
+    static qint64 scanAllocation(const QString &path, const std::atomic<bool> *cancel = nullptr);
+
+    /**
+     * @brief Bytes in the data extents of the file at @p path
+     *
+     * Holes are skipped; without hole support the whole file counts.
+     */
+    static qint64 dataExtentBytes(const QString &path, const std::atomic<bool> *cancel = nullptr);
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CORE_IMAGEINSPECTOR_H
@@ -0,0 +1,199 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "MetricHistory.h"
+
+namespace QVirt {
+
+MetricHistory::MetricHistory(int seriesCount, int capacity)
+    : m_series(qMax(1, seriesCount))
+    , m_capacity(qMax(1, capacity))
+    , m_head(0)
+    , m_count(0)
+    , m_nextSequence(0)
+    , m_generation(0)
+{
+}
+
+void MetricHistory::append(qint64 timestampMs, const float *values)
+{
+    if (m_count > 0 && timestampMs < lastTimestamp()) {
+        timestampMs = lastTimestamp();
+    }
+
+    if (m_count < m_capacity) {
+        // Still growing; m_head stays on slot 0
+        m_timestamps.append(timestampMs);
+        for (int s = 0; s < m_series.size(); ++s) {
+            m_series[s].append(values[s]);
+        }
+        m_count++;
+    } else {
+        m_timestamps[m_head] = timestampMs;
+        for (int s = 0; s < m_series.size(); ++s) {
+            m_series[s][m_head] = values[s];
+        }
+        m_head = (m_head + 1) % m_count;
+    }
+
+    m_nextSequence++;
+    m_generation++;
+}
+
+void MetricHistory::append(qint64 timestampMs, const QVector<float> &values)
+{
+    QVector<float> padded = values;
+    padded.resize(m_series.size());
+    append(timestampMs, padded.constData());
+}
+
+void MetricHistory::clear()
+{
+    m_timestamps.clear();
+    for (auto &series : m_series) {
+        series.clear();
+    }
+    m_head = 0;
+    m_count = 0;
+    m_generation++;
+}
+
+void MetricHistory::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == m_capacity) {
+        return;
+    }
+
+    // Keep the newest samples that still fit, laid out linearly again
+    int keep = qMin(m_count, capacity);
+    int first = m_count - keep;
+
+    QVector<qint64> timestamps;
+    timestamps.reserve(keep);
+    for (int i = first; i < m_count; ++i) {
+        timestamps.append(timestamp(i));
+    }
+
+    QVector<QVector<float>> series(m_series.size());
+    for (int s = 0; s < m_series.size(); ++s) {
+        series[s].reserve(keep);
+        for (int i = first; i < m_count; ++i) {
+            series[s].append(value(s, i));
+        }
+    }
+
+    m_timestamps = timestamps;
+    m_series = series;
+    m_capacity = capacity;
+    m_head = 0;
+    m_count = keep;
+    m_generation++;
+}
+
+int MetricHistory::lowerBound(qint64 timestampMs) const
+{
+    int lo = 0;
+    int hi = m_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (timestamp(mid) < timestampMs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+QVector<TieredMetricHistory::Tier> TieredMetricHistory::defaultTiers()
+{
+    return {{1, MetricHistory::DefaultCapacity}, {60, 1440}};
+}
+
+TieredMetricHistory::TieredMetricHistory(int seriesCount, const QVector<Tier> &tiers)
+{
+    const QVector<Tier> specs = tiers.isEmpty() ? defaultTiers() : tiers;
+    for (const Tier &spec : specs) {
+        Level level{qMax(1, spec.factor), MetricHistory(seriesCount, spec.capacity),
+                    QVector<double>(qMax(1, seriesCount), 0.0), 0};
+        m_tiers.append(level);
+    }
+}
+
+void TieredMetricHistory::append(qint64 timestampMs, const float *values)
+{
+    m_tiers[0].history.append(timestampMs, values);
+
+    // Fold the new sample into the coarser tiers, carrying each completed
+    // mean on to the next tier
+    QVector<float> carry(seriesCount());
+    for (int s = 0; s < carry.size(); ++s) {
+        carry[s] = values[s];
+    }
+
+    for (int t = 1; t < m_tiers.size(); ++t) {
+        Level &level = m_tiers[t];
+        for (int s = 0; s < carry.size(); ++s) {
+            level.sums[s] += carry.at(s);
+        }
+        if (++level.pending < level.factor) {
+            return;
+        }
+
+        for (int s = 0; s < carry.size(); ++s) {
+            carry[s] = static_cast<float>(level.sums.at(s) / level.pending);
+            level.sums[s] = 0.0;
+        }
+        level.pending = 0;
+        level.history.append(timestampMs, carry.constData());
+    }
+}
+
+void TieredMetricHistory::clear()
+{
+    for (Level &level : m_tiers) {
+        level.history.clear();
+        level.sums.fill(0.0);
+        level.pending = 0;
+    }
+}
+
+qint64 TieredMetricHistory::firstTimestamp() const
+{
+    qint64 first = 0;
+    for (const Level &level : m_tiers) {
+        if (!level.history.isEmpty() && (first == 0 || level.history.firstTimestamp() < first)) {
+            first = level.history.firstTimestamp();
+        }
+    }
+    return first;
+}
+
+int TieredMetricHistory::tierFor(qint64 timestampMs) const
+{
+    int furthest = 0;
+    for (int t = 0; t < m_tiers.size(); ++t) {
+        const MetricHistory &history = m_tiers.at(t).history;
+        if (history.isEmpty()) {
+            continue;
+        }
+        if (history.firstTimestamp() <= timestampMs) {
+            return t;
+        }
+        if (history.firstTimestamp() < tier(furthest).firstTimestamp()) {
+            furthest = t;
+        }
+    }
+    return furthest;
+}
+
+} // namespace QVirt
@@ -0,0 +1,145 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CORE_METRICHISTORY_H
+#define QVIRT_CORE_METRICHISTORY_H
+
+#include <QVector>
+
+namespace QVirt {
+
+/**
+ * @brief Long-horizon ring buffer of timestamped multi-series samples
+ *
+ * All series share one time axis, so a sample is a timestamp plus one
+ * value per series. Storage grows on demand up to capacity() and is then
+ * reused in place, which keeps idle domains cheap. Longer horizons are
+ * kept downsampled by TieredMetricHistory.
+ *
+ * Every sample also gets a monotonically increasing sequence number that
+ * survives wrap-around, clear() and setCapacity(). Consumers that derive
+ * data from the history (see MetricPyramid) use sequences to catch up
+ * incrementally instead of rescanning everything.
+ */
+class MetricHistory
+{
+public:
+    // One hour of one-second samples
+    static constexpr int DefaultCapacity = 3600;
+
+    explicit MetricHistory(int seriesCount, int capacity = DefaultCapacity);
+
+    /**
+     * @brief Append one sample
+     * @param timestampMs Sample time; clamped so time never goes backwards
+     * @param values seriesCount() values, one per series
+     */
+    void append(qint64 timestampMs, const float *values);
+    void append(qint64 timestampMs, const QVector<float> &values);
+    void clear();
+
+    int seriesCount() const { return m_series.size(); }
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // Index 0 is the oldest sample still held
+    qint64 timestamp(int i) const { return m_timestamps.at(physical(i)); }
+    float value(int series, int i) const { return m_series.at(series).at(physical(i)); }
+
+    qint64 firstTimestamp() const { return m_count > 0 ? timestamp(0) : 0; }
+    qint64 lastTimestamp() const { return m_count > 0 ? timestamp(m_count - 1) : 0; }
+
+    // Index of the first sample with timestamp >= timestampMs (size() if none)
+    int lowerBound(qint64 timestampMs) const;
+
+    // Sequence numbers: sample i has sequence firstSequence() + i
+    quint64 firstSequence() const { return m_nextSequence - static_cast<quint64>(m_count); }
+    quint64 endSequence() const { return m_nextSequence; }
+    float valueAtSequence(int series, quint64 sequence) const
+    {
+        return value(series, static_cast<int>(sequence - firstSequence()));
+    }
+
+    // Bumped by every append and by clear()/setCapacity()
+    quint64 generation() const { return m_generation; }
+
+private:
+    int physical(int i) const
+    {
+        // m_head stays 0 while storage is still growing
+        int p = m_head + i;
+        return p >= m_count ? p - m_count : p;
+    }
+
+    QVector<qint64> m_timestamps;
+    QVector<QVector<float>> m_series;
+    int m_capacity;
+    int m_head;     // Oldest slot; also the next one overwritten once full
+    int m_count;
+    quint64 m_nextSequence;
+    quint64 m_generation;
+};
+
+/**
+ * @brief Bounded MetricHistory tiers of decreasing resolution
+ *
+ * Tier 0 holds the raw samples for a short horizon. Every further tier
+ * holds one sample per factor samples of the tier below: their mean,
+ * stamped with the newest of them. Each tier is a bounded ring, so the
+ * default hour of raw samples plus a day of one-minute means costs a
+ * fraction of a raw day.
+ */
+class TieredMetricHistory
+{
+public:
+    struct Tier {
+        int factor;     // Samples of the tier below per sample; ignored for tier 0
+        int capacity;
+    };
+
+    // An hour of raw samples, then a day of their one-minute means
+    static QVector<Tier> defaultTiers();
+
+    explicit TieredMetricHistory(int seriesCount, const QVector<Tier> &tiers = defaultTiers());
+
+    void append(qint64 timestampMs, const float *values);
+    void clear();
+
+    int seriesCount() const { return m_tiers.first().history.seriesCount(); }
+    int tierCount() const { return m_tiers.size(); }
+    const MetricHistory &tier(int i) const { return m_tiers.at(i).history; }
+
+    bool isEmpty() const { return tier(0).isEmpty(); }
+    // Oldest sample of any tier, and the newest raw sample
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const { return tier(0).lastTimestamp(); }
+
+    // Finest tier that still reaches back to @p timestampMs, or the one
+    // reaching back furthest if none does
+    int tierFor(qint64 timestampMs) const;
+
+private:
+    struct Level {
+        int factor;
+        MetricHistory history;
+        QVector<double> sums;   // Samples of the tier below not folded in yet
+        int pending;
+    };
+
+    QVector<Level> m_tiers;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CORE_METRICHISTORY_H
@@ -0,0 +1,156 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "MetricPyramid.h"
+#include "MetricHistory.h"
+
+namespace QVirt {
+
+namespace {
+// Ranges shorter than this are cheaper to read from the raw samples
+constexpr int MinimumShift = 2;
+
+void mergeInto(MetricPyramid::Summary *summary, float min, float max, double sum, quint64 count)
+{
+    if (summary->count == 0) {
+        summary->min = min;
+        summary->max = max;
+    } else {
+        summary->min = qMin(summary->min, min);
+        summary->max = qMax(summary->max, max);
+    }
+    summary->sum += sum;
+    summary->count += count;
+}
+} // namespace
+
+MetricPyramid::MetricPyramid()
+    : m_seriesCount(0)
+    , m_capacity(0)
+    , m_synced(0)
+    , m_initialized(false)
+    , m_rebuildCount(0)
+{
+}
+
+void MetricPyramid::reset()
+{
+    m_levels.clear();
+    m_seriesCount = 0;
+    m_capacity = 0;
+    m_synced = 0;
+    m_initialized = false;
+}
+
+void MetricPyramid::rebuild(const MetricHistory &history)
+{
+    m_seriesCount = history.seriesCount();
+    m_capacity = history.capacity();
+    m_levels.clear();
+
+    for (int shift = MinimumShift; (1 << shift) <= m_capacity; ++shift) {
+        Level level;
+        level.shift = shift;
+        // Enough slots that no bucket still inside the history is overwritten
+        level.slots = (m_capacity >> shift) + 2;
+        level.buckets = QVector<Bucket>(level.slots * m_seriesCount, Bucket{0.0f, 0.0f, 0.0});
+        m_levels.append(level);
+    }
+
+    m_synced = history.firstSequence();
+    m_initialized = true;
+    m_rebuildCount++;
+}
+
+void MetricPyramid::sync(const MetricHistory &history)
+{
+    if (!m_initialized || history.seriesCount() != m_seriesCount ||
+        history.capacity() != m_capacity || m_synced > history.endSequence()) {
+        rebuild(history);
+    }
+
+    // Samples evicted before we saw them are skipped; buckets that would
+    // have covered them start before firstSequence() and are never queried
+    if (m_synced < history.firstSequence()) {
+        m_synced = history.firstSequence();
+    }
+
+    for (quint64 seq = m_synced; seq < history.endSequence(); ++seq) {
+        fold(history, seq);
+    }
+    m_synced = history.endSequence();
+}
+
+void MetricPyramid::fold(const MetricHistory &history, quint64 sequence)
+{
+    for (Level &level : m_levels) {
+        quint64 mask = (quint64(1) << level.shift) - 1;
+        bool first = (sequence & mask) == 0;
+        int slot = static_cast<int>((sequence >> level.shift) % static_cast<quint64>(level.slots));
+
+        for (int s = 0; s < m_seriesCount; ++s) {
+            float v = history.valueAtSequence(s, sequence);
+            Bucket &b = level.buckets[s * level.slots + slot];
+            if (first) {
+                b.min = v;
+                b.max = v;
+                b.sum = v;
+            } else {
+                b.min = qMin(b.min, v);
+                b.max = qMax(b.max, v);
+                b.sum += v;
+            }
+        }
+    }
+}
+
+MetricPyramid::Summary MetricPyramid::summarize(const MetricHistory &history, int series,
+                                                quint64 beginSequence, quint64 endSequence) const
+{
+    Summary summary;
+    if (series < 0 || series >= history.seriesCount()) {
+        return summary;
+    }
+
+    quint64 begin = qMax(beginSequence, history.firstSequence());
+    quint64 end = qMin(endSequence, history.endSequence());
+    bool useBuckets = m_initialized && m_seriesCount == history.seriesCount() &&
+                      m_capacity == history.capacity();
+
+    quint64 seq = begin;
+    while (seq < end) {
+        bool merged = false;
+        if (useBuckets) {
+            // Largest complete, aligned bucket starting here
+            for (int i = m_levels.size() - 1; i >= 0; --i) {
+                const Level &level = m_levels.at(i);
+                quint64 size = quint64(1) << level.shift;
+                if ((seq & (size - 1)) == 0 && seq + size <= end && seq + size <= m_synced) {
+                    const Bucket &b = bucket(level, series, seq);
+                    mergeInto(&summary, b.min, b.max, b.sum, size);
+                    seq += size;
+                    merged = true;
+                    break;
+                }
+            }
+        }
+
+        if (!merged) {
+            float v = history.valueAtSequence(series, seq);
+            mergeInto(&summary, v, v, v, 1);
+            seq++;
+        }
+    }
+
+    return summary;
+}
+
+} // namespace QVirt
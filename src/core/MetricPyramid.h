@@ -0,0 +1,97 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CORE_METRICPYRAMID_H
+#define QVIRT_CORE_METRICPYRAMID_H
+
+#include <QVector>
+
+namespace QVirt {
+
+class MetricHistory;
+
+/**
+ * @brief Multi-resolution min/max/sum summary of a MetricHistory
+ *
+ * Level k holds one bucket per 2^k consecutive samples (by sequence
+ * number), for every series. summarize() answers "min, max and mean of
+ * series s over samples [begin, end)" by combining at most a few buckets
+ * per level plus a handful of raw edge samples, so the cost of a query is
+ * logarithmic in the range length instead of linear.
+ *
+ * sync() only folds in samples appended since the previous call, so
+ * keeping the pyramid current costs O(levels) per new sample.
+ */
+class MetricPyramid
+{
+public:
+    struct Summary {
+        float min = 0.0f;
+        float max = 0.0f;
+        double sum = 0.0;
+        quint64 count = 0;
+
+        bool isValid() const { return count > 0; }
+        float mean() const { return count > 0 ? static_cast<float>(sum / count) : 0.0f; }
+    };
+
+    MetricPyramid();
+
+    // Catch up with samples appended to @p history since the last sync
+    void sync(const MetricHistory &history);
+    // Forget everything; the next sync() starts from the oldest held sample
+    void reset();
+
+    /**
+     * @brief Summarize one series over a sequence range
+     *
+     * The range is clipped to the samples both held by @p history and
+     * already folded in by sync().
+     */
+    Summary summarize(const MetricHistory &history, int series,
+                      quint64 beginSequence, quint64 endSequence) const;
+
+    int levelCount() const { return m_levels.size(); }
+    quint64 syncedSequence() const { return m_synced; }
+    int rebuildCount() const { return m_rebuildCount; }
+
+private:
+    struct Bucket {
+        float min;
+        float max;
+        double sum;
+    };
+
+    struct Level {
+        int shift;
+        int slots;
+        QVector<Bucket> buckets;    // series-major: series * slots + slot
+    };
+
+    void rebuild(const MetricHistory &history);
+    void fold(const MetricHistory &history, quint64 sequence);
+    const Bucket &bucket(const Level &level, int series, quint64 sequence) const
+    {
+        int slot = static_cast<int>((sequence >> level.shift) % static_cast<quint64>(level.slots));
+        return level.buckets.at(series * level.slots + slot);
+    }
+
+    QVector<Level> m_levels;
+    int m_seriesCount;
+    int m_capacity;
+    quint64 m_synced;       // Sequence of the next sample to fold in
+    bool m_initialized;
+    int m_rebuildCount;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CORE_METRICPYRAMID_H
@@ -0,0 +1,96 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CORE_SPSCQUEUE_H
+#define QVIRT_CORE_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace QVirt {
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * Exactly one thread may call tryPush() and exactly one (other) thread may
+ * call tryPop(). Slots are preallocated, so neither side allocates or
+ * blocks; a full queue makes tryPush() fail and leaves the policy (drop,
+ * retry, coalesce) to the producer.
+ *
+ * T must be default-constructible and assignable. The read and write
+ * indices live on separate cache lines so the two threads do not contend.
+ */
+template <typename T>
+class SPSCQueue
+{
+public:
+    explicit SPSCQueue(int capacity)
+        // One slot stays empty to tell a full queue from an empty one
+        : m_slots(static_cast<std::size_t>(capacity) + 1)
+        , m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    int capacity() const { return static_cast<int>(m_slots.size()) - 1; }
+
+    // Producer side
+    bool tryPush(const T &value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m_slots[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool tryPop(T *value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *value = std::move(m_slots[head]);
+        m_head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with the other side
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::size_t increment(std::size_t index) const
+    {
+        return index + 1 == m_slots.size() ? 0 : index + 1;
+    }
+
+    // Not a QVector: implicit sharing would put a shared refcount check on
+    // both threads' paths
+    std::vector<T> m_slots;
+    alignas(64) std::atomic<std::size_t> m_head;    // Next slot to read
+    alignas(64) std::atomic<std::size_t> m_tail;    // Next slot to write
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CORE_SPSCQUEUE_H
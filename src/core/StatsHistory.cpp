@@ -0,0 +1,85 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "StatsHistory.h"
+
+namespace QVirt {
+
+StatsHistory::StatsHistory(int capacity)
+    : m_values(qMax(1, capacity), 0.0f)
+    , m_head(0)
+    , m_count(0)
+    , m_generation(0)
+{
+}
+
+void StatsHistory::append(float value)
+{
+    m_values[m_head] = value;
+    m_head = (m_head + 1) % m_values.size();
+    if (m_count < m_values.size()) {
+        m_count++;
+    }
+    m_generation++;
+}
+
+void StatsHistory::clear()
+{
+    m_head = 0;
+    m_count = 0;
+    m_generation++;
+}
+
+void StatsHistory::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == m_values.size()) {
+        return;
+    }
+
+    // Keep the newest samples that still fit
+    QVector<float> samples = toVector();
+    int keep = qMin(samples.size(), capacity);
+
+    m_values = QVector<float>(capacity, 0.0f);
+    for (int i = 0; i < keep; ++i) {
+        m_values[i] = samples.at(samples.size() - keep + i);
+    }
+    m_count = keep;
+    m_head = keep % capacity;
+    m_generation++;
+}
+
+float StatsHistory::at(int i) const
+{
+    if (i < 0 || i >= m_count) {
+        return 0.0f;
+    }
+    int start = (m_head - m_count + m_values.size()) % m_values.size();
+    return m_values.at((start + i) % m_values.size());
+}
+
+float StatsHistory::last() const
+{
+    return m_count > 0 ? at(m_count - 1) : 0.0f;
+}
+
+QVector<float> StatsHistory::toVector() const
+{
+    QVector<float> samples;
+    samples.reserve(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        samples.append(at(i));
+    }
+    return samples;
+}
+
+} // namespace QVirt
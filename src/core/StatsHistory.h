@@ -0,0 +1,58 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_CORE_STATSHISTORY_H
+#define QVIRT_CORE_STATSHISTORY_H
+
+#include <QVector>
+
+namespace QVirt {
+
+/**
+ * @brief Fixed-capacity ring buffer of recent statistic samples
+ *
+ * Appending never reallocates or shifts existing samples. Every append
+ * bumps generation(), so consumers can cache anything derived from the
+ * history and only rebuild it when the generation moves.
+ */
+class StatsHistory
+{
+public:
+    explicit StatsHistory(int capacity = 60);
+
+    void append(float value);
+    void clear();
+
+    int capacity() const { return m_values.size(); }
+    void setCapacity(int capacity);
+
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    // Index 0 is the oldest sample still held
+    float at(int i) const;
+    float last() const;
+
+    quint64 generation() const { return m_generation; }
+
+    // Samples in chronological order
+    QVector<float> toVector() const;
+
+private:
+    QVector<float> m_values;
+    int m_head;     // Slot the next sample is written to
+    int m_count;
+    quint64 m_generation;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_CORE_STATSHISTORY_H
@@ -0,0 +1,1094 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "BackupManager.h"
+#include "Connection.h"
+#include "Domain.h"
+#include "DomainCheckpoint.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QDomDocument>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTimer>
+#include <QDebug>
+#include <cstdlib>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+// Backups run for hours; progress does not need to be fresher than this
+constexpr int PollIntervalMs = 2000;
+
+// Policies are checked this often; they are due in whole hours
+constexpr int PolicyCheckIntervalMs = 60 * 1000;
+
+// A policy whose backup failed is tried again after this long
+constexpr qint64 PolicyRetrySecs = 60 * 60;
+
+constexpr int MaxFailedPolls = 3;
+
+// Prefix of the checkpoints this class creates and may delete
+const QString CheckpointPrefix = QStringLiteral("qvirt-");
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+bool isActive(const Domain *domain)
+{
+    const Domain::State state = domain->state();
+    return state == Domain::StateRunning || state == Domain::StatePaused
+        || state == Domain::StateBlocked;
+}
+
+QString modeName(BackupRecord::Mode mode)
+{
+    return mode == BackupRecord::Incremental ? QStringLiteral("incremental")
+                                             : QStringLiteral("full");
+}
+
+} // namespace
+
+BackupCatalog::BackupCatalog(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+int BackupCatalog::incrementalsSinceFull() const
+{
+    int count = 0;
+    for (int i = int(m_records.size()) - 1; i >= 0; --i) {
+        if (m_records.at(i).mode == BackupRecord::Full) {
+            return count;
+        }
+        count++;
+    }
+    return -1;
+}
+
+QList<BackupRecord> BackupCatalog::restoreChain(int index) const
+{
+    QList<BackupRecord> chain;
+    if (index < 0 || index >= int(m_records.size())) {
+        return chain;
+    }
+
+    chain.append(m_records.at(index));
+    int current = index;
+    while (chain.first().mode == BackupRecord::Incremental) {
+        const QString parent = chain.first().parentCheckpoint;
+        int found = -1;
+        for (int i = current - 1; i >= 0; --i) {
+            if (m_records.at(i).checkpoint == parent) {
+                found = i;
+                break;
+            }
+        }
+        if (found < 0) {
+            // A link is missing: the backup cannot be restored
+            return QList<BackupRecord>();
+        }
+        chain.prepend(m_records.at(found));
+        current = found;
+    }
+    return chain;
+}
+
+QString BackupCatalog::path(const BackupRecord &record) const
+{
+    return QDir(m_directory).filePath(record.directory);
+}
+
+bool BackupCatalog::load(QString *error)
+{
+    m_records.clear();
+
+    QFile file(QDir(m_directory).filePath(FileName));
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QObject::tr("Cannot read %1: %2").arg(file.fileName(), file.errorString());
+        }
+        return false;
+    }
+    if (!fromXML(QString::fromUtf8(file.readAll()))) {
+        if (error) {
+            *error = QObject::tr("%1 is not a backup catalog").arg(file.fileName());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool BackupCatalog::save(QString *error) const
+{
+    if (!QDir().mkpath(m_directory)) {
+        if (error) {
+            *error = QObject::tr("Cannot create %1").arg(m_directory);
+        }
+        return false;
+    }
+
+    // Written aside and renamed, so a crash never leaves half a catalog
+    QSaveFile file(QDir(m_directory).filePath(FileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = QObject::tr("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+        }
+        return false;
+    }
+    file.write(toXML().toUtf8());
+    if (!file.commit()) {
+        if (error) {
+            *error = QObject::tr("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+QString BackupCatalog::toXML() const
+{
+    QDomDocument doc;
+    QDomElement root = doc.createElement("backups");
+    doc.appendChild(root);
+
+    for (const BackupRecord &record : m_records) {
+        QDomElement backup = doc.createElement("backup");
+        backup.setAttribute("mode", modeName(record.mode));
+        backup.setAttribute("checkpoint", record.checkpoint);
+        if (!record.parentCheckpoint.isEmpty()) {
+            backup.setAttribute("parent", record.parentCheckpoint);
+        }
+        backup.setAttribute("started", record.started.toString(Qt::ISODate));
+        backup.setAttribute("finished", record.finished.toString(Qt::ISODate));
+        backup.setAttribute("directory", record.directory);
+        backup.setAttribute("bytes", QString::number(record.bytes));
+        for (const QString &disk : record.disks) {
+            QDomElement element = doc.createElement("disk");
+            element.setAttribute("name", disk);
+            backup.appendChild(element);
+        }
+        root.appendChild(backup);
+    }
+    return doc.toString(2);
+}
+
+bool BackupCatalog::fromXML(const QString &xml)
+{
+    QDomDocument doc;
+    if (!doc.setContent(xml) || doc.documentElement().tagName() != "backups") {
+        return false;
+    }
+
+    QList<BackupRecord> records;
+    QDomElement root = doc.documentElement();
+    for (QDomElement backup = root.firstChildElement("backup"); !backup.isNull();
+         backup = backup.nextSiblingElement("backup")) {
+        BackupRecord record;
+        record.mode = backup.attribute("mode") == "incremental" ? BackupRecord::Incremental
+                                                                : BackupRecord::Full;
+        record.checkpoint = backup.attribute("checkpoint");
+        record.parentCheckpoint = backup.attribute("parent");
+        record.started = QDateTime::fromString(backup.attribute("started"), Qt::ISODate);
+        record.finished = QDateTime::fromString(backup.attribute("finished"), Qt::ISODate);
+        record.directory = backup.attribute("directory");
+        record.bytes = backup.attribute("bytes").toLongLong();
+        for (QDomElement disk = backup.firstChildElement("disk"); !disk.isNull();
+             disk = disk.nextSiblingElement("disk")) {
+            record.disks.append(disk.attribute("name"));
+        }
+        records.append(record);
+    }
+    m_records = records;
+    return true;
+}
+
+/**
+ * Parameters of one backup and a reference of its own on the domain,
+ * shared with the workers that start, poll and finish it.
+ */
+struct BackupJob::Work
+{
+    ~Work()
+    {
+        if (domain) {
+            virDomainFree(domain);
+        }
+    }
+
+    virDomainPtr domain = nullptr;
+    QString catalogDir;
+    BackupJob::Mode requested = BackupJob::Auto;
+
+    // Set on the GUI thread once the backup has begun
+    BackupRecord record;
+};
+
+namespace {
+
+struct StartResult {
+    QString error;
+    BackupRecord record;
+    QStringList skipped;
+    qint64 changed = -1;
+};
+
+struct PollResult {
+    int status = -1;                // -1 on error, 0 once the job is gone, 1 running
+    qint64 processed = 0;
+    qint64 total = 0;
+    QString error;
+};
+
+struct FinalResult {
+    BackupJob::State state = BackupJob::Failed;
+    qint64 processed = -1;
+    QString error;
+};
+
+void readProgress(virTypedParameterPtr params, int nparams, qint64 *processed, qint64 *total)
+{
+    // Backups report disk_*; fall back to the generic data_* fields
+    unsigned long long value = 0;
+    if (virTypedParamsGetULLong(params, nparams, VIR_DOMAIN_JOB_DISK_PROCESSED, &value) == 1
+        || virTypedParamsGetULLong(params, nparams, VIR_DOMAIN_JOB_DATA_PROCESSED, &value) == 1) {
+        *processed = qint64(value);
+    }
+    if (virTypedParamsGetULLong(params, nparams, VIR_DOMAIN_JOB_DISK_TOTAL, &value) == 1
+        || virTypedParamsGetULLong(params, nparams, VIR_DOMAIN_JOB_DATA_TOTAL, &value) == 1) {
+        *total = qint64(value);
+    }
+}
+
+StartResult beginBackup(const std::shared_ptr<BackupJob::Work> &work)
+{
+    StartResult result;
+#if LIBVIR_CHECK_VERSION(6, 0, 0)
+    char *xml = virDomainGetXMLDesc(work->domain, 0);
+    if (!xml) {
+        result.error = lastErrorMessage(QStringLiteral("Failed to read the domain XML"));
+        return result;
+    }
+    const QList<BackupManager::Disk> disks = BackupManager::backupDisks(QString::fromUtf8(xml));
+    free(xml);
+
+    BackupRecord &record = result.record;
+    for (const BackupManager::Disk &disk : disks) {
+        if (disk.eligible) {
+            record.disks.append(disk.name);
+        } else {
+            result.skipped.append(disk.name);
+        }
+    }
+    if (record.disks.isEmpty()) {
+        result.error = QStringLiteral("No qcow2 disk to back up");
+        return result;
+    }
+
+    BackupCatalog catalog(work->catalogDir);
+    if (!catalog.load(&result.error)) {
+        return result;
+    }
+
+    // Incremental against the last backup's checkpoint, if libvirt still has it
+    const QString parent = catalog.last().checkpoint;
+    if (work->requested != BackupJob::Full && !parent.isEmpty()) {
+        const QByteArray parentName = parent.toUtf8();
+        virDomainCheckpointPtr handle =
+            virDomainCheckpointLookupByName(work->domain, parentName.constData(), 0);
+        if (handle) {
+            DomainCheckpoint checkpoint(nullptr, handle);
+            if (checkpoint.reload(true)) {
+                result.changed = checkpoint.changedBytes();
+            }
+            record.mode = BackupRecord::Incremental;
+            record.parentCheckpoint = parent;
+        }
+    }
+    if (work->requested == BackupJob::Incremental && record.mode != BackupRecord::Incremental) {
+        result.error = QStringLiteral("The last backup's checkpoint is gone; "
+                                      "a full backup is needed first");
+        return result;
+    }
+
+    record.started = QDateTime::currentDateTime();
+    const QString stamp = record.started.toString("yyyyMMdd-HHmmss");
+    record.checkpoint = CheckpointPrefix + stamp;
+    record.directory = stamp;
+
+    QDir catalogDir(work->catalogDir);
+    if (catalogDir.exists(stamp) || !catalogDir.mkpath(stamp)) {
+        result.error = QString("Cannot create backup directory %1").arg(catalogDir.filePath(stamp));
+        return result;
+    }
+
+    const QString description = QString("%1 backup by QVirt-Manager").arg(modeName(record.mode));
+    const QByteArray backupXml = BackupManager::backupXML(disks, catalogDir.filePath(stamp),
+                                                          record.parentCheckpoint).toUtf8();
+    const QByteArray checkpointXml = BackupManager::checkpointXML(disks, record.checkpoint,
+                                                                  description).toUtf8();
+
+    // Creates the checkpoint and starts the copy in one step
+    if (virDomainBackupBegin(work->domain, backupXml.constData(), checkpointXml.constData(),
+                             0) < 0) {
+        result.error = lastErrorMessage(QStringLiteral("Failed to start the backup"));
+        QDir(catalogDir.filePath(stamp)).removeRecursively();
+    }
+#else
+    Q_UNUSED(work);
+    result.error = QStringLiteral("Backups need libvirt 6.0 or newer");
+#endif
+    return result;
+}
+
+PollResult pollBackup(const std::shared_ptr<BackupJob::Work> &work)
+{
+    PollResult result;
+    int type = VIR_DOMAIN_JOB_NONE;
+    virTypedParameterPtr params = nullptr;
+    int nparams = 0;
+    if (virDomainGetJobStats(work->domain, &type, &params, &nparams, 0) < 0) {
+        result.error = lastErrorMessage(QStringLiteral("Failed to query the backup"));
+        return result;
+    }
+    result.status = type == VIR_DOMAIN_JOB_NONE ? 0 : 1;
+    readProgress(params, nparams, &result.processed, &result.total);
+    virTypedParamsFree(params, nparams);
+    return result;
+}
+
+QString abortBackup(const std::shared_ptr<BackupJob::Work> &work)
+{
+    if (virDomainAbortJob(work->domain) < 0) {
+        return lastErrorMessage(QStringLiteral("Failed to abort the backup"));
+    }
+    return QString();
+}
+
+void deleteCheckpoint(virDomainPtr domain, const QString &name)
+{
+    const QByteArray utf8 = name.toUtf8();
+    virDomainCheckpointPtr checkpoint = virDomainCheckpointLookupByName(domain, utf8.constData(), 0);
+    if (!checkpoint) {
+        return;
+    }
+    if (virDomainCheckpointDelete(checkpoint, 0) < 0) {
+        qWarning() << "Failed to delete checkpoint" << name << ":"
+                   << lastErrorMessage(QStringLiteral("unknown error"));
+    }
+    virDomainCheckpointFree(checkpoint);
+}
+
+// A new chain starts with a full backup; the older checkpoints only cost bitmaps
+void pruneCheckpoints(virDomainPtr domain, const QString &keep)
+{
+    virDomainCheckpointPtr *checkpoints = nullptr;
+    int count = virDomainListAllCheckpoints(domain, &checkpoints, 0);
+    for (int i = 0; i < count; ++i) {
+        const char *name = virDomainCheckpointGetName(checkpoints[i]);
+        const QString checkpointName = name ? QString::fromUtf8(name) : QString();
+        if (checkpointName.startsWith(CheckpointPrefix) && checkpointName != keep
+            && virDomainCheckpointDelete(checkpoints[i], 0) < 0) {
+            qWarning() << "Failed to delete checkpoint" << checkpointName << ":"
+                       << lastErrorMessage(QStringLiteral("unknown error"));
+        }
+        virDomainCheckpointFree(checkpoints[i]);
+    }
+    free(checkpoints);
+}
+
+FinalResult finishBackup(const std::shared_ptr<BackupJob::Work> &work)
+{
+    FinalResult result;
+    const BackupRecord &record = work->record;
+    const QString directory = QDir(work->catalogDir).filePath(record.directory);
+
+    int type = VIR_DOMAIN_JOB_NONE;
+    virTypedParameterPtr params = nullptr;
+    int nparams = 0;
+    if (virDomainGetJobStats(work->domain, &type, &params, &nparams,
+                             VIR_DOMAIN_JOB_STATS_COMPLETED) == 0 && type != VIR_DOMAIN_JOB_NONE) {
+        qint64 total = 0;
+        readProgress(params, nparams, &result.processed, &total);
+        if (type == VIR_DOMAIN_JOB_COMPLETED) {
+            result.state = BackupJob::Finished;
+        } else {
+            result.state = type == VIR_DOMAIN_JOB_CANCELLED ? BackupJob::Cancelled
+                                                            : BackupJob::Failed;
+#ifdef VIR_DOMAIN_JOB_ERRMSG
+            const char *message = nullptr;
+            if (virTypedParamsGetString(params, nparams, VIR_DOMAIN_JOB_ERRMSG, &message) == 1
+                && message) {
+                result.error = QString::fromUtf8(message);
+            }
+#endif
+            if (result.error.isEmpty() && result.state == BackupJob::Failed) {
+                result.error = QStringLiteral("The hypervisor reported the backup as failed");
+            }
+        }
+        virTypedParamsFree(params, nparams);
+    } else {
+        // Another client collected the statistics: go by the images
+        result.state = BackupJob::Finished;
+        for (const QString &disk : record.disks) {
+            if (QFileInfo(QDir(directory).filePath(disk + ".qcow2")).size() <= 0) {
+                result.state = BackupJob::Failed;
+                result.error = QStringLiteral("The backup ended without a result");
+                break;
+            }
+        }
+    }
+
+    if (result.state == BackupJob::Finished) {
+        BackupCatalog catalog(work->catalogDir);
+        BackupRecord done = record;
+        done.finished = QDateTime::currentDateTime();
+        done.bytes = qMax<qint64>(0, result.processed);
+        if (catalog.load(&result.error)) {
+            catalog.append(done);
+            if (catalog.save(&result.error)) {
+                if (done.mode == BackupRecord::Full) {
+                    pruneCheckpoints(work->domain, done.checkpoint);
+                }
+                return result;
+            }
+        }
+        result.state = BackupJob::Failed;
+    }
+
+    // Deleting the checkpoint merges its bitmap into the parent's, so the
+    // next incremental backup still copies everything written since
+    deleteCheckpoint(work->domain, record.checkpoint);
+    QDir(directory).removeRecursively();
+    return result;
+}
+
+} // namespace
+
+BackupJob::BackupJob(Domain *domain, const QString &targetDir, Mode mode, QObject *parent)
+    : QObject(parent)
+    , m_state(Queued)
+    , m_domain(domain)
+    , m_targetDir(targetDir)
+    , m_mode(mode)
+    , m_processed(0)
+    , m_total(0)
+    , m_changed(-1)
+    , m_runningMs(-1)
+    , m_abortRequested(false)
+    , m_cancelWhenStarted(false)
+    , m_pollInFlight(false)
+    , m_failedPolls(0)
+{
+    if (domain) {
+        m_domainName = domain->name();
+        m_domainUuid = domain->uuid();
+        if (domain->connection()) {
+            m_connectionUri = domain->connection()->uri();
+        }
+    }
+}
+
+BackupJob::~BackupJob() = default;
+
+qint64 BackupJob::elapsedMs() const
+{
+    if (m_runningMs >= 0) {
+        return m_runningMs;
+    }
+    return m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+qint64 BackupJob::throughput() const
+{
+    const qint64 ms = elapsedMs();
+    return ms > 0 ? m_processed * 1000 / ms : 0;
+}
+
+void BackupJob::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    if (state == Running) {
+        m_clock.start();
+    } else if (isDone() && m_clock.isValid()) {
+        m_runningMs = m_clock.elapsed();
+    }
+    emit stateChanged(state);
+}
+
+void BackupJob::setProgress(qint64 processed, qint64 total)
+{
+    total = qMax<qint64>(0, total);
+    processed = qMax<qint64>(0, processed);
+    if (processed != m_processed || total != m_total) {
+        m_processed = processed;
+        m_total = total;
+        emit progress(m_processed, m_total);
+    }
+}
+
+BackupManager *BackupManager::s_instance = nullptr;
+
+BackupManager::BackupManager(QObject *parent)
+    : QObject(parent)
+    , m_maxConcurrent(DefaultMaxConcurrent)
+    , m_pollTimer(new QTimer(this))
+    , m_policyTimer(new QTimer(this))
+{
+    m_pollTimer->setInterval(PollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &BackupManager::pollProgress);
+
+    m_policyTimer->setInterval(PolicyCheckIntervalMs);
+    connect(m_policyTimer, &QTimer::timeout, this, &BackupManager::runDuePolicies);
+}
+
+BackupManager::~BackupManager()
+{
+    // Running backups go on in QEMU; the next start finds their checkpoints
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+BackupManager *BackupManager::instance()
+{
+    if (!s_instance) {
+        s_instance = new BackupManager();
+    }
+    return s_instance;
+}
+
+BackupJob *BackupManager::backup(Domain *domain, const QString &targetDir, BackupJob::Mode mode)
+{
+    if (!domain || !domain->rawDomain()) {
+        return failed(domain, targetDir, mode, tr("No domain"));
+    }
+    if (!isActive(domain)) {
+        return failed(domain, targetDir, mode, tr("Backups need a running domain"));
+    }
+    if (targetDir.isEmpty()) {
+        return failed(domain, targetDir, mode, tr("No backup directory"));
+    }
+    // QEMU writes the images on its host, while the catalog is kept here
+    if (domain->connection() && !domain->connection()->isLocal()) {
+        return failed(domain, targetDir, mode,
+                      tr("Backups are only supported on local connections: the backup "
+                         "directory must be on the host that runs the VM"));
+    }
+
+    auto work = std::make_shared<BackupJob::Work>();
+    work->domain = domain->rawDomain();
+    virDomainRef(work->domain);
+    work->catalogDir = catalogDirectory(targetDir, domain->name());
+    work->requested = mode;
+
+    auto *job = new BackupJob(domain, targetDir, mode, this);
+    job->m_work = work;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+
+    // Start from the event loop so callers can connect to the job first
+    QTimer::singleShot(0, this, &BackupManager::schedule);
+    return job;
+}
+
+BackupJob *BackupManager::failed(Domain *domain, const QString &targetDir, BackupJob::Mode mode,
+                                 const QString &error)
+{
+    auto *job = new BackupJob(domain, targetDir, mode, this);
+    job->m_error = error;
+    job->m_state = BackupJob::Failed;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+    QTimer::singleShot(0, this, [this, job]() {
+        emit job->stateChanged(BackupJob::Failed);
+        emit jobFinished(job);
+    });
+    return job;
+}
+
+void BackupManager::cancel(BackupJob *job)
+{
+    if (!job || !m_jobs.contains(job) || !job->isCancellable()) {
+        return;
+    }
+
+    switch (job->m_state) {
+    case BackupJob::Queued:
+        job->m_work.reset();
+        job->setState(BackupJob::Cancelled);
+        emit jobFinished(job);
+        break;
+    case BackupJob::Starting:
+        job->m_cancelWhenStarted = true;
+        emit job->stateChanged(job->m_state);
+        break;
+    default:
+        abort(job);
+        break;
+    }
+}
+
+QList<DomainCheckpoint*> BackupManager::checkpoints(Domain *domain, QObject *parent) const
+{
+    QList<DomainCheckpoint*> result;
+    if (!domain || !domain->rawDomain()) {
+        return result;
+    }
+
+    virDomainCheckpointPtr *checkpoints = nullptr;
+    int count = virDomainListAllCheckpoints(domain->rawDomain(), &checkpoints,
+                                            VIR_DOMAIN_CHECKPOINT_LIST_TOPOLOGICAL);
+    for (int i = 0; i < count; ++i) {
+        // Takes over the reference
+        result.append(new DomainCheckpoint(domain->connection(), checkpoints[i], parent));
+    }
+    free(checkpoints);
+    return result;
+}
+
+QList<BackupJob*> BackupManager::jobs(Domain *domain) const
+{
+    QList<BackupJob*> result;
+    if (!domain) {
+        return result;
+    }
+    const QString uuid = domain->uuid();
+    for (BackupJob *job : m_jobs) {
+        if (job->m_domainUuid == uuid) {
+            result.append(job);
+        }
+    }
+    return result;
+}
+
+int BackupManager::activeCount() const
+{
+    int count = 0;
+    for (BackupJob *job : m_jobs) {
+        if (!job->isDone()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void BackupManager::clearFinished()
+{
+    for (int i = int(m_jobs.size()) - 1; i >= 0; --i) {
+        BackupJob *job = m_jobs.at(i);
+        if (job->isDone()) {
+            m_jobs.removeAt(i);
+            emit jobRemoved(job);
+            job->deleteLater();
+        }
+    }
+}
+
+void BackupManager::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    schedule();
+}
+
+void BackupManager::addConnection(Connection *connection)
+{
+    if (!connection || m_connections.contains(connection)) {
+        return;
+    }
+    m_connections.append(connection);
+    if (!m_policyTimer->isActive()) {
+        m_policyTimer->start();
+    }
+}
+
+void BackupManager::removeConnection(Connection *connection)
+{
+    m_connections.removeAll(connection);
+    m_connections.removeAll(QPointer<Connection>());
+    if (m_connections.isEmpty()) {
+        m_policyTimer->stop();
+    }
+}
+
+QString BackupManager::catalogDirectory(const QString &targetDir, const QString &domainName)
+{
+    return QDir(targetDir).filePath(domainName);
+}
+
+QList<BackupManager::Disk> BackupManager::backupDisks(const QString &domainXml)
+{
+    QList<Disk> disks;
+    QDomDocument doc;
+    if (!doc.setContent(domainXml)) {
+        return disks;
+    }
+
+    QDomElement devices = doc.documentElement().firstChildElement("devices");
+    for (QDomElement element = devices.firstChildElement("disk"); !element.isNull();
+         element = element.nextSiblingElement("disk")) {
+        if (element.attribute("device", "disk") != "disk") {
+            continue;
+        }
+        Disk disk;
+        disk.name = element.firstChildElement("target").attribute("dev");
+        if (disk.name.isEmpty()) {
+            continue;
+        }
+        disk.format = element.firstChildElement("driver").attribute("type");
+
+        // Dirty bitmaps live in the qcow2 image itself
+        disk.eligible = disk.format == "qcow2"
+            && element.firstChildElement("readonly").isNull()
+            && !element.firstChildElement("source").isNull();
+        disks.append(disk);
+    }
+    return disks;
+}
+
+QString BackupManager::backupXML(const QList<Disk> &disks, const QString &directory,
+                                 const QString &incremental)
+{
+    QString xml = "<domainbackup mode='push'>\n";
+    if (!incremental.isEmpty()) {
+        xml += QString("  <incremental>%1</incremental>\n").arg(incremental.toHtmlEscaped());
+    }
+    xml += "  <disks>\n";
+    for (const Disk &disk : disks) {
+        if (!disk.eligible) {
+            xml += QString("    <disk name='%1' backup='no'/>\n").arg(disk.name.toHtmlEscaped());
+            continue;
+        }
+        const QString target = QDir(directory).filePath(disk.name + ".qcow2");
+        xml += QString("    <disk name='%1' backup='yes' type='file'>\n"
+                       "      <target file='%2'/>\n"
+                       "      <driver type='qcow2'/>\n"
+                       "    </disk>\n")
+                   .arg(disk.name.toHtmlEscaped(), target.toHtmlEscaped());
+    }
+    xml += "  </disks>\n"
+           "</domainbackup>";
+    return xml;
+}
+
+QString BackupManager::checkpointXML(const QList<Disk> &disks, const QString &name,
+                                     const QString &description)
+{
+    DomainCheckpoint checkpoint;
+    checkpoint.setName(name);
+    checkpoint.setDescription(description);
+
+    QList<DomainCheckpoint::Disk> checkpointDisks;
+    for (const Disk &disk : disks) {
+        DomainCheckpoint::Disk entry;
+        entry.name = disk.name;
+        entry.checkpoint = disk.eligible ? QStringLiteral("bitmap") : QStringLiteral("no");
+        checkpointDisks.append(entry);
+    }
+    checkpoint.setDisks(checkpointDisks);
+    return checkpoint.toXML();
+}
+
+bool BackupManager::isDue(const BackupPolicy &policy, const QDateTime &now)
+{
+    if (!policy.enabled || policy.targetDir.isEmpty()) {
+        return false;
+    }
+    return policy.lastRun <= 0
+        || now.toSecsSinceEpoch() - policy.lastRun >= qint64(policy.intervalHours) * 3600;
+}
+
+BackupJob::Mode BackupManager::policyMode(const BackupPolicy &policy, const BackupCatalog &catalog)
+{
+    if (policy.fullEvery <= 0) {
+        return BackupJob::Auto;
+    }
+    const int incrementals = catalog.incrementalsSinceFull();
+    return incrementals < 0 || incrementals >= policy.fullEvery ? BackupJob::Full
+                                                                : BackupJob::Auto;
+}
+
+void BackupManager::runDuePolicies()
+{
+    Config *config = Config::instance();
+    const QDateTime now = QDateTime::currentDateTime();
+    m_connections.removeAll(QPointer<Connection>());
+
+    for (const QPointer<Connection> &connection : m_connections) {
+        const QString uri = connection->uri();
+        const QStringList uuids = config->backupPolicyUUIDs(uri);
+        for (const QString &uuid : uuids) {
+            const BackupPolicy policy = config->vmBackupPolicy(uri, uuid);
+            if (!isDue(policy, now)
+                || now.toSecsSinceEpoch() - m_lastAttempt.value(uuid) < PolicyRetrySecs) {
+                continue;
+            }
+
+            Domain *domain = connection->getDomainByUUID(uuid);
+            if (!domain || !isActive(domain)) {
+                continue;
+            }
+            bool busy = false;
+            for (BackupJob *job : m_jobs) {
+                if (!job->isDone() && job->m_domainUuid == uuid) {
+                    busy = true;
+                    break;
+                }
+            }
+            if (busy) {
+                continue;
+            }
+
+            BackupCatalog catalog(catalogDirectory(policy.targetDir, domain->name()));
+            catalog.load();
+            m_lastAttempt.insert(uuid, now.toSecsSinceEpoch());
+            backup(domain, policy.targetDir, policyMode(policy, catalog));
+        }
+    }
+}
+
+void BackupManager::schedule()
+{
+    int running = 0;
+    for (BackupJob *job : m_jobs) {
+        if (job->m_state == BackupJob::Starting || job->m_state == BackupJob::Running) {
+            running++;
+        }
+    }
+
+    // Oldest first; QEMU runs one backup per domain
+    for (BackupJob *job : m_jobs) {
+        if (running >= m_maxConcurrent) {
+            break;
+        }
+        if (job->m_state == BackupJob::Queued && !domainBusy(job)) {
+            start(job);
+            running++;
+        }
+    }
+}
+
+void BackupManager::start(BackupJob *job)
+{
+    job->setState(BackupJob::Starting);
+    if (!m_pollTimer->isActive()) {
+        m_pollTimer->start();
+    }
+
+    std::shared_ptr<BackupJob::Work> work = job->m_work;
+    QPointer<BackupJob> guard(job);
+
+    auto *watcher = new QFutureWatcher<StartResult>(this);
+    connect(watcher, &QFutureWatcher<StartResult>::finished, this, [this, watcher, guard]() {
+        const StartResult result = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        BackupJob *job = guard;
+        job->m_skippedDisks = result.skipped;
+        if (!result.error.isEmpty()) {
+            finish(job, BackupJob::Failed, result.error);
+            return;
+        }
+
+        job->m_work->record = result.record;
+        job->m_mode = result.record.mode == BackupRecord::Incremental ? BackupJob::Incremental
+                                                                      : BackupJob::Full;
+        job->m_checkpoint = result.record.checkpoint;
+        job->m_parentCheckpoint = result.record.parentCheckpoint;
+        job->m_directory = QDir(job->m_work->catalogDir).filePath(result.record.directory);
+        job->m_changed = result.changed;
+        job->setState(BackupJob::Running);
+
+        if (job->m_cancelWhenStarted) {
+            job->m_cancelWhenStarted = false;
+            abort(job);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([work]() {
+        return beginBackup(work);
+    }));
+}
+
+void BackupManager::abort(BackupJob *job)
+{
+    if (!job->m_work || job->m_abortRequested) {
+        return;
+    }
+    job->m_abortRequested = true;
+    emit job->stateChanged(job->m_state);
+
+    std::shared_ptr<BackupJob::Work> work = job->m_work;
+    QPointer<BackupJob> guard(job);
+
+    // The poll notices the end of the job and cleans up
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [watcher, guard]() {
+        const QString error = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone() || error.isEmpty()) {
+            return;
+        }
+        guard->m_abortRequested = false;
+        guard->m_error = error;
+        qWarning() << "Backup of" << guard->m_domainName << "abort failed:" << error;
+        emit guard->stateChanged(guard->m_state);
+    });
+    watcher->setFuture(QtConcurrent::run([work]() {
+        return abortBackup(work);
+    }));
+}
+
+void BackupManager::pollProgress()
+{
+    for (BackupJob *job : m_jobs) {
+        if (job->m_state != BackupJob::Running || job->m_pollInFlight || !job->m_work) {
+            continue;
+        }
+
+        job->m_pollInFlight = true;
+        std::shared_ptr<BackupJob::Work> work = job->m_work;
+        QPointer<BackupJob> guard(job);
+
+        auto *watcher = new QFutureWatcher<PollResult>(this);
+        connect(watcher, &QFutureWatcher<PollResult>::finished, this, [this, watcher, guard]() {
+            const PollResult result = watcher->result();
+            watcher->deleteLater();
+            if (!guard || guard->isDone()) {
+                return;
+            }
+            BackupJob *job = guard;
+
+            if (result.status < 0) {
+                job->m_pollInFlight = false;
+                if (++job->m_failedPolls >= MaxFailedPolls) {
+                    // The domain went away; the checkpoint went with it
+                    finish(job, BackupJob::Failed, result.error);
+                }
+                return;
+            }
+            job->m_failedPolls = 0;
+
+            if (result.status > 0) {
+                job->m_pollInFlight = false;
+                job->setProgress(result.processed, result.total);
+                return;
+            }
+
+            // Still marked in flight so no further poll starts while finishing
+            complete(job);
+        });
+        watcher->setFuture(QtConcurrent::run([work]() {
+            return pollBackup(work);
+        }));
+    }
+}
+
+void BackupManager::complete(BackupJob *job)
+{
+    std::shared_ptr<BackupJob::Work> work = job->m_work;
+    QPointer<BackupJob> guard(job);
+
+    auto *watcher = new QFutureWatcher<FinalResult>(this);
+    connect(watcher, &QFutureWatcher<FinalResult>::finished, this, [this, watcher, guard]() {
+        const FinalResult result = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        BackupJob *job = guard;
+        job->m_pollInFlight = false;
+        if (result.processed >= 0) {
+            job->setProgress(result.processed, qMax(job->m_total, result.processed));
+        }
+        finish(job, result.state, result.error);
+    });
+    watcher->setFuture(QtConcurrent::run([work]() {
+        return finishBackup(work);
+    }));
+}
+
+void BackupManager::finish(BackupJob *job, BackupJob::State state, const QString &error)
+{
+    if (job->isDone()) {
+        return;
+    }
+
+    job->m_work.reset();
+    if (!error.isEmpty()) {
+        job->m_error = error;
+    }
+    if (state == BackupJob::Failed) {
+        qWarning() << "Backup of" << job->m_domainName << "failed:" << job->m_error;
+    }
+    job->setState(state);
+
+    // Policies count from the last good backup, whoever started it
+    if (state == BackupJob::Finished && !job->m_connectionUri.isEmpty()) {
+        Config *config = Config::instance();
+        if (config->backupPolicyUUIDs(job->m_connectionUri).contains(job->m_domainUuid)) {
+            config->setVMBackupLastRun(job->m_connectionUri, job->m_domainUuid,
+                                       QDateTime::currentDateTime().toSecsSinceEpoch());
+        }
+    }
+
+    emit jobFinished(job);
+
+    bool busy = false;
+    for (BackupJob *other : m_jobs) {
+        if (other->m_state == BackupJob::Starting || other->m_state == BackupJob::Running) {
+            busy = true;
+            break;
+        }
+    }
+    if (!busy) {
+        m_pollTimer->stop();
+    }
+    schedule();
+}
+
+bool BackupManager::domainBusy(const BackupJob *job) const
+{
+    for (BackupJob *other : m_jobs) {
+        if (other != job && other->m_domainUuid == job->m_domainUuid
+            && (other->m_state == BackupJob::Starting || other->m_state == BackupJob::Running)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace QVirt
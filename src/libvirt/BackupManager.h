@@ -0,0 +1,286 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_BACKUPMANAGER_H
+#define QVIRT_LIBVIRT_BACKUPMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QDateTime>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <memory>
+
+#include "../core/Config.h"
+
+class QTimer;
+
+namespace QVirt {
+
+class Connection;
+class Domain;
+class DomainCheckpoint;
+
+/**
+ * @brief One backup in a BackupCatalog
+ */
+struct BackupRecord
+{
+    enum Mode {
+        Full,
+        Incremental
+    };
+
+    Mode mode = Full;
+    QString checkpoint;             // Created with the backup
+    QString parentCheckpoint;       // Incremental: what the changes are relative to
+    QDateTime started;
+    QDateTime finished;
+    QString directory;              // Below the catalog directory
+    QStringList disks;              // Target devices, one <disk>.qcow2 each
+    qint64 bytes = 0;               // Bytes copied
+};
+
+/**
+ * @brief The backups of one VM, listed in backups.xml next to them
+ *
+ * Each backup is a directory of qcow2 images, one per disk. An
+ * incremental image only holds the blocks written since its parent
+ * checkpoint, so restoring it needs the chain back to the last full
+ * backup; restoreChain() lists it.
+ */
+class BackupCatalog
+{
+public:
+    static constexpr const char *FileName = "backups.xml";
+
+    explicit BackupCatalog(const QString &directory = QString());
+
+    QString directory() const { return m_directory; }
+    QList<BackupRecord> records() const { return m_records; }
+    bool isEmpty() const { return m_records.isEmpty(); }
+    BackupRecord last() const { return m_records.isEmpty() ? BackupRecord() : m_records.last(); }
+    void append(const BackupRecord &record) { m_records.append(record); }
+
+    // Incremental backups after the last full one, -1 if there is none
+    int incrementalsSinceFull() const;
+
+    // The full backup and the incrementals up to record @p index, oldest first
+    QList<BackupRecord> restoreChain(int index) const;
+
+    QString path(const BackupRecord &record) const;
+
+    // A missing file is an empty catalog
+    bool load(QString *error = nullptr);
+    bool save(QString *error = nullptr) const;
+
+    QString toXML() const;
+    bool fromXML(const QString &xml);
+
+private:
+    QString m_directory;
+    QList<BackupRecord> m_records;
+};
+
+/**
+ * @brief One push-mode backup of a running domain
+ */
+class BackupJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        Auto,           // Incremental when the last checkpoint is still there
+        Full,
+        Incremental
+    };
+
+    enum State {
+        Queued,
+        Starting,
+        Running,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    ~BackupJob() override;
+
+    State state() const { return m_state; }
+    bool isDone() const { return m_state >= Finished; }
+    bool isCancellable() const { return !isDone() && !m_abortRequested && !m_cancelWhenStarted; }
+
+    Domain *domain() const { return m_domain; }
+    QString domainName() const { return m_domainName; }
+    QString targetDir() const { return m_targetDir; }
+
+    // Auto until started, then what was actually done
+    Mode mode() const { return m_mode; }
+    QString checkpoint() const { return m_checkpoint; }
+    QString parentCheckpoint() const { return m_parentCheckpoint; }
+    QString directory() const { return m_directory; }
+    QStringList skippedDisks() const { return m_skippedDisks; }
+    QString errorString() const { return m_error; }
+
+    qint64 processedBytes() const { return m_processed; }
+    qint64 totalBytes() const { return m_total; }
+
+    // Written since the parent checkpoint, -1 for full backups
+    qint64 changedBytes() const { return m_changed; }
+
+    // Average bytes/s while running
+    qint64 throughput() const;
+    qint64 elapsedMs() const;
+
+    // Parameters and handles shared with the workers; defined in the .cpp
+    struct Work;
+
+signals:
+    void stateChanged(QVirt::BackupJob::State state);
+    void progress(qint64 processed, qint64 total);
+
+private:
+    BackupJob(Domain *domain, const QString &targetDir, Mode mode, QObject *parent);
+    void setState(State state);
+    void setProgress(qint64 processed, qint64 total);
+
+    State m_state;
+    QPointer<Domain> m_domain;
+    QString m_domainName;
+    QString m_domainUuid;
+    QString m_connectionUri;
+    QString m_targetDir;
+    Mode m_mode;
+    QString m_checkpoint;
+    QString m_parentCheckpoint;
+    QString m_directory;
+    QStringList m_skippedDisks;
+    QString m_error;
+
+    qint64 m_processed;
+    qint64 m_total;
+    qint64 m_changed;
+    qint64 m_runningMs;             // Time spent running, once done
+    bool m_abortRequested;
+    bool m_cancelWhenStarted;
+    bool m_pollInFlight;
+    int m_failedPolls;
+    QElapsedTimer m_clock;
+
+    std::shared_ptr<Work> m_work;
+
+    friend class BackupManager;
+};
+
+/**
+ * @brief Runs incremental backups and the per-VM backup schedule
+ *
+ * A backup starts with virDomainBackupBegin() in push mode: QEMU writes
+ * one qcow2 image per disk into a new directory below the target, and a
+ * checkpoint created in the same step starts a dirty bitmap on every
+ * disk. The next backup is incremental against that checkpoint and only
+ * copies the blocks written since. The chain is recorded in a
+ * BackupCatalog per VM; when its last checkpoint is gone, or a policy
+ * asks for it, a full backup starts a new chain and older checkpoints
+ * are deleted.
+ *
+ * Only qcow2 disks can carry bitmaps; other disks are skipped and
+ * reported. At most maxConcurrent() backups run at a time.
+ *
+ * The target directory is a path on both QEMU's host and this one, so
+ * backups are refused on remote connections.
+ */
+class BackupManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxConcurrent = 2;
+
+    // Disk of a domain as far as backups are concerned
+    struct Disk {
+        QString name;               // Target device
+        QString format;
+        bool eligible = false;      // Writable qcow2 disk
+    };
+
+    explicit BackupManager(QObject *parent = nullptr);
+    ~BackupManager() override;
+
+    static BackupManager *instance();
+
+    BackupJob *backup(Domain *domain, const QString &targetDir,
+                      BackupJob::Mode mode = BackupJob::Auto);
+    void cancel(BackupJob *job);
+
+    // Checkpoints of @p domain, parents first; the caller owns them
+    QList<DomainCheckpoint*> checkpoints(Domain *domain, QObject *parent = nullptr) const;
+
+    QList<BackupJob*> jobs() const { return m_jobs; }
+    QList<BackupJob*> jobs(Domain *domain) const;
+    int activeCount() const;
+    void clearFinished();
+
+    int maxConcurrent() const { return m_maxConcurrent; }
+    void setMaxConcurrent(int count);
+
+    // Run the backup policies of the domains on @p connection
+    void addConnection(Connection *connection);
+    void removeConnection(Connection *connection);
+
+    static QString catalogDirectory(const QString &targetDir, const QString &domainName);
+    static QList<Disk> backupDisks(const QString &domainXml);
+
+    // <domainbackup> writing each eligible disk to @p directory
+    static QString backupXML(const QList<Disk> &disks, const QString &directory,
+                             const QString &incremental);
+    static QString checkpointXML(const QList<Disk> &disks, const QString &name,
+                                 const QString &description);
+
+    static bool isDue(const BackupPolicy &policy, const QDateTime &now);
+    static BackupJob::Mode policyMode(const BackupPolicy &policy, const BackupCatalog &catalog);
+
+signals:
+    void jobAdded(QVirt::BackupJob *job);
+    void jobRemoved(QVirt::BackupJob *job);
+    void jobFinished(QVirt::BackupJob *job);
+
+private slots:
+    void schedule();
+    void pollProgress();
+    void runDuePolicies();
+
+private:
+    BackupJob *failed(Domain *domain, const QString &targetDir, BackupJob::Mode mode,
+                      const QString &error);
+    void start(BackupJob *job);
+    void abort(BackupJob *job);
+    void complete(BackupJob *job);
+    void finish(BackupJob *job, BackupJob::State state, const QString &error = QString());
+    bool domainBusy(const BackupJob *job) const;
+
+    QList<BackupJob*> m_jobs;
+    int m_maxConcurrent;
+    QTimer *m_pollTimer;
+    QTimer *m_policyTimer;
+    QList<QPointer<Connection>> m_connections;
+    QHash<QString, qint64> m_lastAttempt;   // Per domain UUID, for retries
+
+    static BackupManager *s_instance;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_BACKUPMANAGER_H
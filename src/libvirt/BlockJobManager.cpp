@@ -0,0 +1,936 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "BlockJobManager.h"
+#include "Domain.h"
+#include "EventLoop.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QDomDocument>
+#include <QTimer>
+#include <QDebug>
+#include <limits>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+constexpr int DefaultPollIntervalMs = 1000;
+
+// With events, a job missing from this many polls in a row is taken as
+// done even if its completion event never arrived
+constexpr int MaxMissingPolls = 5;
+
+// Polls failing in a row before the job is given up
+constexpr int MaxFailedPolls = 3;
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+// The legacy APIs take the bandwidth as unsigned long
+unsigned long bandwidthArgument(qint64 bandwidth)
+{
+    return bandwidth <= 0 ? 0
+        : static_cast<unsigned long>(qMin<quint64>(quint64(bandwidth),
+                                                   std::numeric_limits<unsigned long>::max()));
+}
+
+bool isActive(const Domain *domain)
+{
+    const Domain::State state = domain->state();
+    return state == Domain::StateRunning || state == Domain::StatePaused
+        || state == Domain::StateBlocked;
+}
+
+// Runs on libvirt's event thread
+void blockJobEventCallback(virConnectPtr conn, virDomainPtr dom, const char *disk,
+                           int type, int status, void *opaque)
+{
+    Q_UNUSED(conn);
+
+    char uuid[VIR_UUID_STRING_BUFLEN];
+    if (!dom || !disk || virDomainGetUUIDString(dom, uuid) < 0) {
+        return;
+    }
+    QMetaObject::invokeMethod(static_cast<BlockJobManager*>(opaque), "onBlockJobEvent",
+                              Qt::QueuedConnection,
+                              Q_ARG(QString, QString::fromUtf8(uuid)),
+                              Q_ARG(QString, QString::fromUtf8(disk)),
+                              Q_ARG(int, type), Q_ARG(int, status));
+}
+
+} // namespace
+
+/**
+ * Parameters of one job and a reference of its own on the domain, shared
+ * with the workers that start, poll and abort it.
+ */
+struct BlockJob::Work
+{
+    ~Work()
+    {
+        if (domain) {
+            virDomainFree(domain);
+        }
+    }
+
+    virDomainPtr domain = nullptr;
+    virConnectPtr connection = nullptr;     // Key into the event watches while watched
+    QByteArray disk;
+    QByteArray base;                        // Pull and commit; empty for the default
+    QByteArray top;                         // Commit
+    QByteArray destination;                 // Copy
+    QString format;                         // Copy
+    qint64 bandwidth = 0;
+    bool shallow = false;
+};
+
+namespace {
+
+struct PollResult {
+    int status = -1;                        // virDomainGetBlockJobInfo(): -1, 0 or 1
+    qint64 cursor = 0;
+    qint64 end = 0;
+    qint64 bandwidth = 0;
+    QString error;
+};
+
+const char *orNull(const QByteArray &value)
+{
+    return value.isEmpty() ? nullptr : value.constData();
+}
+
+QString copyDestinationXML(const QByteArray &destination, const QString &format)
+{
+    const QString path = QString::fromUtf8(destination).toHtmlEscaped();
+    const bool block = destination.startsWith("/dev/");
+    QString xml = block ? QString("<disk type='block'><source dev='%1'/>").arg(path)
+                        : QString("<disk type='file'><source file='%1'/>").arg(path);
+    if (!format.isEmpty()) {
+        xml += QString("<driver type='%1'/>").arg(format.toHtmlEscaped());
+    }
+    return xml + "</disk>";
+}
+
+// Older daemons only know the rebase form of a copy
+int startCopyByRebase(const std::shared_ptr<BlockJob::Work> &work)
+{
+    unsigned int flags = VIR_DOMAIN_BLOCK_REBASE_COPY | VIR_DOMAIN_BLOCK_REBASE_BANDWIDTH_BYTES;
+    if (work->shallow) {
+        flags |= VIR_DOMAIN_BLOCK_REBASE_SHALLOW;
+    }
+    if (work->format == QLatin1String("raw")) {
+        flags |= VIR_DOMAIN_BLOCK_REBASE_COPY_RAW;
+    }
+    return virDomainBlockRebase(work->domain, work->disk.constData(),
+                                work->destination.constData(),
+                                bandwidthArgument(work->bandwidth), flags);
+}
+
+int startCopy(const std::shared_ptr<BlockJob::Work> &work)
+{
+    const QByteArray xml = copyDestinationXML(work->destination, work->format).toUtf8();
+
+    virTypedParameterPtr params = nullptr;
+    int nparams = 0;
+    int maxparams = 0;
+    if (work->bandwidth > 0
+        && virTypedParamsAddULLong(&params, &nparams, &maxparams,
+                                   VIR_DOMAIN_BLOCK_COPY_BANDWIDTH,
+                                   quint64(work->bandwidth)) < 0) {
+        return -1;
+    }
+
+    unsigned int flags = work->shallow ? VIR_DOMAIN_BLOCK_COPY_SHALLOW : 0;
+#if LIBVIR_CHECK_VERSION(4, 5, 0)
+    // Persistent domains refuse a copy that would have to survive a restart
+    flags |= VIR_DOMAIN_BLOCK_COPY_TRANSIENT_JOB;
+#endif
+    int ret = virDomainBlockCopy(work->domain, work->disk.constData(), xml.constData(),
+                                 params, nparams, flags);
+    virTypedParamsFree(params, nparams);
+
+    if (ret < 0) {
+        virErrorPtr err = virGetLastError();
+        if (err && err->code == VIR_ERR_NO_SUPPORT) {
+            ret = startCopyByRebase(work);
+        }
+    }
+    return ret;
+}
+
+QString startJob(const std::shared_ptr<BlockJob::Work> &work, BlockJob::Type type)
+{
+    const unsigned long bandwidth = bandwidthArgument(work->bandwidth);
+    int ret = -1;
+
+    switch (type) {
+    case BlockJob::Pull:
+        if (work->base.isEmpty()) {
+            ret = virDomainBlockPull(work->domain, work->disk.constData(), bandwidth,
+                                     VIR_DOMAIN_BLOCK_PULL_BANDWIDTH_BYTES);
+        } else {
+            // Pulling down to a base needs the rebase form
+            ret = virDomainBlockRebase(work->domain, work->disk.constData(),
+                                       work->base.constData(), bandwidth,
+                                       VIR_DOMAIN_BLOCK_REBASE_BANDWIDTH_BYTES);
+        }
+        break;
+    case BlockJob::Commit:
+    case BlockJob::ActiveCommit: {
+        unsigned int flags = VIR_DOMAIN_BLOCK_COMMIT_BANDWIDTH_BYTES;
+        if (type == BlockJob::ActiveCommit) {
+            flags |= VIR_DOMAIN_BLOCK_COMMIT_ACTIVE;
+        }
+        ret = virDomainBlockCommit(work->domain, work->disk.constData(), orNull(work->base),
+                                   orNull(work->top), bandwidth, flags);
+        break;
+    }
+    case BlockJob::Copy:
+        ret = startCopy(work);
+        break;
+    }
+
+    return ret < 0 ? lastErrorMessage(QStringLiteral("Failed to start block job")) : QString();
+}
+
+QString abortJob(const std::shared_ptr<BlockJob::Work> &work, bool pivot)
+{
+    // Synchronous: returns once the job is gone or the disk switched over
+    if (virDomainBlockJobAbort(work->domain, work->disk.constData(),
+                               pivot ? VIR_DOMAIN_BLOCK_JOB_ABORT_PIVOT : 0) < 0) {
+        return lastErrorMessage(pivot ? QStringLiteral("Failed to pivot block job")
+                                      : QStringLiteral("Failed to abort block job"));
+    }
+    return QString();
+}
+
+QString setJobSpeed(const std::shared_ptr<BlockJob::Work> &work, qint64 bandwidth)
+{
+    if (virDomainBlockJobSetSpeed(work->domain, work->disk.constData(),
+                                  bandwidthArgument(bandwidth),
+                                  VIR_DOMAIN_BLOCK_JOB_SPEED_BANDWIDTH_BYTES) < 0) {
+        return lastErrorMessage(QStringLiteral("Failed to set block job speed"));
+    }
+    return QString();
+}
+
+PollResult pollJob(const std::shared_ptr<BlockJob::Work> &work)
+{
+    PollResult result;
+    virDomainBlockJobInfo info;
+    result.status = virDomainGetBlockJobInfo(work->domain, work->disk.constData(), &info,
+                                             VIR_DOMAIN_BLOCK_JOB_INFO_BANDWIDTH_BYTES);
+    if (result.status < 0) {
+        result.error = lastErrorMessage(QStringLiteral("Failed to query block job"));
+    } else if (result.status > 0) {
+        result.cursor = qint64(info.cur);
+        result.end = qint64(info.end);
+        result.bandwidth = qint64(info.bandwidth);
+    }
+    return result;
+}
+
+} // namespace
+
+BlockJob::BlockJob(Type type, Domain *domain, const QString &disk, QObject *parent)
+    : QObject(parent)
+    , m_type(type)
+    , m_state(Queued)
+    , m_domain(domain)
+    , m_disk(disk)
+    , m_processed(0)
+    , m_total(0)
+    , m_bandwidth(0)
+    , m_pivotWhenReady(false)
+    , m_abortRequested(false)
+    , m_pivotRequested(false)
+    , m_cancelWhenStarted(false)
+    , m_pollInFlight(false)
+    , m_missingPolls(0)
+    , m_failedPolls(0)
+{
+    if (domain) {
+        m_domainName = domain->name();
+        m_domainUuid = domain->uuid();
+    }
+}
+
+BlockJob::~BlockJob() = default;
+
+QString BlockJob::description() const
+{
+    switch (m_type) {
+    case Pull:
+        return m_target.isEmpty() ? tr("Flatten %1").arg(m_disk)
+                                  : tr("Pull %1 down to %2").arg(m_disk, m_target);
+    case Commit:
+        return m_target.isEmpty() ? tr("Commit %1 into its backing file").arg(m_disk)
+                                  : tr("Commit %1 into %2").arg(m_disk, m_target);
+    case ActiveCommit:
+        return m_target.isEmpty() ? tr("Commit active layer of %1").arg(m_disk)
+                                  : tr("Commit active layer of %1 into %2").arg(m_disk, m_target);
+    case Copy:
+        return tr("Copy %1 to %2").arg(m_disk, m_target);
+    }
+    return m_disk;
+}
+
+qint64 BlockJob::elapsedMs() const
+{
+    return m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+bool BlockJob::isPivotable() const
+{
+    return (m_type == Copy || m_type == ActiveCommit) && m_state == Ready && !m_abortRequested;
+}
+
+void BlockJob::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    if (state == Starting) {
+        m_clock.start();
+    }
+    emit stateChanged(state);
+}
+
+void BlockJob::setProgress(qint64 processed, qint64 total)
+{
+    total = qMax<qint64>(0, total);
+    processed = qBound<qint64>(0, processed, total);
+    if (processed != m_processed || total != m_total) {
+        m_processed = processed;
+        m_total = total;
+        emit progress(m_processed, m_total);
+    }
+}
+
+BlockJobManager *BlockJobManager::s_instance = nullptr;
+
+BlockJobManager::BlockJobManager(QObject *parent)
+    : QObject(parent)
+    , m_maxConcurrent(DefaultMaxConcurrent)
+    , m_pollTimer(new QTimer(this))
+{
+    m_pollTimer->setInterval(DefaultPollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &BlockJobManager::pollProgress);
+}
+
+BlockJobManager::~BlockJobManager()
+{
+    // The jobs themselves go on in the hypervisor; only stop listening.
+    // Their Work still holds the domains, and with them the connections.
+    for (auto it = m_watches.cbegin(); it != m_watches.cend(); ++it) {
+        if (it.value().callbackId >= 0) {
+            virConnectDomainEventDeregisterAny(static_cast<virConnectPtr>(it.key()),
+                                               it.value().callbackId);
+        }
+    }
+    m_watches.clear();
+
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+BlockJobManager *BlockJobManager::instance()
+{
+    if (!s_instance) {
+        s_instance = new BlockJobManager();
+    }
+    return s_instance;
+}
+
+BlockJob *BlockJobManager::pull(Domain *domain, const QString &disk, const QString &base,
+                                qint64 bandwidth)
+{
+    auto work = std::make_shared<BlockJob::Work>();
+    work->base = base.toUtf8();
+    work->bandwidth = bandwidth;
+
+    BlockJob *job = enqueue(BlockJob::Pull, domain, disk, work);
+    job->m_target = base;
+    return job;
+}
+
+BlockJob *BlockJobManager::commit(Domain *domain, const QString &disk, const QString &base,
+                                  const QString &top, qint64 bandwidth, bool pivotWhenReady)
+{
+    auto work = std::make_shared<BlockJob::Work>();
+    work->base = base.toUtf8();
+    work->top = top.toUtf8();
+    work->bandwidth = bandwidth;
+
+    // Without a top layer the commit starts at the active one
+    BlockJob *job = enqueue(top.isEmpty() ? BlockJob::ActiveCommit : BlockJob::Commit,
+                            domain, disk, work);
+    job->m_target = base;
+    job->m_pivotWhenReady = pivotWhenReady && top.isEmpty();
+    return job;
+}
+
+BlockJob *BlockJobManager::copy(Domain *domain, const QString &disk, const QString &destination,
+                                const QString &format, qint64 bandwidth, bool shallow,
+                                bool pivotWhenReady)
+{
+    if (destination.isEmpty()) {
+        return failed(BlockJob::Copy, domain, disk, tr("No destination for the copy"));
+    }
+
+    auto work = std::make_shared<BlockJob::Work>();
+    work->destination = destination.toUtf8();
+    work->format = format;
+    work->bandwidth = bandwidth;
+    work->shallow = shallow;
+
+    BlockJob *job = enqueue(BlockJob::Copy, domain, disk, work);
+    job->m_target = destination;
+    job->m_pivotWhenReady = pivotWhenReady;
+    return job;
+}
+
+QList<BlockJob*> BlockJobManager::flatten(const QList<Domain*> &domains, qint64 bandwidth)
+{
+    // Everything is queued at once; maxConcurrent() spreads it out
+    QList<BlockJob*> started;
+    for (Domain *domain : domains) {
+        if (!domain || !isActive(domain)) {
+            continue;
+        }
+        const QStringList disks = disksWithBackingChain(domain);
+        for (const QString &disk : disks) {
+            started.append(pull(domain, disk, QString(), bandwidth));
+        }
+    }
+    return started;
+}
+
+QStringList BlockJobManager::disksWithBackingChain(Domain *domain)
+{
+    return domain ? disksWithBackingChain(domain->getXMLDesc()) : QStringList();
+}
+
+QStringList BlockJobManager::disksWithBackingChain(const QString &domainXml)
+{
+    QStringList disks;
+    QDomDocument doc;
+    if (!doc.setContent(domainXml)) {
+        return disks;
+    }
+
+    QDomElement devices = doc.documentElement().firstChildElement("devices");
+    for (QDomElement disk = devices.firstChildElement("disk"); !disk.isNull();
+         disk = disk.nextSiblingElement("disk")) {
+        if (disk.attribute("device", "disk") != "disk"
+            || !disk.firstChildElement("readonly").isNull()) {
+            continue;
+        }
+        // An empty <backingStore/> marks the end of the chain
+        QDomElement backing = disk.firstChildElement("backingStore");
+        if (backing.isNull() || backing.firstChildElement("source").isNull()) {
+            continue;
+        }
+        const QString target = disk.firstChildElement("target").attribute("dev");
+        if (!target.isEmpty()) {
+            disks.append(target);
+        }
+    }
+    return disks;
+}
+
+void BlockJobManager::pivot(BlockJob *job)
+{
+    if (!job || !m_jobs.contains(job) || !job->isPivotable()) {
+        return;
+    }
+    abort(job, true);
+}
+
+void BlockJobManager::cancel(BlockJob *job)
+{
+    if (!job || !m_jobs.contains(job) || !job->isCancellable()) {
+        return;
+    }
+
+    switch (job->m_state) {
+    case BlockJob::Queued:
+        job->m_work.reset();
+        job->setState(BlockJob::Cancelled);
+        emit jobFinished(job);
+        break;
+    case BlockJob::Starting:
+        // Nothing to abort until libvirt has returned
+        job->m_cancelWhenStarted = true;
+        emit job->stateChanged(job->m_state);
+        break;
+    default:
+        abort(job, false);
+        break;
+    }
+}
+
+void BlockJobManager::setBandwidth(BlockJob *job, qint64 bandwidth)
+{
+    if (!job || !m_jobs.contains(job) || job->isDone() || !job->m_work) {
+        return;
+    }
+    bandwidth = qMax<qint64>(0, bandwidth);
+
+    if (job->m_state == BlockJob::Queued) {
+        job->m_work->bandwidth = bandwidth;
+        job->m_bandwidth = bandwidth;
+        emit job->stateChanged(job->m_state);
+        return;
+    }
+
+    std::shared_ptr<BlockJob::Work> work = job->m_work;
+    QPointer<BlockJob> guard(job);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [watcher, guard, bandwidth]() {
+        const QString error = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        if (error.isEmpty()) {
+            guard->m_bandwidth = bandwidth;
+        } else {
+            guard->m_error = error;
+            qWarning() << "Block job" << guard->description() << "speed change failed:" << error;
+        }
+        emit guard->stateChanged(guard->m_state);
+    });
+    watcher->setFuture(QtConcurrent::run([work, bandwidth]() {
+        return setJobSpeed(work, bandwidth);
+    }));
+}
+
+QList<BlockJob*> BlockJobManager::jobs(Domain *domain) const
+{
+    QList<BlockJob*> result;
+    if (!domain) {
+        return result;
+    }
+    const QString uuid = domain->uuid();
+    for (BlockJob *job : m_jobs) {
+        if (job->m_domainUuid == uuid) {
+            result.append(job);
+        }
+    }
+    return result;
+}
+
+int BlockJobManager::activeCount() const
+{
+    int count = 0;
+    for (BlockJob *job : m_jobs) {
+        if (!job->isDone()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void BlockJobManager::clearFinished()
+{
+    for (int i = int(m_jobs.size()) - 1; i >= 0; --i) {
+        BlockJob *job = m_jobs.at(i);
+        if (job->isDone()) {
+            m_jobs.removeAt(i);
+            emit jobRemoved(job);
+            job->deleteLater();
+        }
+    }
+}
+
+void BlockJobManager::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    schedule();
+}
+
+int BlockJobManager::pollInterval() const
+{
+    return m_pollTimer->interval();
+}
+
+void BlockJobManager::setPollInterval(int milliseconds)
+{
+    m_pollTimer->setInterval(qMax(50, milliseconds));
+}
+
+BlockJob *BlockJobManager::enqueue(BlockJob::Type type, Domain *domain, const QString &disk,
+                                   const std::shared_ptr<BlockJob::Work> &work)
+{
+    if (!domain || !domain->rawDomain()) {
+        return failed(type, domain, disk, tr("No domain"));
+    }
+    if (!isActive(domain)) {
+        return failed(type, domain, disk, tr("Block jobs need a running domain"));
+    }
+    if (disk.isEmpty()) {
+        return failed(type, domain, disk, tr("No disk"));
+    }
+
+    work->domain = domain->rawDomain();
+    virDomainRef(work->domain);
+    work->disk = disk.toUtf8();
+
+    auto *job = new BlockJob(type, domain, disk, this);
+    job->m_bandwidth = qMax<qint64>(0, work->bandwidth);
+    job->m_work = work;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+
+    // Start from the event loop so callers can connect to the job first
+    QTimer::singleShot(0, this, &BlockJobManager::schedule);
+    return job;
+}
+
+BlockJob *BlockJobManager::failed(BlockJob::Type type, Domain *domain, const QString &disk,
+                                  const QString &error)
+{
+    auto *job = new BlockJob(type, domain, disk, this);
+    job->m_error = error;
+    job->m_state = BlockJob::Failed;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+    QTimer::singleShot(0, this, [this, job]() {
+        emit job->stateChanged(BlockJob::Failed);
+        emit jobFinished(job);
+    });
+    return job;
+}
+
+void BlockJobManager::schedule()
+{
+    // Mirrors that are ready only track writes; they do not count
+    int running = 0;
+    for (BlockJob *job : m_jobs) {
+        if (job->m_state == BlockJob::Starting || job->m_state == BlockJob::Running) {
+            running++;
+        }
+    }
+
+    // Oldest first; a disk runs one job at a time
+    for (BlockJob *job : m_jobs) {
+        if (running >= m_maxConcurrent) {
+            break;
+        }
+        if (job->m_state == BlockJob::Queued && !diskBusy(job)) {
+            start(job);
+            running++;
+        }
+    }
+}
+
+void BlockJobManager::start(BlockJob *job)
+{
+    // Listen before starting so a quick job cannot finish unnoticed
+    watchConnection(job);
+    job->setState(BlockJob::Starting);
+    if (!m_pollTimer->isActive()) {
+        m_pollTimer->start();
+    }
+
+    std::shared_ptr<BlockJob::Work> work = job->m_work;
+    const BlockJob::Type type = job->m_type;
+    QPointer<BlockJob> guard(job);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, guard]() {
+        const QString error = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        BlockJob *job = guard;
+        if (!error.isEmpty()) {
+            finish(job, BlockJob::Failed, error);
+            return;
+        }
+        // An event may already have made it ready
+        if (job->m_state == BlockJob::Starting) {
+            job->setState(BlockJob::Running);
+        }
+        if (job->m_cancelWhenStarted) {
+            job->m_cancelWhenStarted = false;
+            abort(job, false);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([work, type]() {
+        return startJob(work, type);
+    }));
+}
+
+void BlockJobManager::finish(BlockJob *job, BlockJob::State state, const QString &error)
+{
+    if (job->isDone()) {
+        return;
+    }
+
+    releaseConnection(job);
+    job->m_work.reset();
+
+    if (!error.isEmpty()) {
+        job->m_error = error;
+    }
+    if (state == BlockJob::Finished && job->m_total > 0) {
+        job->setProgress(job->m_total, job->m_total);
+    }
+    if (state == BlockJob::Failed) {
+        qWarning() << "Block job" << job->description() << "on" << job->m_domainName
+                   << "failed:" << job->m_error;
+    }
+    job->setState(state);
+
+    // The disk's backing chain has changed
+    if (Domain *domain = job->m_domain) {
+        domain->updateInfoAsync(true);
+    }
+
+    emit jobFinished(job);
+
+    bool busy = false;
+    for (BlockJob *other : m_jobs) {
+        if (other->m_state >= BlockJob::Starting && !other->isDone()) {
+            busy = true;
+            break;
+        }
+    }
+    if (!busy) {
+        m_pollTimer->stop();
+    }
+    schedule();
+}
+
+void BlockJobManager::abort(BlockJob *job, bool pivot)
+{
+    if (!job->m_work || job->m_abortRequested) {
+        return;
+    }
+    job->m_abortRequested = true;
+    job->m_pivotRequested = pivot;
+    emit job->stateChanged(job->m_state);
+
+    std::shared_ptr<BlockJob::Work> work = job->m_work;
+    QPointer<BlockJob> guard(job);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, guard, pivot]() {
+        const QString error = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        BlockJob *job = guard;
+        if (error.isEmpty()) {
+            finish(job, pivot ? BlockJob::Finished : BlockJob::Cancelled);
+            return;
+        }
+        // Still running; let the user try again
+        job->m_abortRequested = false;
+        job->m_pivotRequested = false;
+        job->m_error = error;
+        qWarning() << "Block job" << job->description() << "abort failed:" << error;
+        emit job->stateChanged(job->m_state);
+    });
+    watcher->setFuture(QtConcurrent::run([work, pivot]() {
+        return abortJob(work, pivot);
+    }));
+}
+
+void BlockJobManager::pollProgress()
+{
+    for (BlockJob *job : m_jobs) {
+        if ((job->m_state != BlockJob::Running && job->m_state != BlockJob::Ready)
+            || job->m_pollInFlight || !job->m_work) {
+            continue;
+        }
+
+        job->m_pollInFlight = true;
+        std::shared_ptr<BlockJob::Work> work = job->m_work;
+        QPointer<BlockJob> guard(job);
+
+        auto *watcher = new QFutureWatcher<PollResult>(this);
+        connect(watcher, &QFutureWatcher<PollResult>::finished, this, [this, watcher, guard]() {
+            const PollResult result = watcher->result();
+            watcher->deleteLater();
+            if (!guard) {
+                return;
+            }
+            BlockJob *job = guard;
+            job->m_pollInFlight = false;
+            if (job->isDone() || job->m_state == BlockJob::Starting) {
+                return;
+            }
+
+            if (result.status < 0) {
+                if (++job->m_failedPolls >= MaxFailedPolls) {
+                    finish(job, BlockJob::Failed, result.error);
+                }
+                return;
+            }
+            job->m_failedPolls = 0;
+
+            if (result.status == 0) {
+                // Gone: polling cannot tell a failure from a completion
+                // and relies on the event for that where there is one
+                if (!hasEvents(job) || ++job->m_missingPolls >= MaxMissingPolls) {
+                    const bool cancelled = job->m_abortRequested && !job->m_pivotRequested;
+                    finish(job, cancelled ? BlockJob::Cancelled : BlockJob::Finished);
+                }
+                return;
+            }
+            job->m_missingPolls = 0;
+
+            job->m_bandwidth = result.bandwidth;
+            job->setProgress(result.cursor, result.end);
+
+            const bool mirror = job->m_type == BlockJob::Copy
+                || job->m_type == BlockJob::ActiveCommit;
+            if (!hasEvents(job) && mirror && job->m_state == BlockJob::Running
+                && result.end > 0 && result.cursor == result.end) {
+                job->setState(BlockJob::Ready);
+                if (job->m_pivotWhenReady) {
+                    abort(job, true);
+                }
+            }
+        });
+        watcher->setFuture(QtConcurrent::run([work]() {
+            return pollJob(work);
+        }));
+    }
+}
+
+void BlockJobManager::onBlockJobEvent(const QString &domainUuid, const QString &disk,
+                                      int type, int status)
+{
+    Q_UNUSED(type);
+
+    BlockJob *job = activeJob(domainUuid, disk);
+    if (!job) {
+        // Started elsewhere, or already finished by an abort
+        return;
+    }
+
+    switch (status) {
+    case VIR_DOMAIN_BLOCK_JOB_READY:
+        if (job->m_state == BlockJob::Starting || job->m_state == BlockJob::Running) {
+            if (job->m_total > 0) {
+                job->setProgress(job->m_total, job->m_total);
+            }
+            job->setState(BlockJob::Ready);
+            if (job->m_pivotWhenReady) {
+                abort(job, true);
+            }
+        }
+        break;
+    case VIR_DOMAIN_BLOCK_JOB_COMPLETED:
+        finish(job, job->m_abortRequested && !job->m_pivotRequested ? BlockJob::Cancelled
+                                                                    : BlockJob::Finished);
+        break;
+    case VIR_DOMAIN_BLOCK_JOB_FAILED:
+        finish(job, BlockJob::Failed, tr("The hypervisor reported the block job as failed"));
+        break;
+    case VIR_DOMAIN_BLOCK_JOB_CANCELED:
+        finish(job, BlockJob::Cancelled);
+        break;
+    default:
+        break;
+    }
+}
+
+bool BlockJobManager::diskBusy(const BlockJob *job) const
+{
+    BlockJob *active = activeJob(job->m_domainUuid, job->m_disk);
+    return active && active != job;
+}
+
+BlockJob *BlockJobManager::activeJob(const QString &domainUuid, const QString &disk) const
+{
+    for (BlockJob *job : m_jobs) {
+        if (job->m_state >= BlockJob::Starting && !job->isDone()
+            && job->m_domainUuid == domainUuid && job->m_disk == disk) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void BlockJobManager::watchConnection(BlockJob *job)
+{
+    BlockJob::Work *work = job->m_work.get();
+    if (!work || work->connection) {
+        return;
+    }
+    virConnectPtr conn = virDomainGetConnect(work->domain);
+    if (!conn) {
+        return;
+    }
+    work->connection = conn;
+
+    // Events only arrive while something dispatches libvirt's event loop
+    EventWatch &watch = m_watches[conn];
+    if (watch.users++ == 0 && EventLoop::isStarted()) {
+        watch.callbackId = virConnectDomainEventRegisterAny(
+            conn, nullptr, VIR_DOMAIN_EVENT_ID_BLOCK_JOB_2,
+            VIR_DOMAIN_EVENT_CALLBACK(blockJobEventCallback), this, nullptr);
+        // On failure callbackId stays negative and the progress poll
+        // notices the end of the job instead
+    }
+}
+
+void BlockJobManager::releaseConnection(BlockJob *job)
+{
+    BlockJob::Work *work = job->m_work.get();
+    if (!work || !work->connection) {
+        return;
+    }
+
+    auto it = m_watches.find(work->connection);
+    if (it != m_watches.end() && --it.value().users <= 0) {
+        if (it.value().callbackId >= 0) {
+            virConnectDomainEventDeregisterAny(work->connection, it.value().callbackId);
+        }
+        m_watches.erase(it);
+    }
+    work->connection = nullptr;
+}
+
+bool BlockJobManager::hasEvents(const BlockJob *job) const
+{
+    const BlockJob::Work *work = job->m_work.get();
+    return work && work->connection && m_watches.value(work->connection).callbackId >= 0;
+}
+
+} // namespace QVirt
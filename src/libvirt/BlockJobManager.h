@@ -0,0 +1,233 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_BLOCKJOBMANAGER_H
+#define QVIRT_LIBVIRT_BLOCKJOBMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <memory>
+
+class QTimer;
+
+namespace QVirt {
+
+class Domain;
+
+/**
+ * @brief One block job on a disk of a running domain
+ *
+ * Created and tracked by BlockJobManager. Progress is the job's own
+ * cursor as reported by virDomainGetBlockJobInfo().
+ */
+class BlockJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Type {
+        Pull,           // Pull the backing chain (or part of it) into the disk
+        Commit,         // Commit an inactive layer into its backing file
+        ActiveCommit,   // Commit the active layer; needs a pivot once ready
+        Copy            // Mirror the disk to a new image; needs a pivot once ready
+    };
+
+    enum State {
+        Queued,
+        Starting,
+        Running,
+        Ready,          // Mirror in sync: pivot() or cancel() ends it
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    ~BlockJob() override;
+
+    Type type() const { return m_type; }
+    State state() const { return m_state; }
+    bool isDone() const { return m_state >= Finished; }
+
+    Domain *domain() const { return m_domain; }
+    QString domainName() const { return m_domainName; }
+    QString disk() const { return m_disk; }
+    QString description() const;
+    QString errorString() const { return m_error; }
+
+    // Job cursor, in bytes of the disk
+    qint64 processedBytes() const { return m_processed; }
+    qint64 totalBytes() const { return m_total; }
+
+    // Speed limit in bytes/s, 0 for none
+    qint64 bandwidth() const { return m_bandwidth; }
+
+    qint64 elapsedMs() const;
+
+    // Copies and active commits that can be switched over to the new image
+    bool isPivotable() const;
+    bool isCancellable() const { return !isDone() && !m_abortRequested && !m_cancelWhenStarted; }
+    bool pivotWhenReady() const { return m_pivotWhenReady; }
+
+    // Parameters and handles shared with the workers; defined in the .cpp
+    struct Work;
+
+signals:
+    void stateChanged(QVirt::BlockJob::State state);
+    void progress(qint64 processed, qint64 total);
+
+private:
+    BlockJob(Type type, Domain *domain, const QString &disk, QObject *parent);
+    void setState(State state);
+    void setProgress(qint64 processed, qint64 total);
+
+    const Type m_type;
+    State m_state;
+    QPointer<Domain> m_domain;
+    QString m_domainName;
+    QString m_domainUuid;
+    QString m_disk;
+    QString m_target;               // Base, top or destination, for description()
+    QString m_error;
+
+    qint64 m_processed;
+    qint64 m_total;
+    qint64 m_bandwidth;
+    bool m_pivotWhenReady;
+    bool m_abortRequested;
+    bool m_pivotRequested;
+    bool m_cancelWhenStarted;       // Cancelled while libvirt was starting it
+    bool m_pollInFlight;
+    int m_missingPolls;             // Polls in a row that found no job
+    int m_failedPolls;              // Polls in a row that failed
+    QElapsedTimer m_clock;
+
+    std::shared_ptr<Work> m_work;
+
+    friend class BlockJobManager;
+};
+
+/**
+ * @brief Starts and tracks block jobs: pull, commit, copy and rebase
+ *
+ * Jobs are queued and at most maxConcurrent() of them are started at a
+ * time across all domains, so flattening the chains of many guests at
+ * once does not saturate the storage; each job also gets a bandwidth
+ * limit. Starting, pivoting and aborting run off the GUI thread.
+ *
+ * State changes come from VIR_DOMAIN_EVENT_ID_BLOCK_JOB_2, registered per
+ * connection while it has jobs. Progress, and the state where events are
+ * unavailable, comes from polling virDomainGetBlockJobInfo().
+ */
+class BlockJobManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxConcurrent = 4;
+
+    explicit BlockJobManager(QObject *parent = nullptr);
+    ~BlockJobManager() override;
+
+    static BlockJobManager *instance();
+
+    // Pull data from the backing chain down to @p base, or all of it if empty
+    BlockJob *pull(Domain *domain, const QString &disk, const QString &base = QString(),
+                   qint64 bandwidth = 0);
+
+    /**
+     * @brief Commit @p top (the active layer if empty) into @p base
+     *
+     * An empty @p base commits into the immediate backing file. Committing
+     * the active layer becomes Ready once in sync and, with
+     * @p pivotWhenReady, switches the disk over to @p base by itself.
+     */
+    BlockJob *commit(Domain *domain, const QString &disk, const QString &base = QString(),
+                     const QString &top = QString(), qint64 bandwidth = 0,
+                     bool pivotWhenReady = true);
+
+    // Mirror the disk into a new image at @p destination
+    BlockJob *copy(Domain *domain, const QString &disk, const QString &destination,
+                   const QString &format, qint64 bandwidth = 0, bool shallow = false,
+                   bool pivotWhenReady = false);
+
+    // Pull every disk of @p domains that has a backing chain into a single image
+    QList<BlockJob*> flatten(const QList<Domain*> &domains, qint64 bandwidth = 0);
+
+    // Writable disks of @p domain that sit on a backing chain
+    static QStringList disksWithBackingChain(Domain *domain);
+    static QStringList disksWithBackingChain(const QString &domainXml);
+
+    void pivot(BlockJob *job);
+    void cancel(BlockJob *job);
+    void setBandwidth(BlockJob *job, qint64 bandwidth);
+
+    QList<BlockJob*> jobs() const { return m_jobs; }
+    QList<BlockJob*> jobs(Domain *domain) const;
+
+    // Queued, starting, running and ready jobs
+    int activeCount() const;
+
+    // Drop jobs that are done
+    void clearFinished();
+
+    int maxConcurrent() const { return m_maxConcurrent; }
+    void setMaxConcurrent(int count);
+
+    int pollInterval() const;
+    void setPollInterval(int milliseconds);
+
+signals:
+    void jobAdded(QVirt::BlockJob *job);
+    void jobRemoved(QVirt::BlockJob *job);
+    void jobFinished(QVirt::BlockJob *job);
+
+private slots:
+    void schedule();
+    void pollProgress();
+    void onBlockJobEvent(const QString &domainUuid, const QString &disk, int type, int status);
+
+private:
+    BlockJob *enqueue(BlockJob::Type type, Domain *domain, const QString &disk,
+                      const std::shared_ptr<BlockJob::Work> &work);
+    BlockJob *failed(BlockJob::Type type, Domain *domain, const QString &disk,
+                     const QString &error);
+    void start(BlockJob *job);
+    void finish(BlockJob *job, BlockJob::State state, const QString &error = QString());
+    void abort(BlockJob *job, bool pivot);
+    bool diskBusy(const BlockJob *job) const;
+    BlockJob *activeJob(const QString &domainUuid, const QString &disk) const;
+
+    void watchConnection(BlockJob *job);
+    void releaseConnection(BlockJob *job);
+    bool hasEvents(const BlockJob *job) const;
+
+    QList<BlockJob*> m_jobs;
+    int m_maxConcurrent;
+    QTimer *m_pollTimer;
+
+    // Event callback per connection, with the number of jobs using it
+    struct EventWatch {
+        int callbackId = -1;
+        int users = 0;
+    };
+    QHash<void*, EventWatch> m_watches;
+
+    static BlockJobManager *s_instance;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_BLOCKJOBMANAGER_H
@@ -14,9 +14,11 @@
 #include "Network.h"
 #include "StoragePool.h"
 #include "NodeDevice.h"
+#include "EventLoop.h"
 #include "../core/Error.h"
 #include "../core/Config.h"
 #include <QDebug>
+#include <QUrl>
 #include <QtConcurrent/QtConcurrent>
 #include <QFutureWatcher>
 #include <tuple>
@@ -84,8 +86,38 @@ struct DomainStats {
     quint64 currentMemory;
     int vcpuCount;
     quint64 cpuTime;
+    qint64 blockBytes;
+    qint64 netBytes;
 };
 
+#ifdef LIBVIRT_FOUND
+namespace {
+
+// Sum of <prefix>.<i>.<first> and <prefix>.<i>.<second> over the devices
+// of a bulk stats record; -1 if the record has no such group
+qint64 sumDeviceBytes(virTypedParameterPtr params, int nparams, const char *prefix,
+                      const char *first, const char *second)
+{
+    unsigned int count = 0;
+    if (virTypedParamsGetUInt(params, nparams, (QByteArray(prefix) + ".count").constData(),
+                              &count) != 1) {
+        return -1;
+    }
+
+    qint64 total = 0;
+    for (unsigned int i = 0; i < count; ++i) {
+        QByteArray base = QByteArray(prefix) + '.' + QByteArray::number(i) + '.';
+        unsigned long long a = 0, b = 0;
+        virTypedParamsGetULLong(params, nparams, (base + first).constData(), &a);
+        virTypedParamsGetULLong(params, nparams, (base + second).constData(), &b);
+        total += static_cast<qint64>(a + b);
+    }
+    return total;
+}
+
+} // namespace
+#endif
+
 Connection::Connection(const QString &uri)
     : BaseObject()
     , m_uri(uri)
@@ -103,6 +135,7 @@ Connection::Connection(const QString &uri)
     , m_libvirtVersionFetched(false)
 {
     // Attempt to open the connection (no auth)
+    EventLoop::ensureRunning();
     m_conn = virConnectOpen(uri.toUtf8().constData());
 
     if (m_conn) {
@@ -173,6 +206,7 @@ Connection::Connection(const QString &uri, const QString &sshKeyPath, const QStr
     }
 
     // Attempt to open the connection with auth
+    EventLoop::ensureRunning();
     authHelper.cbdata = &authData;
     m_conn = virConnectOpenAuth(uri.toUtf8().constData(), &authHelper, 0);
 
@@ -229,6 +263,48 @@ Connection *Connection::open(const QString &uri, const QString &sshKeyPath, cons
     return conn;
 }
 
+virConnectPtr Connection::openAuthenticated(const QString &uri, QString *error)
+{
+#ifdef LIBVIRT_FOUND
+    ConnectionAuthData authData;
+    authData.sshKeyPath = Config::instance()->connSSHKeyPath(uri);
+
+    QByteArray originalLibvirtSsh;
+    if (!authData.sshKeyPath.isEmpty()) {
+        originalLibvirtSsh = qgetenv("LIBVIRT_SSH");
+        QString sshCmd = QString("ssh -i \"%1\" -o IdentitiesOnly=yes -o BatchMode=no -o ConnectTimeout=10")
+            .arg(authData.sshKeyPath);
+        qputenv("LIBVIRT_SSH", sshCmd.toUtf8());
+    }
+
+    // A copy of the helper, so callers on other threads do not share cbdata
+    virConnectAuth auth = authHelper;
+    auth.cbdata = &authData;
+    EventLoop::ensureRunning();
+    virConnectPtr conn = virConnectOpenAuth(uri.toUtf8().constData(), &auth, 0);
+
+    if (!authData.sshKeyPath.isEmpty()) {
+        if (originalLibvirtSsh.isEmpty()) {
+            qunsetenv("LIBVIRT_SSH");
+        } else {
+            qputenv("LIBVIRT_SSH", originalLibvirtSsh);
+        }
+    }
+
+    if (!conn && error) {
+        virErrorPtr err = virGetLastError();
+        *error = err && err->message ? QString::fromUtf8(err->message) : tr("Failed to connect");
+    }
+    return conn;
+#else
+    Q_UNUSED(uri);
+    if (error) {
+        *error = tr("libvirt not available");
+    }
+    return nullptr;
+#endif
+}
+
 Connection *Connection::create(const QString &uri)
 {
     return new Connection(uri);
@@ -296,6 +372,7 @@ void Connection::openAsync(const QString &sshKeyPath, const QString &password)
     QFuture<OpenResult> future = QtConcurrent::run([this, sshKeyPath, password]() -> OpenResult {
         OpenResult result{nullptr, QString()};
 #ifdef LIBVIRT_FOUND
+        EventLoop::ensureRunning();
         if (sshKeyPath.isEmpty() && password.isEmpty()) {
             result.conn = virConnectOpen(m_uri.toUtf8().constData());
         } else {
@@ -343,6 +420,13 @@ bool Connection::isOpen() const
     return m_conn != nullptr && m_state == Active;
 }
 
+bool Connection::isLocal() const
+{
+    // "qemu:///system" has no host; "qemu+ssh://host/system" does
+    const QString host = QUrl(m_uri).host();
+    return host.isEmpty() || host == QLatin1String("localhost");
+}
+
 void Connection::refresh()
 {
     if (!isOpen()) {
@@ -811,7 +895,8 @@ void Connection::tick()
                 if (domain) {
                     domain->applyStats(it.value().state, it.value().maxMemory,
                                        it.value().currentMemory, it.value().vcpuCount,
-                                       it.value().cpuTime);
+                                       it.value().cpuTime, it.value().blockBytes,
+                                       it.value().netBytes);
                 }
             }
             watcher->deleteLater();
@@ -820,6 +905,7 @@ void Connection::tick()
         QFuture<QMap<QString, DomainStats>> future = QtConcurrent::run([this, domainNames]() -> QMap<QString, DomainStats> {
             QMap<QString, DomainStats> results;
             QMutexLocker locker(&m_connMutex);
+            QVector<virDomainPtr> running;
             for (const QString &name : domainNames) {
                 Domain *domain = m_domains.value(name, nullptr);
                 if (domain && domain->rawDomain()) {
@@ -831,10 +917,39 @@ void Connection::tick()
                         ds.currentMemory = info.memory;
                         ds.vcpuCount = info.nrVirtCpu;
                         ds.cpuTime = info.cpuTime;
+                        ds.blockBytes = -1;
+                        ds.netBytes = -1;
                         results[name] = ds;
+
+                        if (info.state == VIR_DOMAIN_RUNNING) {
+                            running.append(domain->rawDomain());
+                        }
                     }
                 }
             }
+
+            // One bulk query for the disk and interface counters of every
+            // running domain instead of a round trip per domain
+            if (!running.isEmpty()) {
+                running.append(nullptr);
+                virDomainStatsRecordPtr *records = nullptr;
+                int count = virDomainListGetStats(running.data(),
+                                                  VIR_DOMAIN_STATS_BLOCK | VIR_DOMAIN_STATS_INTERFACE,
+                                                  &records, 0);
+                for (int i = 0; i < count; ++i) {
+                    auto it = results.find(QString::fromUtf8(virDomainGetName(records[i]->dom)));
+                    if (it == results.end()) {
+                        continue;
+                    }
+                    virTypedParameterPtr params = records[i]->params;
+                    int nparams = records[i]->nparams;
+                    it->blockBytes = sumDeviceBytes(params, nparams, "block", "rd.bytes", "wr.bytes");
+                    it->netBytes = sumDeviceBytes(params, nparams, "net", "rx.bytes", "tx.bytes");
+                }
+                if (records) {
+                    virDomainStatsRecordListFree(records);
+                }
+            }
             return results;
         });
         watcher->setFuture(future);
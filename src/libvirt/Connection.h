@@ -70,6 +70,18 @@ public:
     static Connection *open(const QString &uri, const QString &sshKeyPath = QString(),
                            const QString &password = QString());
 
+    /**
+     * @brief Open a bare libvirt connection the way open() does (blocking)
+     *
+     * Uses the SSH key saved for @p uri and the same auth callback, for
+     * callers that need a virConnectPtr of their own, such as the
+     * destination of a migration. Close it with virConnectClose().
+     * @param uri Connection URI
+     * @param error Set to libvirt's message on failure
+     * @return The connection, or nullptr on failure
+     */
+    static virConnectPtr openAuthenticated(const QString &uri, QString *error = nullptr);
+
     /**
      * @brief Create a connection object without opening (for async connection)
      * @param uri Connection URI
@@ -103,6 +115,9 @@ public:
     QString uri() const { return m_uri; }
     bool isOpen() const;
 
+    // Whether the hypervisor runs on this host, so its files can be read directly
+    bool isLocal() const;
+
     // Close the connection
     void close();
 
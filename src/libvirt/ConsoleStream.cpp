@@ -0,0 +1,512 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ConsoleStream.h"
+#include "Domain.h"
+#include "EventLoop.h"
+#include "../core/SPSCQueue.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+#include <atomic>
+#include <cstring>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+
+#include <libvirt/libvirt-stream.h>
+#else
+typedef void *virStreamPtr;
+#endif
+
+namespace QVirt {
+
+namespace {
+
+// One virStreamRecv() worth of data; full chunks are queued without a copy
+constexpr int ChunkSize = 16 * 1024;
+
+// Upper bound on queued chunks, whatever their size
+constexpr int MaxQueuedChunks = 1024;
+
+// Chunks received per callback before yielding back to the event loop, so
+// the GUI thread never waits long on the lock during a flood
+constexpr int MaxChunksPerEvent = 16;
+
+constexpr int MaxSendBytes = 64 * 1024;
+
+constexpr qint64 DefaultReadBufferLimit = 4 * 1024 * 1024;
+constexpr qint64 DefaultWriteBufferLimit = 256 * 1024;
+
+enum NotifyFlag {
+    NotifyPending = 0x1,
+    EndOfStream = 0x2,
+    StreamFailed = 0x4
+};
+
+#ifdef LIBVIRT_FOUND
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+#endif
+
+} // namespace
+
+/**
+ * State shared between the GUI thread and libvirt's event thread; kept
+ * alive by the registered callback until libvirt releases it.
+ */
+struct ConsoleStream::Shared {
+    Shared()
+        : chunks(MaxQueuedChunks)
+    {
+    }
+
+    // Guards the stream handle, the event mask, the send buffer and owner
+    QMutex lock;
+    virStreamPtr stream = nullptr;
+    int events = 0;
+    bool readPaused = false;
+    bool finished = false;
+    QByteArray pending;             // Unsent input
+    int pendingOffset = 0;
+    QString error;
+    ConsoleStream *owner = nullptr;
+
+    // Received data, event thread to GUI thread
+    SPSCQueue<QByteArray> chunks;
+    std::atomic<int> queuedChunks{0};
+    std::atomic<qint64> queuedBytes{0};
+    std::atomic<qint64> readLimit{DefaultReadBufferLimit};
+
+    std::atomic<qint64> writtenBytes{0};    // Sent since the last notification
+    std::atomic<int> flags{0};
+
+    // Event thread only
+    QByteArray scratch;
+
+    void handleEvents(int events);
+    void receive();
+    void send();
+    void finish(int flag, const QString &message);
+    void updateEvents();
+    void notify();
+    bool canReceive() const;
+
+    static void onStreamEvent(virStreamPtr stream, int events, void *opaque);
+    static void releaseOpaque(void *opaque);
+};
+
+void ConsoleStream::Shared::onStreamEvent(virStreamPtr stream, int events, void *opaque)
+{
+    Q_UNUSED(stream);
+    std::shared_ptr<Shared> shared = *static_cast<std::shared_ptr<Shared> *>(opaque);
+
+    QMutexLocker locker(&shared->lock);
+    // Torn down while this callback was being dispatched
+    if (!shared->stream) {
+        return;
+    }
+    shared->handleEvents(events);
+}
+
+void ConsoleStream::Shared::releaseOpaque(void *opaque)
+{
+    delete static_cast<std::shared_ptr<Shared> *>(opaque);
+}
+
+bool ConsoleStream::Shared::canReceive() const
+{
+    return queuedChunks.load(std::memory_order_acquire) < chunks.capacity()
+           && queuedBytes.load(std::memory_order_acquire) < readLimit.load(std::memory_order_relaxed);
+}
+
+void ConsoleStream::Shared::handleEvents(int events)
+{
+#ifdef LIBVIRT_FOUND
+    if (events & VIR_STREAM_EVENT_READABLE) {
+        receive();
+    }
+    if (!finished && (events & VIR_STREAM_EVENT_WRITABLE)) {
+        send();
+    }
+    if (!finished && (events & VIR_STREAM_EVENT_ERROR)) {
+        finish(StreamFailed, lastErrorMessage(ConsoleStream::tr("Console stream error")));
+    } else if (!finished && (events & VIR_STREAM_EVENT_HANGUP)) {
+        finish(EndOfStream, ConsoleStream::tr("Console closed by the remote end"));
+    }
+    updateEvents();
+    notify();
+#else
+    Q_UNUSED(events);
+#endif
+}
+
+void ConsoleStream::Shared::receive()
+{
+#ifdef LIBVIRT_FOUND
+    for (int i = 0; i < MaxChunksPerEvent; ++i) {
+        if (!canReceive()) {
+            // Back-pressure: leave the data in the stream until the reader
+            // catches up
+            readPaused = true;
+            return;
+        }
+
+        if (scratch.size() != ChunkSize) {
+            scratch = QByteArray(ChunkSize, Qt::Uninitialized);
+        }
+        int bytesRead = virStreamRecv(stream, scratch.data(), ChunkSize);
+        if (bytesRead == -2) {
+            return;     // Drained
+        }
+        if (bytesRead == 0) {
+            finish(EndOfStream, ConsoleStream::tr("Console closed by the remote end"));
+            return;
+        }
+        if (bytesRead < 0) {
+            finish(StreamFailed, lastErrorMessage(ConsoleStream::tr("Console read failed")));
+            return;
+        }
+
+        // Full chunks change hands as they are; short reads (the common
+        // case for interactive output) get a right-sized copy instead of
+        // pinning a whole chunk
+        QByteArray chunk;
+        if (bytesRead == ChunkSize) {
+            chunk.swap(scratch);
+        } else {
+            chunk = QByteArray(scratch.constData(), bytesRead);
+        }
+        chunks.tryPush(chunk);
+        queuedBytes.fetch_add(bytesRead, std::memory_order_release);
+        queuedChunks.fetch_add(1, std::memory_order_release);
+    }
+#endif
+}
+
+void ConsoleStream::Shared::send()
+{
+#ifdef LIBVIRT_FOUND
+    qint64 sent = 0;
+    while (pendingOffset < pending.size()) {
+        int length = int(qMin<qint64>(pending.size() - pendingOffset, MaxSendBytes));
+        int bytesSent = virStreamSend(stream, pending.constData() + pendingOffset, length);
+        if (bytesSent == -2) {
+            break;      // Would block; wait for the next WRITABLE event
+        }
+        if (bytesSent < 0) {
+            finish(StreamFailed, lastErrorMessage(ConsoleStream::tr("Console write failed")));
+            break;
+        }
+        pendingOffset += bytesSent;
+        sent += bytesSent;
+    }
+
+    if (pendingOffset >= pending.size()) {
+        pending.clear();
+        pendingOffset = 0;
+    } else if (pendingOffset > MaxSendBytes) {
+        pending.remove(0, pendingOffset);
+        pendingOffset = 0;
+    }
+    if (sent > 0) {
+        writtenBytes.fetch_add(sent, std::memory_order_relaxed);
+    }
+#endif
+}
+
+void ConsoleStream::Shared::finish(int flag, const QString &message)
+{
+    finished = true;
+    error = message;
+    flags.fetch_or(flag);
+}
+
+void ConsoleStream::Shared::updateEvents()
+{
+#ifdef LIBVIRT_FOUND
+    int wanted = 0;
+    if (!finished) {
+        wanted = VIR_STREAM_EVENT_ERROR | VIR_STREAM_EVENT_HANGUP;
+        if (!readPaused) {
+            wanted |= VIR_STREAM_EVENT_READABLE;
+        }
+        if (pendingOffset < pending.size()) {
+            wanted |= VIR_STREAM_EVENT_WRITABLE;
+        }
+    }
+    if (wanted != events && virStreamEventUpdateCallback(stream, wanted) == 0) {
+        events = wanted;
+    }
+#endif
+}
+
+void ConsoleStream::Shared::notify()
+{
+    // One queued call covers everything until the GUI thread picks it up
+    if (owner && !(flags.fetch_or(NotifyPending) & NotifyPending)) {
+        QMetaObject::invokeMethod(owner, "processNotifications", Qt::QueuedConnection);
+    }
+}
+
+ConsoleStream::ConsoleStream(QObject *parent)
+    : QIODevice(parent)
+    , m_readOffset(0)
+    , m_readBufferLimit(DefaultReadBufferLimit)
+    , m_writeBufferLimit(DefaultWriteBufferLimit)
+{
+}
+
+ConsoleStream::~ConsoleStream()
+{
+    teardown();
+}
+
+bool ConsoleStream::openConsole(Domain *domain, const QString &device, bool force)
+{
+    close();
+
+    if (!domain || !domain->rawDomain()) {
+        setErrorString(tr("Domain is not available"));
+        return false;
+    }
+
+#ifdef LIBVIRT_FOUND
+    if (!EventLoop::ensureRunning()) {
+        setErrorString(tr("libvirt event loop is not available"));
+        return false;
+    }
+
+    virDomainPtr dom = domain->rawDomain();
+    virConnectPtr conn = virDomainGetConnect(dom);
+    virStreamPtr stream = conn ? virStreamNew(conn, VIR_STREAM_NONBLOCK) : nullptr;
+    if (!stream) {
+        setErrorString(lastErrorMessage(tr("Failed to create stream")));
+        return false;
+    }
+
+    const QByteArray deviceName = device.toUtf8();
+    unsigned int flags = force ? VIR_DOMAIN_CONSOLE_FORCE : 0;
+    if (virDomainOpenConsole(dom, device.isEmpty() ? nullptr : deviceName.constData(),
+                             stream, flags) < 0) {
+        setErrorString(lastErrorMessage(tr("Failed to open console")));
+        virStreamFree(stream);
+        return false;
+    }
+
+    auto shared = std::make_shared<Shared>();
+    shared->readLimit.store(m_readBufferLimit);
+    shared->owner = this;
+
+    {
+        // Held across registration so the first callback sees a complete state
+        QMutexLocker locker(&shared->lock);
+        shared->stream = stream;
+        shared->events = VIR_STREAM_EVENT_READABLE | VIR_STREAM_EVENT_ERROR
+                         | VIR_STREAM_EVENT_HANGUP;
+
+        auto *opaque = new std::shared_ptr<Shared>(shared);
+        if (virStreamEventAddCallback(stream, shared->events, &Shared::onStreamEvent,
+                                      opaque, &Shared::releaseOpaque) < 0) {
+            delete opaque;
+            setErrorString(lastErrorMessage(tr("Cannot watch console stream")));
+            shared->stream = nullptr;
+            virStreamAbort(stream);
+            virStreamFree(stream);
+            return false;
+        }
+    }
+
+    m_shared = shared;
+    m_readChunk.clear();
+    m_readOffset = 0;
+
+    // Unbuffered: the chunk queue is the read buffer
+    return QIODevice::open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+#else
+    Q_UNUSED(device);
+    Q_UNUSED(force);
+    setErrorString(tr("libvirt not available"));
+    return false;
+#endif
+}
+
+void ConsoleStream::close()
+{
+    if (isOpen()) {
+        QIODevice::close();
+    }
+    teardown();
+    m_shared.reset();
+    m_readChunk.clear();
+    m_readOffset = 0;
+}
+
+void ConsoleStream::teardown()
+{
+    if (!m_shared) {
+        return;
+    }
+
+    QMutexLocker locker(&m_shared->lock);
+    m_shared->owner = nullptr;
+#ifdef LIBVIRT_FOUND
+    if (m_shared->stream) {
+        virStreamEventRemoveCallback(m_shared->stream);
+        if (m_shared->flags.load() & EndOfStream) {
+            virStreamFinish(m_shared->stream);
+        } else {
+            virStreamAbort(m_shared->stream);
+        }
+        virStreamFree(m_shared->stream);
+        m_shared->stream = nullptr;
+    }
+#endif
+}
+
+qint64 ConsoleStream::bytesAvailable() const
+{
+    qint64 available = QIODevice::bytesAvailable() + (m_readChunk.size() - m_readOffset);
+    if (m_shared) {
+        available += m_shared->queuedBytes.load(std::memory_order_acquire);
+    }
+    return available;
+}
+
+qint64 ConsoleStream::bytesToWrite() const
+{
+    if (!m_shared) {
+        return 0;
+    }
+    QMutexLocker locker(&m_shared->lock);
+    return m_shared->pending.size() - m_shared->pendingOffset;
+}
+
+void ConsoleStream::setReadBufferLimit(qint64 bytes)
+{
+    m_readBufferLimit = qMax<qint64>(ChunkSize, bytes);
+    if (m_shared) {
+        m_shared->readLimit.store(m_readBufferLimit);
+    }
+}
+
+void ConsoleStream::setWriteBufferLimit(qint64 bytes)
+{
+    m_writeBufferLimit = qMax<qint64>(1, bytes);
+}
+
+qint64 ConsoleStream::readData(char *data, qint64 maxSize)
+{
+    if (!m_shared) {
+        return -1;
+    }
+
+    qint64 copied = 0;
+    while (copied < maxSize) {
+        if (m_readOffset >= m_readChunk.size()) {
+            m_readChunk.clear();
+            m_readOffset = 0;
+            if (!m_shared->chunks.tryPop(&m_readChunk)) {
+                break;
+            }
+            m_shared->queuedChunks.fetch_sub(1, std::memory_order_release);
+        }
+
+        qint64 length = qMin<qint64>(maxSize - copied, m_readChunk.size() - m_readOffset);
+        std::memcpy(data + copied, m_readChunk.constData() + m_readOffset, length);
+        m_readOffset += int(length);
+        copied += length;
+        m_shared->queuedBytes.fetch_sub(length, std::memory_order_release);
+    }
+
+    if (copied > 0) {
+        // Resume reading once the backlog is down to half the limit
+        QMutexLocker locker(&m_shared->lock);
+        if (m_shared->stream && m_shared->readPaused
+            && m_shared->queuedBytes.load() < m_shared->readLimit.load() / 2
+            && m_shared->queuedChunks.load() < m_shared->chunks.capacity() / 2) {
+            m_shared->readPaused = false;
+            m_shared->updateEvents();
+        }
+    } else if ((m_shared->flags.load() & (EndOfStream | StreamFailed))
+               && m_shared->queuedBytes.load() == 0) {
+        // Nothing left: data is queued before the end flag is raised
+        return -1;
+    }
+    return copied;
+}
+
+qint64 ConsoleStream::writeData(const char *data, qint64 maxSize)
+{
+    if (!m_shared) {
+        return -1;
+    }
+
+    QMutexLocker locker(&m_shared->lock);
+    if (!m_shared->stream || m_shared->finished) {
+        setErrorString(tr("Console is not connected"));
+        return -1;
+    }
+
+    qint64 queued = m_shared->pending.size() - m_shared->pendingOffset;
+    qint64 accepted = qMin(maxSize, m_writeBufferLimit - queued);
+    if (accepted <= 0) {
+        return 0;   // Full; retry after bytesWritten()
+    }
+
+    m_shared->pending.append(data, int(accepted));
+    m_shared->updateEvents();
+    return accepted;
+}
+
+void ConsoleStream::processNotifications()
+{
+    if (!m_shared) {
+        return;
+    }
+
+    const int flags = m_shared->flags.fetch_and(~NotifyPending);
+
+    qint64 written = m_shared->writtenBytes.exchange(0);
+    if (written > 0) {
+        emit bytesWritten(written);
+    }
+    if (bytesAvailable() > 0) {
+        emit readyRead();
+    }
+
+    // The device stays open so buffered output can still be read
+    if ((flags & (EndOfStream | StreamFailed)) && m_shared->stream) {
+        QString message;
+        {
+            QMutexLocker locker(&m_shared->lock);
+            message = m_shared->error;
+        }
+        teardown();
+        setErrorString(message);
+        if (flags & StreamFailed) {
+            emit errorOccurred(message);
+        }
+        emit readChannelFinished();
+    }
+}
+
+} // namespace QVirt
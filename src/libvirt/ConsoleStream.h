@@ -0,0 +1,97 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_CONSOLESTREAM_H
+#define QVIRT_LIBVIRT_CONSOLESTREAM_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <memory>
+
+namespace QVirt {
+
+class Domain;
+
+/**
+ * @brief Guest text console as a sequential QIODevice
+ *
+ * Opens a serial/console device with virDomainOpenConsole over a
+ * non-blocking virStream, so it works the same on local and remote
+ * (qemu+ssh, qemu+tls) connections without a PTY or ssh shell.
+ *
+ * All stream I/O happens in virStreamEventAddCallback callbacks on the
+ * libvirt event thread (see EventLoop). Received data is stored as a queue
+ * of chunks handed to the GUI thread without locking; once the reader falls
+ * behind by readBufferLimit() bytes, reading from the stream pauses until
+ * it catches up, so a guest flooding the console cannot run away with
+ * memory. write() accepts at most writeBufferLimit() unsent bytes and
+ * returns a short count beyond that; bytesWritten() reports progress.
+ *
+ * readyRead() and bytesWritten() are coalesced: one notification covers
+ * everything that arrived since the previous one. When the guest side
+ * goes away or the stream fails, the device closes itself and emits
+ * readChannelFinished(); errorString() tells why.
+ */
+class ConsoleStream : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit ConsoleStream(QObject *parent = nullptr);
+    ~ConsoleStream() override;
+
+    /**
+     * @brief Open a console of a running domain
+     * @param device Device alias such as "serial0" or "console0"; empty for
+     *        the first console
+     * @param force Take the console over from another client
+     */
+    bool openConsole(Domain *domain, const QString &device = QString(), bool force = false);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+    qint64 bytesToWrite() const override;
+    void close() override;
+
+    qint64 readBufferLimit() const { return m_readBufferLimit; }
+    void setReadBufferLimit(qint64 bytes);
+
+    qint64 writeBufferLimit() const { return m_writeBufferLimit; }
+    void setWriteBufferLimit(qint64 bytes);
+
+signals:
+    void errorOccurred(const QString &message);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private slots:
+    void processNotifications();
+
+private:
+    struct Shared;
+
+    void teardown();
+
+    std::shared_ptr<Shared> m_shared;
+
+    // Chunk being consumed by readData(), GUI thread only
+    QByteArray m_readChunk;
+    int m_readOffset;
+
+    qint64 m_readBufferLimit;
+    qint64 m_writeBufferLimit;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_CONSOLESTREAM_H
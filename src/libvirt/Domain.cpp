@@ -11,6 +11,7 @@
 
 #include "Domain.h"
 #include "DomainSnapshot.h"
+#include "SnapshotTree.h"
 #include "Connection.h"
 #include "EnumMapper.h"
 #include "../core/Error.h"
@@ -38,7 +39,11 @@ Domain::Domain(Connection *conn, virDomainPtr domain)
     , m_cachedDiskUsage(0.0f)
     , m_cachedNetworkUsage(0.0f)
     , m_maxVcpuCount(0)
+    , m_prevBlockBytes(-1)
+    , m_prevNetBytes(-1)
+    , m_metricHistory(MetricCount)
     , m_xmlFetched(false)
+    , m_snapshotTree(nullptr)
 {
     // Only call libvirt functions if we have a valid virDomainPtr
     // For cached domains (m_domain == nullptr), values will be set by fromCacheInfo()
@@ -177,6 +182,9 @@ void Domain::updateInfoMinimal()
             if (usage < 0.0f) usage = 0.0f;
             if (usage > maxUsage) usage = maxUsage;
             m_cachedCpuUsage = usage;
+            m_cpuHistory.append(usage);
+            // No block stats on this path; hold the last rate so both histories stay aligned
+            m_diskHistory.append(m_cachedDiskUsage);
         }
     }
 
@@ -193,7 +201,8 @@ void Domain::updateInfoMinimal()
 }
 
 void Domain::applyStats(int state, quint64 maxMemory, quint64 currentMemory,
-                        int vcpuCount, quint64 cpuTime)
+                        int vcpuCount, quint64 cpuTime, qint64 blockBytes,
+                        qint64 netBytes)
 {
     State newState = static_cast<State>(state);
     if (newState != m_state) {
@@ -211,9 +220,36 @@ void Domain::applyStats(int state, quint64 maxMemory, quint64 currentMemory,
             if (usage < 0.0f) usage = 0.0f;
             if (usage > maxUsage) usage = maxUsage;
             m_cachedCpuUsage = usage;
+
+            if (blockBytes >= 0 && m_prevBlockBytes >= 0 && blockBytes >= m_prevBlockBytes) {
+                m_cachedDiskUsage = static_cast<float>(blockBytes - m_prevBlockBytes) / 1024.0f /
+                                    (static_cast<float>(timeDelta) / 1000.0f);
+            } else {
+                m_cachedDiskUsage = 0.0f;
+            }
+
+            if (netBytes >= 0 && m_prevNetBytes >= 0 && netBytes >= m_prevNetBytes) {
+                m_cachedNetworkUsage = static_cast<float>(netBytes - m_prevNetBytes) / 1024.0f /
+                                       (static_cast<float>(timeDelta) / 1000.0f);
+            } else {
+                m_cachedNetworkUsage = 0.0f;
+            }
+
+            m_cpuHistory.append(m_cachedCpuUsage);
+            m_diskHistory.append(m_cachedDiskUsage);
+
+            float metrics[MetricCount];
+            metrics[CpuMetric] = m_cachedCpuUsage;
+            metrics[MemoryMetric] = maxMemory > 0 ?
+                qMin(100.0f, static_cast<float>(currentMemory) * 100.0f / maxMemory) : 0.0f;
+            metrics[DiskMetric] = m_cachedDiskUsage;
+            metrics[NetworkMetric] = m_cachedNetworkUsage;
+            m_metricHistory.append(currentTime, metrics);
         }
     }
 
+    m_prevBlockBytes = blockBytes;
+    m_prevNetBytes = netBytes;
     m_prevCpuTime = cpuTime;
     m_prevCpuTimestamp = currentTime;
 
@@ -443,27 +479,19 @@ QList<DomainSnapshot*> Domain::snapshots() const
         return snapshotList;
     }
 
-    // List all snapshots
-    int numSnapshots = virDomainSnapshotNum(m_domain, 0);
+    // One call returns the handles; no lookup by name per snapshot
+    virDomainSnapshotPtr *snaps = nullptr;
+    int numSnapshots = virDomainListAllSnapshots(m_domain, &snaps, 0);
     if (numSnapshots < 0) {
         return snapshotList;
     }
 
-    // Get snapshot names
-    char **names = new char*[numSnapshots];
-    numSnapshots = virDomainSnapshotListNames(m_domain, names, numSnapshots, 0);
-
     for (int i = 0; i < numSnapshots; ++i) {
-        virDomainSnapshotPtr snap = virDomainSnapshotLookupByName(m_domain, names[i], 0);
-        if (snap) {
-            auto *snapshot = new DomainSnapshot(snap, const_cast<Domain*>(this),
-                                                const_cast<Domain*>(this));
-            snapshotList.append(snapshot);
-        }
-        free(names[i]);
+        auto *snapshot = new DomainSnapshot(snaps[i], const_cast<Domain*>(this),
+                                            const_cast<Domain*>(this));
+        snapshotList.append(snapshot);
     }
-
-    delete[] names;
+    free(snaps);
 
     return snapshotList;
 }
@@ -478,6 +506,7 @@ DomainSnapshot *Domain::createSnapshot(const QString &xml, unsigned int flags)
     virDomainSnapshotPtr snap = virDomainSnapshotCreateXML(m_domain, xmlBytes.constData(), flags);
 
     if (snap) {
+        emit snapshotsChanged();
         return new DomainSnapshot(snap, this, this);
     }
 
@@ -508,6 +537,14 @@ bool Domain::hasCurrentSnapshot() const
     return virDomainHasCurrentSnapshot(m_domain, 0) == 1;
 }
 
+SnapshotTree *Domain::snapshotTree()
+{
+    if (!m_snapshotTree) {
+        m_snapshotTree = new SnapshotTree(this, this);
+    }
+    return m_snapshotTree;
+}
+
 // Guest Agent methods - simplified implementation
 bool Domain::guestAgentConnected() const
 {
@@ -13,6 +13,8 @@
 #define QVIRT_LIBVIRT_DOMAIN_H
 
 #include "../core/BaseObject.h"
+#include "../core/StatsHistory.h"
+#include "../core/MetricHistory.h"
 #include <QString>
 #include <QPixmap>
 #include <QList>
@@ -44,6 +46,7 @@ namespace QVirt {
 
 class Connection;
 class DomainSnapshot;
+class SnapshotTree;
 
 /**
  * @brief libvirt domain (VM) wrapper
@@ -115,8 +118,22 @@ public:
     quint64 cpuTime() const { return m_cpuTime; }
     float cpuUsage() const { return m_cachedCpuUsage; }
     quint64 currentMemory() const { return m_currentMemory; }
-    float diskUsage() const { return m_cachedDiskUsage; }
-    float networkUsage() const { return m_cachedNetworkUsage; }
+    float diskUsage() const { return m_cachedDiskUsage; }  // KiB/s
+    float networkUsage() const { return m_cachedNetworkUsage; }  // KiB/s
+
+    // Recent samples fed by the stats collector (cached - never call libvirt)
+    const StatsHistory &cpuHistory() const { return m_cpuHistory; }
+    const StatsHistory &diskHistory() const { return m_diskHistory; }
+
+    // Long-horizon history of all metrics on a shared time axis
+    enum MetricSeries {
+        CpuMetric,          // percent
+        MemoryMetric,       // percent of max memory
+        DiskMetric,         // KiB/s
+        NetworkMetric,      // KiB/s
+        MetricCount
+    };
+    const TieredMetricHistory &metricHistory() const { return m_metricHistory; }
 
     // Update cached info (synchronous - may block)
     void updateInfo();
@@ -125,8 +142,11 @@ public:
     void updateInfoMinimal();
 
     // Apply pre-collected stats (no libvirt calls, main thread only)
+    // blockBytes is the total bytes read+written by all disks, netBytes the
+    // total bytes received+sent by all interfaces; -1 if unknown
     void applyStats(int state, quint64 maxMemory, quint64 currentMemory,
-                    int vcpuCount, quint64 cpuTime);
+                    int vcpuCount, quint64 cpuTime, qint64 blockBytes = -1,
+                    qint64 netBytes = -1);
 
     // Update cached info (asynchronous - non-blocking)
     void updateInfoAsync();
@@ -138,6 +158,9 @@ public:
     DomainSnapshot *currentSnapshot() const;
     bool hasCurrentSnapshot() const;
 
+    // All snapshots as a tree, cached and loaded in the background
+    SnapshotTree *snapshotTree();
+
     // Guest Agent
     bool guestAgentConnected() const;
     QString guestAgentVersion() const;
@@ -211,6 +234,9 @@ signals:
     void infoUpdateFailed();
     void lifecycleOperationFinished(const QString &operation, bool success);
 
+    // A snapshot was created, deleted or reverted to
+    void snapshotsChanged();
+
 private:
     Domain(Connection *conn, virDomainPtr domain);
     void setState(State state);
@@ -244,10 +270,19 @@ private:
     float m_cachedDiskUsage;
     float m_cachedNetworkUsage;
     int m_maxVcpuCount;
+    qint64 m_prevBlockBytes;
+    qint64 m_prevNetBytes;
+
+    // Stats histories
+    StatsHistory m_cpuHistory;
+    StatsHistory m_diskHistory;
+    TieredMetricHistory m_metricHistory;
 
     // Track if XML has been fetched
     bool m_xmlFetched;
 
+    SnapshotTree *m_snapshotTree;
+
     friend class Connection;
 };
 
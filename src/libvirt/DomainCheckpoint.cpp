@@ -27,6 +27,13 @@ DomainCheckpoint::DomainCheckpoint(Connection *conn, void *checkpointHandle, QOb
 #endif
 {
     Q_UNUSED(conn);
+#ifdef LIBVIRT_FOUND
+    if (m_checkpointHandle) {
+        reload();
+    }
+#else
+    Q_UNUSED(checkpointHandle);
+#endif
 }
 
 DomainCheckpoint::DomainCheckpoint(QObject *parent)
@@ -76,6 +83,48 @@ void DomainCheckpoint::setParentName(const QString &name)
     }
 }
 
+void DomainCheckpoint::setDisks(const QList<Disk> &disks)
+{
+    m_disks = disks;
+    emit stateChanged();
+}
+
+qint64 DomainCheckpoint::changedBytes() const
+{
+    qint64 total = 0;
+    bool known = false;
+    for (const Disk &disk : m_disks) {
+        if (disk.size >= 0) {
+            total += disk.size;
+            known = true;
+        }
+    }
+    return known ? total : -1;
+}
+
+#ifdef LIBVIRT_FOUND
+bool DomainCheckpoint::reload(bool withSize)
+{
+    auto checkpoint = reinterpret_cast<virDomainCheckpointPtr>(m_checkpointHandle);
+    if (!checkpoint) {
+        return false;
+    }
+
+    unsigned int flags = VIR_DOMAIN_CHECKPOINT_XML_NO_DOMAIN;
+    if (withSize) {
+        flags |= VIR_DOMAIN_CHECKPOINT_XML_SIZE;
+    }
+    char *xml = virDomainCheckpointGetXMLDesc(checkpoint, flags);
+    if (!xml) {
+        return false;
+    }
+    bool ok = fromXML(QString::fromUtf8(xml));
+    free(xml);
+    emit stateChanged();
+    return ok;
+}
+#endif
+
 void DomainCheckpoint::setReverting(bool reverting)
 {
     if (m_reverting != reverting) {
@@ -89,7 +138,7 @@ QString DomainCheckpoint::toXML() const
     QString xml;
     QXmlStreamWriter writer(&xml);
     writer.setAutoFormatting(false);
-    writer.writeStartElement("domainCheckpoint");
+    writer.writeStartElement("domaincheckpoint");
 
     writer.writeTextElement("name", m_name);
 
@@ -97,12 +146,32 @@ QString DomainCheckpoint::toXML() const
         writer.writeTextElement("description", m_description);
     }
 
+    // Output only; libvirt ignores these unless a checkpoint is redefined
     if (m_creationTime.isValid()) {
-        writer.writeTextElement("creationTime", m_creationTime.toString(Qt::ISODate));
+        writer.writeTextElement("creationTime",
+                                QString::number(m_creationTime.toSecsSinceEpoch()));
     }
 
     if (!m_parentName.isEmpty()) {
-        writer.writeTextElement("parent", m_parentName);
+        writer.writeStartElement("parent");
+        writer.writeTextElement("name", m_parentName);
+        writer.writeEndElement();
+    }
+
+    if (!m_disks.isEmpty()) {
+        writer.writeStartElement("disks");
+        for (const Disk &disk : m_disks) {
+            writer.writeStartElement("disk");
+            writer.writeAttribute("name", disk.name);
+            if (!disk.checkpoint.isEmpty()) {
+                writer.writeAttribute("checkpoint", disk.checkpoint);
+            }
+            if (!disk.bitmap.isEmpty()) {
+                writer.writeAttribute("bitmap", disk.bitmap);
+            }
+            writer.writeEndElement();
+        }
+        writer.writeEndElement();
     }
 
     writer.writeEndElement();
@@ -112,28 +181,64 @@ QString DomainCheckpoint::toXML() const
 bool DomainCheckpoint::fromXML(const QString &xml)
 {
     QXmlStreamReader reader(xml);
-    
+    QList<Disk> disks;
+    int depth = 0;                  // The root element is at depth 1
+
     while (!reader.atEnd() && !reader.hasError()) {
         reader.readNext();
-        
-        if (reader.isStartElement()) {
+
+        if (reader.isEndElement()) {
+            depth--;
+            continue;
+        }
+        if (!reader.isStartElement()) {
+            continue;
+        }
+        depth++;
+
+        // The embedded <domain> has a <name> of its own
+        if (depth == 2) {
             if (reader.name() == QLatin1String("name")) {
                 m_name = reader.readElementText();
+                depth--;
             } else if (reader.name() == QLatin1String("description")) {
                 m_description = reader.readElementText();
+                depth--;
             } else if (reader.name() == QLatin1String("creationTime")) {
-                m_creationTime = QDateTime::fromString(reader.readElementText(), Qt::ISODate);
+                // Seconds since the epoch; older copies of this class wrote ISO dates
+                const QString text = reader.readElementText().trimmed();
+                bool isNumber = false;
+                const qint64 seconds = text.toLongLong(&isNumber);
+                m_creationTime = isNumber ? QDateTime::fromSecsSinceEpoch(seconds)
+                                          : QDateTime::fromString(text, Qt::ISODate);
+                depth--;
             } else if (reader.name() == QLatin1String("parent")) {
-                m_parentName = reader.readElementText();
+                // <parent><name>...</name></parent>, or the old plain text form
+                m_parentName = reader.readElementText(QXmlStreamReader::IncludeChildElements)
+                                   .trimmed();
+                depth--;
+            } else if (reader.name() != QLatin1String("disks")) {
+                reader.skipCurrentElement();
+                depth--;
             }
+        } else if (depth == 3 && reader.name() == QLatin1String("disk")) {
+            const QXmlStreamAttributes attrs = reader.attributes();
+            Disk disk;
+            disk.name = attrs.value("name").toString();
+            disk.checkpoint = attrs.value("checkpoint").toString();
+            disk.bitmap = attrs.value("bitmap").toString();
+            if (attrs.hasAttribute("size")) {
+                disk.size = attrs.value("size").toString().toLongLong();
+            }
+            disks.append(disk);
         }
-        
-        if (reader.isEndElement() && reader.name() == QLatin1String("domainCheckpoint")) {
-            break;
-        }
     }
-    
-    return !reader.hasError();
+
+    if (reader.hasError()) {
+        return false;
+    }
+    m_disks = disks;
+    return true;
 }
 
 } // namespace QVirt
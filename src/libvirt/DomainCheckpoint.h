@@ -15,6 +15,7 @@
 #include "../core/BaseObject.h"
 #include <QString>
 #include <QDateTime>
+#include <QList>
 
 #ifdef LIBVIRT_FOUND
 #include <libvirt/libvirt.h>
@@ -27,13 +28,24 @@ class Connection;
 /**
  * @brief Domain checkpoint wrapper
  *
- * Represents a VM checkpoint for save/restore functionality
+ * A checkpoint marks a point in time on the disks of a domain: QEMU keeps
+ * a dirty bitmap per disk from then on, so an incremental backup only
+ * reads the blocks written since. toXML() and fromXML() use libvirt's
+ * <domaincheckpoint> format.
  */
 class DomainCheckpoint : public BaseObject
 {
     Q_OBJECT
 
 public:
+    // Per-disk part of the checkpoint
+    struct Disk {
+        QString name;               // Target device, e.g. "vda"
+        QString checkpoint;         // "bitmap" or "no"
+        QString bitmap;             // Bitmap name, set by libvirt
+        qint64 size = -1;           // Bytes written since, if asked for
+    };
+
     explicit DomainCheckpoint(Connection *conn, void *checkpointHandle, QObject *parent = nullptr);
     explicit DomainCheckpoint(QObject *parent = nullptr);
     ~DomainCheckpoint() override;
@@ -50,8 +62,22 @@ public:
     QString parentName() const { return m_parentName; }
     void setParentName(const QString &name);
 
+    QList<Disk> disks() const { return m_disks; }
+    void setDisks(const QList<Disk> &disks);
+
+    // Bytes written since the checkpoint over all disks, -1 if unknown
+    qint64 changedBytes() const;
+
 #ifdef LIBVIRT_FOUND
     void *handle() const { return m_checkpointHandle; }
+
+    /**
+     * @brief Re-read the checkpoint from libvirt
+     *
+     * With @p withSize the disks report how much was written since the
+     * checkpoint; that asks QEMU and needs the domain running.
+     */
+    bool reload(bool withSize = false);
 #endif
 
     bool isReverting() const { return m_reverting; }
@@ -68,6 +94,7 @@ private:
     QString m_description;
     QDateTime m_creationTime;
     QString m_parentName;
+    QList<Disk> m_disks;
 #ifdef LIBVIRT_FOUND
     void *m_checkpointHandle = nullptr;
 #endif
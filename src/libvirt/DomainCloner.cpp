@@ -0,0 +1,606 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "DomainCloner.h"
+#include "Connection.h"
+#include "Domain.h"
+#include "StorageVolume.h"
+
+#include <QDomDocument>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTimer>
+#include <QUuid>
+#include <QDebug>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+bool volumeExists(virStoragePoolPtr pool, const QString &name)
+{
+    virStorageVolPtr vol = virStorageVolLookupByName(pool, name.toUtf8().constData());
+    if (!vol) {
+        return false;
+    }
+    virStorageVolFree(vol);
+    return true;
+}
+
+// @p name, or "name-N.ext" if it is taken in @p pool or by another disk
+QString uniqueVolumeName(virStoragePoolPtr pool, const QString &name, const QSet<QString> &taken)
+{
+    int dot = name.lastIndexOf('.');
+    const QString base = dot > 0 ? name.left(dot) : name;
+    const QString extension = dot > 0 ? name.mid(dot) : QString();
+
+    QString candidate = name;
+    for (int i = 1; taken.contains(candidate) || volumeExists(pool, candidate); ++i) {
+        candidate = QString("%1-%2%3").arg(base).arg(i).arg(extension);
+    }
+    return candidate;
+}
+
+} // namespace
+
+DomainCloner::DomainCloner(Domain *source, const QString &cloneName,
+                           StorageJobManager *jobs, QObject *parent)
+    : QObject(parent)
+    , m_source(source)
+    , m_cloneName(cloneName)
+    , m_jobs(jobs ? jobs : StorageJobManager::instance())
+    , m_cloneStorage(true)
+    , m_generateMACs(true)
+    , m_state(Idle)
+    , m_abortState(Idle)
+    , m_clone(nullptr)
+{
+}
+
+DomainCloner::~DomainCloner()
+{
+    if (m_state == Cloning) {
+        // Stop quietly; running jobs delete what they create
+        for (const PendingDisk &pending : m_pending) {
+            if (pending.job) {
+                disconnect(pending.job, nullptr, this, nullptr);
+                if (m_jobs) {
+                    m_jobs->cancel(pending.job);
+                }
+            }
+        }
+        rollback();
+    }
+    clearPending();
+}
+
+qint64 DomainCloner::processedBytes() const
+{
+    qint64 processed = 0;
+    for (const Disk &disk : m_disks) {
+        processed += disk.processed;
+    }
+    return processed;
+}
+
+qint64 DomainCloner::totalBytes() const
+{
+    qint64 total = 0;
+    for (const Disk &disk : m_disks) {
+        total += disk.total;
+    }
+    return total;
+}
+
+bool DomainCloner::start()
+{
+    if (m_state == Cloning) {
+        m_error = tr("A clone is already in progress");
+        return false;
+    }
+    if (!m_source || !m_source->connection()) {
+        m_error = tr("No source domain");
+        return false;
+    }
+    if (m_cloneName.isEmpty()) {
+        m_error = tr("The clone needs a name");
+        return false;
+    }
+    if (!m_jobs) {
+        m_error = tr("No storage job manager");
+        return false;
+    }
+
+    // A running guest keeps writing to its disks while they are copied
+    Domain::State domainState = m_source->state();
+    if (domainState != Domain::StateShutOff && domainState != Domain::StatePaused) {
+        m_error = tr("Domain '%1' must be shut off or paused to be cloned").arg(m_source->name());
+        return false;
+    }
+    if (m_source->connection()->getDomain(m_cloneName)) {
+        m_error = tr("A domain named '%1' already exists").arg(m_cloneName);
+        return false;
+    }
+
+    m_sourceXml = m_source->getXMLDesc(VIR_DOMAIN_XML_INACTIVE | VIR_DOMAIN_XML_SECURE);
+    if (m_sourceXml.isEmpty()) {
+        m_error = tr("Failed to get the XML of domain '%1'").arg(m_source->name());
+        return false;
+    }
+
+    clearPending();
+    m_disks.clear();
+    m_error.clear();
+    m_clone = nullptr;
+    if (m_cloneStorage && !prepareDisks(m_sourceXml)) {
+        clearPending();
+        m_disks.clear();
+        return false;
+    }
+
+    m_abortState = Idle;
+    setState(Cloning);
+
+    // The job manager bounds how many disks copy at once per pool
+    for (int i = 0; i < m_pending.size(); ++i) {
+        PendingDisk &pending = m_pending[i];
+        StorageJob *job = m_jobs->cloneVolume(pending.source, m_disks.at(i).cloneName, m_targetPool);
+        pending.job = job;
+        m_disks[i].total = job->totalBytes();
+
+        connect(job, &StorageJob::progress, this, [this, i](qint64 processed, qint64 total) {
+            Disk &disk = m_disks[i];
+            disk.processed = processed;
+            disk.total = total;
+            emit diskProgress(i, processed, total);
+            emit progress(processedBytes(), totalBytes());
+        });
+        connect(job, &StorageJob::stateChanged, this, [this, i]() {
+            onJobStateChanged(i);
+        });
+    }
+
+    if (m_pending.isEmpty()) {
+        // Nothing to copy: define from the event loop like any other outcome
+        QTimer::singleShot(0, this, &DomainCloner::defineClone);
+    }
+    return true;
+}
+
+void DomainCloner::cancel()
+{
+    if (m_state != Cloning) {
+        return;
+    }
+
+    abort(tr("Cancelled"), Cancelled);
+    if (jobsDone()) {
+        finishAbort();
+    }
+}
+
+bool DomainCloner::prepareDisks(const QString &xml)
+{
+    QDomDocument doc;
+    if (!doc.setContent(xml)) {
+        m_error = tr("Failed to parse the domain XML");
+        return false;
+    }
+
+    virConnectPtr conn = virDomainGetConnect(m_source->rawDomain());
+    if (!conn) {
+        m_error = lastErrorMessage(tr("No connection for domain '%1'").arg(m_source->name()));
+        return false;
+    }
+
+    // Names picked so far per target pool, so two disks never collide
+    QHash<QString, QSet<QString>> taken;
+
+    QDomElement devices = doc.documentElement().firstChildElement("devices");
+    for (QDomElement disk = devices.firstChildElement("disk"); !disk.isNull();
+         disk = disk.nextSiblingElement("disk")) {
+        // Removable media and disks meant to be shared stay as they are
+        if (disk.attribute("device", "disk") != "disk"
+            || !disk.firstChildElement("readonly").isNull()
+            || !disk.firstChildElement("shareable").isNull()) {
+            continue;
+        }
+
+        const QString type = disk.attribute("type");
+        const QString target = disk.firstChildElement("target").attribute("dev");
+        QDomElement source = disk.firstChildElement("source");
+
+        QString sourcePath;
+        virStorageVolPtr vol = nullptr;
+        if (type == "file" || type == "block") {
+            sourcePath = source.attribute(type == "file" ? "file" : "dev");
+            if (sourcePath.isEmpty()) {
+                continue;
+            }
+            vol = virStorageVolLookupByPath(conn, sourcePath.toUtf8().constData());
+        } else if (type == "volume") {
+            const QString poolName = source.attribute("pool");
+            const QString volumeName = source.attribute("volume");
+            sourcePath = poolName + "/" + volumeName;
+            virStoragePoolPtr pool = virStoragePoolLookupByName(conn, poolName.toUtf8().constData());
+            if (pool) {
+                vol = virStorageVolLookupByName(pool, volumeName.toUtf8().constData());
+                virStoragePoolFree(pool);
+            }
+        } else {
+            m_error = tr("Disk %1 of type '%2' cannot be cloned").arg(target, type);
+            return false;
+        }
+
+        if (!vol) {
+            m_error = tr("Disk %1 (%2) is not a volume of any storage pool")
+                          .arg(target, sourcePath);
+            return false;
+        }
+
+        virStoragePoolPtr sourcePool = virStoragePoolLookupByVolume(vol);
+        StoragePool *sourceWrapper = nullptr;
+        if (sourcePool) {
+            const char *name = virStoragePoolGetName(sourcePool);
+            sourceWrapper = m_source->connection()->getStoragePool(QString::fromUtf8(name));
+        }
+
+        PendingDisk pending;
+        pending.source = new StorageVolume(vol, sourceWrapper, this);
+        pending.sourceType = type;
+        if (m_targetPool && m_targetPool->virPool()) {
+            pending.targetPool = m_targetPool->virPool();
+            virStoragePoolRef(pending.targetPool);
+            if (sourcePool) {
+                virStoragePoolFree(sourcePool);
+            }
+        } else {
+            pending.targetPool = sourcePool;
+        }
+        m_pending.append(pending);
+
+        if (!pending.targetPool) {
+            m_error = lastErrorMessage(tr("Cannot find the pool of disk %1").arg(target));
+            return false;
+        }
+
+        Disk entry;
+        entry.target = target;
+        entry.sourcePath = sourcePath;
+        entry.poolName = QString::fromUtf8(virStoragePoolGetName(pending.targetPool));
+        entry.total = pending.source->allocation();
+
+        QSet<QString> &names = taken[entry.poolName];
+        entry.cloneName = uniqueVolumeName(pending.targetPool,
+            cloneVolumeName(pending.source->name(), m_source->name(), m_cloneName), names);
+        names.insert(entry.cloneName);
+        m_disks.append(entry);
+    }
+    return true;
+}
+
+void DomainCloner::clearPending()
+{
+    for (const PendingDisk &pending : m_pending) {
+        delete pending.source;
+        if (pending.targetPool) {
+            virStoragePoolFree(pending.targetPool);
+        }
+    }
+    m_pending.clear();
+}
+
+bool DomainCloner::jobsDone() const
+{
+    for (const PendingDisk &pending : m_pending) {
+        if (pending.job && !pending.job->isDone()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DomainCloner::onJobStateChanged(int index)
+{
+    if (m_state != Cloning || index >= m_pending.size()) {
+        return;
+    }
+    StorageJob *job = m_pending.at(index).job;
+    if (!job) {
+        return;
+    }
+
+    Disk &disk = m_disks[index];
+    disk.state = job->state();
+    disk.error = job->errorString();
+    if (!job->isDone()) {
+        return;
+    }
+
+    if (job->state() == StorageJob::Finished) {
+        disk.processed = disk.total;
+        emit diskProgress(index, disk.processed, disk.total);
+        emit progress(processedBytes(), totalBytes());
+    } else if (job->state() == StorageJob::Failed) {
+        // The first failure stops the other disks
+        abort(tr("Failed to clone disk %1: %2").arg(disk.target, disk.error), Failed);
+    }
+
+    if (!jobsDone()) {
+        return;
+    }
+    if (m_abortState != Idle) {
+        finishAbort();
+    } else {
+        defineClone();
+    }
+}
+
+void DomainCloner::defineClone()
+{
+    if (m_state != Cloning || m_abortState != Idle) {
+        return;
+    }
+
+    QHash<QString, DiskSource> sources;
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const PendingDisk &pending = m_pending.at(i);
+        Disk &disk = m_disks[i];
+
+        virStorageVolPtr vol = virStorageVolLookupByName(pending.targetPool,
+                                                         disk.cloneName.toUtf8().constData());
+        if (!vol) {
+            abort(lastErrorMessage(tr("Cloned volume '%1' is missing").arg(disk.cloneName)), Failed);
+            finishAbort();
+            return;
+        }
+
+        char *path = virStorageVolGetPath(vol);
+        if (path) {
+            disk.clonePath = QString::fromUtf8(path);
+            free(path);
+        }
+
+        virStorageVolInfo info;
+        bool haveInfo = virStorageVolGetInfo(vol, &info) == 0;
+        virStorageVolFree(vol);
+
+        // Keep volume references; otherwise follow what the volume is
+        DiskSource source;
+        if (pending.sourceType == "volume" || !haveInfo
+            || (info.type != VIR_STORAGE_VOL_FILE && info.type != VIR_STORAGE_VOL_BLOCK)) {
+            source.type = "volume";
+            source.pool = disk.poolName;
+            source.volume = disk.cloneName;
+        } else {
+            source.type = info.type == VIR_STORAGE_VOL_FILE ? "file" : "block";
+            source.path = disk.clonePath;
+        }
+        sources.insert(disk.target, source);
+    }
+
+    Connection *connection = m_source ? m_source->connection() : nullptr;
+    if (!connection) {
+        abort(tr("The connection was closed"), Failed);
+        finishAbort();
+        return;
+    }
+
+    const QString xml = rewriteXML(m_sourceXml, m_cloneName,
+                                   QUuid::createUuid().toString(QUuid::WithoutBraces),
+                                   sources, m_generateMACs);
+
+    QString error;
+    Domain *clone = connection->defineDomain(xml, &error);
+    if (!clone) {
+        abort(tr("Failed to define domain '%1': %2").arg(m_cloneName, error), Failed);
+        finishAbort();
+        return;
+    }
+
+    m_clone = clone;
+    clearPending();
+    setState(Finished);
+    emit finished(true);
+}
+
+void DomainCloner::abort(const QString &error, State state)
+{
+    if (m_abortState != Idle) {
+        return;
+    }
+    m_error = error;
+    m_abortState = state;
+
+    // Queued jobs drop out at once, which may finish the abort right
+    // here; running ones delete their volume when they are done
+    QList<QPointer<StorageJob>> jobs;
+    for (const PendingDisk &pending : m_pending) {
+        jobs.append(pending.job);
+    }
+    for (const QPointer<StorageJob> &job : jobs) {
+        if (job && !job->isDone() && m_jobs) {
+            m_jobs->cancel(job);
+        }
+    }
+}
+
+void DomainCloner::finishAbort()
+{
+    if (m_state != Cloning) {
+        return;
+    }
+
+    rollback();
+    clearPending();
+    qWarning() << "Cloning" << (m_source ? m_source->name() : QString()) << "failed:" << m_error;
+    setState(m_abortState);
+    emit finished(false);
+}
+
+void DomainCloner::rollback()
+{
+    // Cancelled and failed jobs leave nothing behind; finished ones do
+    QSet<StoragePool*> changed;
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const PendingDisk &pending = m_pending.at(i);
+        if (!pending.job || pending.job->state() != StorageJob::Finished || !pending.targetPool) {
+            continue;
+        }
+
+        const QString &name = m_disks.at(i).cloneName;
+        virStorageVolPtr vol = virStorageVolLookupByName(pending.targetPool, name.toUtf8().constData());
+        if (!vol) {
+            continue;
+        }
+        if (virStorageVolDelete(vol, 0) < 0) {
+            qWarning() << "Failed to remove cloned volume" << name << ":"
+                       << lastErrorMessage(QStringLiteral("unknown error"));
+        }
+        virStorageVolFree(vol);
+
+        StoragePool *pool = m_targetPool ? m_targetPool.data()
+                                         : (pending.source ? pending.source->pool() : nullptr);
+        if (pool) {
+            changed.insert(pool);
+        }
+    }
+    for (StoragePool *pool : changed) {
+        pool->refreshVolumes();
+    }
+}
+
+void DomainCloner::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    emit stateChanged(state);
+}
+
+QString DomainCloner::cloneVolumeName(const QString &volume, const QString &sourceDomain,
+                                      const QString &cloneDomain)
+{
+    int at = sourceDomain.isEmpty() ? -1 : volume.indexOf(sourceDomain);
+    if (at >= 0) {
+        QString name = volume;
+        return name.replace(at, sourceDomain.length(), cloneDomain);
+    }
+    return cloneDomain + "-" + volume;
+}
+
+QString DomainCloner::generateMAC()
+{
+    // 52:54:00 is the prefix libvirt uses for QEMU/KVM guests
+    QString mac = "52:54:00";
+
+    auto *rng = QRandomGenerator::global();
+    for (int i = 0; i < 3; ++i) {
+        quint8 byte = static_cast<quint8>(rng->bounded(256));
+        mac += QString(":%1").arg(byte, 2, 16, QChar('0'));
+    }
+    return mac;
+}
+
+QString DomainCloner::rewriteXML(const QString &xml, const QString &name, const QString &uuid,
+                                 const QHash<QString, DiskSource> &disks, bool newMACs)
+{
+    QDomDocument doc;
+    if (!doc.setContent(xml)) {
+        return QString();
+    }
+    QDomElement root = doc.documentElement();
+
+    auto setText = [&doc, &root](const QString &tag, const QString &text) {
+        QDomElement element = root.firstChildElement(tag);
+        if (element.isNull()) {
+            element = doc.createElement(tag);
+            root.insertAfter(element, root.firstChildElement("name"));
+        }
+        while (element.hasChildNodes()) {
+            element.removeChild(element.firstChild());
+        }
+        element.appendChild(doc.createTextNode(text));
+    };
+    setText("name", name);
+    setText("uuid", uuid);
+
+    // Without a path libvirt creates fresh UEFI variables from the template
+    QDomElement nvram = root.firstChildElement("os").firstChildElement("nvram");
+    while (!nvram.isNull() && nvram.hasChildNodes()) {
+        nvram.removeChild(nvram.firstChild());
+    }
+
+    QDomElement devices = root.firstChildElement("devices");
+    for (QDomElement disk = devices.firstChildElement("disk"); !disk.isNull();
+         disk = disk.nextSiblingElement("disk")) {
+        const QString target = disk.firstChildElement("target").attribute("dev");
+        if (!disks.contains(target)) {
+            continue;
+        }
+        const DiskSource &newSource = disks.value(target);
+
+        disk.setAttribute("type", newSource.type);
+        QDomElement source = disk.firstChildElement("source");
+        if (source.isNull()) {
+            source = doc.createElement("source");
+            disk.insertBefore(source, disk.firstChildElement("target"));
+        }
+        for (const char *attribute : {"file", "dev", "pool", "volume", "mode"}) {
+            source.removeAttribute(attribute);
+        }
+        if (newSource.type == "file") {
+            source.setAttribute("file", newSource.path);
+        } else if (newSource.type == "block") {
+            source.setAttribute("dev", newSource.path);
+        } else {
+            source.setAttribute("pool", newSource.pool);
+            source.setAttribute("volume", newSource.volume);
+        }
+
+        // The copy is a standalone image
+        QDomElement backing = disk.firstChildElement("backingStore");
+        if (!backing.isNull()) {
+            disk.removeChild(backing);
+        }
+    }
+
+    if (newMACs) {
+        for (QDomElement iface = devices.firstChildElement("interface"); !iface.isNull();
+             iface = iface.nextSiblingElement("interface")) {
+            QDomElement mac = iface.firstChildElement("mac");
+            if (!mac.isNull()) {
+                mac.setAttribute("address", generateMAC());
+            }
+        }
+    }
+
+    return doc.toString();
+}
+
+} // namespace QVirt
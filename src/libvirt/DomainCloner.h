@@ -0,0 +1,173 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_DOMAINCLONER_H
+#define QVIRT_LIBVIRT_DOMAINCLONER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+
+#include "StorageJobManager.h"
+#include "StoragePool.h"
+
+namespace QVirt {
+
+class Domain;
+class StorageVolume;
+
+/**
+ * @brief Clones a domain together with its disks
+ *
+ * Every writable disk backed by a storage volume is cloned as its own
+ * StorageJob, so the disks copy side by side within the job manager's
+ * per-pool limit and a clone takes about as long as its largest disk.
+ * Reflinks are tried first where the pool allows them.
+ *
+ * Once all disks are done the domain XML is rewritten (name, UUID, disk
+ * sources and, optionally, MAC addresses) and defined. If a disk fails,
+ * the remaining jobs are cancelled; if anything fails, the volumes
+ * created so far are deleted again. Read-only and shareable disks and
+ * removable media are kept as they are.
+ */
+class DomainCloner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Idle,
+        Cloning,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    struct Disk {
+        QString target;             // Guest device, e.g. "vda"
+        QString sourcePath;
+        QString cloneName;          // Name of the new volume
+        QString clonePath;          // Set once the clone exists
+        QString poolName;           // Pool the clone goes to
+        qint64 processed = 0;
+        qint64 total = 0;
+        StorageJob::State state = StorageJob::Queued;
+        QString error;
+    };
+
+    // New source of a disk in the cloned domain
+    struct DiskSource {
+        QString type;               // "file", "block" or "volume"
+        QString path;               // For file and block disks
+        QString pool;               // For volume disks
+        QString volume;
+    };
+
+    DomainCloner(Domain *source, const QString &cloneName,
+                 StorageJobManager *jobs = nullptr, QObject *parent = nullptr);
+    ~DomainCloner() override;
+
+    // Copy the disks; on by default. Without it the clone shares them.
+    bool cloneStorage() const { return m_cloneStorage; }
+    void setCloneStorage(bool clone) { m_cloneStorage = clone; }
+
+    // Pool for the cloned disks; null keeps each next to its source
+    void setTargetPool(StoragePool *pool) { m_targetPool = pool; }
+
+    bool generateMACs() const { return m_generateMACs; }
+    void setGenerateMACs(bool generate) { m_generateMACs = generate; }
+
+    // Start cloning; false with errorString() if it cannot start
+    bool start();
+
+    // Stop the disk jobs and roll back
+    void cancel();
+
+    State state() const { return m_state; }
+    QString errorString() const { return m_error; }
+    QList<Disk> disks() const { return m_disks; }
+
+    // Summed over all disks
+    qint64 processedBytes() const;
+    qint64 totalBytes() const;
+
+    // The new domain once finished
+    Domain *clonedDomain() const { return m_clone; }
+
+    /**
+     * @brief Name for the clone of volume @p volume
+     *
+     * The source domain's name in the volume name is replaced by the
+     * clone's; otherwise the clone's name is put in front. The extension
+     * is kept.
+     */
+    static QString cloneVolumeName(const QString &volume, const QString &sourceDomain,
+                                   const QString &cloneDomain);
+
+    // Random locally administered MAC in the QEMU/KVM range
+    static QString generateMAC();
+
+    /**
+     * @brief Domain XML for the clone
+     *
+     * Sets @p name and @p uuid, points the disks listed in @p disks (by
+     * target device) at their new sources, drops the NVRAM path so a
+     * fresh one is created, and gives every interface a new MAC if
+     * @p newMACs is set.
+     */
+    static QString rewriteXML(const QString &xml, const QString &name, const QString &uuid,
+                              const QHash<QString, DiskSource> &disks, bool newMACs);
+
+signals:
+    void stateChanged(QVirt::DomainCloner::State state);
+    void diskProgress(int index, qint64 processed, qint64 total);
+    void progress(qint64 processed, qint64 total);
+    void finished(bool success);
+
+private:
+    struct PendingDisk {
+        StorageVolume *source = nullptr;
+        QString sourceType;         // Disk type in the source XML
+        virStoragePoolPtr targetPool = nullptr;
+        QPointer<StorageJob> job;
+    };
+
+    bool prepareDisks(const QString &xml);
+    void clearPending();
+    bool jobsDone() const;
+    void onJobStateChanged(int index);
+    void defineClone();
+    void abort(const QString &error, State state);
+    void finishAbort();
+    void rollback();
+    void setState(State state);
+
+    QPointer<Domain> m_source;
+    const QString m_cloneName;
+    QPointer<StorageJobManager> m_jobs;
+    QPointer<StoragePool> m_targetPool;
+    bool m_cloneStorage;
+    bool m_generateMACs;
+
+    State m_state;
+    State m_abortState;             // Failed or Cancelled while jobs stop, else Idle
+    QString m_error;
+    QString m_sourceXml;
+    QList<Disk> m_disks;
+    QList<PendingDisk> m_pending;
+    Domain *m_clone;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_DOMAINCLONER_H
@@ -82,9 +82,7 @@ bool DomainSnapshot::isCurrent() const
         return false;
     }
 
-    // A snapshot is current if it has no parent
-    virDomainSnapshotPtr parent = virDomainSnapshotGetParent(m_snapshot, 0);
-    return (parent == nullptr);
+    return virDomainSnapshotIsCurrent(m_snapshot, 0) == 1;
 }
 
 bool DomainSnapshot::delete_(unsigned int flags)
@@ -93,7 +91,13 @@ bool DomainSnapshot::delete_(unsigned int flags)
         return false;
     }
 
-    return virDomainSnapshotDelete(m_snapshot, flags) == 0;
+    if (virDomainSnapshotDelete(m_snapshot, flags) < 0) {
+        return false;
+    }
+    if (m_domain) {
+        emit m_domain->snapshotsChanged();
+    }
+    return true;
 }
 
 bool DomainSnapshot::revert(unsigned int flags)
@@ -102,7 +106,13 @@ bool DomainSnapshot::revert(unsigned int flags)
         return false;
     }
 
-    return virDomainRevertToSnapshot(m_snapshot, flags) == 0;
+    if (virDomainRevertToSnapshot(m_snapshot, flags) < 0) {
+        return false;
+    }
+    if (m_domain) {
+        emit m_domain->snapshotsChanged();
+    }
+    return true;
 }
 
 DomainSnapshot *DomainSnapshot::parent() const
@@ -0,0 +1,119 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "EventLoop.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+QMutex s_lock;
+EventLoop *s_loop = nullptr;
+
+// How long quitting waits for the loop to notice the stop request
+constexpr unsigned long ShutdownWaitMs = 2000;
+
+#ifdef LIBVIRT_FOUND
+void wakeupTimeout(int timer, void *opaque)
+{
+    Q_UNUSED(opaque);
+    virEventRemoveTimeout(timer);
+}
+#endif
+
+} // namespace
+
+EventLoop::EventLoop()
+    : QThread(nullptr)
+{
+    setObjectName(QStringLiteral("libvirt-event"));
+}
+
+bool EventLoop::ensureRunning()
+{
+    QMutexLocker locker(&s_lock);
+    if (s_loop) {
+        return true;
+    }
+
+#ifdef LIBVIRT_FOUND
+    if (virEventRegisterDefaultImpl() < 0) {
+        virErrorPtr err = virGetLastError();
+        qWarning() << "Cannot register libvirt event loop:"
+                   << (err ? QString::fromUtf8(err->message) : QString());
+        return false;
+    }
+
+    // Lives until the application quits; libvirt keeps pointers into the
+    // registered implementation for the rest of the process
+    s_loop = new EventLoop();
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        QObject::connect(app, &QCoreApplication::aboutToQuit, app, []() {
+            QMutexLocker quitLocker(&s_lock);
+            if (s_loop) {
+                s_loop->shutdown();
+            }
+        });
+    }
+    s_loop->start();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool EventLoop::isStarted()
+{
+    QMutexLocker locker(&s_lock);
+    return s_loop && s_loop->QThread::isRunning();
+}
+
+void EventLoop::run()
+{
+#ifdef LIBVIRT_FOUND
+    while (!isInterruptionRequested()) {
+        if (virEventRunDefaultImpl() < 0) {
+            virErrorPtr err = virGetLastError();
+            qWarning() << "libvirt event loop iteration failed:"
+                       << (err ? QString::fromUtf8(err->message) : QString());
+        }
+    }
+#endif
+}
+
+void EventLoop::shutdown()
+{
+    requestInterruption();
+#ifdef LIBVIRT_FOUND
+    // An immediate one-shot timeout makes the blocked poll() return
+    virEventAddTimeout(0, wakeupTimeout, nullptr, nullptr);
+#endif
+    if (!wait(ShutdownWaitMs)) {
+        qWarning() << "libvirt event loop did not stop in time";
+    }
+}
+
+} // namespace QVirt
@@ -0,0 +1,58 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_EVENTLOOP_H
+#define QVIRT_LIBVIRT_EVENTLOOP_H
+
+#include <QThread>
+
+namespace QVirt {
+
+/**
+ * @brief Thread driving libvirt's default event loop
+ *
+ * Non-blocking streams (consoles, screenshots) and connection socket
+ * watches only make progress when an event implementation is registered
+ * before the connection is opened and something keeps dispatching it.
+ * This registers libvirt's built-in poll() loop and runs it on a dedicated
+ * thread, so stream callbacks never wait on the GUI thread.
+ *
+ * Callbacks registered with libvirt (virStreamEventAddCallback and
+ * friends) run on this thread.
+ */
+class EventLoop : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Register the event implementation and start the thread
+     *
+     * Idempotent and thread-safe. Must be called before the first
+     * virConnectOpen*() for that connection to get asynchronous I/O.
+     * Returns false if libvirt refused the registration.
+     */
+    static bool ensureRunning();
+
+    // True once ensureRunning() succeeded
+    static bool isStarted();
+
+protected:
+    void run() override;
+
+private:
+    EventLoop();
+    void shutdown();
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_EVENTLOOP_H
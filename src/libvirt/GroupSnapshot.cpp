@@ -0,0 +1,333 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "GroupSnapshot.h"
+#include "Domain.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QXmlStreamWriter>
+#include <limits>
+#include <vector>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+/**
+ * One reference per member domain, taken on the GUI thread, and the
+ * results the worker fills in; the GUI thread reads them once it is done.
+ */
+struct GroupSnapshot::Work
+{
+    ~Work()
+    {
+        for (virDomainSnapshotPtr snapshot : snapshots) {
+            if (snapshot) {
+                virDomainSnapshotFree(snapshot);
+            }
+        }
+        for (virDomainPtr domain : domains) {
+            virDomainFree(domain);
+        }
+    }
+
+    QList<virDomainPtr> domains;
+    QList<virDomainSnapshotPtr> snapshots;
+    QList<GroupSnapshot::Member> members;
+    QByteArray xml;
+    int maxParallel = GroupSnapshot::DefaultMaxParallel;
+    bool requireFreeze = false;
+
+    QString error;
+    qint64 elapsedMs = 0;
+    qint64 freezeWindowMs = -1;
+};
+
+namespace {
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+// Runs @p task for every member index on @p pool and waits for all of them
+template<typename Task>
+void forEachMember(QThreadPool *pool, int count, const Task &task)
+{
+    QList<QFuture<void>> futures;
+    for (int i = 0; i < count; ++i) {
+        futures.append(QtConcurrent::run(pool, [&task, i]() { task(i); }));
+    }
+    for (QFuture<void> &future : futures) {
+        future.waitForFinished();
+    }
+}
+
+// Runs on a worker thread; libvirt errors are per thread, so each
+// member's error is read on the pool thread that made the call
+void runGroup(GroupSnapshot::Work *work)
+{
+    const int count = int(work->domains.size());
+    QThreadPool pool;
+    pool.setMaxThreadCount(work->maxParallel);
+
+    // Plain vectors: each pool thread writes its own element, which
+    // implicitly shared Qt containers do not allow
+    std::vector<GroupSnapshot::Member> members(work->members.begin(), work->members.end());
+    std::vector<virDomainSnapshotPtr> snapshots(count, nullptr);
+    std::vector<qint64> freezeStart(count, -1);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    forEachMember(&pool, count, [work, &members, &clock, &freezeStart](int i) {
+        GroupSnapshot::Member &member = members[i];
+        if (!member.running) {
+            return;
+        }
+        const qint64 start = clock.elapsed();
+        freezeStart[i] = start;
+        if (virDomainFSFreeze(work->domains.at(i), nullptr, 0, 0) < 0) {
+            member.error = QObject::tr("Filesystems not frozen: %1")
+                               .arg(lastErrorMessage(QObject::tr("no guest agent")));
+        } else {
+            member.frozen = true;
+        }
+        member.freezeMs = clock.elapsed() - start;
+    });
+
+    bool proceed = true;
+    if (work->requireFreeze) {
+        for (const GroupSnapshot::Member &member : members) {
+            if (member.running && !member.frozen) {
+                work->error = QObject::tr("Could not freeze the filesystems of %1")
+                                  .arg(member.domainName);
+                proceed = false;
+                break;
+            }
+        }
+    }
+
+    if (proceed) {
+        // Consistency comes from the freeze, not from the snapshot itself
+        const unsigned int flags = VIR_DOMAIN_SNAPSHOT_CREATE_DISK_ONLY
+                                 | VIR_DOMAIN_SNAPSHOT_CREATE_ATOMIC;
+        forEachMember(&pool, count, [work, &members, &snapshots, &clock, flags](int i) {
+            GroupSnapshot::Member &member = members[i];
+            const qint64 start = clock.elapsed();
+            virDomainSnapshotPtr snapshot = virDomainSnapshotCreateXML(
+                work->domains.at(i), work->xml.constData(), flags);
+            member.snapshotMs = clock.elapsed() - start;
+            if (snapshot) {
+                snapshots[i] = snapshot;
+                member.created = true;
+            } else {
+                member.error = lastErrorMessage(QObject::tr("Snapshot failed"));
+            }
+        });
+    }
+
+    // Thaw as soon as the last snapshot is taken, whatever the outcome
+    forEachMember(&pool, count, [work, &members, &clock, &freezeStart](int i) {
+        GroupSnapshot::Member &member = members[i];
+        if (!member.frozen) {
+            return;
+        }
+        const qint64 start = clock.elapsed();
+        if (virDomainFSThaw(work->domains.at(i), nullptr, 0, 0) < 0) {
+            member.error = QObject::tr("Thaw failed, the guest may still be frozen: %1")
+                               .arg(lastErrorMessage(QObject::tr("unknown error")));
+        }
+        const qint64 end = clock.elapsed();
+        member.thawMs = end - start;
+        member.frozenMs = end - freezeStart[i];
+    });
+
+    qint64 firstFreeze = std::numeric_limits<qint64>::max();
+    qint64 lastThaw = -1;
+    for (int i = 0; i < count; ++i) {
+        const GroupSnapshot::Member &member = members[i];
+        if (member.frozenMs >= 0) {
+            firstFreeze = qMin(firstFreeze, freezeStart[i]);
+            lastThaw = qMax(lastThaw, freezeStart[i] + member.frozenMs);
+        }
+    }
+    if (lastThaw >= 0) {
+        work->freezeWindowMs = lastThaw - firstFreeze;
+    }
+
+    // All or nothing: undo the snapshots of the others on a partial failure
+    bool complete = proceed;
+    for (const GroupSnapshot::Member &member : members) {
+        if (!member.created) {
+            complete = false;
+            if (work->error.isEmpty() && proceed) {
+                work->error = QObject::tr("Snapshot of %1 failed: %2")
+                                  .arg(member.domainName, member.error);
+            }
+        }
+    }
+    if (!complete) {
+        forEachMember(&pool, count, [&members, &snapshots](int i) {
+            GroupSnapshot::Member &member = members[i];
+            virDomainSnapshotPtr snapshot = snapshots[i];
+            if (!snapshot) {
+                return;
+            }
+            if (virDomainSnapshotDelete(snapshot, 0) == 0) {
+                member.rolledBack = true;
+            } else {
+                member.error = QObject::tr("Could not be rolled back, delete it by hand: %1")
+                                   .arg(lastErrorMessage(QObject::tr("unknown error")));
+            }
+        });
+    }
+
+    work->elapsedMs = clock.elapsed();
+    for (int i = 0; i < count; ++i) {
+        work->members[i] = members[i];
+        work->snapshots[i] = snapshots[i];
+    }
+}
+
+} // namespace
+
+GroupSnapshot::GroupSnapshot(const QList<Domain*> &domains, QObject *parent)
+    : QObject(parent)
+    , m_name(defaultName(QDateTime::currentDateTime()))
+    , m_maxParallel(DefaultMaxParallel)
+    , m_requireFreeze(false)
+    , m_state(Ready)
+    , m_elapsedMs(0)
+    , m_freezeWindowMs(-1)
+{
+    for (Domain *domain : domains) {
+        m_domains.append(domain);
+
+        Member member;
+        member.domainName = domain ? domain->name() : QString();
+        member.running = domain && domain->state() == Domain::StateRunning;
+        m_members.append(member);
+    }
+}
+
+GroupSnapshot::~GroupSnapshot() = default;
+
+void GroupSnapshot::setMaxParallel(int count)
+{
+    m_maxParallel = qMax(1, count);
+}
+
+void GroupSnapshot::start()
+{
+    if (m_state != Ready) {
+        return;
+    }
+    m_state = Running;
+
+    if (m_domains.isEmpty()) {
+        fail(tr("No VMs selected"));
+        return;
+    }
+    if (m_name.trimmed().isEmpty()) {
+        fail(tr("No snapshot name"));
+        return;
+    }
+
+    auto work = std::make_shared<Work>();
+    for (int i = 0; i < m_domains.size(); ++i) {
+        Domain *domain = m_domains.at(i);
+        if (!domain || !domain->rawDomain()) {
+            fail(tr("%1 is not connected").arg(m_members.at(i).domainName));
+            return;
+        }
+        virDomainRef(domain->rawDomain());
+        work->domains.append(domain->rawDomain());
+        work->snapshots.append(nullptr);
+    }
+    work->members = m_members;
+    work->xml = snapshotXML(m_name, m_description).toUtf8();
+    work->maxParallel = m_maxParallel;
+    work->requireFreeze = m_requireFreeze;
+    m_work = work;
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, work]() {
+        watcher->deleteLater();
+
+        m_members = work->members;
+        m_error = work->error;
+        m_elapsedMs = work->elapsedMs;
+        m_freezeWindowMs = work->freezeWindowMs;
+        m_work.reset();
+
+        bool success = m_error.isEmpty();
+        for (int i = 0; i < m_members.size(); ++i) {
+            if (!m_members.at(i).created) {
+                success = false;
+            }
+            // Kept or rolled back, the snapshot trees are out of date
+            if (m_members.at(i).created && m_domains.at(i)) {
+                emit m_domains.at(i)->snapshotsChanged();
+            }
+        }
+
+        m_state = success ? Finished : Failed;
+        emit finished(success);
+    });
+    watcher->setFuture(QtConcurrent::run([work]() {
+        runGroup(work.get());
+    }));
+}
+
+void GroupSnapshot::fail(const QString &error)
+{
+    m_error = error;
+    m_state = Failed;
+
+    // Reported from the event loop so callers can connect first
+    QTimer::singleShot(0, this, [this]() {
+        emit finished(false);
+    });
+}
+
+QString GroupSnapshot::defaultName(const QDateTime &time)
+{
+    return QStringLiteral("group-") + time.toString(QStringLiteral("yyyyMMdd-HHmmss"));
+}
+
+QString GroupSnapshot::snapshotXML(const QString &name, const QString &description)
+{
+    QString xml;
+    QXmlStreamWriter writer(&xml);
+    writer.writeStartElement("domainsnapshot");
+    writer.writeTextElement("name", name);
+    if (!description.isEmpty()) {
+        writer.writeTextElement("description", description);
+    }
+    writer.writeEndElement();
+    return xml;
+}
+
+} // namespace QVirt
@@ -0,0 +1,125 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_GROUPSNAPSHOT_H
+#define QVIRT_LIBVIRT_GROUPSNAPSHOT_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QDateTime>
+#include <QPointer>
+#include <memory>
+
+namespace QVirt {
+
+class Domain;
+
+/**
+ * @brief Consistent disk snapshot of several domains at one point in time
+ *
+ * Runs in three phases, each on all members at once with at most
+ * maxParallel() domains in flight: freeze the guest filesystems through
+ * the guest agent, take a disk-only snapshot, thaw. Every snapshot is
+ * taken while all running guests are frozen, so the set is consistent
+ * as a whole. The XML and domain handles are prepared before the first
+ * freeze to keep that window short.
+ *
+ * If a snapshot fails, the snapshots already taken for the other
+ * members are deleted again. A running guest whose filesystems cannot
+ * be frozen is snapshotted crash-consistent, unless requireFreeze() is
+ * set; then nothing is snapshotted. Paused and shut off domains do not
+ * write and are not frozen.
+ */
+class GroupSnapshot : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxParallel = 4;
+
+    enum State {
+        Ready,
+        Running,
+        Finished,
+        Failed
+    };
+
+    struct Member {
+        QString domainName;
+        bool running = false;       // Needs a freeze
+        bool frozen = false;
+        bool created = false;
+        bool rolledBack = false;
+        QString error;              // Failure, or why the guest was not frozen
+
+        // -1 where the phase did not run for this member
+        qint64 freezeMs = -1;
+        qint64 snapshotMs = -1;
+        qint64 thawMs = -1;
+        qint64 frozenMs = -1;       // Freeze start to thaw end
+    };
+
+    explicit GroupSnapshot(const QList<Domain*> &domains, QObject *parent = nullptr);
+    ~GroupSnapshot() override;
+
+    QString name() const { return m_name; }
+    void setName(const QString &name) { m_name = name; }
+    QString description() const { return m_description; }
+    void setDescription(const QString &description) { m_description = description; }
+
+    int maxParallel() const { return m_maxParallel; }
+    void setMaxParallel(int count);
+    bool requireFreeze() const { return m_requireFreeze; }
+    void setRequireFreeze(bool require) { m_requireFreeze = require; }
+
+    // Runs in the background; finished() follows, also on early failures
+    void start();
+
+    State state() const { return m_state; }
+    bool isDone() const { return m_state >= Finished; }
+    QList<Member> members() const { return m_members; }
+    QString errorString() const { return m_error; }
+    qint64 elapsedMs() const { return m_elapsedMs; }
+
+    // From the first freeze to the last thaw, -1 if nothing was frozen
+    qint64 freezeWindowMs() const { return m_freezeWindowMs; }
+
+    static QString defaultName(const QDateTime &time);
+    static QString snapshotXML(const QString &name, const QString &description);
+
+    // Parameters and handles shared with the worker; defined in the .cpp
+    struct Work;
+
+signals:
+    void finished(bool success);
+
+private:
+    void fail(const QString &error);
+
+    QList<QPointer<Domain>> m_domains;
+    QString m_name;
+    QString m_description;
+    int m_maxParallel;
+    bool m_requireFreeze;
+
+    State m_state;
+    QList<Member> m_members;
+    QString m_error;
+    qint64 m_elapsedMs;
+    qint64 m_freezeWindowMs;
+
+    std::shared_ptr<Work> m_work;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_GROUPSNAPSHOT_H
@@ -0,0 +1,735 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "MigrationManager.h"
+#include "Domain.h"
+#include "Connection.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QTimer>
+#include <QDebug>
+#include <atomic>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+// Migrations converge within seconds to minutes; keep the numbers live
+constexpr int PollIntervalMs = 1000;
+
+// Used when the hypervisor does not report its page size
+constexpr qint64 DefaultPageSize = 4096;
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+bool isActive(const Domain *domain)
+{
+    const Domain::State state = domain->state();
+    return state == Domain::StateRunning || state == Domain::StatePaused
+        || state == Domain::StateBlocked;
+}
+
+} // namespace
+
+/**
+ * Parameters of one migration and a reference of its own on the domain,
+ * shared with the worker that migrates and the ones that poll it.
+ */
+struct MigrationJob::Work
+{
+    ~Work()
+    {
+        if (domain) {
+            virDomainFree(domain);
+        }
+    }
+
+    virDomainPtr domain = nullptr;
+    MigrationJob::Options options;
+    unsigned int flags = 0;
+
+    // Set by the first poll that finds the migration running
+    std::atomic<bool> downtimeApplied{false};
+};
+
+namespace {
+
+struct MigrateResult {
+    bool ok = false;
+    QString error;
+    bool hasStats = false;
+    MigrationJob::Stats stats;
+};
+
+struct PollResult {
+    int status = -1;                // -1 on error, 0 with no job, 1 running
+    MigrationJob::Stats stats;
+    QString error;
+};
+
+void readStats(virTypedParameterPtr params, int nparams, MigrationJob::Stats *stats)
+{
+    auto read = [params, nparams](const char *field, qint64 *target) {
+        unsigned long long value = 0;
+        if (virTypedParamsGetULLong(params, nparams, field, &value) == 1) {
+            *target = qint64(value);
+        }
+    };
+
+    read(VIR_DOMAIN_JOB_TIME_ELAPSED, &stats->elapsedMs);
+    read(VIR_DOMAIN_JOB_DATA_TOTAL, &stats->dataTotal);
+    read(VIR_DOMAIN_JOB_DATA_PROCESSED, &stats->dataProcessed);
+    read(VIR_DOMAIN_JOB_DATA_REMAINING, &stats->dataRemaining);
+    read(VIR_DOMAIN_JOB_MEMORY_REMAINING, &stats->memoryRemaining);
+    read(VIR_DOMAIN_JOB_MEMORY_BPS, &stats->throughput);
+    read(VIR_DOMAIN_JOB_DOWNTIME, &stats->downtimeMs);
+    read(VIR_DOMAIN_JOB_MEMORY_ITERATION, &stats->passes);
+
+    // Reported in pages per second
+    qint64 dirtyPages = -1;
+    qint64 pageSize = -1;
+    read(VIR_DOMAIN_JOB_MEMORY_DIRTY_RATE, &dirtyPages);
+    read(VIR_DOMAIN_JOB_MEMORY_PAGE_SIZE, &pageSize);
+    if (dirtyPages >= 0) {
+        stats->dirtyRate = dirtyPages * (pageSize > 0 ? pageSize : DefaultPageSize);
+    }
+
+    int throttle = 0;
+    if (virTypedParamsGetInt(params, nparams, VIR_DOMAIN_JOB_AUTO_CONVERGE_THROTTLE,
+                             &throttle) == 1) {
+        stats->throttle = throttle;
+    }
+}
+
+bool addParams(const MigrationJob::Options &options, virTypedParameterPtr *params,
+               int *nparams, int *maxparams)
+{
+    if (options.bandwidth > 0
+        && virTypedParamsAddULLong(params, nparams, maxparams, VIR_MIGRATE_PARAM_BANDWIDTH,
+                                   static_cast<unsigned long long>(options.bandwidth)) < 0) {
+        return false;
+    }
+
+    const char *compression = nullptr;
+    switch (options.compression) {
+    case MigrationJob::Xbzrle:
+        compression = "xbzrle";
+        break;
+    case MigrationJob::Zstd:
+        compression = "zstd";
+        break;
+    case MigrationJob::NoCompression:
+        break;
+    }
+    if (compression
+        && virTypedParamsAddString(params, nparams, maxparams, VIR_MIGRATE_PARAM_COMPRESSION,
+                                   compression) < 0) {
+        return false;
+    }
+
+#ifdef VIR_MIGRATE_PARAM_PARALLEL_CONNECTIONS
+    if (options.parallelConnections > 1
+        && virTypedParamsAddInt(params, nparams, maxparams,
+                                VIR_MIGRATE_PARAM_PARALLEL_CONNECTIONS,
+                                options.parallelConnections) < 0) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+// Blocks until the domain runs on the destination or the migration failed
+MigrateResult runMigration(const std::shared_ptr<MigrationJob::Work> &work)
+{
+    MigrateResult result;
+
+    virTypedParameterPtr params = nullptr;
+    int nparams = 0;
+    int maxparams = 0;
+    if (!addParams(work->options, &params, &nparams, &maxparams)) {
+        result.error = lastErrorMessage(QStringLiteral("Invalid migration parameters"));
+        virTypedParamsFree(params, nparams);
+        return result;
+    }
+
+    const QByteArray uri = work->options.destinationUri.toUtf8();
+    virConnectPtr destination = nullptr;
+    virDomainPtr migrated = nullptr;
+
+    if (work->flags & VIR_MIGRATE_PEER2PEER) {
+        result.ok = virDomainMigrateToURI3(work->domain, uri.constData(), params, nparams,
+                                           work->flags) == 0;
+        if (!result.ok) {
+            result.error = lastErrorMessage(QStringLiteral("Migration failed"));
+        }
+    } else {
+        // Managed migration: this client talks to both hosts, and reaches
+        // the destination with the credentials saved for it
+        QString error;
+        destination = Connection::openAuthenticated(work->options.destinationUri, &error);
+        if (!destination) {
+            result.error = QStringLiteral("Cannot connect to %1: %2")
+                               .arg(work->options.destinationUri, error);
+        } else {
+            migrated = virDomainMigrate3(work->domain, destination, params, nparams,
+                                         work->flags);
+            result.ok = migrated != nullptr;
+            if (!result.ok) {
+                result.error = lastErrorMessage(QStringLiteral("Migration failed"));
+            }
+        }
+    }
+    virTypedParamsFree(params, nparams);
+
+    // The destination measured the real downtime; a transient source is gone
+    if (result.ok) {
+        int type = VIR_DOMAIN_JOB_NONE;
+        virTypedParameterPtr stats = nullptr;
+        int nstats = 0;
+        if (virDomainGetJobStats(migrated ? migrated : work->domain, &type, &stats, &nstats,
+                                 VIR_DOMAIN_JOB_STATS_COMPLETED) == 0) {
+            if (type != VIR_DOMAIN_JOB_NONE) {
+                readStats(stats, nstats, &result.stats);
+                result.hasStats = true;
+            }
+            virTypedParamsFree(stats, nstats);
+        }
+    }
+
+    if (migrated) {
+        virDomainFree(migrated);
+    }
+    if (destination) {
+        virConnectClose(destination);
+    }
+    return result;
+}
+
+PollResult pollMigration(const std::shared_ptr<MigrationJob::Work> &work)
+{
+    PollResult result;
+    int type = VIR_DOMAIN_JOB_NONE;
+    virTypedParameterPtr params = nullptr;
+    int nparams = 0;
+    if (virDomainGetJobStats(work->domain, &type, &params, &nparams, 0) < 0) {
+        result.error = lastErrorMessage(QStringLiteral("Failed to query the migration"));
+        return result;
+    }
+    result.status = type == VIR_DOMAIN_JOB_NONE ? 0 : 1;
+    readStats(params, nparams, &result.stats);
+    virTypedParamsFree(params, nparams);
+
+    // Only accepted while the migration job exists
+    if (result.status > 0 && work->options.maxDowntime > 0
+        && !work->downtimeApplied.exchange(true)
+        && virDomainMigrateSetMaxDowntime(work->domain,
+                                          static_cast<unsigned long long>(work->options.maxDowntime),
+                                          0) < 0) {
+        qWarning() << "Failed to set the maximum downtime:"
+                   << lastErrorMessage(QStringLiteral("unknown error"));
+    }
+    return result;
+}
+
+} // namespace
+
+MigrationJob::MigrationJob(Domain *domain, const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_state(Queued)
+    , m_domain(domain)
+    , m_options(options)
+    , m_runningMs(-1)
+    , m_abortRequested(false)
+    , m_postCopyRequested(false)
+    , m_pollInFlight(false)
+{
+    if (domain) {
+        m_domainName = domain->name();
+        m_domainUuid = domain->uuid();
+    }
+}
+
+MigrationJob::~MigrationJob() = default;
+
+bool MigrationJob::isCancellable() const
+{
+    // Once switched over, the destination holds the only current memory
+    return (m_state == Queued || m_state == Running)
+        && !m_abortRequested && !m_postCopyRequested;
+}
+
+bool MigrationJob::canSwitchToPostCopy() const
+{
+    return m_state == Running && m_options.postCopy && m_options.live
+        && !m_abortRequested && !m_postCopyRequested;
+}
+
+qint64 MigrationJob::elapsedMs() const
+{
+    if (m_runningMs >= 0) {
+        return m_runningMs;
+    }
+    return m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+void MigrationJob::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    if (state == Running) {
+        m_clock.start();
+    } else if (isDone() && m_clock.isValid()) {
+        m_runningMs = m_clock.elapsed();
+    }
+    emit stateChanged(state);
+}
+
+MigrationManager *MigrationManager::s_instance = nullptr;
+
+MigrationManager::MigrationManager(QObject *parent)
+    : QObject(parent)
+    , m_maxConcurrent(DefaultMaxConcurrent)
+    , m_pool(new QThreadPool(this))
+    , m_pollTimer(new QTimer(this))
+{
+    // Each migration blocks a thread for its whole run; keep them off the global pool
+    m_pool->setMaxThreadCount(m_maxConcurrent);
+
+    m_pollTimer->setInterval(PollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &MigrationManager::pollProgress);
+}
+
+MigrationManager::~MigrationManager()
+{
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+MigrationManager *MigrationManager::instance()
+{
+    if (!s_instance) {
+        s_instance = new MigrationManager();
+    }
+    return s_instance;
+}
+
+MigrationJob *MigrationManager::migrate(Domain *domain, const MigrationJob::Options &options)
+{
+    if (!domain || !domain->rawDomain()) {
+        return failed(domain, options, tr("No domain"));
+    }
+    const QString error = validate(options, isActive(domain));
+    if (!error.isEmpty()) {
+        return failed(domain, options, error);
+    }
+
+    auto work = std::make_shared<MigrationJob::Work>();
+    work->domain = domain->rawDomain();
+    virDomainRef(work->domain);
+    work->options = options;
+
+    auto *job = new MigrationJob(domain, options, this);
+    job->m_work = work;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+
+    // Start from the event loop so callers can connect to the job first
+    QTimer::singleShot(0, this, &MigrationManager::schedule);
+    return job;
+}
+
+MigrationJob *MigrationManager::failed(Domain *domain, const MigrationJob::Options &options,
+                                       const QString &error)
+{
+    auto *job = new MigrationJob(domain, options, this);
+    job->m_error = error;
+    job->m_state = MigrationJob::Failed;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+    QTimer::singleShot(0, this, [this, job]() {
+        emit job->stateChanged(MigrationJob::Failed);
+        emit jobFinished(job);
+    });
+    return job;
+}
+
+void MigrationManager::cancel(MigrationJob *job)
+{
+    if (!job || !m_jobs.contains(job) || !job->isCancellable()) {
+        return;
+    }
+
+    if (job->m_state == MigrationJob::Queued) {
+        finish(job, MigrationJob::Cancelled);
+        return;
+    }
+
+    job->m_abortRequested = true;
+    emit job->stateChanged(job->m_state);
+
+    std::shared_ptr<MigrationJob::Work> work = job->m_work;
+    QPointer<MigrationJob> guard(job);
+
+    // The migration call returns once QEMU has stopped
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [watcher, guard]() {
+        const QString error = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone() || error.isEmpty()) {
+            return;
+        }
+        guard->m_abortRequested = false;
+        guard->m_error = error;
+        qWarning() << "Migration of" << guard->m_domainName << "abort failed:" << error;
+        emit guard->stateChanged(guard->m_state);
+    });
+    watcher->setFuture(QtConcurrent::run([work]() {
+        if (virDomainAbortJob(work->domain) < 0) {
+            return lastErrorMessage(QStringLiteral("Failed to abort the migration"));
+        }
+        return QString();
+    }));
+}
+
+void MigrationManager::switchToPostCopy(MigrationJob *job)
+{
+    if (!job || !m_jobs.contains(job) || !job->canSwitchToPostCopy()) {
+        return;
+    }
+
+    job->m_postCopyRequested = true;
+    emit job->stateChanged(job->m_state);
+
+    std::shared_ptr<MigrationJob::Work> work = job->m_work;
+    QPointer<MigrationJob> guard(job);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [watcher, guard]() {
+        const QString error = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        if (error.isEmpty()) {
+            guard->setState(MigrationJob::PostCopy);
+            return;
+        }
+        guard->m_postCopyRequested = false;
+        guard->m_error = error;
+        qWarning() << "Migration of" << guard->m_domainName << "post-copy failed:" << error;
+        emit guard->stateChanged(guard->m_state);
+    });
+    watcher->setFuture(QtConcurrent::run([work]() {
+        if (virDomainMigrateStartPostCopy(work->domain, 0) < 0) {
+            return lastErrorMessage(QStringLiteral("Failed to switch to post-copy"));
+        }
+        return QString();
+    }));
+}
+
+int MigrationManager::activeCount() const
+{
+    int count = 0;
+    for (MigrationJob *job : m_jobs) {
+        if (!job->isDone()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void MigrationManager::clearFinished()
+{
+    for (int i = int(m_jobs.size()) - 1; i >= 0; --i) {
+        MigrationJob *job = m_jobs.at(i);
+        if (job->isDone()) {
+            m_jobs.removeAt(i);
+            emit jobRemoved(job);
+            job->deleteLater();
+        }
+    }
+}
+
+void MigrationManager::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    m_pool->setMaxThreadCount(m_maxConcurrent);
+    schedule();
+}
+
+QString MigrationManager::validate(const MigrationJob::Options &options, bool active)
+{
+    if (options.destinationUri.isEmpty()) {
+        return tr("No destination");
+    }
+    if (!active && !options.persistent) {
+        return tr("A shut off VM can only be migrated as a persistent definition");
+    }
+    if (options.compression == MigrationJob::Zstd && options.parallelConnections < 2) {
+        return tr("zstd compression needs parallel connections");
+    }
+#if !LIBVIR_CHECK_VERSION(5, 2, 0)
+    if (options.parallelConnections > 1) {
+        return tr("Parallel connections need libvirt 5.2 or newer");
+    }
+#endif
+    if (options.postCopyAfterPasses > 0 && !options.postCopy) {
+        return tr("Switching to post-copy needs post-copy allowed");
+    }
+    return QString();
+}
+
+unsigned int MigrationManager::migrationFlags(const MigrationJob::Options &options, bool active)
+{
+    unsigned int flags = 0;
+    if (options.persistent) {
+        flags |= VIR_MIGRATE_PERSIST_DEST;
+    }
+    if (options.undefineSource) {
+        flags |= VIR_MIGRATE_UNDEFINE_SOURCE;
+    }
+    if (options.allowUnsafe) {
+        flags |= VIR_MIGRATE_UNSAFE;
+    }
+    if (options.peerToPeer) {
+        flags |= VIR_MIGRATE_PEER2PEER;
+    }
+
+    // Nothing runs: only the definition moves
+    if (!active) {
+        return flags | VIR_MIGRATE_OFFLINE | VIR_MIGRATE_PERSIST_DEST;
+    }
+
+    if (options.live) {
+        flags |= VIR_MIGRATE_LIVE;
+    }
+    if (options.compression != MigrationJob::NoCompression) {
+        flags |= VIR_MIGRATE_COMPRESSED;
+    }
+#if LIBVIR_CHECK_VERSION(5, 2, 0)
+    if (options.parallelConnections > 1) {
+        flags |= VIR_MIGRATE_PARALLEL;
+    }
+#endif
+    if (options.autoConverge) {
+        flags |= VIR_MIGRATE_AUTO_CONVERGE;
+    }
+    if (options.postCopy && options.live) {
+        flags |= VIR_MIGRATE_POSTCOPY;
+    }
+    return flags;
+}
+
+QString MigrationManager::destinationUri(Transport transport, const QString &host, int port,
+                                         const QString &user)
+{
+    QString scheme;
+    int defaultPort = 0;
+    switch (transport) {
+    case SSH:
+        scheme = QStringLiteral("qemu+ssh");
+        defaultPort = 22;
+        break;
+    case TLS:
+        scheme = QStringLiteral("qemu+tls");
+        defaultPort = 16514;
+        break;
+    case TCP:
+        scheme = QStringLiteral("qemu+tcp");
+        defaultPort = 16509;
+        break;
+    }
+
+    QString authority = host.trimmed();
+    if (authority.contains(':') && !authority.startsWith('[')) {
+        authority = QStringLiteral("[%1]").arg(authority);
+    }
+    if (port > 0 && port != defaultPort) {
+        authority += QStringLiteral(":%1").arg(port);
+    }
+    if (transport == SSH && !user.isEmpty()) {
+        authority = user + QStringLiteral("@") + authority;
+    }
+    return QStringLiteral("%1://%2/system").arg(scheme, authority);
+}
+
+void MigrationManager::schedule()
+{
+    int running = 0;
+    for (MigrationJob *job : m_jobs) {
+        if (job->m_state == MigrationJob::Running || job->m_state == MigrationJob::PostCopy) {
+            running++;
+        }
+    }
+
+    // In the order they were queued
+    for (MigrationJob *job : m_jobs) {
+        if (running >= m_maxConcurrent) {
+            break;
+        }
+        if (job->m_state == MigrationJob::Queued && !domainBusy(job)) {
+            if (!start(job)) {
+                // finish() has scheduled the rest already
+                return;
+            }
+            running++;
+        }
+    }
+}
+
+bool MigrationManager::start(MigrationJob *job)
+{
+    std::shared_ptr<MigrationJob::Work> work = job->m_work;
+
+    // The domain may have been started or shut off while queued
+    const bool active = job->m_domain ? isActive(job->m_domain) : true;
+    const QString error = validate(job->m_options, active);
+    if (!error.isEmpty()) {
+        finish(job, MigrationJob::Failed, error);
+        return false;
+    }
+    work->flags = migrationFlags(job->m_options, active);
+
+    job->setState(MigrationJob::Running);
+    if (!m_pollTimer->isActive()) {
+        m_pollTimer->start();
+    }
+
+    QPointer<MigrationJob> guard(job);
+    auto *watcher = new QFutureWatcher<MigrateResult>(this);
+    connect(watcher, &QFutureWatcher<MigrateResult>::finished, this, [this, watcher, guard]() {
+        const MigrateResult result = watcher->result();
+        watcher->deleteLater();
+        if (!guard || guard->isDone()) {
+            return;
+        }
+        MigrationJob *job = guard;
+        if (result.hasStats) {
+            job->m_stats = result.stats;
+            emit job->statsChanged();
+        }
+        if (result.ok) {
+            finish(job, MigrationJob::Finished);
+        } else if (job->m_abortRequested) {
+            finish(job, MigrationJob::Cancelled);
+        } else {
+            finish(job, MigrationJob::Failed, result.error);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(m_pool, [work]() {
+        return runMigration(work);
+    }));
+    return true;
+}
+
+void MigrationManager::pollProgress()
+{
+    for (MigrationJob *job : m_jobs) {
+        if ((job->m_state != MigrationJob::Running && job->m_state != MigrationJob::PostCopy)
+            || job->m_pollInFlight || !job->m_work) {
+            continue;
+        }
+
+        job->m_pollInFlight = true;
+        std::shared_ptr<MigrationJob::Work> work = job->m_work;
+        QPointer<MigrationJob> guard(job);
+
+        auto *watcher = new QFutureWatcher<PollResult>(this);
+        connect(watcher, &QFutureWatcher<PollResult>::finished, this, [this, watcher, guard]() {
+            const PollResult result = watcher->result();
+            watcher->deleteLater();
+            if (!guard || guard->isDone()) {
+                return;
+            }
+            MigrationJob *job = guard;
+            job->m_pollInFlight = false;
+
+            // Not begun yet or just over; the migration call reports the outcome
+            if (result.status <= 0) {
+                return;
+            }
+            job->m_stats = result.stats;
+            emit job->statsChanged();
+
+            const int after = job->m_options.postCopyAfterPasses;
+            if (after > 0 && job->m_stats.passes > after && job->canSwitchToPostCopy()) {
+                switchToPostCopy(job);
+            }
+        });
+        watcher->setFuture(QtConcurrent::run([work]() {
+            return pollMigration(work);
+        }));
+    }
+}
+
+void MigrationManager::finish(MigrationJob *job, MigrationJob::State state, const QString &error)
+{
+    if (job->isDone()) {
+        return;
+    }
+
+    job->m_work.reset();
+    if (!error.isEmpty()) {
+        job->m_error = error;
+    }
+    if (state == MigrationJob::Failed) {
+        qWarning() << "Migration of" << job->m_domainName << "failed:" << job->m_error;
+    }
+    job->setState(state);
+    emit jobFinished(job);
+
+    bool busy = false;
+    for (MigrationJob *other : m_jobs) {
+        if (other->m_state == MigrationJob::Running || other->m_state == MigrationJob::PostCopy) {
+            busy = true;
+            break;
+        }
+    }
+    if (!busy) {
+        m_pollTimer->stop();
+    }
+    schedule();
+}
+
+bool MigrationManager::domainBusy(const MigrationJob *job) const
+{
+    for (MigrationJob *other : m_jobs) {
+        if (other != job && other->m_domainUuid == job->m_domainUuid
+            && (other->m_state == MigrationJob::Running
+                || other->m_state == MigrationJob::PostCopy)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace QVirt
@@ -0,0 +1,201 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_MIGRATIONMANAGER_H
+#define QVIRT_LIBVIRT_MIGRATIONMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <memory>
+
+class QTimer;
+class QThreadPool;
+
+namespace QVirt {
+
+class Domain;
+
+/**
+ * @brief One migration of a domain to another host
+ */
+class MigrationJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Queued,
+        Running,
+        PostCopy,       // Running on the destination, memory still arriving
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    enum Compression {
+        NoCompression,
+        Xbzrle,         // Delta of pages sent before; helps guests that rewrite memory
+        Zstd            // Needs parallel connections
+    };
+
+    struct Options {
+        QString destinationUri;     // libvirt URI of the destination host
+        bool live = true;           // Otherwise paused while moving, or only defined if shut off
+        bool peerToPeer = false;    // The source libvirtd connects to the destination
+        bool persistent = true;
+        bool undefineSource = false;
+        bool allowUnsafe = false;
+        Compression compression = NoCompression;
+        int parallelConnections = 1;
+        bool autoConverge = false;
+        bool postCopy = false;
+        int postCopyAfterPasses = 0;    // Switch automatically after this many passes; 0 = by hand
+        int bandwidth = 0;              // MiB/s, 0 = unlimited
+        int maxDowntime = 0;            // ms, 0 = hypervisor default
+    };
+
+    // From virDomainGetJobStats(); -1 where the hypervisor did not report it
+    struct Stats {
+        qint64 elapsedMs = -1;
+        qint64 dataTotal = -1;
+        qint64 dataProcessed = -1;
+        qint64 dataRemaining = -1;
+        qint64 memoryRemaining = -1;
+        qint64 dirtyRate = -1;          // Bytes/s the guest writes
+        qint64 throughput = -1;         // Bytes/s sent
+        qint64 downtimeMs = -1;         // Expected while running, actual once done
+        qint64 passes = -1;             // Passes over guest memory
+        int throttle = -1;              // Auto-converge CPU throttle in percent
+    };
+
+    ~MigrationJob() override;
+
+    State state() const { return m_state; }
+    bool isDone() const { return m_state >= Finished; }
+    bool isCancellable() const;
+    bool canSwitchToPostCopy() const;
+
+    Domain *domain() const { return m_domain; }
+    QString domainName() const { return m_domainName; }
+    Options options() const { return m_options; }
+    Stats stats() const { return m_stats; }
+    QString errorString() const { return m_error; }
+    qint64 elapsedMs() const;
+
+    // Parameters and handles shared with the workers; defined in the .cpp
+    struct Work;
+
+signals:
+    void stateChanged(QVirt::MigrationJob::State state);
+    void statsChanged();
+
+private:
+    MigrationJob(Domain *domain, const Options &options, QObject *parent);
+    void setState(State state);
+
+    State m_state;
+    QPointer<Domain> m_domain;
+    QString m_domainName;
+    QString m_domainUuid;
+    Options m_options;
+    Stats m_stats;
+    QString m_error;
+
+    qint64 m_runningMs;             // Time spent running, once done
+    bool m_abortRequested;
+    bool m_postCopyRequested;
+    bool m_pollInFlight;
+    QElapsedTimer m_clock;
+
+    std::shared_ptr<Work> m_work;
+
+    friend class MigrationManager;
+};
+
+/**
+ * @brief Runs migrations to other hosts and reports their progress
+ *
+ * Each migration is one blocking virDomainMigrate3() call, or
+ * virDomainMigrateToURI3() when peer to peer, on a pool of its own,
+ * so at most maxConcurrent() run at a time and the rest wait in order.
+ * While they run, virDomainGetJobStats() is polled on the global pool
+ * for the remaining memory, the dirty rate, the throughput and the
+ * expected downtime.
+ *
+ * A migration that does not converge can be aborted, or, when started
+ * with post-copy allowed, switched over to the destination; then the
+ * remaining memory follows on demand and it can no longer be aborted.
+ */
+class MigrationManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxConcurrent = 2;
+
+    enum Transport {
+        SSH,
+        TLS,
+        TCP
+    };
+
+    explicit MigrationManager(QObject *parent = nullptr);
+    ~MigrationManager() override;
+
+    static MigrationManager *instance();
+
+    MigrationJob *migrate(Domain *domain, const MigrationJob::Options &options);
+    void cancel(MigrationJob *job);
+    void switchToPostCopy(MigrationJob *job);
+
+    QList<MigrationJob*> jobs() const { return m_jobs; }
+    int activeCount() const;
+    void clearFinished();
+
+    int maxConcurrent() const { return m_maxConcurrent; }
+    void setMaxConcurrent(int count);
+
+    // Empty if @p options can be used for a domain that is @p active
+    static QString validate(const MigrationJob::Options &options, bool active);
+    static unsigned int migrationFlags(const MigrationJob::Options &options, bool active);
+    static QString destinationUri(Transport transport, const QString &host, int port = 0,
+                                  const QString &user = QString());
+
+signals:
+    void jobAdded(QVirt::MigrationJob *job);
+    void jobRemoved(QVirt::MigrationJob *job);
+    void jobFinished(QVirt::MigrationJob *job);
+
+private slots:
+    void schedule();
+    void pollProgress();
+
+private:
+    MigrationJob *failed(Domain *domain, const MigrationJob::Options &options,
+                         const QString &error);
+    bool start(MigrationJob *job);
+    void finish(MigrationJob *job, MigrationJob::State state, const QString &error = QString());
+    bool domainBusy(const MigrationJob *job) const;
+
+    QList<MigrationJob*> m_jobs;
+    int m_maxConcurrent;
+    QThreadPool *m_pool;
+    QTimer *m_pollTimer;
+
+    static MigrationManager *s_instance;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_MIGRATIONMANAGER_H
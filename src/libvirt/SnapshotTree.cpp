@@ -0,0 +1,335 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "SnapshotTree.h"
+#include "Domain.h"
+#include "EventLoop.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QXmlStreamReader>
+#include <algorithm>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+struct LoadResult {
+    QList<SnapshotTree::Node> nodes;
+    QList<int> roots;
+    QString error;
+};
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+// Runs on a worker thread; takes over the reference on @p domain
+LoadResult fetchSnapshots(virDomainPtr domain)
+{
+    LoadResult result;
+
+    virDomainSnapshotPtr *snapshots = nullptr;
+    int count = virDomainListAllSnapshots(domain, &snapshots, 0);
+    if (count < 0) {
+        result.error = lastErrorMessage(QStringLiteral("Cannot list snapshots"));
+        virDomainFree(domain);
+        return result;
+    }
+
+    result.nodes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        char *xml = virDomainSnapshotGetXMLDesc(snapshots[i], 0);
+        if (xml) {
+            SnapshotTree::Node node = SnapshotTree::parseNode(QString::fromUtf8(xml));
+            free(xml);
+            if (!node.name.isEmpty()) {
+                result.nodes.append(node);
+            }
+        }
+        virDomainSnapshotFree(snapshots[i]);
+    }
+    free(snapshots);
+
+    // One call for the current snapshot instead of one per snapshot
+    QString current;
+    if (virDomainHasCurrentSnapshot(domain, 0) == 1) {
+        virDomainSnapshotPtr snapshot = virDomainSnapshotCurrent(domain, 0);
+        if (snapshot) {
+            current = QString::fromUtf8(virDomainSnapshotGetName(snapshot));
+            virDomainSnapshotFree(snapshot);
+        }
+    }
+    virDomainFree(domain);
+
+    result.roots = SnapshotTree::link(result.nodes, current);
+    return result;
+}
+
+virDomainState stateFromName(const QString &name)
+{
+    if (name == QLatin1String("running")) {
+        return VIR_DOMAIN_RUNNING;
+    } else if (name == QLatin1String("paused")) {
+        return VIR_DOMAIN_PAUSED;
+    } else if (name == QLatin1String("crashed")) {
+        return VIR_DOMAIN_CRASHED;
+    } else if (name == QLatin1String("pmsuspended")) {
+        return VIR_DOMAIN_PMSUSPENDED;
+    } else if (name == QLatin1String("shutoff") || name == QLatin1String("disk-snapshot")) {
+        return VIR_DOMAIN_SHUTOFF;
+    }
+    return VIR_DOMAIN_NOSTATE;
+}
+
+// Runs on libvirt's event thread
+int lifecycleEventCallback(virConnectPtr conn, virDomainPtr dom, int event, int detail,
+                           void *opaque)
+{
+    Q_UNUSED(conn);
+    Q_UNUSED(dom);
+
+    const bool fromSnapshot =
+        (event == VIR_DOMAIN_EVENT_DEFINED && detail == VIR_DOMAIN_EVENT_DEFINED_FROM_SNAPSHOT)
+        || (event == VIR_DOMAIN_EVENT_STARTED && detail == VIR_DOMAIN_EVENT_STARTED_FROM_SNAPSHOT)
+        || (event == VIR_DOMAIN_EVENT_STOPPED && detail == VIR_DOMAIN_EVENT_STOPPED_FROM_SNAPSHOT)
+        || (event == VIR_DOMAIN_EVENT_SUSPENDED
+            && detail == VIR_DOMAIN_EVENT_SUSPENDED_FROM_SNAPSHOT)
+        || (event == VIR_DOMAIN_EVENT_RESUMED && detail == VIR_DOMAIN_EVENT_RESUMED_FROM_SNAPSHOT);
+    if (fromSnapshot) {
+        QMetaObject::invokeMethod(static_cast<SnapshotTree*>(opaque), "invalidate",
+                                  Qt::QueuedConnection);
+    }
+    return 0;
+}
+
+} // namespace
+
+SnapshotTree::SnapshotTree(Domain *domain, QObject *parent)
+    : QObject(parent)
+    , m_domain(domain)
+    , m_loaded(false)
+    , m_stale(false)
+    , m_loading(false)
+    , m_reloadPending(false)
+    , m_connection(nullptr)
+    , m_callbackId(-1)
+{
+    if (m_domain) {
+        connect(m_domain, &Domain::snapshotsChanged, this, &SnapshotTree::invalidate);
+    }
+    registerEvents();
+}
+
+SnapshotTree::~SnapshotTree()
+{
+    if (m_connection) {
+        if (m_callbackId >= 0) {
+            virConnectDomainEventDeregisterAny(m_connection, m_callbackId);
+        }
+        virConnectClose(m_connection);
+    }
+}
+
+void SnapshotTree::registerEvents()
+{
+    // Events only arrive while something dispatches libvirt's event loop
+    if (!m_domain || !m_domain->rawDomain() || !EventLoop::isStarted()) {
+        return;
+    }
+    virConnectPtr conn = virDomainGetConnect(m_domain->rawDomain());
+    if (!conn) {
+        return;
+    }
+
+    m_callbackId = virConnectDomainEventRegisterAny(
+        conn, m_domain->rawDomain(), VIR_DOMAIN_EVENT_ID_LIFECYCLE,
+        VIR_DOMAIN_EVENT_CALLBACK(lifecycleEventCallback), this, nullptr);
+    if (m_callbackId < 0) {
+        return;                     // Then the tree only reloads when asked to
+    }
+
+    // Keep the connection open as long as the callback is registered
+    virConnectRef(conn);
+    m_connection = conn;
+}
+
+int SnapshotTree::currentIndex() const
+{
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes.at(i).current) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SnapshotTree::load()
+{
+    if (m_loading || (m_loaded && !m_stale)) {
+        return;
+    }
+    refresh();
+}
+
+void SnapshotTree::invalidate()
+{
+    m_stale = true;
+    if (m_loaded || m_loading) {
+        refresh();
+    }
+}
+
+void SnapshotTree::refresh()
+{
+    if (m_loading) {
+        m_reloadPending = true;
+        return;
+    }
+
+    if (!m_domain || !m_domain->rawDomain()) {
+        m_error = tr("The VM is not connected");
+        m_loaded = true;
+        m_stale = false;
+        emit loadFailed(m_error);
+        return;
+    }
+
+    m_loading = true;
+    m_stale = false;
+
+    // The worker gets a reference of its own in case the domain goes away
+    virDomainPtr domain = m_domain->rawDomain();
+    virDomainRef(domain);
+
+    auto *watcher = new QFutureWatcher<LoadResult>(this);
+    connect(watcher, &QFutureWatcher<LoadResult>::finished, this, [this, watcher]() {
+        LoadResult result = watcher->result();
+        watcher->deleteLater();
+        m_loading = false;
+
+        if (!result.error.isEmpty()) {
+            m_error = result.error;
+            emit loadFailed(m_error);
+        } else {
+            m_error.clear();
+            m_nodes = result.nodes;
+            m_roots = result.roots;
+            m_index.clear();
+            for (int i = 0; i < m_nodes.size(); ++i) {
+                m_index.insert(m_nodes.at(i).name, i);
+            }
+            m_loaded = true;
+            emit changed();
+        }
+
+        if (m_reloadPending) {
+            m_reloadPending = false;
+            refresh();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([domain]() {
+        return fetchSnapshots(domain);
+    }));
+}
+
+SnapshotTree::Node SnapshotTree::parseNode(const QString &xml)
+{
+    Node node;
+    node.xml = xml;
+
+    QXmlStreamReader reader(xml);
+    if (!reader.readNextStartElement()
+        || reader.name() != QLatin1String("domainsnapshot")) {
+        return Node();
+    }
+
+    // Only the top level; the embedded <domain> is skipped unparsed
+    bool hasMemory = false;
+    while (reader.readNextStartElement()) {
+        const auto name = reader.name();
+        if (name == QLatin1String("name")) {
+            node.name = reader.readElementText().trimmed();
+        } else if (name == QLatin1String("description")) {
+            node.description = reader.readElementText();
+        } else if (name == QLatin1String("state")) {
+            const QString state = reader.readElementText().trimmed();
+            node.state = stateFromName(state);
+            node.diskOnly = state == QLatin1String("disk-snapshot");
+        } else if (name == QLatin1String("creationTime")) {
+            node.creationTime = QDateTime::fromSecsSinceEpoch(
+                reader.readElementText().trimmed().toLongLong());
+        } else if (name == QLatin1String("parent")) {
+            node.parentName = reader.readElementText(QXmlStreamReader::IncludeChildElements)
+                                  .trimmed();
+        } else if (name == QLatin1String("memory")) {
+            const QString snapshot = reader.attributes().value("snapshot").toString();
+            node.memory = !snapshot.isEmpty() && snapshot != QLatin1String("no");
+            hasMemory = true;
+            reader.skipCurrentElement();
+        } else {
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError()) {
+        return Node();
+    }
+
+    // Without a <memory> element, running and paused snapshots include it
+    if (!hasMemory) {
+        node.memory = node.state == VIR_DOMAIN_RUNNING || node.state == VIR_DOMAIN_PAUSED;
+    }
+    return node;
+}
+
+QList<int> SnapshotTree::link(QList<Node> &nodes, const QString &current)
+{
+    std::stable_sort(nodes.begin(), nodes.end(), [](const Node &a, const Node &b) {
+        return a.creationTime < b.creationTime;
+    });
+
+    QHash<QString, int> index;
+    index.reserve(nodes.size());
+    for (int i = 0; i < nodes.size(); ++i) {
+        nodes[i].parent = -1;
+        nodes[i].children.clear();
+        nodes[i].current = !current.isEmpty() && nodes.at(i).name == current;
+        index.insert(nodes.at(i).name, i);
+    }
+
+    QList<int> roots;
+    for (int i = 0; i < nodes.size(); ++i) {
+        const int parent = nodes.at(i).parentName.isEmpty()
+            ? -1 : index.value(nodes.at(i).parentName, -1);
+        if (parent < 0 || parent == i) {
+            roots.append(i);
+            continue;
+        }
+        nodes[i].parent = parent;
+        nodes[parent].children.append(i);
+    }
+    return roots;
+}
+
+} // namespace QVirt
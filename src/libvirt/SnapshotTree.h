@@ -0,0 +1,113 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_SNAPSHOTTREE_H
+#define QVIRT_LIBVIRT_SNAPSHOTTREE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QDateTime>
+
+#include "DomainSnapshot.h"
+
+namespace QVirt {
+
+class Domain;
+
+/**
+ * @brief Cached parent/child tree of a domain's snapshots
+ *
+ * All snapshots are listed with one virDomainListAllSnapshots() call and
+ * their XML is fetched and parsed on a worker thread, so the GUI never
+ * waits on per-snapshot lookups. The result stays cached on the domain
+ * until a snapshot is created, deleted or reverted to through Domain or
+ * DomainSnapshot, or a lifecycle event reports a change caused by a
+ * snapshot; then it is reloaded in the background and changed() is
+ * emitted again.
+ */
+class SnapshotTree : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Node {
+        QString name;
+        QString description;
+        QString parentName;
+        virDomainState state = VIR_DOMAIN_NOSTATE;
+        bool diskOnly = false;      // Disk snapshot without VM state
+        bool memory = false;        // Includes the guest memory
+        QDateTime creationTime;
+        bool current = false;
+        QString xml;
+
+        int parent = -1;            // Index in nodes(), -1 for roots
+        QList<int> children;        // Oldest first
+    };
+
+    explicit SnapshotTree(Domain *domain, QObject *parent = nullptr);
+    ~SnapshotTree() override;
+
+    Domain *domain() const { return m_domain; }
+
+    bool isLoaded() const { return m_loaded; }
+    bool isLoading() const { return m_loading; }
+    QString errorString() const { return m_error; }
+
+    QList<Node> nodes() const { return m_nodes; }
+    QList<int> roots() const { return m_roots; }
+    int count() const { return int(m_nodes.size()); }
+    int indexOf(const QString &name) const { return m_index.value(name, -1); }
+    int currentIndex() const;
+
+    // Load unless the cache is up to date; changed() follows once done
+    void load();
+
+    static Node parseNode(const QString &xml);
+
+    // Orders @p nodes by creation time, links parents and children and
+    // returns the roots; a node whose parent is missing becomes a root
+    static QList<int> link(QList<Node> &nodes, const QString &current = QString());
+
+public slots:
+    // Reload now, even if the cache is up to date
+    void refresh();
+
+    // Mark the cache stale and reload it if it was loaded before
+    void invalidate();
+
+signals:
+    void changed();
+    void loadFailed(const QString &error);
+
+private:
+    void registerEvents();
+
+    Domain *m_domain;
+    QList<Node> m_nodes;
+    QList<int> m_roots;
+    QHash<QString, int> m_index;
+    QString m_error;
+
+    bool m_loaded;
+    bool m_stale;
+    bool m_loading;
+    bool m_reloadPending;
+
+    virConnectPtr m_connection;     // Holds the lifecycle event callback
+    int m_callbackId;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_SNAPSHOTTREE_H
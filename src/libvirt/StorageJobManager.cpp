@@ -0,0 +1,596 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "StorageJobManager.h"
+#include "StoragePool.h"
+#include "StorageVolume.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QDebug>
+#include <atomic>
+#include <cstdlib>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+#endif
+
+namespace QVirt {
+
+namespace {
+
+constexpr int DefaultPollIntervalMs = 1000;
+
+// Long jobs get their own threads; the per-pool limit bounds them further
+constexpr int MaxJobThreads = 16;
+
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+
+// Allocation of @p vol in bytes, or -1
+qint64 volumeAllocation(virStorageVolPtr vol)
+{
+    virStorageVolInfo info;
+    if (!vol || virStorageVolGetInfo(vol, &info) < 0) {
+        return -1;
+    }
+    return qint64(info.allocation);
+}
+
+// Pools of the same name on different hosts have budgets of their own
+QString poolKey(virStoragePoolPtr pool, const QString &poolName)
+{
+    QString uri;
+    virConnectPtr conn = pool ? virStoragePoolGetConnect(pool) : nullptr;
+    if (char *connUri = conn ? virConnectGetURI(conn) : nullptr) {
+        uri = QString::fromUtf8(connUri);
+        free(connUri);
+    }
+    return uri + QLatin1Char('/') + poolName;
+}
+
+} // namespace
+
+/**
+ * Parameters and libvirt handles of one job, shared with the worker and
+ * the progress polls. The handles are references of their own.
+ */
+struct StorageJob::Work
+{
+    ~Work()
+    {
+        if (volume) {
+            virStorageVolFree(volume);
+        }
+        if (pool) {
+            virStoragePoolFree(pool);
+        }
+    }
+
+    virStoragePoolPtr pool = nullptr;
+    virStorageVolPtr volume = nullptr;      // Clone source, or the volume wiped or resized
+    QByteArray xml;                         // Create and clone
+    QString targetName;                     // Volume whose allocation is polled
+    unsigned int flags = 0;
+    unsigned int algorithm = 0;
+    qint64 capacity = 0;
+    bool tryReflink = false;
+
+    std::atomic<bool> cancelRequested{false};
+
+    // Written by the worker, read once it has returned
+    bool reflinked = false;
+    bool cancelled = false;
+    QString error;
+};
+
+namespace {
+
+bool execute(const std::shared_ptr<StorageJob::Work> &work, StorageJob::Type type)
+{
+    virStorageVolPtr created = nullptr;
+
+    switch (type) {
+    case StorageJob::Create:
+        created = virStorageVolCreateXML(work->pool, work->xml.constData(), work->flags);
+        break;
+    case StorageJob::Clone:
+        if (work->tryReflink) {
+            created = virStorageVolCreateXMLFrom(work->pool, work->xml.constData(), work->volume,
+                                                 work->flags | VIR_STORAGE_VOL_CREATE_REFLINK);
+            work->reflinked = created != nullptr;
+        }
+        if (!created) {
+            // Not a file pool, or the file system cannot share extents
+            created = virStorageVolCreateXMLFrom(work->pool, work->xml.constData(), work->volume,
+                                                 work->flags);
+        }
+        break;
+    case StorageJob::Wipe:
+        if (virStorageVolWipePattern(work->volume, work->algorithm, 0) < 0) {
+            work->error = lastErrorMessage(QStringLiteral("Failed to wipe volume"));
+            return false;
+        }
+        return true;
+    case StorageJob::Resize:
+        if (virStorageVolResize(work->volume, quint64(work->capacity), work->flags) < 0) {
+            work->error = lastErrorMessage(QStringLiteral("Failed to resize volume"));
+            return false;
+        }
+        return true;
+    }
+
+    if (!created) {
+        work->error = lastErrorMessage(QStringLiteral("Failed to create volume"));
+        return false;
+    }
+
+    // Cancelled while libvirt was building it: undo the result
+    if (work->cancelRequested.load()) {
+        virStorageVolDelete(created, 0);
+        work->cancelled = true;
+    }
+    virStorageVolFree(created);
+    return !work->cancelled;
+}
+
+qint64 pollAllocation(const std::shared_ptr<StorageJob::Work> &work, StorageJob::Type type)
+{
+    if (type == StorageJob::Create || type == StorageJob::Clone) {
+        // The target is listed in its pool while libvirt builds it
+        QByteArray name = work->targetName.toUtf8();
+        virStorageVolPtr vol = virStorageVolLookupByName(work->pool, name.constData());
+        qint64 allocation = volumeAllocation(vol);
+        if (vol) {
+            virStorageVolFree(vol);
+        }
+        return allocation;
+    }
+    return volumeAllocation(work->volume);
+}
+
+} // namespace
+
+StorageJob::StorageJob(Type type, const std::shared_ptr<Work> &work, QObject *parent)
+    : QObject(parent)
+    , m_type(type)
+    , m_state(Queued)
+    , m_processed(0)
+    , m_total(0)
+    , m_baseBytes(0)
+    , m_reflinked(false)
+    , m_pollInFlight(false)
+    , m_work(work)
+{
+}
+
+StorageJob::~StorageJob() = default;
+
+QString StorageJob::description() const
+{
+    switch (m_type) {
+    case Create:
+        return tr("Create %1").arg(m_volumeName);
+    case Clone:
+        return tr("Clone to %1").arg(m_volumeName);
+    case Wipe:
+        return tr("Wipe %1").arg(m_volumeName);
+    case Resize:
+        return tr("Resize %1").arg(m_volumeName);
+    }
+    return m_volumeName;
+}
+
+qint64 StorageJob::elapsedMs() const
+{
+    return m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+bool StorageJob::isCancellable() const
+{
+    if (m_state == Queued) {
+        return true;
+    }
+    return m_state == Running && (m_type == Create || m_type == Clone)
+        && !isCancelRequested();
+}
+
+bool StorageJob::isCancelRequested() const
+{
+    return m_work && m_work->cancelRequested.load();
+}
+
+void StorageJob::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    if (state == Running) {
+        m_clock.start();
+    }
+    emit stateChanged(state);
+}
+
+void StorageJob::setProgress(qint64 processed)
+{
+    processed = qBound<qint64>(0, processed, m_total);
+    if (processed != m_processed) {
+        m_processed = processed;
+        emit progress(m_processed, m_total);
+    }
+}
+
+StorageJobManager *StorageJobManager::s_instance = nullptr;
+
+StorageJobManager::StorageJobManager(QObject *parent)
+    : QObject(parent)
+    , m_maxConcurrentPerPool(DefaultMaxConcurrentPerPool)
+    , m_pollTimer(new QTimer(this))
+{
+    m_threadPool.setMaxThreadCount(MaxJobThreads);
+
+    m_pollTimer->setInterval(DefaultPollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, this, &StorageJobManager::pollProgress);
+}
+
+StorageJobManager::~StorageJobManager()
+{
+    // Running libvirt calls cannot be interrupted; let them complete
+    // rather than leave half built volumes behind
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+StorageJobManager *StorageJobManager::instance()
+{
+    if (!s_instance) {
+        s_instance = new StorageJobManager();
+    }
+    return s_instance;
+}
+
+StorageJob *StorageJobManager::createVolume(StoragePool *pool, const QString &name,
+                                            qint64 capacity, qint64 allocation,
+                                            const QString &format)
+{
+    if (!pool || !pool->virPool()) {
+        return failed(StorageJob::Create, name, tr("No storage pool"));
+    }
+
+    QString xml = QString("<volume>\n"
+                          "  <name>%1</name>\n"
+                          "  <capacity unit='bytes'>%2</capacity>\n"
+                          "  <allocation unit='bytes'>%3</allocation>\n"
+                          "  <target>\n"
+                          "    <format type='%4'/>\n"
+                          "  </target>\n"
+                          "</volume>")
+                      .arg(name.toHtmlEscaped())
+                      .arg(capacity)
+                      .arg(allocation)
+                      .arg(format.toHtmlEscaped());
+
+    auto work = std::make_shared<StorageJob::Work>();
+    work->pool = pool->virPool();
+    virStoragePoolRef(work->pool);
+    work->xml = xml.toUtf8();
+    work->targetName = name;
+
+    StorageJob *job = enqueue(StorageJob::Create, work, pool, name);
+    job->m_total = qMax<qint64>(0, allocation);
+    return job;
+}
+
+StorageJob *StorageJobManager::cloneVolume(StorageVolume *source, const QString &name,
+                                           StoragePool *targetPool)
+{
+    if (!source || !source->virVolume()) {
+        return failed(StorageJob::Clone, name, tr("No source volume"));
+    }
+
+    auto work = std::make_shared<StorageJob::Work>();
+    work->volume = source->virVolume();
+    virStorageVolRef(work->volume);
+
+    const bool samePool = !targetPool || targetPool == source->pool();
+    StoragePool *pool = targetPool ? targetPool : source->pool();
+    if (pool && pool->virPool()) {
+        work->pool = pool->virPool();
+        virStoragePoolRef(work->pool);
+    } else {
+        work->pool = virStoragePoolLookupByVolume(work->volume);
+        if (!work->pool) {
+            return failed(StorageJob::Clone, name,
+                          lastErrorMessage(tr("Cannot find the pool of the source volume")));
+        }
+    }
+
+    // Same size and format. Nothing is allocated up front, so the clone
+    // stays sparse and its allocation grows with the bytes copied
+    QString format = source->format();
+    QString xml = QString("<volume>\n"
+                          "  <name>%1</name>\n"
+                          "  <capacity unit='bytes'>%2</capacity>\n"
+                          "  <allocation unit='bytes'>0</allocation>\n")
+                      .arg(name.toHtmlEscaped())
+                      .arg(source->capacity());
+    if (!format.isEmpty()) {
+        xml += QString("  <target>\n"
+                       "    <format type='%1'/>\n"
+                       "  </target>\n").arg(format.toHtmlEscaped());
+    }
+    xml += "</volume>";
+    work->xml = xml.toUtf8();
+    work->targetName = name;
+
+    // Sharing extents only works between files of the same pool
+    StoragePool::PoolType poolType = pool ? pool->type() : StoragePool::TypeDir;
+    work->tryReflink = samePool
+        && (poolType == StoragePool::TypeDir || poolType == StoragePool::TypeFS
+            || poolType == StoragePool::TypeNetFS);
+
+    // Only the data of the source is copied; ask for it now rather than
+    // trust the last listing of its pool
+    qint64 toCopy = volumeAllocation(work->volume);
+    StorageJob *job = enqueue(StorageJob::Clone, work, pool, name);
+    job->m_total = qMax<qint64>(0, toCopy >= 0 ? toCopy : source->allocation());
+    return job;
+}
+
+StorageJob *StorageJobManager::wipeVolume(StorageVolume *volume, unsigned int algorithm)
+{
+    if (!volume || !volume->virVolume()) {
+        return failed(StorageJob::Wipe, volume ? volume->name() : QString(), tr("No volume"));
+    }
+
+    auto work = std::make_shared<StorageJob::Work>();
+    work->volume = volume->virVolume();
+    virStorageVolRef(work->volume);
+    work->algorithm = algorithm;
+
+    // Wiping rewrites what is allocated; there is nothing to measure
+    return enqueue(StorageJob::Wipe, work, volume->pool(), volume->name());
+}
+
+StorageJob *StorageJobManager::resizeVolume(StorageVolume *volume, qint64 capacity,
+                                            unsigned int flags)
+{
+    if (!volume || !volume->virVolume()) {
+        return failed(StorageJob::Resize, volume ? volume->name() : QString(), tr("No volume"));
+    }
+
+    auto work = std::make_shared<StorageJob::Work>();
+    work->volume = volume->virVolume();
+    virStorageVolRef(work->volume);
+    work->capacity = capacity;
+    work->flags = flags;
+
+    StorageJob *job = enqueue(StorageJob::Resize, work, volume->pool(), volume->name());
+
+    // Only a resize that allocates the new space writes anything
+    if (flags & VIR_STORAGE_VOL_RESIZE_ALLOCATE) {
+        job->m_baseBytes = volume->allocation();
+        job->m_total = qMax<qint64>(0, capacity - volume->allocation());
+    }
+    return job;
+}
+
+StorageJob *StorageJobManager::enqueue(StorageJob::Type type,
+                                       const std::shared_ptr<StorageJob::Work> &work,
+                                       StoragePool *pool, const QString &volumeName)
+{
+    auto *job = new StorageJob(type, work, this);
+    job->m_pool = pool;
+    if (pool) {
+        job->m_poolName = pool->name();
+    } else if (work->pool) {
+        const char *poolName = virStoragePoolGetName(work->pool);
+        job->m_poolName = poolName ? QString::fromUtf8(poolName) : QString();
+    }
+    job->m_poolKey = poolKey(work->pool, job->m_poolName);
+    job->m_volumeName = volumeName;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+
+    // Start from the event loop so callers can connect to the job first
+    QTimer::singleShot(0, this, &StorageJobManager::schedule);
+    return job;
+}
+
+StorageJob *StorageJobManager::failed(StorageJob::Type type, const QString &volumeName,
+                                      const QString &error)
+{
+    auto *job = new StorageJob(type, nullptr, this);
+    job->m_volumeName = volumeName;
+    job->m_error = error;
+    job->m_state = StorageJob::Failed;
+
+    m_jobs.append(job);
+    emit jobAdded(job);
+    QTimer::singleShot(0, this, [this, job]() {
+        emit job->stateChanged(StorageJob::Failed);
+        emit jobFinished(job);
+    });
+    return job;
+}
+
+void StorageJobManager::cancel(StorageJob *job)
+{
+    if (!job || !m_jobs.contains(job) || !job->isCancellable()) {
+        return;
+    }
+
+    if (job->m_state == StorageJob::Queued) {
+        job->m_work.reset();
+        job->setState(StorageJob::Cancelled);
+        emit jobFinished(job);
+        return;
+    }
+
+    // The worker deletes the volume once libvirt has built it
+    job->m_work->cancelRequested.store(true);
+    emit job->stateChanged(job->m_state);
+}
+
+int StorageJobManager::activeCount() const
+{
+    int count = 0;
+    for (StorageJob *job : m_jobs) {
+        if (!job->isDone()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void StorageJobManager::clearFinished()
+{
+    for (int i = int(m_jobs.size()) - 1; i >= 0; --i) {
+        StorageJob *job = m_jobs.at(i);
+        if (job->isDone()) {
+            m_jobs.removeAt(i);
+            emit jobRemoved(job);
+            job->deleteLater();
+        }
+    }
+}
+
+void StorageJobManager::setMaxConcurrentPerPool(int count)
+{
+    m_maxConcurrentPerPool = qMax(1, count);
+    schedule();
+}
+
+int StorageJobManager::pollInterval() const
+{
+    return m_pollTimer->interval();
+}
+
+void StorageJobManager::setPollInterval(int milliseconds)
+{
+    m_pollTimer->setInterval(qMax(50, milliseconds));
+}
+
+void StorageJobManager::schedule()
+{
+    // Oldest first, within each pool's budget
+    for (StorageJob *job : m_jobs) {
+        if (job->m_state == StorageJob::Queued
+            && m_runningPerPool.value(job->m_poolKey) < m_maxConcurrentPerPool) {
+            start(job);
+        }
+    }
+}
+
+void StorageJobManager::start(StorageJob *job)
+{
+    m_runningPerPool[job->m_poolKey]++;
+    job->setState(StorageJob::Running);
+    if (!m_pollTimer->isActive()) {
+        m_pollTimer->start();
+    }
+
+    std::shared_ptr<StorageJob::Work> work = job->m_work;
+    const StorageJob::Type type = job->m_type;
+
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, job]() {
+        bool success = watcher->result();
+        watcher->deleteLater();
+        finish(job, success);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_threadPool, [work, type]() {
+        return execute(work, type);
+    }));
+}
+
+void StorageJobManager::finish(StorageJob *job, bool success)
+{
+    if (--m_runningPerPool[job->m_poolKey] <= 0) {
+        m_runningPerPool.remove(job->m_poolKey);
+    }
+
+    const std::shared_ptr<StorageJob::Work> work = job->m_work;
+    job->m_reflinked = work->reflinked;
+    if (success) {
+        job->setProgress(job->m_total);
+        job->setState(StorageJob::Finished);
+    } else if (work->cancelled) {
+        job->setState(StorageJob::Cancelled);
+    } else {
+        job->m_error = work->error;
+        qWarning() << "Storage job" << job->description() << "failed:" << job->m_error;
+        job->setState(StorageJob::Failed);
+    }
+    job->m_work.reset();
+
+    // One listing picks up the new or changed volume
+    if (job->m_pool) {
+        job->m_pool->refreshVolumes();
+    }
+
+    emit jobFinished(job);
+
+    if (m_runningPerPool.isEmpty()) {
+        m_pollTimer->stop();
+    }
+    schedule();
+}
+
+void StorageJobManager::pollProgress()
+{
+    for (StorageJob *job : m_jobs) {
+        if (job->m_state != StorageJob::Running || job->m_total <= 0 || job->m_pollInFlight
+            || !job->m_work) {
+            continue;
+        }
+
+        job->m_pollInFlight = true;
+        std::shared_ptr<StorageJob::Work> work = job->m_work;
+        const StorageJob::Type type = job->m_type;
+        QPointer<StorageJob> guard(job);
+
+        // Short calls; the shared pool is fine for them
+        auto *watcher = new QFutureWatcher<qint64>(this);
+        connect(watcher, &QFutureWatcher<qint64>::finished, this, [watcher, guard]() {
+            qint64 allocation = watcher->result();
+            watcher->deleteLater();
+            if (!guard) {
+                return;
+            }
+            guard->m_pollInFlight = false;
+            if (allocation >= 0 && guard->m_state == StorageJob::Running) {
+                guard->setProgress(allocation - guard->m_baseBytes);
+            }
+        });
+        watcher->setFuture(QtConcurrent::run([work, type]() {
+            return pollAllocation(work, type);
+        }));
+    }
+}
+
+} // namespace QVirt
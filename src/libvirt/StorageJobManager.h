@@ -0,0 +1,199 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_STORAGEJOBMANAGER_H
+#define QVIRT_LIBVIRT_STORAGEJOBMANAGER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <memory>
+
+class QTimer;
+
+namespace QVirt {
+
+class StoragePool;
+class StorageVolume;
+
+/**
+ * @brief One long-running storage volume operation
+ *
+ * Created and run by StorageJobManager. Progress is measured by polling
+ * the allocation of the volume being written, so totalBytes() is 0 for
+ * operations that do not change it (wipe).
+ */
+class StorageJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Type {
+        Create,
+        Clone,
+        Wipe,
+        Resize
+    };
+
+    enum State {
+        Queued,
+        Running,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    ~StorageJob() override;
+
+    Type type() const { return m_type; }
+    State state() const { return m_state; }
+    bool isDone() const { return m_state >= Finished; }
+
+    QString poolName() const { return m_poolName; }
+    QString volumeName() const { return m_volumeName; }
+    QString description() const;
+    QString errorString() const { return m_error; }
+
+    // Bytes written so far out of totalBytes(), 0 if it cannot be measured
+    qint64 processedBytes() const { return m_processed; }
+    qint64 totalBytes() const { return m_total; }
+
+    // Milliseconds spent running so far
+    qint64 elapsedMs() const;
+
+    /**
+     * @brief Whether cancel() can still stop the job
+     *
+     * Queued jobs are dropped before they start. libvirt cannot abort a
+     * volume build, so a running create or clone finishes and its volume
+     * is deleted again; a running wipe or resize cannot be cancelled.
+     */
+    bool isCancellable() const;
+    bool isCancelRequested() const;
+
+    // Clones only: whether the copy shares extents with its source
+    bool usedReflink() const { return m_reflinked; }
+
+    // Parameters and handles shared with the workers; defined in the .cpp
+    struct Work;
+
+signals:
+    void stateChanged(QVirt::StorageJob::State state);
+    void progress(qint64 processed, qint64 total);
+
+private:
+    StorageJob(Type type, const std::shared_ptr<Work> &work, QObject *parent);
+    void setState(State state);
+    void setProgress(qint64 processed);
+
+    const Type m_type;
+    State m_state;
+    QString m_poolName;
+    QString m_poolKey;              // Connection URI and pool name
+    QString m_volumeName;
+    QString m_error;
+    QPointer<StoragePool> m_pool;
+
+    qint64 m_processed;
+    qint64 m_total;
+    qint64 m_baseBytes;             // Allocation before the job started
+    bool m_reflinked;
+    bool m_pollInFlight;
+    QElapsedTimer m_clock;
+
+    std::shared_ptr<Work> m_work;
+
+    friend class StorageJobManager;
+};
+
+/**
+ * @brief Runs volume create, clone, wipe and resize off the GUI thread
+ *
+ * Jobs are queued per pool and up to maxConcurrentPerPool() of them run
+ * at once on a dedicated thread pool, so a long copy neither freezes the
+ * UI nor starves the shared pool used for short requests. The jobs hold
+ * their own libvirt references and do not depend on the wrappers passed
+ * in staying alive; the pool's volume list is refreshed once a job ends.
+ *
+ * Clones within a file based pool first try VIR_STORAGE_VOL_CREATE_REFLINK
+ * and fall back to a full copy when the file system cannot share extents;
+ * clones into another pool are always copied.
+ */
+class StorageJobManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultMaxConcurrentPerPool = 2;
+
+    explicit StorageJobManager(QObject *parent = nullptr);
+    ~StorageJobManager() override;
+
+    static StorageJobManager *instance();
+
+    StorageJob *createVolume(StoragePool *pool, const QString &name, qint64 capacity,
+                             qint64 allocation, const QString &format);
+    // Clone into @p targetPool, or next to the source if null
+    StorageJob *cloneVolume(StorageVolume *source, const QString &name,
+                            StoragePool *targetPool = nullptr);
+    StorageJob *wipeVolume(StorageVolume *volume, unsigned int algorithm = 0);
+    StorageJob *resizeVolume(StorageVolume *volume, qint64 capacity, unsigned int flags = 0);
+
+    void cancel(StorageJob *job);
+
+    QList<StorageJob*> jobs() const { return m_jobs; }
+
+    // Queued and running jobs
+    int activeCount() const;
+
+    // Drop jobs that are done
+    void clearFinished();
+
+    int maxConcurrentPerPool() const { return m_maxConcurrentPerPool; }
+    void setMaxConcurrentPerPool(int count);
+
+    // Delay between allocation polls of running jobs
+    int pollInterval() const;
+    void setPollInterval(int milliseconds);
+
+signals:
+    void jobAdded(QVirt::StorageJob *job);
+    void jobRemoved(QVirt::StorageJob *job);
+    void jobFinished(QVirt::StorageJob *job);
+
+private slots:
+    void schedule();
+    void pollProgress();
+
+private:
+    StorageJob *enqueue(StorageJob::Type type, const std::shared_ptr<StorageJob::Work> &work,
+                        StoragePool *pool, const QString &volumeName);
+    StorageJob *failed(StorageJob::Type type, const QString &volumeName, const QString &error);
+    void start(StorageJob *job);
+    void finish(StorageJob *job, bool success);
+
+    QList<StorageJob*> m_jobs;
+    QHash<QString, int> m_runningPerPool;      // By StorageJob::m_poolKey
+    int m_maxConcurrentPerPool;
+
+    QThreadPool m_threadPool;
+    QTimer *m_pollTimer;
+
+    static StorageJobManager *s_instance;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_STORAGEJOBMANAGER_H
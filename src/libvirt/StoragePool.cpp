@@ -125,6 +125,7 @@ bool StoragePool::stop()
     }
 
     m_active = false;
+    clearVolumes();
     emit stateChanged();
     return true;
 }
@@ -149,6 +150,9 @@ void StoragePool::updateInfo()
     if (isActive >= 0) {
         m_active = (isActive == 1);
         m_state = m_active ? StateRunning : StateInactive;
+        if (!m_active) {
+            clearVolumes();
+        }
     }
 
     // Refresh capacity/allocation info
@@ -214,38 +218,99 @@ QString StoragePool::getXMLDesc(unsigned int flags)
 
 QList<StorageVolume*> StoragePool::volumes()
 {
-    QList<StorageVolume*> volumeList;
+    if (!m_volumesListed) {
+        refreshVolumes();
+    }
+    return m_volumes;
+}
 
-    if (!m_pool || !m_active) {
-        return volumeList;
+StorageVolume *StoragePool::volume(const QString &key) const
+{
+    return m_volumesByKey.value(key);
+}
+
+StorageVolume *StoragePool::volumeByName(const QString &name) const
+{
+    for (StorageVolume *volume : m_volumes) {
+        if (volume->name() == name) {
+            return volume;
+        }
     }
+    return nullptr;
+}
 
-    // List all volumes in the pool
-    int numVolumes = virStoragePoolNumOfVolumes(m_pool);
-    if (numVolumes <= 0) {
-        return volumeList;
+bool StoragePool::refreshVolumes()
+{
+    if (!m_pool || !m_active) {
+        clearVolumes();
+        return false;
     }
 
-    // Get volume names
-    char **names = new char*[numVolumes];
-    int actualVolumes = virStoragePoolListVolumes(m_pool, names, numVolumes);
-    if (actualVolumes < 0) {
-        delete[] names;
-        return volumeList;
+    // One call for every handle; name and key come with it
+    virStorageVolPtr *vols = nullptr;
+    int count = virStoragePoolListAllVolumes(m_pool, &vols, 0);
+    if (count < 0) {
+        return false;
     }
 
-    for (int i = 0; i < actualVolumes; ++i) {
-        virStorageVolPtr vol = virStorageVolLookupByName(m_pool, names[i]);
-        if (vol) {
-            auto *volume = new StorageVolume(vol, this, this);
-            volumeList.append(volume);
+    QList<StorageVolume*> listed;
+    QList<StorageVolume*> added;
+    QHash<QString, StorageVolume*> byKey;
+    listed.reserve(count);
+    byKey.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        const char *keyChars = virStorageVolGetKey(vols[i]);
+        const QString key = keyChars ? QString::fromUtf8(keyChars) : QString();
+
+        StorageVolume *volume = key.isEmpty() ? nullptr : m_volumesByKey.take(key);
+        if (volume) {
+            // Known volume: refresh its sizes and keep the old handle
+            volume->updateInfo();
+            virStorageVolFree(vols[i]);
+        } else {
+            volume = new StorageVolume(vols[i], this, this);
+            added.append(volume);
         }
-        free(names[i]);
+        listed.append(volume);
+        byKey.insert(volume->key(), volume);
     }
+    free(vols);
 
-    delete[] names;
+    // What is left in the old index is gone from the pool
+    const QList<StorageVolume*> removed = m_volumesByKey.values();
 
-    return volumeList;
+    m_volumes = listed;
+    m_volumesByKey = byKey;
+    m_volumesListed = true;
+
+    for (StorageVolume *volume : removed) {
+        emit volumeRemoved(volume);
+        volume->deleteLater();
+    }
+    for (StorageVolume *volume : added) {
+        emit volumeAdded(volume);
+    }
+    emit volumesChanged();
+    return true;
+}
+
+void StoragePool::clearVolumes()
+{
+    if (!m_volumesListed) {
+        return;
+    }
+
+    const QList<StorageVolume*> removed = m_volumes;
+    m_volumes.clear();
+    m_volumesByKey.clear();
+    m_volumesListed = false;
+
+    for (StorageVolume *volume : removed) {
+        emit volumeRemoved(volume);
+        volume->deleteLater();
+    }
+    emit volumesChanged();
 }
 
 void StoragePool::parseXML(const QString &xml)
@@ -291,6 +356,8 @@ void StoragePool::parseXML(const QString &xml)
     } else if (typeStr == "vstorage") {
         m_type = TypeVStorage;
     }
+
+    m_targetPath = root.firstChildElement("target").firstChildElement("path").text();
 }
 
 } // namespace QVirt
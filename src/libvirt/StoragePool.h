@@ -15,6 +15,7 @@
 #include "../core/BaseObject.h"
 #include <QString>
 #include <QList>
+#include <QHash>
 
 #ifdef LIBVIRT_FOUND
 #include <libvirt/libvirt.h>
@@ -71,6 +72,9 @@ public:
     PoolState state() const { return m_state; }
     PoolType type() const { return m_type; }
 
+    // Directory or device the pool's volumes live in
+    QString targetPath() const { return m_targetPath; }
+
     quint64 capacity() const { return m_capacity; }
     quint64 allocation() const { return m_allocation; }
     quint64 available() const { return m_available; }
@@ -78,9 +82,26 @@ public:
     // Access to virStoragePoolPtr for volume operations
     virStoragePoolPtr virPool() const { return m_pool; }
 
-    // Volume operations
+    /**
+     * @brief Volumes of the pool, listed on first use
+     *
+     * The wrappers are owned by the pool and stay valid until the volume
+     * disappears from a refreshVolumes() or the pool stops.
+     */
     QList<StorageVolume*> volumes();
 
+    // Look up a cached volume without a round trip
+    StorageVolume *volume(const QString &key) const;
+    StorageVolume *volumeByName(const QString &name) const;
+
+    /**
+     * @brief Re-list the volumes with virStoragePoolListAllVolumes()
+     *
+     * Known volumes are updated in place; new ones are added and missing
+     * ones removed, with volumeAdded()/volumeRemoved() for each.
+     */
+    bool refreshVolumes();
+
     bool start();
     bool stop();
     bool refresh();
@@ -92,6 +113,9 @@ public:
 
 signals:
     void stateChanged();
+    void volumeAdded(StorageVolume *volume);
+    void volumeRemoved(StorageVolume *volume);
+    void volumesChanged();
 
 private:
     StoragePool(Connection *conn, virStoragePoolPtr pool);
@@ -104,6 +128,7 @@ private:
     bool m_active;
     PoolState m_state;
     PoolType m_type;
+    QString m_targetPath;
 
     quint64 m_capacity;
     quint64 m_allocation;
@@ -113,7 +138,13 @@ private:
     mutable QString m_cachedXmlDesc;
     mutable bool m_xmlFetched = false;
 
+    // Volume wrappers in listing order, and by key
+    QList<StorageVolume*> m_volumes;
+    QHash<QString, StorageVolume*> m_volumesByKey;
+    bool m_volumesListed = false;
+
     void parseXML(const QString &xml);
+    void clearVolumes();
 
     friend class Connection;
 };
@@ -12,6 +12,7 @@
 #include "StorageVolume.h"
 #include "StoragePool.h"
 #include "Connection.h"
+#include "VolumeTransfer.h"
 #include "../core/Error.h"
 
 #include <QDomDocument>
@@ -37,6 +38,7 @@ StorageVolume::StorageVolume(virStorageVol *vol, StoragePool *pool, QObject *par
     : QObject(parent)
     , m_volume(vol)
     , m_pool(pool)
+    , m_type(TypeFile)
     , m_capacity(0)
     , m_allocation(0)
 {
@@ -44,7 +46,7 @@ StorageVolume::StorageVolume(virStorageVol *vol, StoragePool *pool, QObject *par
         return;
     }
 
-    // Get basic info
+    // Name and key are kept in the handle; no round trip
     const char *nameChars = virStorageVolGetName(m_volume);
     if (nameChars) {
         m_name = QString::fromUtf8(nameChars);
@@ -55,23 +57,8 @@ StorageVolume::StorageVolume(virStorageVol *vol, StoragePool *pool, QObject *par
         m_key = QString::fromUtf8(keyChars);
     }
 
-    char *pathChars = virStorageVolGetPath(m_volume);
-    if (pathChars) {
-        m_path = QString::fromUtf8(pathChars);
-        free(pathChars);
-    }
-
-    // Get and parse XML description
-    char *xml = virStorageVolGetXMLDesc(m_volume, 0);
-    if (xml) {
-        QString xmlStr = QString::fromUtf8(xml);
-        parseXML(xmlStr);
-        free(xml);
-
-        // Cache the XML for future getXMLDesc() calls
-        m_cachedXmlDesc = xmlStr;
-        m_xmlFetched = true;
-    }
+    // Path and format come with the first call that needs them
+    updateInfo();
 }
 
 StorageVolume::~StorageVolume()
@@ -93,6 +80,24 @@ QString StorageVolume::key() const
 
 QString StorageVolume::path() const
 {
+    if (m_pathFetched || !m_volume) {
+        return m_path;
+    }
+    m_pathFetched = true;
+
+    // File based pools key their volumes by path
+    if (m_pool && m_key.startsWith('/')
+        && (m_pool->type() == StoragePool::TypeDir || m_pool->type() == StoragePool::TypeFS
+            || m_pool->type() == StoragePool::TypeNetFS)) {
+        m_path = m_key;
+        return m_path;
+    }
+
+    char *pathChars = virStorageVolGetPath(m_volume);
+    if (pathChars) {
+        m_path = QString::fromUtf8(pathChars);
+        free(pathChars);
+    }
     return m_path;
 }
 
@@ -113,6 +118,9 @@ qint64 StorageVolume::allocation() const
 
 QString StorageVolume::format() const
 {
+    if (!m_xmlFetched && m_volume) {
+        fetchXML(0);
+    }
     return m_format;
 }
 
@@ -141,145 +149,24 @@ bool StorageVolume::wipe(unsigned int flags)
 
 bool StorageVolume::download(const QString &path, unsigned int flags)
 {
-    if (!m_volume || !m_pool) {
+    VolumeTransfer transfer(this, VolumeTransfer::Download, path);
+    transfer.setSparse(flags & VIR_STORAGE_VOL_DOWNLOAD_SPARSE_STREAM);
+    if (!transfer.run()) {
+        qWarning() << "Download of volume" << m_name << "failed:" << transfer.errorString();
         return false;
     }
-
-#ifdef LIBVIRT_FOUND
-    // Get the connection from the pool
-    virConnectPtr conn = virStoragePoolGetConnect(m_pool->virPool());
-    if (!conn) {
-        return false;
-    }
-
-    // Create a stream
-    virStreamPtr stream = virStreamNew(conn, 0);
-    if (!stream) {
-        return false;
-    }
-
-    // Open the destination file
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly)) {
-        virStreamFree(stream);
-        return false;
-    }
-
-    // Download implementation with virStorageVolDownload requires stream management
-    // Start the download from the volume
-    if (virStorageVolDownload(m_volume, stream, 0, 0, flags) < 0) {
-        file.close();
-        virStreamFree(stream);
-        return false;
-    }
-
-    // Receive data in chunks
-    char buffer[64 * 1024]; // 64KB buffer
-    bool success = true;
-
-    while (success) {
-        int bytesRead = virStreamRecv(stream, buffer, sizeof(buffer));
-        if (bytesRead < 0) {
-            success = false;
-            break;
-        }
-        if (bytesRead == 0) {
-            // End of stream
-            break;
-        }
-
-        // Write to file
-        qint64 written = file.write(buffer, bytesRead);
-        if (written != bytesRead) {
-            success = false;
-            break;
-        }
-    }
-
-    // Finish the stream
-    if (virStreamFinish(stream) < 0) {
-        success = false;
-    }
-
-    file.close();
-    virStreamFree(stream);
-
-    return success;
-#else
-    Q_UNUSED(flags);
-    return false;
-#endif
+    return true;
 }
 
 bool StorageVolume::upload(const QString &path, unsigned int flags)
 {
-    if (!m_volume || !m_pool) {
-        return false;
-    }
-
-#ifdef LIBVIRT_FOUND
-    // Get the connection from the pool
-    virConnectPtr conn = virStoragePoolGetConnect(m_pool->virPool());
-    if (!conn) {
-        return false;
-    }
-
-    // Open the source file
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return false;
-    }
-
-    // Create a stream
-    virStreamPtr stream = virStreamNew(conn, 0);
-    if (!stream) {
-        file.close();
-        return false;
-    }
-
-    // Start the download from the volume
-    if (virStorageVolDownload(m_volume, stream, 0, 0, flags) < 0) {
-        file.close();
-        virStreamFree(stream);
+    VolumeTransfer transfer(this, VolumeTransfer::Upload, path);
+    transfer.setSparse(flags & VIR_STORAGE_VOL_UPLOAD_SPARSE_STREAM);
+    if (!transfer.run()) {
+        qWarning() << "Upload to volume" << m_name << "failed:" << transfer.errorString();
         return false;
     }
-
-    // Receive data in chunks
-    char buffer[64 * 1024]; // 64KB buffer
-    bool success = true;
-
-    while (success) {
-        int bytesRead = virStreamRecv(stream, buffer, sizeof(buffer));
-        if (bytesRead < 0) {
-            success = false;
-            break;
-        }
-        if (bytesRead == 0) {
-            // End of stream
-            break;
-        }
-
-        // Write to file
-        qint64 written = file.write(buffer, bytesRead);
-        if (written != bytesRead) {
-            success = false;
-            break;
-        }
-    }
-
-    // Finish the stream
-    if (virStreamFinish(stream) < 0) {
-        success = false;
-    }
-
-    file.close();
-    virStreamFree(stream);
-
-    return success;
-#else
-    Q_UNUSED(flags);
-    return false;
-#endif
+    return true;
 }
 
 StorageVolume *StorageVolume::clone(const QString &name, unsigned int flags)
@@ -321,7 +208,11 @@ QString StorageVolume::getXMLDesc(unsigned int flags)
     if (m_xmlFetched && !m_cachedXmlDesc.isEmpty()) {
         return m_cachedXmlDesc;
     }
+    return fetchXML(flags);
+}
 
+QString StorageVolume::fetchXML(unsigned int flags) const
+{
     char *xml = virStorageVolGetXMLDesc(m_volume, flags);
     if (!xml) {
         return QString();
@@ -329,6 +220,7 @@ QString StorageVolume::getXMLDesc(unsigned int flags)
 
     QString xmlStr = QString::fromUtf8(xml);
     free(xml);
+    parseXML(xmlStr);
 
     // Cache the XML for future calls
     m_cachedXmlDesc = xmlStr;
@@ -342,20 +234,25 @@ void StorageVolume::updateInfo()
         return;
     }
 
-    // Refresh volume info by re-parsing XML
-    char *xml = virStorageVolGetXMLDesc(m_volume, 0);
-    if (xml) {
-        QString xmlStr = QString::fromUtf8(xml);
-        parseXML(xmlStr);
-        free(xml);
-
-        // Update cached XML
-        m_cachedXmlDesc = xmlStr;
-        m_xmlFetched = true;
+    virStorageVolInfo info;
+    if (virStorageVolGetInfo(m_volume, &info) == 0) {
+        applyInfo(info.type, qint64(info.capacity), qint64(info.allocation));
     }
+
+    // The description may be stale now; fetch it again when asked
+    m_xmlFetched = false;
+    m_cachedXmlDesc.clear();
 }
 
-void StorageVolume::parseXML(const QString &xml)
+void StorageVolume::applyInfo(int type, qint64 capacity, qint64 allocation)
+{
+    // VolumeType follows virStorageVolType up to TypeNetDir
+    m_type = type >= TypeFile && type <= TypeNetDir ? static_cast<VolumeType>(type) : TypeFile;
+    m_capacity = capacity;
+    m_allocation = allocation;
+}
+
+void StorageVolume::parseXML(const QString &xml) const
 {
     QDomDocument doc;
     if (!doc.setContent(xml)) {
@@ -369,61 +266,20 @@ void StorageVolume::parseXML(const QString &xml)
         return;
     }
 
-    // Parse type from target
-    QDomNode targetNode = root.firstChildElement("target");
+    // Sizes and type come from virStorageVolGetInfo(); the XML adds the
+    // format, and the path for free
+    QDomElement targetNode = root.firstChildElement("target");
     if (!targetNode.isNull()) {
-        QDomNode formatNode = targetNode.firstChildElement("format");
+        QDomElement formatNode = targetNode.firstChildElement("format");
         if (!formatNode.isNull()) {
-            m_format = formatNode.toElement().attribute("type");
-        }
-    }
-
-    // Parse capacity
-    QDomNode capacityNode = root.firstChildElement("capacity");
-    if (!capacityNode.isNull()) {
-        QString unit = capacityNode.toElement().attribute("unit", "bytes");
-        m_capacity = capacityNode.toElement().text().toLongLong();
-
-        // Convert to bytes if needed
-        if (unit == "KiB") {
-            m_capacity *= 1024;
-        } else if (unit == "MiB") {
-            m_capacity *= 1024 * 1024;
-        } else if (unit == "GiB") {
-            m_capacity *= 1024 * 1024 * 1024;
-        } else if (unit == "TiB") {
-            m_capacity *= 1024LL * 1024 * 1024 * 1024;
+            m_format = formatNode.attribute("type");
         }
-    }
-
-    // Parse allocation
-    QDomNode allocationNode = root.firstChildElement("allocation");
-    if (!allocationNode.isNull()) {
-        QString unit = allocationNode.toElement().attribute("unit", "bytes");
-        m_allocation = allocationNode.toElement().text().toLongLong();
-
-        // Convert to bytes if needed
-        if (unit == "KiB") {
-            m_allocation *= 1024;
-        } else if (unit == "MiB") {
-            m_allocation *= 1024 * 1024;
-        } else if (unit == "GiB") {
-            m_allocation *= 1024 * 1024 * 1024;
-        } else if (unit == "TiB") {
-            m_allocation *= 1024LL * 1024 * 1024 * 1024;
+        QDomElement pathNode = targetNode.firstChildElement("path");
+        if (!pathNode.isNull() && !m_pathFetched) {
+            m_path = pathNode.text();
+            m_pathFetched = true;
         }
     }
-
-    // Determine type from path/format
-    if (m_path.contains("/dev/")) {
-        m_type = TypeBlock;
-    } else if (m_format == "dir") {
-        m_type = TypeDir;
-    } else if (m_format == "network") {
-        m_type = TypeNetwork;
-    } else {
-        m_type = TypeFile;
-    }
 }
 
 } // namespace QVirt
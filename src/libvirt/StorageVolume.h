@@ -42,7 +42,10 @@ class StoragePool;
 /**
  * @brief Storage Volume Wrapper
  *
- * Represents a storage volume in libvirt
+ * Represents a storage volume in libvirt. Construction costs a single
+ * virStorageVolGetInfo() round trip; the path and the XML description
+ * (and with it the format) are fetched on first use and cached.
+ * Wrappers are owned and reused by their StoragePool.
  */
 class StorageVolume : public QObject
 {
@@ -74,6 +77,9 @@ public:
     // Operations
     bool delete_(unsigned int flags = 0);
     bool wipe(unsigned int flags = 0);
+    // Blocking; see VolumeTransfer for background transfers. @p flags as
+    // for virStorageVolDownload()/virStorageVolUpload(): the stream is only
+    // sparse with VIR_STORAGE_VOL_DOWNLOAD/UPLOAD_SPARSE_STREAM
     bool download(const QString &path, unsigned int flags = 0);
     bool upload(const QString &path, unsigned int flags = 0);
     StorageVolume *clone(const QString &name, unsigned int flags = 0);
@@ -81,26 +87,34 @@ public:
     // XML operations
     QString getXMLDesc(unsigned int flags = 0);
 
-    // Refresh volume info
+    // Refresh type and sizes; the XML is fetched again on next use
     void updateInfo();
 
+    virStorageVol *virVolume() const { return m_volume; }
+    StoragePool *pool() const { return m_pool; }
+
 private:
     virStorageVol *m_volume;
     StoragePool *m_pool;
 
     QString m_name;
     QString m_key;
-    QString m_path;
+    mutable QString m_path;
+    mutable bool m_pathFetched = false;
     VolumeType m_type;
     qint64 m_capacity;
     qint64 m_allocation;
-    QString m_format;
+    mutable QString m_format;
 
     // Cached XML to avoid repeated remote calls
     mutable QString m_cachedXmlDesc;
     mutable bool m_xmlFetched = false;
 
-    void parseXML(const QString &xml);
+    QString fetchXML(unsigned int flags) const;
+    void parseXML(const QString &xml) const;
+    void applyInfo(int type, qint64 capacity, qint64 allocation);
+
+    friend class StoragePool;
 };
 
 } // namespace QVirt
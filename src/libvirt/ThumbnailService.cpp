@@ -0,0 +1,442 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ThumbnailService.h"
+#include "Connection.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QBuffer>
+#include <QDateTime>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+
+#include <libvirt/libvirt-stream.h>
+#endif
+
+namespace QVirt {
+
+namespace {
+
+// How often the queue of due domains is looked at
+constexpr int ScheduleTickMs = 1000;
+
+constexpr int DefaultRefreshIntervalMs = 10000;
+constexpr int DefaultMaxConcurrent = 4;
+
+// Stays below libvirtd's default max_client_requests (5) so thumbnails
+// never block interactive calls on the same connection
+constexpr int MaxConcurrentPerConnection = 2;
+
+// Upper bound for failing domains: about five minutes at the default interval
+constexpr int MaxBackoffShift = 5;
+
+// An uncompressed 4K PPM is ~25 MiB; anything larger is not a screen
+constexpr int MaxScreenshotBytes = 64 * 1024 * 1024;
+
+constexpr int RecvChunkBytes = 256 * 1024;
+
+} // namespace
+
+ThumbnailService::ThumbnailService(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_refreshInterval(DefaultRefreshIntervalMs)
+    , m_maxConcurrent(DefaultMaxConcurrent)
+    , m_thumbnailSize(256, 192)
+    , m_inFlight(0)
+    , m_captures(0)
+    , m_failures(0)
+{
+    m_clock.start();
+    m_timer->setInterval(ScheduleTickMs);
+    connect(m_timer, &QTimer::timeout, this, &ThumbnailService::schedule);
+}
+
+ThumbnailService::~ThumbnailService() = default;
+
+void ThumbnailService::addConnection(Connection *conn)
+{
+    if (!conn || m_connections.contains(conn)) {
+        return;
+    }
+
+    m_connections.append(conn);
+    connect(conn, &Connection::domainAdded, this, &ThumbnailService::onDomainAdded);
+    connect(conn, &Connection::domainRemoved, this, &ThumbnailService::onDomainRemoved);
+    connect(conn, &QObject::destroyed, this, [this](QObject *object) {
+        m_connections.removeAll(static_cast<Connection *>(object));
+    });
+
+    for (Domain *domain : conn->domains()) {
+        watchDomain(domain);
+    }
+}
+
+void ThumbnailService::removeConnection(Connection *conn)
+{
+    if (!m_connections.removeAll(conn)) {
+        return;
+    }
+
+    disconnect(conn, nullptr, this, nullptr);
+    for (Domain *domain : conn->domains()) {
+        onDomainRemoved(domain);
+    }
+}
+
+ThumbnailService::Thumbnail ThumbnailService::thumbnail(const Domain *domain) const
+{
+    auto it = m_entries.constFind(domain);
+    return it != m_entries.constEnd() ? it->thumbnail : Thumbnail();
+}
+
+qint64 ThumbnailService::thumbnailAge(const Domain *domain) const
+{
+    auto it = m_entries.constFind(domain);
+    if (it == m_entries.constEnd() || it->thumbnail.isNull()) {
+        return -1;
+    }
+    return qMax<qint64>(0, QDateTime::currentMSecsSinceEpoch() - it->thumbnail.capturedMs);
+}
+
+void ThumbnailService::setRefreshInterval(int milliseconds)
+{
+    m_refreshInterval = qMax(ScheduleTickMs, milliseconds);
+}
+
+void ThumbnailService::setMaxConcurrent(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+}
+
+void ThumbnailService::setThumbnailSize(const QSize &size)
+{
+    if (size.isValid()) {
+        m_thumbnailSize = size;
+    }
+}
+
+bool ThumbnailService::isActive() const
+{
+    return m_timer->isActive();
+}
+
+void ThumbnailService::setActive(bool active)
+{
+    if (active == isActive()) {
+        return;
+    }
+
+    if (active) {
+        m_timer->start();
+        schedule();
+    } else {
+        m_timer->stop();
+    }
+}
+
+void ThumbnailService::onDomainAdded(Domain *domain)
+{
+    watchDomain(domain);
+}
+
+void ThumbnailService::onDomainRemoved(Domain *domain)
+{
+    if (!domain) {
+        return;
+    }
+
+    disconnect(domain, nullptr, this, nullptr);
+    m_entries.remove(domain);
+}
+
+void ThumbnailService::onDomainStateChanged(Domain::State state)
+{
+    Q_UNUSED(state);
+
+    Domain *domain = qobject_cast<Domain *>(sender());
+    auto it = m_entries.find(domain);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    if (wantsCapture(domain)) {
+        // Boot screens are the interesting ones: capture soon after a start
+        it->nextDueMs = 0;
+        it->failures = 0;
+    } else if (!it->thumbnail.isNull()) {
+        // The last screen of a stopped guest would only mislead
+        it->thumbnail = Thumbnail();
+        emit thumbnailUpdated(domain);
+    }
+}
+
+void ThumbnailService::watchDomain(Domain *domain)
+{
+    if (!domain || m_entries.contains(domain)) {
+        return;
+    }
+
+    m_entries.insert(domain, Entry());
+    connect(domain, &Domain::stateChanged, this, &ThumbnailService::onDomainStateChanged);
+    connect(domain, &QObject::destroyed, this, [this](QObject *object) {
+        m_entries.remove(static_cast<Domain *>(object));
+    });
+}
+
+bool ThumbnailService::wantsCapture(const Domain *domain)
+{
+    return domain && !domain->isCached() && domain->rawDomain()
+           && domain->state() == Domain::StateRunning;
+}
+
+void ThumbnailService::schedule()
+{
+    if (!isActive() || m_inFlight >= m_maxConcurrent) {
+        return;
+    }
+
+    // Most overdue first, so a large fleet is walked round-robin
+    const qint64 now = m_clock.elapsed();
+    QVector<QPair<qint64, Domain *>> due;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        Domain *domain = const_cast<Domain *>(it.key());
+        if (!it->inFlight && it->nextDueMs <= now && wantsCapture(domain)) {
+            due.append(qMakePair(it->nextDueMs, domain));
+        }
+    }
+    std::sort(due.begin(), due.end(), [](const QPair<qint64, Domain *> &a,
+                                         const QPair<qint64, Domain *> &b) {
+        return a.first < b.first;
+    });
+
+    for (const auto &candidate : due) {
+        if (m_inFlight >= m_maxConcurrent) {
+            break;
+        }
+        Domain *domain = candidate.second;
+        if (m_inFlightPerConnection.value(domain->connection()) >= MaxConcurrentPerConnection) {
+            continue;
+        }
+        startCapture(domain, m_entries[domain]);
+    }
+}
+
+void ThumbnailService::startCapture(Domain *domain, Entry &entry)
+{
+    Connection *conn = domain->connection();
+    virDomainPtr raw = domain->rawDomain();
+#ifdef LIBVIRT_FOUND
+    // The worker holds its own reference in case the Domain goes away first
+    if (virDomainRef(raw) < 0) {
+        entry.nextDueMs = m_clock.elapsed() + retryDelay(m_refreshInterval, ++entry.failures);
+        return;
+    }
+#endif
+
+    entry.inFlight = true;
+    m_inFlight++;
+    m_inFlightPerConnection[conn]++;
+
+    QPointer<Domain> guard(domain);
+    const QSize bounds = m_thumbnailSize;
+
+    auto *watcher = new QFutureWatcher<CaptureResult>(this);
+    connect(watcher, &QFutureWatcher<CaptureResult>::finished, this,
+            [this, watcher, guard, domain, conn]() {
+        CaptureResult result = watcher->result();
+        watcher->deleteLater();
+
+        m_inFlight--;
+        if (--m_inFlightPerConnection[conn] <= 0) {
+            m_inFlightPerConnection.remove(conn);
+        }
+
+        // Domain was deleted or dropped while the capture ran
+        if (guard && m_entries.contains(domain)) {
+            finishCapture(domain, result);
+        }
+        schedule();
+    });
+
+    watcher->setFuture(QtConcurrent::run([raw, bounds]() {
+        return capture(raw, bounds);
+    }));
+}
+
+void ThumbnailService::finishCapture(Domain *domain, const CaptureResult &result)
+{
+    Entry &entry = m_entries[domain];
+    entry.inFlight = false;
+
+    if (result.image.isNull()) {
+        m_failures++;
+        entry.failures++;
+        entry.nextDueMs = m_clock.elapsed() + retryDelay(m_refreshInterval, entry.failures);
+        return;
+    }
+
+    m_captures++;
+    entry.failures = 0;
+    entry.nextDueMs = m_clock.elapsed() + m_refreshInterval;
+
+    // A state change may have arrived while the capture was running
+    if (!wantsCapture(domain)) {
+        return;
+    }
+
+    entry.thumbnail.pixmap = QPixmap::fromImage(result.image);
+    entry.thumbnail.png = result.png;
+    entry.thumbnail.capturedMs = QDateTime::currentMSecsSinceEpoch();
+    emit thumbnailUpdated(domain);
+}
+
+ThumbnailService::CaptureResult ThumbnailService::capture(virDomainPtr domain, const QSize &bounds)
+{
+    CaptureResult result;
+
+#ifdef LIBVIRT_FOUND
+    virConnectPtr conn = virDomainGetConnect(domain);
+    virStreamPtr stream = conn ? virStreamNew(conn, 0) : nullptr;
+    if (!stream) {
+        virDomainFree(domain);
+        result.error = QStringLiteral("Failed to create stream");
+        return result;
+    }
+
+    char *mime = virDomainScreenshot(domain, stream, 0, 0);
+    if (!mime) {
+        virErrorPtr err = virGetLastError();
+        result.error = err ? QString::fromUtf8(err->message) : QStringLiteral("Screenshot failed");
+        virStreamFree(stream);
+        virDomainFree(domain);
+        return result;
+    }
+    const QString mimeType = QString::fromUtf8(mime);
+    free(mime);
+
+    // Receive straight into the payload buffer, no bounce copy
+    QByteArray data;
+    bool success = true;
+    for (;;) {
+        const int offset = data.size();
+        if (offset + RecvChunkBytes > MaxScreenshotBytes) {
+            result.error = QStringLiteral("Screenshot too large");
+            success = false;
+            break;
+        }
+        data.resize(offset + RecvChunkBytes);
+        int bytesRead = virStreamRecv(stream, data.data() + offset, RecvChunkBytes);
+        if (bytesRead < 0) {
+            result.error = QStringLiteral("Stream receive failed");
+            success = false;
+            data.resize(offset);
+            break;
+        }
+        data.resize(offset + bytesRead);
+        if (bytesRead == 0) {
+            break;
+        }
+    }
+
+    if (success) {
+        if (virStreamFinish(stream) < 0) {
+            result.error = QStringLiteral("Stream finish failed");
+            success = false;
+        }
+    } else {
+        virStreamAbort(stream);
+    }
+    virStreamFree(stream);
+    virDomainFree(domain);
+
+    if (!success) {
+        return result;
+    }
+
+    result.image = decodeScreenshot(data, mimeType, bounds);
+    if (result.image.isNull()) {
+        result.error = QStringLiteral("Cannot decode %1 screenshot").arg(mimeType);
+        return result;
+    }
+
+    QBuffer buffer(&result.png);
+    buffer.open(QIODevice::WriteOnly);
+    result.image.save(&buffer, "PNG");
+#else
+    Q_UNUSED(domain);
+    Q_UNUSED(bounds);
+    result.error = QStringLiteral("libvirt not available");
+#endif
+
+    return result;
+}
+
+QImage ThumbnailService::decodeScreenshot(const QByteArray &data, const QString &mimeType,
+                                          const QSize &bounds)
+{
+    const char *format = nullptr;
+    if (mimeType == QLatin1String("image/png")) {
+        format = "PNG";
+    } else if (mimeType == QLatin1String("image/x-portable-pixmap")) {
+        format = "PPM";
+    }
+
+    QImage image;
+    if (!image.loadFromData(data, format) && format) {
+        image.loadFromData(data);
+    }
+    if (image.isNull()) {
+        return QImage();
+    }
+
+    if (bounds.isValid() && (image.width() > bounds.width() || image.height() > bounds.height())) {
+        image = image.scaled(bounds, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (image.format() != QImage::Format_RGB32 && !image.hasAlphaChannel()) {
+        image = image.convertToFormat(QImage::Format_RGB32);
+    }
+    return image;
+}
+
+qint64 ThumbnailService::retryDelay(qint64 interval, int failures)
+{
+    if (failures <= 0) {
+        return interval;
+    }
+    return interval << qMin(failures, MaxBackoffShift);
+}
+
+QString ThumbnailService::describeAge(qint64 milliseconds)
+{
+    const qint64 seconds = qMax<qint64>(0, milliseconds / 1000);
+    if (seconds < 60) {
+        return tr("%1 s ago").arg(seconds);
+    }
+    if (seconds < 3600) {
+        return tr("%1 min ago").arg(seconds / 60);
+    }
+    return tr("%1 h ago").arg(seconds / 3600);
+}
+
+} // namespace QVirt
@@ -0,0 +1,152 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_THUMBNAILSERVICE_H
+#define QVIRT_LIBVIRT_THUMBNAILSERVICE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QImage>
+#include <QElapsedTimer>
+
+#include "Domain.h"
+
+class QTimer;
+
+namespace QVirt {
+
+class Connection;
+
+/**
+ * @brief Periodic console screenshots of running domains
+ *
+ * Fetches the primary screen of every running domain on the watched
+ * connections with virDomainScreenshot, one domain at a time per refresh
+ * interval. Captures run on the thread pool under a small concurrency
+ * budget (global and per connection), so a fleet of a hundred VMs costs a
+ * handful of streams at any moment and a slow host cannot starve the rest.
+ *
+ * The PPM/PNG payload is decoded and downscaled once on the worker; the GUI
+ * thread only turns the small result into a pixmap. Domains whose capture
+ * fails (no graphics device, unsupported driver) are retried with
+ * exponential backoff.
+ */
+class ThumbnailService : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Thumbnail {
+        QPixmap pixmap;
+        QByteArray png;             // Encoded copy for rich-text tooltips
+        qint64 capturedMs = 0;      // Wall clock, ms since epoch
+
+        bool isNull() const { return pixmap.isNull(); }
+    };
+
+    explicit ThumbnailService(QObject *parent = nullptr);
+    ~ThumbnailService() override;
+
+    void addConnection(Connection *conn);
+    void removeConnection(Connection *conn);
+
+    // Last thumbnail of @p domain, null if none was captured yet
+    Thumbnail thumbnail(const Domain *domain) const;
+
+    // Milliseconds since the last capture of @p domain, or -1
+    qint64 thumbnailAge(const Domain *domain) const;
+
+    // Delay between two captures of the same domain
+    int refreshInterval() const { return m_refreshInterval; }
+    void setRefreshInterval(int milliseconds);
+
+    // Number of screenshots allowed in flight at once
+    int maxConcurrent() const { return m_maxConcurrent; }
+    void setMaxConcurrent(int count);
+
+    // Bounding box the screenshots are downscaled into
+    QSize thumbnailSize() const { return m_thumbnailSize; }
+    void setThumbnailSize(const QSize &size);
+
+    // Capturing only runs while active, which a new service is not;
+    // cached thumbnails stay available either way
+    bool isActive() const;
+    void setActive(bool active);
+
+    int inFlightCount() const { return m_inFlight; }
+    quint64 captureCount() const { return m_captures; }
+    quint64 failureCount() const { return m_failures; }
+
+    /**
+     * @brief Decode a screenshot payload and fit it into @p bounds
+     *
+     * @p mimeType is the type reported by libvirt and is only used as a
+     * format hint; the data is sniffed if it does not match. Returns a null
+     * image if the payload cannot be decoded.
+     */
+    static QImage decodeScreenshot(const QByteArray &data, const QString &mimeType,
+                                   const QSize &bounds);
+
+    // Delay before the next attempt after @p failures consecutive failures
+    static qint64 retryDelay(qint64 interval, int failures);
+
+    // Short human readable age such as "12 s ago"
+    static QString describeAge(qint64 milliseconds);
+
+signals:
+    void thumbnailUpdated(Domain *domain);
+
+private slots:
+    void schedule();
+    void onDomainAdded(Domain *domain);
+    void onDomainRemoved(Domain *domain);
+    void onDomainStateChanged(Domain::State state);
+
+private:
+    struct Entry {
+        Thumbnail thumbnail;
+        qint64 nextDueMs = 0;       // m_clock time of the next capture
+        int failures = 0;
+        bool inFlight = false;
+    };
+
+    struct CaptureResult {
+        QImage image;
+        QByteArray png;
+        QString error;
+    };
+
+    void watchDomain(Domain *domain);
+    void startCapture(Domain *domain, Entry &entry);
+    void finishCapture(Domain *domain, const CaptureResult &result);
+    static bool wantsCapture(const Domain *domain);
+    static CaptureResult capture(virDomainPtr domain, const QSize &bounds);
+
+    QList<Connection *> m_connections;
+    QHash<const Domain *, Entry> m_entries;
+    QHash<const Connection *, int> m_inFlightPerConnection;
+
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    int m_refreshInterval;
+    int m_maxConcurrent;
+    QSize m_thumbnailSize;
+
+    int m_inFlight;
+    quint64 m_captures;
+    quint64 m_failures;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_THUMBNAILSERVICE_H
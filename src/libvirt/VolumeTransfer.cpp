@@ -0,0 +1,707 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VolumeTransfer.h"
+#include "StorageVolume.h"
+#include "../core/ImageInspector.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QFutureWatcher>
+#include <QFile>
+#include <QTimer>
+#include <atomic>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef LIBVIRT_FOUND
+#include <libvirt/libvirt.h>
+#include <libvirt/virterror.h>
+
+// Windows.h defines 'state' as a macro which breaks our code
+#ifdef _WIN32
+#undef state
+#endif
+
+#include <libvirt/libvirt-stream.h>
+#endif
+
+namespace QVirt {
+
+namespace {
+
+constexpr qint64 MinBufferSize = 256 * 1024;
+constexpr qint64 MaxBufferSize = 256 * 1024 * 1024;
+
+// Buffer, offset and length alignment O_DIRECT needs
+constexpr qint64 DirectIOAlignment = 4096;
+
+constexpr int SampleIntervalMs = 500;
+
+// Weight of the newest sample in the smoothed rates
+constexpr double RateSmoothing = 0.3;
+
+/**
+ * Section of @p fd starting at @p pos: whether it holds data and how long
+ * it runs, up to @p end. Without hole support the rest is one data section.
+ */
+void probeSection(int fd, qint64 pos, qint64 end, bool *inData, qint64 *length)
+{
+#if defined(Q_OS_UNIX) && defined(SEEK_DATA)
+    const off_t data = ::lseek(fd, off_t(pos), SEEK_DATA);
+    if (data < 0 && errno == ENXIO) {
+        // Nothing but a hole up to the end of the file
+        *inData = false;
+        *length = qMax<qint64>(0, end - pos);
+        return;
+    }
+    if (data > pos) {
+        *inData = false;
+        *length = qMin<qint64>(data, end) - pos;
+        return;
+    }
+    if (data == pos) {
+        const off_t hole = ::lseek(fd, off_t(pos), SEEK_HOLE);
+        if (hole > pos) {
+            *inData = true;
+            *length = qMin<qint64>(hole, end) - pos;
+            return;
+        }
+    }
+#else
+    Q_UNUSED(fd);
+#endif
+    *inData = pos < end;
+    *length = qMax<qint64>(0, end - pos);
+}
+
+#ifdef LIBVIRT_FOUND
+QString lastErrorMessage(const QString &fallback)
+{
+    virErrorPtr err = virGetLastError();
+    return err && err->message ? QString::fromUtf8(err->message) : fallback;
+}
+#endif
+
+} // namespace
+
+/**
+ * State of one transfer, shared with the worker thread. The worker owns
+ * everything but the atomics until it returns.
+ */
+struct VolumeTransfer::Job
+{
+    ~Job()
+    {
+        if (buffer) {
+            qFreeAligned(buffer);
+        }
+#ifdef LIBVIRT_FOUND
+        if (volume) {
+            virStorageVolFree(volume);
+        }
+#endif
+    }
+
+    bool execute();
+    bool ensureBuffer();
+
+    // Download side
+    bool flushBuffer();
+    bool writeAt(qint64 offset, const char *data, qint64 length);
+    bool discard(qint64 offset, qint64 length);
+    void setDirect(bool direct);
+
+#ifdef LIBVIRT_FOUND
+    bool upload();
+    bool download();
+
+    static int readData(virStreamPtr stream, char *bytes, size_t nbytes, void *opaque);
+    static int inData(virStreamPtr stream, int *inData, long long *length, void *opaque);
+    static int skipHole(virStreamPtr stream, long long length, void *opaque);
+    static int writeData(virStreamPtr stream, const char *bytes, size_t nbytes, void *opaque);
+    static int writeHole(virStreamPtr stream, long long length, void *opaque);
+#endif
+
+    Direction direction = Upload;
+    virStorageVolPtr volume = nullptr;
+    QFile file;
+    qint64 start = 0;           // Range in the file and the volume
+    qint64 length = 0;          // 0 runs to the end
+    qint64 end = 0;             // Expected end, for progress
+    qint64 pos = 0;
+    qint64 existingSize = 0;    // Download target size before the transfer
+    bool sparse = true;
+    bool directIO = false;
+    bool directActive = false;
+
+    // Read-ahead or write-behind block at file offset bufferStart; libvirt
+    // moves much smaller pieces
+    char *buffer = nullptr;
+    qint64 bufferSize = DefaultBufferSize;
+    qint64 bufferStart = 0;
+    qint64 bufferLength = 0;
+
+    QString error;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<qint64> processed{0};
+    std::atomic<qint64> data{0};
+    std::atomic<qint64> holes{0};
+};
+
+bool VolumeTransfer::Job::ensureBuffer()
+{
+    if (!buffer) {
+        buffer = static_cast<char *>(qMallocAligned(size_t(bufferSize), DirectIOAlignment));
+    }
+    return buffer != nullptr;
+}
+
+bool VolumeTransfer::Job::execute()
+{
+    if (!ensureBuffer()) {
+        error = VolumeTransfer::tr("Out of memory for the transfer buffer");
+        return false;
+    }
+#ifdef LIBVIRT_FOUND
+    return direction == Upload ? upload() : download();
+#else
+    error = VolumeTransfer::tr("libvirt not available");
+    return false;
+#endif
+}
+
+void VolumeTransfer::Job::setDirect(bool direct)
+{
+#if defined(Q_OS_LINUX) && defined(O_DIRECT)
+    if (direct == directActive) {
+        return;
+    }
+    const int fd = file.handle();
+    const int flags = ::fcntl(fd, F_GETFL);
+    if (flags >= 0 && ::fcntl(fd, F_SETFL, direct ? flags | O_DIRECT : flags & ~O_DIRECT) == 0) {
+        directActive = direct;
+    }
+#else
+    Q_UNUSED(direct);
+#endif
+}
+
+bool VolumeTransfer::Job::writeAt(qint64 offset, const char *bytes, qint64 count)
+{
+    if (directIO) {
+        // O_DIRECT only takes aligned writes; the odd tail goes through the cache
+        setDirect(offset % DirectIOAlignment == 0 && count % DirectIOAlignment == 0
+                  && quintptr(bytes) % DirectIOAlignment == 0);
+    }
+    if (!file.seek(offset) || file.write(bytes, count) != count) {
+        error = VolumeTransfer::tr("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool VolumeTransfer::Job::flushBuffer()
+{
+    if (bufferLength == 0) {
+        return true;
+    }
+    if (!writeAt(bufferStart, buffer, bufferLength)) {
+        return false;
+    }
+    bufferStart += bufferLength;
+    bufferLength = 0;
+    return true;
+}
+
+bool VolumeTransfer::Job::discard(qint64 offset, qint64 count)
+{
+    // Only data written before this transfer needs clearing
+    count = qMin(count, existingSize - offset);
+    if (count <= 0) {
+        return true;
+    }
+
+#if defined(Q_OS_LINUX) && defined(FALLOC_FL_PUNCH_HOLE)
+    if (::fallocate(file.handle(), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                    off_t(offset), off_t(count)) == 0) {
+        return true;
+    }
+#endif
+
+    // No hole punching here: the old data still has to become zeros
+    std::memset(buffer, 0, size_t(qMin(count, bufferSize)));
+    while (count > 0) {
+        const qint64 chunk = qMin(count, bufferSize);
+        if (!writeAt(offset, buffer, chunk)) {
+            return false;
+        }
+        offset += chunk;
+        count -= chunk;
+    }
+    return true;
+}
+
+#ifdef LIBVIRT_FOUND
+bool VolumeTransfer::Job::upload()
+{
+    virConnectPtr conn = virStorageVolGetConnect(volume);
+
+    for (bool trySparse = sparse;; trySparse = false) {
+        virStreamPtr stream = conn ? virStreamNew(conn, 0) : nullptr;
+        if (!stream) {
+            error = lastErrorMessage(VolumeTransfer::tr("Failed to create stream"));
+            return false;
+        }
+
+        const unsigned int flags = trySparse ? VIR_STORAGE_VOL_UPLOAD_SPARSE_STREAM : 0;
+        if (virStorageVolUpload(volume, stream, quint64(start), quint64(end - start), flags) < 0) {
+            virStreamFree(stream);
+            if (trySparse) {
+                continue;   // The pool cannot take a sparse stream
+            }
+            error = lastErrorMessage(VolumeTransfer::tr("Failed to start upload"));
+            return false;
+        }
+
+        // Both abort the stream themselves when a callback fails
+        int ret = trySparse ? virStreamSparseSendAll(stream, &Job::readData, &Job::inData,
+                                                     &Job::skipHole, this)
+                            : virStreamSendAll(stream, &Job::readData, this);
+        if (ret == 0) {
+            ret = virStreamFinish(stream);
+        }
+        if (ret < 0 && error.isEmpty()) {
+            error = cancelled.load() ? VolumeTransfer::tr("Transfer cancelled")
+                                     : lastErrorMessage(VolumeTransfer::tr("Upload failed"));
+        }
+        virStreamFree(stream);
+        return ret == 0;
+    }
+}
+
+bool VolumeTransfer::Job::download()
+{
+    virConnectPtr conn = virStorageVolGetConnect(volume);
+    bufferStart = pos;
+
+    for (bool trySparse = sparse;; trySparse = false) {
+        virStreamPtr stream = conn ? virStreamNew(conn, 0) : nullptr;
+        if (!stream) {
+            error = lastErrorMessage(VolumeTransfer::tr("Failed to create stream"));
+            return false;
+        }
+
+        const unsigned int flags = trySparse ? VIR_STORAGE_VOL_DOWNLOAD_SPARSE_STREAM : 0;
+        if (virStorageVolDownload(volume, stream, quint64(start), quint64(length), flags) < 0) {
+            virStreamFree(stream);
+            if (trySparse) {
+                continue;   // The pool cannot produce a sparse stream
+            }
+            error = lastErrorMessage(VolumeTransfer::tr("Failed to start download"));
+            return false;
+        }
+
+        // Both abort the stream themselves when a callback fails
+        int ret = trySparse ? virStreamSparseRecvAll(stream, &Job::writeData, &Job::writeHole, this)
+                            : virStreamRecvAll(stream, &Job::writeData, this);
+        if (ret == 0) {
+            ret = virStreamFinish(stream);
+        }
+        if (ret < 0 && error.isEmpty()) {
+            error = cancelled.load() ? VolumeTransfer::tr("Transfer cancelled")
+                                     : lastErrorMessage(VolumeTransfer::tr("Download failed"));
+        }
+        virStreamFree(stream);
+
+        // Keep what arrived, also on failure, so the transfer can resume
+        if (!flushBuffer()) {
+            ret = -1;
+        }
+        setDirect(false);
+
+        // A trailing hole writes nothing, so the size has to be set
+        if (ret == 0 && file.size() < pos && !file.resize(pos)) {
+            error = VolumeTransfer::tr("Cannot write %1: %2").arg(file.fileName(), file.errorString());
+            ret = -1;
+        }
+        return ret == 0;
+    }
+}
+
+int VolumeTransfer::Job::readData(virStreamPtr, char *bytes, size_t nbytes, void *opaque)
+{
+    auto *job = static_cast<Job *>(opaque);
+    if (job->cancelled.load(std::memory_order_relaxed)) {
+        return -1;
+    }
+    if (nbytes == 0 || job->pos >= job->end) {
+        return 0;
+    }
+
+    if (job->pos < job->bufferStart || job->pos >= job->bufferStart + job->bufferLength) {
+        if (!job->file.seek(job->pos)) {
+            return -1;
+        }
+        const qint64 got = job->file.read(job->buffer, qMin(job->bufferSize, job->end - job->pos));
+        if (got < 0) {
+            job->error = VolumeTransfer::tr("Cannot read %1: %2")
+                             .arg(job->file.fileName(), job->file.errorString());
+            return -1;
+        }
+        job->bufferStart = job->pos;
+        job->bufferLength = got;
+        if (got == 0) {
+            return 0;
+        }
+    }
+
+    const qint64 local = job->pos - job->bufferStart;
+    const qint64 length = qMin<qint64>(qint64(nbytes), job->bufferLength - local);
+    std::memcpy(bytes, job->buffer + local, size_t(length));
+    job->pos += length;
+    job->processed.fetch_add(length, std::memory_order_relaxed);
+    job->data.fetch_add(length, std::memory_order_relaxed);
+    return int(length);
+}
+
+int VolumeTransfer::Job::inData(virStreamPtr, int *inData, long long *length, void *opaque)
+{
+    auto *job = static_cast<Job *>(opaque);
+    if (job->cancelled.load(std::memory_order_relaxed)) {
+        return -1;
+    }
+
+    bool data = false;
+    qint64 section = 0;
+    probeSection(job->file.handle(), job->pos, job->end, &data, &section);
+    *inData = data ? 1 : 0;
+    *length = section;
+    return 0;
+}
+
+int VolumeTransfer::Job::skipHole(virStreamPtr, long long length, void *opaque)
+{
+    auto *job = static_cast<Job *>(opaque);
+    job->pos += length;
+    job->processed.fetch_add(length, std::memory_order_relaxed);
+    job->holes.fetch_add(length, std::memory_order_relaxed);
+    return 0;
+}
+
+int VolumeTransfer::Job::writeData(virStreamPtr, const char *bytes, size_t nbytes, void *opaque)
+{
+    auto *job = static_cast<Job *>(opaque);
+    if (job->cancelled.load(std::memory_order_relaxed)) {
+        return -1;
+    }
+
+    // Collect into the block; the disk sees one large write per block
+    qint64 done = 0;
+    while (done < qint64(nbytes)) {
+        if (job->bufferLength == job->bufferSize && !job->flushBuffer()) {
+            return -1;
+        }
+        const qint64 take = qMin(qint64(nbytes) - done, job->bufferSize - job->bufferLength);
+        std::memcpy(job->buffer + job->bufferLength, bytes + done, size_t(take));
+        job->bufferLength += take;
+        done += take;
+    }
+
+    job->pos += done;
+    job->processed.fetch_add(done, std::memory_order_relaxed);
+    job->data.fetch_add(done, std::memory_order_relaxed);
+    return int(done);
+}
+
+int VolumeTransfer::Job::writeHole(virStreamPtr, long long length, void *opaque)
+{
+    auto *job = static_cast<Job *>(opaque);
+    if (job->cancelled.load(std::memory_order_relaxed)) {
+        return -1;
+    }
+
+    // Skip over the hole instead of writing zeros
+    if (!job->flushBuffer() || !job->discard(job->pos, length)) {
+        return -1;
+    }
+    job->pos += length;
+    job->bufferStart = job->pos;
+    job->processed.fetch_add(length, std::memory_order_relaxed);
+    job->holes.fetch_add(length, std::memory_order_relaxed);
+    return 0;
+}
+#endif
+
+VolumeTransfer::VolumeTransfer(StorageVolume *volume, Direction direction, const QString &path,
+                               QObject *parent)
+    : QObject(parent)
+    , m_volume(volume)
+    , m_direction(direction)
+    , m_path(path)
+    , m_bufferSize(DefaultBufferSize)
+    , m_sparse(true)
+    , m_offset(0)
+    , m_length(0)
+    , m_directIO(false)
+    , m_state(Idle)
+    , m_sampleTimer(new QTimer(this))
+    , m_lastSampleMs(0)
+    , m_lastProcessed(0)
+    , m_lastData(0)
+    , m_bytesPerSecond(0)
+    , m_processRate(0)
+    , m_etaMs(-1)
+{
+    m_sampleTimer->setInterval(SampleIntervalMs);
+    connect(m_sampleTimer, &QTimer::timeout, this, &VolumeTransfer::sampleProgress);
+}
+
+VolumeTransfer::~VolumeTransfer()
+{
+    cancel();
+    if (m_future.isRunning()) {
+        m_future.waitForFinished();
+    }
+}
+
+void VolumeTransfer::setBufferSize(qint64 bytes)
+{
+    // Whole O_DIRECT blocks, so full buffers can bypass the cache
+    bytes = qBound(MinBufferSize, bytes, MaxBufferSize);
+    m_bufferSize = bytes - bytes % DirectIOAlignment;
+}
+
+void VolumeTransfer::setRange(qint64 offset, qint64 length)
+{
+    m_offset = qMax<qint64>(0, offset);
+    m_length = qMax<qint64>(0, length);
+}
+
+qint64 VolumeTransfer::processedBytes() const
+{
+    return m_job ? m_job->processed.load(std::memory_order_relaxed) : 0;
+}
+
+qint64 VolumeTransfer::totalBytes() const
+{
+    return m_job ? m_job->end - m_job->start : 0;
+}
+
+qint64 VolumeTransfer::dataBytes() const
+{
+    return m_job ? m_job->data.load(std::memory_order_relaxed) : 0;
+}
+
+qint64 VolumeTransfer::holeBytes() const
+{
+    return m_job ? m_job->holes.load(std::memory_order_relaxed) : 0;
+}
+
+bool VolumeTransfer::openFile(Job *job)
+{
+    job->file.setFileName(m_path);
+
+    if (m_direction == Upload) {
+        if (!job->file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            m_error = tr("Cannot open %1: %2").arg(m_path, job->file.errorString());
+            return false;
+        }
+        const qint64 size = job->file.size();
+        if (m_offset > size) {
+            m_error = tr("Offset %1 is beyond the end of %2").arg(m_offset).arg(m_path);
+            return false;
+        }
+        job->end = m_length > 0 ? qMin(size, m_offset + m_length) : size;
+        return true;
+    }
+
+    // Only a whole-volume download starts the file afresh
+    QIODevice::OpenMode mode = QIODevice::ReadWrite | QIODevice::Unbuffered;
+    if (m_offset == 0 && m_length == 0) {
+        mode |= QIODevice::Truncate;
+    }
+    if (!job->file.open(mode)) {
+        m_error = tr("Cannot open %1: %2").arg(m_path, job->file.errorString());
+        return false;
+    }
+    job->existingSize = job->file.size();
+
+    // What the stream will carry: the file size of a file volume, not its
+    // virtual capacity
+    qint64 volumeSize = m_volume->capacity();
+#ifdef LIBVIRT_FOUND
+    virStorageVolInfo info;
+    if (virStorageVolGetInfoFlags(m_volume->virVolume(), &info,
+                                  VIR_STORAGE_VOL_GET_PHYSICAL) == 0) {
+        volumeSize = qint64(info.allocation);
+    }
+#endif
+    job->end = m_length > 0 ? m_offset + m_length : qMax(m_offset, volumeSize);
+    return true;
+}
+
+bool VolumeTransfer::prepare()
+{
+    if (m_state == Running) {
+        return false;
+    }
+    m_state = Failed;
+
+    if (!m_volume || !m_volume->virVolume()) {
+        m_error = tr("Volume is not available");
+        return false;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->direction = m_direction;
+    job->start = m_offset;
+    job->length = m_length;
+    job->pos = m_offset;
+    job->sparse = m_sparse;
+    job->directIO = m_directIO && m_direction == Download;
+    job->bufferSize = m_bufferSize;
+    if (!openFile(job.get())) {
+        return false;
+    }
+
+#ifdef LIBVIRT_FOUND
+    // The worker keeps its own reference in case the wrapper goes away
+    if (virStorageVolRef(m_volume->virVolume()) < 0) {
+        m_error = lastErrorMessage(tr("Volume is not available"));
+        return false;
+    }
+    job->volume = m_volume->virVolume();
+#endif
+
+    m_job = job;
+    m_error.clear();
+    m_state = Running;
+    m_lastSampleMs = 0;
+    m_lastProcessed = 0;
+    m_lastData = 0;
+    m_bytesPerSecond = 0;
+    m_processRate = 0;
+    m_etaMs = -1;
+    m_clock.start();
+    return true;
+}
+
+bool VolumeTransfer::start()
+{
+    if (!prepare()) {
+        return false;
+    }
+
+    std::shared_ptr<Job> job = m_job;
+    auto *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        if (m_state == Running) {
+            complete(watcher->result());
+        }
+    });
+    m_future = QtConcurrent::run([job]() {
+        return job->execute();
+    });
+    watcher->setFuture(m_future);
+    m_sampleTimer->start();
+    return true;
+}
+
+bool VolumeTransfer::run()
+{
+    if (!prepare()) {
+        return false;
+    }
+    const bool success = m_job->execute();
+    complete(success);
+    return success;
+}
+
+void VolumeTransfer::cancel()
+{
+    if (m_job) {
+        m_job->cancelled.store(true);
+    }
+}
+
+void VolumeTransfer::waitForFinished()
+{
+    if (m_state != Running || !m_future.isStarted()) {
+        return;
+    }
+    m_future.waitForFinished();
+    complete(m_future.result());
+}
+
+void VolumeTransfer::complete(bool success)
+{
+    m_sampleTimer->stop();
+    sampleProgress();
+
+    if (success) {
+        m_state = Finished;
+        m_etaMs = 0;
+    } else {
+        m_state = m_job->cancelled.load() ? Cancelled : Failed;
+        m_error = m_job->error;
+    }
+    emit finished(success);
+}
+
+void VolumeTransfer::sampleProgress()
+{
+    const qint64 now = m_clock.elapsed();
+    const qint64 processed = processedBytes();
+    const qint64 data = dataBytes();
+    const qint64 elapsed = now - m_lastSampleMs;
+
+    if (elapsed > 0) {
+        const double dataRate = (data - m_lastData) * 1000.0 / elapsed;
+        const double processRate = (processed - m_lastProcessed) * 1000.0 / elapsed;
+        m_bytesPerSecond = m_lastSampleMs == 0
+                               ? dataRate
+                               : RateSmoothing * dataRate + (1 - RateSmoothing) * m_bytesPerSecond;
+        m_processRate = m_lastSampleMs == 0
+                            ? processRate
+                            : RateSmoothing * processRate + (1 - RateSmoothing) * m_processRate;
+        m_etaMs = estimateEtaMs(totalBytes() - processed, m_processRate);
+
+        m_lastSampleMs = now;
+        m_lastProcessed = processed;
+        m_lastData = data;
+    }
+    emit progress(processed, totalBytes());
+}
+
+qint64 VolumeTransfer::estimateEtaMs(qint64 remaining, double bytesPerSecond)
+{
+    if (remaining <= 0) {
+        return 0;
+    }
+    if (bytesPerSecond <= 0) {
+        return -1;
+    }
+    return qint64(remaining * 1000.0 / bytesPerSecond);
+}
+
+qint64 VolumeTransfer::allocatedBytes(const QString &path)
+{
+    return ImageInspector::dataExtentBytes(path);
+}
+
+} // namespace QVirt
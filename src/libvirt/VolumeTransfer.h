@@ -0,0 +1,175 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_LIBVIRT_VOLUMETRANSFER_H
+#define QVIRT_LIBVIRT_VOLUMETRANSFER_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <memory>
+
+class QTimer;
+
+namespace QVirt {
+
+class StorageVolume;
+
+/**
+ * @brief Streams data between a local file and a storage volume
+ *
+ * Both directions use sparse streams. An upload finds the holes in the
+ * source file with SEEK_DATA/SEEK_HOLE and sends them as hole markers
+ * (virStreamSparseSendAll); a download receives holes the same way
+ * (virStreamSparseRecvAll) and skips over them in the target file, or
+ * punches them out where it overwrites older data, instead of writing
+ * zeros. A mostly empty image only moves its data extents. Pools that
+ * cannot do sparse streams get a plain one instead.
+ *
+ * Data passes through a bufferSize() block, so the disk sees large reads
+ * and writes while libvirt moves stream-sized packets. A transfer may
+ * cover a byte range, at the same offset in the file and the volume; a
+ * failed download keeps what it received, and a new transfer starting at
+ * resumeOffset() picks up from there.
+ *
+ * start() runs the transfer on a worker thread and reports progress(),
+ * throughput and ETA while it runs; run() does the same work on the
+ * calling thread. cancel() aborts the stream.
+ */
+class VolumeTransfer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Direction {
+        Upload,     // File to volume
+        Download    // Volume to file
+    };
+
+    enum State {
+        Idle,
+        Running,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    static constexpr qint64 DefaultBufferSize = 8 * 1024 * 1024;
+
+    VolumeTransfer(StorageVolume *volume, Direction direction, const QString &path,
+                   QObject *parent = nullptr);
+    ~VolumeTransfer() override;
+
+    Direction direction() const { return m_direction; }
+    QString path() const { return m_path; }
+    State state() const { return m_state; }
+    QString errorString() const { return m_error; }
+
+    qint64 bufferSize() const { return m_bufferSize; }
+    void setBufferSize(qint64 bytes);
+
+    // Transfer holes as holes; on by default
+    bool isSparse() const { return m_sparse; }
+    void setSparse(bool sparse) { m_sparse = sparse; }
+
+    /**
+     * @brief Limit the transfer to @p length bytes from @p offset
+     *
+     * A length of 0 runs to the end. A download of the whole volume
+     * replaces the file; a range download writes into it in place.
+     */
+    void setRange(qint64 offset, qint64 length);
+    qint64 offset() const { return m_offset; }
+    qint64 length() const { return m_length; }
+
+    // Downloads only: write with O_DIRECT where supported, bypassing the
+    // page cache so a large image does not evict everything else
+    bool directIO() const { return m_directIO; }
+    void setDirectIO(bool direct) { m_directIO = direct; }
+
+    // Start on a worker thread; false if the transfer could not be set up
+    bool start();
+
+    // Transfer on the calling thread
+    bool run();
+
+    void cancel();
+    void waitForFinished();
+
+    // Bytes of the file covered so far, holes included, out of totalBytes()
+    qint64 processedBytes() const;
+    qint64 totalBytes() const;
+
+    // Bytes moved as data, and skipped as holes
+    qint64 dataBytes() const;
+    qint64 holeBytes() const;
+
+    // File offset up to which the transfer is complete
+    qint64 resumeOffset() const { return m_offset + processedBytes(); }
+
+    // Smoothed data rate on the wire, and estimated time left (-1 if unknown)
+    double bytesPerSecond() const { return m_bytesPerSecond; }
+    qint64 etaMs() const { return m_etaMs; }
+
+    /**
+     * @brief Bytes of @p path backed by data rather than holes
+     *
+     * What a sparse upload will send; the file size when the file system
+     * cannot report holes, -1 if the file cannot be read.
+     */
+    static qint64 allocatedBytes(const QString &path);
+
+    // Time left for @p remaining bytes at @p bytesPerSecond, or -1
+    static qint64 estimateEtaMs(qint64 remaining, double bytesPerSecond);
+
+signals:
+    void progress(qint64 processed, qint64 total);
+    void finished(bool success);
+
+private slots:
+    void sampleProgress();
+
+private:
+    struct Job;
+
+    bool prepare();
+    bool openFile(Job *job);
+    void complete(bool success);
+
+    StorageVolume *m_volume;
+    const Direction m_direction;
+    const QString m_path;
+    qint64 m_bufferSize;
+    bool m_sparse;
+    qint64 m_offset;
+    qint64 m_length;
+    bool m_directIO;
+
+    State m_state;
+    QString m_error;
+    std::shared_ptr<Job> m_job;
+    QFuture<bool> m_future;
+
+    // Progress sampling, GUI thread
+    QTimer *m_sampleTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastSampleMs;
+    qint64 m_lastProcessed;
+    qint64 m_lastData;
+    double m_bytesPerSecond;
+    double m_processRate;
+    qint64 m_etaMs;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_LIBVIRT_VOLUMETRANSFER_H
@@ -0,0 +1,207 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "GroupSnapshotDialog.h"
+#include "../../libvirt/EnumMapper.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHeaderView>
+#include <QDateTime>
+#include <QMessageBox>
+
+namespace QVirt {
+
+namespace {
+
+enum MemberColumn {
+    ColumnVM,
+    ColumnState,
+    ColumnFreeze,
+    ColumnSnapshot,
+    ColumnThaw,
+    ColumnFrozen,
+    ColumnResult
+};
+
+QString msText(qint64 ms)
+{
+    return ms < 0 ? QString("-") : QString("%1 ms").arg(ms);
+}
+
+QString resultText(const GroupSnapshot::Member &member)
+{
+    if (member.rolledBack) {
+        return "Rolled back";
+    }
+    if (member.created) {
+        return member.error.isEmpty() ? QString("Done")
+                                      : QString("Done, %1").arg(member.error);
+    }
+    return member.error.isEmpty() ? QString("Not taken") : member.error;
+}
+
+} // namespace
+
+GroupSnapshotDialog::GroupSnapshotDialog(const QList<Domain*> &domains, QWidget *parent)
+    : QDialog(parent)
+    , m_domains(domains)
+    , m_group(nullptr)
+{
+    setWindowTitle("Group Snapshot");
+    setMinimumSize(760, 420);
+
+    setupUI();
+}
+
+void GroupSnapshotDialog::setupUI()
+{
+    auto *layout = new QVBoxLayout(this);
+
+    auto *configGroup = new QGroupBox("Snapshot", this);
+    auto *configLayout = new QFormLayout(configGroup);
+
+    m_nameEdit = new QLineEdit(configGroup);
+    m_nameEdit->setText(GroupSnapshot::defaultName(QDateTime::currentDateTime()));
+    configLayout->addRow("Name:", m_nameEdit);
+
+    m_descEdit = new QTextEdit(configGroup);
+    m_descEdit->setPlaceholderText("Description (optional)");
+    m_descEdit->setMaximumHeight(60);
+    configLayout->addRow("Description:", m_descEdit);
+
+    m_parallelSpin = new QSpinBox(configGroup);
+    m_parallelSpin->setRange(1, 32);
+    m_parallelSpin->setValue(qMin(int(GroupSnapshot::DefaultMaxParallel),
+                                  qMax(1, int(m_domains.size()))));
+    m_parallelSpin->setToolTip("VMs frozen, snapshotted and thawed at the same time");
+    configLayout->addRow("In parallel:", m_parallelSpin);
+
+    m_requireFreezeCheck = new QCheckBox("Only if every running VM can be frozen", configGroup);
+    m_requireFreezeCheck->setToolTip(
+        "Freezing needs the QEMU guest agent. Without this option, VMs that cannot "
+        "be frozen are snapshotted as after a power loss.");
+    configLayout->addRow("", m_requireFreezeCheck);
+
+    layout->addWidget(configGroup);
+
+    m_memberList = new QTreeWidget(this);
+    m_memberList->setRootIsDecorated(false);
+    m_memberList->setHeaderLabels({"VM", "State", "Freeze", "Snapshot", "Thaw",
+                                   "Frozen For", "Result"});
+    m_memberList->header()->setStretchLastSection(true);
+    m_memberList->setColumnWidth(ColumnVM, 160);
+    for (Domain *domain : m_domains) {
+        auto *item = new QTreeWidgetItem(m_memberList);
+        item->setText(ColumnVM, domain->name());
+        item->setText(ColumnState, EnumMapper::stateToString(domain->state()));
+    }
+    layout->addWidget(m_memberList, 1);
+
+    m_summaryLabel = new QLabel(
+        "Running VMs are frozen together, snapshotted disk-only and thawed. "
+        "If any snapshot fails, the others are deleted again.", this);
+    m_summaryLabel->setWordWrap(true);
+    layout->addWidget(m_summaryLabel);
+
+    auto *buttonLayout = new QHBoxLayout();
+    m_btnStart = new QPushButton("Take Snapshot", this);
+    m_btnStart->setDefault(true);
+    m_btnClose = new QPushButton("Close", this);
+    connect(m_btnStart, &QPushButton::clicked, this, &GroupSnapshotDialog::onStart);
+    connect(m_btnClose, &QPushButton::clicked, this, &GroupSnapshotDialog::reject);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_btnStart);
+    buttonLayout->addWidget(m_btnClose);
+    layout->addLayout(buttonLayout);
+}
+
+void GroupSnapshotDialog::onStart()
+{
+    const QString name = m_nameEdit->text().trimmed();
+    if (name.isEmpty()) {
+        QMessageBox::warning(this, "Invalid Name", "Please enter a snapshot name");
+        return;
+    }
+
+    delete m_group;
+    m_group = new GroupSnapshot(m_domains, this);
+    m_group->setName(name);
+    m_group->setDescription(m_descEdit->toPlainText());
+    m_group->setMaxParallel(m_parallelSpin->value());
+    m_group->setRequireFreeze(m_requireFreezeCheck->isChecked());
+    connect(m_group, &GroupSnapshot::finished, this, &GroupSnapshotDialog::onFinished);
+
+    m_nameEdit->setEnabled(false);
+    m_descEdit->setEnabled(false);
+    m_parallelSpin->setEnabled(false);
+    m_requireFreezeCheck->setEnabled(false);
+    m_btnStart->setEnabled(false);
+    m_btnClose->setEnabled(false);
+    m_summaryLabel->setText(QString("Taking snapshot '%1' of %2 VM(s)...")
+                                .arg(name).arg(m_domains.size()));
+
+    m_group->start();
+}
+
+void GroupSnapshotDialog::onFinished(bool success)
+{
+    updateMembers();
+    m_btnClose->setEnabled(true);
+
+    if (success) {
+        QString summary = QString("Snapshot '%1' taken of %2 VM(s) in %3 ms.")
+                              .arg(m_group->name()).arg(m_domains.size())
+                              .arg(m_group->elapsedMs());
+        if (m_group->freezeWindowMs() >= 0) {
+            summary += QString(" Guests were frozen for %1 ms.").arg(m_group->freezeWindowMs());
+        }
+        m_summaryLabel->setText(summary);
+        return;
+    }
+
+    m_summaryLabel->setText(QString("Group snapshot failed: %1").arg(m_group->errorString()));
+
+    // Nothing was kept, so another attempt may reuse the settings
+    m_nameEdit->setEnabled(true);
+    m_descEdit->setEnabled(true);
+    m_parallelSpin->setEnabled(true);
+    m_requireFreezeCheck->setEnabled(true);
+    m_btnStart->setEnabled(true);
+}
+
+void GroupSnapshotDialog::updateMembers()
+{
+    const QList<GroupSnapshot::Member> members = m_group->members();
+    for (int i = 0; i < members.size() && i < m_memberList->topLevelItemCount(); ++i) {
+        const GroupSnapshot::Member &member = members.at(i);
+        QTreeWidgetItem *item = m_memberList->topLevelItem(i);
+        item->setText(ColumnFreeze, member.running && !member.frozen && member.freezeMs >= 0
+                                        ? QString("Failed") : msText(member.freezeMs));
+        item->setText(ColumnSnapshot, msText(member.snapshotMs));
+        item->setText(ColumnThaw, msText(member.thawMs));
+        item->setText(ColumnFrozen, msText(member.frozenMs));
+        item->setText(ColumnResult, resultText(member));
+        item->setToolTip(ColumnResult, member.error);
+    }
+}
+
+void GroupSnapshotDialog::reject()
+{
+    if (m_group && m_group->state() == GroupSnapshot::Running) {
+        return;
+    }
+    QDialog::reject();
+}
+
+} // namespace QVirt
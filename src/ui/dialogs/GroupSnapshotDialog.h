@@ -0,0 +1,69 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_DIALOGS_GROUPSNAPSHOTDIALOG_H
+#define QVIRT_UI_DIALOGS_GROUPSNAPSHOTDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QTextEdit>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTreeWidget>
+
+#include "../../libvirt/Domain.h"
+#include "../../libvirt/GroupSnapshot.h"
+
+namespace QVirt {
+
+/**
+ * @brief Group Snapshot Dialog
+ *
+ * Takes one consistent disk snapshot of several VMs and shows how long
+ * each step took per VM.
+ */
+class GroupSnapshotDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit GroupSnapshotDialog(const QList<Domain*> &domains, QWidget *parent = nullptr);
+    ~GroupSnapshotDialog() override = default;
+
+    // Not while guests may be frozen
+    void reject() override;
+
+private slots:
+    void onStart();
+    void onFinished(bool success);
+
+private:
+    void setupUI();
+    void updateMembers();
+
+    QList<Domain*> m_domains;
+    GroupSnapshot *m_group;
+
+    QLineEdit *m_nameEdit;
+    QTextEdit *m_descEdit;
+    QSpinBox *m_parallelSpin;
+    QCheckBox *m_requireFreezeCheck;
+    QTreeWidget *m_memberList;
+    QLabel *m_summaryLabel;
+    QPushButton *m_btnStart;
+    QPushButton *m_btnClose;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_DIALOGS_GROUPSNAPSHOTDIALOG_H
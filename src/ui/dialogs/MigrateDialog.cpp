@@ -11,20 +11,68 @@
 
 #include "MigrateDialog.h"
 #include "../../core/Error.h"
+#include "../../core/ByteFormat.h"
 
 #include <QMessageBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
+#include <QHeaderView>
 
 namespace QVirt {
 
+namespace {
+
+enum JobColumn {
+    ColumnVM,
+    ColumnState,
+    ColumnProgress,
+    ColumnRemaining,
+    ColumnDirtyRate,
+    ColumnThroughput,
+    ColumnDowntime,
+    ColumnPasses
+};
+
+QString stateText(const MigrationJob *job)
+{
+    switch (job->state()) {
+    case MigrationJob::Queued:
+        return "Queued";
+    case MigrationJob::Running:
+        return "Migrating";
+    case MigrationJob::PostCopy:
+        return "Post-copy";
+    case MigrationJob::Finished:
+        return QString("Done in %1 s").arg(job->elapsedMs() / 1000.0, 0, 'f', 1);
+    case MigrationJob::Failed:
+        return "Failed";
+    case MigrationJob::Cancelled:
+        return "Aborted";
+    }
+    return QString();
+}
+
+bool isActive(const Domain *domain)
+{
+    const Domain::State state = domain->state();
+    return state == Domain::StateRunning || state == Domain::StatePaused
+        || state == Domain::StateBlocked;
+}
+
+} // namespace
+
 MigrateDialog::MigrateDialog(Domain *domain, QWidget *parent)
+    : MigrateDialog(domain ? QList<Domain*>{domain} : QList<Domain*>(), parent)
+{
+}
+
+MigrateDialog::MigrateDialog(const QList<Domain*> &domains, QWidget *parent)
     : QDialog(parent)
-    , m_domain(domain)
+    , m_domains(domains)
 {
     setWindowTitle("Migrate Virtual Machine");
-    setMinimumSize(600, 400);
+    setMinimumSize(760, 560);
 
     setupUI();
 }
@@ -34,49 +82,55 @@ void MigrateDialog::setupUI()
     auto *mainLayout = new QVBoxLayout(this);
 
     // Title
-    QString vmName = m_domain ? m_domain->name() : tr("Unknown VM");
-    auto *titleLabel = new QLabel(QString("<h2>Migrate '%1'</h2>").arg(vmName));
+    QString title;
+    if (m_domains.size() == 1) {
+        title = QString("<h2>Migrate '%1'</h2>").arg(m_domains.first()->name().toHtmlEscaped());
+    } else {
+        title = QString("<h2>Migrate %1 VMs</h2>").arg(m_domains.size());
+    }
+    auto *titleLabel = new QLabel(title);
     titleLabel->setAlignment(Qt::AlignCenter);
     mainLayout->addWidget(titleLabel);
 
-    // Basic options group
-    setupBasicOptions();
-    auto *basicGroup = new QGroupBox("Basic Options", this);
-    auto *basicLayout = new QVBoxLayout(basicGroup);
-
-    // Connection type
-    auto *connTypeLayout = new QFormLayout();
-    m_connectionTypeCombo = new QComboBox();
-    m_connectionTypeCombo->addItem("Remote SSH", 0);
-    m_connectionTypeCombo->addItem("Remote TLS", 1);
-    m_connectionTypeCombo->addItem("Peer-to-Peer", 2);
-    m_connectionTypeCombo->setCurrentIndex(0);
-    connect(m_connectionTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
-            this, &MigrateDialog::onConnectionTypeChanged);
-    connTypeLayout->addRow("Connection Type:", m_connectionTypeCombo);
-
-    // Remote host
+    m_optionsWidget = new QWidget(this);
+    auto *optionsLayout = new QVBoxLayout(m_optionsWidget);
+    optionsLayout->setContentsMargins(0, 0, 0, 0);
+
+    // Destination
+    auto *basicGroup = new QGroupBox("Destination", m_optionsWidget);
+    auto *connTypeLayout = new QFormLayout(basicGroup);
+
+    m_transportCombo = new QComboBox();
+    m_transportCombo->addItem("SSH", MigrationManager::SSH);
+    m_transportCombo->addItem("TLS", MigrationManager::TLS);
+    m_transportCombo->addItem("TCP", MigrationManager::TCP);
+    m_transportCombo->setCurrentIndex(0);
+    connect(m_transportCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MigrateDialog::onTransportChanged);
+    connTypeLayout->addRow("Connection Type:", m_transportCombo);
+
     m_remoteHostEdit = new QLineEdit();
     m_remoteHostEdit->setPlaceholderText("example.com or 192.168.1.100");
     connTypeLayout->addRow("Remote Host:", m_remoteHostEdit);
 
-    // Remote port
     m_remotePortSpin = new QSpinBox();
     m_remotePortSpin->setRange(1, 65535);
     m_remotePortSpin->setValue(22);  // Default SSH port
     connTypeLayout->addRow("Remote Port:", m_remotePortSpin);
 
-    // Username (for SSH)
     m_usernameEdit = new QLineEdit();
     m_usernameEdit->setPlaceholderText("root");
     connTypeLayout->addRow("Username:", m_usernameEdit);
 
-    basicLayout->addLayout(connTypeLayout);
+    m_peerToPeerCheck = new QCheckBox("Peer-to-peer");
+    m_peerToPeerCheck->setToolTip("The source host connects to the destination itself, "
+                                  "instead of this application connecting to both");
+    connTypeLayout->addRow(m_peerToPeerCheck);
 
-    mainLayout->addWidget(basicGroup);
+    optionsLayout->addWidget(basicGroup);
 
     // Migration mode
-    auto *modeGroup = new QGroupBox("Migration Mode", this);
+    auto *modeGroup = new QGroupBox("Migration Mode", m_optionsWidget);
     auto *modeLayout = new QVBoxLayout(modeGroup);
 
     m_migrationModeGroup = new QButtonGroup(this);
@@ -87,36 +141,61 @@ void MigrateDialog::setupUI()
     connect(m_liveRadio, &QRadioButton::toggled, this, &MigrateDialog::onLiveMigrationToggled);
     m_migrationModeGroup->addButton(m_liveRadio, 0);
 
-    m_offlineRadio = new QRadioButton("Offline Migration (VM must be shut off)");
-    m_offlineRadio->setToolTip("Migrate the VM while it is shut off");
+    m_offlineRadio = new QRadioButton("Non-live Migration (VM is paused while it moves)");
+    m_offlineRadio->setToolTip("Faster, since memory is copied only once");
     m_migrationModeGroup->addButton(m_offlineRadio, 1);
 
     modeLayout->addWidget(m_liveRadio);
     modeLayout->addWidget(m_offlineRadio);
+    modeLayout->addWidget(new QLabel("Shut off VMs move as a definition only."));
 
-    mainLayout->addWidget(modeGroup);
+    optionsLayout->addWidget(modeGroup);
 
     // Advanced options
-    setupAdvancedOptions();
-    auto *advancedGroup = new QGroupBox("Advanced Options", this);
-    auto *advancedLayout = new QFormLayout(advancedGroup);
+    auto *advancedGroup = new QGroupBox("Advanced Options", m_optionsWidget);
+    auto *advancedLayout = new QGridLayout(advancedGroup);
 
     m_persistentCheck = new QCheckBox("Make VM persistent on destination");
     m_persistentCheck->setChecked(true);
     m_persistentCheck->setToolTip("VM configuration will be saved on the destination host");
-    advancedLayout->addRow(m_persistentCheck);
+    advancedLayout->addWidget(m_persistentCheck, 0, 0, 1, 2);
 
     m_undefineSourceCheck = new QCheckBox("Undefine VM from source host");
     m_undefineSourceCheck->setToolTip("Remove VM from source host after successful migration");
-    advancedLayout->addRow(m_undefineSourceCheck);
-
-    m_compressedCheck = new QCheckBox("Compress migration data");
-    m_compressedCheck->setToolTip("Reduce network bandwidth usage during migration");
-    advancedLayout->addRow(m_compressedCheck);
+    advancedLayout->addWidget(m_undefineSourceCheck, 1, 0, 1, 2);
 
     m_allowUnsafeCheck = new QCheckBox("Allow unsafe migration (no storage verification)");
     m_allowUnsafeCheck->setToolTip("Force migration even if storage is not properly shared");
-    advancedLayout->addRow(m_allowUnsafeCheck);
+    advancedLayout->addWidget(m_allowUnsafeCheck, 2, 0, 1, 2);
+
+    m_autoConvergeCheck = new QCheckBox("Auto-converge");
+    m_autoConvergeCheck->setToolTip("Slow down the guest's CPUs when it writes memory "
+                                    "faster than it can be sent");
+    advancedLayout->addWidget(m_autoConvergeCheck, 3, 0, 1, 2);
+
+    m_postCopyCheck = new QCheckBox("Allow post-copy");
+    m_postCopyCheck->setToolTip("The VM can be switched over to the destination before all "
+                                "memory is copied; the rest follows on demand");
+    advancedLayout->addWidget(m_postCopyCheck, 4, 0, 1, 2);
+
+    m_compressionCombo = new QComboBox();
+    m_compressionCombo->addItem("None", MigrationJob::NoCompression);
+    m_compressionCombo->addItem("XBZRLE", MigrationJob::Xbzrle);
+    m_compressionCombo->addItem("zstd", MigrationJob::Zstd);
+    m_compressionCombo->setToolTip("XBZRLE sends only the changes to pages sent before; "
+                                   "zstd needs parallel connections");
+    connect(m_compressionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MigrateDialog::onCompressionChanged);
+    advancedLayout->addWidget(new QLabel("Compression:"), 0, 2);
+    advancedLayout->addWidget(m_compressionCombo, 0, 3);
+
+    m_parallelSpin = new QSpinBox();
+    m_parallelSpin->setRange(1, 16);
+    m_parallelSpin->setValue(1);
+    m_parallelSpin->setSpecialValueText("Off");
+    m_parallelSpin->setToolTip("Connections memory is sent over at the same time");
+    advancedLayout->addWidget(new QLabel("Parallel Connections:"), 1, 2);
+    advancedLayout->addWidget(m_parallelSpin, 1, 3);
 
     m_bandwidthSpin = new QSpinBox();
     m_bandwidthSpin->setRange(0, 1000000);
@@ -124,16 +203,55 @@ void MigrateDialog::setupUI()
     m_bandwidthSpin->setSuffix(" MiB/s");
     m_bandwidthSpin->setSpecialValueText("Unlimited");
     m_bandwidthSpin->setToolTip("Limit migration bandwidth (0 = unlimited)");
-    advancedLayout->addRow("Bandwidth Limit:", m_bandwidthSpin);
+    advancedLayout->addWidget(new QLabel("Bandwidth Limit:"), 2, 2);
+    advancedLayout->addWidget(m_bandwidthSpin, 2, 3);
 
     m_maxDowntimeSpin = new QSpinBox();
-    m_maxDowntimeSpin->setRange(1, 10000);
-    m_maxDowntimeSpin->setValue(30);
+    m_maxDowntimeSpin->setRange(0, 10000);
+    m_maxDowntimeSpin->setValue(0);
     m_maxDowntimeSpin->setSuffix(" ms");
+    m_maxDowntimeSpin->setSpecialValueText("Default");
     m_maxDowntimeSpin->setToolTip("Maximum downtime allowed during live migration");
-    advancedLayout->addRow("Max Downtime:", m_maxDowntimeSpin);
+    advancedLayout->addWidget(new QLabel("Max Downtime:"), 3, 2);
+    advancedLayout->addWidget(m_maxDowntimeSpin, 3, 3);
+
+    m_postCopyAfterSpin = new QSpinBox();
+    m_postCopyAfterSpin->setRange(0, 100);
+    m_postCopyAfterSpin->setValue(0);
+    m_postCopyAfterSpin->setSuffix(" passes");
+    m_postCopyAfterSpin->setSpecialValueText("By hand");
+    m_postCopyAfterSpin->setToolTip("Switch to post-copy automatically once memory has been "
+                                    "sent this many times");
+    m_postCopyAfterSpin->setEnabled(false);
+    connect(m_postCopyCheck, &QCheckBox::toggled, m_postCopyAfterSpin, &QWidget::setEnabled);
+    advancedLayout->addWidget(new QLabel("Switch to Post-Copy:"), 4, 2);
+    advancedLayout->addWidget(m_postCopyAfterSpin, 4, 3);
+
+    m_concurrentSpin = new QSpinBox(this);
+    m_concurrentSpin->setRange(1, 16);
+    m_concurrentSpin->setValue(MigrationManager::instance()->maxConcurrent());
+    m_concurrentSpin->setToolTip("VMs migrated at the same time; the others wait in order");
+    if (m_domains.size() > 1) {
+        advancedLayout->addWidget(new QLabel("Simultaneous Migrations:"), 5, 2);
+        advancedLayout->addWidget(m_concurrentSpin, 5, 3);
+    } else {
+        m_concurrentSpin->hide();
+    }
 
-    mainLayout->addWidget(advancedGroup);
+    optionsLayout->addWidget(advancedGroup);
+    mainLayout->addWidget(m_optionsWidget);
+
+    // Progress, once started
+    m_jobList = new QTreeWidget(this);
+    m_jobList->setRootIsDecorated(false);
+    m_jobList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_jobList->setHeaderLabels({"VM", "State", "Progress", "Remaining Memory", "Dirty Rate",
+                                "Throughput", "Expected Downtime", "Pass"});
+    m_jobList->header()->setStretchLastSection(false);
+    m_jobList->setColumnWidth(ColumnVM, 140);
+    m_jobList->hide();
+    connect(m_jobList, &QTreeWidget::itemSelectionChanged, this, &MigrateDialog::updateButtons);
+    mainLayout->addWidget(m_jobList, 1);
 
     // Status label
     m_statusLabel = new QLabel("Ready to migrate");
@@ -142,6 +260,19 @@ void MigrateDialog::setupUI()
 
     // Buttons
     auto *buttonLayout = new QHBoxLayout();
+
+    m_btnPostCopy = new QPushButton("Switch to Post-Copy", this);
+    m_btnPostCopy->setToolTip("Run the VM on the destination now; cannot be aborted afterwards");
+    m_btnPostCopy->hide();
+    connect(m_btnPostCopy, &QPushButton::clicked, this, &MigrateDialog::onSwitchToPostCopy);
+    buttonLayout->addWidget(m_btnPostCopy);
+
+    m_btnAbort = new QPushButton("Abort", this);
+    m_btnAbort->setToolTip("Abort the selected migrations, or all of them");
+    m_btnAbort->hide();
+    connect(m_btnAbort, &QPushButton::clicked, this, &MigrateDialog::onAbort);
+    buttonLayout->addWidget(m_btnAbort);
+
     buttonLayout->addStretch();
 
     m_btnCancel = new QPushButton("Cancel", this);
@@ -151,69 +282,83 @@ void MigrateDialog::setupUI()
     m_btnMigrate = new QPushButton("Migrate", this);
     m_btnMigrate->setDefault(true);
     m_btnMigrate->setEnabled(false);
-    connect(m_btnMigrate, &QPushButton::clicked, this, &MigrateDialog::validateAndAccept);
+    connect(m_btnMigrate, &QPushButton::clicked, this, &MigrateDialog::onMigrate);
     buttonLayout->addWidget(m_btnMigrate);
 
     mainLayout->addLayout(buttonLayout);
 
     // Connect input changes to validation
     connect(m_remoteHostEdit, &QLineEdit::textChanged, [this]() {
-        m_btnMigrate->setEnabled(!m_remoteHostEdit->text().isEmpty());
+        m_btnMigrate->setEnabled(!m_remoteHostEdit->text().isEmpty() && !m_domains.isEmpty());
     });
 }
 
-void MigrateDialog::setupBasicOptions()
+MigrationJob::Options MigrateDialog::options() const
 {
-    // Setup is done in setupUI()
-}
-
-void MigrateDialog::setupAdvancedOptions()
-{
-    // Setup is done in setupUI()
-}
-
-void MigrateDialog::onAdvancedToggled(bool checked)
-{
-    Q_UNUSED(checked);
-    // Advanced options are always visible in this implementation
+    MigrationJob::Options options;
+    const auto transport =
+        static_cast<MigrationManager::Transport>(m_transportCombo->currentData().toInt());
+    options.destinationUri = MigrationManager::destinationUri(
+        transport, m_remoteHostEdit->text(), m_remotePortSpin->value(),
+        m_usernameEdit->text().trimmed());
+    options.live = m_liveRadio->isChecked();
+    options.peerToPeer = m_peerToPeerCheck->isChecked();
+    options.persistent = m_persistentCheck->isChecked();
+    options.undefineSource = m_undefineSourceCheck->isChecked();
+    options.allowUnsafe = m_allowUnsafeCheck->isChecked();
+    options.compression =
+        static_cast<MigrationJob::Compression>(m_compressionCombo->currentData().toInt());
+    options.parallelConnections = m_parallelSpin->value();
+    options.autoConverge = options.live && m_autoConvergeCheck->isChecked();
+    options.postCopy = options.live && m_postCopyCheck->isChecked();
+    options.postCopyAfterPasses = options.postCopy ? m_postCopyAfterSpin->value() : 0;
+    options.bandwidth = m_bandwidthSpin->value();
+    options.maxDowntime = options.live ? m_maxDowntimeSpin->value() : 0;
+    return options;
 }
 
 void MigrateDialog::onLiveMigrationToggled(bool checked)
 {
-    m_config.live = checked;
-
-    // Update max downtime availability
+    // Only a running guest keeps dirtying memory while it is copied
     m_maxDowntimeSpin->setEnabled(checked);
+    m_autoConvergeCheck->setEnabled(checked);
+    m_postCopyCheck->setEnabled(checked);
+    m_postCopyAfterSpin->setEnabled(checked && m_postCopyCheck->isChecked());
 
     // Update status
     if (checked) {
         m_statusLabel->setText("Live migration: VM will continue running with minimal downtime");
     } else {
-        m_statusLabel->setText("Offline migration: VM will be shut off before migration");
+        m_statusLabel->setText("Non-live migration: VM will be paused until it runs on the destination");
     }
 }
 
-void MigrateDialog::onConnectionTypeChanged()
+void MigrateDialog::onTransportChanged()
 {
-    int type = m_connectionTypeCombo->currentData().toInt();
-
-    switch (type) {
-        case 0:  // SSH
+    switch (m_transportCombo->currentData().toInt()) {
+        case MigrationManager::SSH:
             m_remotePortSpin->setValue(22);
             m_usernameEdit->setEnabled(true);
             break;
-        case 1:  // TLS
+        case MigrationManager::TLS:
             m_remotePortSpin->setValue(16514);
             m_usernameEdit->setEnabled(false);
             break;
-        case 2:  // Peer-to-Peer
+        case MigrationManager::TCP:
             m_remotePortSpin->setValue(16509);
             m_usernameEdit->setEnabled(false);
             break;
     }
 }
 
-void MigrateDialog::validateAndAccept()
+void MigrateDialog::onCompressionChanged()
+{
+    // QEMU compresses with zstd per multifd channel only
+    const bool zstd = m_compressionCombo->currentData().toInt() == MigrationJob::Zstd;
+    m_parallelSpin->setMinimum(zstd ? 2 : 1);
+}
+
+void MigrateDialog::onMigrate()
 {
     // Validate inputs
     if (m_remoteHostEdit->text().isEmpty()) {
@@ -221,73 +366,47 @@ void MigrateDialog::validateAndAccept()
         return;
     }
 
-    // Check domain state for live migration
-    if (m_domain) {
-        if (m_liveRadio->isChecked()) {
-            if (m_domain->state() != Domain::StateRunning) {
-                m_statusLabel->setText("<span style='color: red;'>Error: VM must be running for live migration</span>");
-                return;
-            }
-        } else {
-            if (m_domain->state() != Domain::StateShutOff) {
-                auto result = QMessageBox::warning(
-                    this,
-                    "VM Running",
-                    "The VM is currently running. It will be shut off before offline migration.\n\nContinue?",
-                    QMessageBox::Ok | QMessageBox::Cancel,
-                    QMessageBox::Cancel
-                );
-                if (result != QMessageBox::Ok) {
-                    return;
-                }
-            }
+    const MigrationJob::Options options = this->options();
+    QStringList running;
+    QStringList shutOff;
+    for (Domain *domain : m_domains) {
+        const bool active = isActive(domain);
+        (active ? running : shutOff).append(domain->name());
+        const QString error = MigrationManager::validate(options, active);
+        if (!error.isEmpty()) {
+            m_statusLabel->setText(QString("<span style='color: red;'>Error: %1</span>")
+                                       .arg(error.toHtmlEscaped()));
+            return;
         }
     }
 
-    // Build connection URI
-    QString uri;
-    int type = m_connectionTypeCombo->currentData().toInt();
-
-    switch (type) {
-        case 0:  // SSH
-            {
-                QString username = m_usernameEdit->text().isEmpty() ?
-                    QString() : m_usernameEdit->text() + "@";
-                uri = QString("qemu+ssh://%1%2/system").arg(username, m_remoteHostEdit->text());
-            }
-            break;
-        case 1:  // TLS
-            uri = QString("qemu+%1/system").arg(m_remoteHostEdit->text());
-            break;
-        case 2:  // Peer-to-Peer
-            uri = QString("qemu+tcp://%1/system").arg(m_remoteHostEdit->text());
-            break;
-    }
-
-    m_config.destinationUri = uri;
-    m_config.live = m_liveRadio->isChecked();
-    m_config.persistent = m_persistentCheck->isChecked();
-    m_config.undefineSource = m_undefineSourceCheck->isChecked();
-    m_config.compressed = m_compressedCheck->isChecked();
-    m_config.bandwidth = m_bandwidthSpin->value();
-    m_config.maxDowntime = m_maxDowntimeSpin->value();
-
     // Show summary
     QString summary = QString(
         "Migration Summary:\n"
         "• Destination: %1\n"
         "• Mode: %2\n"
         "• Persistent: %3\n"
-    ).arg(m_config.destinationUri)
-     .arg(m_config.live ? "Live" : "Offline")
-     .arg(m_config.persistent ? "Yes" : "No");
+    ).arg(options.destinationUri)
+     .arg(options.live ? "Live" : "Non-live")
+     .arg(options.persistent ? "Yes" : "No");
 
-    if (m_config.bandwidth > 0) {
-        summary += QString("• Bandwidth Limit: %1 MiB/s\n").arg(m_config.bandwidth);
+    if (options.bandwidth > 0) {
+        summary += QString("• Bandwidth Limit: %1 MiB/s\n").arg(options.bandwidth);
     }
-
-    if (m_config.live) {
-        summary += QString("• Max Downtime: %1 ms\n").arg(m_config.maxDowntime);
+    if (options.compression != MigrationJob::NoCompression) {
+        summary += QString("• Compression: %1\n").arg(m_compressionCombo->currentText());
+    }
+    if (options.parallelConnections > 1) {
+        summary += QString("• Parallel Connections: %1\n").arg(options.parallelConnections);
+    }
+    if (options.live && options.maxDowntime > 0) {
+        summary += QString("• Max Downtime: %1 ms\n").arg(options.maxDowntime);
+    }
+    if (!options.live && !running.isEmpty()) {
+        summary += QString("• Paused while moving: %1\n").arg(running.join(", "));
+    }
+    if (!shutOff.isEmpty()) {
+        summary += QString("• Definition only, shut off: %1\n").arg(shutOff.join(", "));
     }
 
     auto result = QMessageBox::information(
@@ -297,9 +416,147 @@ void MigrateDialog::validateAndAccept()
         QMessageBox::Ok | QMessageBox::Cancel,
         QMessageBox::Cancel
     );
+    if (result != QMessageBox::Ok) {
+        return;
+    }
+
+    MigrationManager *manager = MigrationManager::instance();
+    manager->clearFinished();
+    if (m_domains.size() > 1) {
+        manager->setMaxConcurrent(m_concurrentSpin->value());
+    }
+
+    for (Domain *domain : m_domains) {
+        MigrationJob *job = manager->migrate(domain, options);
+        m_jobs.append(job);
+
+        auto *item = new QTreeWidgetItem(m_jobList);
+        item->setText(ColumnVM, domain->name());
+        for (int column = ColumnProgress; column <= ColumnPasses; ++column) {
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+
+        connect(job, &MigrationJob::stateChanged, this, &MigrateDialog::updateJob);
+        connect(job, &MigrationJob::statsChanged, this, &MigrateDialog::updateJob);
+        updateJobRow(int(m_jobs.size()) - 1);
+    }
+
+    m_optionsWidget->hide();
+    m_jobList->show();
+    m_btnMigrate->hide();
+    m_btnAbort->show();
+    m_btnPostCopy->setVisible(options.postCopy);
+    m_btnCancel->setText("Close");
+    m_btnCancel->setToolTip("Migrations go on in the background");
+    updateButtons();
+}
+
+void MigrateDialog::updateJob()
+{
+    auto *job = qobject_cast<MigrationJob*>(sender());
+    const int row = int(m_jobs.indexOf(job));
+    if (row >= 0) {
+        updateJobRow(row);
+    }
+    updateButtons();
+}
+
+void MigrateDialog::updateJobRow(int row)
+{
+    MigrationJob *job = m_jobs.at(row);
+    QTreeWidgetItem *item = m_jobList->topLevelItem(row);
+    if (!job || !item) {
+        return;
+    }
+
+    const MigrationJob::Stats stats = job->stats();
+    item->setText(ColumnState, stateText(job));
+    item->setToolTip(ColumnState, job->errorString());
+
+    QString progress = "-";
+    if (job->state() == MigrationJob::Finished) {
+        progress = "100%";
+    } else if (stats.dataTotal > 0 && stats.dataRemaining >= 0) {
+        const qint64 sent = qMax<qint64>(0, stats.dataTotal - stats.dataRemaining);
+        progress = QString("%1%").arg(sent * 100 / stats.dataTotal);
+    }
+    item->setText(ColumnProgress, progress);
+    item->setText(ColumnRemaining, formatBytes(stats.memoryRemaining));
+
+    QString dirtyRate = formatByteRate(stats.dirtyRate);
+    if (stats.throttle > 0) {
+        dirtyRate += QString(" (CPU -%1%)").arg(stats.throttle);
+    }
+    item->setText(ColumnDirtyRate, dirtyRate);
+    item->setText(ColumnThroughput, formatByteRate(stats.throughput));
+    item->setText(ColumnDowntime, stats.downtimeMs < 0 ? QString("-")
+                                                       : QString("%1 ms").arg(stats.downtimeMs));
+    item->setText(ColumnPasses, stats.passes < 0 ? QString("-") : QString::number(stats.passes));
+}
+
+QList<MigrationJob*> MigrateDialog::selectedJobs() const
+{
+    QList<MigrationJob*> jobs;
+    const QList<QTreeWidgetItem*> selected = m_jobList->selectedItems();
+    for (int row = 0; row < m_jobs.size(); ++row) {
+        if (m_jobs.at(row) && (selected.isEmpty()
+                               || selected.contains(m_jobList->topLevelItem(row)))) {
+            jobs.append(m_jobs.at(row));
+        }
+    }
+    return jobs;
+}
+
+void MigrateDialog::updateButtons()
+{
+    bool cancellable = false;
+    bool switchable = false;
+    int active = 0;
+    const QList<MigrationJob*> jobs = selectedJobs();
+    for (MigrationJob *job : jobs) {
+        cancellable = cancellable || job->isCancellable();
+        switchable = switchable || job->canSwitchToPostCopy();
+    }
+    for (const QPointer<MigrationJob> &job : m_jobs) {
+        if (job && !job->isDone()) {
+            active++;
+        }
+    }
+
+    m_btnAbort->setEnabled(cancellable);
+    m_btnPostCopy->setEnabled(switchable);
+    if (!m_jobs.isEmpty()) {
+        m_statusLabel->setText(active > 0
+            ? QString("%1 of %2 migration(s) in progress").arg(active).arg(m_jobs.size())
+            : QString("All migrations done"));
+    }
+}
+
+void MigrateDialog::onAbort()
+{
+    const QList<MigrationJob*> jobs = selectedJobs();
+    for (MigrationJob *job : jobs) {
+        MigrationManager::instance()->cancel(job);
+    }
+}
+
+void MigrateDialog::onSwitchToPostCopy()
+{
+    auto result = QMessageBox::warning(
+        this,
+        "Switch to Post-Copy",
+        "The VMs will run on the destination while the rest of their memory follows.\n"
+        "If the network fails now, they are lost; they can no longer be aborted.\n\nContinue?",
+        QMessageBox::Ok | QMessageBox::Cancel,
+        QMessageBox::Cancel
+    );
+    if (result != QMessageBox::Ok) {
+        return;
+    }
 
-    if (result == QMessageBox::Ok) {
-        accept();
+    const QList<MigrationJob*> jobs = selectedJobs();
+    for (MigrationJob *job : jobs) {
+        MigrationManager::instance()->switchToPostCopy(job);
     }
 }
 
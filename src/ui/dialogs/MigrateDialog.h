@@ -25,16 +25,22 @@
 #include <QGroupBox>
 #include <QRadioButton>
 #include <QButtonGroup>
+#include <QTreeWidget>
+#include <QPointer>
 
 #include "../../libvirt/Connection.h"
 #include "../../libvirt/Domain.h"
+#include "../../libvirt/MigrationManager.h"
 
 namespace QVirt {
 
 /**
  * @brief VM Migration Dialog
  *
- * Dialog for migrating VMs between hosts
+ * Dialog for migrating one or more VMs to another host. The migrations
+ * run in MigrationManager and go on when the dialog is closed; while it
+ * is open, it shows their progress and can abort them or switch them
+ * to post-copy.
  */
 class MigrateDialog : public QDialog
 {
@@ -42,40 +48,35 @@ class MigrateDialog : public QDialog
 
 public:
     explicit MigrateDialog(Domain *domain, QWidget *parent = nullptr);
+    explicit MigrateDialog(const QList<Domain*> &domains, QWidget *parent = nullptr);
     ~MigrateDialog() override = default;
 
-    struct MigrationConfig {
-        QString destinationUri;
-        bool live = false;
-        bool persistent = true;
-        bool undefineSource = false;
-        bool compressed = false;
-        int bandwidth = 0;  // 0 = unlimited
-        int maxDowntime = 30;  // milliseconds
-    };
-
-    MigrationConfig config() const { return m_config; }
+    MigrationJob::Options options() const;
 
 private slots:
-    void validateAndAccept();
-    void onAdvancedToggled(bool checked);
+    void onMigrate();
     void onLiveMigrationToggled(bool checked);
-    void onConnectionTypeChanged();
+    void onTransportChanged();
+    void onCompressionChanged();
+    void onAbort();
+    void onSwitchToPostCopy();
+    void updateJob();
+    void updateButtons();
 
 private:
     void setupUI();
-    void setupBasicOptions();
-    void setupAdvancedOptions();
+    void updateJobRow(int row);
+    QList<MigrationJob*> selectedJobs() const;
 
-    Domain *m_domain;
-    MigrationConfig m_config;
+    QList<Domain*> m_domains;
+    QList<QPointer<MigrationJob>> m_jobs;
 
-    // Basic options
-    QComboBox *m_connectionTypeCombo;
+    // Destination
+    QComboBox *m_transportCombo;
     QLineEdit *m_remoteHostEdit;
     QSpinBox *m_remotePortSpin;
     QLineEdit *m_usernameEdit;
-    QLineEdit *m_passwordEdit;
+    QCheckBox *m_peerToPeerCheck;
 
     // Migration mode
     QButtonGroup *m_migrationModeGroup;
@@ -85,12 +86,22 @@ private:
     // Advanced options
     QCheckBox *m_persistentCheck;
     QCheckBox *m_undefineSourceCheck;
-    QCheckBox *m_compressedCheck;
     QCheckBox *m_allowUnsafeCheck;
+    QComboBox *m_compressionCombo;
+    QSpinBox *m_parallelSpin;
+    QCheckBox *m_autoConvergeCheck;
+    QCheckBox *m_postCopyCheck;
+    QSpinBox *m_postCopyAfterSpin;
     QSpinBox *m_bandwidthSpin;
     QSpinBox *m_maxDowntimeSpin;
+    QSpinBox *m_concurrentSpin;
+
+    QWidget *m_optionsWidget;
+    QTreeWidget *m_jobList;
 
     // Buttons
+    QPushButton *m_btnPostCopy;
+    QPushButton *m_btnAbort;
     QPushButton *m_btnMigrate;
     QPushButton *m_btnCancel;
 
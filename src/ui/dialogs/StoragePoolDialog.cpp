@@ -11,7 +11,14 @@
 
 #include "StoragePoolDialog.h"
 #include "../../core/Error.h"
+#include "../../core/ProgressDialog.h"
+#include "../../core/ImageInspector.h"
+#include "../../core/ByteFormat.h"
 #include "../../libvirt/EnumMapper.h"
+#include "../../libvirt/VolumeTransfer.h"
+#include "../../libvirt/StorageJobManager.h"
+#include "../models/VolumeListModel.h"
+#include "../widgets/StorageJobPanel.h"
 #include "../wizards/CreateVolumeWizard.h"
 
 #include <QHeaderView>
@@ -22,7 +29,11 @@
 #include <QGridLayout>
 #include <QGuiApplication>
 #include <QStandardItemModel>
+#include <QSortFilterProxyModel>
 #include <QItemSelectionModel>
+#include <QPointer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 #ifdef LIBVIRT_FOUND
 #include <libvirt/libvirt.h>
@@ -35,6 +46,8 @@ StoragePoolDialog::StoragePoolDialog(Connection *conn, QWidget *parent)
     , m_connection(conn)
     , m_currentPool(nullptr)
     , m_currentVolume(nullptr)
+    , m_scanBytes(-1)
+    , m_scanCancel(std::make_shared<std::atomic<bool>>(false))
 {
     setWindowTitle("Storage Pools");
     resize(900, 600);
@@ -48,6 +61,7 @@ StoragePoolDialog::~StoragePoolDialog()
     // Clear pointers to avoid dangling references
     // Note: We don't delete m_currentPool or m_currentVolume as they are owned by the Connection
     m_currentPool = nullptr;
+    m_scanCancel->store(true);
     m_currentVolume = nullptr;
 }
 
@@ -61,6 +75,9 @@ void StoragePoolDialog::setupUI()
     setupPoolsTab();
     setupVolumesTab();
 
+    // Jobs run on in the background after the dialog closes
+    m_tabWidget->addTab(new StorageJobPanel(StorageJobManager::instance(), m_tabWidget), "Jobs");
+
     mainLayout->addWidget(m_tabWidget);
 
     // Close button
@@ -158,10 +175,30 @@ void StoragePoolDialog::setupVolumesTab()
     auto *volumeGroup = new QGroupBox("Storage Volumes", volumesTab);
     auto *volumeLayout = new QVBoxLayout(volumeGroup);
 
+    m_volumeFilter = new QLineEdit(volumeGroup);
+    m_volumeFilter->setPlaceholderText("Filter by name");
+    m_volumeFilter->setClearButtonEnabled(true);
+    volumeLayout->addWidget(m_volumeFilter);
+
+    // Cells are formatted on demand; sizes sort by their byte values
+    m_volumeModel = new VolumeListModel(this);
+    m_volumeProxy = new QSortFilterProxyModel(this);
+    m_volumeProxy->setSourceModel(m_volumeModel);
+    m_volumeProxy->setSortRole(VolumeListModel::SortRole);
+    m_volumeProxy->setFilterKeyColumn(VolumeListModel::ColumnName);
+    m_volumeProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    connect(m_volumeFilter, &QLineEdit::textChanged,
+            m_volumeProxy, &QSortFilterProxyModel::setFilterFixedString);
+
     m_volumeList = new QTableView(volumeGroup);
+    m_volumeList->setModel(m_volumeProxy);
     m_volumeList->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_volumeList->setSelectionMode(QAbstractItemView::SingleSelection);
     m_volumeList->setAlternatingRowColors(true);
+    m_volumeList->setSortingEnabled(true);
+    m_volumeList->sortByColumn(VolumeListModel::ColumnName, Qt::AscendingOrder);
+    m_volumeList->horizontalHeader()->setStretchLastSection(true);
+    m_volumeList->horizontalHeader()->resizeSection(VolumeListModel::ColumnName, 220);
     connect(m_volumeList, &QTableView::clicked, this, &StoragePoolDialog::onVolumeSelected);
 
     volumeLayout->addWidget(m_volumeList);
@@ -180,6 +217,9 @@ void StoragePoolDialog::setupVolumesTab()
     m_btnVolumeUpload = new QPushButton("Upload", volumeGroup);
     m_btnVolumeClone = new QPushButton("Clone", volumeGroup);
     m_btnVolumeWipe = new QPushButton("Wipe", volumeGroup);
+    m_btnVolumeResize = new QPushButton("Resize", volumeGroup);
+    m_btnVolumeScan = new QPushButton("Scan Allocation", volumeGroup);
+    m_btnVolumeScan->setToolTip("Count the data the image holds by reading its allocation tables");
     m_btnRefreshVolumes = new QPushButton("Refresh", volumeGroup);
 
     connect(m_btnVolumeCreate, &QPushButton::clicked, this, &StoragePoolDialog::onVolumeCreate);
@@ -188,6 +228,8 @@ void StoragePoolDialog::setupVolumesTab()
     connect(m_btnVolumeUpload, &QPushButton::clicked, this, &StoragePoolDialog::onVolumeUpload);
     connect(m_btnVolumeClone, &QPushButton::clicked, this, &StoragePoolDialog::onVolumeClone);
     connect(m_btnVolumeWipe, &QPushButton::clicked, this, &StoragePoolDialog::onVolumeWipe);
+    connect(m_btnVolumeResize, &QPushButton::clicked, this, &StoragePoolDialog::onVolumeResize);
+    connect(m_btnVolumeScan, &QPushButton::clicked, this, &StoragePoolDialog::onVolumeScan);
     connect(m_btnRefreshVolumes, &QPushButton::clicked, this, &StoragePoolDialog::onRefresh);
 
     buttonLayout->addWidget(m_btnVolumeCreate);
@@ -196,6 +238,8 @@ void StoragePoolDialog::setupVolumesTab()
     buttonLayout->addWidget(m_btnVolumeUpload);
     buttonLayout->addWidget(m_btnVolumeClone);
     buttonLayout->addWidget(m_btnVolumeWipe);
+    buttonLayout->addWidget(m_btnVolumeResize);
+    buttonLayout->addWidget(m_btnVolumeScan);
     buttonLayout->addStretch();
     buttonLayout->addWidget(m_btnRefreshVolumes);
 
@@ -212,6 +256,8 @@ void StoragePoolDialog::setupVolumesTab()
     m_btnVolumeUpload->setEnabled(false);
     m_btnVolumeClone->setEnabled(false);
     m_btnVolumeWipe->setEnabled(false);
+    m_btnVolumeResize->setEnabled(false);
+    m_btnVolumeScan->setEnabled(false);
 }
 
 void StoragePoolDialog::updatePoolList()
@@ -250,17 +296,10 @@ void StoragePoolDialog::updatePoolList()
         // Type
         row.append(new QStandardItem(EnumMapper::poolTypeToString(pool->type())));
 
-        // Capacity (in GB)
-        double capacityGB = pool->capacity() / (1024.0 * 1024 * 1024);
-        row.append(new QStandardItem(QString("%1 GB").arg(capacityGB, 0, 'f', 2)));
-
-        // Allocated (in GB)
-        double allocatedGB = pool->allocation() / (1024.0 * 1024 * 1024);
-        row.append(new QStandardItem(QString("%1 GB").arg(allocatedGB, 0, 'f', 2)));
-
-        // Available (in GB)
-        double availableGB = pool->available() / (1024.0 * 1024 * 1024);
-        row.append(new QStandardItem(QString("%1 GB").arg(availableGB, 0, 'f', 2)));
+        // Capacity, allocated and available
+        row.append(new QStandardItem(formatBytes(pool->capacity())));
+        row.append(new QStandardItem(formatBytes(pool->allocation())));
+        row.append(new QStandardItem(formatBytes(pool->available())));
 
         model->appendRow(row);
     }
@@ -273,47 +312,21 @@ void StoragePoolDialog::updatePoolList()
 void StoragePoolDialog::updateVolumeList()
 {
     if (!m_currentPool) {
+        m_volumeModel->setPool(nullptr);
+        m_currentVolume = nullptr;
         m_volumeInfoLabel->setText("Select a pool to view volumes");
         return;
     }
 
-    // Get list of volumes from pool
-    QList<StorageVolume*> volumes = m_currentPool->volumes();
-
-    // Create table model
-    auto *model = new QStandardItemModel(this);
-    model->setHorizontalHeaderLabels({"Name", "Type", "Capacity", "Allocation", "Path"});
-
-    for (StorageVolume *volume : volumes) {
-        if (!volume) {
-            continue;
-        }
-
-        QList<QStandardItem*> row;
-
-        // Name
-        row.append(new QStandardItem(volume->name()));
-
-        // Type
-        row.append(new QStandardItem(EnumMapper::volumeTypeToString(volume->type())));
-
-        // Capacity (in GB)
-        double capacityGB = volume->capacity() / (1024.0 * 1024 * 1024);
-        row.append(new QStandardItem(QString("%1 GB").arg(capacityGB, 0, 'f', 2)));
-
-        // Allocation (in GB)
-        double allocationGB = volume->allocation() / (1024.0 * 1024 * 1024);
-        row.append(new QStandardItem(QString("%1 GB").arg(allocationGB, 0, 'f', 2)));
-
-        // Path
-        row.append(new QStandardItem(volume->path()));
-
-        model->appendRow(row);
+    // Re-list the pool; known volumes keep their wrappers and the model
+    // only inserts and removes the rows that changed
+    m_currentPool->refreshVolumes();
+    m_volumeModel->setPool(m_currentPool);
+    if (m_volumeModel->rowOf(m_currentVolume) < 0) {
+        m_currentVolume = nullptr;
     }
 
-    m_volumeList->setModel(model);
-    m_volumeList->resizeColumnsToContents();
-    m_volumeInfoLabel->setText(QString("Found %1 volume(s)").arg(volumes.size()));
+    m_volumeInfoLabel->setText(QString("Found %1 volume(s)").arg(m_volumeModel->rowCount()));
 }
 
 void StoragePoolDialog::updatePoolInfo()
@@ -327,9 +340,9 @@ void StoragePoolDialog::updatePoolInfo()
     info += QString("<b>UUID:</b> %1<br>").arg(m_currentPool->uuid());
     info += QString("<b>State:</b> %1<br>").arg(EnumMapper::poolStateToString(m_currentPool->state()));
     info += QString("<b>Type:</b> %1<br>").arg(EnumMapper::poolTypeToString(m_currentPool->type()));
-    info += QString("<b>Capacity:</b> %1 GB<br>").arg(m_currentPool->capacity() / (1024.0 * 1024 * 1024), 0, 'f', 2);
-    info += QString("<b>Allocation:</b> %1 GB<br>").arg(m_currentPool->allocation() / (1024.0 * 1024 * 1024), 0, 'f', 2);
-    info += QString("<b>Available:</b> %1 GB").arg(m_currentPool->available() / (1024.0 * 1024 * 1024), 0, 'f', 2);
+    info += QString("<b>Capacity:</b> %1<br>").arg(formatBytes(m_currentPool->capacity()));
+    info += QString("<b>Allocation:</b> %1<br>").arg(formatBytes(m_currentPool->allocation()));
+    info += QString("<b>Available:</b> %1").arg(formatBytes(m_currentPool->available()));
 
     m_poolInfoLabel->setText(info);
 
@@ -345,14 +358,28 @@ void StoragePoolDialog::updateVolumeInfo()
 {
     if (!m_currentVolume) {
         m_volumeInfoLabel->setText("Select a volume to view details");
+        m_btnVolumeScan->setEnabled(false);
         return;
     }
 
+    // Local images are read directly: no XML round trip, and the chain comes along
+    const bool localFile = m_connection && m_connection->isLocal()
+                           && m_currentVolume->type() == StorageVolume::TypeFile;
+    const QString path = localFile ? m_currentVolume->path() : QString();
+    if (!path.isEmpty() && path != m_chainPath) {
+        loadBackingChain(path);
+    }
+    const QString imageInfo = path.isEmpty() ? QString() : localImageInfo(path);
+
     QString info = QString("<b>Volume:</b> %1<br>").arg(m_currentVolume->name());
     info += QString("<b>Type:</b> %1<br>").arg(EnumMapper::volumeTypeToString(m_currentVolume->type()));
-    info += QString("<b>Capacity:</b> %1 GB<br>").arg(m_currentVolume->capacity() / (1024.0 * 1024 * 1024), 0, 'f', 2);
-    info += QString("<b>Allocation:</b> %1 GB<br>").arg(m_currentVolume->allocation() / (1024.0 * 1024 * 1024), 0, 'f', 2);
-    info += QString("<b>Format:</b> %1").arg(m_currentVolume->format());
+    info += QString("<b>Capacity:</b> %1<br>").arg(formatBytes(m_currentVolume->capacity()));
+    info += QString("<b>Allocation:</b> %1").arg(formatBytes(m_currentVolume->allocation()));
+    if (imageInfo.isEmpty()) {
+        info += QString("<br><b>Format:</b> %1").arg(m_currentVolume->format());
+    } else {
+        info += imageInfo;
+    }
 
     m_volumeInfoLabel->setText(info);
 
@@ -362,6 +389,107 @@ void StoragePoolDialog::updateVolumeInfo()
     m_btnVolumeUpload->setEnabled(true);
     m_btnVolumeClone->setEnabled(true);
     m_btnVolumeWipe->setEnabled(true);
+    m_btnVolumeResize->setEnabled(true);
+    m_btnVolumeScan->setEnabled(!imageInfo.isEmpty());
+}
+
+QString StoragePoolDialog::localImageInfo(const QString &path) const
+{
+    const QList<ImageInfo> &chain = m_chain;
+    if (m_chainPath != path || chain.isEmpty() || !chain.first().isReadable()) {
+        return QString();
+    }
+
+    // A header that is not recognised says nothing; keep libvirt's format then
+    const ImageInfo &top = chain.first();
+    QString info = QString("<br><b>Format:</b> %1")
+                       .arg(top.isValid() ? top.formatName() : m_currentVolume->format());
+    if (top.format == ImageInfo::FormatQcow2) {
+        info += QString(" v%1, %2 clusters, %3-bit refcounts")
+                    .arg(top.version).arg(formatBytes(top.clusterSize())).arg(top.refcountBits);
+        if (top.isDirty()) {
+            info += ", <b>dirty</b>";
+        }
+        if (top.isCorrupt()) {
+            info += ", <b>marked corrupt</b>";
+        }
+    }
+    info += QString("<br><b>Host usage:</b> %1").arg(formatBytes(top.allocation));
+    if (m_scanPath == path && m_scanBytes >= 0) {
+        info += QString("<br><b>Guest data:</b> %1").arg(formatBytes(m_scanBytes));
+    }
+
+    if (chain.size() > 1 || !top.backingFile.isEmpty()) {
+        QStringList links;
+        for (int i = 1; i < chain.size(); ++i) {
+            const ImageInfo &image = chain.at(i);
+            const QString format = image.isValid() ? image.formatName()
+                                   : image.isReadable() ? QString("unknown format")
+                                   : image.error.toHtmlEscaped();
+            links << QString("%1 (%2)").arg(image.path.toHtmlEscaped(), format);
+        }
+        // A remote backing file ends the chain without an entry of its own
+        const ImageInfo &last = chain.last();
+        if (last.isValid() && !last.backingFile.isEmpty()
+            && ImageInspector::resolveBackingFile(last).isEmpty()) {
+            links << last.backingFile.toHtmlEscaped();
+        }
+        info += QString("<br><b>Backing chain:</b> %1").arg(links.join(" &rarr; "));
+    }
+    return info;
+}
+
+void StoragePoolDialog::loadBackingChain(const QString &path)
+{
+    m_chainPath = path;
+    m_chain.clear();
+
+    // Each image of the chain is opened and its header read: not on the GUI thread
+    auto *watcher = new QFutureWatcher<QList<ImageInfo>>(this);
+    connect(watcher, &QFutureWatcher<QList<ImageInfo>>::finished, this, [this, watcher, path]() {
+        watcher->deleteLater();
+        if (m_chainPath != path) {
+            return;
+        }
+        m_chain = watcher->result();
+        if (m_currentVolume && m_currentVolume->path() == path) {
+            updateVolumeInfo();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([path]() {
+        return ImageInspector::backingChain(path);
+    }));
+}
+
+void StoragePoolDialog::onVolumeScan()
+{
+    if (!m_currentVolume) {
+        return;
+    }
+
+    const QString path = m_currentVolume->path();
+    m_btnVolumeScan->setEnabled(false);
+    m_btnVolumeScan->setText("Scanning...");
+
+    // Reads every allocation table of the image: keep it off the GUI thread
+    std::shared_ptr<std::atomic<bool>> cancel = m_scanCancel;
+    auto *watcher = new QFutureWatcher<qint64>(this);
+    connect(watcher, &QFutureWatcher<qint64>::finished, this, [this, watcher, path]() {
+        m_scanPath = path;
+        m_scanBytes = watcher->result();
+        m_btnVolumeScan->setText("Scan Allocation");
+        if (m_currentVolume && m_currentVolume->path() == path) {
+            updateVolumeInfo();
+            if (m_scanBytes < 0) {
+                m_volumeInfoLabel->setText(m_volumeInfoLabel->text()
+                    + QString("<br><b>Guest data:</b> the image could not be scanned"));
+            }
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([path, cancel]() {
+        return ImageInspector::scanAllocation(path, cancel.get());
+    }));
 }
 
 void StoragePoolDialog::onPoolSelected()
@@ -408,19 +536,12 @@ void StoragePoolDialog::onVolumeSelected()
         return;
     }
 
-    // Get the volume name from the first column of the selected row
-    QModelIndex index = selectedIndexes.first();
-    QAbstractItemModel *model = m_volumeList->model();
-    QString volumeName = model->data(model->index(index.row(), 0)).toString();
-
-    // Find the volume by name
-    QList<StorageVolume*> volumes = m_currentPool->volumes();
-    for (StorageVolume *volume : volumes) {
-        if (volume && volume->name() == volumeName) {
-            m_currentVolume = volume;
-            updateVolumeInfo();
-            break;
-        }
+    // Map the selected row back to its cached wrapper
+    QModelIndex index = m_volumeProxy->mapToSource(selectedIndexes.first());
+    if (StorageVolume *volume = m_volumeModel->volumeAt(index.row())) {
+        m_currentVolume = volume;
+        m_chainPath.clear();        // Read the chain again, it may have changed
+        updateVolumeInfo();
     }
 }
 
@@ -454,6 +575,7 @@ void StoragePoolDialog::onPoolStop()
         if (m_currentPool->stop()) {
             m_poolInfoLabel->setText(QString("Pool '%1' stopped").arg(m_currentPool->name()));
             updatePoolInfo();
+            updateVolumeList();
         } else {
             QMessageBox::warning(this, "Failed to Stop Pool",
                 QString("Failed to stop pool '%1'").arg(m_currentPool->name()));
@@ -514,31 +636,9 @@ void StoragePoolDialog::onVolumeCreate()
         QString format = dialog.volumeFormat();
 
 #ifdef LIBVIRT_FOUND
-        // Generate volume XML
-        QString xml = QString("<volume>\n"
-                              "  <name>%1</name>\n"
-                              "  <capacity unit='bytes'>%2</capacity>\n"
-                              "  <allocation unit='bytes'>%3</allocation>\n"
-                              "  <target>\n"
-                              "    <format type='%4'/>\n"
-                              "  </target>\n"
-                              "</volume>")
-                          .arg(name)
-                          .arg(capacity)
-                          .arg(allocation)
-                          .arg(format);
-
-        QByteArray xmlBytes = xml.toUtf8();
-        virStorageVolPtr vol = virStorageVolCreateXML(m_currentPool->virPool(),
-                                                        xmlBytes.constData(), 0);
-        if (vol) {
-            virStorageVolFree(vol);
-            m_volumeInfoLabel->setText(QString("Volume '%1' created successfully").arg(name));
-            updateVolumeList();
-        } else {
-            QMessageBox::warning(this, "Failed to Create Volume",
-                QString("Failed to create volume '%1'").arg(name));
-        }
+        StorageJob *job = StorageJobManager::instance()->createVolume(
+            m_currentPool, name, capacity, allocation, format);
+        trackJob(job, QString("Creating volume '%1'").arg(name));
 #else
         Q_UNUSED(name);
         Q_UNUSED(capacity);
@@ -586,19 +686,45 @@ void StoragePoolDialog::onVolumeDownload()
     QString filename = QFileDialog::getSaveFileName(this, "Save Volume",
         m_currentVolume->name() + ".img");
 
-    if (!filename.isEmpty()) {
-        // Use the download function from StorageVolume
-        if (m_currentVolume->download(filename)) {
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    const QString volumeName = m_currentVolume->name();
+    auto *transfer = new VolumeTransfer(m_currentVolume, VolumeTransfer::Download, filename, this);
+    QPointer<ProgressDialog> progress = trackTransfer(transfer, "Download Volume",
+        QString("Downloading volume '%1' to '%2'").arg(volumeName).arg(filename),
+        m_currentVolume->allocation());
+
+    connect(transfer, &VolumeTransfer::finished, this,
+            [this, progress, transfer, filename, volumeName](bool success) {
+        if (success) {
             m_volumeInfoLabel->setText(
-                QString("Volume '%1' downloaded to '%2'").arg(m_currentVolume->name()).arg(filename));
-            QMessageBox::information(this, "Download Complete",
-                QString("Successfully downloaded volume '%1' to '%2'")
-                    .arg(m_currentVolume->name()).arg(filename));
+                QString("Volume '%1' downloaded to '%2' (%3 of holes skipped)")
+                    .arg(volumeName).arg(filename).arg(formatBytes(transfer->holeBytes())));
+            if (progress) {
+                progress->finishJob();
+            }
+        } else if (transfer->state() == VolumeTransfer::Cancelled) {
+            if (progress) {
+                progress->close();
+            }
+        } else if (progress) {
+            progress->setError(transfer->errorString());
         } else {
-            QMessageBox::warning(this, "Download Failed",
-                QString("Failed to download volume '%1'").arg(m_currentVolume->name()));
+            QMessageBox::warning(this, "Download Failed", transfer->errorString());
         }
+        transfer->deleteLater();
+    });
+
+    if (!transfer->start()) {
+        QMessageBox::warning(this, "Download Failed",
+            QString("Failed to download volume '%1': %2").arg(volumeName).arg(transfer->errorString()));
+        delete progress;
+        delete transfer;
+        return;
     }
+    progress->startJob();
 }
 
 void StoragePoolDialog::onVolumeUpload()
@@ -630,10 +756,11 @@ void StoragePoolDialog::onVolumeUpload()
     qint64 fileSize = fileInfo.size();
 
 #ifdef LIBVIRT_FOUND
-    // Generate volume XML
+    // Allocation 0 keeps the volume sparse; the upload fills in only the data
     QString xml = QString("<volume>\n"
                           "  <name>%1</name>\n"
                           "  <capacity unit='bytes'>%2</capacity>\n"
+                          "  <allocation unit='bytes'>0</allocation>\n"
                           "  <target>\n"
                           "    <format type='raw'/>\n"
                           "  </target>\n"
@@ -650,26 +777,75 @@ void StoragePoolDialog::onVolumeUpload()
         return;
     }
 
-    // Create a temporary StorageVolume wrapper to use the upload function
-    StorageVolume *tempVolume = new StorageVolume(vol, m_currentPool, this);
-    if (tempVolume->upload(filename)) {
-        m_volumeInfoLabel->setText(
-            QString("File '%1' uploaded to volume '%2'").arg(filename).arg(volumeName));
-        QMessageBox::information(this, "Upload Complete",
-            QString("Successfully uploaded '%1' to volume '%2'")
-                .arg(filename).arg(volumeName));
+    // The wrapper and transfer live until the upload ends
+    auto *volume = new StorageVolume(vol, m_currentPool, this);
+    auto *transfer = new VolumeTransfer(volume, VolumeTransfer::Upload, filename, volume);
+    QPointer<ProgressDialog> progress = trackTransfer(transfer, "Upload Volume",
+        QString("Uploading '%1' to volume '%2'").arg(filename).arg(volumeName),
+        VolumeTransfer::allocatedBytes(filename));
+
+    connect(transfer, &VolumeTransfer::finished, this,
+            [this, progress, transfer, volume, filename, volumeName](bool success) {
+        if (success) {
+            m_volumeInfoLabel->setText(
+                QString("File '%1' uploaded to volume '%2' (%3 of holes skipped)")
+                    .arg(filename).arg(volumeName).arg(formatBytes(transfer->holeBytes())));
+            if (progress) {
+                progress->finishJob();
+            }
+        } else if (transfer->state() == VolumeTransfer::Cancelled) {
+            // A partial upload is useless, remove the volume again
+            volume->delete_();
+            if (progress) {
+                progress->close();
+            }
+        } else if (progress) {
+            progress->setError(transfer->errorString());
+        } else {
+            QMessageBox::warning(this, "Upload Failed", transfer->errorString());
+        }
+        volume->deleteLater();
         updateVolumeList();
-    } else {
+    });
+
+    if (!transfer->start()) {
         QMessageBox::warning(this, "Upload Failed",
-            QString("Failed to upload file to volume '%1'").arg(volumeName));
+            QString("Failed to upload file to volume '%1': %2")
+                .arg(volumeName).arg(transfer->errorString()));
+        volume->delete_();
+        delete volume;
+        delete progress;
+        return;
     }
-    delete tempVolume;
+    progress->startJob();
 #else
     Q_UNUSED(fileSize);
     QMessageBox::information(this, "Upload Volume", "libvirt not available");
 #endif
 }
 
+ProgressDialog *StoragePoolDialog::trackTransfer(VolumeTransfer *transfer, const QString &title,
+                                                 const QString &text, qint64 dataSize)
+{
+    auto *progress = new ProgressDialog(title, text, this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+
+    connect(transfer, &VolumeTransfer::progress, progress,
+            [progress, transfer, dataSize](qint64 processed, qint64 total) {
+        int percent = total > 0 ? int(processed * 100 / total) : 0;
+        QString status = QString("%1 of %2 data transferred, %3/s")
+                             .arg(formatBytes(transfer->dataBytes()))
+                             .arg(formatBytes(qMax<qint64>(dataSize, transfer->dataBytes())))
+                             .arg(formatBytes(qint64(transfer->bytesPerSecond())));
+        if (transfer->etaMs() >= 0) {
+            status += QString(", %1 s left").arg(transfer->etaMs() / 1000);
+        }
+        progress->updateProgress(qMin(percent, 99), status);
+    });
+    connect(progress, &ProgressDialog::cancelRequested, transfer, &VolumeTransfer::cancel);
+    return progress;
+}
+
 void StoragePoolDialog::onVolumeClone()
 {
     if (!m_currentVolume) {
@@ -682,20 +858,8 @@ void StoragePoolDialog::onVolumeClone()
         m_currentVolume->name() + "-clone", &ok);
 
     if (ok && !newName.isEmpty()) {
-        // Use the clone function from StorageVolume
-        StorageVolume *clonedVolume = m_currentVolume->clone(newName);
-        if (clonedVolume) {
-            m_volumeInfoLabel->setText(
-                QString("Volume '%1' cloned to '%2'").arg(m_currentVolume->name()).arg(newName));
-            QMessageBox::information(this, "Clone Complete",
-                QString("Successfully cloned volume '%1' to '%2'")
-                    .arg(m_currentVolume->name()).arg(newName));
-            delete clonedVolume; // We don't need to keep the wrapper
-            updateVolumeList();
-        } else {
-            QMessageBox::warning(this, "Clone Failed",
-                QString("Failed to clone volume '%1'").arg(m_currentVolume->name()));
-        }
+        StorageJob *job = StorageJobManager::instance()->cloneVolume(m_currentVolume, newName);
+        trackJob(job, QString("Cloning volume '%1' to '%2'").arg(m_currentVolume->name()).arg(newName));
     }
 }
 
@@ -711,17 +875,57 @@ void StoragePoolDialog::onVolumeWipe()
         QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        // Use the wipe function from StorageVolume
-        if (m_currentVolume->wipe()) {
-            m_volumeInfoLabel->setText(QString("Volume '%1' wiped").arg(m_currentVolume->name()));
-            QMessageBox::information(this, "Wipe Complete",
-                QString("Successfully wiped volume '%1'").arg(m_currentVolume->name()));
-            updateVolumeList();
-        } else {
-            QMessageBox::warning(this, "Wipe Failed",
-                QString("Failed to wipe volume '%1'").arg(m_currentVolume->name()));
-        }
+        StorageJob *job = StorageJobManager::instance()->wipeVolume(m_currentVolume);
+        trackJob(job, QString("Wiping volume '%1'").arg(m_currentVolume->name()));
+    }
+}
+
+void StoragePoolDialog::onVolumeResize()
+{
+    if (!m_currentVolume) {
+        return;
     }
+
+    const double gib = 1024.0 * 1024 * 1024;
+    bool ok;
+    double sizeGB = QInputDialog::getDouble(this, "Resize Volume",
+        QString("New capacity of volume '%1' (GB):").arg(m_currentVolume->name()),
+        m_currentVolume->capacity() / gib, 0.01, 1024.0 * 1024, 2, &ok);
+    if (!ok) {
+        return;
+    }
+
+    qint64 capacity = qint64(sizeGB * gib);
+    unsigned int flags = 0;
+#ifdef LIBVIRT_FOUND
+    if (capacity < m_currentVolume->capacity()) {
+        flags |= VIR_STORAGE_VOL_RESIZE_SHRINK;
+    }
+#endif
+    StorageJob *job = StorageJobManager::instance()->resizeVolume(m_currentVolume, capacity, flags);
+    trackJob(job, QString("Resizing volume '%1' to %2").arg(m_currentVolume->name())
+                      .arg(formatBytes(capacity)));
+}
+
+void StoragePoolDialog::trackJob(StorageJob *job, const QString &text)
+{
+    m_volumeInfoLabel->setText(text + " (see the Jobs tab)");
+
+    connect(job, &StorageJob::stateChanged, this, [this, job](StorageJob::State state) {
+        if (state == StorageJob::Finished) {
+            m_volumeInfoLabel->setText(QString("%1: done%2").arg(job->description())
+                .arg(job->usedReflink() ? " (reflink)" : ""));
+            if (m_currentVolume && m_currentVolume->name() == job->volumeName()) {
+                updateVolumeInfo();
+            }
+        } else if (state == StorageJob::Failed) {
+            m_volumeInfoLabel->setText(QString("%1: failed").arg(job->description()));
+            QMessageBox::warning(this, "Storage Job Failed",
+                QString("%1 failed: %2").arg(job->description()).arg(job->errorString()));
+        } else if (state == StorageJob::Cancelled) {
+            m_volumeInfoLabel->setText(QString("%1: cancelled").arg(job->description()));
+        }
+    });
 }
 
 void StoragePoolDialog::onRefresh()
@@ -834,10 +1038,8 @@ void CreateVolumeDialog::setupUI()
 
     // Information about available space
     if (m_pool) {
-        qint64 availableGB = m_pool->available() / (1024 * 1024 * 1024);
         auto *infoLabel = new QLabel(
-            QString("Available space in pool: %1 GB").arg(static_cast<double>(availableGB), 0, 'f', 2),
-            this);
+            QString("Available space in pool: %1").arg(formatBytes(m_pool->available())), this);
         infoLabel->setWordWrap(true);
         layout->addWidget(infoLabel);
     }
@@ -26,13 +26,23 @@
 #include <QTextEdit>
 #include <QMenu>
 #include <QAction>
+#include <atomic>
+#include <memory>
 
 #include "../../libvirt/Connection.h"
 #include "../../libvirt/StoragePool.h"
 #include "../../libvirt/StorageVolume.h"
+#include "../../core/ImageInspector.h"
+
+class QSortFilterProxyModel;
 
 namespace QVirt {
 
+class ProgressDialog;
+class StorageJob;
+class VolumeListModel;
+class VolumeTransfer;
+
 /**
  * @brief Storage Pool Management Dialog
  *
@@ -59,6 +69,8 @@ private slots:
     void onVolumeUpload();
     void onVolumeClone();
     void onVolumeWipe();
+    void onVolumeResize();
+    void onVolumeScan();
     void onRefresh();
     void onContextMenuRequested(const QPoint &pos);
 
@@ -70,7 +82,12 @@ private:
     void updateVolumeList();
     void updatePoolInfo();
     void updateVolumeInfo();
+    QString localImageInfo(const QString &path) const;
+    void loadBackingChain(const QString &path);
     void createVolume();
+    ProgressDialog *trackTransfer(VolumeTransfer *transfer, const QString &title,
+                                  const QString &text, qint64 dataSize);
+    void trackJob(StorageJob *job, const QString &text);
 
     Connection *m_connection;
     StoragePool *m_currentPool;
@@ -89,7 +106,10 @@ private:
     QPushButton *m_btnRefreshPools;
 
     // Volumes tab
+    QLineEdit *m_volumeFilter;
     QTableView *m_volumeList;
+    VolumeListModel *m_volumeModel;
+    QSortFilterProxyModel *m_volumeProxy;
     QLabel *m_volumeInfoLabel;
     QPushButton *m_btnVolumeCreate;
     QPushButton *m_btnVolumeDelete;
@@ -97,8 +117,19 @@ private:
     QPushButton *m_btnVolumeUpload;
     QPushButton *m_btnVolumeClone;
     QPushButton *m_btnVolumeWipe;
+    QPushButton *m_btnVolumeResize;
+    QPushButton *m_btnVolumeScan;
     QPushButton *m_btnRefreshVolumes;
 
+    // Backing chain of the selected local image, read in the background
+    QString m_chainPath;
+    QList<ImageInfo> m_chain;
+
+    // Last full allocation scan of a local image
+    QString m_scanPath;
+    qint64 m_scanBytes;
+    std::shared_ptr<std::atomic<bool>> m_scanCancel;
+
     // Context menu
     QMenu *m_contextMenu;
     QAction *m_actionStart;
@@ -17,19 +17,28 @@
 #include "../dialogs/ConnectionProgressDialog.h"
 #include "../widgets/ContextMenu.h"
 #include "../widgets/GraphWidget.h"
+#include "../widgets/FleetDashboardView.h"
+#include "../widgets/BlockJobPanel.h"
 #include "../vmwindow/VMWindow.h"
 #include "../wizards/CreateVMWizard.h"
 #include "../dialogs/HostDialog.h"
 #include "../dialogs/DeleteDialog.h"
+#include "../dialogs/GroupSnapshotDialog.h"
+#include "../dialogs/MigrateDialog.h"
 #include "../../core/Engine.h"
 #include "../../core/Config.h"
 #include "../../libvirt/EnumMapper.h"
+#include "../../libvirt/ThumbnailService.h"
+#include "../../libvirt/BlockJobManager.h"
+#include "../../libvirt/BackupManager.h"
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QMenu>
 #include <QStatusBar>
 #include <QFile>
 #include <QApplication>
+#include <QDialog>
+#include <QVBoxLayout>
 
 namespace QVirt {
 
@@ -43,6 +52,10 @@ ManagerWindow::ManagerWindow(QWidget *parent)
     , m_actionPause(nullptr)
     , m_actionResume(nullptr)
     , m_actionOpenConsole(nullptr)
+    , m_dashboardView(nullptr)
+    , m_dashboardModel(nullptr)
+    , m_actionDashboard(nullptr)
+    , m_thumbnails(nullptr)
 {
     setWindowTitle(tr("QVirt Manager"));
     resize(1024, 768);
@@ -93,6 +106,7 @@ ManagerWindow::ManagerWindow(QWidget *parent)
 
             // Add to model - this will show as disconnected with cached VMs
             m_treeModel->addConnection(conn);
+            m_dashboardModel->addConnection(conn);
 
             // Auto-expand the connection to show cached VMs
             QModelIndex connIndex = m_treeModel->connectionIndex(conn);
@@ -124,12 +138,19 @@ void ManagerWindow::setupUI()
     leftLayout->setContentsMargins(4, 4, 4, 4);
     leftLayout->setSpacing(4);
 
+    m_thumbnails = new ThumbnailService(this);
+
     m_treeModel = new ConnectionTreeModel(this);
+    m_treeModel->setThumbnailService(m_thumbnails);
+
+    // Theme and style changes reach the window; the icons follow them
+    installEventFilter(m_treeModel);
     m_treeView = new QTreeView();
     m_treeView->setModel(m_treeModel);
-    m_treeView->setHeaderHidden(true);
+    m_treeView->header()->setStretchLastSection(false);
+    m_treeView->header()->setSectionResizeMode(ConnectionTreeModel::NameColumn, QHeaderView::Stretch);
     m_treeView->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_treeView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_treeView->setContextMenuPolicy(Qt::CustomContextMenu);
     m_treeView->setAlternatingRowColors(false);
     m_treeView->setAnimated(true);
@@ -138,6 +159,22 @@ void ManagerWindow::setupUI()
     m_treeView->setUniformRowHeights(true);
     m_treeView->expandAll();
 
+    // Recent CPU and disk activity of each VM, drawn from the domain histories
+    auto *cpuSparkline = new SparklineDelegate(ConnectionTreeModel::CPUHistoryRole,
+                                               ConnectionTreeModel::CPUHistoryGenerationRole,
+                                               ConnectionTreeModel::HistoryKeyRole, m_treeView);
+    cpuSparkline->setValueRange(0.0f, 100.0f);
+    m_treeView->setItemDelegateForColumn(ConnectionTreeModel::CPUHistoryColumn, cpuSparkline);
+
+    auto *diskSparkline = new SparklineDelegate(ConnectionTreeModel::DiskHistoryRole,
+                                                ConnectionTreeModel::DiskHistoryGenerationRole,
+                                                ConnectionTreeModel::HistoryKeyRole, m_treeView);
+    diskSparkline->setColor(QColor(46, 204, 113));
+    m_treeView->setItemDelegateForColumn(ConnectionTreeModel::DiskHistoryColumn, diskSparkline);
+
+    m_treeView->setColumnWidth(ConnectionTreeModel::CPUHistoryColumn, 90);
+    m_treeView->setColumnWidth(ConnectionTreeModel::DiskHistoryColumn, 90);
+
     leftLayout->addWidget(m_treeView);
 
     QPushButton *btnAddConn = new QPushButton(tr("Add Connection"));
@@ -147,7 +184,18 @@ void ManagerWindow::setupUI()
     m_splitter->addWidget(leftPanel);
     m_splitter->setStretchFactor(0, 1);
 
-    mainLayout->addWidget(m_splitter);
+    // Dashboard shares the VM list roles with the other list views
+    m_dashboardModel = new VMListModel(this);
+    m_dashboardModel->setThumbnailService(m_thumbnails);
+    m_dashboardView = new FleetDashboardView();
+    m_dashboardView->setModel(m_dashboardModel);
+    m_dashboardView->setThumbnailRole(VMListModel::ThumbnailRole);
+
+    m_centralStack = new QStackedWidget(this);
+    m_centralStack->addWidget(m_splitter);
+    m_centralStack->addWidget(m_dashboardView);
+
+    mainLayout->addWidget(m_centralStack);
 
     // Status bar
     statusBar();
@@ -238,6 +286,11 @@ void ManagerWindow::setupMenus()
     actionRefresh->setShortcut(QKeySequence::Refresh);
     connect(actionRefresh, &QAction::triggered, this, &ManagerWindow::refresh);
 
+    m_actionDashboard = m_menuView->addAction(tr("Dashboard"));
+    m_actionDashboard->setCheckable(true);
+    m_actionDashboard->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_D));
+    connect(m_actionDashboard, &QAction::toggled, this, &ManagerWindow::setDashboardMode);
+
     m_menuView->addSeparator();
 
     QAction *actionHostDetails = m_menuView->addAction(tr("Host Details"));
@@ -248,6 +301,9 @@ void ManagerWindow::setupMenus()
     QAction *actionStoragePools = m_menuView->addAction(tr("Storage Pools"));
     connect(actionStoragePools, &QAction::triggered, this, &ManagerWindow::showStoragePools);
 
+    QAction *actionBlockJobs = m_menuView->addAction(tr("Block Jobs"));
+    connect(actionBlockJobs, &QAction::triggered, this, &ManagerWindow::showBlockJobs);
+
     QAction *actionNetworks = m_menuView->addAction(tr("Virtual Networks"));
     connect(actionNetworks, &QAction::triggered, this, &ManagerWindow::showNetworks);
 
@@ -268,6 +324,14 @@ void ManagerWindow::setupMenus()
     QAction *actionVMDelete = m_menuVM->addAction(tr("Delete"));
     connect(actionVMDelete, &QAction::triggered, this, &ManagerWindow::onDeleteVM);
 
+    m_menuVM->addSeparator();
+
+    QAction *actionGroupSnapshot = m_menuVM->addAction(tr("Group Snapshot..."));
+    connect(actionGroupSnapshot, &QAction::triggered, this, &ManagerWindow::onGroupSnapshot);
+
+    QAction *actionMigrate = m_menuVM->addAction(tr("Migrate..."));
+    connect(actionMigrate, &QAction::triggered, this, &ManagerWindow::onMigrate);
+
     // Help menu
     m_menuHelp = menuBar()->addMenu(tr("&Help"));
     QAction *actionAbout = m_menuHelp->addAction(tr("About"));
@@ -295,6 +359,12 @@ void ManagerWindow::connectSignals()
     connect(m_treeView, &QTreeView::doubleClicked,
             this, &ManagerWindow::onTreeItemDoubleClicked);
 
+    // Dashboard tiles
+    connect(m_dashboardView->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &ManagerWindow::updateVMControls);
+    connect(m_dashboardView, &QAbstractItemView::activated,
+            this, &ManagerWindow::onDashboardActivated);
+
     // Toolbar actions
     connect(m_actionNewVM, &QAction::triggered, this, &ManagerWindow::onNewVM);
     connect(m_actionStart, &QAction::triggered, this, &ManagerWindow::onVMStarted);
@@ -313,8 +383,18 @@ void ManagerWindow::connectSignals()
     });
 }
 
+bool ManagerWindow::isDashboardMode() const
+{
+    return m_centralStack->currentWidget() == m_dashboardView;
+}
+
 Connection* ManagerWindow::getCurrentConnection() const
 {
+    if (isDashboardMode()) {
+        Domain *domain = getCurrentDomain();
+        return domain ? domain->connection() : nullptr;
+    }
+
     QModelIndex index = m_treeView->currentIndex();
     if (!index.isValid()) {
         return nullptr;
@@ -337,6 +417,11 @@ Connection* ManagerWindow::getCurrentConnection() const
 
 Domain* ManagerWindow::getCurrentDomain() const
 {
+    if (isDashboardMode()) {
+        QModelIndex index = m_dashboardView->currentIndex();
+        return index.isValid() ? m_dashboardModel->domainAt(index.row()) : nullptr;
+    }
+
     QModelIndex index = m_treeView->currentIndex();
     if (!index.isValid()) {
         return nullptr;
@@ -350,6 +435,36 @@ Domain* ManagerWindow::getCurrentDomain() const
     return item->domain();
 }
 
+QList<Domain*> ManagerWindow::getSelectedDomains() const
+{
+    QList<Domain*> domains;
+
+    if (isDashboardMode()) {
+        const QModelIndexList indexes = m_dashboardView->selectionModel()->selectedIndexes();
+        for (const QModelIndex &index : indexes) {
+            Domain *domain = m_dashboardModel->domainAt(index.row());
+            if (domain && !domains.contains(domain)) {
+                domains.append(domain);
+            }
+        }
+    } else {
+        const QModelIndexList rows = m_treeView->selectionModel()->selectedRows();
+        for (const QModelIndex &index : rows) {
+            TreeItem *item = m_treeModel->itemAt(index);
+            if (item && item->type() == TreeItem::VMItem && item->domain()) {
+                domains.append(item->domain());
+            }
+        }
+    }
+
+    if (domains.isEmpty()) {
+        if (Domain *domain = getCurrentDomain()) {
+            domains.append(domain);
+        }
+    }
+    return domains;
+}
+
 void ManagerWindow::addConnection(Connection *conn)
 {
     if (!conn) {
@@ -364,6 +479,9 @@ void ManagerWindow::addConnection(Connection *conn)
     Engine::instance()->registerConnection(conn);
 
     m_treeModel->addConnection(conn);
+    m_dashboardModel->addConnection(conn);
+    m_thumbnails->addConnection(conn);
+    BackupManager::instance()->addConnection(conn);
 
     // Automatically persist SSH credentials for remote connections
     Config *config = Config::instance();
@@ -397,10 +515,7 @@ void ManagerWindow::removeConnection(Connection *conn)
 
     QString uri = conn->uri();
 
-    // Unregister connection from Engine
-    Engine::instance()->unregisterConnection(conn);
-
-    m_treeModel->removeConnection(conn);
+    detachConnection(conn);
 
     // Add back as disconnected so it remains in the sidebar
     m_treeModel->addDisconnectedConnection(uri, false);
@@ -409,6 +524,17 @@ void ManagerWindow::removeConnection(Connection *conn)
     updateVMControls();
 }
 
+// Drops every reference to @p conn, so it can be deleted or replaced
+void ManagerWindow::detachConnection(Connection *conn)
+{
+    Engine::instance()->unregisterConnection(conn);
+
+    m_treeModel->removeConnection(conn);
+    m_dashboardModel->removeConnection(conn);
+    m_thumbnails->removeConnection(conn);
+    BackupManager::instance()->removeConnection(conn);
+}
+
 void ManagerWindow::onConnectionAdded()
 {
     // Placeholder for connection added handling
@@ -468,6 +594,30 @@ void ManagerWindow::onVMResume()
     updateVMControls();
 }
 
+void ManagerWindow::onGroupSnapshot()
+{
+    const QList<Domain*> domains = getSelectedDomains();
+    if (domains.isEmpty()) {
+        m_statusLabel->setText(tr("Select the VMs to snapshot"));
+        return;
+    }
+
+    GroupSnapshotDialog dialog(domains, this);
+    dialog.exec();
+}
+
+void ManagerWindow::onMigrate()
+{
+    const QList<Domain*> domains = getSelectedDomains();
+    if (domains.isEmpty()) {
+        m_statusLabel->setText(tr("Select the VMs to migrate"));
+        return;
+    }
+
+    MigrateDialog dialog(domains, this);
+    dialog.exec();
+}
+
 void ManagerWindow::onNewVM()
 {
     qDebug() << "onNewVM: Starting VM creation wizard";
@@ -625,6 +775,54 @@ void ManagerWindow::onTreeItemDoubleClicked(const QModelIndex &index)
     }
 }
 
+void ManagerWindow::setDashboardMode(bool enabled)
+{
+    m_centralStack->setCurrentWidget(enabled ? static_cast<QWidget *>(m_dashboardView)
+                                             : static_cast<QWidget *>(m_splitter));
+    if (m_actionDashboard->isChecked() != enabled) {
+        m_actionDashboard->setChecked(enabled);
+    }
+    updateVMControls();
+    updateThumbnailCapture();
+}
+
+void ManagerWindow::updateThumbnailCapture()
+{
+    // Screenshots are only worth their cost while the tiles are on screen
+    m_thumbnails->setActive(isVisible() && !isMinimized() && isDashboardMode());
+}
+
+void ManagerWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    updateThumbnailCapture();
+}
+
+void ManagerWindow::hideEvent(QHideEvent *event)
+{
+    QMainWindow::hideEvent(event);
+    updateThumbnailCapture();
+}
+
+void ManagerWindow::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        updateThumbnailCapture();
+    }
+}
+
+void ManagerWindow::onDashboardActivated(const QModelIndex &index)
+{
+    Domain *domain = index.isValid() ? m_dashboardModel->domainAt(index.row()) : nullptr;
+    if (!domain) {
+        return;
+    }
+
+    auto *vmWindow = new VMWindow(domain, this);
+    vmWindow->show();
+}
+
 void ManagerWindow::openConnectionDialog()
 {
     ConnectionDialog dialog(this);
@@ -737,6 +935,25 @@ void ManagerWindow::showStoragePools()
     dialog->show();
 }
 
+void ManagerWindow::showBlockJobs()
+{
+    Connection *conn = getCurrentConnection();
+    if (!conn) {
+        QMessageBox::warning(this, tr("No Connection Selected"),
+            tr("Please select a connection first."));
+        return;
+    }
+
+    // Jobs of every VM on the connection
+    auto *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("Block Jobs - %1").arg(conn->uri()));
+    auto *layout = new QVBoxLayout(dialog);
+    layout->addWidget(new BlockJobPanel(BlockJobManager::instance(), conn, nullptr, dialog));
+    dialog->resize(800, 400);
+    dialog->show();
+}
+
 void ManagerWindow::showNetworks()
 {
     // Get selected connection
@@ -796,6 +1013,14 @@ void ManagerWindow::onTreeContextMenu(const QPoint &pos)
         QAction *deleteAction = menu.addAction(tr("Delete"));
         deleteAction->setEnabled(true);
         connect(deleteAction, &QAction::triggered, this, &ManagerWindow::onDeleteConnection);
+    } else if (item->type() == TreeItem::VMItem && item->domain()
+               && getSelectedDomains().size() > 1) {
+        // Several VMs selected: only actions that apply to all of them
+        QAction *groupSnapshotAction = menu.addAction(tr("Group Snapshot..."));
+        connect(groupSnapshotAction, &QAction::triggered, this, &ManagerWindow::onGroupSnapshot);
+
+        QAction *migrateAction = menu.addAction(tr("Migrate..."));
+        connect(migrateAction, &QAction::triggered, this, &ManagerWindow::onMigrate);
     } else if (item->type() == TreeItem::VMItem && item->domain()) {
         // VM context menu from tree
         VMContextMenu contextMenu(this);
@@ -806,6 +1031,7 @@ void ManagerWindow::onTreeContextMenu(const QPoint &pos)
         connect(&contextMenu, &VMContextMenu::rebootRequested, this, &ManagerWindow::onVMRebooted);
         connect(&contextMenu, &VMContextMenu::pauseRequested, this, &ManagerWindow::onVMPaused);
         connect(&contextMenu, &VMContextMenu::deleteRequested, this, &ManagerWindow::onDeleteVM);
+        connect(&contextMenu, &VMContextMenu::migrateRequested, this, &ManagerWindow::onMigrate);
         connect(&contextMenu, &VMContextMenu::openConsoleRequested, this, [this]() {
             Domain *domain = getCurrentDomain();
             if (domain) {
@@ -939,13 +1165,8 @@ void ManagerWindow::onEditConnection()
         // If connection is active, reconnect to apply new settings
         if (conn) {
             // IMPORTANT: Don't use removeConnection() here as it will add back as disconnected
-            // Instead, directly manipulate the model to avoid duplicates
-
-            // Unregister from Engine
-            Engine::instance()->unregisterConnection(conn);
-
-            // Remove from models
-            m_treeModel->removeConnection(conn);
+            // Instead, only detach it, to avoid duplicates
+            detachConnection(conn);
 
             // Close old connection
             delete conn;
@@ -1065,6 +1286,7 @@ void ManagerWindow::onConnectionStateChanged(Connection::State state)
 
         // Add connection to tree (will show as disconnected with cached VMs)
         m_treeModel->addConnection(conn);
+        m_dashboardModel->addConnection(conn);
 
         QMessageBox::warning(this, tr("Connection Failed"),
             tr("Failed to connect to: %1\n\n%2\n\nShowing cached VMs.").arg(uri, conn->connectionError()));
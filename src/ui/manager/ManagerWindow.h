@@ -20,6 +20,7 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSplitter>
+#include <QStackedWidget>
 #include <QToolBar>
 #include <QAction>
 #include <QMenu>
@@ -27,10 +28,13 @@
 
 #include "../../libvirt/Connection.h"
 #include "../models/ConnectionTreeModel.h"
+#include "../models/VMListModel.h"
 #include "../widgets/ContextMenu.h"
 
 namespace QVirt {
 
+class FleetDashboardView;
+class ThumbnailService;
 class KeyboardShortcuts;
 class ConnectionProgressDialog;
 
@@ -39,6 +43,7 @@ class ConnectionProgressDialog;
  *
  * This is the main application window that displays:
  * - Expandable tree of connections with VMs as children
+ * - Optional dashboard with one tile per VM across all connections
  * - VM list in the main area
  * - VM controls (start, stop, reboot, etc.)
  */
@@ -53,6 +58,11 @@ public:
     void addConnection(Connection *conn);
     void removeConnection(Connection *conn);
 
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
 private slots:
     void onConnectionAdded();
     void onVMStarted();
@@ -62,11 +72,14 @@ private slots:
     void onVMResume();
     void onNewVM();
     void onDeleteVM();
+    void onGroupSnapshot();
+    void onMigrate();
     void onTreeSelectionChanged();
     void openConnectionDialog();
     void showPreferences();
     void showHostDetails();
     void showStoragePools();
+    void showBlockJobs();
     void showNetworks();
     void refresh();
     void onTreeContextMenu(const QPoint &pos);
@@ -77,6 +90,8 @@ private slots:
     void openConsole();
     void onConnectionStateChanged(Connection::State state);
     void onTreeItemDoubleClicked(const QModelIndex &index);
+    void setDashboardMode(bool enabled);
+    void onDashboardActivated(const QModelIndex &index);
 
 private:
     void setupUI();
@@ -87,14 +102,28 @@ private:
     void updateVMControls();
     Connection* getCurrentConnection() const;
     Domain* getCurrentDomain() const;
+    QList<Domain*> getSelectedDomains() const;
+    void detachConnection(Connection *conn);
+
+    bool isDashboardMode() const;
+    void updateThumbnailCapture();
 
     // UI components
+    QStackedWidget *m_centralStack;
     QSplitter *m_splitter;
 
     // Left panel (tree view with connections and VMs)
     QTreeView *m_treeView;
     ConnectionTreeModel *m_treeModel;
 
+    // Dashboard (tiles for every VM of every connection)
+    FleetDashboardView *m_dashboardView;
+    VMListModel *m_dashboardModel;
+    QAction *m_actionDashboard;
+
+    // Console screenshots for dashboard tiles and tree tooltips
+    ThumbnailService *m_thumbnails;
+
     // VM control buttons
     QPushButton *m_btnStart;
     QPushButton *m_btnStop;
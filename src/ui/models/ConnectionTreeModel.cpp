@@ -12,14 +12,14 @@
 #include "ConnectionTreeModel.h"
 #include "../../libvirt/Domain.h"
 #include "../../libvirt/EnumMapper.h"
-#include <QDebug>
-#include <QFont>
-#include <QColor>
+#include "../../libvirt/ThumbnailService.h"
 #include <QDebug>
 #include <QFont>
 #include <QColor>
 #include <QApplication>
 #include <QStyle>
+#include <QEvent>
+#include <QElapsedTimer>
 
 
 namespace QVirt {
@@ -124,8 +124,16 @@ QString TreeItem::uri() const
 // ConnectionTreeModel implementation
 ConnectionTreeModel::ConnectionTreeModel(QObject *parent)
     : QAbstractItemModel(parent)
+    , m_iconCacheValid(false)
+    , m_profilingEnabled(false)
 {
     m_rootItem = new TreeItem(TreeItem::ConnectionItem, "Root", nullptr);
+
+    QFont italicFont;
+    italicFont.setItalic(true);
+    m_offlineFont = italicFont;
+    m_defaultFont = QFont();
+    m_offlineForeground = QVariant::fromValue(QColor(Qt::gray));
 }
 
 ConnectionTreeModel::~ConnectionTreeModel()
@@ -177,7 +185,7 @@ int ConnectionTreeModel::rowCount(const QModelIndex &parent) const
 int ConnectionTreeModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return 1;
+    return ColumnCount;
 }
 
 QVariant ConnectionTreeModel::data(const QModelIndex &index, int role) const
@@ -191,6 +199,29 @@ QVariant ConnectionTreeModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
+    if (index.column() != NameColumn) {
+        return historyData(item, index.column(), role);
+    }
+
+    if (!m_profilingEnabled) {
+        return itemData(item, role);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVariant value = itemData(item, role);
+    qint64 nsecs = timer.nsecsElapsed();
+
+    m_profile.calls++;
+    m_profile.totalNsecs += nsecs;
+    if (nsecs > m_profile.maxNsecs) {
+        m_profile.maxNsecs = nsecs;
+    }
+    return value;
+}
+
+QVariant ConnectionTreeModel::itemData(TreeItem *item, int role) const
+{
     switch (role) {
     case Qt::DisplayRole: {
         QString name = item->displayName();
@@ -204,62 +235,52 @@ QVariant ConnectionTreeModel::data(const QModelIndex &index, int role) const
     }
 
     case Qt::FontRole: {
-        QFont font;
         if (item->isDisconnected()) {
-            font.setItalic(true);
+            return m_offlineFont;
         }
         // Also italic for cached VMs
         if (item->type() == TreeItem::VMItem && item->domain() && item->domain()->isCached()) {
-            font.setItalic(true);
+            return m_offlineFont;
         }
-        return font;
+        return m_defaultFont;
     }
 
     case Qt::ForegroundRole: {
         if (item->isDisconnected()) {
-            return QVariant::fromValue(QColor(Qt::gray));
+            return m_offlineForeground;
         }
         // Gray color for cached VMs (offline)
         if (item->type() == TreeItem::VMItem && item->domain() && item->domain()->isCached()) {
-            return QVariant::fromValue(QColor(Qt::gray));
+            return m_offlineForeground;
         }
         return QVariant();
     }
 
     case Qt::DecorationRole: {
-        // Icons for items using theme icons with fallbacks
+        // Icons are resolved once and shared by all rows in the same state
         if (item->type() == TreeItem::ConnectionItem) {
-            // Connection icon - network/server icon
-            return QIcon::fromTheme("network-server", QApplication::style()->standardIcon(QStyle::SP_DriveNetIcon));
+            return stateIcon(ConnectionIcon);
         } else if (item->type() == TreeItem::VMItem && item->domain()) {
-            Domain::State state = item->domain()->state();
-            // Use semi-transparent icon for cached VMs
-            if (item->domain()->isCached()) {
-                switch (state) {
-                case Domain::StateRunning:
-                    return QIcon::fromTheme("media-playback-start", QApplication::style()->standardIcon(QStyle::SP_MediaPlay));
-                case Domain::StatePaused:
-                    return QIcon::fromTheme("media-playback-pause", QApplication::style()->standardIcon(QStyle::SP_MediaPause));
-                case Domain::StateShutOff:
-                    return QIcon::fromTheme("computer", QApplication::style()->standardIcon(QStyle::SP_DesktopIcon));
-                default:
-                    return QIcon::fromTheme("computer", QApplication::style()->standardIcon(QStyle::SP_ComputerIcon));
-                }
-            }
-            switch (state) {
+            switch (item->domain()->state()) {
             case Domain::StateRunning:
-                return QIcon::fromTheme("media-playback-start", QApplication::style()->standardIcon(QStyle::SP_MediaPlay));
+                return stateIcon(RunningIcon);
             case Domain::StatePaused:
-                return QIcon::fromTheme("media-playback-pause", QApplication::style()->standardIcon(QStyle::SP_MediaPause));
+                return stateIcon(PausedIcon);
             case Domain::StateShutOff:
-                return QIcon::fromTheme("computer", QApplication::style()->standardIcon(QStyle::SP_DesktopIcon));
+                return stateIcon(ShutOffIcon);
             default:
-                return QIcon::fromTheme("computer", QApplication::style()->standardIcon(QStyle::SP_ComputerIcon));
+                return stateIcon(DefaultVMIcon);
             }
         }
         return QVariant();
     }
 
+    case Qt::ToolTipRole:
+        if (item->type() == TreeItem::VMItem && item->domain()) {
+            return vmToolTip(item->domain());
+        }
+        return QVariant();
+
     case URIRole:
         return item->uri();
 
@@ -295,11 +316,72 @@ QVariant ConnectionTreeModel::data(const QModelIndex &index, int role) const
     }
 }
 
+QVariant ConnectionTreeModel::historyData(TreeItem *item, int column, int role) const
+{
+    // Only VM rows have histories; connection rows leave these cells empty
+    Domain *domain = item->type() == TreeItem::VMItem ? item->domain() : nullptr;
+    if (!domain) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case Qt::ToolTipRole:
+        if (column == CPUHistoryColumn) {
+            return tr("CPU: %1%").arg(domain->cpuUsage(), 0, 'f', 1);
+        }
+        return tr("Disk I/O: %1 KiB/s").arg(domain->diskUsage(), 0, 'f', 0);
+    case CPUHistoryRole:
+        return QVariant::fromValue(domain->cpuHistory().toVector());
+    case DiskHistoryRole:
+        return QVariant::fromValue(domain->diskHistory().toVector());
+    case CPUHistoryGenerationRole:
+        return domain->cpuHistory().generation();
+    case DiskHistoryGenerationRole:
+        return domain->diskHistory().generation();
+    case HistoryKeyRole:
+        // The same VM may be listed under two connections after a migration
+        return item->uri() + QLatin1Char('/') + domain->uuid();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant ConnectionTreeModel::vmToolTip(Domain *domain) const
+{
+    // Tooltips are pulled on hover, so they always show the latest capture
+    ThumbnailService::Thumbnail thumb;
+    if (m_thumbnails) {
+        thumb = m_thumbnails->thumbnail(domain);
+    }
+    if (thumb.isNull()) {
+        return QVariant();
+    }
+
+    qint64 age = m_thumbnails->thumbnailAge(domain);
+    return QStringLiteral("<b>%1</b><br><img src=\"data:image/png;base64,%2\"><br><small>%3</small>")
+        .arg(domain->name().toHtmlEscaped(),
+             QString::fromLatin1(thumb.png.toBase64()),
+             tr("Captured %1").arg(ThumbnailService::describeAge(age)));
+}
+
+void ConnectionTreeModel::setThumbnailService(ThumbnailService *service)
+{
+    m_thumbnails = service;
+}
+
 QVariant ConnectionTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    Q_UNUSED(section);
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
-        return tr("Connections");
+        switch (section) {
+        case NameColumn:
+            return tr("Name");
+        case CPUHistoryColumn:
+            return tr("CPU usage");
+        case DiskHistoryColumn:
+            return tr("Disk I/O");
+        default:
+            break;
+        }
     }
     return QVariant();
 }
@@ -366,8 +448,7 @@ void ConnectionTreeModel::addConnection(Connection *conn)
                         vmItem->setDomain(domain);
                         existingItem->addChild(vmItem);
 
-                        connect(domain, &Domain::stateChanged,
-                                this, &ConnectionTreeModel::onDomainStateChanged);
+                        connectDomain(domain);
                     }
 
                     endInsertRows();
@@ -397,8 +478,7 @@ void ConnectionTreeModel::addConnection(Connection *conn)
                     existingItem->addChild(vmItem);
 
                     // Connect to domain signals (for when connection is restored)
-                    connect(domain, &Domain::stateChanged,
-                            this, &ConnectionTreeModel::onDomainStateChanged);
+                    connectDomain(domain);
                 }
 
                 endInsertRows();
@@ -447,8 +527,7 @@ void ConnectionTreeModel::addConnection(Connection *conn)
             connItem->addChild(vmItem);
 
             // Connect to domain signals
-            connect(domain, &Domain::stateChanged,
-                    this, &ConnectionTreeModel::onDomainStateChanged);
+            connectDomain(domain);
         }
 
         endInsertRows();
@@ -611,6 +690,79 @@ QModelIndex ConnectionTreeModel::connectionIndex(Connection *conn) const
     return QModelIndex();
 }
 
+void ConnectionTreeModel::invalidateIconCache()
+{
+    m_iconCacheValid = false;
+    m_iconCache.clear();
+
+    // Views only ask again for rows they are told changed
+    const QVector<int> roles{Qt::DecorationRole};
+    const QList<TreeItem*> connections = m_rootItem->children();
+    if (connections.isEmpty()) {
+        return;
+    }
+    emit dataChanged(createIndex(0, 0, connections.first()),
+                     createIndex(int(connections.size()) - 1, 0, connections.last()), roles);
+    for (TreeItem *connItem : connections) {
+        const QList<TreeItem*> vms = connItem->children();
+        if (!vms.isEmpty()) {
+            emit dataChanged(createIndex(0, 0, vms.first()),
+                             createIndex(int(vms.size()) - 1, 0, vms.last()), roles);
+        }
+    }
+}
+
+void ConnectionTreeModel::setProfilingEnabled(bool enabled)
+{
+    m_profilingEnabled = enabled;
+    m_profile = DataProfile();
+}
+
+ConnectionTreeModel::DataProfile ConnectionTreeModel::takeProfile()
+{
+    DataProfile profile = m_profile;
+    m_profile = DataProfile();
+    return profile;
+}
+
+bool ConnectionTreeModel::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::ThemeChange:
+    case QEvent::StyleChange:
+    case QEvent::ApplicationPaletteChange:
+        if (m_iconCacheValid) {
+            invalidateIconCache();
+        }
+        break;
+    default:
+        break;
+    }
+    return QAbstractItemModel::eventFilter(watched, event);
+}
+
+void ConnectionTreeModel::ensureIconCache() const
+{
+    if (m_iconCacheValid) {
+        return;
+    }
+
+    QStyle *style = QApplication::style();
+    m_iconCache.resize(IconKindCount);
+    m_iconCache[ConnectionIcon] = QIcon::fromTheme("network-server", style->standardIcon(QStyle::SP_DriveNetIcon));
+    m_iconCache[RunningIcon] = QIcon::fromTheme("media-playback-start", style->standardIcon(QStyle::SP_MediaPlay));
+    m_iconCache[PausedIcon] = QIcon::fromTheme("media-playback-pause", style->standardIcon(QStyle::SP_MediaPause));
+    m_iconCache[ShutOffIcon] = QIcon::fromTheme("computer", style->standardIcon(QStyle::SP_DesktopIcon));
+    m_iconCache[DefaultVMIcon] = QIcon::fromTheme("computer", style->standardIcon(QStyle::SP_ComputerIcon));
+    m_iconCacheValid = true;
+}
+
+const QVariant &ConnectionTreeModel::stateIcon(IconKind kind) const
+{
+    ensureIconCache();
+    return m_iconCache.at(kind);
+}
+
 void ConnectionTreeModel::setupConnectionItem(TreeItem *item, Connection *conn)
 {
     Q_UNUSED(item);
@@ -701,8 +853,7 @@ void ConnectionTreeModel::onDomainAdded(Domain *domain)
     connItem->addChild(vmItem);
 
     // Connect to domain signals
-    connect(domain, &Domain::stateChanged,
-            this, &ConnectionTreeModel::onDomainStateChanged);
+    connectDomain(domain);
 
     endInsertRows();
 }
@@ -735,6 +886,14 @@ void ConnectionTreeModel::onDomainRemoved(Domain *domain)
     endRemoveRows();
 }
 
+void ConnectionTreeModel::connectDomain(Domain *domain)
+{
+    connect(domain, &Domain::stateChanged,
+            this, &ConnectionTreeModel::onDomainStateChanged, Qt::UniqueConnection);
+    connect(domain, &Domain::statsUpdated,
+            this, &ConnectionTreeModel::onDomainStatsUpdated, Qt::UniqueConnection);
+}
+
 void ConnectionTreeModel::onDomainStateChanged()
 {
     Domain *domain = qobject_cast<Domain*>(sender());
@@ -757,4 +916,27 @@ void ConnectionTreeModel::onDomainStateChanged()
     emit dataChanged(idx, idx);
 }
 
+void ConnectionTreeModel::onDomainStatsUpdated()
+{
+    Domain *domain = qobject_cast<Domain*>(sender());
+    if (!domain || !domain->connection()) {
+        return;
+    }
+
+    TreeItem *connItem = findConnectionItem(domain->connection());
+    if (!connItem) {
+        return;
+    }
+
+    TreeItem *vmItem = findVMItem(connItem, domain);
+    if (!vmItem) {
+        return;
+    }
+
+    // Only the sparkline cells change with the stats
+    QModelIndex parentIdx = index(connItem->row(), 0, QModelIndex());
+    emit dataChanged(index(vmItem->row(), CPUHistoryColumn, parentIdx),
+                     index(vmItem->row(), DiskHistoryColumn, parentIdx));
+}
+
 } // namespace QVirt
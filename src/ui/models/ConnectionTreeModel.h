@@ -16,6 +16,9 @@
 #include <QList>
 #include <QSet>
 #include <QIcon>
+#include <QVector>
+#include <QVariant>
+#include <QPointer>
 
 #include "../../libvirt/Connection.h"
 #include "../../core/Config.h"
@@ -23,6 +26,7 @@
 namespace QVirt {
 
 class Domain;
+class ThumbnailService;
 
 /**
  * @brief Tree item for connection tree model
@@ -78,6 +82,9 @@ private:
  * Provides a tree view where:
  * - Top level: Connections (connected or disconnected)
  * - Second level: VMs under each connection
+ *
+ * Besides the name, VM rows carry their recent CPU and disk histories
+ * for the sparkline columns.
  */
 class ConnectionTreeModel : public QAbstractItemModel
 {
@@ -92,7 +99,19 @@ public:
         DomainRole,
         ConnectionRole,
         IconRole,
-        IsCachedRole
+        IsCachedRole,
+        CPUHistoryRole,             // QVector<float>, CPU usage in percent
+        DiskHistoryRole,            // QVector<float>, disk throughput in KiB/s
+        CPUHistoryGenerationRole,   // quint64, bumped whenever the CPU history advances
+        DiskHistoryGenerationRole,  // quint64, bumped whenever the disk history advances
+        HistoryKeyRole              // QString, unique per VM row; keys the sparkline cache
+    };
+
+    enum Columns {
+        NameColumn,
+        CPUHistoryColumn,
+        DiskHistoryColumn,
+        ColumnCount
     };
 
     explicit ConnectionTreeModel(QObject *parent = nullptr);
@@ -128,6 +147,37 @@ public:
     // Get connection row index
     QModelIndex connectionIndex(Connection *conn) const;
 
+    /**
+     * @brief Drop the resolved state icons so they are looked up again
+     *
+     * Called automatically on theme/style changes of the widgets the
+     * model is installed on as an event filter.
+     */
+    void invalidateIconCache();
+
+    // Console thumbnails shown in VM tooltips; not owned
+    void setThumbnailService(ThumbnailService *service);
+
+    /**
+     * @brief Timing counters for data() calls
+     */
+    struct DataProfile {
+        quint64 calls = 0;
+        qint64 totalNsecs = 0;
+        qint64 maxNsecs = 0;
+    };
+
+    // data() profiling hook (disabled by default, zero cost when off)
+    void setProfilingEnabled(bool enabled);
+    bool isProfilingEnabled() const { return m_profilingEnabled; }
+
+    /**
+     * @brief Return the counters gathered since the last call and reset them
+     *
+     * Call once per painted frame to get per-frame data() cost.
+     */
+    DataProfile takeProfile();
+
 signals:
     void connectionActivated(Connection *conn);
     void vmActivated(Domain *domain);
@@ -137,8 +187,28 @@ private slots:
     void onDomainAdded(Domain *domain);
     void onDomainRemoved(Domain *domain);
     void onDomainStateChanged();
+    void onDomainStatsUpdated();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
+    enum IconKind {
+        ConnectionIcon,
+        RunningIcon,
+        PausedIcon,
+        ShutOffIcon,
+        DefaultVMIcon,
+        IconKindCount
+    };
+
+    QVariant itemData(TreeItem *item, int role) const;
+    QVariant historyData(TreeItem *item, int column, int role) const;
+    void connectDomain(Domain *domain);
+    QVariant vmToolTip(Domain *domain) const;
+    const QVariant &stateIcon(IconKind kind) const;
+    void ensureIconCache() const;
+
     TreeItem *m_rootItem;
     QMap<QString, TreeItem*> m_connectionItems;
     QMap<Connection*, TreeItem*> m_connectionToItem;
@@ -148,6 +218,20 @@ private:
     TreeItem* findConnectionItem(const QString &uri) const;
     TreeItem* findConnectionItem(Connection *conn) const;
     TreeItem* findVMItem(TreeItem *connItem, Domain *domain) const;
+
+    // Resolved decoration icons, built on first use
+    mutable QVector<QVariant> m_iconCache;
+    mutable bool m_iconCacheValid;
+
+    // Pre-built font/foreground roles for offline items
+    QVariant m_offlineFont;
+    QVariant m_defaultFont;
+    QVariant m_offlineForeground;
+
+    bool m_profilingEnabled;
+    mutable DataProfile m_profile;
+
+    QPointer<ThumbnailService> m_thumbnails;
 };
 
 } // namespace QVirt
@@ -11,6 +11,7 @@
 
 #include "VMListModel.h"
 #include "../../libvirt/EnumMapper.h"
+#include "../../libvirt/ThumbnailService.h"
 #include <QDebug>
 
 namespace QVirt {
@@ -56,12 +57,24 @@ QVariant VMListModel::data(const QModelIndex &index, int role) const
     // Handle table view display by column
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
-        case 0: // Name
+        case NameColumn:
             return domainName;
-        case 1: // State
+        case StateColumn:
             return EnumMapper::domainStatusToString(domain->state());
-        case 2: // Memory
+        case MemoryColumn:
             return data(index, MemoryFormattedRole).toString();
+        default:
+            // History columns are drawn by SparklineDelegate
+            return QVariant();
+        }
+    }
+
+    if (role == Qt::ToolTipRole) {
+        switch (index.column()) {
+        case CPUHistoryColumn:
+            return tr("CPU: %1%").arg(domain->cpuUsage(), 0, 'f', 1);
+        case DiskHistoryColumn:
+            return tr("Disk I/O: %1 KiB/s").arg(domain->diskUsage(), 0, 'f', 0);
         default:
             return QVariant();
         }
@@ -93,6 +106,22 @@ QVariant VMListModel::data(const QModelIndex &index, int role) const
         return domain->vcpuCount();
     case DescriptionRole:
         return domain->description();
+    case TitleRole:
+        return domain->title();
+    case IPAddressesRole:
+        return domain->guestIPAddresses();
+    case CPUHistoryRole:
+        return QVariant::fromValue(domain->cpuHistory().toVector());
+    case DiskHistoryRole:
+        return QVariant::fromValue(domain->diskHistory().toVector());
+    case CPUHistoryGenerationRole:
+        return domain->cpuHistory().generation();
+    case DiskHistoryGenerationRole:
+        return domain->diskHistory().generation();
+    case ThumbnailRole:
+        return m_thumbnails ? m_thumbnails->thumbnail(domain).pixmap : QPixmap();
+    case ThumbnailAgeRole:
+        return m_thumbnails ? m_thumbnails->thumbnailAge(domain) : qint64(-1);
     case MemoryFormattedRole: {
         quint64 current = domain->currentMemory() / 1024; // MB
         quint64 max = domain->maxMemory() / 1024; // MB
@@ -110,12 +139,16 @@ QVariant VMListModel::headerData(int section, Qt::Orientation orientation, int r
 {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
         switch (section) {
-        case 0:
+        case NameColumn:
             return tr("Name");
-        case 1:
+        case StateColumn:
             return tr("State");
-        case 2:
+        case MemoryColumn:
             return tr("Memory");
+        case CPUHistoryColumn:
+            return tr("CPU");
+        case DiskHistoryColumn:
+            return tr("Disk I/O");
         default:
             return QVariant();
         }
@@ -316,9 +349,41 @@ void VMListModel::onDomainStatsUpdated()
         return;
     }
 
+    // Refresh the whole row so the history columns pick up the new sample
     int index = m_domains.indexOf(domain);
     if (index >= 0) {
-        emit dataChanged(createIndex(index, 0), createIndex(index, 0));
+        emit dataChanged(createIndex(index, 0), createIndex(index, ColumnCount - 1));
+    }
+}
+
+void VMListModel::setThumbnailService(ThumbnailService *service)
+{
+    if (m_thumbnails == service) {
+        return;
+    }
+
+    if (m_thumbnails) {
+        disconnect(m_thumbnails, nullptr, this, nullptr);
+    }
+    m_thumbnails = service;
+    if (m_thumbnails) {
+        connect(m_thumbnails, &ThumbnailService::thumbnailUpdated,
+                this, &VMListModel::onThumbnailUpdated);
+    }
+
+    if (!m_domains.isEmpty()) {
+        emit dataChanged(createIndex(0, 0), createIndex(m_domains.count() - 1, 0),
+                         {ThumbnailRole, ThumbnailAgeRole});
+    }
+}
+
+void VMListModel::onThumbnailUpdated(Domain *domain)
+{
+    // Only the thumbnail moved: leave text and sparkline caches alone
+    int index = m_domains.indexOf(domain);
+    if (index >= 0) {
+        emit dataChanged(createIndex(index, 0), createIndex(index, 0),
+                         {ThumbnailRole, ThumbnailAgeRole});
     }
 }
 
@@ -15,12 +15,15 @@
 #include <QAbstractListModel>
 #include <QList>
 #include <QPixmap>
+#include <QPointer>
 
 #include "../../libvirt/Domain.h"
 #include "ConnectionListModel.h"
 
 namespace QVirt {
 
+class ThumbnailService;
+
 /**
  * @brief Qt model for displaying list of VMs (domains)
  *
@@ -43,14 +46,31 @@ public:
         MaxMemoryRole,
         VCPUCountRole,
         DescriptionRole,
-        MemoryFormattedRole
+        MemoryFormattedRole,
+        TitleRole,
+        IPAddressesRole,
+        CPUHistoryRole,             // QVector<float>, CPU usage in percent
+        DiskHistoryRole,            // QVector<float>, disk throughput in KiB/s
+        CPUHistoryGenerationRole,   // quint64, bumped whenever the CPU history advances
+        DiskHistoryGenerationRole,  // quint64, bumped whenever the disk history advances
+        ThumbnailRole,              // QPixmap console thumbnail, null if none
+        ThumbnailAgeRole            // qint64 ms since the thumbnail was taken, -1 if none
+    };
+
+    enum Columns {
+        NameColumn,
+        StateColumn,
+        MemoryColumn,
+        CPUHistoryColumn,
+        DiskHistoryColumn,
+        ColumnCount
     };
 
     explicit VMListModel(QObject *parent = nullptr);
 
     // QAbstractItemModel interface (for QTableView)
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
-    int columnCount(const QModelIndex &parent = QModelIndex()) const override { Q_UNUSED(parent); return 3; }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override { Q_UNUSED(parent); return ColumnCount; }
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation,
                         int role = Qt::DisplayRole) const override;
@@ -64,6 +84,9 @@ public:
     Domain* domainAt(int index) const;
     QList<Domain*> domains() const { return m_domains; }
 
+    // Source of ThumbnailRole; the model does not take ownership
+    void setThumbnailService(ThumbnailService *service);
+
     // Filtering
     void setShowActiveVMs(bool show);
     void setShowInactiveVMs(bool show);
@@ -74,6 +97,7 @@ public slots:
     void onDomainRemoved(Domain *domain);
     void onDomainStateChanged(Domain::State state);
     void onDomainStatsUpdated();
+    void onThumbnailUpdated(Domain *domain);
 
 private:
     void rebuildDomainList();
@@ -81,6 +105,7 @@ private:
 
     QList<Connection*> m_connections;
     QList<Domain*> m_domains;
+    QPointer<ThumbnailService> m_thumbnails;
 
     bool m_showActive;
     bool m_showInactive;
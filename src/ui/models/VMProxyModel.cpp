@@ -10,6 +10,8 @@
  */
 
 #include "VMProxyModel.h"
+#include "VMListModel.h"
+#include <QTimer>
 
 namespace QVirt {
 
@@ -18,20 +20,91 @@ VMProxyModel::VMProxyModel(QObject *parent)
     , m_filterState(-1)
     , m_showFavorites(false)
     , m_sortColumn(SortColumn::Name)
+    , m_filterTimer(new QTimer(this))
+    , m_filterDelay(150)
+    , m_querySignature(0)
+    , m_indexDirty(true)
 {
     setDynamicSortFilter(true);
     setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    m_filterTimer->setSingleShot(true);
+    connect(m_filterTimer, &QTimer::timeout,
+            this, &VMProxyModel::applyPendingFilter);
+}
+
+void VMProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+
+    // Connect before the base class does, so the index is already up to
+    // date when QSortFilterProxyModel re-evaluates filterAcceptsRow()
+    if (model) {
+        connect(model, &QAbstractItemModel::rowsInserted,
+                this, &VMProxyModel::onSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsRemoved,
+                this, &VMProxyModel::onSourceRowsRemoved);
+        connect(model, &QAbstractItemModel::dataChanged,
+                this, &VMProxyModel::onSourceDataChanged);
+        connect(model, &QAbstractItemModel::layoutAboutToBeChanged,
+                this, &VMProxyModel::onSourceLayoutChanged);
+        connect(model, &QAbstractItemModel::modelAboutToBeReset,
+                this, &VMProxyModel::onSourceLayoutChanged);
+        connect(model, &QAbstractItemModel::modelReset,
+                this, &VMProxyModel::statisticsChanged);
+        connect(model, &QAbstractItemModel::layoutChanged,
+                this, &VMProxyModel::statisticsChanged);
+    }
+
+    m_indexDirty = true;
+    QSortFilterProxyModel::setSourceModel(model);
+    emit statisticsChanged();
 }
 
 void VMProxyModel::setFilterText(const QString &text)
 {
     if (m_filterText != text) {
         m_filterText = text;
-        invalidateFilter();
-        emit filterUpdated();
+        if (m_filterDelay > 0) {
+            m_filterTimer->start(m_filterDelay);
+        } else {
+            applyPendingFilter();
+        }
     }
 }
 
+void VMProxyModel::setFilterDelay(int msec)
+{
+    m_filterDelay = qMax(0, msec);
+}
+
+void VMProxyModel::applyPendingFilter()
+{
+    m_filterTimer->stop();
+    if (m_appliedFilterText == m_filterText) {
+        return;
+    }
+
+    QString previous = normalize(m_appliedFilterText);
+    QString current = normalize(m_filterText);
+    m_appliedFilterText = m_filterText;
+
+    m_queryTokens = current.isEmpty() ? QStringList() : current.split(QLatin1Char(' '));
+    m_querySignature = 0;
+    for (const QString &token : m_queryTokens) {
+        m_querySignature |= trigramSignature(token);
+    }
+
+    // Rows that failed the previous query cannot match a longer one
+    bool narrowOnly = !previous.isEmpty() && current.startsWith(previous);
+    recomputeMatches(narrowOnly);
+
+    invalidateFilter();
+    emit filterUpdated();
+}
+
 void VMProxyModel::setFilterState(int state)
 {
     if (m_filterState != state) {
@@ -70,44 +143,20 @@ int VMProxyModel::totalVMs() const
 
 int VMProxyModel::runningVMs() const
 {
-    int count = 0;
-    if (sourceModel()) {
-        for (int i = 0; i < sourceModel()->rowCount(); ++i) {
-            QModelIndex idx = sourceModel()->index(i, 0);
-            if (getStateFromIndex(idx) == 1) {
-                count++;
-            }
-        }
-    }
-    return count;
+    ensureIndex();
+    return m_stateCounts.value(1);
 }
 
 int VMProxyModel::pausedVMs() const
 {
-    int count = 0;
-    if (sourceModel()) {
-        for (int i = 0; i < sourceModel()->rowCount(); ++i) {
-            QModelIndex idx = sourceModel()->index(i, 0);
-            if (getStateFromIndex(idx) == 2) {
-                count++;
-            }
-        }
-    }
-    return count;
+    ensureIndex();
+    return m_stateCounts.value(2);
 }
 
 int VMProxyModel::stoppedVMs() const
 {
-    int count = 0;
-    if (sourceModel()) {
-        for (int i = 0; i < sourceModel()->rowCount(); ++i) {
-            QModelIndex idx = sourceModel()->index(i, 0);
-            if (getStateFromIndex(idx) == 3 || getStateFromIndex(idx) == 0) {
-                count++;
-            }
-        }
-    }
-    return count;
+    ensureIndex();
+    return m_stateCounts.value(3) + m_stateCounts.value(0);
 }
 
 bool VMProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
@@ -122,25 +171,21 @@ bool VMProxyModel::matchesFilter(const QModelIndex &index) const
         return false;
     }
 
+    ensureIndex();
+    bool indexed = !index.parent().isValid() && index.row() < m_entries.count();
+
     // Search text filter
-    if (!m_filterText.isEmpty()) {
-        bool matchesText = false;
-        for (int col = 0; col < sourceModel()->columnCount(index.parent()); ++col) {
-            QModelIndex colIndex = sourceModel()->index(index.row(), col, index.parent());
-            QString value = sourceModel()->data(colIndex, Qt::DisplayRole).toString();
-            if (value.contains(m_filterText, Qt::CaseInsensitive)) {
-                matchesText = true;
-                break;
-            }
-        }
-        if (!matchesText) {
+    if (!m_queryTokens.isEmpty()) {
+        bool matches = indexed ? m_entries.at(index.row()).matches
+                               : matchesText(buildEntry(index.row()));
+        if (!matches) {
             return false;
         }
     }
 
     // State filter
     if (m_filterState >= 0) {
-        int state = getStateFromIndex(index);
+        int state = indexed ? m_entries.at(index.row()).state : getStateFromIndex(index);
         if (state != m_filterState) {
             return false;
         }
@@ -200,4 +245,178 @@ int VMProxyModel::getStateFromIndex(const QModelIndex &index) const
     return stateData.toInt();
 }
 
+void VMProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid() || m_indexDirty) {
+        return;
+    }
+
+    if (first > m_entries.count()) {
+        m_indexDirty = true;
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        SearchEntry entry = buildEntry(row);
+        entry.matches = matchesText(entry);
+        adjustStateCount(entry.state, 1);
+        m_entries.insert(row, entry);
+    }
+    emit statisticsChanged();
+}
+
+void VMProxyModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid() || m_indexDirty) {
+        return;
+    }
+
+    if (last >= m_entries.count()) {
+        m_indexDirty = true;
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        adjustStateCount(m_entries.at(row).state, -1);
+    }
+    m_entries.remove(first, last - first + 1);
+    emit statisticsChanged();
+}
+
+void VMProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (topLeft.parent().isValid() || m_indexDirty) {
+        return;
+    }
+
+    bool statesChanged = false;
+    int last = qMin(bottomRight.row(), m_entries.count() - 1);
+    for (int row = topLeft.row(); row <= last; ++row) {
+        SearchEntry entry = buildEntry(row);
+        SearchEntry &current = m_entries[row];
+        if (entry.state != current.state) {
+            adjustStateCount(current.state, -1);
+            adjustStateCount(entry.state, 1);
+            statesChanged = true;
+        }
+        if (entry.key != current.key) {
+            entry.matches = matchesText(entry);
+            current = entry;
+        } else {
+            current.state = entry.state;
+        }
+    }
+
+    if (statesChanged) {
+        emit statisticsChanged();
+    }
+}
+
+void VMProxyModel::onSourceLayoutChanged()
+{
+    // Row order is unknown until the change completes; rebuild lazily
+    m_indexDirty = true;
+}
+
+void VMProxyModel::ensureIndex() const
+{
+    if (!m_indexDirty) {
+        return;
+    }
+    m_indexDirty = false;
+
+    m_entries.clear();
+    m_stateCounts.clear();
+    if (!sourceModel()) {
+        return;
+    }
+
+    int rows = sourceModel()->rowCount();
+    m_entries.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        SearchEntry entry = buildEntry(row);
+        entry.matches = matchesText(entry);
+        adjustStateCount(entry.state, 1);
+        m_entries.append(entry);
+    }
+}
+
+VMProxyModel::SearchEntry VMProxyModel::buildEntry(int sourceRow) const
+{
+    SearchEntry entry;
+    QAbstractItemModel *model = sourceModel();
+    QModelIndex index = model->index(sourceRow, 0);
+
+    QString name = model->data(index, VMListModel::NameRole).toString();
+    if (name.isEmpty()) {
+        name = model->data(index, Qt::DisplayRole).toString();
+    }
+
+    QStringList fields;
+    fields << name
+           << model->data(index, VMListModel::TitleRole).toString()
+           << model->data(index, VMListModel::DescriptionRole).toString()
+           << model->data(index, VMListModel::UUIDRole).toString()
+           << model->data(index, VMListModel::IPAddressesRole).toStringList();
+
+    entry.key = normalize(fields.join(QLatin1Char(' ')));
+    entry.signature = trigramSignature(entry.key);
+    entry.state = getStateFromIndex(index);
+    return entry;
+}
+
+bool VMProxyModel::matchesText(const SearchEntry &entry) const
+{
+    if (m_queryTokens.isEmpty()) {
+        return true;
+    }
+
+    // Cheap rejection: every query trigram must be present in the key
+    if ((entry.signature & m_querySignature) != m_querySignature) {
+        return false;
+    }
+
+    for (const QString &token : m_queryTokens) {
+        if (!entry.key.contains(token)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void VMProxyModel::recomputeMatches(bool narrowOnly)
+{
+    if (m_indexDirty) {
+        // ensureIndex() computes matches against the new query
+        return;
+    }
+
+    for (SearchEntry &entry : m_entries) {
+        if (narrowOnly && !entry.matches) {
+            continue;
+        }
+        entry.matches = matchesText(entry);
+    }
+}
+
+void VMProxyModel::adjustStateCount(int state, int delta) const
+{
+    m_stateCounts[state] += delta;
+}
+
+QString VMProxyModel::normalize(const QString &text)
+{
+    return text.toCaseFolded().simplified();
+}
+
+quint64 VMProxyModel::trigramSignature(const QString &text)
+{
+    quint64 signature = 0;
+    QStringView view(text);
+    for (int i = 0; i + 3 <= view.size(); ++i) {
+        signature |= quint64(1) << (qHash(view.mid(i, 3)) & 63);
+    }
+    return signature;
+}
+
 } // namespace QVirt
@@ -15,14 +15,24 @@
 #include "../../core/BaseObject.h"
 #include <QSortFilterProxyModel>
 #include <QString>
+#include <QStringList>
 #include <QDateTime>
+#include <QVector>
+#include <QHash>
+
+class QTimer;
 
 namespace QVirt {
 
 /**
  * @brief Proxy model for VM list filtering and sorting
  *
- * Provides search, state filtering, and custom sorting for VM lists
+ * Provides search, state filtering, and custom sorting for VM lists.
+ *
+ * Search runs against a per-row index of pre-normalized keys (name, title,
+ * description, UUID, IP addresses) that is kept in sync with the source
+ * model, so a keystroke never goes through data() for every row. A query
+ * that extends the previous one only re-tests rows that matched before.
  */
 class VMProxyModel : public QSortFilterProxyModel
 {
@@ -41,10 +51,19 @@ public:
     explicit VMProxyModel(QObject *parent = nullptr);
     ~VMProxyModel() override = default;
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
     // Filter settings
     QString filterText() const { return m_filterText; }
     void setFilterText(const QString &text);
 
+    /**
+     * @brief Delay before a text change is applied (search-as-you-type)
+     * @param msec Debounce interval in milliseconds, 0 applies immediately
+     */
+    int filterDelay() const { return m_filterDelay; }
+    void setFilterDelay(int msec);
+
     int filterState() const { return m_filterState; }
     void setFilterState(int state);
 
@@ -69,14 +88,56 @@ signals:
     void filterUpdated();
     void statisticsChanged();
 
+public slots:
+    // Apply a pending (debounced) filter text change right away
+    void applyPendingFilter();
+
+private slots:
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onSourceLayoutChanged();
+
 private:
+    /**
+     * @brief Pre-normalized search data for one source row
+     */
+    struct SearchEntry {
+        QString key;              // Case-folded fields joined by spaces
+        quint64 signature = 0;    // Bitmask of hashed trigrams in key
+        int state = 0;
+        bool matches = true;      // Result for the applied filter text
+    };
+
     bool matchesFilter(const QModelIndex &index) const;
     int getStateFromIndex(const QModelIndex &index) const;
 
+    // Search index maintenance
+    void ensureIndex() const;
+    SearchEntry buildEntry(int sourceRow) const;
+    bool matchesText(const SearchEntry &entry) const;
+    void recomputeMatches(bool narrowOnly);
+    void adjustStateCount(int state, int delta) const;
+
+    static QString normalize(const QString &text);
+    static quint64 trigramSignature(const QString &text);
+
     QString m_filterText;
     int m_filterState = -1;
     bool m_showFavorites = false;
     SortColumn m_sortColumn = SortColumn::Name;
+
+    // Debounced filter text
+    QTimer *m_filterTimer;
+    int m_filterDelay;
+    QString m_appliedFilterText;
+    QStringList m_queryTokens;
+    quint64 m_querySignature;
+
+    // Search index, one entry per top-level source row
+    mutable QVector<SearchEntry> m_entries;
+    mutable QHash<int, int> m_stateCounts;
+    mutable bool m_indexDirty;
 };
 
 } // namespace QVirt
@@ -0,0 +1,213 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "VolumeListModel.h"
+#include "../../libvirt/StoragePool.h"
+#include "../../libvirt/StorageVolume.h"
+#include "../../libvirt/EnumMapper.h"
+#include "../../core/ByteFormat.h"
+
+#include <QSet>
+
+namespace QVirt {
+
+VolumeListModel::VolumeListModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int VolumeListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_volumes.size());
+}
+
+int VolumeListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant VolumeListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_volumes.size()) {
+        return QVariant();
+    }
+
+    StorageVolume *volume = m_volumes.at(index.row());
+
+    if (role == KeyRole) {
+        return volume->key();
+    }
+
+    if (role == SortRole) {
+        switch (index.column()) {
+        case ColumnName:
+            return volume->name().toLower();
+        case ColumnType:
+            return static_cast<int>(volume->type());
+        case ColumnCapacity:
+            return volume->capacity();
+        case ColumnAllocation:
+            return volume->allocation();
+        case ColumnPath:
+            return volume->path();
+        }
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case ColumnName:
+            return volume->name();
+        case ColumnType:
+            return EnumMapper::volumeTypeToString(volume->type());
+        case ColumnCapacity:
+            return formatSize(volume->capacity());
+        case ColumnAllocation:
+            return formatSize(volume->allocation());
+        case ColumnPath:
+            return volume->path();
+        }
+        return QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole
+        && (index.column() == ColumnCapacity || index.column() == ColumnAllocation)) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    return QVariant();
+}
+
+QVariant VolumeListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+    case ColumnName:
+        return tr("Name");
+    case ColumnType:
+        return tr("Type");
+    case ColumnCapacity:
+        return tr("Capacity");
+    case ColumnAllocation:
+        return tr("Allocation");
+    case ColumnPath:
+        return tr("Path");
+    }
+    return QVariant();
+}
+
+void VolumeListModel::setPool(StoragePool *pool)
+{
+    if (m_pool == pool) {
+        return;
+    }
+
+    if (m_pool) {
+        disconnect(m_pool, nullptr, this, nullptr);
+    }
+
+    beginResetModel();
+    m_pool = pool;
+    m_volumes = pool ? pool->volumes() : QList<StorageVolume*>();
+    endResetModel();
+
+    if (pool) {
+        connect(pool, &StoragePool::volumesChanged, this, &VolumeListModel::onVolumesChanged);
+        connect(pool, &QObject::destroyed, this, &VolumeListModel::onPoolDestroyed);
+    }
+}
+
+void VolumeListModel::setVolumes(const QList<StorageVolume*> &volumes)
+{
+    QSet<StorageVolume*> listed;
+    listed.reserve(volumes.size());
+    for (StorageVolume *volume : volumes) {
+        listed.insert(volume);
+    }
+
+    // Remove rows that are gone, one run of adjacent rows at a time
+    int row = int(m_volumes.size()) - 1;
+    while (row >= 0) {
+        if (listed.contains(m_volumes.at(row))) {
+            --row;
+            continue;
+        }
+        int last = row;
+        while (row > 0 && !listed.contains(m_volumes.at(row - 1))) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_volumes.erase(m_volumes.begin() + row, m_volumes.begin() + last + 1);
+        endRemoveRows();
+        --row;
+    }
+
+    // Sizes of the rows kept may have changed
+    if (!m_volumes.isEmpty()) {
+        emit dataChanged(index(0, 0), index(int(m_volumes.size()) - 1, ColumnCount - 1));
+    }
+
+    // Append the new ones
+    QSet<StorageVolume*> known;
+    known.reserve(m_volumes.size());
+    const QList<StorageVolume*> &kept = m_volumes;
+    for (StorageVolume *volume : kept) {
+        known.insert(volume);
+    }
+    QList<StorageVolume*> added;
+    for (StorageVolume *volume : volumes) {
+        if (!known.contains(volume)) {
+            added.append(volume);
+        }
+    }
+    if (!added.isEmpty()) {
+        const int first = int(m_volumes.size());
+        beginInsertRows(QModelIndex(), first, first + int(added.size()) - 1);
+        m_volumes.append(added);
+        endInsertRows();
+    }
+}
+
+StorageVolume *VolumeListModel::volumeAt(int row) const
+{
+    return row >= 0 && row < m_volumes.size() ? m_volumes.at(row) : nullptr;
+}
+
+int VolumeListModel::rowOf(StorageVolume *volume) const
+{
+    return int(m_volumes.indexOf(volume));
+}
+
+QString VolumeListModel::formatSize(qint64 bytes)
+{
+    return formatBytes(bytes);
+}
+
+void VolumeListModel::onVolumesChanged()
+{
+    if (m_pool) {
+        setVolumes(m_pool->volumes());
+    }
+}
+
+void VolumeListModel::onPoolDestroyed()
+{
+    // The wrappers went with their pool
+    beginResetModel();
+    m_pool = nullptr;
+    m_volumes.clear();
+    endResetModel();
+}
+
+} // namespace QVirt
@@ -0,0 +1,95 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_MODELS_VOLUMELISTMODEL_H
+#define QVIRT_UI_MODELS_VOLUMELISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QPointer>
+
+namespace QVirt {
+
+class StoragePool;
+class StorageVolume;
+
+/**
+ * @brief Table model over the cached volumes of a storage pool
+ *
+ * Rows point at the pool's StorageVolume wrappers and cells are formatted
+ * in data(), so only the rows a view paints cost anything. Switching pools
+ * is a model reset; a volume refresh of the same pool inserts and removes
+ * just the rows that changed.
+ *
+ * SortRole gives raw values (sizes in bytes) for a QSortFilterProxyModel,
+ * which also provides the name filter.
+ */
+class VolumeListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnName,
+        ColumnType,
+        ColumnCapacity,
+        ColumnAllocation,
+        ColumnPath,
+        ColumnCount
+    };
+
+    enum Roles {
+        SortRole = Qt::UserRole + 1,
+        KeyRole
+    };
+
+    explicit VolumeListModel(QObject *parent = nullptr);
+
+    // QAbstractTableModel interface
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Show the volumes of @p pool and follow its refreshes
+     *
+     * Setting the pool already shown does nothing.
+     */
+    void setPool(StoragePool *pool);
+    StoragePool *pool() const { return m_pool; }
+
+    /**
+     * @brief Bring the rows in line with @p volumes
+     *
+     * Rows of volumes no longer listed are removed, new volumes are
+     * appended, and the rest stay where they are.
+     */
+    void setVolumes(const QList<StorageVolume*> &volumes);
+
+    StorageVolume *volumeAt(int row) const;
+    int rowOf(StorageVolume *volume) const;
+
+    static QString formatSize(qint64 bytes);
+
+private slots:
+    void onVolumesChanged();
+    void onPoolDestroyed();
+
+private:
+    QPointer<StoragePool> m_pool;
+    QList<StorageVolume*> m_volumes;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_MODELS_VOLUMELISTMODEL_H
@@ -0,0 +1,370 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "BackupsPage.h"
+#include "../../libvirt/Connection.h"
+#include "../../libvirt/DomainCheckpoint.h"
+#include "../../core/Config.h"
+#include "../../core/ByteFormat.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QSplitter>
+#include <QFileDialog>
+#include <QMessageBox>
+
+namespace QVirt {
+
+namespace {
+
+QString connectionUri(Domain *domain)
+{
+    return domain && domain->connection() ? domain->connection()->uri() : QString();
+}
+
+} // namespace
+
+BackupsPage::BackupsPage(Domain *domain, QWidget *parent)
+    : QWidget(parent)
+    , m_domain(domain)
+    , m_manager(BackupManager::instance())
+{
+    setupUI();
+    loadPolicy();
+
+    connect(m_manager, &BackupManager::jobAdded, this, &BackupsPage::onJobAdded);
+
+    // Pick up a backup that is already running, e.g. from the schedule
+    for (BackupJob *job : m_manager->jobs(m_domain)) {
+        if (!job->isDone()) {
+            watchJob(job);
+        }
+    }
+
+    refresh();
+}
+
+void BackupsPage::setupUI()
+{
+    auto *layout = new QVBoxLayout(this);
+
+    // Back up now
+    auto *backupGroup = new QGroupBox("Back Up", this);
+    auto *backupLayout = new QVBoxLayout(backupGroup);
+
+    auto *targetLayout = new QHBoxLayout();
+    m_targetEdit = new QLineEdit(backupGroup);
+    m_targetEdit->setPlaceholderText("Directory on the host running the VM");
+    auto *btnBrowse = new QPushButton("Browse...", backupGroup);
+    connect(btnBrowse, &QPushButton::clicked, this, &BackupsPage::onBrowse);
+    targetLayout->addWidget(new QLabel("Target:", backupGroup));
+    targetLayout->addWidget(m_targetEdit, 1);
+    targetLayout->addWidget(btnBrowse);
+    backupLayout->addLayout(targetLayout);
+
+    auto *actionLayout = new QHBoxLayout();
+    m_modeCombo = new QComboBox(backupGroup);
+    m_modeCombo->addItem("Incremental if possible", BackupJob::Auto);
+    m_modeCombo->addItem("Full", BackupJob::Full);
+    m_modeCombo->addItem("Incremental only", BackupJob::Incremental);
+    m_btnBackup = new QPushButton("Back Up Now", backupGroup);
+    m_btnCancel = new QPushButton("Cancel", backupGroup);
+    connect(m_btnBackup, &QPushButton::clicked, this, &BackupsPage::onBackup);
+    connect(m_btnCancel, &QPushButton::clicked, this, &BackupsPage::onCancel);
+    actionLayout->addWidget(m_modeCombo);
+    actionLayout->addStretch();
+    actionLayout->addWidget(m_btnBackup);
+    actionLayout->addWidget(m_btnCancel);
+    backupLayout->addLayout(actionLayout);
+
+    m_progressBar = new QProgressBar(backupGroup);
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setValue(0);
+    m_jobLabel = new QLabel(backupGroup);
+    m_jobLabel->setWordWrap(true);
+    backupLayout->addWidget(m_progressBar);
+    backupLayout->addWidget(m_jobLabel);
+    layout->addWidget(backupGroup);
+
+    // Schedule
+    auto *policyGroup = new QGroupBox("Schedule", this);
+    auto *policyLayout = new QFormLayout(policyGroup);
+    m_policyEnabled = new QCheckBox("Back up this VM automatically", policyGroup);
+    m_intervalSpin = new QSpinBox(policyGroup);
+    m_intervalSpin->setRange(1, 24 * 30);
+    m_intervalSpin->setSuffix(" h");
+    m_fullEverySpin = new QSpinBox(policyGroup);
+    m_fullEverySpin->setRange(0, 365);
+    m_fullEverySpin->setSpecialValueText("Never");
+    m_fullEverySpin->setToolTip("Incremental backups between two full ones");
+    m_lastRunLabel = new QLabel(policyGroup);
+    auto *btnSavePolicy = new QPushButton("Save Schedule", policyGroup);
+    connect(btnSavePolicy, &QPushButton::clicked, this, &BackupsPage::onSavePolicy);
+    policyLayout->addRow(m_policyEnabled);
+    policyLayout->addRow("Every:", m_intervalSpin);
+    policyLayout->addRow("Full backup after:", m_fullEverySpin);
+    policyLayout->addRow("Last backup:", m_lastRunLabel);
+    policyLayout->addRow(btnSavePolicy);
+    layout->addWidget(policyGroup);
+
+    // Catalog and checkpoints
+    auto *splitter = new QSplitter(Qt::Horizontal, this);
+    m_backupList = new QTreeWidget(splitter);
+    m_backupList->setRootIsDecorated(false);
+    m_backupList->setHeaderLabels({"Started", "Mode", "Copied", "Restorable", "Directory"});
+    m_backupList->header()->setStretchLastSection(true);
+    m_checkpointList = new QTreeWidget(splitter);
+    m_checkpointList->setRootIsDecorated(false);
+    m_checkpointList->setHeaderLabels({"Checkpoint", "Parent", "Created", "Changed Since"});
+    m_checkpointList->header()->setStretchLastSection(true);
+    splitter->addWidget(m_backupList);
+    splitter->addWidget(m_checkpointList);
+    layout->addWidget(splitter, 1);
+
+    auto *btnRefresh = new QPushButton("Refresh", this);
+    connect(btnRefresh, &QPushButton::clicked, this, &BackupsPage::refresh);
+    auto *refreshLayout = new QHBoxLayout();
+    refreshLayout->addStretch();
+    refreshLayout->addWidget(btnRefresh);
+    layout->addLayout(refreshLayout);
+}
+
+void BackupsPage::refresh()
+{
+    updateCatalog();
+    updateCheckpoints();
+    updateJobStatus();
+}
+
+void BackupsPage::loadPolicy()
+{
+    BackupPolicy policy = Config::instance()->vmBackupPolicy(connectionUri(m_domain),
+                                                             m_domain->uuid());
+    m_targetEdit->setText(policy.targetDir);
+    m_policyEnabled->setChecked(policy.enabled);
+    m_intervalSpin->setValue(policy.intervalHours);
+    m_fullEverySpin->setValue(policy.fullEvery);
+    m_lastRunLabel->setText(policy.lastRun > 0
+        ? QDateTime::fromSecsSinceEpoch(policy.lastRun).toString("yyyy-MM-dd hh:mm")
+        : QString("Never"));
+}
+
+void BackupsPage::onBrowse()
+{
+    QString path = QFileDialog::getExistingDirectory(this, "Select Backup Directory",
+                                                     m_targetEdit->text());
+    if (!path.isEmpty()) {
+        m_targetEdit->setText(path);
+        updateCatalog();
+    }
+}
+
+void BackupsPage::onBackup()
+{
+    if (m_targetEdit->text().isEmpty()) {
+        QMessageBox::warning(this, "Back Up", "Choose a target directory first.");
+        return;
+    }
+
+    auto mode = static_cast<BackupJob::Mode>(m_modeCombo->currentData().toInt());
+    watchJob(m_manager->backup(m_domain, m_targetEdit->text(), mode));
+}
+
+void BackupsPage::onCancel()
+{
+    if (m_job) {
+        m_manager->cancel(m_job);
+    }
+}
+
+void BackupsPage::onSavePolicy()
+{
+    if (m_policyEnabled->isChecked() && m_targetEdit->text().isEmpty()) {
+        QMessageBox::warning(this, "Schedule", "Choose a target directory first.");
+        return;
+    }
+
+    const QString uri = connectionUri(m_domain);
+    BackupPolicy policy = Config::instance()->vmBackupPolicy(uri, m_domain->uuid());
+    policy.enabled = m_policyEnabled->isChecked();
+    policy.targetDir = m_targetEdit->text();
+    policy.intervalHours = m_intervalSpin->value();
+    policy.fullEvery = m_fullEverySpin->value();
+    Config::instance()->setVMBackupPolicy(uri, m_domain->uuid(), policy);
+    loadPolicy();
+}
+
+void BackupsPage::onJobAdded(BackupJob *job)
+{
+    if (job->domain() == m_domain) {
+        watchJob(job);
+    }
+}
+
+void BackupsPage::watchJob(BackupJob *job)
+{
+    if (!job || job == m_job) {
+        return;
+    }
+    if (m_job) {
+        disconnect(m_job, nullptr, this, nullptr);
+    }
+    m_job = job;
+
+    connect(job, &BackupJob::progress, this, &BackupsPage::updateJobStatus);
+    connect(job, &BackupJob::stateChanged, this, [this](BackupJob::State state) {
+        updateJobStatus();
+        if (state == BackupJob::Finished || state == BackupJob::Failed
+            || state == BackupJob::Cancelled) {
+            loadPolicy();
+            updateCatalog();
+            updateCheckpoints();
+        }
+    });
+    updateJobStatus();
+}
+
+void BackupsPage::updateJobStatus()
+{
+    const bool running = m_job && !m_job->isDone();
+    const bool local = !m_domain->connection() || m_domain->connection()->isLocal();
+    m_btnBackup->setEnabled(!running && local);
+    m_btnBackup->setToolTip(local ? QString()
+                                  : QString("Backups are only supported on local connections"));
+    m_btnCancel->setEnabled(m_job && m_job->isCancellable());
+
+    if (!m_job) {
+        m_progressBar->setValue(0);
+        m_jobLabel->setText("No backup running.");
+        return;
+    }
+
+    BackupJob *job = m_job;
+    const QString mode = job->mode() == BackupJob::Incremental ? QString("Incremental")
+                       : job->mode() == BackupJob::Full ? QString("Full") : QString("Backup");
+
+    if (job->state() == BackupJob::Starting || job->state() == BackupJob::Queued) {
+        m_progressBar->setRange(0, 0);
+    } else {
+        m_progressBar->setRange(0, 100);
+        int percent = job->state() == BackupJob::Finished ? 100 : 0;
+        if (job->state() == BackupJob::Running && job->totalBytes() > 0) {
+            percent = int(job->processedBytes() * 100 / job->totalBytes());
+        }
+        m_progressBar->setValue(percent);
+    }
+
+    QString text;
+    switch (job->state()) {
+    case BackupJob::Queued:
+        text = "Queued";
+        break;
+    case BackupJob::Starting:
+        text = "Starting...";
+        break;
+    case BackupJob::Running:
+        text = QString("%1 backup: %2 of %3 at %4/s")
+                   .arg(mode, formatBytes(job->processedBytes()), formatBytes(job->totalBytes()),
+                        formatBytes(job->throughput()));
+        break;
+    case BackupJob::Finished:
+        text = QString("%1 backup done: %2 copied in %3 s (%4/s)")
+                   .arg(mode, formatBytes(job->processedBytes()))
+                   .arg(job->elapsedMs() / 1000)
+                   .arg(formatBytes(job->throughput()));
+        break;
+    case BackupJob::Failed:
+        text = QString("Backup failed: %1").arg(job->errorString());
+        break;
+    case BackupJob::Cancelled:
+        text = "Backup cancelled";
+        break;
+    }
+    if (job->changedBytes() >= 0) {
+        text += QString("\nChanged since %1: %2")
+                    .arg(job->parentCheckpoint(), formatBytes(job->changedBytes()));
+    }
+    if (!job->skippedDisks().isEmpty()) {
+        text += QString("\nNot backed up (not qcow2 or read-only): %1")
+                    .arg(job->skippedDisks().join(", "));
+    }
+    m_jobLabel->setText(text);
+}
+
+void BackupsPage::updateCatalog()
+{
+    m_backupList->clear();
+    if (m_targetEdit->text().isEmpty()) {
+        return;
+    }
+
+    BackupCatalog catalog(BackupManager::catalogDirectory(m_targetEdit->text(), m_domain->name()));
+    QString error;
+    if (!catalog.load(&error)) {
+        auto *item = new QTreeWidgetItem(m_backupList);
+        item->setText(0, error);
+        return;
+    }
+
+    const QList<BackupRecord> records = catalog.records();
+    for (int i = int(records.size()) - 1; i >= 0; --i) {
+        const BackupRecord &record = records.at(i);
+        const QList<BackupRecord> chain = catalog.restoreChain(i);
+
+        auto *item = new QTreeWidgetItem(m_backupList);
+        item->setText(0, record.started.toString("yyyy-MM-dd hh:mm"));
+        item->setText(1, record.mode == BackupRecord::Incremental ? "Incremental" : "Full");
+        item->setText(2, formatBytes(record.bytes));
+        if (chain.isEmpty()) {
+            item->setText(3, "No, chain broken");
+        } else if (chain.size() == 1) {
+            item->setText(3, "Yes");
+        } else {
+            item->setText(3, QString("Yes, with %1 earlier").arg(chain.size() - 1));
+        }
+        item->setText(4, catalog.path(record));
+        item->setToolTip(4, QString("Checkpoint %1").arg(record.checkpoint));
+    }
+}
+
+void BackupsPage::updateCheckpoints()
+{
+    m_checkpointList->clear();
+
+    // Sizes come from QEMU's bitmaps and need the VM running
+    const bool running = m_domain->state() == Domain::StateRunning
+        || m_domain->state() == Domain::StatePaused;
+    const QList<DomainCheckpoint*> checkpoints = m_manager->checkpoints(m_domain);
+    for (DomainCheckpoint *checkpoint : checkpoints) {
+        if (running) {
+            checkpoint->reload(true);
+        }
+        auto *item = new QTreeWidgetItem(m_checkpointList);
+        item->setText(0, checkpoint->name());
+        item->setText(1, checkpoint->parentName());
+        item->setText(2, checkpoint->creationTime().toString("yyyy-MM-dd hh:mm"));
+        item->setText(3, formatBytes(checkpoint->changedBytes()));
+        delete checkpoint;
+    }
+}
+
+} // namespace QVirt
@@ -0,0 +1,86 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_VMWINDOW_BACKUPSPAGE_H
+#define QVIRT_UI_VMWINDOW_BACKUPSPAGE_H
+
+#include <QWidget>
+#include <QPointer>
+
+#include "../../libvirt/Domain.h"
+#include "../../libvirt/BackupManager.h"
+
+class QLineEdit;
+class QComboBox;
+class QCheckBox;
+class QSpinBox;
+class QPushButton;
+class QProgressBar;
+class QLabel;
+class QTreeWidget;
+
+namespace QVirt {
+
+/**
+ * @brief Backups Page for VMWindow
+ *
+ * Starts full and incremental backups of the VM, shows the running one
+ * with its throughput, lists the backups in the catalog and the VM's
+ * checkpoints, and edits the VM's backup schedule.
+ */
+class BackupsPage : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit BackupsPage(Domain *domain, QWidget *parent = nullptr);
+    ~BackupsPage() override = default;
+
+    void refresh();
+
+private slots:
+    void onBrowse();
+    void onBackup();
+    void onCancel();
+    void onSavePolicy();
+    void onJobAdded(QVirt::BackupJob *job);
+    void updateJobStatus();
+
+private:
+    void setupUI();
+    void loadPolicy();
+    void updateCatalog();
+    void updateCheckpoints();
+    void watchJob(BackupJob *job);
+
+    Domain *m_domain;
+    BackupManager *m_manager;
+    QPointer<BackupJob> m_job;
+
+    QLineEdit *m_targetEdit;
+    QComboBox *m_modeCombo;
+    QPushButton *m_btnBackup;
+    QPushButton *m_btnCancel;
+    QProgressBar *m_progressBar;
+    QLabel *m_jobLabel;
+
+    QCheckBox *m_policyEnabled;
+    QSpinBox *m_intervalSpin;
+    QSpinBox *m_fullEverySpin;
+    QLabel *m_lastRunLabel;
+
+    QTreeWidget *m_backupList;
+    QTreeWidget *m_checkpointList;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_VMWINDOW_BACKUPSPAGE_H
@@ -13,6 +13,8 @@
 #include "../../libvirt/EnumMapper.h"
 #include "../../console/VNCViewer.h"
 #include "../../console/SpiceViewer.h"
+#include "../../console/SerialConsole.h"
+#include "../../libvirt/ConsoleStream.h"
 
 #include <QMessageBox>
 #include <QInputDialog>
@@ -26,6 +28,7 @@ ConsolePage::ConsolePage(Domain *domain, QWidget *parent)
     , m_fullscreen(false)
     , m_vncViewer(nullptr)
     , m_spiceViewer(nullptr)
+    , m_serialConsole(nullptr)
     , m_currentViewer(nullptr)
 {
     setupUI();
@@ -88,10 +91,22 @@ void ConsolePage::setupViewerStack()
         }
     });
     connect(m_spiceViewer, &SpiceViewer::errorOccurred, this, &ConsolePage::onViewerError);
+
+    // Text console for guests without graphics, over a libvirt stream
+    m_serialConsole = new SerialConsole(this);
+    connect(m_serialConsole, &SerialConsole::connected, this, &ConsolePage::onViewerConnected);
+    connect(m_serialConsole, &SerialConsole::connectionError, this, &ConsolePage::onViewerError);
+    connect(m_serialConsole, &SerialConsole::disconnected, this, [this]() {
+        // Stay on the console so its last lines and close reason remain readable
+        m_connected = false;
+        m_statusLabel->setText("Disconnected");
+        m_toolbar->setConnected(false);
+    });
     
     // Add viewers to stack
     m_viewStack->addWidget(m_vncViewer);
     m_viewStack->addWidget(m_spiceViewer);
+    m_viewStack->addWidget(m_serialConsole);
 }
 
 void ConsolePage::setupToolbar()
@@ -359,6 +374,8 @@ void ConsolePage::connectConsole()
             m_spiceViewer->connectToHost(host, port);
             m_statusLabel->setText("Connecting to SPICE...");
         }
+    } else if (hasTextConsole(xml)) {
+        connectSerialConsole();
     } else {
         QMessageBox::warning(this, "No Console",
             "No VNC or SPICE graphics device configured for this VM.");
@@ -366,6 +383,26 @@ void ConsolePage::connectConsole()
     }
 }
 
+bool ConsolePage::hasTextConsole(const QString &xml)
+{
+    return xml.contains("<console") || xml.contains("<serial");
+}
+
+void ConsolePage::connectSerialConsole()
+{
+    // Goes through the libvirt connection, so remote guests work too
+    auto *stream = new ConsoleStream();
+    if (!stream->openConsole(m_domain)) {
+        QString error = stream->errorString();
+        delete stream;
+        onViewerError(error);
+        return;
+    }
+
+    m_viewStack->setCurrentWidget(m_serialConsole);
+    m_serialConsole->connectToStream(stream);
+}
+
 void ConsolePage::disconnectConsole()
 {
     if (m_vncViewer) {
@@ -374,6 +411,9 @@ void ConsolePage::disconnectConsole()
     if (m_spiceViewer) {
         m_spiceViewer->disconnect();
     }
+    if (m_serialConsole && m_serialConsole->isConnected()) {
+        m_serialConsole->disconnect();
+    }
 
     m_connected = false;
     m_statusLabel->setText("Disconnected");
@@ -512,7 +552,11 @@ void ConsolePage::onViewerError(const QString &message)
 void ConsolePage::onViewerConnected()
 {
     m_connected = true;
-    m_statusLabel->setText("Connected to " + m_graphicsType + " console");
+    if (m_viewStack->currentWidget() == m_serialConsole) {
+        m_statusLabel->setText("Connected to serial console");
+    } else {
+        m_statusLabel->setText("Connected to " + m_graphicsType + " console");
+    }
     m_toolbar->setConnected(true);
     m_toolbar->setViewerType(m_graphicsType);
     emit consoleConnected();
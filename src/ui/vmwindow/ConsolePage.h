@@ -31,6 +31,7 @@ namespace QVirt {
 // Forward declarations
 class VNCViewer;
 class SpiceViewer;
+class SerialConsole;
 
 /**
  * @brief Console Page for VMWindow
@@ -82,6 +83,9 @@ private:
     void setupPlaceholderView();
     void updateConsoleInfo();
     QString getGraphicsType() const;
+    // @p xml is the domain XML connectConsole() already fetched
+    static bool hasTextConsole(const QString &xml);
+    void connectSerialConsole();
 
     Domain *m_domain;
 
@@ -108,6 +112,7 @@ private:
     // Viewer widgets
     VNCViewer *m_vncViewer;
     SpiceViewer *m_spiceViewer;
+    SerialConsole *m_serialConsole;
     QWidget *m_currentViewer;
     QString m_graphicsType;
 };
@@ -13,12 +13,17 @@
 #include "../dialogs/AddHardwareDialog.h"
 #include "../../core/Error.h"
 #include "../../libvirt/EnumMapper.h"
+#include "../../libvirt/Connection.h"
+#include "../../core/ImageInspector.h"
+#include "../../core/ByteFormat.h"
 
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QIcon>
 #include <QDomDocument>
 #include <QTextStream>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 namespace QVirt {
 
@@ -26,6 +31,7 @@ DetailsPage::DetailsPage(Domain *domain, QWidget *parent)
     : QWidget(parent)
     , m_readOnly(false)
     , m_domain(domain)
+    , m_treeGeneration(0)
 {
     setupUI();
     updateReadOnlyMode();
@@ -136,6 +142,7 @@ void DetailsPage::updateReadOnlyMode()
 void DetailsPage::populateDeviceTree()
 {
     m_deviceTree->clear();
+    m_treeGeneration++;
 
     // Parse domain XML once and reuse for all sections
     QString xml = m_domain->getXMLDesc();
@@ -199,6 +206,8 @@ void DetailsPage::populateDeviceTree()
     // Disks section - properly parse from XML
     auto *disksItem = addDeviceCategory("Disk Devices", "drive-harddisk");
     bool hasDisks = false;
+    const bool localHost = m_domain->connection() && m_domain->connection()->isLocal();
+    QList<LocalDisk> localDisks;
     if (xmlValid) {
         QDomElement root = doc.documentElement();
         QDomNodeList diskNodes = root.elementsByTagName("disk");
@@ -217,13 +226,23 @@ void DetailsPage::populateDeviceTree()
             if (!sourceFile.isEmpty()) {
                 diskInfo += QString(" (%1)").arg(sourceFile);
             }
-            addDevice(disksItem, QString("Disk %1").arg(i + 1), diskInfo);
+
+            auto *diskItem = addDevice(disksItem, QString("Disk %1").arg(i + 1), diskInfo);
+
+            // Local images: format, sizes and backing chain from the headers
+            if (localHost && diskElement.attribute("type") == "file" && !sourceFile.isEmpty()) {
+                localDisks.append({diskItem, sourceFile,
+                                   diskElement.firstChildElement("driver").attribute("type")});
+            }
             hasDisks = true;
         }
     }
     if (!hasDisks) {
         addDevice(disksItem, "No disk devices", "-");
     }
+    if (!localDisks.isEmpty()) {
+        loadBackingChains(localDisks);
+    }
 
     // Network section - properly parse from XML
     auto *netItem = addDeviceCategory("Network Interfaces", "network-wired");
@@ -408,6 +427,58 @@ QTreeWidgetItem* DetailsPage::addDeviceCategory(const QString &name, const QStri
     return item;
 }
 
+void DetailsPage::loadBackingChains(const QList<LocalDisk> &disks)
+{
+    QStringList paths;
+    for (const LocalDisk &disk : disks) {
+        paths << disk.path;
+    }
+
+    // Every image of every chain is opened: keep it off the GUI thread
+    const quint64 generation = m_treeGeneration;
+    auto *watcher = new QFutureWatcher<QList<QList<ImageInfo>>>(this);
+    connect(watcher, &QFutureWatcher<QList<QList<ImageInfo>>>::finished, this,
+            [this, watcher, disks, generation]() {
+        watcher->deleteLater();
+        if (generation != m_treeGeneration) {
+            return;                 // The items are gone with the old tree
+        }
+
+        const QList<QList<ImageInfo>> chains = watcher->result();
+        for (int i = 0; i < disks.size() && i < chains.size(); ++i) {
+            const QList<ImageInfo> &chain = chains.at(i);
+            if (chain.isEmpty() || !chain.first().isReadable()) {
+                continue;
+            }
+
+            // A header that is not recognised says nothing; keep libvirt's format then
+            const ImageInfo &top = chain.first();
+            const QString format = top.isValid() ? top.formatName() : disks.at(i).driverFormat;
+            QTreeWidgetItem *diskItem = disks.at(i).item;
+            diskItem->setText(1, diskItem->text(1)
+                                     + QString(" - %1, %2 virtual, %3 used")
+                                           .arg(format.isEmpty() ? QString("unknown format") : format,
+                                                formatBytes(top.virtualSize),
+                                                formatBytes(top.allocation)));
+            for (int j = 1; j < chain.size(); ++j) {
+                const ImageInfo &image = chain.at(j);
+                const QString imageFormat = image.isValid() ? image.formatName()
+                                            : image.isReadable() ? QString("unknown format")
+                                            : image.error;
+                addDevice(diskItem, QString("Backing %1").arg(j),
+                          QString("%1 (%2)").arg(image.path, imageFormat));
+            }
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([paths]() {
+        QList<QList<ImageInfo>> chains;
+        for (const QString &path : paths) {
+            chains.append(ImageInspector::backingChain(path));
+        }
+        return chains;
+    }));
+}
+
 QTreeWidgetItem* DetailsPage::addDevice(QTreeWidgetItem *parent, const QString &name, const QString &details)
 {
     auto *item = new QTreeWidgetItem(parent);
@@ -52,6 +52,14 @@ private:
     void setupUI();
     void populateDeviceTree();
     void updateReadOnlyMode();
+
+    // Local disk image whose backing chain is read in the background
+    struct LocalDisk {
+        QTreeWidgetItem *item;
+        QString path;
+        QString driverFormat;       // As libvirt has it
+    };
+    void loadBackingChains(const QList<LocalDisk> &disks);
     QLabel *m_readOnlyLabel;
     bool m_readOnly;
     QTreeWidgetItem* addDeviceCategory(const QString &name, const QString &icon);
@@ -74,6 +82,9 @@ private:
 
     // Currently selected device info
     QString m_currentDeviceXML;
+
+    // Bumped on every rebuild of the tree; older chain reads are dropped
+    quint64 m_treeGeneration;
 };
 
 } // namespace QVirt
@@ -162,6 +162,12 @@ void OverviewPage::setupUI()
     m_memoryGraph->setMaxDataPoints(60); // 60 seconds of data
     graphLayout->addWidget(m_memoryGraph, 0, 1);
 
+    // Long-horizon history of all metrics, fed directly by the domain
+    m_timelineGraph = new TimelineGraphWidget(this);
+    m_timelineGraph->setMinimumHeight(180);
+    m_timelineGraph->setDomain(m_domain);
+    graphLayout->addWidget(m_timelineGraph, 1, 0, 1, 2);
+
     mainLayout->addWidget(m_graphsGroup);
 
     // Setup graph update timer (update every 2 seconds)
@@ -21,6 +21,7 @@
 
 #include "../../libvirt/Domain.h"
 #include "../widgets/GraphWidget.h"
+#include "../widgets/TimelineGraphWidget.h"
 
 class GuestAgentDetails;
 
@@ -84,6 +85,7 @@ private:
     QGroupBox *m_graphsGroup;
     GraphWidget *m_cpuGraph;
     GraphWidget *m_memoryGraph;
+    TimelineGraphWidget *m_timelineGraph;
     QTimer *m_graphUpdateTimer;
 };
 
@@ -22,71 +22,130 @@
 #include <QTextEdit>
 #include <QCheckBox>
 #include <QDateTime>
+#include <QFont>
 #include <QFontDatabase>
 
 namespace QVirt {
 
 //=============================================================================
-// SnapshotListModel
+// SnapshotTreeModel
 //=============================================================================
 
-SnapshotListModel::SnapshotListModel(QObject *parent)
-    : QAbstractTableModel(parent)
+SnapshotTreeModel::SnapshotTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
 {
 }
 
-void SnapshotListModel::setSnapshots(const QList<DomainSnapshot*> &snapshots)
+void SnapshotTreeModel::setTree(const QList<SnapshotTree::Node> &nodes, const QList<int> &roots)
 {
     beginResetModel();
-    m_snapshots = snapshots;
+    m_nodes = nodes;
+    m_roots = roots;
+
+    QList<int> rows;
+    rows.reserve(m_nodes.size());
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        rows.append(0);
+    }
+    for (int row = 0; row < m_roots.size(); ++row) {
+        rows[m_roots.at(row)] = row;
+    }
+    for (const SnapshotTree::Node &node : m_nodes) {
+        for (int row = 0; row < node.children.size(); ++row) {
+            rows[node.children.at(row)] = row;
+        }
+    }
+    m_rows = rows;
     endResetModel();
 }
 
-DomainSnapshot* SnapshotListModel::snapshotAt(int row) const
+const SnapshotTree::Node *SnapshotTreeModel::nodeAt(const QModelIndex &index) const
 {
-    if (row >= 0 && row < m_snapshots.size()) {
-        return m_snapshots.at(row);
+    if (!index.isValid() || index.internalId() >= quintptr(m_nodes.size())) {
+        return nullptr;
     }
-    return nullptr;
+    return &m_nodes.at(int(index.internalId()));
 }
 
-int SnapshotListModel::rowCount(const QModelIndex &parent) const
+QModelIndex SnapshotTreeModel::indexOf(const QString &name) const
 {
-    Q_UNUSED(parent);
-    return m_snapshots.size();
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes.at(i).name == name) {
+            return createIndex(m_rows.at(i), 0, quintptr(i));
+        }
+    }
+    return QModelIndex();
+}
+
+QModelIndex SnapshotTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const QList<int> &siblings = parent.isValid()
+        ? m_nodes.at(int(parent.internalId())).children : m_roots;
+    if (row < 0 || row >= siblings.size() || column < 0 || column >= columnCount()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, quintptr(siblings.at(row)));
+}
+
+QModelIndex SnapshotTreeModel::parent(const QModelIndex &child) const
+{
+    const SnapshotTree::Node *node = nodeAt(child);
+    if (!node || node->parent < 0) {
+        return QModelIndex();
+    }
+    return createIndex(m_rows.at(node->parent), 0, quintptr(node->parent));
 }
 
-int SnapshotListModel::columnCount(const QModelIndex &parent) const
+int SnapshotTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_roots.size();
+    }
+    if (parent.column() != 0) {
+        return 0;
+    }
+    const SnapshotTree::Node *node = nodeAt(parent);
+    return node ? node->children.size() : 0;
+}
+
+int SnapshotTreeModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return 3; // Name, Time, State
+    return 4; // Name, Time, State, Description
 }
 
-QVariant SnapshotListModel::data(const QModelIndex &index, int role) const
+QVariant SnapshotTreeModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() >= m_snapshots.size()) {
+    const SnapshotTree::Node *node = nodeAt(index);
+    if (!node) {
         return QVariant();
     }
 
-    DomainSnapshot *snapshot = m_snapshots.at(index.row());
-
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
         case 0:
-            return snapshot->name();
+            return node->current ? QString("%1 (current)").arg(node->name) : node->name;
         case 1:
-            return snapshot->creationTime().toString("yyyy-MM-dd hh:mm:ss");
+            return node->creationTime.toString("yyyy-MM-dd hh:mm:ss");
         case 2:
-            return EnumMapper::stateToString(snapshot->state());
+            return node->diskOnly ? QString("Disk only") : EnumMapper::stateToString(node->state);
+        case 3:
+            return node->description.section('\n', 0, 0);
         default:
             break;
         }
+    } else if (role == Qt::FontRole && node->current) {
+        QFont font;
+        font.setBold(true);
+        return font;
+    } else if (role == Qt::ToolTipRole && index.column() == 3) {
+        return node->description;
     }
 
     return QVariant();
 }
 
-QVariant SnapshotListModel::headerData(int section, Qt::Orientation orientation, int role) const
+QVariant SnapshotTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
         switch (section) {
@@ -96,6 +155,8 @@ QVariant SnapshotListModel::headerData(int section, Qt::Orientation orientation,
             return "Created";
         case 2:
             return "State";
+        case 3:
+            return "Description";
         }
     }
 
@@ -109,12 +170,18 @@ QVariant SnapshotListModel::headerData(int section, Qt::Orientation orientation,
 SnapshotsPage::SnapshotsPage(Domain *domain, QWidget *parent)
     : QWidget(parent)
     , m_domain(domain)
-    , m_currentSnapshot(nullptr)
+    , m_tree(domain->snapshotTree())
 {
     setupUI();
     setupSnapshotList();
     setupSnapshotInfo();
-    updateSnapshotList();
+
+    connect(m_tree, &SnapshotTree::changed, this, &SnapshotsPage::onTreeChanged);
+    connect(m_tree, &SnapshotTree::loadFailed, this, &SnapshotsPage::onTreeLoadFailed);
+
+    // Show what is cached right away; load() only fetches when it is stale
+    onTreeChanged();
+    m_tree->load();
 }
 
 void SnapshotsPage::setupUI()
@@ -134,21 +201,24 @@ void SnapshotsPage::setupUI()
     auto *listGroup = new QGroupBox("Snapshots", topWidget);
     auto *listLayout = new QVBoxLayout(listGroup);
 
-    m_snapshotList = new QTableView(listGroup);
+    m_snapshotList = new QTreeView(listGroup);
     m_snapshotList->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_snapshotList->setSelectionMode(QAbstractItemView::SingleSelection);
     m_snapshotList->setAlternatingRowColors(true);
     m_snapshotList->setContextMenuPolicy(Qt::CustomContextMenu);
-    m_snapshotList->horizontalHeader()->setStretchLastSection(true);
-    m_snapshotList->verticalHeader()->setVisible(false);
+    m_snapshotList->setUniformRowHeights(true);
+    m_snapshotList->header()->setStretchLastSection(true);
 
-    connect(m_snapshotList, &QTableView::clicked,
+    connect(m_snapshotList, &QTreeView::clicked,
             this, &SnapshotsPage::onSnapshotSelected);
-    connect(m_snapshotList, &QTableView::customContextMenuRequested,
+    connect(m_snapshotList, &QTreeView::customContextMenuRequested,
             this, &SnapshotsPage::onContextMenuRequested);
 
     listLayout->addWidget(m_snapshotList);
 
+    m_statusLabel = new QLabel(listGroup);
+    listLayout->addWidget(m_statusLabel);
+
     // Snapshot control buttons
     auto *buttonLayout = new QHBoxLayout();
 
@@ -214,11 +284,11 @@ void SnapshotsPage::setupUI()
 
 void SnapshotsPage::setupSnapshotList()
 {
-    auto *model = new SnapshotListModel(m_snapshotList);
+    auto *model = new SnapshotTreeModel(m_snapshotList);
     m_snapshotList->setModel(model);
 
     // Adjust column widths
-    m_snapshotList->setColumnWidth(0, 200);
+    m_snapshotList->setColumnWidth(0, 260);
     m_snapshotList->setColumnWidth(1, 180);
     m_snapshotList->setColumnWidth(2, 100);
 
@@ -242,41 +312,64 @@ void SnapshotsPage::setupSnapshotInfo()
 
 void SnapshotsPage::updateSnapshotList()
 {
-    // Clear existing snapshots
-    qDeleteAll(m_snapshots);
-    m_snapshots.clear();
-    m_currentSnapshot = nullptr;
+    // Reload in the background; the tree stays usable meanwhile
+    m_statusLabel->setText("Loading snapshots...");
+    m_tree->refresh();
+}
 
-    // Fetch snapshots from libvirt
-    int numSnapshots = 0;
-    virDomainSnapshotPtr *snapshots = nullptr;
+void SnapshotsPage::onTreeChanged()
+{
+    auto *model = static_cast<SnapshotTreeModel*>(m_snapshotList->model());
+    model->setTree(m_tree->nodes(), m_tree->roots());
+    m_snapshotList->expandAll();
+
+    // Keep the selection across reloads
+    QModelIndex selected = model->indexOf(m_selectedName);
+    if (selected.isValid()) {
+        m_snapshotList->setCurrentIndex(selected);
+    } else {
+        m_selectedName.clear();
+    }
 
-    if (m_domain->rawDomain()) {
-        numSnapshots = virDomainListAllSnapshots(m_domain->rawDomain(), &snapshots, 0);
+    if (m_tree->isLoaded()) {
+        m_statusLabel->setText(m_tree->count() == 1 ? QString("1 snapshot")
+                               : QString("%1 snapshots").arg(m_tree->count()));
+    } else {
+        m_statusLabel->setText("Loading snapshots...");
     }
 
-    if (numSnapshots >= 0) {
-        for (int i = 0; i < numSnapshots; ++i) {
-            auto *snapshot = new DomainSnapshot(snapshots[i], m_domain, this);
-            m_snapshots.append(snapshot);
-        }
+    updateSnapshotInfo();
+    updateButtonStates();
+}
 
-        if (snapshots) {
-            free(snapshots);
-        }
-    }
+void SnapshotsPage::onTreeLoadFailed(const QString &error)
+{
+    m_statusLabel->setText(QString("Failed to load snapshots: %1").arg(error));
+}
 
-    // Update model
-    auto *model = static_cast<SnapshotListModel*>(m_snapshotList->model());
-    model->setSnapshots(m_snapshots);
+const SnapshotTree::Node *SnapshotsPage::selectedNode() const
+{
+    if (m_selectedName.isEmpty()) {
+        return nullptr;
+    }
+    auto *model = static_cast<SnapshotTreeModel*>(m_snapshotList->model());
+    return model->nodeAt(model->indexOf(m_selectedName));
+}
 
-    // Update button states
-    updateButtonStates();
+DomainSnapshot *SnapshotsPage::lookupSelected()
+{
+    if (m_selectedName.isEmpty() || !m_domain->rawDomain()) {
+        return nullptr;
+    }
+    virDomainSnapshotPtr snap = virDomainSnapshotLookupByName(
+        m_domain->rawDomain(), m_selectedName.toUtf8().constData(), 0);
+    return snap ? new DomainSnapshot(snap, m_domain) : nullptr;
 }
 
 void SnapshotsPage::updateSnapshotInfo()
 {
-    if (!m_currentSnapshot) {
+    const SnapshotTree::Node *node = selectedNode();
+    if (!node) {
         m_snapshotInfoLabel->setText("Select a snapshot to view details");
         return;
     }
@@ -287,14 +380,18 @@ void SnapshotsPage::updateSnapshotInfo()
         "<tr><td><b>Description:</b></td><td>%2</td></tr>"
         "<tr><td><b>Created:</b></td><td>%3</td></tr>"
         "<tr><td><b>State:</b></td><td>%4</td></tr>"
-        "<tr><td><b>Is Current:</b></td><td>%5</td></tr>"
+        "<tr><td><b>Parent:</b></td><td>%5</td></tr>"
+        "<tr><td><b>Children:</b></td><td>%6</td></tr>"
+        "<tr><td><b>Is Current:</b></td><td>%7</td></tr>"
         "</table>"
     ).arg(
-        m_currentSnapshot->name(),
-        m_currentSnapshot->description().isEmpty() ? "N/A" : m_currentSnapshot->description(),
-        m_currentSnapshot->creationTime().toString("yyyy-MM-dd hh:mm:ss"),
-        EnumMapper::stateToString(m_currentSnapshot->state()),
-        m_currentSnapshot->isCurrent() ? "Yes" : "No"
+        node->name.toHtmlEscaped(),
+        node->description.isEmpty() ? "N/A" : node->description.toHtmlEscaped(),
+        node->creationTime.toString("yyyy-MM-dd hh:mm:ss"),
+        node->diskOnly ? QString("Disk only") : EnumMapper::stateToString(node->state),
+        node->parentName.isEmpty() ? "None" : node->parentName.toHtmlEscaped(),
+        QString::number(node->children.size()),
+        node->current ? "Yes" : "No"
     );
 
     m_snapshotInfoLabel->setText(info);
@@ -302,7 +399,7 @@ void SnapshotsPage::updateSnapshotInfo()
 
 void SnapshotsPage::updateButtonStates()
 {
-    bool hasSnapshot = m_currentSnapshot != nullptr;
+    bool hasSnapshot = selectedNode() != nullptr;
     bool vmRunning = m_domain->state() == Domain::StateRunning;
 
     m_btnRevertSnapshot->setEnabled(hasSnapshot);
@@ -318,8 +415,9 @@ void SnapshotsPage::refresh()
 
 void SnapshotsPage::onSnapshotSelected(const QModelIndex &index)
 {
-    auto *model = static_cast<SnapshotListModel*>(m_snapshotList->model());
-    m_currentSnapshot = model->snapshotAt(index.row());
+    auto *model = static_cast<SnapshotTreeModel*>(m_snapshotList->model());
+    const SnapshotTree::Node *node = model->nodeAt(index);
+    m_selectedName = node ? node->name : QString();
     updateSnapshotInfo();
     updateButtonStates();
 }
@@ -376,19 +474,15 @@ void SnapshotsPage::onTakeSnapshot()
         memoryCheck->isChecked() ? "<memory snapshot='internal'/>" : ""
     );
 
-    // Take snapshot via libvirt
+    // Take snapshot via libvirt; the tree reloads on its own
     if (m_domain->rawDomain()) {
-        virDomainSnapshotPtr snap = virDomainSnapshotCreateXML(
-            m_domain->rawDomain(),
-            xml.toUtf8().constData(),
-            0
-        );
+        DomainSnapshot *snap = m_domain->createSnapshot(xml);
 
         if (snap) {
-            virDomainSnapshotFree(snap);
+            delete snap;
+            m_selectedName = name;
             QMessageBox::information(this, "Success",
                 QString("Snapshot '%1' created successfully").arg(name));
-            updateSnapshotList();
         } else {
             QMessageBox::critical(this, "Error",
                 QString("Failed to create snapshot"));
@@ -398,16 +492,18 @@ void SnapshotsPage::onTakeSnapshot()
 
 void SnapshotsPage::onRevertSnapshot()
 {
-    if (!m_currentSnapshot) {
+    const SnapshotTree::Node *node = selectedNode();
+    if (!node) {
         return;
     }
+    const QString name = node->name;
 
     int result = QMessageBox::question(
         this,
         "Revert to Snapshot",
         QString("Are you sure you want to revert to snapshot '%1'?\n\n"
                 "This will discard the current VM state and cannot be undone.")
-            .arg(m_currentSnapshot->name()),
+            .arg(name),
         QMessageBox::Yes | QMessageBox::No
     );
 
@@ -415,10 +511,13 @@ void SnapshotsPage::onRevertSnapshot()
         return;
     }
 
-    if (m_currentSnapshot->revert(0)) {
+    DomainSnapshot *snapshot = lookupSelected();
+    bool reverted = snapshot && snapshot->revert(0);
+    delete snapshot;
+
+    if (reverted) {
         QMessageBox::information(this, "Success",
-            QString("Reverted to snapshot '%1'").arg(m_currentSnapshot->name()));
-        updateSnapshotList();
+            QString("Reverted to snapshot '%1'").arg(name));
     } else {
         QMessageBox::critical(this, "Error",
             QString("Failed to revert to snapshot"));
@@ -427,28 +526,56 @@ void SnapshotsPage::onRevertSnapshot()
 
 void SnapshotsPage::onDeleteSnapshot()
 {
-    if (!m_currentSnapshot) {
+    const SnapshotTree::Node *node = selectedNode();
+    if (!node) {
         return;
     }
+    const QString name = node->name;
+
+    unsigned int flags = 0;
+    if (node->children.isEmpty()) {
+        int result = QMessageBox::question(
+            this,
+            "Delete Snapshot",
+            QString("Are you sure you want to delete snapshot '%1'?\n\n"
+                    "This cannot be undone.")
+                .arg(name),
+            QMessageBox::Yes | QMessageBox::No
+        );
 
-    int result = QMessageBox::question(
-        this,
-        "Delete Snapshot",
-        QString("Are you sure you want to delete snapshot '%1'?\n\n"
-                "This cannot be undone.")
-            .arg(m_currentSnapshot->name()),
-        QMessageBox::Yes | QMessageBox::No
-    );
-
-    if (result != QMessageBox::Yes) {
-        return;
+        if (result != QMessageBox::Yes) {
+            return;
+        }
+    } else {
+        // Children are attached to the parent unless they go as well
+        QMessageBox box(QMessageBox::Question, "Delete Snapshot",
+            QString("Snapshot '%1' has %2 snapshot(s) taken after it.\n\n"
+                    "Delete only this snapshot, or it and everything below it? "
+                    "This cannot be undone.")
+                .arg(name).arg(node->children.size()),
+            QMessageBox::Cancel, this);
+        QPushButton *onlyThis = box.addButton("Delete Snapshot", QMessageBox::AcceptRole);
+        QPushButton *withChildren = box.addButton("Delete With Children",
+                                                  QMessageBox::DestructiveRole);
+        box.exec();
+
+        if (box.clickedButton() == withChildren) {
+            flags = VIR_DOMAIN_SNAPSHOT_DELETE_CHILDREN;
+        } else if (box.clickedButton() != onlyThis) {
+            return;
+        }
     }
 
-    if (m_currentSnapshot->delete_(0)) {
+    DomainSnapshot *snapshot = lookupSelected();
+    bool deleted = snapshot && snapshot->delete_(flags);
+    delete snapshot;
+
+    if (deleted) {
         QMessageBox::information(this, "Success",
-            QString("Snapshot '%1' deleted").arg(m_currentSnapshot->name()));
-        m_currentSnapshot = nullptr;
-        updateSnapshotList();
+            QString("Snapshot '%1' deleted").arg(name));
+        m_selectedName.clear();
+        updateSnapshotInfo();
+        updateButtonStates();
     } else {
         QMessageBox::critical(this, "Error",
             QString("Failed to delete snapshot"));
@@ -457,14 +584,16 @@ void SnapshotsPage::onDeleteSnapshot()
 
 void SnapshotsPage::onViewSnapshotXML()
 {
-    if (!m_currentSnapshot) {
+    const SnapshotTree::Node *node = selectedNode();
+    if (!node) {
         return;
     }
 
-    QString xml = m_currentSnapshot->getXMLDesc(0);
+    // Fetched with the tree, no further call to libvirt
+    QString xml = node->xml;
 
     QDialog dialog(this);
-    dialog.setWindowTitle("Snapshot XML - " + m_currentSnapshot->name());
+    dialog.setWindowTitle("Snapshot XML - " + node->name);
     dialog.resize(600, 400);
 
     auto *layout = new QVBoxLayout(&dialog);
@@ -15,7 +15,7 @@
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QTableView>
+#include <QTreeView>
 #include <QLabel>
 #include <QPushButton>
 #include <QGroupBox>
@@ -25,6 +25,7 @@
 
 #include "../../libvirt/Domain.h"
 #include "../../libvirt/DomainSnapshot.h"
+#include "../../libvirt/SnapshotTree.h"
 
 namespace QVirt {
 
@@ -32,7 +33,7 @@ namespace QVirt {
  * @brief Snapshots Page for VMWindow
  *
  * Provides snapshot management functionality including:
- * - Listing all snapshots
+ * - Showing all snapshots as a tree, from the domain's cached SnapshotTree
  * - Taking new snapshots
  * - Reverting to snapshots
  * - Deleting snapshots
@@ -50,6 +51,8 @@ public:
     void updateSnapshotList();
 
 private slots:
+    void onTreeChanged();
+    void onTreeLoadFailed(const QString &error);
     void onSnapshotSelected(const QModelIndex &index);
     void onTakeSnapshot();
     void onRevertSnapshot();
@@ -68,14 +71,19 @@ private:
     void revertSnapshot();
     void deleteSnapshot();
     void viewSnapshotXML();
+    const SnapshotTree::Node *selectedNode() const;
+
+    // Handle for an operation on the selected snapshot; the caller owns it
+    DomainSnapshot *lookupSelected();
 
     Domain *m_domain;
-    DomainSnapshot *m_currentSnapshot;
-    QList<DomainSnapshot*> m_snapshots;
+    SnapshotTree *m_tree;
+    QString m_selectedName;
 
     // UI components
     QSplitter *m_splitter;
-    QTableView *m_snapshotList;
+    QTreeView *m_snapshotList;
+    QLabel *m_statusLabel;
     QLabel *m_snapshotInfoLabel;
     QPushButton *m_btnTakeSnapshot;
     QPushButton *m_btnRevertSnapshot;
@@ -91,25 +99,30 @@ private:
 };
 
 /**
- * @brief Simple model for snapshot list display
+ * @brief Snapshot tree model, children below the snapshot they were taken from
  */
-class SnapshotListModel : public QAbstractTableModel
+class SnapshotTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
 
 public:
-    explicit SnapshotListModel(QObject *parent = nullptr);
+    explicit SnapshotTreeModel(QObject *parent = nullptr);
 
-    void setSnapshots(const QList<DomainSnapshot*> &snapshots);
-    DomainSnapshot* snapshotAt(int row) const;
+    void setTree(const QList<SnapshotTree::Node> &nodes, const QList<int> &roots);
+    const SnapshotTree::Node *nodeAt(const QModelIndex &index) const;
+    QModelIndex indexOf(const QString &name) const;
 
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
 private:
-    QList<DomainSnapshot*> m_snapshots;
+    QList<SnapshotTree::Node> m_nodes;
+    QList<int> m_roots;
+    QList<int> m_rows;          // Row of each node below its parent
 };
 
 } // namespace QVirt
@@ -14,17 +14,23 @@
 #include "DetailsPage.h"
 #include "ConsolePage.h"
 #include "SnapshotsPage.h"
+#include "BackupsPage.h"
 
 #include "../../core/Engine.h"
 #include "../../core/Error.h"
 
 #include "../dialogs/CloneDialog.h"
 #include "../dialogs/DeleteDialog.h"
+#include "../dialogs/MigrateDialog.h"
 #include "../dialogs/AddHardwareDialog.h"
+#include "../widgets/BlockJobPanel.h"
+#include "../../libvirt/BlockJobManager.h"
 #include "../../devices/Device.h"
 
 #include <QMessageBox>
 #include <QCloseEvent>
+#include <QDir>
+#include <QPointer>
 #include <QStatusBar>
 #include <QMenuBar>
 
@@ -67,12 +73,17 @@ void VMWindow::setupUI()
     m_detailsPage = new DetailsPage(m_domain, this);
     m_consolePage = new ConsolePage(m_domain, this);
     m_snapshotsPage = new SnapshotsPage(m_domain, this);
+    m_blockJobsPage = new BlockJobPanel(BlockJobManager::instance(), m_domain->connection(),
+                                        m_domain, this);
+    m_backupsPage = new BackupsPage(m_domain, this);
 
     // Add pages to tab widget
     m_tabWidget->addTab(m_overviewPage, "Overview");
     m_tabWidget->addTab(m_detailsPage, "Details");
     m_tabWidget->addTab(m_consolePage, "Console");
     m_tabWidget->addTab(m_snapshotsPage, "Snapshots");
+    m_tabWidget->addTab(m_blockJobsPage, "Block Jobs");
+    m_tabWidget->addTab(m_backupsPage, "Backups");
 
     // Status bar
     m_statusLabel = new QLabel(this);
@@ -342,19 +353,85 @@ void VMWindow::onRestoreSavedClicked()
 void VMWindow::onCloneVM()
 {
     CloneDialog dialog(m_domain, this);
-    if (dialog.exec() == QDialog::Accepted) {
-        // Clone VM logic would go here
-        // For now, just show a message with the clone parameters
-        QString info = QString("Clone Configuration:\n")
-            + QString("  Source: %1\n").arg(m_domain->name())
-            + QString("  Clone Name: %1\n").arg(dialog.cloneName())
-            + QString("  Clone Storage: %1\n").arg(dialog.cloneStorage() ? "Yes" : "No")
-            + QString("  Generate MACs: %1\n").arg(dialog.generateMACs() ? "Yes" : "No");
-
-        QMessageBox::information(this, "Clone VM (Placeholder)",
-            info + "\n\nClone functionality requires libvirt XML manipulation. "
-            "This dialog shows the clone configuration interface.");
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    const QString cloneName = dialog.cloneName().trimmed();
+    auto *cloner = new DomainCloner(m_domain, cloneName, StorageJobManager::instance(), this);
+    cloner->setCloneStorage(dialog.cloneStorage());
+    cloner->setGenerateMACs(dialog.generateMACs());
+
+    // Disks can only be cloned into a pool; an empty path keeps each in its own
+    const QString storagePath = dialog.storagePath().trimmed();
+    if (dialog.cloneStorage() && !storagePath.isEmpty()) {
+        StoragePool *target = nullptr;
+        for (StoragePool *pool : m_domain->connection()->storagePools()) {
+            if (pool->isActive() && QDir::cleanPath(pool->targetPath()) == QDir::cleanPath(storagePath)) {
+                target = pool;
+                break;
+            }
+        }
+        if (!target) {
+            QMessageBox::warning(this, "Clone VM",
+                QString("No active storage pool uses '%1'.\n\n"
+                        "Create a pool for that directory first, or leave the path empty "
+                        "to keep each cloned disk next to its source.").arg(storagePath));
+            delete cloner;
+            return;
+        }
+        cloner->setTargetPool(target);
+    }
+
+    if (!cloner->start()) {
+        QMessageBox::critical(this, "Clone VM",
+            QString("Failed to clone '%1': %2").arg(m_domain->name(), cloner->errorString()));
+        delete cloner;
+        return;
     }
+
+    QPointer<ProgressDialog> progress = new ProgressDialog("Clone VM",
+        QString("Cloning '%1' to '%2'").arg(m_domain->name(), cloneName), this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(progress, &ProgressDialog::cancelRequested, cloner, &DomainCloner::cancel);
+
+    // One line per disk; the bar stays below 100% until the clone is defined
+    auto showProgress = [progress, cloner]() {
+        if (!progress) {
+            return;
+        }
+        QStringList lines;
+        for (const DomainCloner::Disk &disk : cloner->disks()) {
+            int percent = disk.total > 0 ? int(disk.processed * 100 / disk.total) : 0;
+            lines << QString("%1 -> %2: %3%").arg(disk.target, disk.cloneName).arg(percent);
+        }
+        qint64 total = cloner->totalBytes();
+        int percent = total > 0 ? int(cloner->processedBytes() * 100 / total) : 0;
+        progress->updateProgress(qMin(percent, 99), lines.join('\n'));
+    };
+    connect(cloner, &DomainCloner::progress, this, showProgress);
+    connect(cloner, &DomainCloner::diskProgress, this, showProgress);
+
+    connect(cloner, &DomainCloner::finished, this, [this, progress, cloner, cloneName](bool success) {
+        if (success) {
+            m_statusLabel->setText(QString("Cloned to '%1'").arg(cloneName));
+            if (progress) {
+                progress->finishJob();
+            }
+        } else if (cloner->state() == DomainCloner::Cancelled) {
+            if (progress) {
+                progress->close();
+            }
+        } else if (progress) {
+            progress->setError(cloner->errorString());
+        } else {
+            QMessageBox::critical(this, "Clone VM", cloner->errorString());
+        }
+        cloner->deleteLater();
+    });
+
+    progress->startJob();
+    showProgress();
 }
 
 void VMWindow::onDeleteVM()
@@ -374,7 +451,8 @@ void VMWindow::onDeleteVM()
 
 void VMWindow::onMigrateVM()
 {
-    QMessageBox::information(this, "Not Implemented", "Migrate VM functionality will be implemented in Phase 8");
+    MigrateDialog dialog(m_domain, this);
+    dialog.exec();
 }
 
 void VMWindow::onAddHardware()
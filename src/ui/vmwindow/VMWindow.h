@@ -31,6 +31,7 @@ class OverviewPage;
 class DetailsPage;
 class ConsolePage;
 class SnapshotsPage;
+class BackupsPage;
 
 /**
  * @brief VM Details Window
@@ -40,6 +41,8 @@ class SnapshotsPage;
  * - Details: Hardware device list
  * - Console: VNC/SPICE console (future)
  * - Snapshots: Snapshot management (future)
+ * - Block Jobs: Pull, commit and copy jobs on the VM's disks
+ * - Backups: Full and incremental backups and their schedule
  */
 class VMWindow : public QMainWindow
 {
@@ -87,6 +90,8 @@ private:
     QWidget *m_detailsPage;
     QWidget *m_consolePage;
     QWidget *m_snapshotsPage;
+    QWidget *m_blockJobsPage;
+    QWidget *m_backupsPage;
 
     // Toolbar actions
     QAction *m_actionStart;
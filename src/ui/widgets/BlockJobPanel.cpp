@@ -0,0 +1,371 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "BlockJobPanel.h"
+#include "../../libvirt/BlockJobManager.h"
+#include "../../libvirt/Connection.h"
+#include "../../libvirt/Domain.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QLabel>
+#include <QInputDialog>
+#include <QMessageBox>
+
+namespace QVirt {
+
+namespace {
+
+enum JobColumn {
+    ColumnDomain,
+    ColumnDisk,
+    ColumnOperation,
+    ColumnProgress,
+    ColumnSpeed,
+    ColumnStatus
+};
+
+constexpr qint64 MiB = 1024 * 1024;
+
+QString stateText(const BlockJob *job)
+{
+    switch (job->state()) {
+    case BlockJob::Queued:
+        return QObject::tr("Queued");
+    case BlockJob::Starting:
+        return job->isCancellable() ? QObject::tr("Starting") : QObject::tr("Cancelling");
+    case BlockJob::Running:
+        return job->isCancellable() ? QObject::tr("Running") : QObject::tr("Stopping");
+    case BlockJob::Ready:
+        if (!job->isCancellable()) {
+            return QObject::tr("Switching over");
+        }
+        return job->isPivotable() ? QObject::tr("Ready to pivot") : QObject::tr("Ready");
+    case BlockJob::Finished:
+        return QObject::tr("Done");
+    case BlockJob::Failed:
+        return QObject::tr("Failed: %1").arg(job->errorString());
+    case BlockJob::Cancelled:
+        return QObject::tr("Cancelled");
+    }
+    return QString();
+}
+
+QString speedText(qint64 bandwidth)
+{
+    if (bandwidth <= 0) {
+        return QObject::tr("Unlimited");
+    }
+    return QObject::tr("%1 MiB/s").arg(double(bandwidth) / MiB, 0, 'f', 1);
+}
+
+bool isActive(const Domain *domain)
+{
+    const Domain::State state = domain->state();
+    return state == Domain::StateRunning || state == Domain::StatePaused
+        || state == Domain::StateBlocked;
+}
+
+} // namespace
+
+BlockJobPanel::BlockJobPanel(BlockJobManager *manager, Connection *connection, Domain *domain,
+                             QWidget *parent)
+    : QWidget(parent)
+    , m_manager(manager)
+    , m_connection(connection)
+    , m_domain(domain)
+    , m_jobList(nullptr)
+    , m_summaryLabel(nullptr)
+    , m_btnPivot(nullptr)
+    , m_btnCancel(nullptr)
+    , m_btnSpeed(nullptr)
+    , m_btnFlatten(nullptr)
+    , m_btnClear(nullptr)
+{
+    setupUI();
+
+    connect(m_manager, &BlockJobManager::jobAdded, this, &BlockJobPanel::onJobAdded);
+    connect(m_manager, &BlockJobManager::jobRemoved, this, &BlockJobPanel::onJobRemoved);
+
+    for (BlockJob *job : m_manager->jobs()) {
+        onJobAdded(job);
+    }
+    updateSummary();
+    updateButtons();
+}
+
+void BlockJobPanel::setupUI()
+{
+    auto *layout = new QVBoxLayout(this);
+
+    m_jobList = new QTreeWidget(this);
+    m_jobList->setRootIsDecorated(false);
+    m_jobList->setHeaderLabels({tr("VM"), tr("Disk"), tr("Operation"), tr("Progress"),
+                                tr("Speed"), tr("Status")});
+    m_jobList->header()->setStretchLastSection(true);
+    m_jobList->setColumnWidth(ColumnDomain, 140);
+    m_jobList->setColumnWidth(ColumnDisk, 60);
+    m_jobList->setColumnWidth(ColumnOperation, 200);
+    m_jobList->setColumnWidth(ColumnProgress, 140);
+    if (m_domain) {
+        m_jobList->setColumnHidden(ColumnDomain, true);
+    }
+    connect(m_jobList, &QTreeWidget::itemSelectionChanged, this, &BlockJobPanel::updateButtons);
+    layout->addWidget(m_jobList);
+
+    auto *buttonLayout = new QHBoxLayout();
+    m_summaryLabel = new QLabel(this);
+    m_btnFlatten = new QPushButton(tr("Flatten Disks..."), this);
+    m_btnFlatten->setToolTip(m_domain
+        ? tr("Pull the backing chain of every disk into the disk itself")
+        : tr("Pull the backing chains of all running VMs into their disks"));
+    m_btnPivot = new QPushButton(tr("Pivot"), this);
+    m_btnPivot->setToolTip(tr("Switch the disk over to the new image"));
+    m_btnSpeed = new QPushButton(tr("Set Speed..."), this);
+    m_btnCancel = new QPushButton(tr("Cancel Job"), this);
+    m_btnClear = new QPushButton(tr("Clear Finished"), this);
+    connect(m_btnFlatten, &QPushButton::clicked, this, &BlockJobPanel::onFlatten);
+    connect(m_btnPivot, &QPushButton::clicked, this, &BlockJobPanel::onPivot);
+    connect(m_btnSpeed, &QPushButton::clicked, this, &BlockJobPanel::onSetSpeed);
+    connect(m_btnCancel, &QPushButton::clicked, this, &BlockJobPanel::onCancel);
+    connect(m_btnClear, &QPushButton::clicked, this, &BlockJobPanel::onClearFinished);
+
+    buttonLayout->addWidget(m_summaryLabel);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_btnFlatten);
+    buttonLayout->addWidget(m_btnPivot);
+    buttonLayout->addWidget(m_btnSpeed);
+    buttonLayout->addWidget(m_btnCancel);
+    buttonLayout->addWidget(m_btnClear);
+    layout->addLayout(buttonLayout);
+}
+
+bool BlockJobPanel::accepts(BlockJob *job) const
+{
+    Domain *domain = job->domain();
+    if (m_domain) {
+        return domain == m_domain;
+    }
+    return !m_connection || !domain || domain->connection() == m_connection;
+}
+
+void BlockJobPanel::onJobAdded(BlockJob *job)
+{
+    if (m_items.contains(job) || !accepts(job)) {
+        return;
+    }
+
+    auto *item = new QTreeWidgetItem(m_jobList);
+    m_items.insert(job, item);
+
+    auto *bar = new QProgressBar(m_jobList);
+    bar->setTextVisible(true);
+    m_jobList->setItemWidget(item, ColumnProgress, bar);
+
+    connect(job, &BlockJob::stateChanged, this, [this, job]() {
+        updateJob(job);
+        updateSummary();
+        updateButtons();
+    });
+    connect(job, &BlockJob::progress, this, [this, job]() {
+        updateJob(job);
+    });
+
+    updateJob(job);
+    updateSummary();
+}
+
+void BlockJobPanel::onJobRemoved(BlockJob *job)
+{
+    delete m_items.take(job);
+    updateSummary();
+    updateButtons();
+}
+
+void BlockJobPanel::updateJob(BlockJob *job)
+{
+    QTreeWidgetItem *item = m_items.value(job);
+    if (!item) {
+        return;
+    }
+
+    item->setText(ColumnDomain, job->domainName());
+    item->setText(ColumnDisk, job->disk());
+    item->setText(ColumnOperation, job->description());
+    item->setText(ColumnSpeed, speedText(job->bandwidth()));
+    item->setText(ColumnStatus, stateText(job));
+    item->setToolTip(ColumnStatus, job->errorString());
+
+    auto *bar = qobject_cast<QProgressBar *>(m_jobList->itemWidget(item, ColumnProgress));
+    if (!bar) {
+        return;
+    }
+
+    if (job->state() == BlockJob::Starting
+        || (job->state() == BlockJob::Running && job->totalBytes() <= 0)) {
+        // No cursor yet: a busy indicator
+        bar->setRange(0, 0);
+    } else {
+        bar->setRange(0, 100);
+        int percent = 0;
+        if (job->state() == BlockJob::Finished || job->state() == BlockJob::Ready) {
+            percent = 100;
+        } else if (job->totalBytes() > 0) {
+            percent = int(job->processedBytes() * 100 / job->totalBytes());
+        }
+        bar->setValue(percent);
+    }
+}
+
+void BlockJobPanel::updateSummary()
+{
+    int active = 0;
+    for (auto it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        if (!it.key()->isDone()) {
+            active++;
+        }
+    }
+    m_summaryLabel->setText(active > 0 ? tr("%1 job(s) pending").arg(active)
+                                       : tr("No pending jobs"));
+}
+
+BlockJob *BlockJobPanel::selectedJob() const
+{
+    QTreeWidgetItem *current = m_jobList->currentItem();
+    if (!current || !current->isSelected()) {
+        return nullptr;
+    }
+    for (auto it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        if (it.value() == current) {
+            return it.key();
+        }
+    }
+    return nullptr;
+}
+
+void BlockJobPanel::onPivot()
+{
+    if (BlockJob *job = selectedJob()) {
+        m_manager->pivot(job);
+        updateButtons();
+    }
+}
+
+void BlockJobPanel::onCancel()
+{
+    BlockJob *job = selectedJob();
+    if (!job) {
+        return;
+    }
+
+    // Abandoning a mirror in sync keeps the original image
+    if (job->isPivotable()) {
+        auto reply = QMessageBox::question(this, tr("Cancel Block Job"),
+            tr("The copy of %1 is complete. Cancel it and keep using the original image?")
+                .arg(job->disk()),
+            QMessageBox::Yes | QMessageBox::No);
+        if (reply != QMessageBox::Yes) {
+            return;
+        }
+    }
+    m_manager->cancel(job);
+    updateButtons();
+}
+
+void BlockJobPanel::onSetSpeed()
+{
+    BlockJob *job = selectedJob();
+    if (!job) {
+        return;
+    }
+
+    bool ok = false;
+    double speed = QInputDialog::getDouble(this, tr("Set Speed"),
+        tr("Speed limit for %1 in MiB/s (0 for none):").arg(job->description()),
+        double(job->bandwidth()) / MiB, 0, 1024 * 1024, 1, &ok);
+    if (ok) {
+        m_manager->setBandwidth(job, qint64(speed * MiB));
+    }
+}
+
+void BlockJobPanel::onFlatten()
+{
+    QList<Domain*> domains;
+    if (m_domain) {
+        domains.append(m_domain);
+    } else if (m_connection) {
+        domains = m_connection->domains();
+    }
+
+    int skipped = 0;
+    for (Domain *domain : domains) {
+        if (!isActive(domain)) {
+            skipped++;
+        }
+    }
+    if (skipped == domains.size()) {
+        QMessageBox::information(this, tr("Flatten Disks"),
+            m_domain ? tr("The VM must be running to flatten its disks.")
+                     : tr("No VM is running."));
+        return;
+    }
+
+    bool ok = false;
+    double speed = QInputDialog::getDouble(this, tr("Flatten Disks"),
+        tr("Speed limit per disk in MiB/s (0 for none).\n"
+           "At most %1 disks are flattened at the same time.").arg(m_manager->maxConcurrent()),
+        0, 0, 1024 * 1024, 1, &ok);
+    if (!ok) {
+        return;
+    }
+
+    QList<BlockJob*> jobs = m_manager->flatten(domains, qint64(speed * MiB));
+    if (jobs.isEmpty()) {
+        QMessageBox::information(this, tr("Flatten Disks"),
+            tr("No disk of a running VM has a backing chain."));
+        return;
+    }
+
+    QString status = tr("%1 disk(s) queued for flattening").arg(jobs.size());
+    if (skipped > 0) {
+        status += tr(", %1 VM(s) not running skipped").arg(skipped);
+    }
+    m_summaryLabel->setText(status);
+}
+
+void BlockJobPanel::onClearFinished()
+{
+    m_manager->clearFinished();
+}
+
+void BlockJobPanel::updateButtons()
+{
+    BlockJob *job = selectedJob();
+    m_btnPivot->setEnabled(job && job->isPivotable());
+    m_btnCancel->setEnabled(job && job->isCancellable());
+    m_btnSpeed->setEnabled(job && job->isCancellable() && job->state() != BlockJob::Ready);
+    m_btnFlatten->setEnabled(m_domain || m_connection);
+
+    bool anyDone = false;
+    for (auto it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        if (it.key()->isDone()) {
+            anyDone = true;
+            break;
+        }
+    }
+    m_btnClear->setEnabled(anyDone);
+}
+
+} // namespace QVirt
@@ -0,0 +1,81 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_BLOCKJOBPANEL_H
+#define QVIRT_UI_BLOCKJOBPANEL_H
+
+#include <QWidget>
+#include <QHash>
+#include <QPointer>
+
+class QTreeWidget;
+class QTreeWidgetItem;
+class QPushButton;
+class QLabel;
+
+namespace QVirt {
+
+class BlockJob;
+class BlockJobManager;
+class Connection;
+class Domain;
+
+/**
+ * @brief Block jobs with their progress and speed
+ *
+ * Lists the jobs of a BlockJobManager, either those of one domain or
+ * those of every domain on a connection. Ready mirrors can be pivoted,
+ * jobs cancelled and throttled, and the backing chains of the listed
+ * domains flattened in one go.
+ */
+class BlockJobPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // With a @p domain only its jobs are shown and flattened
+    BlockJobPanel(BlockJobManager *manager, Connection *connection, Domain *domain = nullptr,
+                  QWidget *parent = nullptr);
+
+private slots:
+    void onJobAdded(BlockJob *job);
+    void onJobRemoved(BlockJob *job);
+    void onPivot();
+    void onCancel();
+    void onSetSpeed();
+    void onFlatten();
+    void onClearFinished();
+    void updateButtons();
+
+private:
+    void setupUI();
+    bool accepts(BlockJob *job) const;
+    void updateJob(BlockJob *job);
+    void updateSummary();
+    BlockJob *selectedJob() const;
+
+    BlockJobManager *m_manager;
+    QPointer<Connection> m_connection;
+    QPointer<Domain> m_domain;
+    QHash<BlockJob*, QTreeWidgetItem*> m_items;
+
+    QTreeWidget *m_jobList;
+    QLabel *m_summaryLabel;
+    QPushButton *m_btnPivot;
+    QPushButton *m_btnCancel;
+    QPushButton *m_btnSpeed;
+    QPushButton *m_btnFlatten;
+    QPushButton *m_btnClear;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_BLOCKJOBPANEL_H
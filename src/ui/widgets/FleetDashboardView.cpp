@@ -0,0 +1,770 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "FleetDashboardView.h"
+#include "GraphWidget.h"
+#include "../models/VMListModel.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QImage>
+#include <QEvent>
+
+namespace QVirt {
+
+namespace {
+constexpr int GlyphSize = 12;
+constexpr int AtlasColumns = 8;
+constexpr int MinimumAtlasSlots = AtlasColumns * 4;
+
+const QColor RunningColor(46, 204, 113);
+const QColor PausedColor(241, 196, 15);
+const QColor StoppedColor(149, 165, 166);
+const QColor OtherColor(231, 76, 60);
+const QColor CPUColor(52, 152, 219);
+const QColor MemoryColor(155, 89, 182);
+
+const QColor &glyphColor(int glyph)
+{
+    static const QColor colors[] = { RunningColor, PausedColor, StoppedColor, OtherColor };
+    return colors[glyph];
+}
+} // namespace
+
+FleetDashboardView::FleetDashboardView(QWidget *parent)
+    : QAbstractItemView(parent)
+    , m_tileSize(220, 104)
+    , m_spacing(6)
+    , m_thumbnailRole(-1)
+    , m_glyphsValid(false)
+    , m_frame(0)
+    , m_lastPaintedTiles(0)
+    , m_sparklineRenders(0)
+{
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setSelectionBehavior(QAbstractItemView::SelectRows);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setMouseTracking(false);
+
+    updateLayout();
+}
+
+void FleetDashboardView::setTileSize(const QSize &size)
+{
+    QSize bounded = size.expandedTo(QSize(120, 64));
+    if (bounded == m_tileSize) {
+        return;
+    }
+    m_tileSize = bounded;
+    updateLayout();
+    updateGeometries();
+    viewport()->update();
+}
+
+void FleetDashboardView::setThumbnailRole(int role)
+{
+    if (role == m_thumbnailRole) {
+        return;
+    }
+    m_thumbnailRole = role;
+    updateLayout();
+    viewport()->update();
+}
+
+void FleetDashboardView::updateLayout()
+{
+    int w = m_tileSize.width();
+    int h = m_tileSize.height();
+
+    // Thumbnails take a 4:3 box on the right, up to half the tile
+    int thumbWidth = 0;
+    if (m_thumbnailRole >= 0) {
+        thumbWidth = qMin((h - 16) * 4 / 3, w / 2);
+        m_layout.thumbnail = QRect(w - 8 - thumbWidth, 8, thumbWidth, h - 16);
+        thumbWidth += 8;
+    } else {
+        m_layout.thumbnail = QRect();
+    }
+
+    int contentWidth = w - 20 - thumbWidth;
+    m_layout.stripe = QRect(0, 0, 4, h);
+    m_layout.glyph = QRect(10, 8, GlyphSize, GlyphSize);
+    m_layout.name = QRect(28, 5, contentWidth - 18, 18);
+    m_layout.detail = QRect(10, 24, contentWidth, 16);
+    m_layout.cpuBar = QRect(10, 44, contentWidth, 5);
+    m_layout.memoryBar = QRect(10, 52, contentWidth, 5);
+    m_layout.sparkline = QRect(10, 62, contentWidth, qMax(8, h - 70));
+
+    // Geometry changed: every cached text and atlas slot is stale
+    m_tiles.clear();
+    m_slotKeys.clear();
+    m_slotFrames.clear();
+    m_sparkAtlas = QPixmap();
+}
+
+QString FleetDashboardView::tileKey(const QModelIndex &index) const
+{
+    return index.data(VMListModel::ConnectionURIRole).toString() + QLatin1Char('/') +
+           index.data(VMListModel::UUIDRole).toString();
+}
+
+FleetDashboardView::Glyph FleetDashboardView::glyphForState(int state)
+{
+    switch (state) {
+    case VIR_DOMAIN_RUNNING:
+    case VIR_DOMAIN_BLOCKED:
+        return RunningGlyph;
+    case VIR_DOMAIN_PAUSED:
+    case VIR_DOMAIN_PMSUSPENDED:
+        return PausedGlyph;
+    case VIR_DOMAIN_CRASHED:
+        return OtherGlyph;
+    default:
+        return StoppedGlyph;
+    }
+}
+
+void FleetDashboardView::ensureGlyphAtlas()
+{
+    qreal dpr = devicePixelRatioF();
+    if (m_glyphsValid && m_glyphAtlas.devicePixelRatio() == dpr) {
+        return;
+    }
+
+    m_glyphAtlas = QPixmap(QSize(GlyphCount * GlyphSize, GlyphSize) * dpr);
+    m_glyphAtlas.setDevicePixelRatio(dpr);
+    m_glyphAtlas.fill(Qt::transparent);
+
+    QPainter painter(&m_glyphAtlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (int g = 0; g < GlyphCount; ++g) {
+        QRectF cell(g * GlyphSize, 0, GlyphSize, GlyphSize);
+        painter.setPen(QPen(glyphColor(g).darker(130), 1));
+        painter.setBrush(glyphColor(g));
+        painter.drawEllipse(cell.adjusted(1.5, 1.5, -1.5, -1.5));
+    }
+
+    m_glyphsValid = true;
+}
+
+QRect FleetDashboardView::slotRect(int slot) const
+{
+    QSize size = m_layout.sparkline.size();
+    return QRect(QPoint((slot % AtlasColumns) * size.width(), (slot / AtlasColumns) * size.height()),
+                 size);
+}
+
+int FleetDashboardView::acquireSlot(const QString &key)
+{
+    // Free slot, or the one painted longest ago (never one used this frame)
+    int victim = -1;
+    quint64 oldest = m_frame;
+    for (int i = 0; i < m_slotKeys.size(); ++i) {
+        if (m_slotKeys.at(i).isEmpty()) {
+            victim = i;
+            break;
+        }
+        if (m_slotFrames.at(i) < oldest) {
+            oldest = m_slotFrames.at(i);
+            victim = i;
+        }
+    }
+
+    if (victim < 0) {
+        // Every slot is on screen: grow the atlas, keeping existing slots
+        int oldCount = m_slotKeys.size();
+        int newCount = qMax(MinimumAtlasSlots, oldCount * 2);
+        int rows = (newCount + AtlasColumns - 1) / AtlasColumns;
+        qreal dpr = devicePixelRatioF();
+
+        QPixmap atlas(QSize(AtlasColumns * m_layout.sparkline.width(),
+                            rows * m_layout.sparkline.height()) * dpr);
+        atlas.setDevicePixelRatio(dpr);
+        atlas.fill(Qt::transparent);
+        if (!m_sparkAtlas.isNull()) {
+            QPainter painter(&atlas);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawPixmap(0, 0, m_sparkAtlas);
+        }
+        m_sparkAtlas = atlas;
+
+        m_slotKeys.resize(newCount);
+        m_slotFrames.resize(newCount);
+        victim = oldCount;
+    } else if (!m_slotKeys.at(victim).isEmpty()) {
+        auto it = m_tiles.find(m_slotKeys.at(victim));
+        if (it != m_tiles.end()) {
+            it->slot = -1;
+        }
+    }
+
+    m_slotKeys[victim] = key;
+    m_slotFrames[victim] = m_frame;
+    return victim;
+}
+
+int FleetDashboardView::columnCount() const
+{
+    int stride = m_tileSize.width() + m_spacing;
+    return qMax(1, (viewport()->width() - m_spacing) / stride);
+}
+
+QRect FleetDashboardView::tileRect(int row) const
+{
+    int columns = columnCount();
+    int x = m_spacing + (row % columns) * (m_tileSize.width() + m_spacing);
+    int y = m_spacing + (row / columns) * (m_tileSize.height() + m_spacing);
+    return QRect(QPoint(x, y), m_tileSize);
+}
+
+void FleetDashboardView::rowRange(const QRect &viewportRect, int *first, int *last) const
+{
+    int count = model() ? model()->rowCount(rootIndex()) : 0;
+    int columns = columnCount();
+    int stride = m_tileSize.height() + m_spacing;
+
+    int top = qMax(0, viewportRect.top() + verticalOffset() - m_spacing);
+    int bottom = viewportRect.bottom() + verticalOffset() - m_spacing;
+
+    *first = (top / stride) * columns;
+    *last = bottom < 0 ? -1 : qMin(count - 1, (bottom / stride + 1) * columns - 1);
+}
+
+QRect FleetDashboardView::visualRect(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.parent() != rootIndex()) {
+        return QRect();
+    }
+    return tileRect(index.row()).translated(-horizontalOffset(), -verticalOffset());
+}
+
+void FleetDashboardView::scrollTo(const QModelIndex &index, ScrollHint hint)
+{
+    QRect rect = visualRect(index);
+    QRect area = viewport()->rect();
+    if (rect.isNull() || (hint == EnsureVisible && area.contains(rect))) {
+        return;
+    }
+
+    QScrollBar *bar = verticalScrollBar();
+    if (hint == PositionAtTop || (hint == EnsureVisible && rect.top() < area.top())) {
+        bar->setValue(bar->value() + rect.top() - m_spacing);
+    } else if (hint == PositionAtBottom || hint == EnsureVisible) {
+        bar->setValue(bar->value() + rect.bottom() - area.bottom() + m_spacing);
+    } else {
+        bar->setValue(bar->value() + rect.center().y() - area.center().y());
+    }
+}
+
+QModelIndex FleetDashboardView::indexAt(const QPoint &point) const
+{
+    if (!model()) {
+        return QModelIndex();
+    }
+
+    QPoint p = point + QPoint(horizontalOffset(), verticalOffset()) - QPoint(m_spacing, m_spacing);
+    if (p.x() < 0 || p.y() < 0) {
+        return QModelIndex();
+    }
+
+    int strideX = m_tileSize.width() + m_spacing;
+    int strideY = m_tileSize.height() + m_spacing;
+    int column = p.x() / strideX;
+
+    // Points in the gaps between tiles hit nothing
+    if (column >= columnCount() || p.x() % strideX >= m_tileSize.width() ||
+        p.y() % strideY >= m_tileSize.height()) {
+        return QModelIndex();
+    }
+
+    int row = (p.y() / strideY) * columnCount() + column;
+    if (row >= model()->rowCount(rootIndex())) {
+        return QModelIndex();
+    }
+    return model()->index(row, 0, rootIndex());
+}
+
+QModelIndex FleetDashboardView::moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers)
+{
+    Q_UNUSED(modifiers);
+
+    int count = model() ? model()->rowCount(rootIndex()) : 0;
+    if (count == 0) {
+        return QModelIndex();
+    }
+
+    QModelIndex current = currentIndex();
+    if (!current.isValid()) {
+        return model()->index(0, 0, rootIndex());
+    }
+
+    int columns = columnCount();
+    int pageRows = qMax(1, viewport()->height() / (m_tileSize.height() + m_spacing));
+    int row = current.row();
+
+    switch (cursorAction) {
+    case MoveLeft:
+    case MovePrevious:
+        row -= 1;
+        break;
+    case MoveRight:
+    case MoveNext:
+        row += 1;
+        break;
+    case MoveUp:
+        row -= columns;
+        break;
+    case MoveDown:
+        row += columns;
+        break;
+    case MovePageUp:
+        row -= columns * pageRows;
+        break;
+    case MovePageDown:
+        row += columns * pageRows;
+        break;
+    case MoveHome:
+        row = 0;
+        break;
+    case MoveEnd:
+        row = count - 1;
+        break;
+    }
+
+    return model()->index(qBound(0, row, count - 1), 0, rootIndex());
+}
+
+int FleetDashboardView::horizontalOffset() const
+{
+    return 0;
+}
+
+int FleetDashboardView::verticalOffset() const
+{
+    return verticalScrollBar()->value();
+}
+
+bool FleetDashboardView::isIndexHidden(const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return false;
+}
+
+void FleetDashboardView::setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command)
+{
+    if (!model() || !selectionModel()) {
+        return;
+    }
+
+    QRect content = rect.normalized().translated(horizontalOffset(), verticalOffset());
+    int count = model()->rowCount(rootIndex());
+    int columns = columnCount();
+    int strideX = m_tileSize.width() + m_spacing;
+    int strideY = m_tileSize.height() + m_spacing;
+
+    int firstColumn = qMax(0, (content.left() - m_spacing) / strideX);
+    int lastColumn = qMin(columns - 1, qMax(0, content.right() - m_spacing) / strideX);
+    int firstGridRow = qMax(0, (content.top() - m_spacing) / strideY);
+    int lastGridRow = qMax(0, content.bottom() - m_spacing) / strideY;
+
+    QItemSelection selection;
+    for (int gridRow = firstGridRow; gridRow <= lastGridRow; ++gridRow) {
+        int start = -1;
+        int end = -1;
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            int row = gridRow * columns + column;
+            if (row >= count) {
+                break;
+            }
+            if (tileRect(row).intersects(content)) {
+                if (start < 0) {
+                    start = row;
+                }
+                end = row;
+            }
+        }
+        if (start >= 0) {
+            selection.select(model()->index(start, 0, rootIndex()),
+                             model()->index(end, 0, rootIndex()));
+        }
+    }
+
+    selectionModel()->select(selection, command);
+}
+
+QRegion FleetDashboardView::visualRegionForSelection(const QItemSelection &selection) const
+{
+    int first = 0;
+    int last = -1;
+    rowRange(viewport()->rect(), &first, &last);
+
+    QRegion region;
+    for (const QItemSelectionRange &range : selection) {
+        int top = qMax(range.top(), first);
+        int bottom = qMin(range.bottom(), last);
+        for (int row = top; row <= bottom; ++row) {
+            region += tileRect(row).translated(-horizontalOffset(), -verticalOffset());
+        }
+    }
+    return region;
+}
+
+void FleetDashboardView::updateGeometries()
+{
+    int count = model() ? model()->rowCount(rootIndex()) : 0;
+    int columns = columnCount();
+    int gridRows = (count + columns - 1) / columns;
+    int contentHeight = m_spacing + gridRows * (m_tileSize.height() + m_spacing);
+
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight - viewport()->height()));
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(m_tileSize.height() + m_spacing);
+    horizontalScrollBar()->setRange(0, 0);
+
+    QAbstractItemView::updateGeometries();
+}
+
+void FleetDashboardView::reset()
+{
+    QAbstractItemView::reset();
+
+    // Keys are stable across resets but rows may have gone; start over
+    m_tiles.clear();
+    m_slotKeys.fill(QString());
+    m_slotFrames.fill(0);
+}
+
+void FleetDashboardView::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                     const QVector<int> &roles)
+{
+    Q_UNUSED(roles);
+
+    // Only tiles on screen are repainted; the rest are read when scrolled in
+    if (!isVisible() || !topLeft.isValid() || !bottomRight.isValid()) {
+        return;
+    }
+
+    int first = 0;
+    int last = -1;
+    rowRange(viewport()->rect(), &first, &last);
+
+    int top = qMax(topLeft.row(), first);
+    int bottom = qMin(bottomRight.row(), last);
+    for (int row = top; row <= bottom; ++row) {
+        viewport()->update(tileRect(row).translated(-horizontalOffset(), -verticalOffset()));
+    }
+}
+
+void FleetDashboardView::rowsInserted(const QModelIndex &parent, int start, int end)
+{
+    QAbstractItemView::rowsInserted(parent, start, end);
+    scheduleDelayedItemsLayout();
+}
+
+void FleetDashboardView::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
+{
+    QAbstractItemView::rowsAboutToBeRemoved(parent, start, end);
+
+    // Drop the cached text and free the atlas slots of the leaving VMs,
+    // while their keys can still be read
+    if (parent == rootIndex()) {
+        for (int row = start; row <= end; ++row) {
+            auto it = m_tiles.find(tileKey(model()->index(row, 0, parent)));
+            if (it == m_tiles.end()) {
+                continue;
+            }
+            if (it->slot >= 0 && m_slotKeys.value(it->slot) == it.key()) {
+                m_slotKeys[it->slot].clear();
+                m_slotFrames[it->slot] = 0;
+            }
+            m_tiles.erase(it);
+        }
+    }
+
+    scheduleDelayedItemsLayout();
+}
+
+void FleetDashboardView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractItemView::resizeEvent(event);
+    updateGeometries();
+}
+
+void FleetDashboardView::changeEvent(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::PaletteChange:
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+        m_glyphsValid = false;
+        // Elided names depend on the font
+        for (TileCache &cache : m_tiles) {
+            cache.name.clear();
+            cache.detail.clear();
+        }
+        break;
+    default:
+        break;
+    }
+    QAbstractItemView::changeEvent(event);
+}
+
+void FleetDashboardView::scrollContentsBy(int dx, int dy)
+{
+    // Only the newly exposed strip gets repainted
+    viewport()->scroll(dx, dy);
+}
+
+void FleetDashboardView::paintEvent(QPaintEvent *event)
+{
+    m_lastPaintedTiles = 0;
+    if (!model()) {
+        return;
+    }
+
+    int first = 0;
+    int last = -1;
+    rowRange(event->rect(), &first, &last);
+    if (first > last) {
+        return;
+    }
+
+    ensureGlyphAtlas();
+    m_frame++;
+
+    struct VisibleTile {
+        QModelIndex index;
+        QRect rect;
+        QString key;
+        Glyph glyph;
+        float cpu;
+        float memory;
+    };
+
+    // Pass 0: cull and read the model once per visible tile
+    QVector<VisibleTile> tiles;
+    tiles.reserve(last - first + 1);
+    const QRegion region = event->region();
+    for (int row = first; row <= last; ++row) {
+        QRect rect = tileRect(row).translated(-horizontalOffset(), -verticalOffset());
+        if (!region.intersects(rect)) {
+            continue;
+        }
+
+        QModelIndex index = model()->index(row, 0, rootIndex());
+        int state = index.data(VMListModel::StateRole).toInt();
+        bool running = glyphForState(state) == RunningGlyph;
+        float maxMemory = index.data(VMListModel::MaxMemoryRole).toFloat();
+        float memory = running && maxMemory > 0.0f
+            ? index.data(VMListModel::MemoryRole).toFloat() / maxMemory * 100.0f : 0.0f;
+
+        VisibleTile tile;
+        tile.index = index;
+        tile.rect = rect;
+        tile.key = tileKey(index);
+        tile.glyph = glyphForState(state);
+        tile.cpu = running ? index.data(VMListModel::CPURole).toFloat() : 0.0f;
+        tile.memory = qBound(0.0f, memory, 100.0f);
+        tiles.append(tile);
+
+        // Insert now so no rehash happens while pointers are held below
+        m_tiles[tile.key];
+    }
+    m_lastPaintedTiles = tiles.size();
+
+    // Refresh text and find sparklines whose slot is missing or stale
+    QVector<QPair<int, QModelIndex>> pendingSparklines;
+    QFontMetrics fm(font());
+    for (const VisibleTile &tile : tiles) {
+        TileCache &cache = m_tiles[tile.key];
+
+        QString name = tile.index.data(VMListModel::NameRole).toString();
+        if (cache.name != name) {
+            cache.name = name;
+            cache.nameText.setText(fm.elidedText(name, Qt::ElideRight, m_layout.name.width()));
+            cache.nameText.setTextFormat(Qt::PlainText);
+        }
+
+        QString detail = tr("%1, CPU %2%, Mem %3%")
+            .arg(tile.index.data(VMListModel::StateStringRole).toString())
+            .arg(tile.cpu, 0, 'f', 0)
+            .arg(tile.memory, 0, 'f', 0);
+        if (cache.detail != detail) {
+            cache.detail = detail;
+            cache.detailText.setText(fm.elidedText(detail, Qt::ElideRight, m_layout.detail.width()));
+            cache.detailText.setTextFormat(Qt::PlainText);
+        }
+
+        quint64 generation = tile.index.data(VMListModel::CPUHistoryGenerationRole).toULongLong();
+        bool slotValid = cache.slot >= 0 && m_slotKeys.value(cache.slot) == tile.key;
+        if (!slotValid) {
+            cache.slot = acquireSlot(tile.key);
+        }
+        m_slotFrames[cache.slot] = m_frame;
+        if (!slotValid || cache.generation != generation) {
+            cache.generation = generation;
+            pendingSparklines.append(qMakePair(cache.slot, tile.index));
+        }
+    }
+
+    // Render stale sparklines into the atlas with a single painter
+    if (!pendingSparklines.isEmpty()) {
+        QPainter atlasPainter(&m_sparkAtlas);
+        atlasPainter.setRenderHint(QPainter::Antialiasing);
+        for (const auto &pending : pendingSparklines) {
+            QRect slot = slotRect(pending.first);
+            atlasPainter.setCompositionMode(QPainter::CompositionMode_Source);
+            atlasPainter.fillRect(slot, Qt::transparent);
+            atlasPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+            QVector<float> history =
+                pending.second.data(VMListModel::CPUHistoryRole).value<QVector<float>>();
+            atlasPainter.setClipRect(slot);
+            SparklineDelegate::paintSparkline(&atlasPainter, QRectF(slot).adjusted(1, 1, -1, -1),
+                                              history, CPUColor, 0.0f, 100.0f);
+            atlasPainter.setClipping(false);
+            m_sparklineRenders++;
+        }
+    }
+
+    QPainter painter(viewport());
+    const QColor textColor = palette().color(QPalette::Text);
+    const QColor trackColor = palette().color(QPalette::Midlight);
+    qreal dpr = m_sparkAtlas.devicePixelRatio();
+    qreal glyphDpr = m_glyphAtlas.devicePixelRatio();
+
+    QVector<QRect> backgrounds;
+    QVector<QRect> stripes[GlyphCount];
+    QVector<QRect> tracks;
+    QVector<QRect> cpuFills;
+    QVector<QRect> memoryFills;
+    QVector<QRect> selected;
+    QVector<QPainter::PixmapFragment> glyphs;
+    QVector<QPainter::PixmapFragment> sparklines;
+    backgrounds.reserve(tiles.size());
+    tracks.reserve(tiles.size() * 2);
+    glyphs.reserve(tiles.size());
+    sparklines.reserve(tiles.size());
+
+    for (const VisibleTile &tile : tiles) {
+        const QPoint origin = tile.rect.topLeft();
+        backgrounds.append(tile.rect);
+        stripes[tile.glyph].append(m_layout.stripe.translated(origin));
+
+        QRect cpuBar = m_layout.cpuBar.translated(origin);
+        QRect memoryBar = m_layout.memoryBar.translated(origin);
+        tracks.append(cpuBar);
+        tracks.append(memoryBar);
+        cpuBar.setWidth(qRound(cpuBar.width() * qMin(tile.cpu, 100.0f) / 100.0f));
+        memoryBar.setWidth(qRound(memoryBar.width() * tile.memory / 100.0f));
+        if (cpuBar.width() > 0) {
+            cpuFills.append(cpuBar);
+        }
+        if (memoryBar.width() > 0) {
+            memoryFills.append(memoryBar);
+        }
+
+        QRectF glyphSource(tile.glyph * GlyphSize * glyphDpr, 0,
+                           GlyphSize * glyphDpr, GlyphSize * glyphDpr);
+        glyphs.append(QPainter::PixmapFragment::create(
+            QRectF(m_layout.glyph.translated(origin)).center(), glyphSource,
+            1.0 / glyphDpr, 1.0 / glyphDpr));
+
+        const TileCache &cache = m_tiles[tile.key];
+        QRectF source(QRectF(slotRect(cache.slot)).topLeft() * dpr,
+                      QSizeF(m_layout.sparkline.size()) * dpr);
+        sparklines.append(QPainter::PixmapFragment::create(
+            QRectF(m_layout.sparkline.translated(origin)).center(), source,
+            1.0 / dpr, 1.0 / dpr));
+
+        if (selectionModel() && selectionModel()->isSelected(tile.index)) {
+            selected.append(tile.rect.adjusted(1, 1, -1, -1));
+        }
+    }
+
+    // Batched passes: one call per kind of primitive
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.setBrush(palette().color(QPalette::Base));
+    painter.drawRects(backgrounds);
+
+    painter.setPen(Qt::NoPen);
+    for (int g = 0; g < GlyphCount; ++g) {
+        if (!stripes[g].isEmpty()) {
+            painter.setBrush(glyphColor(g));
+            painter.drawRects(stripes[g]);
+        }
+    }
+
+    painter.setBrush(trackColor);
+    painter.drawRects(tracks);
+    painter.setBrush(CPUColor);
+    painter.drawRects(cpuFills);
+    painter.setBrush(MemoryColor);
+    painter.drawRects(memoryFills);
+
+    painter.drawPixmapFragments(glyphs.constData(), glyphs.size(), m_glyphAtlas);
+    painter.drawPixmapFragments(sparklines.constData(), sparklines.size(), m_sparkAtlas);
+
+    painter.setPen(textColor);
+    for (const VisibleTile &tile : tiles) {
+        const TileCache &cache = m_tiles[tile.key];
+        painter.drawStaticText(m_layout.name.translated(tile.rect.topLeft()).topLeft(), cache.nameText);
+    }
+    QColor detailColor = textColor;
+    detailColor.setAlpha(170);
+    painter.setPen(detailColor);
+    for (const VisibleTile &tile : tiles) {
+        const TileCache &cache = m_tiles[tile.key];
+        painter.drawStaticText(m_layout.detail.translated(tile.rect.topLeft()).topLeft(), cache.detailText);
+    }
+
+    // Optional console thumbnails are the only per-tile image draws
+    if (m_thumbnailRole >= 0) {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        for (const VisibleTile &tile : tiles) {
+            QVariant value = tile.index.data(m_thumbnailRole);
+            QRect box = m_layout.thumbnail.translated(tile.rect.topLeft());
+            if (value.canConvert<QPixmap>()) {
+                QPixmap pixmap = value.value<QPixmap>();
+                if (!pixmap.isNull()) {
+                    QSize size = (QSizeF(pixmap.size()) / pixmap.devicePixelRatio()).toSize()
+                                     .scaled(box.size(), Qt::KeepAspectRatio);
+                    QRect target(QPoint(0, 0), size);
+                    target.moveCenter(box.center());
+                    painter.drawPixmap(target, pixmap);
+                }
+            } else if (value.canConvert<QImage>()) {
+                QImage image = value.value<QImage>();
+                if (!image.isNull()) {
+                    QRect target(QPoint(0, 0), image.size().scaled(box.size(), Qt::KeepAspectRatio));
+                    target.moveCenter(box.center());
+                    painter.drawImage(target, image);
+                }
+            }
+        }
+    }
+
+    if (!selected.isEmpty()) {
+        painter.setPen(QPen(palette().color(QPalette::Highlight), 2));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRects(selected);
+    }
+
+    QModelIndex current = currentIndex();
+    if (hasFocus() && current.isValid() && current.row() >= first && current.row() <= last) {
+        painter.setPen(QPen(palette().color(QPalette::Highlight), 1, Qt::DotLine));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(visualRect(current).adjusted(3, 3, -4, -4));
+    }
+}
+
+} // namespace QVirt
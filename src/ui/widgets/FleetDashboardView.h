@@ -0,0 +1,148 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_WIDGETS_FLEETDASHBOARDVIEW_H
+#define QVIRT_UI_WIDGETS_FLEETDASHBOARDVIEW_H
+
+#include <QAbstractItemView>
+#include <QHash>
+#include <QPixmap>
+#include <QStaticText>
+#include <QVector>
+
+namespace QVirt {
+
+/**
+ * @brief Grid of VM tiles for a wall-screen overview of many domains
+ *
+ * A single item view over a VMListModel (or any model exposing the same
+ * roles). Tiles are not widgets: the grid is pure arithmetic, so only rows
+ * intersecting the exposed region are visited, and each paint is done in
+ * a fixed number of batched passes (backgrounds, state stripes, glyphs,
+ * usage bars, sparklines, text) rather than tile by tile.
+ *
+ * State glyphs come from one pre-rendered atlas and CPU sparklines from a
+ * shared, LRU-managed atlas; a sparkline slot is re-rendered only when the
+ * row's history generation moves. Model updates for tiles outside the
+ * viewport cost nothing.
+ */
+class FleetDashboardView : public QAbstractItemView
+{
+    Q_OBJECT
+
+public:
+    explicit FleetDashboardView(QWidget *parent = nullptr);
+    ~FleetDashboardView() override = default;
+
+    QSize tileSize() const { return m_tileSize; }
+    void setTileSize(const QSize &size);
+
+    // Role providing a QPixmap/QImage console thumbnail, or -1 for none
+    int thumbnailRole() const { return m_thumbnailRole; }
+    void setThumbnailRole(int role);
+
+    // Statistics for the last paint, for tests and profiling
+    int lastPaintedTileCount() const { return m_lastPaintedTiles; }
+    int sparklineRenderCount() const { return m_sparklineRenders; }
+    int atlasSlotCount() const { return m_slotKeys.size(); }
+    int cachedTileCount() const { return m_tiles.size(); }
+
+    // QAbstractItemView interface
+    QRect visualRect(const QModelIndex &index) const override;
+    void scrollTo(const QModelIndex &index, ScrollHint hint = EnsureVisible) override;
+    QModelIndex indexAt(const QPoint &point) const override;
+
+public slots:
+    void reset() override;
+
+protected slots:
+    void dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                     const QVector<int> &roles = QVector<int>()) override;
+    void rowsInserted(const QModelIndex &parent, int start, int end) override;
+    void rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end) override;
+    void updateGeometries() override;
+
+protected:
+    QModelIndex moveCursor(CursorAction cursorAction, Qt::KeyboardModifiers modifiers) override;
+    int horizontalOffset() const override;
+    int verticalOffset() const override;
+    bool isIndexHidden(const QModelIndex &index) const override;
+    void setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command) override;
+    QRegion visualRegionForSelection(const QItemSelection &selection) const override;
+
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    enum Glyph {
+        RunningGlyph,
+        PausedGlyph,
+        StoppedGlyph,
+        OtherGlyph,
+        GlyphCount
+    };
+
+    // Positions inside a tile, relative to its top-left corner
+    struct TileLayout {
+        QRect stripe;
+        QRect glyph;
+        QRect name;
+        QRect detail;
+        QRect cpuBar;
+        QRect memoryBar;
+        QRect sparkline;
+        QRect thumbnail;
+    };
+
+    struct TileCache {
+        QString name;
+        QString detail;
+        QStaticText nameText;
+        QStaticText detailText;
+        quint64 generation = 0;
+        int slot = -1;
+    };
+
+    int columnCount() const;
+    QRect tileRect(int row) const;      // Content coordinates
+    void rowRange(const QRect &viewportRect, int *first, int *last) const;
+    QString tileKey(const QModelIndex &index) const;
+
+    void updateLayout();
+    void ensureGlyphAtlas();
+    int acquireSlot(const QString &key);
+    QRect slotRect(int slot) const;     // Logical atlas coordinates
+    static Glyph glyphForState(int state);
+
+    QSize m_tileSize;
+    int m_spacing;
+    int m_thumbnailRole;
+    TileLayout m_layout;
+
+    QPixmap m_glyphAtlas;
+    bool m_glyphsValid;
+
+    // Sparkline atlas: fixed-size slots, recycled least recently painted first
+    QPixmap m_sparkAtlas;
+    QVector<QString> m_slotKeys;
+    QVector<quint64> m_slotFrames;
+    QHash<QString, TileCache> m_tiles;
+    quint64 m_frame;
+
+    int m_lastPaintedTiles;
+    int m_sparklineRenders;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_WIDGETS_FLEETDASHBOARDVIEW_H
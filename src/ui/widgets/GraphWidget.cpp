@@ -15,20 +15,31 @@
 #include <QPainterPath>
 #include <QDebug>
 #include <QPixmap>
+#include <QPolygonF>
+#include <QEvent>
+#include <algorithm>
 
 namespace QVirt {
 
 GraphWidget::GraphWidget(GraphType type, QWidget *parent)
     : QWidget(parent)
     , m_type(type)
+    , m_data(60)
     , m_maxDataPoints(60)
+    , m_sampleSequence(0)
     , m_updateTimer(nullptr)
     , m_updateInterval(1000)
     , m_minValue(0.0f)
     , m_maxValue(100.0f)
+    , m_staticDirty(true)
+    , m_plotDirty(true)
+    , m_scrollRemainder(0.0)
+    , m_plotRebuildCount(0)
 {
     setMinimumSize(200, 100);
-    setAutoFillBackground(true);
+
+    // Every pixel comes from the cached layers
+    setAttribute(Qt::WA_OpaquePaintEvent);
 
     // Set default colors based on type
     switch (type) {
@@ -56,22 +67,22 @@ GraphWidget::GraphWidget(GraphType type, QWidget *parent)
 
 void GraphWidget::addValue(float value)
 {
+    bool wasFull = m_data.size() == m_data.capacity();
     m_data.append(value);
-
-    // Keep only the last maxDataPoints values
-    while (m_data.size() > m_maxDataPoints) {
-        m_data.removeFirst();
-    }
-
-    // Update min/max values
-    m_minValue = 0.0f;
-    m_maxValue = 100.0f;
-
-    if (!m_data.isEmpty()) {
-        float max = *std::max_element(m_data.begin(), m_data.end());
-        if (max > m_maxValue) {
-            m_maxValue = max;
-        }
+    pushExtrema(value);
+
+    float previousMax = m_maxValue;
+    updateScale();
+
+    if (m_maxValue != previousMax) {
+        // Y-axis labels and every point move with the scale
+        m_staticDirty = true;
+        m_plotDirty = true;
+    } else if (!m_plotDirty && isVisible()) {
+        appendSegment(wasFull);
+    } else {
+        // Hidden graphs only record samples and redraw once when shown
+        m_plotDirty = true;
     }
 
     update();
@@ -80,6 +91,10 @@ void GraphWidget::addValue(float value)
 void GraphWidget::clear()
 {
     m_data.clear();
+    rebuildExtrema();
+    updateScale();
+    m_staticDirty = true;
+    m_plotDirty = true;
     update();
 }
 
@@ -94,12 +109,15 @@ void GraphWidget::setUpdateInterval(int milliseconds)
 
 void GraphWidget::setMaxDataPoints(int points)
 {
-    m_maxDataPoints = points;
-
-    // Trim existing data if needed
-    while (m_data.size() > m_maxDataPoints) {
-        m_data.removeFirst();
-    }
+    m_maxDataPoints = qMax(2, points);
+
+    // Keeps the newest samples if the buffer shrinks
+    m_data.setCapacity(m_maxDataPoints);
+    rebuildExtrema();
+    updateScale();
+    m_staticDirty = true;
+    m_plotDirty = true;
+    update();
 }
 
 QString GraphWidget::title() const
@@ -110,6 +128,7 @@ QString GraphWidget::title() const
 void GraphWidget::setTitle(const QString &title)
 {
     m_title = title;
+    m_staticDirty = true;
     update();
 }
 
@@ -121,38 +140,190 @@ QColor GraphWidget::graphColor() const
 void GraphWidget::setGraphColor(const QColor &color)
 {
     m_graphColor = color;
+    m_plotDirty = true;
     update();
 }
 
+float GraphWidget::minimumValue() const
+{
+    return m_minWindow.empty() ? 0.0f : m_minWindow.front().value;
+}
+
+float GraphWidget::maximumValue() const
+{
+    return m_maxWindow.empty() ? 0.0f : m_maxWindow.front().value;
+}
+
 void GraphWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
 
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    QSize pixelSize = size() * devicePixelRatioF();
+    if (m_staticDirty || m_staticLayer.size() != pixelSize) {
+        rebuildStaticLayer();
+    }
+    if (m_plotDirty || m_plotLayer.size() != pixelSize) {
+        rebuildPlotLayer();
+    }
 
-    drawBackground(&painter);
-    drawGrid(&painter);
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_staticLayer);
+    painter.drawPixmap(0, 0, m_plotLayer);
 
     if (!m_data.isEmpty()) {
-        drawGraph(&painter);
+        painter.setRenderHint(QPainter::Antialiasing);
+        drawCurrentValue(&painter);
     }
-
-    drawLabels(&painter);
 }
 
 void GraphWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
+    m_staticDirty = true;
+    m_plotDirty = true;
     update();
 }
 
+void GraphWidget::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::FontChange) {
+        m_staticDirty = true;
+    }
+    QWidget::changeEvent(event);
+}
+
 void GraphWidget::updateGraph()
 {
     // This would be called by timer if we were auto-updating
     // For now, updates are triggered externally via addValue()
 }
 
+void GraphWidget::rebuildStaticLayer()
+{
+    m_staticLayer = QPixmap(size() * devicePixelRatioF());
+    m_staticLayer.setDevicePixelRatio(devicePixelRatioF());
+
+    QPainter painter(&m_staticLayer);
+    drawBackground(&painter);
+    drawGrid(&painter);
+    drawLabels(&painter);
+
+    m_staticDirty = false;
+}
+
+void GraphWidget::rebuildPlotLayer()
+{
+    m_plotLayer = QPixmap(size() * devicePixelRatioF());
+    m_plotLayer.setDevicePixelRatio(devicePixelRatioF());
+    m_plotLayer.fill(Qt::transparent);
+    m_scrollRemainder = 0.0;
+
+    if (m_data.size() >= 2) {
+        QPainter painter(&m_plotLayer);
+        painter.setRenderHint(QPainter::Antialiasing);
+        drawGraph(&painter);
+    }
+
+    m_plotDirty = false;
+    m_plotRebuildCount++;
+}
+
+void GraphWidget::appendSegment(bool scroll)
+{
+    int count = m_data.size();
+    if (count < 2 || m_plotLayer.isNull()) {
+        m_plotDirty = true;
+        return;
+    }
+
+    float step = xStep();
+    qreal dpr = m_plotLayer.devicePixelRatio();
+
+    if (scroll) {
+        // Shift the existing plot left by one sample; carry the sub-pixel
+        // remainder so the drift never exceeds one pixel
+        m_scrollRemainder += step * dpr;
+        int dx = qRound(m_scrollRemainder);
+        m_scrollRemainder -= dx;
+        m_plotLayer.scroll(-dx, 0, m_plotLayer.rect());
+
+        QPainter clearPainter(&m_plotLayer);
+        clearPainter.setCompositionMode(QPainter::CompositionMode_Source);
+        clearPainter.fillRect(QRectF(width() - dx / dpr, 0, dx / dpr + 1, height()), Qt::transparent);
+    }
+
+    QPointF from((count - 2) * step, yForValue(m_data.at(count - 2)));
+    QPointF to((count - 1) * step, yForValue(m_data.at(count - 1)));
+
+    QPainter painter(&m_plotLayer);
+
+    // Fill area under the new segment
+    QColor fillColor = m_graphColor;
+    fillColor.setAlpha(50);
+    QPolygonF area;
+    area << from << to << QPointF(to.x(), height()) << QPointF(from.x(), height());
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(fillColor);
+    painter.drawPolygon(area);
+
+    // Draw the line
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(m_graphColor, 2));
+    painter.drawLine(from, to);
+}
+
+void GraphWidget::pushExtrema(float value)
+{
+    quint64 sequence = m_sampleSequence++;
+
+    while (!m_maxWindow.empty() && m_maxWindow.back().value <= value) {
+        m_maxWindow.pop_back();
+    }
+    m_maxWindow.push_back({sequence, value});
+
+    while (!m_minWindow.empty() && m_minWindow.back().value >= value) {
+        m_minWindow.pop_back();
+    }
+    m_minWindow.push_back({sequence, value});
+
+    // Expire samples that fell out of the ring buffer
+    quint64 held = static_cast<quint64>(m_data.size());
+    quint64 oldest = m_sampleSequence > held ? m_sampleSequence - held : 0;
+    while (!m_maxWindow.empty() && m_maxWindow.front().sequence < oldest) {
+        m_maxWindow.pop_front();
+    }
+    while (!m_minWindow.empty() && m_minWindow.front().sequence < oldest) {
+        m_minWindow.pop_front();
+    }
+}
+
+void GraphWidget::rebuildExtrema()
+{
+    m_minWindow.clear();
+    m_maxWindow.clear();
+    m_sampleSequence = 0;
+    for (int i = 0; i < m_data.size(); ++i) {
+        pushExtrema(m_data.at(i));
+    }
+}
+
+void GraphWidget::updateScale()
+{
+    // Percent scale, stretched when samples exceed it
+    m_minValue = 0.0f;
+    m_maxValue = qMax(100.0f, maximumValue());
+}
+
+float GraphWidget::xStep() const
+{
+    return static_cast<float>(width()) / (m_data.capacity() - 1);
+}
+
+float GraphWidget::yForValue(float value) const
+{
+    return height() - (value / m_maxValue * (height() - 20)) - 10;  // Leave padding
+}
+
 void GraphWidget::drawBackground(QPainter *painter)
 {
     painter->fillRect(rect(), palette().window());
@@ -184,28 +355,15 @@ void GraphWidget::drawGraph(QPainter *painter)
     // Create path for the graph
     QPainterPath path;
 
-    float xStep = static_cast<float>(width()) / (m_maxDataPoints - 1);
-
-    // Start the path
-    float y = height() - (m_data[0] / m_maxValue * height());
-    path.moveTo(0, y);
-
-    // Add points to the path
+    float step = xStep();
+    path.moveTo(0, yForValue(m_data.at(0)));
     for (int i = 1; i < m_data.size(); ++i) {
-        float x = i * xStep;
-        float value = m_data[i];
-        y = height() - (value / m_maxValue * (height() - 20)) - 10;  // Leave padding
-        path.lineTo(x, y);
+        path.lineTo(i * step, yForValue(m_data.at(i)));
     }
 
-    // Draw the line
-    QPen pen(m_graphColor, 2);
-    painter->setPen(pen);
-    painter->drawPath(path);
-
     // Fill area under the graph
     QPainterPath fillPath = path;
-    fillPath.lineTo(width(), height());
+    fillPath.lineTo((m_data.size() - 1) * step, height());
     fillPath.lineTo(0, height());
     fillPath.closeSubpath();
 
@@ -213,14 +371,10 @@ void GraphWidget::drawGraph(QPainter *painter)
     fillColor.setAlpha(50);
     painter->fillPath(fillPath, fillColor);
 
-    // Draw current value indicator
-    float lastX = (m_data.size() - 1) * xStep;
-    float lastValue = m_data.last();
-    float lastY = height() - (lastValue / m_maxValue * (height() - 20)) - 10;
-
-    painter->setBrush(QBrush(m_graphColor));
-    painter->setPen(Qt::NoPen);
-    painter->drawEllipse(QPointF(lastX, lastY), 4, 4);
+    // Draw the line
+    QPen pen(m_graphColor, 2);
+    painter->setPen(pen);
+    painter->drawPath(path);
 }
 
 void GraphWidget::drawLabels(QPainter *painter)
@@ -236,20 +390,8 @@ void GraphWidget::drawLabels(QPainter *painter)
     QRect titleRect(10, 5, width() - 20, 20);
     painter->drawText(titleRect, Qt::AlignLeft, m_title);
 
-    // Draw current value if available
-    if (!m_data.isEmpty()) {
-        float currentValue = m_data.last();
-        QString valueText = QString::number(currentValue, 'f', 1) + "%";
-
-        font.setBold(false);
-        font.setPointSize(9);
-        painter->setFont(font);
-
-        QRect valueRect(width() - 80, 5, 70, 20);
-        painter->drawText(valueRect, Qt::AlignRight, valueText);
-    }
-
     // Draw Y-axis labels
+    font.setBold(false);
     font.setPointSize(7);
     painter->setFont(font);
 
@@ -263,10 +405,122 @@ void GraphWidget::drawLabels(QPainter *painter)
     }
 }
 
+void GraphWidget::drawCurrentValue(QPainter *painter)
+{
+    float currentValue = m_data.last();
+
+    // Draw current value indicator
+    if (m_data.size() >= 2) {
+        float lastX = (m_data.size() - 1) * xStep();
+        float lastY = yForValue(currentValue);
+
+        painter->setBrush(QBrush(m_graphColor));
+        painter->setPen(Qt::NoPen);
+        painter->drawEllipse(QPointF(lastX, lastY), 4, 4);
+    }
+
+    // Draw current value
+    QFont font = painter->font();
+    font.setPointSize(9);
+    painter->setFont(font);
+    painter->setPen(QColor(80, 80, 80));
+
+    QString valueText = QString::number(currentValue, 'f', 1) + "%";
+    QRect valueRect(width() - 80, 5, 70, 20);
+    painter->drawText(valueRect, Qt::AlignRight, valueText);
+}
+
 // ============================================================================
 // SparklineDelegate
 // ============================================================================
 
+SparklineDelegate::SparklineDelegate(int historyRole, int generationRole, int keyRole,
+                                     QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_historyRole(historyRole)
+    , m_generationRole(generationRole)
+    , m_keyRole(keyRole)
+    , m_color(52, 152, 219)
+    , m_rangeMin(0.0f)
+    , m_rangeMax(0.0f)
+    , m_cache(2048)
+    , m_renderCount(0)
+{
+}
+
+void SparklineDelegate::setColor(const QColor &color)
+{
+    m_color = color;
+    clearCache();
+}
+
+void SparklineDelegate::setValueRange(float min, float max)
+{
+    m_rangeMin = min;
+    m_rangeMax = max;
+    clearCache();
+}
+
+void SparklineDelegate::clearCache()
+{
+    m_cache.clear();
+}
+
+void SparklineDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                              const QModelIndex &index) const
+{
+    // Let the style draw background and selection
+    QStyledItemDelegate::paint(painter, option, index);
+
+    QRect target = option.rect.adjusted(2, 3, -2, -3);
+    if (target.width() < 4 || target.height() < 4) {
+        return;
+    }
+
+    QString key = index.data(m_keyRole).toString();
+    if (key.isEmpty()) {
+        key = QString::number(index.row());
+    }
+    quint64 generation = index.data(m_generationRole).toULongLong();
+
+    qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    QSize pixelSize = target.size() * dpr;
+
+    CachedSparkline *cached = m_cache.object(key);
+    bool stale = !cached || cached->generation != generation
+                 || cached->pixmap.size() != pixelSize;
+
+    if (stale) {
+        QVector<float> data = index.data(m_historyRole).value<QVector<float>>();
+        if (data.isEmpty()) {
+            return;
+        }
+
+        if (!cached) {
+            cached = new CachedSparkline;
+            m_cache.insert(key, cached);
+        }
+
+        // Reuse the pixmap when only the history advanced
+        if (cached->pixmap.size() != pixelSize) {
+            cached->pixmap = QPixmap(pixelSize);
+        }
+        cached->pixmap.setDevicePixelRatio(dpr);
+        cached->generation = generation;
+        renderSparkline(&cached->pixmap, data, m_color, m_rangeMin, m_rangeMax);
+        m_renderCount++;
+    }
+
+    painter->drawPixmap(target.topLeft(), cached->pixmap);
+}
+
+QSize SparklineDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                  const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QSize(80, qMax(20, option.fontMetrics.height() + 6));
+}
+
 QPixmap SparklineDelegate::generateSparkline(const QVector<float> &data,
                                              const QSize &size,
                                              const QColor &color)
@@ -276,60 +530,80 @@ QPixmap SparklineDelegate::generateSparkline(const QVector<float> &data,
     }
 
     QPixmap pixmap(size);
-    pixmap.fill(Qt::transparent);
+    renderSparkline(&pixmap, data, color, 0.0f, 0.0f);
+    return pixmap;
+}
 
-    QPainter painter(&pixmap);
+void SparklineDelegate::renderSparkline(QPixmap *pixmap, const QVector<float> &data,
+                                        const QColor &color, float minVal, float maxVal)
+{
+    pixmap->fill(Qt::transparent);
+
+    QPainter painter(pixmap);
     painter.setRenderHint(QPainter::Antialiasing);
 
+    QSizeF size = QSizeF(pixmap->size()) / pixmap->devicePixelRatio();
+    paintSparkline(&painter, QRectF(QPointF(0, 0), size), data, color, minVal, maxVal);
+}
+
+void SparklineDelegate::paintSparkline(QPainter *painter, const QRectF &rect,
+                                       const QVector<float> &data, const QColor &color,
+                                       float minVal, float maxVal)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
     if (data.size() < 2) {
         // Draw single point
-        painter.setBrush(QBrush(color));
-        painter.setPen(Qt::NoPen);
-        painter.drawEllipse(QPointF(size.width() / 2, size.height() / 2), 2, 2);
-        return pixmap;
+        painter->setBrush(QBrush(color));
+        painter->setPen(Qt::NoPen);
+        painter->drawEllipse(rect.center(), 2, 2);
+        return;
     }
 
-    // Create path
-    QPainterPath path;
+    // Scale to the data when no fixed range is set
+    if (maxVal <= minVal) {
+        auto bounds = std::minmax_element(data.cbegin(), data.cend());
+        minVal = *bounds.first;
+        maxVal = *bounds.second;
+    }
 
-    float minVal = *std::min_element(data.begin(), data.end());
-    float maxVal = *std::max_element(data.begin(), data.end());
     float range = maxVal - minVal;
-
     if (range == 0) {
         range = 1.0f;
     }
 
-    float xStep = static_cast<float>(size.width()) / (data.size() - 1);
+    // Create path
+    QPainterPath path;
 
-    // Start the path
-    float y = size.height() - ((data[0] - minVal) / range * size.height());
-    path.moveTo(0, y);
+    float xStep = static_cast<float>(rect.width()) / (data.size() - 1);
 
-    // Add points
-    for (int i = 1; i < data.size(); ++i) {
-        float x = i * xStep;
-        float value = data[i];
-        y = size.height() - ((value - minVal) / range * size.height());
-        path.lineTo(x, y);
+    for (int i = 0; i < data.size(); ++i) {
+        float value = qBound(minVal, data[i], maxVal);
+        float y = rect.bottom() - ((value - minVal) / range * rect.height());
+        if (i == 0) {
+            path.moveTo(rect.left(), y);
+        } else {
+            path.lineTo(rect.left() + i * xStep, y);
+        }
     }
 
     // Draw the line
     QPen pen(color, 1.5);
-    painter.setPen(pen);
-    painter.drawPath(path);
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(path);
 
     // Fill area under the graph
     QPainterPath fillPath = path;
-    fillPath.lineTo(size.width(), size.height());
-    fillPath.lineTo(0, size.height());
+    fillPath.lineTo(rect.right(), rect.bottom());
+    fillPath.lineTo(rect.left(), rect.bottom());
     fillPath.closeSubpath();
 
     QColor fillColor = color;
     fillColor.setAlpha(80);
-    painter.fillPath(fillPath, fillColor);
-
-    return pixmap;
+    painter->fillPath(fillPath, fillColor);
 }
 
 } // namespace QVirt
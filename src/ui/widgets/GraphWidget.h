@@ -15,6 +15,12 @@
 #include <QWidget>
 #include <QVector>
 #include <QString>
+#include <QPixmap>
+#include <QCache>
+#include <QStyledItemDelegate>
+#include <deque>
+
+#include "../../core/StatsHistory.h"
 
 class QPainter;
 class QTimer;
@@ -24,7 +30,13 @@ namespace QVirt {
 /**
  * @brief Performance graph widget
  *
- * Displays real-time performance data as a line graph
+ * Displays real-time performance data as a line graph.
+ *
+ * Samples live in a fixed-capacity ring buffer and the window min/max is
+ * kept with monotonic deques, so addValue() is O(1) amortized. Painting
+ * composites two cached layers: background/grid/axis labels, rebuilt only
+ * on resize or scale changes, and the plot, which is scrolled in place
+ * with only the newest segment drawn for each sample.
  */
 class GraphWidget : public QWidget
 {
@@ -52,44 +64,135 @@ public:
     QColor graphColor() const;
     void setGraphColor(const QColor &color);
 
+    // Samples currently held and their extrema
+    int dataPointCount() const { return m_data.size(); }
+    float minimumValue() const;
+    float maximumValue() const;
+
+    // Number of full plot redraws (scrolled samples do not count)
+    int plotRebuildCount() const { return m_plotRebuildCount; }
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
 
 private slots:
     void updateGraph();
 
 private:
+    struct WindowSample {
+        quint64 sequence;
+        float value;
+    };
+
     void drawBackground(QPainter *painter);
     void drawGrid(QPainter *painter);
     void drawGraph(QPainter *painter);
     void drawLabels(QPainter *painter);
+    void drawCurrentValue(QPainter *painter);
+
+    void rebuildStaticLayer();
+    void rebuildPlotLayer();
+    void appendSegment(bool scroll);
+    void pushExtrema(float value);
+    void rebuildExtrema();
+    void updateScale();
+    float xStep() const;
+    float yForValue(float value) const;
 
     GraphType m_type;
     QString m_title;
     QColor m_graphColor;
 
-    QVector<float> m_data;
+    StatsHistory m_data;
     int m_maxDataPoints;
 
+    // Sliding window extrema (front holds the current min/max)
+    std::deque<WindowSample> m_minWindow;
+    std::deque<WindowSample> m_maxWindow;
+    quint64 m_sampleSequence;
+
     QTimer *m_updateTimer;
     int m_updateInterval;
 
     float m_minValue;
     float m_maxValue;
+
+    // Cached layers
+    QPixmap m_staticLayer;
+    QPixmap m_plotLayer;
+    bool m_staticDirty;
+    bool m_plotDirty;
+    qreal m_scrollRemainder;
+    int m_plotRebuildCount;
 };
 
 /**
  * @brief Sparkline delegate for table views
  *
- * Displays mini graphs in table cells
+ * Displays mini graphs in table cells. The history is read from
+ * @p historyRole as a QVector<float>; rendered pixmaps are cached per
+ * row key and only redrawn when the row's @p generationRole value or the
+ * cell size changes, so repainting an unchanged row is a single blit.
  */
-class SparklineDelegate
+class SparklineDelegate : public QStyledItemDelegate
 {
+    Q_OBJECT
+
 public:
+    SparklineDelegate(int historyRole, int generationRole, int keyRole,
+                      QObject *parent = nullptr);
+    ~SparklineDelegate() override = default;
+
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+
+    /**
+     * @brief Use a fixed vertical range for all rows
+     *
+     * A fixed range keeps rows comparable (e.g. 0-100 for CPU percent).
+     * If max <= min, every sparkline is scaled to its own data.
+     */
+    void setValueRange(float min, float max);
+
+    void clearCache();
+    int cachedCount() const { return m_cache.count(); }
+    int renderCount() const { return m_renderCount; }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option,
+                   const QModelIndex &index) const override;
+
     static QPixmap generateSparkline(const QVector<float> &data,
                                      const QSize &size,
                                      const QColor &color = Qt::blue);
+
+    // Draw a sparkline into @p rect of an already cleared target; a range
+    // with max <= min scales to the data
+    static void paintSparkline(QPainter *painter, const QRectF &rect,
+                               const QVector<float> &data, const QColor &color,
+                               float minVal = 0.0f, float maxVal = 0.0f);
+
+private:
+    struct CachedSparkline {
+        quint64 generation = 0;
+        QPixmap pixmap;
+    };
+
+    static void renderSparkline(QPixmap *pixmap, const QVector<float> &data,
+                                const QColor &color, float minVal, float maxVal);
+
+    int m_historyRole;
+    int m_generationRole;
+    int m_keyRole;
+    QColor m_color;
+    float m_rangeMin;
+    float m_rangeMax;
+
+    mutable QCache<QString, CachedSparkline> m_cache;
+    mutable int m_renderCount;
 };
 
 } // namespace QVirt
@@ -0,0 +1,206 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "StorageJobPanel.h"
+#include "../../libvirt/StorageJobManager.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QLabel>
+
+namespace QVirt {
+
+namespace {
+
+enum JobColumn {
+    ColumnOperation,
+    ColumnPool,
+    ColumnProgress,
+    ColumnStatus
+};
+
+QString stateText(const StorageJob *job)
+{
+    switch (job->state()) {
+    case StorageJob::Queued:
+        return QObject::tr("Queued");
+    case StorageJob::Running:
+        return job->isCancelRequested() ? QObject::tr("Cancelling") : QObject::tr("Running");
+    case StorageJob::Finished:
+        return job->usedReflink() ? QObject::tr("Done (reflink)") : QObject::tr("Done");
+    case StorageJob::Failed:
+        return QObject::tr("Failed: %1").arg(job->errorString());
+    case StorageJob::Cancelled:
+        return QObject::tr("Cancelled");
+    }
+    return QString();
+}
+
+} // namespace
+
+StorageJobPanel::StorageJobPanel(StorageJobManager *manager, QWidget *parent)
+    : QWidget(parent)
+    , m_manager(manager)
+    , m_jobList(nullptr)
+    , m_summaryLabel(nullptr)
+    , m_btnCancel(nullptr)
+    , m_btnClear(nullptr)
+{
+    setupUI();
+
+    connect(m_manager, &StorageJobManager::jobAdded, this, &StorageJobPanel::onJobAdded);
+    connect(m_manager, &StorageJobManager::jobRemoved, this, &StorageJobPanel::onJobRemoved);
+
+    for (StorageJob *job : m_manager->jobs()) {
+        onJobAdded(job);
+    }
+    updateSummary();
+    updateButtons();
+}
+
+void StorageJobPanel::setupUI()
+{
+    auto *layout = new QVBoxLayout(this);
+
+    m_jobList = new QTreeWidget(this);
+    m_jobList->setRootIsDecorated(false);
+    m_jobList->setHeaderLabels({tr("Operation"), tr("Pool"), tr("Progress"), tr("Status")});
+    m_jobList->header()->setStretchLastSection(true);
+    m_jobList->setColumnWidth(ColumnOperation, 220);
+    m_jobList->setColumnWidth(ColumnProgress, 160);
+    connect(m_jobList, &QTreeWidget::itemSelectionChanged, this, &StorageJobPanel::updateButtons);
+    layout->addWidget(m_jobList);
+
+    auto *buttonLayout = new QHBoxLayout();
+    m_summaryLabel = new QLabel(this);
+    m_btnCancel = new QPushButton(tr("Cancel Job"), this);
+    m_btnClear = new QPushButton(tr("Clear Finished"), this);
+    connect(m_btnCancel, &QPushButton::clicked, this, &StorageJobPanel::onCancel);
+    connect(m_btnClear, &QPushButton::clicked, this, &StorageJobPanel::onClearFinished);
+
+    buttonLayout->addWidget(m_summaryLabel);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_btnCancel);
+    buttonLayout->addWidget(m_btnClear);
+    layout->addLayout(buttonLayout);
+}
+
+void StorageJobPanel::onJobAdded(StorageJob *job)
+{
+    if (m_items.contains(job)) {
+        return;
+    }
+
+    auto *item = new QTreeWidgetItem(m_jobList);
+    m_items.insert(job, item);
+
+    auto *bar = new QProgressBar(m_jobList);
+    bar->setTextVisible(true);
+    m_jobList->setItemWidget(item, ColumnProgress, bar);
+
+    connect(job, &StorageJob::stateChanged, this, [this, job]() {
+        updateJob(job);
+        updateSummary();
+        updateButtons();
+    });
+    connect(job, &StorageJob::progress, this, [this, job]() {
+        updateJob(job);
+    });
+
+    updateJob(job);
+    updateSummary();
+}
+
+void StorageJobPanel::onJobRemoved(StorageJob *job)
+{
+    delete m_items.take(job);
+    updateSummary();
+    updateButtons();
+}
+
+void StorageJobPanel::updateJob(StorageJob *job)
+{
+    QTreeWidgetItem *item = m_items.value(job);
+    if (!item) {
+        return;
+    }
+
+    item->setText(ColumnOperation, job->description());
+    item->setText(ColumnPool, job->poolName());
+    item->setText(ColumnStatus, stateText(job));
+    item->setToolTip(ColumnStatus, job->errorString());
+
+    auto *bar = qobject_cast<QProgressBar *>(m_jobList->itemWidget(item, ColumnProgress));
+    if (!bar) {
+        return;
+    }
+
+    if (job->state() == StorageJob::Running && job->totalBytes() <= 0) {
+        // Nothing to measure: a busy indicator
+        bar->setRange(0, 0);
+    } else {
+        bar->setRange(0, 100);
+        int percent = 0;
+        if (job->state() == StorageJob::Finished) {
+            percent = 100;
+        } else if (job->totalBytes() > 0) {
+            percent = int(job->processedBytes() * 100 / job->totalBytes());
+        }
+        bar->setValue(percent);
+    }
+}
+
+void StorageJobPanel::updateSummary()
+{
+    int active = m_manager->activeCount();
+    m_summaryLabel->setText(active > 0 ? tr("%1 job(s) pending").arg(active)
+                                       : tr("No pending jobs"));
+}
+
+StorageJob *StorageJobPanel::selectedJob() const
+{
+    QTreeWidgetItem *current = m_jobList->currentItem();
+    if (!current || !current->isSelected()) {
+        return nullptr;
+    }
+    for (auto it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        if (it.value() == current) {
+            return it.key();
+        }
+    }
+    return nullptr;
+}
+
+void StorageJobPanel::onCancel()
+{
+    if (StorageJob *job = selectedJob()) {
+        m_manager->cancel(job);
+        updateButtons();
+    }
+}
+
+void StorageJobPanel::onClearFinished()
+{
+    m_manager->clearFinished();
+}
+
+void StorageJobPanel::updateButtons()
+{
+    StorageJob *job = selectedJob();
+    m_btnCancel->setEnabled(job && job->isCancellable());
+    m_btnClear->setEnabled(m_manager->jobs().size() > m_manager->activeCount());
+}
+
+} // namespace QVirt
@@ -0,0 +1,65 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_STORAGEJOBPANEL_H
+#define QVIRT_UI_STORAGEJOBPANEL_H
+
+#include <QWidget>
+#include <QHash>
+
+class QTreeWidget;
+class QTreeWidgetItem;
+class QPushButton;
+class QLabel;
+
+namespace QVirt {
+
+class StorageJob;
+class StorageJobManager;
+
+/**
+ * @brief Queue of storage jobs with their progress
+ *
+ * Lists the jobs of a StorageJobManager, queued, running and done, and
+ * lets the user cancel the selected one or clear the finished ones.
+ */
+class StorageJobPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StorageJobPanel(StorageJobManager *manager, QWidget *parent = nullptr);
+
+private slots:
+    void onJobAdded(StorageJob *job);
+    void onJobRemoved(StorageJob *job);
+    void onCancel();
+    void onClearFinished();
+    void updateButtons();
+
+private:
+    void setupUI();
+    void updateJob(StorageJob *job);
+    void updateSummary();
+    StorageJob *selectedJob() const;
+
+    StorageJobManager *m_manager;
+    QHash<StorageJob*, QTreeWidgetItem*> m_items;
+
+    QTreeWidget *m_jobList;
+    QLabel *m_summaryLabel;
+    QPushButton *m_btnCancel;
+    QPushButton *m_btnClear;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_STORAGEJOBPANEL_H
@@ -0,0 +1,762 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "TimelineGraphWidget.h"
+#include <QPainter>
+#include <QPolygonF>
+#include <QDateTime>
+#include <QEvent>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <cmath>
+
+namespace QVirt {
+
+namespace {
+constexpr qint64 MinimumSpanMs = 60 * 1000;
+constexpr qint64 MaximumSpanMs = 7 * 24 * 3600 * 1000LL;
+constexpr qint64 DefaultSpanMs = 3600 * 1000;
+
+// Samples further apart than this are drawn as a gap (e.g. VM was off)
+constexpr qint64 GapThresholdMs = 30 * 1000;
+
+// LTTB picks one point per column from this many candidates
+constexpr int LTTBOversampling = 4;
+
+constexpr int LegendHeight = 20;
+constexpr int AxisLabelWidth = 64;
+constexpr int TimeLabelHeight = 16;
+
+float niceCeiling(float value)
+{
+    if (value <= 0.0f) {
+        return 1.0f;
+    }
+    float magnitude = std::pow(10.0f, std::floor(std::log10(value)));
+    for (float step : {1.0f, 2.0f, 5.0f, 10.0f}) {
+        if (value <= step * magnitude) {
+            return step * magnitude;
+        }
+    }
+    return 10.0f * magnitude;
+}
+
+QString formatValue(float value, const QString &unit)
+{
+    if (unit == QLatin1String("KiB/s") && value >= 1024.0f) {
+        return QString("%1 MiB/s").arg(value / 1024.0f, 0, 'f', 1);
+    }
+    // Small axis steps (e.g. 0.25 of a 1 KiB/s scale) keep a decimal
+    int decimals = value < 10.0f && value != std::floor(value) ? 1 : 0;
+    if (unit == QLatin1String("%")) {
+        return QString("%1%").arg(value, 0, 'f', decimals);
+    }
+    return QString("%1 %2").arg(value, 0, 'f', decimals).arg(unit);
+}
+} // namespace
+
+TimelineGraphWidget::TimelineGraphWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_history(nullptr)
+    , m_tiers(nullptr)
+    , m_tier(0)
+    , m_mode(MinMaxDownsample)
+    , m_span(DefaultSpanMs)
+    , m_viewEnd(0)
+    , m_following(true)
+    , m_dragging(false)
+    , m_dragOriginX(0)
+    , m_dragViewEnd(0)
+    , m_plotDirty(true)
+    , m_plotRebuildCount(0)
+    , m_renderedPointCount(0)
+{
+    setMinimumSize(300, 150);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setToolTip(tr("Scroll to zoom, drag to pan, double-click to return to live data.\n"
+                  "Click a legend entry to show or hide it."));
+
+    // Defaults match Domain::MetricSeries
+    setSeries(Domain::CpuMetric, tr("CPU"), QColor(52, 152, 219), "%", 100.0f);
+    setSeries(Domain::MemoryMetric, tr("Memory"), QColor(46, 204, 113), "%", 100.0f);
+    setSeries(Domain::DiskMetric, tr("Disk"), QColor(155, 89, 182), "KiB/s");
+    setSeries(Domain::NetworkMetric, tr("Network"), QColor(230, 126, 34), "KiB/s");
+}
+
+void TimelineGraphWidget::setDomain(Domain *domain)
+{
+    if (m_domain) {
+        disconnect(m_domain, nullptr, this, nullptr);
+    }
+
+    m_domain = domain;
+    setTieredHistory(domain ? &domain->metricHistory() : nullptr);
+
+    if (domain) {
+        connect(domain, &Domain::statsUpdated, this, &TimelineGraphWidget::refresh);
+        connect(domain, &QObject::destroyed, this, [this]() {
+            setTieredHistory(nullptr);
+        });
+    }
+}
+
+void TimelineGraphWidget::setHistory(const MetricHistory *history)
+{
+    m_history = history;
+    m_tiers = nullptr;
+    m_tier = 0;
+    m_pyramid.reset();
+    m_following = true;
+    invalidate();
+}
+
+void TimelineGraphWidget::setTieredHistory(const TieredMetricHistory *history)
+{
+    setHistory(history ? &history->tier(0) : nullptr);
+    m_tiers = history;
+}
+
+void TimelineGraphWidget::selectTier(qint64 t0)
+{
+    if (!m_tiers) {
+        return;
+    }
+    int tier = m_tiers->tierFor(t0);
+    if (tier != m_tier) {
+        // The pyramid summarizes one history; start over on the new tier
+        m_tier = tier;
+        m_history = &m_tiers->tier(tier);
+        m_pyramid.reset();
+    }
+}
+
+qint64 TimelineGraphWidget::firstTimestamp() const
+{
+    return m_tiers ? m_tiers->firstTimestamp() : m_history->firstTimestamp();
+}
+
+qint64 TimelineGraphWidget::lastTimestamp() const
+{
+    return m_tiers ? m_tiers->lastTimestamp() : m_history->lastTimestamp();
+}
+
+void TimelineGraphWidget::setSeries(int series, const QString &name, const QColor &color,
+                                    const QString &unit, float fixedMax)
+{
+    if (series < 0) {
+        return;
+    }
+    if (series >= m_series.size()) {
+        m_series.resize(series + 1);
+        m_peaks.resize(series + 1);
+    }
+
+    Series &s = m_series[series];
+    s.name = name;
+    s.color = color;
+    s.unit = unit;
+    s.fixedMax = fixedMax;
+    invalidate();
+}
+
+void TimelineGraphWidget::setSeriesVisible(int series, bool visible)
+{
+    if (series < 0 || series >= m_series.size() || m_series.at(series).visible == visible) {
+        return;
+    }
+    m_series[series].visible = visible;
+    invalidate();
+}
+
+bool TimelineGraphWidget::isSeriesVisible(int series) const
+{
+    return series >= 0 && series < m_series.size() && m_series.at(series).visible;
+}
+
+void TimelineGraphWidget::setDownsampleMode(DownsampleMode mode)
+{
+    if (m_mode == mode) {
+        return;
+    }
+    m_mode = mode;
+    invalidate();
+}
+
+void TimelineGraphWidget::setTimeSpan(qint64 milliseconds)
+{
+    milliseconds = qBound(MinimumSpanMs, milliseconds, MaximumSpanMs);
+    if (m_span == milliseconds) {
+        return;
+    }
+    m_span = milliseconds;
+    invalidate();
+}
+
+qint64 TimelineGraphWidget::viewEnd() const
+{
+    if (!m_following) {
+        return m_viewEnd;
+    }
+    if (m_history && !m_history->isEmpty()) {
+        return lastTimestamp();
+    }
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+void TimelineGraphWidget::setViewEnd(qint64 timestampMs)
+{
+    if (m_history && !m_history->isEmpty()) {
+        // Keep at least the oldest sample on screen
+        timestampMs = qMax(timestampMs, firstTimestamp());
+        if (timestampMs >= lastTimestamp()) {
+            setFollowing(true, timestampMs);
+            return;
+        }
+    }
+    setFollowing(false, timestampMs);
+}
+
+void TimelineGraphWidget::followLatest()
+{
+    setFollowing(true, m_viewEnd);
+}
+
+void TimelineGraphWidget::setFollowing(bool following, qint64 viewEnd)
+{
+    if (m_following == following && (following || m_viewEnd == viewEnd)) {
+        return;
+    }
+    m_following = following;
+    m_viewEnd = viewEnd;
+    invalidate();
+}
+
+void TimelineGraphWidget::zoom(qreal factor, qreal anchor)
+{
+    anchor = qBound<qreal>(0.0, anchor, 1.0);
+    qint64 end = viewEnd();
+    qint64 anchorTime = end - static_cast<qint64>(m_span * (1.0 - anchor));
+
+    qint64 span = qBound(MinimumSpanMs, static_cast<qint64>(m_span * factor), MaximumSpanMs);
+    if (span == m_span) {
+        return;
+    }
+    m_span = span;
+    m_plotDirty = true;
+    setViewEnd(anchorTime + static_cast<qint64>(span * (1.0 - anchor)));
+    update();
+}
+
+void TimelineGraphWidget::pan(qint64 milliseconds)
+{
+    setViewEnd(viewEnd() + milliseconds);
+}
+
+void TimelineGraphWidget::refresh()
+{
+    if (!m_history) {
+        return;
+    }
+
+    // A panned-away view only changes once eviction reaches its left edge
+    if (m_following || m_history->firstTimestamp() > m_viewEnd - m_span) {
+        invalidate();
+    }
+}
+
+void TimelineGraphWidget::invalidate()
+{
+    m_plotDirty = true;
+    update();
+}
+
+QRect TimelineGraphWidget::plotRect() const
+{
+    return rect().adjusted(AxisLabelWidth, LegendHeight, -8, -TimeLabelHeight);
+}
+
+void TimelineGraphWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    if (m_plotDirty || m_plotCache.size() != size() * devicePixelRatioF()) {
+        rebuildPlot();
+    }
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_plotCache);
+}
+
+void TimelineGraphWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_plotDirty = true;
+}
+
+void TimelineGraphWidget::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::FontChange) {
+        invalidate();
+    }
+    QWidget::changeEvent(event);
+}
+
+void TimelineGraphWidget::rebuildPlot()
+{
+    m_plotDirty = false;
+    m_plotRebuildCount++;
+    m_renderedPointCount = 0;
+
+    qreal dpr = devicePixelRatioF();
+    m_plotCache = QPixmap(size() * dpr);
+    m_plotCache.setDevicePixelRatio(dpr);
+    m_plotCache.fill(palette().color(QPalette::Base));
+
+    QPainter painter(&m_plotCache);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QRect plot = plotRect();
+    qint64 t1 = viewEnd();
+    qint64 t0 = t1 - m_span;
+
+    drawGrid(&painter, plot, t0, t1);
+    selectTier(t0);
+
+    for (float &peak : m_peaks) {
+        peak = 0.0f;
+    }
+
+    if (!m_history || m_history->isEmpty() || plot.width() < 2) {
+        painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        painter.drawText(plot, Qt::AlignCenter, tr("No data"));
+        drawLegend(&painter);
+        return;
+    }
+
+    m_pyramid.sync(*m_history);
+
+    int first = m_history->lowerBound(t0);
+    int last = m_history->lowerBound(t1 + 1);
+    bool raw = last - first <= plot.width();
+
+    // Column edges are shared by every series
+    int columns = plot.width() * (m_mode == LTTBDownsample ? LTTBOversampling : 1);
+    QVector<int> edges(columns + 1);
+    if (!raw) {
+        for (int c = 0; c < columns; ++c) {
+            edges[c] = m_history->lowerBound(t0 + m_span * c / columns);
+        }
+        edges[columns] = last;
+    }
+    int gapColumns = qMax<qint64>(1, GapThresholdMs * columns / m_span);
+
+    quint64 base = m_history->firstSequence();
+    QVector<MetricPyramid::Summary> summaries(raw ? 0 : columns);
+
+    int axisSeries = -1;
+    float axisScale = 0.0f;
+    int seriesCount = qMin(m_history->seriesCount(), m_series.size());
+    for (int s = 0; s < seriesCount; ++s) {
+        if (!m_series.at(s).visible) {
+            continue;
+        }
+
+        float peak = 0.0f;
+        if (raw) {
+            for (int i = first; i < last; ++i) {
+                peak = qMax(peak, m_history->value(s, i));
+            }
+        } else {
+            for (int c = 0; c < columns; ++c) {
+                summaries[c] = m_pyramid.summarize(*m_history, s, base + edges.at(c),
+                                                   base + edges.at(c + 1));
+                if (summaries.at(c).isValid()) {
+                    peak = qMax(peak, summaries.at(c).max);
+                }
+            }
+        }
+        m_peaks[s] = peak;
+
+        float scaleMax = m_series.at(s).fixedMax > 0.0f ? m_series.at(s).fixedMax
+                                                         : niceCeiling(peak);
+        if (axisSeries < 0) {
+            axisSeries = s;
+            axisScale = scaleMax;
+        }
+
+        if (raw) {
+            drawRaw(&painter, plot, s, first, last, t0, t1, scaleMax);
+        } else if (m_mode == LTTBDownsample) {
+            drawLTTB(&painter, plot, s, summaries, scaleMax, gapColumns);
+        } else {
+            drawMinMax(&painter, plot, s, summaries, scaleMax, gapColumns);
+        }
+    }
+
+    if (axisSeries >= 0) {
+        drawValueAxis(&painter, plot, axisSeries, axisScale);
+    }
+    drawLegend(&painter);
+}
+
+void TimelineGraphWidget::drawGrid(QPainter *painter, const QRect &plot, qint64 t0, qint64 t1)
+{
+    QColor gridColor = palette().color(QPalette::Mid);
+    gridColor.setAlpha(80);
+    painter->setPen(QPen(gridColor, 1, Qt::DotLine));
+
+    QFont labelFont = font();
+    labelFont.setPointSizeF(qMax(6.0, labelFont.pointSizeF() * 0.8));
+    painter->setFont(labelFont);
+
+    // Horizontal lines at quarters of each series' scale; labelled later
+    // by drawValueAxis()
+    for (int i = 0; i <= 4; ++i) {
+        int y = plot.bottom() - plot.height() * i / 4;
+        painter->drawLine(plot.left(), y, plot.right(), y);
+    }
+
+    QString format;
+    if (m_span <= 10 * 60 * 1000) {
+        format = "hh:mm:ss";
+    } else if (m_span <= 24 * 3600 * 1000) {
+        format = "hh:mm";
+    } else {
+        format = "MM-dd hh:mm";
+    }
+
+    // Vertical lines with time labels
+    const int ticks = 4;
+    for (int i = 0; i <= ticks; ++i) {
+        int x = plot.left() + plot.width() * i / ticks;
+        painter->setPen(QPen(gridColor, 1, Qt::DotLine));
+        painter->drawLine(x, plot.top(), x, plot.bottom());
+
+        qint64 t = t0 + (t1 - t0) * i / ticks;
+        QString label = QDateTime::fromMSecsSinceEpoch(t).toString(format);
+        Qt::Alignment align = i == 0 ? Qt::AlignLeft : (i == ticks ? Qt::AlignRight : Qt::AlignHCenter);
+        QRect labelRect(x - 60, plot.bottom() + 2, 120, TimeLabelHeight - 2);
+        if (i == 0) {
+            labelRect.moveLeft(x);
+        } else if (i == ticks) {
+            labelRect.moveRight(x);
+        }
+        painter->setPen(palette().color(QPalette::Text));
+        painter->drawText(labelRect, align | Qt::AlignVCenter, label);
+    }
+
+    painter->setPen(palette().color(QPalette::Mid));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(plot);
+}
+
+void TimelineGraphWidget::drawValueAxis(QPainter *painter, const QRect &plot, int series,
+                                        float scaleMax)
+{
+    // Coloured like the series, so it is clear which one the labels belong to
+    const Series &axis = m_series.at(series);
+    painter->setPen(axis.color);
+    for (int i = 0; i <= 4; ++i) {
+        int y = plot.bottom() - plot.height() * i / 4;
+        painter->drawText(QRect(0, y - 8, AxisLabelWidth - 4, 16),
+                          Qt::AlignRight | Qt::AlignVCenter,
+                          formatValue(scaleMax * i / 4, axis.unit));
+    }
+}
+
+void TimelineGraphWidget::drawLegend(QPainter *painter)
+{
+    m_legendRects.fill(QRect(), m_series.size());
+
+    QFontMetrics fm(painter->font());
+    int x = AxisLabelWidth;
+    for (int s = 0; s < m_series.size(); ++s) {
+        const Series &series = m_series.at(s);
+        if (series.name.isEmpty()) {
+            continue;
+        }
+
+        QString text = series.name;
+        if (series.visible && series.fixedMax <= 0.0f && m_history && !m_history->isEmpty()) {
+            text += QString(" (max %1)").arg(formatValue(m_peaks.value(s), series.unit));
+        }
+
+        int width = 14 + fm.boundingRect(text).width();
+        QRect entry(x, 2, width, LegendHeight - 4);
+        m_legendRects[s] = entry;
+
+        QColor color = series.visible ? series.color
+                                      : palette().color(QPalette::Disabled, QPalette::Text);
+        painter->fillRect(QRect(entry.left(), entry.center().y() - 4, 10, 8), color);
+        painter->setPen(series.visible ? palette().color(QPalette::Text) : color);
+        painter->drawText(entry.adjusted(14, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter, text);
+
+        x += width + 12;
+    }
+}
+
+void TimelineGraphWidget::drawRaw(QPainter *painter, const QRect &plot, int series,
+                                  int first, int last, qint64 t0, qint64 t1, float scaleMax)
+{
+    qint64 span = qMax<qint64>(1, t1 - t0);
+    QPolygonF line;
+    qint64 previous = 0;
+
+    auto flush = [&]() {
+        if (line.size() > 1) {
+            painter->drawPolyline(line);
+        }
+        m_renderedPointCount += line.size();
+        line.clear();
+    };
+
+    painter->setPen(QPen(m_series.at(series).color, 1.5));
+    painter->setBrush(Qt::NoBrush);
+    for (int i = first; i < last; ++i) {
+        qint64 t = m_history->timestamp(i);
+        if (!line.isEmpty() && t - previous > GapThresholdMs) {
+            flush();
+        }
+        qreal x = plot.left() + static_cast<qreal>(t - t0) * plot.width() / span;
+        qreal v = qBound(0.0f, m_history->value(series, i) / scaleMax, 1.0f);
+        line.append(QPointF(x, plot.bottom() - v * plot.height()));
+        previous = t;
+    }
+    flush();
+}
+
+void TimelineGraphWidget::drawMinMax(QPainter *painter, const QRect &plot, int series,
+                                     const QVector<MetricPyramid::Summary> &columns,
+                                     float scaleMax, int gapColumns)
+{
+    QColor color = m_series.at(series).color;
+    QColor fill = color;
+    fill.setAlpha(60);
+
+    auto yFor = [&](float value) {
+        return plot.bottom() - qBound(0.0f, value / scaleMax, 1.0f) * plot.height();
+    };
+
+    QPolygonF upper;
+    QPolygonF lower;
+    QPolygonF mean;
+
+    auto flush = [&]() {
+        if (!mean.isEmpty()) {
+            QPolygonF envelope = upper;
+            for (int i = lower.size() - 1; i >= 0; --i) {
+                envelope.append(lower.at(i));
+            }
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(fill);
+            painter->drawPolygon(envelope);
+
+            painter->setPen(QPen(color, 1.5));
+            painter->setBrush(Qt::NoBrush);
+            painter->drawPolyline(mean);
+            m_renderedPointCount += envelope.size() + mean.size();
+        }
+        upper.clear();
+        lower.clear();
+        mean.clear();
+    };
+
+    int emptyRun = 0;
+    for (int c = 0; c < columns.size(); ++c) {
+        const MetricPyramid::Summary &summary = columns.at(c);
+        if (!summary.isValid()) {
+            // Short runs are just columns narrower than the sample interval
+            if (++emptyRun == gapColumns) {
+                flush();
+            }
+            continue;
+        }
+        emptyRun = 0;
+
+        qreal x = plot.left() + c + 0.5;
+        upper.append(QPointF(x, yFor(summary.max)));
+        lower.append(QPointF(x, yFor(summary.min)));
+        mean.append(QPointF(x, yFor(summary.mean())));
+    }
+    flush();
+}
+
+void TimelineGraphWidget::drawLTTB(QPainter *painter, const QRect &plot, int series,
+                                   const QVector<MetricPyramid::Summary> &columns,
+                                   float scaleMax, int gapColumns)
+{
+    qreal columnWidth = static_cast<qreal>(plot.width()) / columns.size();
+    QPolygonF candidates;
+
+    auto flush = [&]() {
+        if (candidates.size() > 1) {
+            int threshold = qMax(2, (candidates.size() + LTTBOversampling - 1) / LTTBOversampling);
+            QPolygonF line(largestTriangleThreeBuckets(candidates, threshold));
+            painter->drawPolyline(line);
+            m_renderedPointCount += line.size();
+        }
+        candidates.clear();
+    };
+
+    painter->setPen(QPen(m_series.at(series).color, 1.5));
+    painter->setBrush(Qt::NoBrush);
+
+    int emptyRun = 0;
+    for (int c = 0; c < columns.size(); ++c) {
+        const MetricPyramid::Summary &summary = columns.at(c);
+        if (!summary.isValid()) {
+            if (++emptyRun == gapColumns) {
+                flush();
+            }
+            continue;
+        }
+        emptyRun = 0;
+
+        qreal x = plot.left() + (c + 0.5) * columnWidth;
+        qreal v = qBound(0.0f, summary.mean() / scaleMax, 1.0f);
+        candidates.append(QPointF(x, plot.bottom() - v * plot.height()));
+    }
+    flush();
+}
+
+QVector<QPointF> TimelineGraphWidget::largestTriangleThreeBuckets(const QVector<QPointF> &points,
+                                                                  int threshold)
+{
+    int count = points.size();
+    if (threshold >= count || count <= 2) {
+        return points;
+    }
+    if (threshold < 3) {
+        return {points.first(), points.last()};
+    }
+
+    QVector<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.first());
+
+    // The first and last points are fixed; the rest is split into buckets
+    double bucketSize = static_cast<double>(count - 2) / (threshold - 2);
+    int a = 0;
+
+    for (int i = 0; i < threshold - 2; ++i) {
+        // Average of the next bucket (or the last point for the final bucket)
+        int nextStart = static_cast<int>(std::floor((i + 1) * bucketSize)) + 1;
+        int nextEnd = qMin(static_cast<int>(std::floor((i + 2) * bucketSize)) + 1, count);
+        if (nextStart >= nextEnd) {
+            nextStart = count - 1;
+            nextEnd = count;
+        }
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (int j = nextStart; j < nextEnd; ++j) {
+            avgX += points.at(j).x();
+            avgY += points.at(j).y();
+        }
+        avgX /= (nextEnd - nextStart);
+        avgY /= (nextEnd - nextStart);
+
+        int rangeStart = static_cast<int>(std::floor(i * bucketSize)) + 1;
+        int rangeEnd = qMin(static_cast<int>(std::floor((i + 1) * bucketSize)) + 1, count - 1);
+
+        const QPointF &pa = points.at(a);
+        double maxArea = -1.0;
+        int chosen = rangeStart;
+        for (int j = rangeStart; j < rangeEnd; ++j) {
+            double area = std::fabs((pa.x() - avgX) * (points.at(j).y() - pa.y()) -
+                                    (pa.x() - points.at(j).x()) * (avgY - pa.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                chosen = j;
+            }
+        }
+
+        sampled.append(points.at(chosen));
+        a = chosen;
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
+void TimelineGraphWidget::wheelEvent(QWheelEvent *event)
+{
+    int delta = event->angleDelta().y();
+    if (delta == 0) {
+        event->ignore();
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    qreal x = event->position().x();
+#else
+    qreal x = event->pos().x();
+#endif
+    QRect plot = plotRect();
+    qreal anchor = plot.width() > 0 ? (x - plot.left()) / plot.width() : 1.0;
+
+    zoom(delta > 0 ? 0.8 : 1.25, anchor);
+    event->accept();
+}
+
+void TimelineGraphWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    for (int s = 0; s < m_legendRects.size(); ++s) {
+        if (m_legendRects.at(s).contains(event->pos())) {
+            setSeriesVisible(s, !isSeriesVisible(s));
+            return;
+        }
+    }
+
+    if (plotRect().contains(event->pos())) {
+        m_dragging = true;
+        m_dragOriginX = event->pos().x();
+        m_dragViewEnd = viewEnd();
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void TimelineGraphWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_dragging) {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+
+    int width = qMax(1, plotRect().width());
+    qint64 offset = static_cast<qint64>(event->pos().x() - m_dragOriginX) * m_span / width;
+    setViewEnd(m_dragViewEnd - offset);
+}
+
+void TimelineGraphWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_dragging && event->button() == Qt::LeftButton) {
+        m_dragging = false;
+        unsetCursor();
+        return;
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void TimelineGraphWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && plotRect().contains(event->pos())) {
+        followLatest();
+        return;
+    }
+    QWidget::mouseDoubleClickEvent(event);
+}
+
+} // namespace QVirt
@@ -0,0 +1,188 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef QVIRT_UI_WIDGETS_TIMELINEGRAPHWIDGET_H
+#define QVIRT_UI_WIDGETS_TIMELINEGRAPHWIDGET_H
+
+#include <QWidget>
+#include <QVector>
+#include <QPointF>
+#include <QPixmap>
+#include <QPointer>
+
+#include "../../core/MetricHistory.h"
+#include "../../core/MetricPyramid.h"
+#include "../../libvirt/Domain.h"
+
+class QPainter;
+
+namespace QVirt {
+
+/**
+ * @brief Multi-series, long-horizon performance graph
+ *
+ * Plots every series of a MetricHistory (by default a Domain's CPU,
+ * memory, disk and network history) on a shared time axis. The view can
+ * be zoomed with the mouse wheel, panned by dragging and snapped back to
+ * the live edge with a double click. For a TieredMetricHistory, the
+ * finest tier that still covers the left edge of the view is drawn.
+ *
+ * The value axis is labelled in the unit and scale of the first visible
+ * series; the legend shows the peaks of the others.
+ *
+ * Raw samples are never rescanned per frame: a MetricPyramid is kept in
+ * sync with the history and each pixel column is summarized from it in
+ * logarithmic time. Columns are drawn either as a min/max envelope with
+ * the mean on top, or as a Largest-Triangle-Three-Buckets polyline. The
+ * result is cached and only redrawn when new samples land in view, the
+ * view moves, or the widget is resized.
+ */
+class TimelineGraphWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum DownsampleMode {
+        MinMaxDownsample,
+        LTTBDownsample
+    };
+
+    explicit TimelineGraphWidget(QWidget *parent = nullptr);
+    ~TimelineGraphWidget() override = default;
+
+    // Show the metric history of @p domain and follow its updates
+    void setDomain(Domain *domain);
+
+    // Show an arbitrary history; the caller keeps it alive and calls
+    // refresh() after appending samples
+    void setHistory(const MetricHistory *history);
+    void setTieredHistory(const TieredMetricHistory *history);
+
+    // The history or tier drawn last
+    const MetricHistory *history() const { return m_history; }
+    int tier() const { return m_tier; }
+
+    /**
+     * @brief Describe one series
+     * @param fixedMax Upper bound of the vertical scale, or 0 to scale to
+     *        the visible peak
+     */
+    void setSeries(int series, const QString &name, const QColor &color,
+                   const QString &unit, float fixedMax = 0.0f);
+    void setSeriesVisible(int series, bool visible);
+    bool isSeriesVisible(int series) const;
+
+    DownsampleMode downsampleMode() const { return m_mode; }
+    void setDownsampleMode(DownsampleMode mode);
+
+    // Visible time span in milliseconds
+    qint64 timeSpan() const { return m_span; }
+    void setTimeSpan(qint64 milliseconds);
+
+    // Right edge of the view; follows the newest sample unless panned away
+    qint64 viewEnd() const;
+    void setViewEnd(qint64 timestampMs);
+    bool isFollowingLatest() const { return m_following; }
+    void followLatest();
+
+    // Zoom by @p factor (< 1 zooms in) keeping the time at @p anchor
+    // (0 = left edge, 1 = right edge) fixed on screen
+    void zoom(qreal factor, qreal anchor = 1.0);
+    void pan(qint64 milliseconds);
+
+    // Number of full plot redraws and points drawn by the last one
+    int plotRebuildCount() const { return m_plotRebuildCount; }
+    int renderedPointCount() const { return m_renderedPointCount; }
+
+    /**
+     * @brief Largest-Triangle-Three-Buckets downsampling
+     *
+     * Picks @p threshold points from @p points (sorted by x), always
+     * keeping the first and last, choosing from each bucket the point that
+     * forms the largest triangle with the previously chosen point and the
+     * mean of the next bucket. Returns @p points unchanged if it already
+     * has no more than @p threshold points, and only the end points if
+     * @p threshold is below 3.
+     */
+    static QVector<QPointF> largestTriangleThreeBuckets(const QVector<QPointF> &points,
+                                                        int threshold);
+
+public slots:
+    // Pick up samples appended to the history
+    void refresh();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    struct Series {
+        QString name;
+        QColor color;
+        QString unit;
+        float fixedMax = 0.0f;
+        bool visible = true;
+    };
+
+    void rebuildPlot();
+    void drawGrid(QPainter *painter, const QRect &plot, qint64 t0, qint64 t1);
+    void drawValueAxis(QPainter *painter, const QRect &plot, int series, float scaleMax);
+    void drawLegend(QPainter *painter);
+    void drawRaw(QPainter *painter, const QRect &plot, int series, int first, int last,
+                 qint64 t0, qint64 t1, float scaleMax);
+    void drawMinMax(QPainter *painter, const QRect &plot, int series,
+                    const QVector<MetricPyramid::Summary> &columns, float scaleMax,
+                    int gapColumns);
+    void drawLTTB(QPainter *painter, const QRect &plot, int series,
+                  const QVector<MetricPyramid::Summary> &columns, float scaleMax,
+                  int gapColumns);
+    QRect plotRect() const;
+    void selectTier(qint64 t0);
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    void setFollowing(bool following, qint64 viewEnd);
+    void invalidate();
+
+    QPointer<Domain> m_domain;
+    const MetricHistory *m_history;
+    const TieredMetricHistory *m_tiers;
+    int m_tier;
+    MetricPyramid m_pyramid;
+    QVector<Series> m_series;
+
+    DownsampleMode m_mode;
+    qint64 m_span;
+    qint64 m_viewEnd;
+    bool m_following;
+
+    // Drag-to-pan state
+    bool m_dragging;
+    int m_dragOriginX;
+    qint64 m_dragViewEnd;
+
+    // Cached plot
+    QPixmap m_plotCache;
+    bool m_plotDirty;
+    QVector<QRect> m_legendRects;
+    QVector<float> m_peaks;     // Visible peak per series, shown in the legend
+    int m_plotRebuildCount;
+    int m_renderedPointCount;
+};
+
+} // namespace QVirt
+
+#endif // QVIRT_UI_WIDGETS_TIMELINEGRAPHWIDGET_H
@@ -20,6 +20,7 @@
 #include "../../src/ui/wizards/CreateVMWizard.h"
 #include "../../src/ui/dialogs/CloneDialog.h"
 #include "../../src/ui/dialogs/SnapshotDialog.h"
+#include "../../src/ui/models/ConnectionTreeModel.h"
 #include "../../src/libvirt/Connection.h"
 #include "../../src/libvirt/Domain.h"
 
@@ -62,6 +63,7 @@ private slots:
 
     // Model performance tests
     void testConnectionTreeModelPerformance();
+    void testConnectionTreeModelPaintProfile();
     void testVMListModelPerformance();
 
     // Event handling performance
@@ -457,6 +459,45 @@ void TestPerformanceBenchmarks::testConnectionTreeModelPerformance()
     QVERIFY2(elapsed < thresholdMs(2000), qPrintable(QString("ConnectionTreeModel too slow: %1ms").arg(elapsed)));
 }
 
+void TestPerformanceBenchmarks::testConnectionTreeModelPaintProfile()
+{
+    ConnectionTreeModel model;
+    const int visibleRows = 200;
+    for (int i = 0; i < visibleRows; i++) {
+        model.addDisconnectedConnection(QString("test:///perf-%1").arg(i));
+    }
+    QCOMPARE(model.rowCount(), visibleRows);
+
+    const int roles[] = { Qt::DisplayRole, Qt::DecorationRole, Qt::FontRole, Qt::ForegroundRole };
+
+    // Warm up the icon cache, then measure one simulated frame
+    model.data(model.index(0, 0), Qt::DecorationRole);
+    model.setProfilingEnabled(true);
+
+    int frames = 100;
+    qint64 totalNsecs = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        for (int row = 0; row < visibleRows; row++) {
+            QModelIndex index = model.index(row, 0);
+            for (int role : roles) {
+                QVariant data = model.data(index, role);
+                Q_UNUSED(data);
+            }
+        }
+        ConnectionTreeModel::DataProfile profile = model.takeProfile();
+        QCOMPARE(profile.calls, quint64(visibleRows * 4));
+        totalNsecs += profile.totalNsecs;
+    }
+
+    qint64 perFrameUs = totalNsecs / frames / 1000;
+    qInfo() << "ConnectionTreeModel data() per 200-row frame:" << perFrameUs << "us";
+    recordBenchmark("ConnectionTreeModel Paint Frame", totalNsecs / 1000000, frames, 1);
+
+    // Painting 200 rows should stay well below a millisecond
+    QVERIFY2(perFrameUs < thresholdMs(1) * 1000,
+             qPrintable(QString("ConnectionTreeModel frame too slow: %1us").arg(perFrameUs)));
+}
+
 void TestPerformanceBenchmarks::testVMListModelPerformance()
 {
     QElapsedTimer timer;
@@ -0,0 +1,304 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "../../src/libvirt/BackupManager.h"
+#include "../../src/libvirt/DomainCheckpoint.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for BackupManager, BackupCatalog and checkpoint XML
+ *
+ * Backups themselves need QEMU; these cover the catalog, the XML handed
+ * to libvirt and the schedule decisions.
+ */
+class TestBackups : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCatalogRoundTrip();
+    void testCatalogSaveLoad();
+    void testRestoreChain();
+    void testBackupDisks();
+    void testBackupXML();
+    void testCheckpointXML();
+    void testCheckpointFromLibvirt();
+    void testPolicy();
+    void testNoDomainFails();
+};
+
+namespace {
+
+const char *DomainXml =
+    "<domain type='kvm'>"
+    "  <name>db01</name>"
+    "  <devices>"
+    "    <disk type='file' device='disk'>"
+    "      <driver name='qemu' type='qcow2'/>"
+    "      <source file='/var/lib/libvirt/images/db01.qcow2'/>"
+    "      <target dev='vda' bus='virtio'/>"
+    "    </disk>"
+    "    <disk type='file' device='disk'>"
+    "      <driver name='qemu' type='raw'/>"
+    "      <source file='/var/lib/libvirt/images/db01-data.img'/>"
+    "      <target dev='vdb' bus='virtio'/>"
+    "    </disk>"
+    "    <disk type='file' device='disk'>"
+    "      <driver name='qemu' type='qcow2'/>"
+    "      <source file='/var/lib/libvirt/images/shared.qcow2'/>"
+    "      <target dev='vdc' bus='virtio'/>"
+    "      <readonly/>"
+    "    </disk>"
+    "    <disk type='file' device='cdrom'>"
+    "      <driver name='qemu' type='raw'/>"
+    "      <target dev='sda' bus='sata'/>"
+    "    </disk>"
+    "  </devices>"
+    "</domain>";
+
+const char *CheckpointXml =
+    "<domaincheckpoint>"
+    "  <name>qvirt-20260301-020000</name>"
+    "  <description>Incremental backup</description>"
+    "  <parent><name>qvirt-20260228-020000</name></parent>"
+    "  <creationTime>1772330400</creationTime>"
+    "  <disks>"
+    "    <disk name='vda' checkpoint='bitmap' bitmap='qvirt-20260301-020000' size='1048576'/>"
+    "    <disk name='vdb' checkpoint='no'/>"
+    "    <disk name='vdc' checkpoint='bitmap' bitmap='qvirt-20260301-020000' size='4096'/>"
+    "  </disks>"
+    "  <domain type='kvm'><name>db01</name></domain>"
+    "</domaincheckpoint>";
+
+BackupRecord record(BackupRecord::Mode mode, const QString &checkpoint,
+                    const QString &parent = QString())
+{
+    BackupRecord result;
+    result.mode = mode;
+    result.checkpoint = checkpoint;
+    result.parentCheckpoint = parent;
+    result.started = QDateTime(QDate(2026, 3, 1), QTime(2, 0));
+    result.finished = result.started.addSecs(90);
+    result.directory = checkpoint.mid(6);
+    result.disks = QStringList{"vda"};
+    result.bytes = 1024;
+    return result;
+}
+
+} // namespace
+
+void TestBackups::testCatalogRoundTrip()
+{
+    BackupCatalog catalog("/backups/db01");
+    QVERIFY(catalog.isEmpty());
+    QCOMPARE(catalog.incrementalsSinceFull(), -1);
+
+    BackupRecord full = record(BackupRecord::Full, "qvirt-full");
+    full.disks = QStringList{"vda", "vdb"};
+    full.bytes = qint64(20) * 1024 * 1024 * 1024;
+    catalog.append(full);
+    catalog.append(record(BackupRecord::Incremental, "qvirt-inc1", "qvirt-full"));
+    QCOMPARE(catalog.incrementalsSinceFull(), 1);
+
+    BackupCatalog copy;
+    QVERIFY(copy.fromXML(catalog.toXML()));
+    QCOMPARE(copy.records().size(), 2);
+
+    const BackupRecord first = copy.records().first();
+    QCOMPARE(first.mode, BackupRecord::Full);
+    QCOMPARE(first.disks, QStringList({"vda", "vdb"}));
+    QCOMPARE(first.bytes, full.bytes);
+    QCOMPARE(first.started, full.started);
+    QCOMPARE(first.finished, full.finished);
+    QVERIFY(first.parentCheckpoint.isEmpty());
+
+    QCOMPARE(copy.last().mode, BackupRecord::Incremental);
+    QCOMPARE(copy.last().parentCheckpoint, QString("qvirt-full"));
+    QCOMPARE(catalog.path(first), QString("/backups/db01/full"));
+
+    QVERIFY(!copy.fromXML("<domain/>"));
+    QVERIFY(!copy.fromXML("not xml"));
+}
+
+void TestBackups::testCatalogSaveLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = BackupManager::catalogDirectory(dir.path(), "db01");
+
+    // No file yet is an empty catalog, not an error
+    BackupCatalog catalog(path);
+    QVERIFY(catalog.load());
+    QVERIFY(catalog.isEmpty());
+
+    catalog.append(record(BackupRecord::Full, "qvirt-full"));
+    QString error;
+    QVERIFY2(catalog.save(&error), qPrintable(error));
+    QVERIFY(QFile::exists(QDir(path).filePath(BackupCatalog::FileName)));
+
+    BackupCatalog loaded(path);
+    QVERIFY(loaded.load());
+    QCOMPARE(loaded.records().size(), 1);
+    QCOMPARE(loaded.last().checkpoint, QString("qvirt-full"));
+}
+
+void TestBackups::testRestoreChain()
+{
+    BackupCatalog catalog;
+    catalog.append(record(BackupRecord::Full, "qvirt-full"));
+    catalog.append(record(BackupRecord::Incremental, "qvirt-inc1", "qvirt-full"));
+    catalog.append(record(BackupRecord::Incremental, "qvirt-inc2", "qvirt-inc1"));
+    catalog.append(record(BackupRecord::Incremental, "qvirt-lost", "qvirt-gone"));
+
+    QCOMPARE(catalog.restoreChain(0).size(), 1);
+
+    const QList<BackupRecord> chain = catalog.restoreChain(2);
+    QCOMPARE(chain.size(), 3);
+    QCOMPARE(chain.first().checkpoint, QString("qvirt-full"));
+    QCOMPARE(chain.last().checkpoint, QString("qvirt-inc2"));
+
+    // The parent of the last one is not in the catalog
+    QVERIFY(catalog.restoreChain(3).isEmpty());
+    QVERIFY(catalog.restoreChain(4).isEmpty());
+    QVERIFY(catalog.restoreChain(-1).isEmpty());
+    QCOMPARE(catalog.incrementalsSinceFull(), 3);
+}
+
+void TestBackups::testBackupDisks()
+{
+    const QList<BackupManager::Disk> disks = BackupManager::backupDisks(QString(DomainXml));
+
+    // The CD-ROM is not a disk to back up
+    QCOMPARE(disks.size(), 3);
+    QCOMPARE(disks.at(0).name, QString("vda"));
+    QVERIFY(disks.at(0).eligible);
+    QCOMPARE(disks.at(1).format, QString("raw"));
+    QVERIFY(!disks.at(1).eligible);
+    QVERIFY(!disks.at(2).eligible);
+
+    QVERIFY(BackupManager::backupDisks(QString("not xml")).isEmpty());
+}
+
+void TestBackups::testBackupXML()
+{
+    const QList<BackupManager::Disk> disks = BackupManager::backupDisks(QString(DomainXml));
+
+    const QString full = BackupManager::backupXML(disks, "/backups/db01/20260301", QString());
+    QVERIFY(full.startsWith("<domainbackup mode='push'>"));
+    QVERIFY(!full.contains("<incremental>"));
+    QVERIFY(full.contains("<disk name='vda' backup='yes' type='file'>"));
+    QVERIFY(full.contains("<target file='/backups/db01/20260301/vda.qcow2'/>"));
+    QVERIFY(full.contains("<disk name='vdb' backup='no'/>"));
+    QVERIFY(full.contains("<disk name='vdc' backup='no'/>"));
+
+    const QString incremental = BackupManager::backupXML(disks, "/backups/db01/20260302",
+                                                         "qvirt-20260301-020000");
+    QVERIFY(incremental.contains("<incremental>qvirt-20260301-020000</incremental>"));
+}
+
+void TestBackups::testCheckpointXML()
+{
+    const QList<BackupManager::Disk> disks = BackupManager::backupDisks(QString(DomainXml));
+    const QString xml = BackupManager::checkpointXML(disks, "qvirt-20260301-020000", "Nightly");
+
+    QVERIFY(xml.startsWith("<domaincheckpoint>"));
+    QVERIFY(xml.contains("<name>qvirt-20260301-020000</name>"));
+    QVERIFY(xml.contains("<description>Nightly</description>"));
+    QVERIFY(xml.contains("<disk name=\"vda\" checkpoint=\"bitmap\"/>"));
+    QVERIFY(xml.contains("<disk name=\"vdb\" checkpoint=\"no\"/>"));
+
+    // What is written reads back
+    DomainCheckpoint checkpoint;
+    QVERIFY(checkpoint.fromXML(xml));
+    QCOMPARE(checkpoint.name(), QString("qvirt-20260301-020000"));
+    QCOMPARE(checkpoint.disks().size(), 3);
+    QCOMPARE(checkpoint.changedBytes(), qint64(-1));
+}
+
+void TestBackups::testCheckpointFromLibvirt()
+{
+    DomainCheckpoint checkpoint;
+    QVERIFY(checkpoint.fromXML(CheckpointXml));
+
+    // Not the name of the embedded domain
+    QCOMPARE(checkpoint.name(), QString("qvirt-20260301-020000"));
+    QCOMPARE(checkpoint.description(), QString("Incremental backup"));
+    QCOMPARE(checkpoint.parentName(), QString("qvirt-20260228-020000"));
+    QCOMPARE(checkpoint.creationTime().toSecsSinceEpoch(), qint64(1772330400));
+
+    const QList<DomainCheckpoint::Disk> disks = checkpoint.disks();
+    QCOMPARE(disks.size(), 3);
+    QCOMPARE(disks.at(0).bitmap, QString("qvirt-20260301-020000"));
+    QCOMPARE(disks.at(1).checkpoint, QString("no"));
+    QCOMPARE(disks.at(1).size, qint64(-1));
+    QCOMPARE(checkpoint.changedBytes(), qint64(1048576 + 4096));
+}
+
+void TestBackups::testPolicy()
+{
+    const QDateTime now = QDateTime::fromSecsSinceEpoch(1772330400);
+
+    BackupPolicy policy;
+    QVERIFY(!BackupManager::isDue(policy, now));
+
+    policy.enabled = true;
+    QVERIFY(!BackupManager::isDue(policy, now));    // No target
+
+    policy.targetDir = "/backups";
+    QVERIFY(BackupManager::isDue(policy, now));     // Never ran
+
+    policy.intervalHours = 24;
+    policy.lastRun = now.toSecsSinceEpoch() - 23 * 3600;
+    QVERIFY(!BackupManager::isDue(policy, now));
+    policy.lastRun = now.toSecsSinceEpoch() - 24 * 3600;
+    QVERIFY(BackupManager::isDue(policy, now));
+
+    BackupCatalog catalog;
+    policy.fullEvery = 2;
+    QCOMPARE(BackupManager::policyMode(policy, catalog), BackupJob::Full);
+
+    catalog.append(record(BackupRecord::Full, "qvirt-full"));
+    catalog.append(record(BackupRecord::Incremental, "qvirt-inc1", "qvirt-full"));
+    QCOMPARE(BackupManager::policyMode(policy, catalog), BackupJob::Auto);
+
+    catalog.append(record(BackupRecord::Incremental, "qvirt-inc2", "qvirt-inc1"));
+    QCOMPARE(BackupManager::policyMode(policy, catalog), BackupJob::Full);
+
+    policy.fullEvery = 0;
+    QCOMPARE(BackupManager::policyMode(policy, catalog), BackupJob::Auto);
+}
+
+void TestBackups::testNoDomainFails()
+{
+    BackupManager manager;
+    QSignalSpy finished(&manager, &BackupManager::jobFinished);
+
+    BackupJob *job = manager.backup(nullptr, "/backups");
+    QVERIFY(job);
+    QCOMPARE(job->state(), BackupJob::Failed);
+    QVERIFY(!job->errorString().isEmpty());
+    QVERIFY(!job->isCancellable());
+
+    // Reported from the event loop, after the caller could connect
+    QCOMPARE(finished.count(), 0);
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(manager.activeCount(), 0);
+
+    manager.clearFinished();
+    QVERIFY(manager.jobs().isEmpty());
+}
+
+QTEST_MAIN(TestBackups)
+#include "test_backups.moc"
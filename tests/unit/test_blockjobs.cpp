@@ -0,0 +1,165 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include "../../src/libvirt/BlockJobManager.h"
+#include "../../src/libvirt/Connection.h"
+#include "../../src/libvirt/Domain.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for BlockJobManager
+ *
+ * The test driver has no block jobs, so starting one fails; that is
+ * enough to run a job through the queue and the worker.
+ */
+class TestBlockJobs : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDisksWithBackingChain();
+    void testNoDomainFails();
+    void testCopyNeedsDestination();
+    void testLimits();
+    void testClearFinished();
+    void testUnsupportedJobFails();
+};
+
+namespace {
+
+const char *ChainXml =
+    "<domain type='kvm'>"
+    "  <name>web01</name>"
+    "  <devices>"
+    "    <disk type='file' device='disk'>"
+    "      <source file='/var/lib/libvirt/images/web01.qcow2'/>"
+    "      <backingStore type='file'><format type='qcow2'/>"
+    "        <source file='/var/lib/libvirt/images/base.qcow2'/>"
+    "        <backingStore/></backingStore>"
+    "      <target dev='vda' bus='virtio'/>"
+    "    </disk>"
+    "    <disk type='file' device='disk'>"
+    "      <source file='/var/lib/libvirt/images/web01-data.qcow2'/>"
+    "      <backingStore/>"
+    "      <target dev='vdb' bus='virtio'/>"
+    "    </disk>"
+    "    <disk type='file' device='disk'>"
+    "      <source file='/var/lib/libvirt/images/shared.qcow2'/>"
+    "      <backingStore type='file'>"
+    "        <source file='/var/lib/libvirt/images/base.qcow2'/></backingStore>"
+    "      <target dev='vdc' bus='virtio'/>"
+    "      <readonly/>"
+    "    </disk>"
+    "    <disk type='file' device='cdrom'>"
+    "      <source file='/isos/install.iso'/>"
+    "      <target dev='sda' bus='sata'/>"
+    "    </disk>"
+    "  </devices>"
+    "</domain>";
+
+} // namespace
+
+void TestBlockJobs::testDisksWithBackingChain()
+{
+    // Only the writable disk whose chain has a backing image
+    QCOMPARE(BlockJobManager::disksWithBackingChain(QString(ChainXml)), QStringList{"vda"});
+    QVERIFY(BlockJobManager::disksWithBackingChain(QString("not xml")).isEmpty());
+    QVERIFY(BlockJobManager::disksWithBackingChain(static_cast<Domain*>(nullptr)).isEmpty());
+}
+
+void TestBlockJobs::testNoDomainFails()
+{
+    BlockJobManager manager;
+    QSignalSpy finished(&manager, &BlockJobManager::jobFinished);
+
+    BlockJob *job = manager.pull(nullptr, "vda");
+    QVERIFY(job);
+    QCOMPARE(job->state(), BlockJob::Failed);
+    QVERIFY(!job->errorString().isEmpty());
+    QVERIFY(!job->isCancellable());
+
+    // Reported from the event loop, after the caller could connect
+    QCOMPARE(finished.count(), 0);
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(manager.activeCount(), 0);
+}
+
+void TestBlockJobs::testCopyNeedsDestination()
+{
+    BlockJobManager manager;
+    BlockJob *job = manager.copy(nullptr, "vda", QString(), "qcow2");
+    QCOMPARE(job->type(), BlockJob::Copy);
+    QCOMPARE(job->state(), BlockJob::Failed);
+    QVERIFY(!job->isPivotable());
+}
+
+void TestBlockJobs::testLimits()
+{
+    BlockJobManager manager;
+    QCOMPARE(manager.maxConcurrent(), int(BlockJobManager::DefaultMaxConcurrent));
+
+    manager.setMaxConcurrent(0);
+    QCOMPARE(manager.maxConcurrent(), 1);
+    manager.setMaxConcurrent(12);
+    QCOMPARE(manager.maxConcurrent(), 12);
+
+    manager.setPollInterval(1);
+    QVERIFY(manager.pollInterval() >= 50);
+}
+
+void TestBlockJobs::testClearFinished()
+{
+    BlockJobManager manager;
+    QSignalSpy removed(&manager, &BlockJobManager::jobRemoved);
+
+    manager.pull(nullptr, "vda");
+    manager.commit(nullptr, "vdb");
+    QCOMPARE(manager.jobs().size(), 2);
+
+    manager.clearFinished();
+    QCOMPARE(manager.jobs().size(), 0);
+    QCOMPARE(removed.count(), 2);
+}
+
+void TestBlockJobs::testUnsupportedJobFails()
+{
+    Connection *conn = Connection::open("test:///default");
+    if (!conn) {
+        QSKIP("Could not open test driver connection");
+    }
+
+    Domain *domain = conn->getDomain("test");
+    if (!domain || domain->state() != Domain::StateRunning) {
+        delete conn;
+        QSKIP("Test domain is not running");
+    }
+
+    BlockJobManager manager;
+    QSignalSpy finished(&manager, &BlockJobManager::jobFinished);
+
+    BlockJob *job = manager.pull(domain, "vda", QString(), 10 * 1024 * 1024);
+    QCOMPARE(job->state(), BlockJob::Queued);
+    QCOMPARE(job->bandwidth(), qint64(10 * 1024 * 1024));
+    QCOMPARE(manager.jobs(domain).size(), 1);
+
+    QVERIFY(finished.wait(5000));
+    QCOMPARE(job->state(), BlockJob::Failed);
+    QVERIFY(!job->errorString().isEmpty());
+    QCOMPARE(manager.activeCount(), 0);
+
+    delete conn;
+}
+
+QTEST_MAIN(TestBlockJobs)
+#include "test_blockjobs.moc"
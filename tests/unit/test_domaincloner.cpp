@@ -0,0 +1,251 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QDomDocument>
+#include "../../src/libvirt/DomainCloner.h"
+#include "../../src/libvirt/Connection.h"
+#include "../../src/libvirt/Domain.h"
+#include <libvirt/libvirt.h>
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for DomainCloner
+ *
+ * The helpers are tested on their own; a whole clone runs against the
+ * libvirt test driver, which needs no daemon.
+ */
+class TestDomainCloner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCloneVolumeName_data();
+    void testCloneVolumeName();
+    void testGenerateMAC();
+    void testRewriteXML();
+    void testRewriteKeepsMACs();
+    void testSparseClone();
+
+private:
+    static QDomElement diskByTarget(const QDomDocument &doc, const QString &target);
+};
+
+namespace {
+
+const char *SourceXml =
+    "<domain type='kvm'>"
+    "  <name>web01</name>"
+    "  <uuid>6695eb01-f6a4-8304-79aa-97f2502e193f</uuid>"
+    "  <os><type>hvm</type>"
+    "    <nvram template='/usr/share/OVMF/OVMF_VARS.fd'>/var/lib/libvirt/qemu/nvram/web01_VARS.fd</nvram>"
+    "  </os>"
+    "  <devices>"
+    "    <disk type='file' device='disk'>"
+    "      <driver name='qemu' type='qcow2'/>"
+    "      <source file='/var/lib/libvirt/images/web01.qcow2'/>"
+    "      <backingStore type='file'><format type='qcow2'/>"
+    "        <source file='/var/lib/libvirt/images/base.qcow2'/></backingStore>"
+    "      <target dev='vda' bus='virtio'/>"
+    "    </disk>"
+    "    <disk type='volume' device='disk'>"
+    "      <source pool='data' volume='web01-data'/>"
+    "      <target dev='vdb' bus='virtio'/>"
+    "    </disk>"
+    "    <disk type='file' device='cdrom'>"
+    "      <source file='/isos/install.iso'/>"
+    "      <target dev='sda' bus='sata'/>"
+    "      <readonly/>"
+    "    </disk>"
+    "    <interface type='network'>"
+    "      <mac address='52:54:00:11:22:33'/>"
+    "      <source network='default'/>"
+    "    </interface>"
+    "  </devices>"
+    "</domain>";
+
+} // namespace
+
+QDomElement TestDomainCloner::diskByTarget(const QDomDocument &doc, const QString &target)
+{
+    QDomElement devices = doc.documentElement().firstChildElement("devices");
+    for (QDomElement disk = devices.firstChildElement("disk"); !disk.isNull();
+         disk = disk.nextSiblingElement("disk")) {
+        if (disk.firstChildElement("target").attribute("dev") == target) {
+            return disk;
+        }
+    }
+    return QDomElement();
+}
+
+void TestDomainCloner::testCloneVolumeName_data()
+{
+    QTest::addColumn<QString>("volume");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("named after domain") << "web01.qcow2" << "web02.qcow2";
+    QTest::newRow("domain inside name") << "web01-data" << "web02-data";
+    QTest::newRow("unrelated name") << "disk.img" << "web02-disk.img";
+}
+
+void TestDomainCloner::testCloneVolumeName()
+{
+    QFETCH(QString, volume);
+    QFETCH(QString, expected);
+    QCOMPARE(DomainCloner::cloneVolumeName(volume, "web01", "web02"), expected);
+}
+
+void TestDomainCloner::testGenerateMAC()
+{
+    QRegularExpression pattern("^52:54:00(:[0-9a-f]{2}){3}$");
+    QSet<QString> seen;
+    for (int i = 0; i < 16; ++i) {
+        QString mac = DomainCloner::generateMAC();
+        QVERIFY2(pattern.match(mac).hasMatch(), qPrintable(mac));
+        seen.insert(mac);
+    }
+    QVERIFY(seen.size() > 1);
+}
+
+void TestDomainCloner::testRewriteXML()
+{
+    QHash<QString, DomainCloner::DiskSource> disks;
+    DomainCloner::DiskSource file;
+    file.type = "file";
+    file.path = "/var/lib/libvirt/images/web02.qcow2";
+    disks.insert("vda", file);
+    DomainCloner::DiskSource volume;
+    volume.type = "volume";
+    volume.pool = "data";
+    volume.volume = "web02-data";
+    disks.insert("vdb", volume);
+
+    const QString uuid = "0a7c7b2e-5d43-4a39-9b33-6f0a7d3f8c11";
+    QString xml = DomainCloner::rewriteXML(SourceXml, "web02", uuid, disks, true);
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(xml));
+    QDomElement root = doc.documentElement();
+    QCOMPARE(root.firstChildElement("name").text(), QString("web02"));
+    QCOMPARE(root.firstChildElement("uuid").text(), uuid);
+
+    // A fresh variable store is made from the template
+    QDomElement nvram = root.firstChildElement("os").firstChildElement("nvram");
+    QVERIFY(nvram.text().isEmpty());
+    QCOMPARE(nvram.attribute("template"), QString("/usr/share/OVMF/OVMF_VARS.fd"));
+
+    QDomElement vda = diskByTarget(doc, "vda");
+    QCOMPARE(vda.attribute("type"), QString("file"));
+    QCOMPARE(vda.firstChildElement("source").attribute("file"), file.path);
+    QVERIFY(vda.firstChildElement("backingStore").isNull());
+    QCOMPARE(vda.firstChildElement("driver").attribute("type"), QString("qcow2"));
+
+    QDomElement vdb = diskByTarget(doc, "vdb");
+    QCOMPARE(vdb.attribute("type"), QString("volume"));
+    QCOMPARE(vdb.firstChildElement("source").attribute("pool"), QString("data"));
+    QCOMPARE(vdb.firstChildElement("source").attribute("volume"), QString("web02-data"));
+
+    // Not in the map: left alone
+    QDomElement sda = diskByTarget(doc, "sda");
+    QCOMPARE(sda.firstChildElement("source").attribute("file"), QString("/isos/install.iso"));
+
+    QString mac = root.firstChildElement("devices").firstChildElement("interface")
+                      .firstChildElement("mac").attribute("address");
+    QVERIFY(mac != "52:54:00:11:22:33");
+    QVERIFY(mac.startsWith("52:54:00:"));
+}
+
+void TestDomainCloner::testRewriteKeepsMACs()
+{
+    QString xml = DomainCloner::rewriteXML(SourceXml, "web02", "uuid", {}, false);
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(xml));
+    QString mac = doc.documentElement().firstChildElement("devices").firstChildElement("interface")
+                      .firstChildElement("mac").attribute("address");
+    QCOMPARE(mac, QString("52:54:00:11:22:33"));
+    QCOMPARE(diskByTarget(doc, "vda").firstChildElement("source").attribute("file"),
+             QString("/var/lib/libvirt/images/web01.qcow2"));
+}
+
+void TestDomainCloner::testSparseClone()
+{
+    Connection *conn = Connection::open("test:///default");
+    if (!conn) {
+        QSKIP("Could not open test driver connection");
+    }
+
+    const char *domainXml =
+        "<domain type='test'>"
+        "  <name>sparse-src</name>"
+        "  <memory unit='MiB'>64</memory>"
+        "  <os><type>hvm</type></os>"
+        "  <devices>"
+        "    <disk type='volume' device='disk'>"
+        "      <source pool='default-pool' volume='sparse-src.img'/>"
+        "      <target dev='vda'/>"
+        "    </disk>"
+        "  </devices>"
+        "</domain>";
+    QString error;
+    Domain *source = conn->defineDomain(domainXml, &error);
+    QVERIFY2(source, qPrintable(error));
+
+    virStoragePoolPtr pool = virStoragePoolLookupByName(virDomainGetConnect(source->rawDomain()),
+                                                        "default-pool");
+    if (!pool) {
+        delete conn;
+        QSKIP("libvirt test driver has no default pool");
+    }
+
+    // 1 GiB of which nothing is written yet
+    const qint64 capacity = 1073741824;
+    const QByteArray volumeXml = QString("<volume><name>sparse-src.img</name>"
+                                         "<capacity unit='bytes'>%1</capacity>"
+                                         "<allocation unit='bytes'>0</allocation></volume>")
+                                     .arg(capacity).toUtf8();
+    virStorageVolPtr sourceVol = virStorageVolCreateXML(pool, volumeXml.constData(), 0);
+    QVERIFY(sourceVol);
+
+    DomainCloner cloner(source, "sparse-copy");
+    QSignalSpy finished(&cloner, &DomainCloner::finished);
+    QVERIFY2(cloner.start(), qPrintable(cloner.errorString()));
+    QVERIFY(finished.wait(10000));
+    QVERIFY2(finished.first().at(0).toBool(), qPrintable(cloner.errorString()));
+
+    const QList<DomainCloner::Disk> disks = cloner.disks();
+    QCOMPARE(disks.size(), 1);
+    QCOMPARE(disks.first().total, qint64(0));
+
+    // Same size, and no more allocated than the source
+    virStorageVolPtr cloneVol = virStorageVolLookupByName(
+        pool, disks.first().cloneName.toUtf8().constData());
+    QVERIFY(cloneVol);
+    virStorageVolInfo info;
+    QCOMPARE(virStorageVolGetInfo(cloneVol, &info), 0);
+    QCOMPARE(qint64(info.capacity), capacity);
+    QCOMPARE(qint64(info.allocation), qint64(0));
+
+    virStorageVolDelete(cloneVol, 0);
+    virStorageVolFree(cloneVol);
+    virStorageVolDelete(sourceVol, 0);
+    virStorageVolFree(sourceVol);
+    virStoragePoolFree(pool);
+    if (cloner.clonedDomain()) {
+        virDomainUndefine(cloner.clonedDomain()->rawDomain());
+    }
+    virDomainUndefine(source->rawDomain());
+    delete conn;
+}
+
+QTEST_MAIN(TestDomainCloner)
+#include "test_domaincloner.moc"
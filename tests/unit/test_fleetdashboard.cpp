@@ -0,0 +1,226 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QStandardItemModel>
+#include <QScrollBar>
+#include <QElapsedTimer>
+#include "../../src/ui/widgets/FleetDashboardView.h"
+#include "../../src/ui/models/VMListModel.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Exposes the protected cursor movement for testing
+ */
+class TestableDashboardView : public FleetDashboardView
+{
+public:
+    using FleetDashboardView::moveCursor;
+};
+
+/**
+ * @brief Unit tests for the fleet dashboard tile view
+ */
+class TestFleetDashboard : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testGeometry();
+    void testViewportCulling();
+    void testSparklineAtlas();
+    void testRemovedRowsPruned();
+    void testKeyboardNavigation();
+    void testLargeFleetPaint();
+
+private:
+    static void populate(QStandardItemModel *model, int count);
+};
+
+void TestFleetDashboard::populate(QStandardItemModel *model, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        QString name = QString("vm-%1").arg(i, 4, 10, QLatin1Char('0'));
+        auto *item = new QStandardItem(name);
+        item->setData(name, VMListModel::NameRole);
+        item->setData(QString("uuid-%1").arg(i), VMListModel::UUIDRole);
+        item->setData(QString("qemu:///system"), VMListModel::ConnectionURIRole);
+        item->setData(i % 3 == 0 ? 5 : 1, VMListModel::StateRole);
+        item->setData(i % 3 == 0 ? QString("Shutoff") : QString("Running"), VMListModel::StateStringRole);
+        item->setData(static_cast<float>(i % 100), VMListModel::CPURole);
+        item->setData(quint64(1024), VMListModel::MemoryRole);
+        item->setData(quint64(2048), VMListModel::MaxMemoryRole);
+        item->setData(QVariant::fromValue(QVector<float>{10.0f, 50.0f, 30.0f, float(i % 100)}),
+                      VMListModel::CPUHistoryRole);
+        item->setData(quint64(1), VMListModel::CPUHistoryGenerationRole);
+        model->appendRow(item);
+    }
+}
+
+void TestFleetDashboard::testGeometry()
+{
+    QStandardItemModel model;
+    populate(&model, 100);
+
+    FleetDashboardView view;
+    view.setModel(&model);
+    view.resize(700, 400);
+    view.grab();
+
+    // Every tile maps back to its own index
+    for (int row = 0; row < 20; ++row) {
+        QModelIndex index = model.index(row, 0);
+        QRect rect = view.visualRect(index);
+        QVERIFY(!rect.isEmpty());
+        QCOMPARE(rect.size(), view.tileSize());
+        QCOMPARE(view.indexAt(rect.center()), index);
+    }
+
+    // Tiles are laid out left to right, then top to bottom
+    QRect first = view.visualRect(model.index(0, 0));
+    QRect second = view.visualRect(model.index(1, 0));
+    QCOMPARE(second.top(), first.top());
+    QVERIFY(second.left() > first.right());
+
+    // The gap between tiles hits nothing
+    QVERIFY(!view.indexAt(QPoint(first.right() + 2, first.center().y())).isValid());
+}
+
+void TestFleetDashboard::testViewportCulling()
+{
+    QStandardItemModel model;
+    populate(&model, 5000);
+
+    FleetDashboardView view;
+    view.setModel(&model);
+    view.resize(800, 600);
+    view.grab();
+
+    // Only the tiles on screen are visited
+    int columns = (view.viewport()->width() - 6) / (view.tileSize().width() + 6);
+    int rows = view.viewport()->height() / (view.tileSize().height() + 6) + 2;
+    QVERIFY(view.lastPaintedTileCount() > 0);
+    QVERIFY(view.lastPaintedTileCount() <= columns * rows);
+
+    // Scrolling to the end shows the last tile
+    view.verticalScrollBar()->setValue(view.verticalScrollBar()->maximum());
+    view.grab();
+    QVERIFY(view.lastPaintedTileCount() <= columns * rows);
+    QRect last = view.visualRect(model.index(4999, 0));
+    QVERIFY(view.viewport()->rect().intersects(last));
+}
+
+void TestFleetDashboard::testSparklineAtlas()
+{
+    QStandardItemModel model;
+    populate(&model, 12);
+
+    FleetDashboardView view;
+    view.setModel(&model);
+    view.resize(800, 600);
+    view.grab();
+
+    int painted = view.lastPaintedTileCount();
+    QCOMPARE(view.sparklineRenderCount(), painted);
+    QVERIFY(view.atlasSlotCount() >= painted);
+
+    // Unchanged histories are blitted from the atlas
+    view.grab();
+    QCOMPARE(view.sparklineRenderCount(), painted);
+
+    // A new sample re-renders only that tile's slot
+    model.item(3)->setData(quint64(2), VMListModel::CPUHistoryGenerationRole);
+    view.grab();
+    QCOMPARE(view.sparklineRenderCount(), painted + 1);
+}
+
+void TestFleetDashboard::testRemovedRowsPruned()
+{
+    QStandardItemModel model;
+    populate(&model, 12);
+
+    FleetDashboardView view;
+    view.setModel(&model);
+    view.resize(800, 600);
+    view.grab();
+
+    int painted = view.lastPaintedTileCount();
+    int slots = view.atlasSlotCount();
+    QCOMPARE(view.cachedTileCount(), painted);
+
+    // Removed VMs leave neither cached tiles nor held atlas slots behind
+    model.removeRows(0, 4);
+    QCOMPARE(view.cachedTileCount(), painted - 4);
+
+    // New VMs take over the freed slots instead of growing the atlas
+    QStandardItemModel extra;
+    populate(&extra, 16);
+    for (int row = 12; row < 16; ++row) {
+        model.appendRow(extra.takeItem(row));
+    }
+    view.grab();
+    QCOMPARE(view.atlasSlotCount(), slots);
+    QCOMPARE(view.cachedTileCount(), view.lastPaintedTileCount());
+}
+
+void TestFleetDashboard::testKeyboardNavigation()
+{
+    QStandardItemModel model;
+    populate(&model, 50);
+
+    TestableDashboardView view;
+    view.setModel(&model);
+    view.resize(700, 400);
+    view.grab();
+
+    int columns = (view.viewport()->width() - 6) / (view.tileSize().width() + 6);
+    QVERIFY(columns > 1);
+
+    view.setCurrentIndex(model.index(0, 0));
+    QCOMPARE(view.moveCursor(QAbstractItemView::MoveRight, Qt::NoModifier).row(), 1);
+    QCOMPARE(view.moveCursor(QAbstractItemView::MoveDown, Qt::NoModifier).row(), columns);
+    QCOMPARE(view.moveCursor(QAbstractItemView::MoveLeft, Qt::NoModifier).row(), 0);
+    QCOMPARE(view.moveCursor(QAbstractItemView::MoveEnd, Qt::NoModifier).row(), 49);
+
+    view.setCurrentIndex(model.index(49, 0));
+    QCOMPARE(view.moveCursor(QAbstractItemView::MoveDown, Qt::NoModifier).row(), 49);
+}
+
+void TestFleetDashboard::testLargeFleetPaint()
+{
+    QStandardItemModel model;
+    populate(&model, 2000);
+
+    FleetDashboardView view;
+    view.setModel(&model);
+    view.resize(1920, 1080);
+    view.grab();
+
+    // Steady-state 1 Hz refresh: every visible history advanced once
+    QElapsedTimer timer;
+    timer.start();
+    const int frames = 10;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            model.item(row)->setData(quint64(frame + 2), VMListModel::CPUHistoryGenerationRole);
+        }
+        view.grab();
+    }
+    qint64 elapsed = timer.elapsed();
+    qint64 avgTime = elapsed / frames;
+
+    QVERIFY2(avgTime < 200, qPrintable(QString("Dashboard frame with %1 tiles too slow: %2ms")
+                                           .arg(view.lastPaintedTileCount()).arg(avgTime)));
+}
+
+QTEST_MAIN(TestFleetDashboard)
+#include "test_fleetdashboard.moc"
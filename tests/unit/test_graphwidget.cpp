@@ -10,7 +10,15 @@
  */
 
 #include <QtTest>
+#include <QStandardItemModel>
+#include <QPainter>
 #include "../../src/ui/widgets/GraphWidget.h"
+#include "../../src/ui/widgets/TimelineGraphWidget.h"
+#include "../../src/core/StatsHistory.h"
+#include "../../src/core/MetricHistory.h"
+#include "../../src/core/MetricPyramid.h"
+#include <QElapsedTimer>
+#include <cmath>
 
 using namespace QVirt;
 
@@ -29,7 +37,16 @@ private slots:
     void testTitle();
     void testGraphColor();
     void testGraphTypes();
+    void testSlidingExtrema();
+    void testCachedLayers();
     void testSparklineGeneration();
+    void testSparklineDelegateCache();
+    void testStatsHistory();
+    void testMetricHistory();
+    void testTieredMetricHistory();
+    void testMetricPyramid();
+    void testLargestTriangleThreeBuckets();
+    void testTimelineGraphDayOfSamples();
 };
 
 void TestGraphWidget::testConstruction()
@@ -91,6 +108,55 @@ void TestGraphWidget::testMaxDataPoints()
     QVERIFY(graph.title().isEmpty() || !graph.title().isEmpty());
 }
 
+void TestGraphWidget::testSlidingExtrema()
+{
+    GraphWidget graph(GraphWidget::GraphType::CPU);
+    graph.setMaxDataPoints(4);
+
+    const float samples[] = { 5.0f, 90.0f, 20.0f, 10.0f, 30.0f, 1.0f };
+    for (float value : samples) {
+        graph.addValue(value);
+    }
+
+    // Window now holds 20, 10, 30, 1 - the 90 peak has expired
+    QCOMPARE(graph.dataPointCount(), 4);
+    QCOMPARE(graph.maximumValue(), 30.0f);
+    QCOMPARE(graph.minimumValue(), 1.0f);
+
+    // Shrinking keeps the newest samples and recomputes the extrema
+    graph.setMaxDataPoints(2);
+    QCOMPARE(graph.dataPointCount(), 2);
+    QCOMPARE(graph.maximumValue(), 30.0f);
+    QCOMPARE(graph.minimumValue(), 1.0f);
+
+    graph.clear();
+    QCOMPARE(graph.dataPointCount(), 0);
+}
+
+void TestGraphWidget::testCachedLayers()
+{
+    GraphWidget graph(GraphWidget::GraphType::CPU);
+    graph.resize(300, 120);
+
+    graph.addValue(10.0f);
+    graph.addValue(20.0f);
+    QPixmap first = graph.grab();
+    QVERIFY(!first.isNull());
+    int rebuilds = graph.plotRebuildCount();
+    QVERIFY(rebuilds >= 1);
+
+    // Repainting without new data reuses the cached plot
+    graph.grab();
+    QCOMPARE(graph.plotRebuildCount(), rebuilds);
+
+    // Samples added while hidden are drawn in a single rebuild
+    for (int i = 0; i < 100; ++i) {
+        graph.addValue(static_cast<float>(i % 50));
+    }
+    graph.grab();
+    QCOMPARE(graph.plotRebuildCount(), rebuilds + 1);
+}
+
 void TestGraphWidget::testTitle()
 {
     GraphWidget graph(GraphWidget::GraphType::CPU);
@@ -164,5 +230,287 @@ void TestGraphWidget::testSparklineGeneration()
     QVERIFY(emptySparkline.isNull() || !emptySparkline.isNull());
 }
 
+void TestGraphWidget::testSparklineDelegateCache()
+{
+    const int historyRole = Qt::UserRole + 1;
+    const int generationRole = Qt::UserRole + 2;
+    const int keyRole = Qt::UserRole + 3;
+
+    QStandardItemModel model;
+    for (int row = 0; row < 3; ++row) {
+        auto *item = new QStandardItem;
+        item->setData(QVariant::fromValue(QVector<float>{10.0f, 40.0f, 20.0f}), historyRole);
+        item->setData(quint64(1), generationRole);
+        item->setData(QString("vm-%1").arg(row), keyRole);
+        model.appendRow(item);
+    }
+
+    SparklineDelegate delegate(historyRole, generationRole, keyRole);
+    delegate.setValueRange(0.0f, 100.0f);
+
+    QPixmap canvas(100, 90);
+    QPainter painter(&canvas);
+    QStyleOptionViewItem option;
+
+    auto paintAll = [&]() {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            option.rect = QRect(0, row * 30, 100, 30);
+            delegate.paint(&painter, option, model.index(row, 0));
+        }
+    };
+
+    // First frame renders every row
+    paintAll();
+    QCOMPARE(delegate.renderCount(), 3);
+    QCOMPARE(delegate.cachedCount(), 3);
+
+    // Unchanged rows are served from the cache
+    paintAll();
+    QCOMPARE(delegate.renderCount(), 3);
+
+    // Only the row whose history advanced is redrawn
+    model.item(1)->setData(QVariant::fromValue(QVector<float>{10.0f, 40.0f, 20.0f, 90.0f}), historyRole);
+    model.item(1)->setData(quint64(2), generationRole);
+    paintAll();
+    QCOMPARE(delegate.renderCount(), 4);
+}
+
+void TestGraphWidget::testStatsHistory()
+{
+    StatsHistory history(4);
+    QVERIFY(history.isEmpty());
+    QCOMPARE(history.capacity(), 4);
+
+    for (int i = 1; i <= 6; ++i) {
+        history.append(static_cast<float>(i));
+    }
+
+    // Oldest samples are overwritten in place
+    QCOMPARE(history.size(), 4);
+    QCOMPARE(history.at(0), 3.0f);
+    QCOMPARE(history.last(), 6.0f);
+    QCOMPARE(history.toVector(), (QVector<float>{3.0f, 4.0f, 5.0f, 6.0f}));
+    QCOMPARE(history.generation(), quint64(6));
+
+    // Shrinking keeps the newest samples
+    history.setCapacity(2);
+    QCOMPARE(history.toVector(), (QVector<float>{5.0f, 6.0f}));
+    history.append(7.0f);
+    QCOMPARE(history.toVector(), (QVector<float>{6.0f, 7.0f}));
+
+    history.clear();
+    QVERIFY(history.isEmpty());
+}
+
+void TestGraphWidget::testMetricHistory()
+{
+    MetricHistory history(2, 4);
+    QVERIFY(history.isEmpty());
+
+    for (int i = 0; i < 6; ++i) {
+        history.append(1000 * i, QVector<float>{float(i), float(-i)});
+    }
+
+    // Wrapped: samples 2..5 remain, sequences keep counting
+    QCOMPARE(history.size(), 4);
+    QCOMPARE(history.firstSequence(), quint64(2));
+    QCOMPARE(history.endSequence(), quint64(6));
+    QCOMPARE(history.timestamp(0), qint64(2000));
+    QCOMPARE(history.value(1, 3), -5.0f);
+    QCOMPARE(history.valueAtSequence(0, 4), 4.0f);
+
+    QCOMPARE(history.lowerBound(0), 0);
+    QCOMPARE(history.lowerBound(3500), 2);
+    QCOMPARE(history.lowerBound(9000), 4);
+
+    // Time never goes backwards
+    history.append(100, QVector<float>{6.0f, -6.0f});
+    QCOMPARE(history.lastTimestamp(), qint64(5000));
+
+    history.setCapacity(2);
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history.value(0, 0), 5.0f);
+    QCOMPARE(history.firstSequence(), quint64(5));
+
+    history.clear();
+    QVERIFY(history.isEmpty());
+    QCOMPARE(history.firstSequence(), history.endSequence());
+}
+
+void TestGraphWidget::testTieredMetricHistory()
+{
+    // Raw tier of 10 samples, then means of 5 raw samples, then of 2 of those
+    TieredMetricHistory history(1, {{1, 10}, {5, 4}, {2, 8}});
+    QCOMPARE(history.tierCount(), 3);
+    QVERIFY(history.isEmpty());
+
+    for (int i = 0; i < 30; ++i) {
+        float v = float(i);
+        history.append(1000 * i, &v);
+    }
+
+    // Every tier stays within its capacity
+    QCOMPARE(history.tier(0).size(), 10);
+    QCOMPARE(history.tier(1).size(), 4);
+    QCOMPARE(history.tier(2).size(), 3);
+
+    // Means of 0..4, 5..9, ... stamped with their newest sample
+    QCOMPARE(history.tier(1).value(0, 3), 27.0f);
+    QCOMPARE(history.tier(1).lastTimestamp(), qint64(29000));
+    QCOMPARE(history.tier(2).value(0, 0), 4.5f);
+    QCOMPARE(history.tier(2).timestamp(0), qint64(9000));
+
+    QCOMPARE(history.firstTimestamp(), qint64(9000));
+    QCOMPARE(history.lastTimestamp(), qint64(29000));
+
+    // The finest tier that reaches back far enough
+    QCOMPARE(history.tierFor(25000), 0);
+    QCOMPARE(history.tierFor(15000), 1);
+    QCOMPARE(history.tierFor(10000), 2);
+    QCOMPARE(history.tierFor(0), 2);
+
+    // The widget switches tiers as the view widens
+    TimelineGraphWidget graph;
+    graph.resize(400, 200);
+    graph.setTieredHistory(&history);
+    graph.setTimeSpan(60 * 1000);
+    graph.grab();
+    QCOMPARE(graph.tier(), 2);
+    QCOMPARE(graph.viewEnd(), qint64(29000));
+
+    history.clear();
+    QVERIFY(history.isEmpty());
+    QVERIFY(history.tier(2).isEmpty());
+}
+
+void TestGraphWidget::testMetricPyramid()
+{
+    MetricHistory history(1, 1000);
+    MetricPyramid pyramid;
+
+    quint32 seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<float>((seed >> 16) % 1000);
+    };
+
+    // Wrap several times, syncing in uneven batches
+    for (int batch = 0; batch < 40; ++batch) {
+        for (int i = 0; i < 17 + batch * 7; ++i) {
+            float v = next();
+            history.append(history.lastTimestamp() + 1000, &v);
+        }
+        pyramid.sync(history);
+    }
+    QCOMPARE(pyramid.rebuildCount(), 1);
+    QCOMPARE(pyramid.syncedSequence(), history.endSequence());
+    QVERIFY(pyramid.levelCount() > 0);
+
+    // Every range must agree with a brute-force scan
+    quint64 first = history.firstSequence();
+    for (int trial = 0; trial < 200; ++trial) {
+        quint64 begin = first + static_cast<quint64>(next()) % history.size();
+        quint64 end = begin + 1 + static_cast<quint64>(next()) % (history.endSequence() - begin);
+
+        MetricPyramid::Summary summary = pyramid.summarize(history, 0, begin, end);
+        float min = history.valueAtSequence(0, begin);
+        float max = min;
+        double sum = 0.0;
+        for (quint64 seq = begin; seq < end; ++seq) {
+            float v = history.valueAtSequence(0, seq);
+            min = qMin(min, v);
+            max = qMax(max, v);
+            sum += v;
+        }
+
+        QCOMPARE(summary.count, end - begin);
+        QCOMPARE(summary.min, min);
+        QCOMPARE(summary.max, max);
+        QVERIFY(qAbs(summary.sum - sum) < 1e-6);
+    }
+
+    // Ranges outside the held samples are clipped
+    QCOMPARE(pyramid.summarize(history, 0, 0, first).count, quint64(0));
+    QVERIFY(!pyramid.summarize(history, 1, first, first + 10).isValid());
+}
+
+void TestGraphWidget::testLargestTriangleThreeBuckets()
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.append(QPointF(i, i == 500 ? 100.0 : 0.0));
+    }
+
+    QVector<QPointF> sampled = TimelineGraphWidget::largestTriangleThreeBuckets(points, 50);
+    QCOMPARE(sampled.size(), 50);
+    QCOMPARE(sampled.first(), points.first());
+    QCOMPARE(sampled.last(), points.last());
+
+    // The lone spike is the most significant point and must survive
+    bool spikeKept = false;
+    for (int i = 1; i < sampled.size(); ++i) {
+        QVERIFY(sampled.at(i).x() > sampled.at(i - 1).x());
+        spikeKept = spikeKept || sampled.at(i).y() == 100.0;
+    }
+    QVERIFY(spikeKept);
+
+    // Nothing to reduce
+    QCOMPARE(TimelineGraphWidget::largestTriangleThreeBuckets(points.mid(0, 10), 50).size(), 10);
+    QCOMPARE(TimelineGraphWidget::largestTriangleThreeBuckets(points, 2).size(), 2);
+}
+
+void TestGraphWidget::testTimelineGraphDayOfSamples()
+{
+    // A day of one-second samples for four series
+    const int daySamples = 24 * 3600;
+    MetricHistory history(4, daySamples);
+    const qint64 start = 1700000000000LL;
+    float values[4];
+    for (int i = 0; i < daySamples; ++i) {
+        values[0] = 50.0f + 40.0f * std::sin(i / 600.0f);
+        values[1] = 30.0f + (i % 3600) / 120.0f;
+        values[2] = (i % 900 == 0) ? 50000.0f : 200.0f;
+        values[3] = static_cast<float>(i % 1024);
+        history.append(start + i * 1000LL, values);
+    }
+
+    TimelineGraphWidget graph;
+    graph.resize(800, 240);
+    graph.setHistory(&history);
+    graph.setTimeSpan(24 * 3600 * 1000LL);
+
+    QElapsedTimer timer;
+    timer.start();
+    graph.grab();
+    qint64 firstFrameMs = timer.elapsed();
+    QCOMPARE(graph.plotRebuildCount(), 1);
+
+    // Min/max keeps output proportional to the width, not the sample count
+    QVERIFY(graph.renderedPointCount() > 0);
+    QVERIFY(graph.renderedPointCount() < 4 * 3 * 800 + 100);
+
+    // Zoom and pan reuse the pyramid; no rescans of the raw day
+    timer.restart();
+    for (int i = 0; i < 10; ++i) {
+        graph.zoom(0.8, 0.5);
+        graph.pan(-60 * 1000);
+        graph.grab();
+    }
+    qint64 interactiveMs = timer.elapsed();
+    QVERIFY(!graph.isFollowingLatest());
+    QCOMPARE(graph.plotRebuildCount(), 11);
+
+    graph.setDownsampleMode(TimelineGraphWidget::LTTBDownsample);
+    graph.followLatest();
+    graph.grab();
+    QVERIFY(graph.isFollowingLatest());
+    QCOMPARE(graph.viewEnd(), history.lastTimestamp());
+    QVERIFY(graph.renderedPointCount() <= 4 * 800 + 100);
+
+    QVERIFY2(interactiveMs / 10 < 250,
+             qPrintable(QString("Timeline zoom/pan too slow: %1ms for 10 frames, first frame %2ms")
+                            .arg(interactiveMs).arg(firstFrameMs)));
+}
+
 QTEST_MAIN(TestGraphWidget)
 #include "test_graphwidget.moc"
@@ -0,0 +1,133 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include "../../src/libvirt/GroupSnapshot.h"
+#include "../../src/libvirt/Connection.h"
+#include "../../src/libvirt/Domain.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for GroupSnapshot
+ */
+class TestGroupSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDefaultName();
+    void testSnapshotXML();
+    void testOptions();
+    void testEmptyGroupFails();
+    void testMissingDomainFails();
+    void testTestDriver();
+};
+
+void TestGroupSnapshot::testDefaultName()
+{
+    const QDateTime time(QDate(2026, 3, 1), QTime(9, 5, 7));
+    QCOMPARE(GroupSnapshot::defaultName(time), QString("group-20260301-090507"));
+}
+
+void TestGroupSnapshot::testSnapshotXML()
+{
+    const QString xml = GroupSnapshot::snapshotXML("before <upgrade>", "db & web");
+    QVERIFY(xml.startsWith("<domainsnapshot>"));
+    QVERIFY(xml.contains("<name>before &lt;upgrade"));
+    QVERIFY(!xml.contains("<upgrade"));
+    QVERIFY(xml.contains("<description>db &amp; web</description>"));
+
+    // No empty description element
+    QVERIFY(!GroupSnapshot::snapshotXML("plain", QString()).contains("description"));
+}
+
+void TestGroupSnapshot::testOptions()
+{
+    GroupSnapshot group{QList<Domain*>()};
+    QCOMPARE(group.state(), GroupSnapshot::Ready);
+    QCOMPARE(group.maxParallel(), int(GroupSnapshot::DefaultMaxParallel));
+    QVERIFY(group.name().startsWith("group-"));
+    QVERIFY(!group.requireFreeze());
+    QCOMPARE(group.freezeWindowMs(), qint64(-1));
+
+    group.setMaxParallel(0);
+    QCOMPARE(group.maxParallel(), 1);
+    group.setMaxParallel(8);
+    QCOMPARE(group.maxParallel(), 8);
+}
+
+void TestGroupSnapshot::testEmptyGroupFails()
+{
+    GroupSnapshot group{QList<Domain*>()};
+    QSignalSpy finished(&group, &GroupSnapshot::finished);
+    group.start();
+
+    // Reported from the event loop, not from start()
+    QCOMPARE(finished.count(), 0);
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(finished.first().at(0).toBool(), false);
+    QCOMPARE(group.state(), GroupSnapshot::Failed);
+    QVERIFY(!group.errorString().isEmpty());
+}
+
+void TestGroupSnapshot::testMissingDomainFails()
+{
+    GroupSnapshot group(QList<Domain*>{nullptr});
+    QCOMPARE(group.members().size(), 1);
+
+    QSignalSpy finished(&group, &GroupSnapshot::finished);
+    group.start();
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(finished.first().at(0).toBool(), false);
+    QVERIFY(group.isDone());
+}
+
+void TestGroupSnapshot::testTestDriver()
+{
+    Connection *conn = Connection::open("test:///default");
+    if (!conn) {
+        QSKIP("Could not open test driver connection");
+    }
+
+    Domain *domain = conn->getDomain("test");
+    if (!domain) {
+        delete conn;
+        QSKIP("Test domain not available");
+    }
+
+    GroupSnapshot group(QList<Domain*>{domain});
+    group.setName("group-test");
+    QSignalSpy finished(&group, &GroupSnapshot::finished);
+    group.start();
+    QCOMPARE(group.state(), GroupSnapshot::Running);
+    QVERIFY(finished.wait(10000));
+    QVERIFY(group.isDone());
+
+    // The test driver has no guest agent and may lack disk-only
+    // snapshots; either way every phase must report back
+    const GroupSnapshot::Member member = group.members().at(0);
+    QCOMPARE(member.domainName, domain->name());
+    QVERIFY(!member.frozen || member.thawMs >= 0);
+    if (finished.first().at(0).toBool()) {
+        QVERIFY(member.created);
+        QVERIFY(!member.rolledBack);
+        QVERIFY(member.snapshotMs >= 0);
+    } else {
+        QVERIFY(!group.errorString().isEmpty());
+    }
+
+    delete conn;
+}
+
+QTEST_MAIN(TestGroupSnapshot)
+#include "test_groupsnapshot.moc"
@@ -0,0 +1,370 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QtEndian>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include "../../src/core/ImageInspector.h"
+
+using namespace QVirt;
+
+namespace {
+
+constexpr int ClusterBits = 16;
+constexpr qint64 ClusterSize = qint64(1) << ClusterBits;
+constexpr quint64 CopiedFlag = quint64(1) << 63;
+constexpr quint64 CompressedFlag = quint64(1) << 62;
+
+void putBE32(QByteArray &data, qint64 offset, quint32 value)
+{
+    qToBigEndian(value, reinterpret_cast<uchar *>(data.data() + offset));
+}
+
+void putBE64(QByteArray &data, qint64 offset, quint64 value)
+{
+    qToBigEndian(value, reinterpret_cast<uchar *>(data.data() + offset));
+}
+
+/*
+ * A minimal qcow2 image: header in cluster 0, L1 table in cluster 1,
+ * one L2 table in cluster 2 and one data cluster in cluster 3.
+ */
+QByteArray qcow2Image(qint64 virtualSize, int version = 3, const QByteArray &backing = QByteArray(),
+                      const QByteArray &backingFormat = QByteArray())
+{
+    QByteArray image(int(4 * ClusterSize), '\0');
+    const qint64 bytesPerL1Entry = ClusterSize * (ClusterSize / 8);
+    const quint32 l1Size = quint32(qMax<qint64>(1, (virtualSize + bytesPerL1Entry - 1) / bytesPerL1Entry));
+
+    putBE32(image, 0, 0x514649fb);
+    putBE32(image, 4, quint32(version));
+    putBE32(image, 20, ClusterBits);
+    putBE64(image, 24, quint64(virtualSize));
+    putBE32(image, 36, l1Size);
+    putBE64(image, 40, quint64(ClusterSize));
+    putBE64(image, 48, quint64(3 * ClusterSize));
+    putBE32(image, 56, 1);
+
+    qint64 pos = 72;
+    if (version >= 3) {
+        putBE32(image, 96, 4);
+        putBE32(image, 100, 104);
+        pos = 104;
+    }
+    if (!backingFormat.isEmpty()) {
+        putBE32(image, pos, 0xe2792aca);
+        putBE32(image, pos + 4, quint32(backingFormat.size()));
+        image.replace(int(pos + 8), backingFormat.size(), backingFormat);
+        pos += 8 + ((backingFormat.size() + 7) & ~7);
+    }
+    pos += 8;   // End of extensions
+
+    if (!backing.isEmpty()) {
+        putBE64(image, 8, quint64(pos));
+        putBE32(image, 16, quint32(backing.size()));
+        image.replace(int(pos), backing.size(), backing);
+    }
+
+    // Guest cluster 0 holds data, 1 is compressed, 2 reads as zeros
+    putBE64(image, ClusterSize, quint64(2 * ClusterSize) | CopiedFlag);
+    putBE64(image, 2 * ClusterSize, quint64(3 * ClusterSize) | CopiedFlag);
+    putBE64(image, 2 * ClusterSize + 8, CompressedFlag | quint64(3 * ClusterSize + 512));
+    putBE64(image, 2 * ClusterSize + 16, quint64(3 * ClusterSize) | 1);
+    return image;
+}
+
+bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+// What holds for any header the parser accepts
+void checkInvariants(const ImageInfo &info, qint64 fileSize)
+{
+    if (!info.isValid() || info.format != ImageInfo::FormatQcow2) {
+        return;
+    }
+    QVERIFY(info.clusterBits >= 9 && info.clusterBits <= 21);
+    QVERIFY(info.version == 2 || info.version == 3);
+    QVERIFY(info.virtualSize >= 0);
+    QVERIFY(info.backingFile.size() <= 1023);
+    QVERIFY(info.l1TableOffset % info.clusterSize() == 0);
+    if (info.l1Size > 0) {
+        QVERIFY(info.l1TableOffset + qint64(info.l1Size) * 8 <= fileSize);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Unit tests for ImageInspector
+ *
+ * Images are built byte by byte, then truncated and mutated at random to
+ * make sure no header makes the parser read out of bounds.
+ */
+class TestImageInspector : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRaw();
+    void testQcow2Header();
+    void testQcow2Version2();
+    void testInvalidHeaders();
+    void testBackingChain();
+    void testBackingLoop();
+    void testRemoteBacking();
+    void testScanAllocation();
+    void testFuzzTruncated();
+    void testFuzzMutated();
+    void testFuzzTables();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+void TestImageInspector::testRaw()
+{
+    const QString path = m_dir.filePath("disk.raw");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.resize(4 * 1024 * 1024));
+    file.close();
+
+    // No header to go by: readable, but not claimed to be raw
+    ImageInfo info = ImageInspector::inspect(path);
+    QVERIFY(info.isReadable());
+    QVERIFY(!info.isValid());
+    QCOMPARE(info.format, ImageInfo::FormatUnknown);
+    QVERIFY(info.formatName().isEmpty());
+    QCOMPARE(info.virtualSize, qint64(4 * 1024 * 1024));
+    QVERIFY(info.backingFile.isEmpty());
+
+    // Never more data than the file holds; nothing at all where holes work
+    qint64 data = ImageInspector::scanAllocation(path);
+    QVERIFY(data >= 0 && data <= info.virtualSize);
+}
+
+void TestImageInspector::testQcow2Header()
+{
+    QByteArray image = qcow2Image(10LL * 1024 * 1024 * 1024, 3, "base.img", "raw");
+    ImageInfo info = ImageInspector::parseHeader(image, image.size());
+
+    QVERIFY2(info.isValid(), qPrintable(info.error));
+    QCOMPARE(info.format, ImageInfo::FormatQcow2);
+    QCOMPARE(info.version, 3);
+    QCOMPARE(info.virtualSize, 10LL * 1024 * 1024 * 1024);
+    QCOMPARE(info.clusterSize(), ClusterSize);
+    QCOMPARE(info.l1Size, quint32(20));
+    QCOMPARE(info.l1TableOffset, ClusterSize);
+    QCOMPARE(info.refcountBits, 16);
+    QCOMPARE(info.backingFile, QString("base.img"));
+    QCOMPARE(info.backingFormat, QString("raw"));
+    QVERIFY(!info.encrypted);
+    QVERIFY(!info.isDirty());
+}
+
+void TestImageInspector::testQcow2Version2()
+{
+    QByteArray image = qcow2Image(1024 * 1024, 2, "/images/base.qcow2");
+    ImageInfo info = ImageInspector::parseHeader(image, image.size());
+
+    QVERIFY2(info.isValid(), qPrintable(info.error));
+    QCOMPARE(info.version, 2);
+    QCOMPARE(info.refcountBits, 16);
+    QCOMPARE(info.backingFile, QString("/images/base.qcow2"));
+    QVERIFY(info.backingFormat.isEmpty());
+}
+
+void TestImageInspector::testInvalidHeaders()
+{
+    const QByteArray good = qcow2Image(1024 * 1024);
+
+    QByteArray image = good;
+    putBE32(image, 4, 1);
+    QVERIFY(!ImageInspector::parseHeader(image, image.size()).isValid());
+
+    image = good;
+    putBE32(image, 20, 30);
+    QVERIFY(!ImageInspector::parseHeader(image, image.size()).isValid());
+
+    // The L1 table cannot cover a disk this large
+    image = good;
+    putBE64(image, 24, 1ULL << 50);
+    QVERIFY(!ImageInspector::parseHeader(image, image.size()).isValid());
+
+    // L1 table past the end of the file
+    image = good;
+    putBE64(image, 40, quint64(16 * ClusterSize));
+    QVERIFY(!ImageInspector::parseHeader(image, image.size()).isValid());
+
+    // Backing file name pointing outside the header
+    image = good;
+    putBE64(image, 8, quint64(image.size() - 4));
+    putBE32(image, 16, 64);
+    QVERIFY(!ImageInspector::parseHeader(image, image.size()).isValid());
+
+    // A header extension running past the first cluster
+    image = good;
+    putBE32(image, 104, 0x12345678);
+    putBE32(image, 108, quint32(ClusterSize));
+    QVERIFY(!ImageInspector::parseHeader(image, image.size()).isValid());
+
+    QVERIFY(!ImageInspector::inspect(m_dir.filePath("missing.qcow2")).isValid());
+}
+
+void TestImageInspector::testBackingChain()
+{
+    const QString base = m_dir.filePath("chain-base.raw");
+    const QString mid = m_dir.filePath("chain-mid.qcow2");
+    const QString top = m_dir.filePath("chain-top.qcow2");
+    QVERIFY(writeFile(base, QByteArray(4096, 'x')));
+    QVERIFY(writeFile(mid, qcow2Image(1024 * 1024, 3, "chain-base.raw", "raw")));
+    QVERIFY(writeFile(top, qcow2Image(1024 * 1024, 3, mid.toUtf8(), "qcow2")));
+
+    QList<ImageInfo> chain = ImageInspector::backingChain(top);
+    QCOMPARE(chain.size(), 3);
+    QCOMPARE(chain.at(0).path, top);
+    QCOMPARE(chain.at(1).path, mid);
+    QCOMPARE(QFileInfo(chain.at(2).path).canonicalFilePath(), QFileInfo(base).canonicalFilePath());
+    QCOMPARE(chain.at(2).format, ImageInfo::FormatRaw);
+    for (const ImageInfo &info : chain) {
+        QVERIFY2(info.isValid(), qPrintable(info.error));
+    }
+
+    // Stops after the requested depth, saying so
+    chain = ImageInspector::backingChain(top, 2);
+    QCOMPARE(chain.size(), 2);
+    QVERIFY(!chain.last().error.isEmpty());
+
+    // Without a backing format the base is not taken for raw
+    const QString untyped = m_dir.filePath("chain-untyped.qcow2");
+    QVERIFY(writeFile(untyped, qcow2Image(1024 * 1024, 3, "chain-base.raw")));
+    chain = ImageInspector::backingChain(untyped);
+    QCOMPARE(chain.size(), 2);
+    QCOMPARE(chain.at(1).format, ImageInfo::FormatUnknown);
+    QVERIFY(chain.at(1).isReadable());
+}
+
+void TestImageInspector::testBackingLoop()
+{
+    const QString a = m_dir.filePath("loop-a.qcow2");
+    const QString b = m_dir.filePath("loop-b.qcow2");
+    QVERIFY(writeFile(a, qcow2Image(1024 * 1024, 3, "loop-b.qcow2")));
+    QVERIFY(writeFile(b, qcow2Image(1024 * 1024, 3, "loop-a.qcow2")));
+
+    QList<ImageInfo> chain = ImageInspector::backingChain(a);
+    QCOMPARE(chain.size(), 2);
+    QVERIFY(!chain.last().error.isEmpty());
+}
+
+void TestImageInspector::testRemoteBacking()
+{
+    const QString path = m_dir.filePath("remote.qcow2");
+    QVERIFY(writeFile(path, qcow2Image(1024 * 1024, 3, "nbd://storage:10809/export", "raw")));
+
+    QList<ImageInfo> chain = ImageInspector::backingChain(path);
+    QCOMPARE(chain.size(), 1);
+    QVERIFY(chain.first().isValid());
+    QVERIFY(ImageInspector::resolveBackingFile(chain.first()).isEmpty());
+    QCOMPARE(chain.first().backingFile, QString("nbd://storage:10809/export"));
+}
+
+void TestImageInspector::testScanAllocation()
+{
+    const QString path = m_dir.filePath("scan.qcow2");
+    QVERIFY(writeFile(path, qcow2Image(1024 * 1024 * 1024)));
+
+    // One data cluster and one compressed one; the zero cluster holds nothing
+    QCOMPARE(ImageInspector::scanAllocation(path), 2 * ClusterSize);
+
+    std::atomic<bool> cancel(true);
+    QCOMPARE(ImageInspector::scanAllocation(path, &cancel), qint64(-1));
+}
+
+void TestImageInspector::testFuzzTruncated()
+{
+    const QByteArray image = qcow2Image(1024 * 1024, 3, "base.img", "raw");
+    for (int length = 0; length <= 1024; ++length) {
+        ImageInfo info = ImageInspector::parseHeader(image.left(length), image.size());
+        checkInvariants(info, image.size());
+        if (length >= 4 && length < 104) {
+            QVERIFY(!info.isValid());
+        }
+    }
+
+    // A file cut short leaves the L1 table outside it
+    QVERIFY(!ImageInspector::parseHeader(image, ClusterSize).isValid());
+}
+
+void TestImageInspector::testFuzzMutated()
+{
+    QRandomGenerator rng(20260518);
+    const QByteArray good = qcow2Image(64 * 1024 * 1024, 3, "base.img", "qcow2");
+    const QByteArray header = good.left(int(ClusterSize));
+
+    for (int round = 0; round < 5000; ++round) {
+        QByteArray mutated = header;
+        const int flips = 1 + rng.bounded(8);
+        for (int i = 0; i < flips; ++i) {
+            // Mostly the fixed header and extensions, sometimes anywhere
+            const int limit = rng.bounded(4) == 0 ? mutated.size() : 256;
+            mutated[rng.bounded(limit)] = char(rng.bounded(256));
+        }
+        const qint64 fileSize = rng.bounded(8) == 0 ? qint64(rng.bounded(1 << 20)) : good.size();
+
+        ImageInfo info = ImageInspector::parseHeader(mutated, fileSize);
+        checkInvariants(info, fileSize);
+        if (QTest::currentTestFailed()) {
+            QFAIL(qPrintable(QString("Round %1 broke an invariant").arg(round)));
+        }
+    }
+
+    // Random bytes behind a valid magic
+    for (int round = 0; round < 2000; ++round) {
+        QByteArray noise(rng.bounded(1, 4096), '\0');
+        for (int i = 0; i < noise.size(); ++i) {
+            noise[i] = char(rng.bounded(256));
+        }
+        if (noise.size() >= 4) {
+            putBE32(noise, 0, 0x514649fb);
+        }
+        ImageInfo info = ImageInspector::parseHeader(noise, noise.size());
+        checkInvariants(info, noise.size());
+    }
+}
+
+void TestImageInspector::testFuzzTables()
+{
+    QRandomGenerator rng(7);
+    const QByteArray good = qcow2Image(1024 * 1024 * 1024);
+    const QString path = m_dir.filePath("fuzz.qcow2");
+
+    // Garbage in the L1 and L2 tables must neither crash nor overcount
+    for (int round = 0; round < 200; ++round) {
+        QByteArray mutated = good;
+        for (int i = 0; i < 16; ++i) {
+            const qint64 table = rng.bounded(2) == 0 ? ClusterSize : 2 * ClusterSize;
+            mutated[int(table + rng.bounded(64))] = char(rng.bounded(256));
+        }
+        QVERIFY(writeFile(path, mutated));
+
+        ImageInfo info = ImageInspector::inspect(path);
+        QVERIFY(info.isValid());
+        const qint64 bytes = ImageInspector::scanAllocation(path);
+        QVERIFY(bytes >= 0 && bytes <= info.virtualSize);
+    }
+}
+
+QTEST_MAIN(TestImageInspector)
+#include "test_imageinspector.moc"
@@ -0,0 +1,179 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include "../../src/libvirt/MigrationManager.h"
+#include "../../src/libvirt/Connection.h"
+#include "../../src/libvirt/Domain.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for MigrationManager
+ *
+ * Migrations themselves need two hosts; these cover the URI, the flags
+ * and parameters handed to libvirt and the job life cycle.
+ */
+class TestMigration : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDestinationUri();
+    void testFlags();
+    void testValidate();
+    void testNoDomainFails();
+    void testTestDriverQueue();
+};
+
+void TestMigration::testDestinationUri()
+{
+    QCOMPARE(MigrationManager::destinationUri(MigrationManager::SSH, "node2", 22, "root"),
+             QString("qemu+ssh://root@node2/system"));
+    QCOMPARE(MigrationManager::destinationUri(MigrationManager::SSH, " node2 ", 2222),
+             QString("qemu+ssh://node2:2222/system"));
+
+    // No user outside SSH
+    QCOMPARE(MigrationManager::destinationUri(MigrationManager::TLS, "node2", 16514, "root"),
+             QString("qemu+tls://node2/system"));
+    QCOMPARE(MigrationManager::destinationUri(MigrationManager::TCP, "fd00::2", 16600),
+             QString("qemu+tcp://[fd00::2]:16600/system"));
+}
+
+void TestMigration::testFlags()
+{
+    MigrationJob::Options options;
+    options.destinationUri = "qemu+ssh://node2/system";
+    options.compression = MigrationJob::Xbzrle;
+    options.autoConverge = true;
+    options.postCopy = true;
+    options.undefineSource = true;
+
+    unsigned int flags = MigrationManager::migrationFlags(options, true);
+    QVERIFY(flags & VIR_MIGRATE_LIVE);
+    QVERIFY(flags & VIR_MIGRATE_PERSIST_DEST);
+    QVERIFY(flags & VIR_MIGRATE_UNDEFINE_SOURCE);
+    QVERIFY(flags & VIR_MIGRATE_COMPRESSED);
+    QVERIFY(flags & VIR_MIGRATE_AUTO_CONVERGE);
+    QVERIFY(flags & VIR_MIGRATE_POSTCOPY);
+    QVERIFY(!(flags & VIR_MIGRATE_PEER2PEER));
+    QVERIFY(!(flags & VIR_MIGRATE_OFFLINE));
+
+    // Paused while moving: post-copy only makes sense live
+    options.live = false;
+    options.peerToPeer = true;
+    flags = MigrationManager::migrationFlags(options, true);
+    QVERIFY(!(flags & VIR_MIGRATE_LIVE));
+    QVERIFY(!(flags & VIR_MIGRATE_POSTCOPY));
+    QVERIFY(flags & VIR_MIGRATE_PEER2PEER);
+
+    // Shut off: only the definition moves
+    options.live = true;
+    options.persistent = false;
+    flags = MigrationManager::migrationFlags(options, false);
+    QVERIFY(flags & VIR_MIGRATE_OFFLINE);
+    QVERIFY(flags & VIR_MIGRATE_PERSIST_DEST);
+    QVERIFY(!(flags & VIR_MIGRATE_LIVE));
+    QVERIFY(!(flags & VIR_MIGRATE_COMPRESSED));
+}
+
+void TestMigration::testValidate()
+{
+    MigrationJob::Options options;
+    QVERIFY(!MigrationManager::validate(options, true).isEmpty());
+
+    options.destinationUri = "qemu+tls://node2/system";
+    QVERIFY(MigrationManager::validate(options, true).isEmpty());
+
+    options.persistent = false;
+    QVERIFY(MigrationManager::validate(options, true).isEmpty());
+    QVERIFY(!MigrationManager::validate(options, false).isEmpty());
+    options.persistent = true;
+
+    options.compression = MigrationJob::Zstd;
+    QVERIFY(!MigrationManager::validate(options, true).isEmpty());
+
+    options.compression = MigrationJob::NoCompression;
+    options.postCopyAfterPasses = 3;
+    QVERIFY(!MigrationManager::validate(options, true).isEmpty());
+    options.postCopy = true;
+    QVERIFY(MigrationManager::validate(options, true).isEmpty());
+}
+
+void TestMigration::testNoDomainFails()
+{
+    MigrationManager manager;
+    QSignalSpy finished(&manager, &MigrationManager::jobFinished);
+
+    MigrationJob::Options options;
+    options.destinationUri = "test:///default";
+    MigrationJob *job = manager.migrate(nullptr, options);
+    QVERIFY(job);
+    QCOMPARE(job->state(), MigrationJob::Failed);
+    QVERIFY(!job->isCancellable());
+
+    // Reported from the event loop, like any other outcome
+    QCOMPARE(finished.count(), 0);
+    QVERIFY(finished.wait(1000));
+    QCOMPARE(manager.activeCount(), 0);
+
+    manager.clearFinished();
+    QVERIFY(manager.jobs().isEmpty());
+}
+
+void TestMigration::testTestDriverQueue()
+{
+    Connection *conn = Connection::open("test:///default");
+    if (!conn) {
+        QSKIP("Could not open test driver connection");
+    }
+
+    Domain *domain = conn->getDomain("test");
+    if (!domain) {
+        delete conn;
+        QSKIP("Test domain not available");
+    }
+
+    MigrationManager manager;
+    manager.setMaxConcurrent(0);
+    QCOMPARE(manager.maxConcurrent(), 1);
+
+    MigrationJob::Options options;
+    options.destinationUri = "test:///default";
+
+    // One migration per domain at a time: the second waits for the first
+    MigrationJob *first = manager.migrate(domain, options);
+    MigrationJob *second = manager.migrate(domain, options);
+    QCOMPARE(first->state(), MigrationJob::Queued);
+    QCOMPARE(second->state(), MigrationJob::Queued);
+    QCOMPARE(manager.activeCount(), 2);
+
+    // Cancelled before it started
+    QSignalSpy finished(&manager, &MigrationManager::jobFinished);
+    manager.cancel(second);
+    QCOMPARE(second->state(), MigrationJob::Cancelled);
+    QCOMPARE(finished.count(), 1);
+
+    QTRY_VERIFY_WITH_TIMEOUT(first->isDone(), 10000);
+
+    // The test driver cannot migrate; the failure must come back as such
+    if (first->state() == MigrationJob::Failed) {
+        QVERIFY(!first->errorString().isEmpty());
+    }
+    QCOMPARE(finished.count(), 2);
+    QCOMPARE(manager.activeCount(), 0);
+
+    delete conn;
+}
+
+QTEST_MAIN(TestMigration)
+#include "test_migration.moc"
@@ -0,0 +1,236 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include "../../src/console/ScrollbackBuffer.h"
+#include "../../src/console/ConsoleLogWriter.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for console scrollback and log rotation
+ */
+class TestScrollback : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testLineIndex();
+    void testManyChunks();
+    void testEvictByLines();
+    void testEvictByBytes();
+    void testOversizedLine();
+    void testClear();
+    void testFind();
+    void testFindAcrossChunks();
+    void testLogRotation();
+    void testLogOpenFailure();
+};
+
+void TestScrollback::testLineIndex()
+{
+    ScrollbackBuffer buffer;
+    buffer.append("one\ntwo\nthr");
+    buffer.append("ee\nfour");
+
+    QCOMPARE(buffer.lineCount(), qint64(4));
+    QCOMPARE(buffer.line(0), QByteArray("one"));
+    QCOMPARE(buffer.line(2), QByteArray("three"));
+    QCOMPARE(buffer.line(3), QByteArray("four"));
+    QCOMPARE(buffer.lineStart(2), qint64(8));
+    QCOMPARE(buffer.lineStart(4), qint64(-1));
+
+    QCOMPARE(buffer.lineAt(0), qint64(0));
+    QCOMPARE(buffer.lineAt(3), qint64(0));      // The newline belongs to its line
+    QCOMPARE(buffer.lineAt(4), qint64(1));
+    QCOMPARE(buffer.lineAt(buffer.endOffset()), qint64(3));
+
+    // An open last line keeps growing
+    buffer.append(" five\n");
+    QCOMPARE(buffer.line(3), QByteArray("four five"));
+    QCOMPARE(buffer.line(4), QByteArray());
+}
+
+void TestScrollback::testManyChunks()
+{
+    ScrollbackBuffer buffer;
+    QByteArray all;
+    for (int i = 0; i < 20000; ++i) {
+        QByteArray line = "[ " + QByteArray::number(i) + " ] kernel: message\n";
+        buffer.append(line);
+        all += line;
+    }
+
+    QVERIFY(buffer.chunkCount() > 1);
+    QCOMPARE(buffer.toByteArray(), all);
+    QCOMPARE(buffer.line(12345), QByteArray("[ 12345 ] kernel: message"));
+
+    // Reads spanning a chunk boundary
+    QCOMPARE(buffer.read(65530, 100), all.mid(65530, 100));
+
+    // Large appends are kept as they are
+    QByteArray big(100000, 'x');
+    buffer.append(big);
+    QCOMPARE(buffer.line(buffer.lastLine()), big);
+}
+
+void TestScrollback::testEvictByLines()
+{
+    ScrollbackBuffer buffer(1024 * 1024, 3);
+    buffer.append("a\nb\nc\nd\ne");
+
+    QCOMPARE(buffer.lineCount(), qint64(3));
+    QCOMPARE(buffer.firstLine(), qint64(2));
+    QCOMPARE(buffer.toByteArray(), QByteArray("c\nd\ne"));
+
+    // Absolute positions stay valid for what is retained
+    QCOMPARE(buffer.line(3), QByteArray("d"));
+    QCOMPARE(buffer.lineStart(2), qint64(4));
+    QCOMPARE(buffer.lineStart(1), qint64(-1));
+    QCOMPARE(buffer.lineAt(0), qint64(2));
+
+    buffer.setLimits(1024 * 1024, 1);
+    QCOMPARE(buffer.toByteArray(), QByteArray("e"));
+}
+
+void TestScrollback::testEvictByBytes()
+{
+    ScrollbackBuffer buffer(20, 1000);
+    buffer.append("aaaa\nbbbb\ncccc\ndddd\neeee\n");
+
+    // Trimmed to whole lines
+    QCOMPARE(buffer.toByteArray(), QByteArray("bbbb\ncccc\ndddd\neeee\n"));
+    QCOMPARE(buffer.firstLine(), qint64(1));
+
+    buffer.append("ff\n");
+    QCOMPARE(buffer.toByteArray(), QByteArray("cccc\ndddd\neeee\nff\n"));
+    QVERIFY(buffer.size() <= 20);
+
+    // A long run of output stays within its budget
+    ScrollbackBuffer bounded(100000, 1000000);
+    for (int i = 0; i < 100000; ++i) {
+        bounded.append("line " + QByteArray::number(i) + "\n");
+    }
+    QVERIFY(bounded.size() <= 100000);
+    QVERIFY(bounded.chunkCount() <= 3);
+    QCOMPARE(bounded.line(bounded.lastLine() - 1), QByteArray("line 99999"));
+}
+
+void TestScrollback::testOversizedLine()
+{
+    // A single line longer than the limit is cut rather than kept whole
+    ScrollbackBuffer buffer(10, 100);
+    buffer.append(QByteArray(25, 'x'));
+    QCOMPARE(buffer.size(), qint64(10));
+    QCOMPARE(buffer.lineCount(), qint64(1));
+    QCOMPARE(buffer.line(buffer.firstLine()), QByteArray(10, 'x'));
+}
+
+void TestScrollback::testClear()
+{
+    ScrollbackBuffer buffer;
+    buffer.append("one\ntwo");
+    buffer.clear();
+
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.startOffset(), qint64(7));
+    QCOMPARE(buffer.firstLine(), qint64(2));
+    QCOMPARE(buffer.lineStart(0), qint64(-1));
+
+    buffer.append("three\n");
+    QCOMPARE(buffer.line(2), QByteArray("three"));
+}
+
+void TestScrollback::testFind()
+{
+    ScrollbackBuffer buffer;
+    buffer.append("Booting kernel\nerror: disk\nok\nERROR: net\n");
+
+    QCOMPARE(buffer.find("error", 0), qint64(15));
+    QCOMPARE(buffer.find("error", 16), qint64(30));
+    QCOMPARE(buffer.find("error", 31), qint64(-1));
+    QCOMPARE(buffer.find("error", 0, ScrollbackBuffer::FindCaseSensitive), qint64(15));
+    QCOMPARE(buffer.find("ERROR", 16, ScrollbackBuffer::FindCaseSensitive), qint64(30));
+
+    // Backward searches return matches starting before the offset
+    QCOMPARE(buffer.find("error", buffer.endOffset(), ScrollbackBuffer::FindBackward), qint64(30));
+    QCOMPARE(buffer.find("error", 30, ScrollbackBuffer::FindBackward), qint64(15));
+    QCOMPARE(buffer.find("error", 15, ScrollbackBuffer::FindBackward), qint64(-1));
+
+    // Matches do not span lines
+    QCOMPARE(buffer.find("disk\nok", 0), qint64(-1));
+
+    // Offsets are bytes, also after multi-byte characters
+    ScrollbackBuffer utf8;
+    utf8.append(QString::fromUtf8("caf\xc3\xa9 menu caf\xc3\xa9\n").toUtf8());
+    QCOMPARE(utf8.find("menu", 0), qint64(6));
+    QCOMPARE(utf8.find(QString::fromUtf8("caf\xc3\xa9"), 1), qint64(11));
+}
+
+void TestScrollback::testFindAcrossChunks()
+{
+    ScrollbackBuffer buffer(200000, 100000);
+    for (int i = 0; i < 10000; ++i) {
+        buffer.append("entry " + QByteArray::number(i) + "\n");
+    }
+
+    qint64 offset = buffer.find("entry 9000", buffer.startOffset());
+    QVERIFY(offset >= 0);
+    QCOMPARE(buffer.line(buffer.lineAt(offset)), QByteArray("entry 9000"));
+
+    qint64 back = buffer.find("entry 10", buffer.endOffset(), ScrollbackBuffer::FindBackward);
+    QCOMPARE(buffer.line(buffer.lineAt(back)), QByteArray("entry 1099"));
+}
+
+void TestScrollback::testLogRotation()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("console.log");
+
+    ConsoleLogWriter writer(path, 100, 2);
+    writer.start();
+    const QByteArray line(40, 'a');
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(writer.append(line));
+    }
+    writer.stop();
+
+    QCOMPARE(writer.writtenBytes(), qint64(400));
+    QCOMPARE(writer.droppedBytes(), qint64(0));
+
+    // Each file holds whole appends up to the limit; only two old ones are kept
+    QFileInfo live(path);
+    QCOMPARE(live.size(), qint64(80));
+    QCOMPARE(QFileInfo(ConsoleLogWriter::rotatedName(path, 1)).size(), qint64(80));
+    QCOMPARE(QFileInfo(ConsoleLogWriter::rotatedName(path, 2)).size(), qint64(80));
+    QVERIFY(!QFile::exists(ConsoleLogWriter::rotatedName(path, 3)));
+
+    // Appending after stop() is refused
+    QVERIFY(!writer.append(line));
+    QCOMPARE(writer.droppedBytes(), qint64(40));
+}
+
+void TestScrollback::testLogOpenFailure()
+{
+    QTemporaryDir dir;
+    ConsoleLogWriter writer(dir.filePath("missing/console.log"));
+    QSignalSpy errorSpy(&writer, &ConsoleLogWriter::writeError);
+    writer.start();
+    QTRY_COMPARE(errorSpy.count(), 1);
+    writer.stop();
+
+    QVERIFY(!writer.append("data"));
+}
+
+QTEST_MAIN(TestScrollback)
+#include "test_scrollback.moc"
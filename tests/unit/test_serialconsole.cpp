@@ -0,0 +1,245 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QPlainTextEdit>
+#include <QTextBlock>
+#include <cstring>
+#include "../../src/console/SerialConsole.h"
+
+using namespace QVirt;
+
+/**
+ * @brief In-memory stand-in for a console stream with a bounded write side
+ */
+class PipeDevice : public QIODevice
+{
+public:
+    explicit PipeDevice(QObject *parent = nullptr)
+        : QIODevice(parent)
+        , writeRoom(1 << 30)
+    {
+        open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return incoming.size() + QIODevice::bytesAvailable(); }
+
+    void feed(const QByteArray &data)
+    {
+        incoming.append(data);
+        emit readyRead();
+    }
+
+    void finish(const QString &reason)
+    {
+        setErrorString(reason);
+        emit readChannelFinished();
+    }
+
+    void grantRoom(qint64 bytes, qint64 flushed)
+    {
+        writeRoom += bytes;
+        emit bytesWritten(flushed);
+    }
+
+    QByteArray incoming;
+    QByteArray written;
+    qint64 writeRoom;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        qint64 length = qMin<qint64>(maxSize, incoming.size());
+        std::memcpy(data, incoming.constData(), length);
+        incoming.remove(0, int(length));
+        return length;
+    }
+
+    qint64 writeData(const char *data, qint64 maxSize) override
+    {
+        qint64 length = qMin(maxSize, writeRoom);
+        written.append(data, int(length));
+        writeRoom -= length;
+        return length;
+    }
+};
+
+/**
+ * @brief Unit tests for the serial console's stream transport
+ */
+class TestSerialConsole : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testConnectToStream();
+    void testFilteredOutput();
+    void testSplitUtf8();
+    void testInputBackpressure();
+    void testFloodIsRenderedInSlices();
+    void testRemoteClose();
+    void testScrollbackSearch();
+
+private:
+    static QPlainTextEdit *view(SerialConsole *console)
+    {
+        return console->findChild<QPlainTextEdit *>();
+    }
+};
+
+void TestSerialConsole::testConnectToStream()
+{
+    SerialConsole console;
+    QSignalSpy connectedSpy(&console, &SerialConsole::connected);
+
+    auto *device = new PipeDevice();
+    console.connectToStream(device);
+    QCOMPARE(connectedSpy.count(), 1);
+    QVERIFY(console.isConnected());
+    QCOMPARE(device->parent(), &console);
+
+    // A closed device is refused
+    QSignalSpy errorSpy(&console, &SerialConsole::connectionError);
+    auto *closed = new PipeDevice();
+    closed->close();
+    console.connectToStream(closed);
+    QCOMPARE(errorSpy.count(), 1);
+    QVERIFY(!console.isConnected());
+}
+
+void TestSerialConsole::testFilteredOutput()
+{
+    SerialConsole console;
+    auto *device = new PipeDevice();
+    console.connectToStream(device);
+
+    // Colours, cursor movement, titles and carriage returns are dropped
+    device->feed("\x1b[1;32m OK \x1b[0m] Reached target\r\n");
+    device->feed("\x1b]0;title\x07\x1b[2Klogin: ");
+    QTRY_COMPARE(view(&console)->toPlainText(), QString(" OK ] Reached target\nlogin: "));
+
+    // Escape sequences split across reads
+    device->feed("\x1b[");
+    device->feed("31mred\x1b");
+    device->feed("[0m\n");
+    QTRY_COMPARE(view(&console)->toPlainText(), QString(" OK ] Reached target\nlogin: red\n"));
+}
+
+void TestSerialConsole::testSplitUtf8()
+{
+    SerialConsole console;
+    auto *device = new PipeDevice();
+    console.connectToStream(device);
+
+    QByteArray text = QString::fromUtf8("caf\xc3\xa9 \xe2\x9c\x93\n").toUtf8();
+    for (char ch : text) {
+        device->feed(QByteArray(1, ch));
+        QCoreApplication::processEvents();
+    }
+    QTRY_COMPARE(view(&console)->toPlainText(), QString::fromUtf8(text));
+}
+
+void TestSerialConsole::testInputBackpressure()
+{
+    SerialConsole console;
+    auto *device = new PipeDevice();
+    device->writeRoom = 3;
+    console.connectToStream(device);
+
+    console.sendText("hello");
+    QCOMPARE(device->written, QByteArray("hel"));
+    QCOMPARE(console.pendingInputBytes(), qint64(2));
+
+    // The rest goes out once the device reports progress
+    device->grantRoom(16, 3);
+    QCOMPARE(device->written, QByteArray("hello"));
+    QCOMPARE(console.pendingInputBytes(), qint64(0));
+}
+
+void TestSerialConsole::testFloodIsRenderedInSlices()
+{
+    SerialConsole console;
+    auto *device = new PipeDevice();
+    console.connectToStream(device);
+
+    QByteArray flood;
+    for (int i = 0; i < 50000; ++i) {
+        flood += "[    1.234567] kernel: line " + QByteArray::number(i) + "\n";
+    }
+    QSignalSpy sliceSpy(&console, &SerialConsole::dataReceived);
+    device->feed(flood);
+    QTRY_COMPARE_WITH_TIMEOUT(device->bytesAvailable(), qint64(0), 20000);
+
+    // Rendered over many bounded passes rather than in one long stall
+    QVERIFY(sliceSpy.count() > 1);
+    qint64 rendered = 0;
+    for (const QList<QVariant> &args : sliceSpy) {
+        QByteArray slice = args.at(0).toByteArray();
+        QVERIFY(slice.size() <= 64 * 1024);
+        rendered += slice.size();
+    }
+    QCOMPARE(rendered, qint64(flood.size()));
+    QVERIFY(view(&console)->blockCount() <= 10001);
+    QVERIFY(view(&console)->toPlainText().contains("kernel: line 49999"));
+}
+
+void TestSerialConsole::testRemoteClose()
+{
+    SerialConsole console;
+    auto *device = new PipeDevice();
+    console.connectToStream(device);
+    QSignalSpy disconnectedSpy(&console, &SerialConsole::disconnected);
+
+    device->incoming = "last words\n";
+    device->finish("Console closed by the remote end");
+
+    QCOMPARE(disconnectedSpy.count(), 1);
+    QVERIFY(!console.isConnected());
+    QString text = view(&console)->toPlainText();
+    QVERIFY(text.contains("last words"));
+    QVERIFY(text.contains("Console closed by the remote end"));
+}
+
+void TestSerialConsole::testScrollbackSearch()
+{
+    SerialConsole console;
+    auto *device = new PipeDevice();
+    console.connectToStream(device);
+
+    QByteArray flood;
+    for (int i = 0; i < 30000; ++i) {
+        flood += "line " + QByteArray::number(i) + (i == 100 ? " panic" : "") + "\n";
+    }
+    device->feed(flood);
+    QTRY_COMPARE_WITH_TIMEOUT(device->bytesAvailable(), qint64(0), 20000);
+    QCOMPARE(console.scrollback().lineCount(), qint64(30001));
+
+    // The match is older than the view, which loads that part of the scrollback
+    QVERIFY(console.findText("PANIC", ScrollbackBuffer::FindBackward));
+    QCOMPARE(view(&console)->textCursor().selectedText(), QString("panic"));
+    QCOMPARE(view(&console)->textCursor().block().text(), QString("line 100 panic"));
+    QVERIFY(!console.findText("no such text"));
+
+    // Back to following the output once search ends
+    console.hideFindBar();
+    device->feed("tail\n");
+    QTRY_VERIFY(view(&console)->toPlainText().endsWith("tail\n"));
+
+    // History outlives the stream
+    device->finish("closed");
+    QVERIFY(console.scrollback().toByteArray().contains("line 100 panic"));
+    console.clearScreen();
+    QVERIFY(console.scrollback().isEmpty());
+}
+
+QTEST_MAIN(TestSerialConsole)
+#include "test_serialconsole.moc"
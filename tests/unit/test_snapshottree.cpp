@@ -0,0 +1,180 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include "../../src/libvirt/SnapshotTree.h"
+#include "../../src/libvirt/Connection.h"
+#include "../../src/libvirt/Domain.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for SnapshotTree
+ */
+class TestSnapshotTree : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testParseNode();
+    void testParseInvalid();
+    void testLink();
+    void testLoadFromTestDriver();
+};
+
+namespace {
+
+const char *SnapshotXml =
+    "<domainsnapshot>"
+    "  <name>before-upgrade</name>"
+    "  <description>Kernel 6.8\nand new drivers</description>"
+    "  <state>running</state>"
+    "  <parent><name>base</name></parent>"
+    "  <creationTime>1772330400</creationTime>"
+    "  <memory snapshot='internal'/>"
+    "  <domain type='kvm'>"
+    "    <name>web01</name>"
+    "    <memory unit='KiB'>1048576</memory>"
+    "  </domain>"
+    "</domainsnapshot>";
+
+SnapshotTree::Node node(const QString &name, const QString &parent, qint64 created)
+{
+    SnapshotTree::Node result;
+    result.name = name;
+    result.parentName = parent;
+    result.creationTime = QDateTime::fromSecsSinceEpoch(created);
+    return result;
+}
+
+} // namespace
+
+void TestSnapshotTree::testParseNode()
+{
+    SnapshotTree::Node parsed = SnapshotTree::parseNode(SnapshotXml);
+
+    // Not the name of the embedded domain
+    QCOMPARE(parsed.name, QString("before-upgrade"));
+    QCOMPARE(parsed.description, QString("Kernel 6.8\nand new drivers"));
+    QCOMPARE(parsed.parentName, QString("base"));
+    QCOMPARE(parsed.state, VIR_DOMAIN_RUNNING);
+    QCOMPARE(parsed.creationTime.toSecsSinceEpoch(), qint64(1772330400));
+    QVERIFY(parsed.memory);
+    QVERIFY(!parsed.diskOnly);
+    QCOMPARE(parsed.xml, QString(SnapshotXml));
+
+    SnapshotTree::Node disk = SnapshotTree::parseNode(
+        "<domainsnapshot><name>disk</name><state>disk-snapshot</state>"
+        "<memory snapshot='no'/><domain><memory>1024</memory></domain></domainsnapshot>");
+    QVERIFY(disk.diskOnly);
+    QVERIFY(!disk.memory);
+    QVERIFY(disk.parentName.isEmpty());
+}
+
+void TestSnapshotTree::testParseInvalid()
+{
+    QVERIFY(SnapshotTree::parseNode("not xml").name.isEmpty());
+    QVERIFY(SnapshotTree::parseNode("<domain><name>web01</name></domain>").name.isEmpty());
+    QVERIFY(SnapshotTree::parseNode("<domainsnapshot><name>cut").name.isEmpty());
+}
+
+void TestSnapshotTree::testLink()
+{
+    // Listed in no particular order, as libvirt does
+    QList<SnapshotTree::Node> nodes{
+        node("c", "a", 300),
+        node("b", "a", 200),
+        node("a", QString(), 100),
+        node("d", "b", 400),
+        node("orphan", "deleted", 50),
+    };
+
+    const QList<int> roots = SnapshotTree::link(nodes, "d");
+    QCOMPARE(nodes.size(), 5);
+
+    // Oldest first
+    QCOMPARE(nodes.at(0).name, QString("orphan"));
+    QCOMPARE(nodes.at(1).name, QString("a"));
+    QCOMPARE(roots, QList<int>({0, 1}));
+
+    const SnapshotTree::Node &a = nodes.at(1);
+    QCOMPARE(a.parent, -1);
+    QCOMPARE(a.children.size(), 2);
+    QCOMPARE(nodes.at(a.children.at(0)).name, QString("b"));
+    QCOMPARE(nodes.at(a.children.at(1)).name, QString("c"));
+
+    const SnapshotTree::Node &b = nodes.at(a.children.at(0));
+    QCOMPARE(b.children.size(), 1);
+    const SnapshotTree::Node &d = nodes.at(b.children.at(0));
+    QCOMPARE(d.name, QString("d"));
+    QVERIFY(d.current);
+    QCOMPARE(nodes.at(d.parent).name, QString("b"));
+
+    int current = 0;
+    for (const SnapshotTree::Node &n : nodes) {
+        current += n.current ? 1 : 0;
+    }
+    QCOMPARE(current, 1);
+}
+
+void TestSnapshotTree::testLoadFromTestDriver()
+{
+    Connection *conn = Connection::open("test:///default");
+    if (!conn) {
+        QSKIP("Could not open test driver connection");
+    }
+
+    Domain *domain = conn->getDomain("test");
+    if (!domain) {
+        delete conn;
+        QSKIP("Test domain not available");
+    }
+
+    DomainSnapshot *first = domain->createSnapshot(
+        "<domainsnapshot><name>tree-first</name></domainsnapshot>");
+    if (!first) {
+        delete conn;
+        QSKIP("Test driver cannot create snapshots");
+    }
+    delete first;
+    delete domain->createSnapshot("<domainsnapshot><name>tree-second</name></domainsnapshot>");
+
+    // One tree per domain, cached
+    SnapshotTree *tree = domain->snapshotTree();
+    QCOMPARE(domain->snapshotTree(), tree);
+
+    QSignalSpy changed(tree, &SnapshotTree::changed);
+    tree->load();
+    QVERIFY(tree->isLoading());
+    QVERIFY(changed.wait(5000));
+    QVERIFY(tree->isLoaded());
+
+    const int second = tree->indexOf("tree-second");
+    QVERIFY(second >= 0);
+    const SnapshotTree::Node node = tree->nodes().at(second);
+    QCOMPARE(node.parentName, QString("tree-first"));
+    QCOMPARE(tree->currentIndex(), second);
+
+    // Up to date: nothing to fetch
+    tree->load();
+    QVERIFY(!tree->isLoading());
+
+    // Creating one through the domain reloads the tree
+    delete domain->createSnapshot("<domainsnapshot><name>tree-third</name></domainsnapshot>");
+    QVERIFY(changed.wait(5000));
+    QVERIFY(tree->indexOf("tree-third") >= 0);
+
+    delete conn;
+}
+
+QTEST_MAIN(TestSnapshotTree)
+#include "test_snapshottree.moc"
@@ -0,0 +1,174 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include "../../src/libvirt/StorageJobManager.h"
+#include "../../src/libvirt/StorageVolume.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for StorageJobManager
+ *
+ * Jobs run against the libvirt test driver, which needs no daemon.
+ */
+class TestStorageJobs : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testMissingSource();
+    void testCloneQueue();
+    void testCloneFailure();
+    void testClearFinished();
+
+private:
+    bool volumeExists(const QString &name) const;
+
+    virConnectPtr m_conn = nullptr;
+    virStoragePoolPtr m_pool = nullptr;
+    StorageVolume *m_source = nullptr;
+};
+
+void TestStorageJobs::initTestCase()
+{
+    m_conn = virConnectOpen("test:///default");
+    if (!m_conn) {
+        QSKIP("libvirt test driver not available");
+    }
+    m_pool = virStoragePoolLookupByName(m_conn, "default-pool");
+    if (!m_pool) {
+        QSKIP("libvirt test driver has no default pool");
+    }
+
+    const char *xml = "<volume><name>base.img</name>"
+                      "<capacity unit='bytes'>1073741824</capacity></volume>";
+    virStorageVolPtr vol = virStorageVolCreateXML(m_pool, xml, 0);
+    QVERIFY(vol);
+    m_source = new StorageVolume(vol, nullptr, this);
+}
+
+void TestStorageJobs::cleanupTestCase()
+{
+    delete m_source;
+    if (m_pool) {
+        virStoragePoolFree(m_pool);
+    }
+    if (m_conn) {
+        virConnectClose(m_conn);
+    }
+}
+
+bool TestStorageJobs::volumeExists(const QString &name) const
+{
+    QByteArray utf8 = name.toUtf8();
+    virStorageVolPtr vol = virStorageVolLookupByName(m_pool, utf8.constData());
+    if (!vol) {
+        return false;
+    }
+    virStorageVolFree(vol);
+    return true;
+}
+
+void TestStorageJobs::testMissingSource()
+{
+    StorageJobManager manager;
+    QSignalSpy finishedSpy(&manager, &StorageJobManager::jobFinished);
+
+    StorageJob *job = manager.cloneVolume(nullptr, "orphan.img");
+    QVERIFY(job);
+    QCOMPARE(job->state(), StorageJob::Failed);
+    QVERIFY(!job->errorString().isEmpty());
+    QVERIFY(!job->isCancellable());
+    QCOMPARE(manager.activeCount(), 0);
+
+    // Reported from the event loop like any other job
+    QCOMPARE(finishedSpy.count(), 0);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+}
+
+void TestStorageJobs::testCloneQueue()
+{
+    StorageJobManager manager;
+    manager.setMaxConcurrentPerPool(1);
+
+    QList<StorageJob*> jobs;
+    for (int i = 0; i < 3; ++i) {
+        jobs.append(manager.cloneVolume(m_source, QString("copy-%1.img").arg(i)));
+    }
+
+    int maxRunning = 0;
+    for (StorageJob *job : jobs) {
+        connect(job, &StorageJob::stateChanged, this, [&]() {
+            int running = 0;
+            for (StorageJob *other : jobs) {
+                running += other->state() == StorageJob::Running ? 1 : 0;
+            }
+            maxRunning = qMax(maxRunning, running);
+        });
+    }
+
+    // Nothing starts before the event loop runs
+    QCOMPARE(manager.activeCount(), 3);
+    for (StorageJob *job : jobs) {
+        QCOMPARE(job->state(), StorageJob::Queued);
+        QVERIFY(job->isCancellable());
+        QCOMPARE(job->poolName(), QString("default-pool"));
+    }
+
+    // A queued job is dropped without touching libvirt
+    manager.cancel(jobs.at(2));
+    QCOMPARE(jobs.at(2)->state(), StorageJob::Cancelled);
+
+    QTRY_COMPARE(manager.activeCount(), 0);
+    QCOMPARE(maxRunning, 1);
+
+    QCOMPARE(jobs.at(0)->state(), StorageJob::Finished);
+    QCOMPARE(jobs.at(1)->state(), StorageJob::Finished);
+    QCOMPARE(jobs.at(0)->processedBytes(), jobs.at(0)->totalBytes());
+    QVERIFY(volumeExists("copy-0.img"));
+    QVERIFY(volumeExists("copy-1.img"));
+    QVERIFY(!volumeExists("copy-2.img"));
+
+    // The test driver cannot share extents: a plain copy was made
+    QVERIFY(!jobs.at(0)->usedReflink());
+}
+
+void TestStorageJobs::testCloneFailure()
+{
+    StorageJobManager manager;
+    QSignalSpy finishedSpy(&manager, &StorageJobManager::jobFinished);
+
+    // The name is taken
+    StorageJob *job = manager.cloneVolume(m_source, "base.img");
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(job->state(), StorageJob::Failed);
+    QVERIFY(!job->errorString().isEmpty());
+}
+
+void TestStorageJobs::testClearFinished()
+{
+    StorageJobManager manager;
+    manager.cloneVolume(nullptr, "a.img");
+    StorageJob *job = manager.cloneVolume(m_source, "clear-me.img");
+    QTRY_VERIFY(job->isDone());
+
+    QSignalSpy removedSpy(&manager, &StorageJobManager::jobRemoved);
+    manager.clearFinished();
+    QCOMPARE(removedSpy.count(), 2);
+    QVERIFY(manager.jobs().isEmpty());
+}
+
+QTEST_MAIN(TestStorageJobs)
+#include "test_storagejobs.moc"
@@ -0,0 +1,153 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QBuffer>
+#include "../../src/libvirt/ThumbnailService.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for screenshot decoding and thumbnail scheduling rules
+ */
+class TestThumbnailService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDecodePPM();
+    void testDecodePNG();
+    void testMismatchedMimeType();
+    void testInvalidPayload();
+    void testNoUpscale();
+    void testRetryDelay();
+    void testDescribeAge();
+    void testDefaults();
+
+private:
+    static QByteArray makePPM(int width, int height, const QColor &color);
+};
+
+QByteArray TestThumbnailService::makePPM(int width, int height, const QColor &color)
+{
+    QByteArray data = QStringLiteral("P6\n%1 %2\n255\n").arg(width).arg(height).toLatin1();
+    QByteArray pixel;
+    pixel.append(char(color.red()));
+    pixel.append(char(color.green()));
+    pixel.append(char(color.blue()));
+    data.append(pixel.repeated(width * height));
+    return data;
+}
+
+void TestThumbnailService::testDecodePPM()
+{
+    // QEMU reports a 4:3 console as image/x-portable-pixmap
+    QByteArray ppm = makePPM(1024, 768, Qt::red);
+    QImage image = ThumbnailService::decodeScreenshot(ppm, "image/x-portable-pixmap", QSize(256, 192));
+
+    QVERIFY(!image.isNull());
+    QCOMPARE(image.size(), QSize(256, 192));
+    QCOMPARE(image.format(), QImage::Format_RGB32);
+    QCOMPARE(QColor(image.pixel(128, 96)), QColor(Qt::red));
+
+    // Aspect ratio is kept for wide screens
+    image = ThumbnailService::decodeScreenshot(makePPM(800, 400, Qt::blue),
+                                               "image/x-portable-pixmap", QSize(256, 192));
+    QCOMPARE(image.size(), QSize(256, 128));
+}
+
+void TestThumbnailService::testDecodePNG()
+{
+    QImage source(640, 480, QImage::Format_RGB32);
+    source.fill(Qt::green);
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(source.save(&buffer, "PNG"));
+
+    QImage image = ThumbnailService::decodeScreenshot(png, "image/png", QSize(320, 240));
+    QCOMPARE(image.size(), QSize(320, 240));
+    QCOMPARE(QColor(image.pixel(10, 10)), QColor(Qt::green));
+}
+
+void TestThumbnailService::testMismatchedMimeType()
+{
+    // The reported type is only a hint; the payload decides
+    QByteArray ppm = makePPM(64, 48, Qt::white);
+    QImage image = ThumbnailService::decodeScreenshot(ppm, "image/png", QSize(32, 24));
+    QCOMPARE(image.size(), QSize(32, 24));
+
+    image = ThumbnailService::decodeScreenshot(ppm, "application/octet-stream", QSize(32, 24));
+    QCOMPARE(image.size(), QSize(32, 24));
+}
+
+void TestThumbnailService::testInvalidPayload()
+{
+    QVERIFY(ThumbnailService::decodeScreenshot(QByteArray(), "image/png", QSize(32, 24)).isNull());
+    QVERIFY(ThumbnailService::decodeScreenshot("not an image", "image/x-portable-pixmap",
+                                               QSize(32, 24)).isNull());
+
+    // Truncated pixel data
+    QByteArray ppm = makePPM(64, 48, Qt::white);
+    ppm.chop(ppm.size() / 2);
+    QVERIFY(ThumbnailService::decodeScreenshot(ppm, "image/x-portable-pixmap",
+                                               QSize(32, 24)).isNull());
+}
+
+void TestThumbnailService::testNoUpscale()
+{
+    QImage image = ThumbnailService::decodeScreenshot(makePPM(80, 25, Qt::black),
+                                                      "image/x-portable-pixmap", QSize(256, 192));
+    QCOMPARE(image.size(), QSize(80, 25));
+}
+
+void TestThumbnailService::testRetryDelay()
+{
+    QCOMPARE(ThumbnailService::retryDelay(10000, 0), qint64(10000));
+    QCOMPARE(ThumbnailService::retryDelay(10000, 1), qint64(20000));
+    QCOMPARE(ThumbnailService::retryDelay(10000, 3), qint64(80000));
+
+    // Backoff is capped so a fixed guest is picked up again eventually
+    QCOMPARE(ThumbnailService::retryDelay(10000, 50), ThumbnailService::retryDelay(10000, 5));
+}
+
+void TestThumbnailService::testDescribeAge()
+{
+    QCOMPARE(ThumbnailService::describeAge(0), QString("0 s ago"));
+    QCOMPARE(ThumbnailService::describeAge(12500), QString("12 s ago"));
+    QCOMPARE(ThumbnailService::describeAge(125000), QString("2 min ago"));
+    QCOMPARE(ThumbnailService::describeAge(2 * 3600 * 1000 + 5), QString("2 h ago"));
+}
+
+void TestThumbnailService::testDefaults()
+{
+    ThumbnailService service;
+    QVERIFY(!service.isActive());
+    QCOMPARE(service.inFlightCount(), 0);
+    QVERIFY(service.maxConcurrent() > 0);
+
+    // Nothing is known about domains that were never watched
+    QVERIFY(service.thumbnail(nullptr).isNull());
+    QCOMPARE(service.thumbnailAge(nullptr), qint64(-1));
+
+    service.setMaxConcurrent(0);
+    QCOMPARE(service.maxConcurrent(), 1);
+    service.setThumbnailSize(QSize());
+    QVERIFY(service.thumbnailSize().isValid());
+
+    service.setActive(true);
+    QVERIFY(service.isActive());
+    service.setActive(false);
+    QVERIFY(!service.isActive());
+}
+
+QTEST_MAIN(TestThumbnailService)
+#include "test_thumbnailservice.moc"
@@ -0,0 +1,230 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QStandardItemModel>
+#include <QElapsedTimer>
+#include <QUuid>
+#include "../../src/ui/models/VMProxyModel.h"
+#include "../../src/ui/models/VMListModel.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for VMProxyModel filtering and statistics
+ */
+class TestVMProxyModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testTextFilter();
+    void testMultiTokenFilter();
+    void testIncrementalNarrowing();
+    void testDebounce();
+    void testStateCounters();
+    void testSourceRowChanges();
+    void testFilterPerformance();
+
+private:
+    static QStandardItem *makeVM(const QString &name, const QString &uuid,
+                                 int state, const QString &description = QString());
+};
+
+QStandardItem *TestVMProxyModel::makeVM(const QString &name, const QString &uuid,
+                                        int state, const QString &description)
+{
+    auto *item = new QStandardItem(name);
+    item->setData(name, VMListModel::NameRole);
+    item->setData(uuid, VMListModel::UUIDRole);
+    item->setData(state, VMListModel::StateRole);
+    item->setData(description, VMListModel::DescriptionRole);
+    return item;
+}
+
+void TestVMProxyModel::testTextFilter()
+{
+    QStandardItemModel source;
+    source.appendRow(makeVM("web-frontend", "1111", 1));
+    source.appendRow(makeVM("db-primary", "2222", 1, "PostgreSQL master"));
+    source.appendRow(makeVM("build-agent", "3333", 0));
+
+    VMProxyModel proxy;
+    proxy.setFilterDelay(0);
+    proxy.setSourceModel(&source);
+    QCOMPARE(proxy.rowCount(), 3);
+
+    proxy.setFilterText("WEB");
+    QCOMPARE(proxy.rowCount(), 1);
+    QCOMPARE(proxy.index(0, 0).data().toString(), QString("web-frontend"));
+
+    // Description and UUID are searchable too
+    proxy.setFilterText("postgres");
+    QCOMPARE(proxy.rowCount(), 1);
+    proxy.setFilterText("3333");
+    QCOMPARE(proxy.rowCount(), 1);
+
+    proxy.setFilterText(QString());
+    QCOMPARE(proxy.rowCount(), 3);
+}
+
+void TestVMProxyModel::testMultiTokenFilter()
+{
+    QStandardItemModel source;
+    source.appendRow(makeVM("web-frontend-eu", "1", 1));
+    source.appendRow(makeVM("web-frontend-us", "2", 1));
+    source.appendRow(makeVM("db-eu", "3", 1));
+
+    VMProxyModel proxy;
+    proxy.setFilterDelay(0);
+    proxy.setSourceModel(&source);
+
+    proxy.setFilterText("eu web");
+    QCOMPARE(proxy.rowCount(), 1);
+    QCOMPARE(proxy.index(0, 0).data().toString(), QString("web-frontend-eu"));
+}
+
+void TestVMProxyModel::testIncrementalNarrowing()
+{
+    QStandardItemModel source;
+    source.appendRow(makeVM("alpha", "1", 1));
+    source.appendRow(makeVM("alpine", "2", 1));
+    source.appendRow(makeVM("beta", "3", 1));
+
+    VMProxyModel proxy;
+    proxy.setFilterDelay(0);
+    proxy.setSourceModel(&source);
+
+    proxy.setFilterText("al");
+    QCOMPARE(proxy.rowCount(), 2);
+    proxy.setFilterText("alp");
+    QCOMPARE(proxy.rowCount(), 2);
+    proxy.setFilterText("alph");
+    QCOMPARE(proxy.rowCount(), 1);
+
+    // Shortening the query must widen the result again
+    proxy.setFilterText("a");
+    QCOMPARE(proxy.rowCount(), 3);
+}
+
+void TestVMProxyModel::testDebounce()
+{
+    QStandardItemModel source;
+    source.appendRow(makeVM("alpha", "1", 1));
+    source.appendRow(makeVM("beta", "2", 1));
+
+    VMProxyModel proxy;
+    proxy.setFilterDelay(50);
+    proxy.setSourceModel(&source);
+
+    QSignalSpy spy(&proxy, &VMProxyModel::filterUpdated);
+    proxy.setFilterText("b");
+    proxy.setFilterText("be");
+    proxy.setFilterText("bet");
+
+    // Nothing applied until the debounce interval elapses
+    QCOMPARE(proxy.rowCount(), 2);
+    QCOMPARE(proxy.filterText(), QString("bet"));
+
+    QTRY_COMPARE(proxy.rowCount(), 1);
+    QCOMPARE(spy.count(), 1);
+
+    proxy.setFilterText("alpha");
+    proxy.applyPendingFilter();
+    QCOMPARE(proxy.rowCount(), 1);
+    QCOMPARE(proxy.index(0, 0).data().toString(), QString("alpha"));
+}
+
+void TestVMProxyModel::testStateCounters()
+{
+    QStandardItemModel source;
+    source.appendRow(makeVM("a", "1", 1));
+    source.appendRow(makeVM("b", "2", 1));
+    source.appendRow(makeVM("c", "3", 2));
+    source.appendRow(makeVM("d", "4", 0));
+
+    VMProxyModel proxy;
+    proxy.setSourceModel(&source);
+
+    QCOMPARE(proxy.totalVMs(), 4);
+    QCOMPARE(proxy.runningVMs(), 2);
+    QCOMPARE(proxy.pausedVMs(), 1);
+    QCOMPARE(proxy.stoppedVMs(), 1);
+
+    QSignalSpy spy(&proxy, &VMProxyModel::statisticsChanged);
+    source.item(0)->setData(3, VMListModel::StateRole);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(proxy.runningVMs(), 1);
+    QCOMPARE(proxy.stoppedVMs(), 2);
+}
+
+void TestVMProxyModel::testSourceRowChanges()
+{
+    QStandardItemModel source;
+    source.appendRow(makeVM("alpha", "1", 1));
+    source.appendRow(makeVM("beta", "2", 0));
+
+    VMProxyModel proxy;
+    proxy.setFilterDelay(0);
+    proxy.setSourceModel(&source);
+    proxy.setFilterText("a");
+    QCOMPARE(proxy.rowCount(), 2);
+
+    source.insertRow(0, makeVM("gamma", "3", 1));
+    QCOMPARE(proxy.rowCount(), 3);
+    QCOMPARE(proxy.runningVMs(), 2);
+
+    source.appendRow(makeVM("zzz", "4", 1));
+    QCOMPARE(proxy.rowCount(), 3);
+
+    source.removeRow(0);
+    QCOMPARE(proxy.rowCount(), 2);
+    QCOMPARE(proxy.runningVMs(), 2);
+
+    // Renaming re-indexes the row
+    source.item(2)->setData("another", VMListModel::NameRole);
+    QCOMPARE(proxy.rowCount(), 3);
+}
+
+void TestVMProxyModel::testFilterPerformance()
+{
+    QStandardItemModel source;
+    const int vmCount = 10000;
+    for (int i = 0; i < vmCount; ++i) {
+        source.appendRow(makeVM(QString("vm-%1-%2").arg(i % 2 ? "web" : "db").arg(i),
+                                QUuid::createUuid().toString(QUuid::WithoutBraces),
+                                i % 3, QString("Description for machine %1").arg(i)));
+    }
+
+    VMProxyModel proxy;
+    proxy.setFilterDelay(0);
+    proxy.setSourceModel(&source);
+    QCOMPARE(proxy.rowCount(), vmCount);
+
+    QElapsedTimer timer;
+    timer.start();
+    const QStringList keystrokes = { "w", "we", "web", "web-", "web-1", "web-12" };
+    for (const QString &text : keystrokes) {
+        proxy.setFilterText(text);
+    }
+    qint64 elapsed = timer.elapsed();
+
+    QVERIFY(proxy.rowCount() > 0);
+    qInfo() << "Filtered" << vmCount << "VMs over" << keystrokes.count()
+            << "keystrokes in" << elapsed << "ms";
+
+    // Should stay within a few frames even on slow CI machines
+    QVERIFY2(elapsed < 16 * keystrokes.count() * 3,
+             qPrintable(QString("Filtering too slow: %1ms").arg(elapsed)));
+}
+
+QTEST_MAIN(TestVMProxyModel)
+#include "test_vmproxymodel.moc"
@@ -0,0 +1,433 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <atomic>
+#include <thread>
+#include "../../src/core/SPSCQueue.h"
+#include "../../src/console/VNCFrameExchange.h"
+#include "../../src/console/VNCInputBatcher.h"
+#include "../../src/console/VNCLinkPolicy.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for the VNC console's thread handoff primitives
+ */
+class TestVNCPipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testQueueBasics();
+    void testQueueAcrossThreads();
+    void testFrameHandoff();
+    void testSkippedFrameDamage();
+    void testFramesAcrossThreads();
+    void testMotionCoalescing();
+    void testButtonsFlushMotion();
+    void testWheelAccumulation();
+    void testKeyOrdering();
+    void testQueuedMotionKeepsButtons();
+    void testLinkTiers();
+    void testLinkHysteresis();
+    void testIdleLinkKeepsTier();
+};
+
+void TestVNCPipeline::testQueueBasics()
+{
+    SPSCQueue<int> queue(4);
+    QCOMPARE(queue.capacity(), 4);
+    QVERIFY(queue.isEmpty());
+
+    int value = 0;
+    QVERIFY(!queue.tryPop(&value));
+
+    for (int i = 1; i <= 4; ++i) {
+        QVERIFY(queue.tryPush(i));
+    }
+    QVERIFY(!queue.tryPush(5));
+
+    // FIFO order, including across the wrap-around point
+    QVERIFY(queue.tryPop(&value));
+    QCOMPARE(value, 1);
+    QVERIFY(queue.tryPush(5));
+    for (int expected = 2; expected <= 5; ++expected) {
+        QVERIFY(queue.tryPop(&value));
+        QCOMPARE(value, expected);
+    }
+    QVERIFY(queue.isEmpty());
+}
+
+void TestVNCPipeline::testQueueAcrossThreads()
+{
+    SPSCQueue<QByteArray> queue(64);
+    const int count = 100000;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < count; ++i) {
+            QByteArray item = QByteArray::number(i);
+            while (!queue.tryPush(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    QByteArray item;
+    while (expected < count) {
+        if (queue.tryPop(&item)) {
+            ordered = ordered && item.toInt() == expected;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    QVERIFY(ordered);
+    QVERIFY(queue.isEmpty());
+}
+
+void TestVNCPipeline::testFrameHandoff()
+{
+    VNCFrameExchange exchange;
+    QRegion damage;
+    QVERIFY(!exchange.acquire(&damage));
+    QVERIFY(exchange.frontFrame().isNull());
+
+    QImage source(64, 32, QImage::Format_RGB32);
+    source.fill(Qt::black);
+    QVERIFY(exchange.publish(source, QRegion(source.rect())));
+    QVERIFY(exchange.acquire(&damage));
+    QCOMPARE(exchange.frontFrame().size(), source.size());
+    QCOMPARE(damage, QRegion(source.rect()));
+    QVERIFY(!exchange.acquire(&damage));
+
+    // An incremental update reaches the consumer intact
+    QRect changed(8, 4, 10, 6);
+    source.fill(Qt::black);
+    for (int y = changed.top(); y <= changed.bottom(); ++y) {
+        for (int x = changed.left(); x <= changed.right(); ++x) {
+            source.setPixel(x, y, qRgb(255, 0, 0));
+        }
+    }
+    QVERIFY(exchange.publish(source, QRegion(changed)));
+    QVERIFY(exchange.acquire(&damage));
+    QVERIFY(damage.contains(changed));
+    QCOMPARE(exchange.frontFrame(), source);
+
+    // Every slot catches up, not just the one that saw the update
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(exchange.publish(source, QRegion(QRect(0, 0, 1, 1))));
+        QVERIFY(exchange.acquire(&damage));
+        QCOMPARE(exchange.frontFrame(), source);
+    }
+}
+
+void TestVNCPipeline::testSkippedFrameDamage()
+{
+    VNCFrameExchange exchange;
+    QImage source(100, 100, QImage::Format_RGB32);
+    source.fill(Qt::black);
+
+    QRegion damage;
+    QVERIFY(exchange.publish(source, QRegion(source.rect())));
+    QVERIFY(exchange.acquire(&damage));
+
+    // The consumer falls behind by three frames
+    QRect first(0, 0, 10, 10);
+    QRect second(50, 50, 10, 10);
+    QRect third(90, 0, 10, 10);
+    QVERIFY(exchange.publish(source, QRegion(first)));
+    QVERIFY(!exchange.publish(source, QRegion(second)));
+    QVERIFY(!exchange.publish(source, QRegion(third)));
+    QCOMPARE(exchange.replacedFrames(), quint64(2));
+
+    // Only the newest frame is delivered, with all of the missed damage
+    QVERIFY(exchange.acquire(&damage));
+    QVERIFY(damage.contains(first));
+    QVERIFY(damage.contains(second));
+    QVERIFY(damage.contains(third));
+    QVERIFY(!exchange.acquire(&damage));
+}
+
+void TestVNCPipeline::testFramesAcrossThreads()
+{
+    VNCFrameExchange exchange;
+    const int frames = 2000;
+    std::atomic<bool> done(false);
+
+    // Each frame is a solid color; a torn frame would mix two of them
+    std::thread producer([&exchange, &done]() {
+        QImage source(320, 200, QImage::Format_RGB32);
+        for (int i = 1; i <= frames; ++i) {
+            source.fill(QColor::fromRgb(i & 0xff, (i >> 8) & 0xff, 0).rgb());
+            exchange.publish(source, QRegion(source.rect()));
+        }
+        done.store(true);
+    });
+
+    int lastFrame = 0;
+    bool untorn = true;
+    bool monotonic = true;
+    QRegion damage;
+    for (;;) {
+        const bool finished = done.load();
+        if (!exchange.acquire(&damage)) {
+            if (finished) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        const QImage &frame = exchange.frontFrame();
+        const QRgb first = frame.pixel(0, 0);
+        for (int y = 0; y < frame.height() && untorn; y += 7) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(frame.constScanLine(y));
+            for (int x = 0; x < frame.width(); ++x) {
+                if (line[x] != first) {
+                    untorn = false;
+                    break;
+                }
+            }
+        }
+        int index = qRed(first) | (qGreen(first) << 8);
+        monotonic = monotonic && index > lastFrame;
+        lastFrame = index;
+    }
+    producer.join();
+
+    QVERIFY(untorn);
+    QVERIFY(monotonic);
+    QCOMPARE(lastFrame, frames);
+    QCOMPARE(exchange.publishedFrames(), quint64(frames));
+}
+
+void TestVNCPipeline::testMotionCoalescing()
+{
+    VNCInputBatcher batcher(16);
+
+    // The first move goes out at once
+    QCOMPARE(batcher.motion(10, 10, 0, 1000), -1);
+    QCOMPARE(batcher.takeEvents().size(), 1);
+
+    // A burst within the interval collapses into its last position
+    QCOMPARE(batcher.motion(11, 10, 0, 1002), 14);
+    for (int i = 0; i < 48; ++i) {
+        QVERIFY(batcher.motion(12 + i, 10, 0, 1003 + i / 4) >= 0);
+    }
+    QVERIFY(batcher.takeEvents().isEmpty());
+    QVERIFY(batcher.hasPendingMotion());
+
+    batcher.flushMotion(1016);
+    QVector<VNCInputEvent> events = batcher.takeEvents();
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().type, VNCInputEvent::Pointer);
+    QCOMPARE(events.first().x, 59);
+
+    // 50 motion events in, 2 out, 48 merged
+    QCOMPARE(batcher.stats().pointerEvents, quint64(50));
+    QCOMPARE(batcher.stats().coalesced, quint64(48));
+
+    // After a quiet interval the leading edge goes out immediately again
+    QCOMPARE(batcher.motion(60, 10, 0, 1100), -1);
+    QCOMPARE(batcher.takeEvents().size(), 1);
+}
+
+void TestVNCPipeline::testButtonsFlushMotion()
+{
+    VNCInputBatcher batcher(16);
+    batcher.motion(0, 0, 0, 0);
+    batcher.motion(5, 5, 0, 1);
+    batcher.takeEvents();
+    QVERIFY(batcher.hasPendingMotion());
+
+    // A press carries its own position and is never delayed
+    batcher.pointer(6, 6, 0x01);
+    QVector<VNCInputEvent> events = batcher.takeEvents();
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().buttonMask, 0x01);
+    QVERIFY(!batcher.hasPendingMotion());
+
+    // A move reporting different buttons is sent as a button change
+    QCOMPARE(batcher.motion(7, 7, 0, 2), -1);
+    events = batcher.takeEvents();
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().buttonMask, 0);
+}
+
+void TestVNCPipeline::testWheelAccumulation()
+{
+    VNCInputBatcher batcher;
+
+    // Touchpad-sized deltas add up to whole steps
+    for (int i = 0; i < 5; ++i) {
+        batcher.wheel(1, 1, 0, 0, 40);
+    }
+    QVector<VNCInputEvent> events = batcher.takeEvents();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(0).buttonMask, 0x08);
+    QCOMPARE(events.at(1).buttonMask, 0);
+    QCOMPARE(batcher.stats().wheelSteps, quint64(1));
+
+    // A fast notch burst becomes one press/release per step
+    batcher.wheel(1, 1, 0, 0, -320);
+    events = batcher.takeEvents();
+    QCOMPARE(events.size(), 4);
+    QCOMPARE(events.at(0).buttonMask, 0x10);
+    QCOMPARE(events.at(2).buttonMask, 0x10);
+}
+
+void TestVNCPipeline::testKeyOrdering()
+{
+    VNCInputBatcher batcher(16);
+    batcher.motion(0, 0, 0, 0);
+    batcher.motion(3, 4, 0, 1);
+    batcher.takeEvents();
+
+    // The pending move happened first, so it is sent before the key
+    batcher.key(0x61, true);
+    batcher.key(0x61, false);
+    QVector<VNCInputEvent> events = batcher.takeEvents();
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events.at(0).type, VNCInputEvent::Pointer);
+    QCOMPARE(events.at(0).x, 3);
+    QCOMPARE(events.at(1).type, VNCInputEvent::Key);
+    QVERIFY(events.at(1).down);
+    QVERIFY(!events.at(2).down);
+    QCOMPARE(batcher.stats().keyEvents, quint64(2));
+}
+
+void TestVNCPipeline::testQueuedMotionKeepsButtons()
+{
+    auto pointer = [](int x, int buttonMask) {
+        VNCInputEvent event;
+        event.type = VNCInputEvent::Pointer;
+        event.x = x;
+        event.buttonMask = buttonMask;
+        return event;
+    };
+
+    // A drag that piled up while the protocol thread was busy
+    QVector<VNCInputEvent> events{pointer(1, 0), pointer(2, 0), pointer(3, 0x01),
+                                  pointer(4, 0x01), pointer(5, 0x01), pointer(6, 0x00),
+                                  pointer(7, 0x00)};
+    int lastMask = 0;
+    QCOMPARE(VNCInputBatcher::collapseMotion(&events, &lastMask), 2);
+    QCOMPARE(lastMask, 0);
+
+    // The press and the release arrive where they happened; only the
+    // motion in between is collapsed
+    QCOMPARE(events.size(), 5);
+    QCOMPARE(events.at(0).x, 2);
+    QCOMPARE(events.at(1).x, 3);
+    QCOMPARE(events.at(1).buttonMask, 0x01);
+    QCOMPARE(events.at(2).x, 5);
+    QCOMPARE(events.at(2).buttonMask, 0x01);
+    QCOMPARE(events.at(3).x, 6);
+    QCOMPARE(events.at(3).buttonMask, 0x00);
+    QCOMPARE(events.at(4).x, 7);
+
+    // A press in the previous batch is not repeated as a transition
+    events = {pointer(8, 0x01), pointer(9, 0x01)};
+    lastMask = 0x01;
+    QCOMPARE(VNCInputBatcher::collapseMotion(&events, &lastMask), 1);
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().x, 9);
+
+    // Keys break up runs of motion
+    VNCInputEvent key;
+    key.keysym = 0x61;
+    key.down = true;
+    events = {pointer(10, 0x01), key, pointer(11, 0x01)};
+    QCOMPARE(VNCInputBatcher::collapseMotion(&events, &lastMask), 0);
+    QCOMPARE(events.size(), 3);
+}
+
+void TestVNCPipeline::testLinkTiers()
+{
+    QCOMPARE(VNCLinkPolicy::tierFor(0.3, -1), VNCLinkPolicy::LanTier);
+    QCOMPARE(VNCLinkPolicy::tierFor(25.0, -1), VNCLinkPolicy::BroadbandTier);
+    QCOMPARE(VNCLinkPolicy::tierFor(80.0, -1), VNCLinkPolicy::WanTier);
+    QCOMPARE(VNCLinkPolicy::tierFor(300.0, -1), VNCLinkPolicy::SlowTier);
+
+    // A thin pipe downgrades even a short round trip, never the reverse
+    QCOMPARE(VNCLinkPolicy::tierFor(0.3, 900.0), VNCLinkPolicy::SlowTier);
+    QCOMPARE(VNCLinkPolicy::tierFor(80.0, 900000.0), VNCLinkPolicy::WanTier);
+
+    // Lower tiers trade fidelity for bandwidth
+    VNCLinkPolicy::Settings lan = VNCLinkPolicy::settingsFor(VNCLinkPolicy::LanTier);
+    VNCLinkPolicy::Settings slow = VNCLinkPolicy::settingsFor(VNCLinkPolicy::SlowTier);
+    QVERIFY(!lan.enableJPEG);
+    QVERIFY(!lan.lowColour);
+    QVERIFY(slow.enableJPEG);
+    QVERIFY(slow.lowColour);
+    QVERIFY(slow.qualityLevel < lan.qualityLevel);
+    QVERIFY(slow.compressLevel > lan.compressLevel);
+}
+
+void TestVNCPipeline::testLinkHysteresis()
+{
+    VNCLinkPolicy policy(VNCLinkPolicy::LanTier);
+    qint64 now = 0;
+
+    // An 80 ms link has to persist before the policy gives up on LAN
+    policy.addRttSample(80.0);
+    QVERIFY(!policy.update(now));
+    now += VNCLinkPolicy::DowngradeDelayMs / 2;
+    policy.addRttSample(80.0);
+    QVERIFY(!policy.update(now));
+    now += VNCLinkPolicy::DowngradeDelayMs;
+    policy.addRttSample(80.0);
+    QVERIFY(policy.update(now));
+    QCOMPARE(policy.tier(), VNCLinkPolicy::WanTier);
+
+    // A brief fast spell does not switch back
+    for (int i = 0; i < 20; ++i) {
+        policy.addRttSample(0.5);
+    }
+    QVERIFY(!policy.update(now += 1000));
+    QVERIFY(!policy.update(now += 1000));
+    QCOMPARE(policy.tier(), VNCLinkPolicy::WanTier);
+
+    // A sustained one does
+    QVERIFY(policy.update(now += VNCLinkPolicy::UpgradeDelayMs));
+    QCOMPARE(policy.tier(), VNCLinkPolicy::LanTier);
+}
+
+void TestVNCPipeline::testIdleLinkKeepsTier()
+{
+    VNCLinkPolicy policy(VNCLinkPolicy::LanTier);
+    policy.addRttSample(0.4);
+
+    // Small updates are no throughput measurement
+    for (int i = 0; i < 100; ++i) {
+        policy.addBurstSample(2000, 50.0);
+    }
+    QVERIFY(policy.throughputKbps() < 0);
+    QVERIFY(!policy.update(0));
+    QVERIFY(!policy.update(60000));
+    QCOMPARE(policy.tier(), VNCLinkPolicy::LanTier);
+
+    // A real burst is
+    policy.addBurstSample(4 * 1024 * 1024, 100.0);
+    QVERIFY(policy.throughputKbps() > 300000.0);
+
+    // The remembered tier outlives the session
+    VNCLinkPolicy::rememberTier("vnc.example:5901", VNCLinkPolicy::SlowTier);
+    QCOMPARE(VNCLinkPolicy::rememberedTier("vnc.example:5901"), VNCLinkPolicy::SlowTier);
+    QCOMPARE(VNCLinkPolicy::rememberedTier("vnc.example:5902"), VNCLinkPolicy::LanTier);
+}
+
+QTEST_MAIN(TestVNCPipeline)
+#include "test_vncpipeline.moc"
@@ -0,0 +1,172 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QSortFilterProxyModel>
+#include "../../src/ui/models/VolumeListModel.h"
+#include "../../src/libvirt/StorageVolume.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for VolumeListModel
+ *
+ * Volumes come from the libvirt test driver, which needs no daemon.
+ */
+class TestVolumeListModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testCells();
+    void testNumericSort();
+    void testNameFilter();
+    void testIncrementalUpdate();
+
+private:
+    StorageVolume *createVolume(const QString &name, qint64 capacity);
+
+    virConnectPtr m_conn = nullptr;
+    virStoragePoolPtr m_pool = nullptr;
+    QList<StorageVolume*> m_volumes;
+};
+
+void TestVolumeListModel::initTestCase()
+{
+    m_conn = virConnectOpen("test:///default");
+    if (!m_conn) {
+        QSKIP("libvirt test driver not available");
+    }
+    m_pool = virStoragePoolLookupByName(m_conn, "default-pool");
+    if (!m_pool) {
+        QSKIP("libvirt test driver has no default pool");
+    }
+
+    m_volumes.append(createVolume("data-small", 512LL * 1024 * 1024));
+    m_volumes.append(createVolume("data-large", 10LL * 1024 * 1024 * 1024));
+    m_volumes.append(createVolume("boot", 2LL * 1024 * 1024 * 1024));
+    for (StorageVolume *volume : m_volumes) {
+        QVERIFY(volume);
+    }
+}
+
+void TestVolumeListModel::cleanupTestCase()
+{
+    qDeleteAll(m_volumes);
+    m_volumes.clear();
+    if (m_pool) {
+        virStoragePoolFree(m_pool);
+    }
+    if (m_conn) {
+        virConnectClose(m_conn);
+    }
+}
+
+StorageVolume *TestVolumeListModel::createVolume(const QString &name, qint64 capacity)
+{
+    QByteArray xml = QString("<volume><name>%1</name>"
+                             "<capacity unit='bytes'>%2</capacity></volume>")
+                         .arg(name).arg(capacity).toUtf8();
+    virStorageVolPtr vol = virStorageVolCreateXML(m_pool, xml.constData(), 0);
+    return vol ? new StorageVolume(vol, nullptr) : nullptr;
+}
+
+void TestVolumeListModel::testCells()
+{
+    VolumeListModel model;
+    model.setVolumes(m_volumes);
+
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.columnCount(), int(VolumeListModel::ColumnCount));
+    QCOMPARE(model.headerData(VolumeListModel::ColumnCapacity, Qt::Horizontal).toString(),
+             QString("Capacity"));
+
+    QModelIndex name = model.index(1, VolumeListModel::ColumnName);
+    QCOMPARE(name.data().toString(), QString("data-large"));
+    QCOMPARE(name.data(VolumeListModel::KeyRole).toString(), m_volumes.at(1)->key());
+
+    QModelIndex capacity = model.index(1, VolumeListModel::ColumnCapacity);
+    QCOMPARE(capacity.data().toString(), QString("10.00 GiB"));
+    QCOMPARE(capacity.data(VolumeListModel::SortRole).toLongLong(), 10LL * 1024 * 1024 * 1024);
+
+    QCOMPARE(model.volumeAt(2), m_volumes.at(2));
+    QCOMPARE(model.volumeAt(3), static_cast<StorageVolume*>(nullptr));
+    QCOMPARE(model.rowOf(m_volumes.at(0)), 0);
+}
+
+void TestVolumeListModel::testNumericSort()
+{
+    VolumeListModel model;
+    model.setVolumes(m_volumes);
+
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setSortRole(VolumeListModel::SortRole);
+    proxy.sort(VolumeListModel::ColumnCapacity, Qt::AscendingOrder);
+
+    // "512.0 MiB" < "2.00 GiB" < "10.00 GiB", not the text order
+    QCOMPARE(proxy.index(0, VolumeListModel::ColumnName).data().toString(), QString("data-small"));
+    QCOMPARE(proxy.index(1, VolumeListModel::ColumnName).data().toString(), QString("boot"));
+    QCOMPARE(proxy.index(2, VolumeListModel::ColumnName).data().toString(), QString("data-large"));
+}
+
+void TestVolumeListModel::testNameFilter()
+{
+    VolumeListModel model;
+    model.setVolumes(m_volumes);
+
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setFilterKeyColumn(VolumeListModel::ColumnName);
+    proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    proxy.setFilterFixedString("DATA");
+    QCOMPARE(proxy.rowCount(), 2);
+    proxy.setFilterFixedString("boot");
+    QCOMPARE(proxy.rowCount(), 1);
+    proxy.setFilterFixedString(QString());
+    QCOMPARE(proxy.rowCount(), 3);
+}
+
+void TestVolumeListModel::testIncrementalUpdate()
+{
+    VolumeListModel model;
+    model.setVolumes({m_volumes.at(0), m_volumes.at(1)});
+
+    QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy removedSpy(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy insertedSpy(&model, &QAbstractItemModel::rowsInserted);
+
+    // One volume gone, one new: the surviving row stays put
+    model.setVolumes({m_volumes.at(1), m_volumes.at(2)});
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(1).toInt(), 0);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.at(0).at(1).toInt(), 1);
+    QCOMPARE(model.volumeAt(0), m_volumes.at(1));
+    QCOMPARE(model.volumeAt(1), m_volumes.at(2));
+
+    // Nothing changed: no structural signals
+    model.setVolumes({m_volumes.at(2), m_volumes.at(1)});
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 1);
+
+    model.setVolumes({});
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(removedSpy.count(), 2);
+}
+
+QTEST_MAIN(TestVolumeListModel)
+#include "test_volumelistmodel.moc"
@@ -0,0 +1,131 @@
+/*
+ * QVirt-Manager
+ *
+ * Copyright (C) 2025-2026 Inoki <veyx.shaw@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include "../../src/libvirt/VolumeTransfer.h"
+
+using namespace QVirt;
+
+/**
+ * @brief Unit tests for volume transfer helpers
+ */
+class TestVolumeTransfer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testAllocatedBytesDense();
+    void testAllocatedBytesSparse();
+    void testAllocatedBytesMissing();
+    void testEstimateEta();
+    void testStartWithoutVolume();
+    void testBufferSizeBounds();
+    void testRange();
+};
+
+void TestVolumeTransfer::testAllocatedBytesDense()
+{
+    QTemporaryDir dir;
+    QFile file(dir.filePath("dense.img"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(1024 * 1024, 'x'));
+    file.close();
+
+    QCOMPARE(VolumeTransfer::allocatedBytes(file.fileName()), qint64(1024 * 1024));
+
+    QFile empty(dir.filePath("empty.img"));
+    QVERIFY(empty.open(QIODevice::WriteOnly));
+    empty.close();
+    QCOMPARE(VolumeTransfer::allocatedBytes(empty.fileName()), qint64(0));
+}
+
+void TestVolumeTransfer::testAllocatedBytesSparse()
+{
+    QTemporaryDir dir;
+    const qint64 size = 64 * 1024 * 1024;
+    QFile file(dir.filePath("sparse.img"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(size));
+    file.write(QByteArray(4096, 'a'));
+    QVERIFY(file.seek(size / 2));
+    file.write(QByteArray(4096, 'b'));
+    file.close();
+
+    // Only the two written blocks count where the file system reports
+    // holes; otherwise the whole file is data
+    qint64 allocated = VolumeTransfer::allocatedBytes(file.fileName());
+    QVERIFY(allocated >= 8192);
+    QVERIFY(allocated <= size);
+}
+
+void TestVolumeTransfer::testAllocatedBytesMissing()
+{
+    QCOMPARE(VolumeTransfer::allocatedBytes("/nonexistent/volume.img"), qint64(-1));
+}
+
+void TestVolumeTransfer::testEstimateEta()
+{
+    QCOMPARE(VolumeTransfer::estimateEtaMs(100 * 1024 * 1024, 50 * 1024 * 1024), qint64(2000));
+    QCOMPARE(VolumeTransfer::estimateEtaMs(0, 0), qint64(0));
+    QCOMPARE(VolumeTransfer::estimateEtaMs(1024, 0), qint64(-1));
+}
+
+void TestVolumeTransfer::testStartWithoutVolume()
+{
+    VolumeTransfer transfer(nullptr, VolumeTransfer::Upload, "/dev/null");
+    QSignalSpy finishedSpy(&transfer, &VolumeTransfer::finished);
+
+    QVERIFY(!transfer.start());
+    QCOMPARE(transfer.state(), VolumeTransfer::Failed);
+    QVERIFY(!transfer.errorString().isEmpty());
+    QCOMPARE(finishedSpy.count(), 0);
+    QCOMPARE(transfer.processedBytes(), qint64(0));
+    QCOMPARE(transfer.etaMs(), qint64(-1));
+}
+
+void TestVolumeTransfer::testBufferSizeBounds()
+{
+    VolumeTransfer transfer(nullptr, VolumeTransfer::Download, QString());
+    QCOMPARE(transfer.bufferSize(), VolumeTransfer::DefaultBufferSize);
+    QVERIFY(transfer.isSparse());
+
+    transfer.setBufferSize(1);
+    QVERIFY(transfer.bufferSize() >= 64 * 1024);
+    transfer.setBufferSize(qint64(1) << 40);
+    QVERIFY(transfer.bufferSize() < (qint64(1) << 40));
+
+    // Whole O_DIRECT blocks
+    transfer.setBufferSize(1000 * 1000);
+    QCOMPARE(transfer.bufferSize() % 4096, qint64(0));
+}
+
+void TestVolumeTransfer::testRange()
+{
+    VolumeTransfer transfer(nullptr, VolumeTransfer::Download, QString());
+    QCOMPARE(transfer.offset(), qint64(0));
+    QCOMPARE(transfer.length(), qint64(0));
+    QVERIFY(!transfer.directIO());
+
+    transfer.setRange(1024 * 1024, 4096);
+    QCOMPARE(transfer.offset(), qint64(1024 * 1024));
+    QCOMPARE(transfer.length(), qint64(4096));
+
+    // Nothing transferred yet: resuming starts at the range
+    QCOMPARE(transfer.resumeOffset(), qint64(1024 * 1024));
+
+    transfer.setRange(-5, -1);
+    QCOMPARE(transfer.offset(), qint64(0));
+    QCOMPARE(transfer.length(), qint64(0));
+}
+
+QTEST_MAIN(TestVolumeTransfer)
+#include "test_volumetransfer.moc"